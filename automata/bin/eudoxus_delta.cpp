@@ -0,0 +1,181 @@
+/*****************************************************************************
+ * Licensed to Qualys, Inc. (QUALYS) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * QUALYS licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+/**
+ * @file
+ * @brief IronAutomata --- Eudoxus Delta Container Producer
+ *
+ * Produces a delta container (see ironautomata/eudoxus_delta.h) from a
+ * base automata file and a new automata file: chunks of the new file
+ * whose content matches the base at the same offset are referenced,
+ * changed chunks are carried inline.  Edge nodes that already have the
+ * base only need the container; ia_eudoxus_create_from_path()
+ * reassembles and verifies the full automata.
+ *
+ * Usage:
+ *
+ *     eudoxus_delta [-c chunk_size] <base> <new> <output>
+ *
+ * The base path is recorded as given; distribute the container next to
+ * the base (relative paths resolve against the container's directory).
+ */
+
+#include <ironautomata/eudoxus_delta.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+//! Read an entire file; exits with a message on failure.
+vector<uint8_t> read_file(const char *path)
+{
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        fprintf(stderr, "Error opening %s\n", path);
+        exit(1);
+    }
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    rewind(fp);
+    if (size < 0) {
+        fprintf(stderr, "Error sizing %s\n", path);
+        exit(1);
+    }
+    vector<uint8_t> data(size);
+    if (size > 0 && fread(&data[0], 1, size, fp) != (size_t)size) {
+        fprintf(stderr, "Error reading %s\n", path);
+        exit(1);
+    }
+    fclose(fp);
+    return data;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t chunk_size = IA_EUDOXUS_DELTA_DEFAULT_CHUNK;
+    int      argi = 1;
+
+    if (argi + 1 < argc && strcmp(argv[argi], "-c") == 0) {
+        chunk_size = strtoull(argv[argi + 1], NULL, 10);
+        argi += 2;
+    }
+    if (argc - argi != 3 || chunk_size == 0) {
+        fprintf(stderr,
+                "Usage: %s [-c chunk_size] <base> <new> <output>\n",
+                argv[0]);
+        return 1;
+    }
+
+    const char *base_path = argv[argi];
+    const char *new_path  = argv[argi + 1];
+    const char *out_path  = argv[argi + 2];
+
+    vector<uint8_t> base_data = read_file(base_path);
+    vector<uint8_t> new_data  = read_file(new_path);
+
+    if (new_data.empty()) {
+        fprintf(stderr, "New automata %s is empty.\n", new_path);
+        return 1;
+    }
+
+    uint64_t n_chunks =
+        ((uint64_t)new_data.size() + chunk_size - 1) / chunk_size;
+
+    vector<ia_eudoxus_delta_chunk_t> chunks(n_chunks);
+    uint64_t inline_bytes = 0;
+
+    for (uint64_t i = 0; i < n_chunks; ++i) {
+        uint64_t offset = i * chunk_size;
+        uint64_t length = new_data.size() - offset;
+        if (length > chunk_size) {
+            length = chunk_size;
+        }
+
+        memset(&chunks[i], 0, sizeof(chunks[i]));
+        chunks[i].length = length;
+        chunks[i].hash =
+            ia_eudoxus_delta_hash(&new_data[offset], length);
+
+        bool same =
+            offset + length <= base_data.size() &&
+            memcmp(&base_data[offset], &new_data[offset], length) == 0;
+        chunks[i].inline_data = same ? 0 : 1;
+        if (! same) {
+            inline_bytes += length;
+        }
+    }
+
+    FILE *out = fopen(out_path, "wb");
+    if (out == NULL) {
+        fprintf(stderr, "Error opening %s for write.\n", out_path);
+        return 1;
+    }
+
+    ia_eudoxus_delta_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.magic            = IA_EUDOXUS_DELTA_MAGIC;
+    header.version          = IA_EUDOXUS_DELTA_VERSION;
+    header.automata_length  = new_data.size();
+    header.chunk_size       = chunk_size;
+    header.n_chunks         = n_chunks;
+    header.base_path_length = strlen(base_path);
+
+    bool ok =
+        fwrite(&header, sizeof(header), 1, out) == 1 &&
+        fwrite(base_path, 1, header.base_path_length, out) ==
+            header.base_path_length &&
+        (n_chunks == 0 ||
+         fwrite(&chunks[0], sizeof(chunks[0]), n_chunks, out) == n_chunks);
+
+    for (uint64_t i = 0; ok && i < n_chunks; ++i) {
+        if (chunks[i].inline_data) {
+            ok = fwrite(
+                &new_data[i * chunk_size], 1, chunks[i].length, out
+            ) == chunks[i].length;
+        }
+    }
+
+    if (! ok || fclose(out) != 0) {
+        fprintf(stderr, "Error writing %s.\n", out_path);
+        return 1;
+    }
+
+    uint64_t inline_chunks = 0;
+    for (uint64_t i = 0; i < n_chunks; ++i) {
+        if (chunks[i].inline_data) {
+            ++inline_chunks;
+        }
+    }
+    printf(
+        "%s: %llu/%llu chunks inline (%llu of %llu bytes, %.1f%%)\n",
+        out_path,
+        (unsigned long long)inline_chunks,
+        (unsigned long long)n_chunks,
+        (unsigned long long)inline_bytes,
+        (unsigned long long)new_data.size(),
+        100.0 * (double)inline_bytes / (double)new_data.size());
+
+    return 0;
+}
@@ -45,15 +45,28 @@
 #include <ironautomata/bits.h>
 
 #include <ironautomata/eudoxus_automata.h>
+#include <ironautomata/eudoxus_delta.h>
 #include <ironautomata/vls.h>
 
 #include <assert.h>
+#include <fcntl.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
+/**
+ * One flattened output chain: a run of entries in
+ * ia_eudoxus_t::flat_outputs.
+ */
+typedef struct {
+    uint32_t start; /**< First entry in flat_outputs. */
+    uint32_t count; /**< Number of outputs in the run. */
+} ia_eudoxus_output_run_t;
+
 struct ia_eudoxus_t
 {
     /**
@@ -80,8 +93,52 @@ struct ia_eudoxus_t
      * otherwise.
      */
     bool free_error_message;
+
+    /**
+     * Is @c automata a memory mapping rather than a heap buffer?
+     *
+     * Memory mapped automata are page-aligned, read-only and backed by
+     * the file's page cache, so all workers mapping the same file share
+     * one copy.  Unmapped with munmap() rather than free() on destroy.
+     */
+    bool automata_is_mmapped;
+
+    /**
+     * Size of the @c automata mapping; only meaningful when
+     * @c automata_is_mmapped is true.
+     */
+    size_t automata_size;
+
+    /**
+     * Flattened output chains, or NULL.
+     *
+     * Legacy automata store a node's outputs as a linked list of
+     * output-list elements scattered through the blob, chased per
+     * match.  At load the chains are validated and re-packed: for
+     * every output-list element, @c output_runs (indexed by the
+     * element's position in the output-list region) gives a contiguous
+     * run in @c flat_outputs of automata offsets of the outputs
+     * reachable from it.  Match processing then iterates a flat array
+     * instead of chasing ids.  Both arrays are heap owned and freed on
+     * destroy; NULL when flattening was skipped (no output lists, a
+     * malformed chain, or a tail-sharing blowup past the memory
+     * budget), in which case the chain walk remains in use.
+     */
+    const ia_eudoxus_output_run_t *output_runs;
+
+    /** Output offsets backing @c output_runs. */
+    const uint64_t *flat_outputs;
 };
 
+/**
+ * Build the flattened output index for @a eudoxus.
+ *
+ * Dispatches on id width; defined after the subengine instantiations.
+ */
+static ia_eudoxus_result_t ia_eudoxus_build_output_index(
+    ia_eudoxus_t *eudoxus
+);
+
 struct ia_eudoxus_state_t
 {
     /**
@@ -118,6 +175,18 @@ struct ia_eudoxus_state_t
      * Remaining bytes in current input chunk.
      */
     size_t remaining_bytes;
+
+    /**
+     * Execution metrics; see ia_eudoxus_metrics_get().
+     */
+    ia_eudoxus_metrics_t metrics;
+
+    /* Cooperative cancellation; see
+     * ia_eudoxus_set_progress_callback(). */
+    ia_eudoxus_progress_fn_t progress_fn;       /**< Callback; NULL off. */
+    void                    *progress_cbdata;   /**< Callback data. */
+    size_t                   progress_interval; /**< Bytes between calls. */
+    size_t                   progress_left;     /**< Bytes until next call. */
 };
 
 /**
@@ -194,9 +263,13 @@ ia_eudoxus_result_t ia_eudoxus_create(
         return IA_EUDOXUS_EINVAL;
     }
 
-    eudoxus->automata           = (ia_eudoxus_automata_t *)data;
-    eudoxus->error_message      = NULL;
-    eudoxus->free_error_message = false;
+    eudoxus->automata            = (ia_eudoxus_automata_t *)data;
+    eudoxus->error_message       = NULL;
+    eudoxus->free_error_message  = false;
+    eudoxus->automata_is_mmapped = false;
+    eudoxus->automata_size       = 0;
+    eudoxus->output_runs         = NULL;
+    eudoxus->flat_outputs        = NULL;
 
     if (eudoxus->automata->version != IA_EUDOXUS_VERSION) {
         rc = IA_EUDOXUS_EINCOMPAT;
@@ -208,6 +281,13 @@ ia_eudoxus_result_t ia_eudoxus_create(
         goto finish;
     }
 
+    /* Validate and flatten the output chains; an automata whose chains
+     * cannot be flattened keeps the (slower) chain walk. */
+    rc = ia_eudoxus_build_output_index(eudoxus);
+    if (rc != IA_EUDOXUS_OK) {
+        goto finish;
+    }
+
 finish:
     if (rc != IA_EUDOXUS_OK) {
         if (eudoxus != NULL) {
@@ -250,7 +330,16 @@ ia_eudoxus_result_t ia_eudoxus_create_from_file(
     return ia_eudoxus_create(out_eudoxus, buffer);
 }
 
-ia_eudoxus_result_t ia_eudoxus_create_from_path(
+/**
+ * Load an automata by reading the file at @a path into a heap buffer.
+ *
+ * Fallback for ia_eudoxus_create_from_path() when the file can not be
+ * memory mapped.
+ *
+ * @sa ia_eudoxus_create_from_path()
+ */
+static
+ia_eudoxus_result_t ia_eudoxus_create_from_path_read(
     ia_eudoxus_t **out_eudoxus,
     const char    *path
 )
@@ -267,6 +356,219 @@ ia_eudoxus_result_t ia_eudoxus_create_from_path(
     return result;
 }
 
+/**
+ * Load an automata described by a delta container at @a path.
+ *
+ * Reassembles the automata into a heap buffer: referenced chunks are
+ * read from the base file (resolved relative to the container's
+ * directory when not absolute) and inline chunks from the container
+ * itself; every chunk is verified against its content hash, so a stale
+ * or wrong base file is detected rather than executed.
+ */
+static ia_eudoxus_result_t ia_eudoxus_create_from_delta(
+    ia_eudoxus_t **out_eudoxus,
+    const char    *path,
+    FILE          *fp
+)
+{
+    ia_eudoxus_delta_header_t  header;
+    ia_eudoxus_delta_chunk_t  *chunks = NULL;
+    char                      *base_path = NULL;
+    FILE                      *base = NULL;
+    char                      *data = NULL;
+    ia_eudoxus_result_t        result = IA_EUDOXUS_EINVAL;
+
+    if (fread(&header, sizeof(header), 1, fp) != 1) {
+        goto done;
+    }
+    if (header.magic != IA_EUDOXUS_DELTA_MAGIC ||
+        header.version != IA_EUDOXUS_DELTA_VERSION ||
+        header.chunk_size == 0 ||
+        header.automata_length == 0 ||
+        header.n_chunks !=
+            (header.automata_length + header.chunk_size - 1) /
+            header.chunk_size)
+    {
+        goto done;
+    }
+
+    /* Base path, resolved relative to the container's directory. */
+    {
+        const char *slash = strrchr(path, '/');
+        size_t      dir_len =
+            (slash != NULL) ? (size_t)(slash - path) + 1 : 0;
+        size_t      full_len = dir_len + header.base_path_length + 1;
+
+        base_path = (char *)malloc(full_len);
+        if (base_path == NULL) {
+            result = IA_EUDOXUS_EALLOC;
+            goto done;
+        }
+        if (header.base_path_length == 0) {
+            goto done;
+        }
+        /* Read the stored path first to see if it is absolute. */
+        if (fread(base_path + dir_len, header.base_path_length, 1, fp) != 1) {
+            goto done;
+        }
+        if (base_path[dir_len] == '/') {
+            memmove(base_path, base_path + dir_len, header.base_path_length);
+            base_path[header.base_path_length] = '\0';
+        }
+        else {
+            memcpy(base_path, path, dir_len);
+            base_path[dir_len + header.base_path_length] = '\0';
+        }
+    }
+
+    chunks = (ia_eudoxus_delta_chunk_t *)malloc(
+        header.n_chunks * sizeof(*chunks));
+    if (chunks == NULL) {
+        result = IA_EUDOXUS_EALLOC;
+        goto done;
+    }
+    if (fread(chunks, sizeof(*chunks), header.n_chunks, fp) !=
+        header.n_chunks)
+    {
+        goto done;
+    }
+
+    data = (char *)malloc(header.automata_length);
+    if (data == NULL) {
+        result = IA_EUDOXUS_EALLOC;
+        goto done;
+    }
+
+    for (uint64_t i = 0; i < header.n_chunks; ++i) {
+        char   *dst = data + i * header.chunk_size;
+        size_t  expect =
+            (i + 1 < header.n_chunks)
+            ? header.chunk_size
+            : header.automata_length - i * header.chunk_size;
+
+        if (chunks[i].length != expect) {
+            goto done;
+        }
+
+        if (chunks[i].inline_data) {
+            /* Inline data follows the chunk table in chunk order. */
+            if (fread(dst, 1, expect, fp) != expect) {
+                goto done;
+            }
+        }
+        else {
+            if (base == NULL) {
+                base = fopen(base_path, "r");
+                if (base == NULL) {
+                    goto done;
+                }
+            }
+            if (fseeko(base, (off_t)(i * header.chunk_size), SEEK_SET) != 0 ||
+                fread(dst, 1, expect, base) != expect)
+            {
+                goto done;
+            }
+        }
+
+        /* Content address check: catches a stale or wrong base. */
+        if (ia_eudoxus_delta_hash((const uint8_t *)dst, expect) !=
+            chunks[i].hash)
+        {
+            goto done;
+        }
+    }
+
+    result = ia_eudoxus_create(out_eudoxus, data);
+    if (result == IA_EUDOXUS_OK) {
+        data = NULL;  /* Owned by the engine now. */
+    }
+
+done:
+    free(chunks);
+    free(base_path);
+    free(data);
+    if (base != NULL) {
+        fclose(base);
+    }
+    return result;
+}
+
+ia_eudoxus_result_t ia_eudoxus_create_from_path(
+    ia_eudoxus_t **out_eudoxus,
+    const char    *path
+)
+{
+    if (out_eudoxus == NULL || path == NULL) {
+        return IA_EUDOXUS_EINVAL;
+    }
+
+    /* Delta containers reassemble into a heap buffer. */
+    {
+        FILE *fp = fopen(path, "r");
+        uint32_t magic = 0;
+
+        if (fp != NULL) {
+            if (fread(&magic, sizeof(magic), 1, fp) == 1 &&
+                magic == IA_EUDOXUS_DELTA_MAGIC)
+            {
+                ia_eudoxus_result_t result;
+
+                rewind(fp);
+                result = ia_eudoxus_create_from_delta(out_eudoxus, path, fp);
+                fclose(fp);
+                return result;
+            }
+            fclose(fp);
+        }
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return IA_EUDOXUS_EINVAL;
+    }
+
+    /* Map regular files read-only: the mapping is page-aligned and backed
+     * by the page cache, so every worker mapping the same automata file
+     * shares one copy. */
+    struct stat file_info;
+    if (fstat(fd, &file_info) != 0 ||
+        ! S_ISREG(file_info.st_mode) ||
+        file_info.st_size <= 0)
+    {
+        close(fd);
+        return ia_eudoxus_create_from_path_read(out_eudoxus, path);
+    }
+
+    void *data = mmap(
+        NULL,
+        file_info.st_size,
+        PROT_READ,
+        MAP_PRIVATE,
+        fd,
+        0
+    );
+    close(fd);
+    if (data == MAP_FAILED) {
+        return ia_eudoxus_create_from_path_read(out_eudoxus, path);
+    }
+
+#ifdef MADV_WILLNEED
+    /* Advisory; failure is harmless. */
+    madvise(data, file_info.st_size, MADV_WILLNEED);
+#endif
+
+    ia_eudoxus_result_t result = ia_eudoxus_create(out_eudoxus, data);
+    if (result != IA_EUDOXUS_OK) {
+        munmap(data, file_info.st_size);
+        return result;
+    }
+
+    (*out_eudoxus)->automata_is_mmapped = true;
+    (*out_eudoxus)->automata_size       = file_info.st_size;
+
+    return IA_EUDOXUS_OK;
+}
+
 void ia_eudoxus_destroy(
     ia_eudoxus_t *eudoxus
 )
@@ -278,11 +580,18 @@ void ia_eudoxus_destroy(
     /* Better to cast away const here than to not have const checks for
      * all uses. */
     if (eudoxus->automata) {
-        free((void *)eudoxus->automata);
+        if (eudoxus->automata_is_mmapped) {
+            munmap((void *)eudoxus->automata, eudoxus->automata_size);
+        }
+        else {
+            free((void *)eudoxus->automata);
+        }
     }
     if (eudoxus->error_message != NULL && eudoxus->free_error_message) {
         free((void *)eudoxus->error_message);
     }
+    free((void *)eudoxus->output_runs);
+    free((void *)eudoxus->flat_outputs);
     free(eudoxus);
 }
 
@@ -323,6 +632,12 @@ ia_eudoxus_result_t ia_eudoxus_create_state(
         (char *)eudoxus->automata + eudoxus->automata->start_index
     );
     state->byte_index     = 0;
+    state->remaining_bytes = 0;
+    memset(&state->metrics, 0, sizeof(state->metrics));
+    state->progress_fn       = NULL;
+    state->progress_cbdata   = NULL;
+    state->progress_interval = 0;
+    state->progress_left     = 0;
 
     *out_state = state;
 
@@ -339,6 +654,41 @@ void ia_eudoxus_destroy_state(
     }
 }
 
+void ia_eudoxus_set_progress_callback(
+    ia_eudoxus_state_t       *state,
+    ia_eudoxus_progress_fn_t  fn,
+    void                     *cbdata,
+    size_t                    interval
+)
+{
+    assert(state != NULL);
+
+    state->progress_fn       = fn;
+    state->progress_cbdata   = cbdata;
+    state->progress_interval = (interval == 0) ? 1 : interval;
+    state->progress_left     = state->progress_interval;
+}
+
+void ia_eudoxus_metrics_get(
+    const ia_eudoxus_state_t *state,
+    ia_eudoxus_metrics_t     *metrics
+)
+{
+    assert(state   != NULL);
+    assert(metrics != NULL);
+
+    *metrics = state->metrics;
+}
+
+void ia_eudoxus_metrics_reset(
+    ia_eudoxus_state_t *state
+)
+{
+    assert(state != NULL);
+
+    memset(&state->metrics, 0, sizeof(state->metrics));
+}
+
 void ia_eudoxus_set_error(
     ia_eudoxus_t *eudoxus,
     char         *message
@@ -442,6 +792,24 @@ void ia_eudoxus_set_error_printf(
 
 /* End Specific Subengine Code */
 
+static ia_eudoxus_result_t ia_eudoxus_build_output_index(
+    ia_eudoxus_t *eudoxus
+)
+{
+    switch (eudoxus->automata->id_width) {
+    case 8:
+        return ia_eudoxus8_build_output_index(eudoxus);
+    case 4:
+        return ia_eudoxus4_build_output_index(eudoxus);
+    case 2:
+        return ia_eudoxus2_build_output_index(eudoxus);
+    case 1:
+        return ia_eudoxus1_build_output_index(eudoxus);
+    default:
+        return IA_EUDOXUS_EINCOMPAT;
+    }
+}
+
 static
 ia_eudoxus_result_t ia_eudoxus_execute_impl(
     ia_eudoxus_state_t *state,
@@ -482,6 +850,53 @@ ia_eudoxus_result_t ia_eudoxus_execute_without_output(
     return ia_eudoxus_execute_impl(state, input, input_length, false);
 }
 
+ia_eudoxus_result_t ia_eudoxus_execute_batch(
+    ia_eudoxus_state_t   *state,
+    const uint8_t *const *inputs,
+    const size_t         *input_lengths,
+    size_t                num_inputs
+)
+{
+    if (state == NULL || inputs == NULL || input_lengths == NULL) {
+        return IA_EUDOXUS_EINVAL;
+    }
+
+    /* Hoist the engine-width dispatch out of the per-block loop. */
+    ia_eudoxus_result_t (*execute)(
+        ia_eudoxus_state_t *,
+        const uint8_t      *,
+        size_t,
+        bool
+    );
+
+    switch (state->eudoxus->automata->id_width) {
+    case 8:
+        execute = ia_eudoxus8_execute;
+        break;
+    case 4:
+        execute = ia_eudoxus4_execute;
+        break;
+    case 2:
+        execute = ia_eudoxus2_execute;
+        break;
+    case 1:
+        execute = ia_eudoxus1_execute;
+        break;
+    default:
+        return IA_EUDOXUS_EINCOMPAT;
+    }
+
+    for (size_t i = 0; i < num_inputs; ++i) {
+        ia_eudoxus_result_t result =
+            execute(state, inputs[i], input_lengths[i], true);
+        if (result != IA_EUDOXUS_OK) {
+            return result;
+        }
+    }
+
+    return IA_EUDOXUS_OK;
+}
+
 ia_eudoxus_result_t ia_eudoxus_metadata(
     ia_eudoxus_t                   *eudoxus,
     ia_eudoxus_metadata_callback_t  callback,
@@ -34,7 +34,9 @@
 #endif
 #endif
 #include <boost/bind.hpp>
+#include <boost/exception_ptr.hpp>
 #include <boost/foreach.hpp>
+#include <boost/thread.hpp>
 #ifdef __clang__
 #pragma clang diagnostic pop
 #endif
@@ -858,6 +860,14 @@ void Compiler<id_width>::compile(
     );
 
     // Adapted BFS... Complicated by path compression nodes.
+    //
+    // The BFS emission order is also the cache layout: the start node
+    // and its shallow descendants -- where Aho-Corasick style matching
+    // spends nearly all of its transitions, since most input bytes fail
+    // back near the root -- occupy the front of the buffer and share
+    // pages and cache lines.  Reordering beyond this (e.g. hot-path
+    // clustering) would need per-node visit frequencies from production
+    // traffic, which the format does not carry today.
     queue<Intermediate::node_p> todo;
     set<Intermediate::node_p>   queued;
 
@@ -977,6 +987,59 @@ void Compiler<id_width>::compile(
     m_result.ids_used += m_node_id_map.size() + m_output_id_map.size();
 }
 
+/**
+ * Compile @a automata at a single id width, recording the outcome.
+ *
+ * Thread body for compile_minimal().  An out_of_range failure means the
+ * width was too small and is recorded as a simple non-success; any other
+ * exception is captured for rethrow on the calling thread.
+ *
+ * @param[in]  automata      Automata to compile.
+ * @param[in]  configuration Configuration with id_width already set.
+ * @param[out] result        Where to store a successful result.
+ * @param[out] success       Set to true iff compilation succeeded.
+ * @param[out] error         Set to the captured exception, if any.
+ */
+void try_compile_width(
+    const Intermediate::Automata* automata,
+    configuration_t               configuration,
+    result_t*                     result,
+    bool*                         success,
+    boost::exception_ptr*         error
+)
+{
+    try {
+        *result = compile(*automata, configuration);
+        *success = true;
+    }
+    catch (const out_of_range&) {
+        // Width too small; move on.
+    }
+    catch (...) {
+        *error = boost::current_exception();
+    }
+}
+
+/*
+ * On a bounded-memory (external-sort) compilation mode: evaluated and
+ * not pursued.  Compilation is not a streamable transform of the
+ * intermediate format: identifier assignment needs final byte offsets,
+ * which depend on the chosen id width and on edge encodings that
+ * themselves contain identifiers, so the compiler lays nodes out in
+ * BFS order while patching forward references across the whole output
+ * -- random access to the entire graph is structural, not incidental.
+ * The intermediate reader already streams its chunked protobuf, but
+ * must materialize the graph to resolve edges at all.
+ *
+ * The memory levers that do exist: compile with a fixed id_width
+ * (one compilation instead of compile_minimal's several), and note
+ * that compile_minimal runs its width candidates concurrently --
+ * trading peak memory for wall time -- so memory-constrained builds
+ * should prefer a fixed width or accept sequential candidates.
+ * Rebuilding at the edge is better served by shipping delta
+ * containers (see ironautomata/eudoxus_delta.h), which reduce
+ * distribution to bytes changed and need no compile at the edge.
+ */
 result_t compile_minimal(
     const Intermediate::Automata& automata,
     configuration_t               configuration
@@ -993,33 +1056,45 @@ result_t compile_minimal(
         );
     }
 
-    result_t result;
-    size_t i;
-
-    for (i = 0; i < c_num_id_widths; ++i) {
-        bool success = true;
-        try {
-            configuration.id_width = c_id_widths[i];
-            result = compile(automata, configuration);
-        }
-        catch (out_of_range) {
-            // move on to next id_width.
-            success = false;
+    // Compile every candidate width concurrently and keep the smallest
+    // width that fits.  The automata is only read during compilation, so
+    // the threads share it without synchronization.
+    result_t             results[c_num_id_widths];
+    bool                 successes[c_num_id_widths];
+    boost::exception_ptr errors[c_num_id_widths];
+    boost::thread_group  threads;
+
+    for (size_t i = 0; i < c_num_id_widths; ++i) {
+        successes[i] = false;
+        configuration.id_width = c_id_widths[i];
+        threads.create_thread(boost::bind(
+            try_compile_width,
+            &automata,
+            configuration,
+            &results[i],
+            &successes[i],
+            &errors[i]
+        ));
+    }
+    threads.join_all();
+
+    // Report outcomes in increasing width order, as the sequential
+    // version did: an unexpected error at a smaller width takes
+    // precedence over a success at a larger one.
+    for (size_t i = 0; i < c_num_id_widths; ++i) {
+        if (errors[i]) {
+            boost::rethrow_exception(errors[i]);
         }
-        if (success) {
-            break;
+        if (successes[i]) {
+            return results[i];
         }
     }
 
-    if (i == c_num_id_widths) {
-        throw logic_error(
-            "Insanity error.  "
-            "Could not fit automata in 2**8 bytes?  "
-            "Please report as bug."
-        );
-    }
-
-    return result; // RVO
+    throw logic_error(
+        "Insanity error.  "
+        "Could not fit automata in 2**8 bytes?  "
+        "Please report as bug."
+    );
 }
 
 } // Anonymous
@@ -123,6 +123,7 @@ ia_eudoxus_result_t IA_EUDOXUS(next_low)(
         if (has_default) {
             next_node            = default_node;
             advance_on_next_node = advance_on_default;
+            ++state->metrics.default_transitions;
         }
         else {
             return IA_EUDOXUS_END;
@@ -233,6 +234,7 @@ ia_eudoxus_result_t IA_EUDOXUS(next_high)(
         if (has_default) {
             next_node            = default_node;
             advance_on_next_node = advance_on_default;
+            ++state->metrics.default_transitions;
         }
         else {
             return IA_EUDOXUS_END;
@@ -331,6 +333,7 @@ ia_eudoxus_result_t IA_EUDOXUS(next_pc)(
     else if (has_default) {
         next_node = default_node;
         advance_on_next_node = advance_on_default;
+        ++state->metrics.default_transitions;
     }
     else {
         return IA_EUDOXUS_END;
@@ -436,6 +439,114 @@ ia_eudoxus_result_t IA_EUDOXUS(next)(
  * @param[in,out] state Current state.
  * @return See ia_eudoxus_execute() for return codes meanings.
  */
+/**
+ * Validate and flatten the automata's output chains at load.
+ *
+ * Walks every output-list element, following its chain and recording
+ * the automata offsets of the reachable outputs as a contiguous run,
+ * so match processing iterates an array instead of chasing linked ids
+ * through the blob.  Chains sharing tails are flattened per element;
+ * the combined size is capped at four times the element count so a
+ * pathological sharing pattern cannot blow up memory -- past the cap,
+ * or on any structurally invalid chain (misaligned or out-of-range id,
+ * cycle), the index is abandoned and the runtime chain walk stays in
+ * use, exactly as before.
+ *
+ * @param[in,out] eudoxus Engine to index; on success takes ownership
+ *                of the built arrays.
+ * @return IA_EUDOXUS_OK (an abandoned index is not an error) or
+ *         IA_EUDOXUS_EALLOC.
+ */
+static
+ia_eudoxus_result_t IA_EUDOXUS(build_output_index)(
+    ia_eudoxus_t *eudoxus
+)
+{
+    const ia_eudoxus_automata_t *automata = eudoxus->automata;
+    const size_t   entry_sz = sizeof(IA_EUDOXUS(output_list_t));
+    const uint64_t n        = automata->num_output_lists;
+
+    ia_eudoxus_output_run_t *runs;
+    uint64_t                *flat;
+    uint64_t                 flat_cap;
+    uint64_t                 flat_used = 0;
+
+    if (n == 0 || n > UINT32_MAX / 4) {
+        return IA_EUDOXUS_OK;
+    }
+    flat_cap = 4 * n;
+
+    runs = (ia_eudoxus_output_run_t *)malloc(n * sizeof(*runs));
+    flat = (uint64_t *)malloc(flat_cap * sizeof(*flat));
+    if (runs == NULL || flat == NULL) {
+        free(runs);
+        free(flat);
+        return IA_EUDOXUS_EALLOC;
+    }
+
+    for (uint64_t i = 0; i < n; ++i) {
+        IA_EUDOXUS_ID_T id =
+            (IA_EUDOXUS_ID_T)(automata->first_output_list + i * entry_sz);
+        uint64_t steps = 0;
+
+        runs[i].start = (uint32_t)flat_used;
+        runs[i].count = 0;
+
+        while (id != 0) {
+            uint64_t output;
+
+            if (++steps > n + 1) {
+                /* Cycle; abandon the index. */
+                goto abandon;
+            }
+
+            if (id < automata->first_output_list) {
+                /* Direct output terminates the chain. */
+                output = id;
+                id = 0;
+            }
+            else {
+                uint64_t off = id - automata->first_output_list;
+                const IA_EUDOXUS(output_list_t) *entry;
+
+                if (off % entry_sz != 0 || off / entry_sz >= n) {
+                    goto abandon;
+                }
+                entry = (const IA_EUDOXUS(output_list_t) *)(
+                    (const char *)automata + id
+                );
+                if (entry->output == 0) {
+                    goto abandon;
+                }
+                output = entry->output;
+                id = entry->next_output;
+            }
+
+            if (output < automata->first_output ||
+                output >= automata->first_output_list)
+            {
+                goto abandon;
+            }
+            if (flat_used >= flat_cap) {
+                /* Tail sharing past the memory budget. */
+                goto abandon;
+            }
+            flat[flat_used] = output;
+            ++flat_used;
+            ++runs[i].count;
+        }
+    }
+
+    eudoxus->output_runs  = runs;
+    eudoxus->flat_outputs = flat;
+    return IA_EUDOXUS_OK;
+
+abandon:
+    free(runs);
+    free(flat);
+    return IA_EUDOXUS_OK;
+}
+
 static
 ia_eudoxus_result_t IA_EUDOXUS(output)(
     ia_eudoxus_state_t *state
@@ -484,6 +595,43 @@ ia_eudoxus_result_t IA_EUDOXUS(output)(
         return IA_EUDOXUS_EINVAL;
     }
 
+    /* Flattened fast path: iterate the precomputed run for this chain
+     * instead of chasing output-list ids through the blob.  Direct
+     * single outputs and automata without an index use the chain walk
+     * below. */
+    if (output_list >= state->eudoxus->automata->first_output_list &&
+        state->eudoxus->output_runs != NULL)
+    {
+        const uint64_t idx =
+            (output_list - state->eudoxus->automata->first_output_list) /
+            sizeof(IA_EUDOXUS(output_list_t));
+
+        if (idx < state->eudoxus->automata->num_output_lists) {
+            const ia_eudoxus_output_run_t *run =
+                &state->eudoxus->output_runs[idx];
+
+            for (uint32_t i = 0; i < run->count; ++i) {
+                const ia_eudoxus_output_t *output_obj =
+                    (const ia_eudoxus_output_t *)(
+                        (const char *)(state->eudoxus->automata) +
+                        state->eudoxus->flat_outputs[run->start + i]
+                    );
+                ++state->metrics.outputs_fired;
+                ia_eudoxus_command_t command = state->callback(
+                    state->eudoxus,
+                    output_obj->data,
+                    output_obj->length,
+                    state->input_location,
+                    state->callback_data
+                );
+                if (command != IA_EUDOXUS_CMD_CONTINUE) {
+                    return (ia_eudoxus_result_t)command;
+                }
+            }
+            return IA_EUDOXUS_OK;
+        }
+    }
+
     while (output_list != 0) {
         const ia_eudoxus_output_t *output_obj = 0;
         if (output_list < state->eudoxus->automata->first_output_list) {
@@ -507,6 +655,7 @@ ia_eudoxus_result_t IA_EUDOXUS(output)(
             );
             output_list = output_list_obj->next_output;
         }
+        ++state->metrics.outputs_fired;
         ia_eudoxus_command_t command = state->callback(
             state->eudoxus,
             output_obj->data,
@@ -572,31 +721,53 @@ ia_eudoxus_result_t IA_EUDOXUS(execute)(
         return IA_EUDOXUS_OK;
     }
 
-    while (state->remaining_bytes > 0) {
-        ia_eudoxus_result_t result = IA_EUDOXUS_OK;
-
-        /* Update state, including state->remaining_bytes */
-        const uint8_t* old_input_location = state->input_location;
-        result = IA_EUDOXUS(next)(state);
-        if (result != IA_EUDOXUS_OK) {
-            return result;
-        }
+    {
+        const size_t        start_remaining = state->remaining_bytes;
+        ia_eudoxus_result_t final_result    = IA_EUDOXUS_OK;
+
+        while (state->remaining_bytes > 0) {
+            ia_eudoxus_result_t result = IA_EUDOXUS_OK;
+
+            /* Cooperative cancellation point, roughly per input byte
+             * consumed; one predictable branch when unregistered. */
+            if (state->progress_fn != NULL) {
+                if (--state->progress_left == 0) {
+                    state->progress_left = state->progress_interval;
+                    if (! state->progress_fn(state->progress_cbdata)) {
+                        final_result = IA_EUDOXUS_CANCELLED;
+                        break;
+                    }
+                }
+            }
 
-        /* Call callback. */
-        if (
-            with_output &&
-            state->callback != NULL &&
-            ( ! state->eudoxus->automata->no_advance_no_output ||
-              state->input_location != old_input_location )
-        ) {
-            result = IA_EUDOXUS(output)(state);
+            /* Update state, including state->remaining_bytes */
+            const uint8_t* old_input_location = state->input_location;
+            result = IA_EUDOXUS(next)(state);
             if (result != IA_EUDOXUS_OK) {
-                return result;
+                final_result = result;
+                break;
+            }
+            ++state->metrics.nodes_visited;
+
+            /* Call callback. */
+            if (
+                with_output &&
+                state->callback != NULL &&
+                ( ! state->eudoxus->automata->no_advance_no_output ||
+                  state->input_location != old_input_location )
+            ) {
+                result = IA_EUDOXUS(output)(state);
+                if (result != IA_EUDOXUS_OK) {
+                    final_result = result;
+                    break;
+                }
             }
         }
-    }
 
-    return IA_EUDOXUS_OK;
+        state->metrics.bytes_consumed +=
+            start_remaining - state->remaining_bytes;
+        return final_result;
+    }
 }
 
 /** @} IronAutomataEudoxusAutomata */
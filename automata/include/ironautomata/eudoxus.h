@@ -72,7 +72,8 @@ enum ia_eudoxus_result_t
     IA_EUDOXUS_EINVAL,    /**< Invalid input. */
     IA_EUDOXUS_EALLOC,    /**< Allocation failure. */
     IA_EUDOXUS_EINCOMPAT, /**< Not compatible with engine. */
-    IA_EUDOXUS_EINSANE    /**< Insanity error; please report as bug. */
+    IA_EUDOXUS_EINSANE,   /**< Insanity error; please report as bug. */
+    IA_EUDOXUS_CANCELLED  /**< Progress callback canceled execution. */
 };
 typedef enum ia_eudoxus_result_t ia_eudoxus_result_t;
 
@@ -136,9 +137,12 @@ ia_eudoxus_result_t ia_eudoxus_create_from_file(
 /**
  * As above, but load automata from a file in the file system.
  *
- * This method will attempt to read the file at @a path and load the entire
- * file in @a path as a Eudoxus automata.  See ia_eudoxus_create() for
- * further discussion.
+ * This method will attempt to memory map the file at @a path read-only;
+ * the mapping is page-aligned and backed by the page cache, so all
+ * workers loading the same automata file share a single copy.  If the
+ * file can not be mapped, e.g., it is not a regular file, the entire
+ * file is read into memory instead.  See ia_eudoxus_create() for further
+ * discussion.
  *
  * @param[out] out_eudoxus Variable to hold pointer to created engine.
  * @param[in]  path        Path to file on disk holding automata.
@@ -313,6 +317,75 @@ void ia_eudoxus_destroy_state(
     ia_eudoxus_state_t *state
 );
 
+/**
+ * Progress callback; see ia_eudoxus_set_progress_callback().
+ *
+ * @param[in] cbdata Callback data given at registration.
+ * @returns Nonzero to continue execution, 0 to cancel it.
+ */
+typedef int (*ia_eudoxus_progress_fn_t)(void *cbdata);
+
+/**
+ * Register a cooperative cancellation point on @a state.
+ *
+ * During ia_eudoxus_execute(), @a fn is called after roughly every
+ * @a interval input bytes; returning 0 makes the execution return
+ * IA_EUDOXUS_CANCELLED immediately, so a caller can abandon a long
+ * scan (a large body, for instance) when a deadline passes instead of
+ * only between calls.  State and metrics remain valid; the caller may
+ * resume by calling execute again, though typically it will not.
+ *
+ * Pass a NULL @a fn to remove the callback.  Unregistered states pay
+ * one predictable branch per input byte.
+ *
+ * @param[in] state State to register on.
+ * @param[in] fn Callback, or NULL to remove.
+ * @param[in] cbdata Callback data.
+ * @param[in] interval Input bytes between calls; 0 behaves as 1.
+ */
+void ia_eudoxus_set_progress_callback(
+    ia_eudoxus_state_t       *state,
+    ia_eudoxus_progress_fn_t  fn,
+    void                     *cbdata,
+    size_t                    interval
+);
+
+/**
+ * Execution metrics, accumulated per state.
+ *
+ * Counters are maintained unconditionally -- the cost is an increment
+ * alongside the work counted -- and accumulate across calls to
+ * ia_eudoxus_execute() until reset.  A high nodes-visited or
+ * default-transition rate relative to bytes consumed indicates an
+ * automata pathologically mismatched to its traffic.
+ */
+typedef struct ia_eudoxus_metrics_t {
+    uint64_t bytes_consumed;      /**< Input bytes advanced over. */
+    uint64_t nodes_visited;       /**< Successful node transitions. */
+    uint64_t outputs_fired;       /**< Output callbacks invoked. */
+    uint64_t default_transitions; /**< Default (failure) edges taken. */
+} ia_eudoxus_metrics_t;
+
+/**
+ * Copy @a state's accumulated metrics to @a metrics.
+ *
+ * @param[in] state State to read.
+ * @param[out] metrics Filled with the current counters.
+ */
+void ia_eudoxus_metrics_get(
+    const ia_eudoxus_state_t *state,
+    ia_eudoxus_metrics_t     *metrics
+);
+
+/**
+ * Reset @a state's accumulated metrics to zero.
+ *
+ * @param[in] state State to reset.
+ */
+void ia_eudoxus_metrics_reset(
+    ia_eudoxus_state_t *state
+);
+
 /**
  * Execute automata on a @a input.
  *
@@ -379,6 +452,33 @@ ia_eudoxus_result_t ia_eudoxus_execute_without_output(
     size_t              input_length
 );
 
+/**
+ * Execute automata on a sequence of input blocks.
+ *
+ * Semantically identical to calling ia_eudoxus_execute() once per block,
+ * but the engine-width dispatch happens once for the whole batch.  This is
+ * intended for callers that hold input as a chain of buffers, e.g. stream
+ * data chunks, and would otherwise pay the per-call overhead for every
+ * chunk.
+ *
+ * Execution stops at the first block that does not return IA_EUDOXUS_OK;
+ * the state then reflects the progress made up to that point, and
+ * execution may be resumed as described for ia_eudoxus_execute().
+ *
+ * @param[in,out] state         State of automata.
+ * @param[in]     inputs        Array of input blocks.
+ * @param[in]     input_lengths Length of each block of @a inputs.
+ * @param[in]     num_inputs    Number of blocks.
+ * @return As ia_eudoxus_execute(); IA_EUDOXUS_OK only if every block was
+ *         fully consumed.
+ */
+ia_eudoxus_result_t ia_eudoxus_execute_batch(
+    ia_eudoxus_state_t   *state,
+    const uint8_t *const *inputs,
+    const size_t         *input_lengths,
+    size_t                num_inputs
+);
+
 /**
  * Set error for @a eudoxus to @a message (claim ownership version).
  *
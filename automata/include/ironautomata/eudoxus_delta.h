@@ -0,0 +1,106 @@
+/*****************************************************************************
+ * Licensed to Qualys, Inc. (QUALYS) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * QUALYS licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#ifndef _IA_EUDOXUS_DELTA_H_
+#define _IA_EUDOXUS_DELTA_H_
+
+/**
+ * @file
+ * @brief IronAutomata --- Eudoxus Delta Container Format
+ *
+ * A delta container describes an automata as a sequence of fixed-size,
+ * content-addressed chunks.  Chunks whose content is unchanged from a
+ * base automata file are referenced (the loader reads them from the
+ * base at the same offset and verifies their hash); changed chunks are
+ * carried inline.  Distribution then ships only the container, whose
+ * size is proportional to what changed, and
+ * ia_eudoxus_create_from_path() reassembles the full automata
+ * transparently.
+ *
+ * Containers are produced by the eudoxus_delta tool from a base and a
+ * new automata file.  Like the automata format itself, the container
+ * uses host byte order; delta distribution assumes a homogeneous
+ * fleet, as automata distribution already does.
+ *
+ * Layout:
+ *
+ * @code
+ * ia_eudoxus_delta_header_t
+ * char base_path[base_path_length]      (not NUL terminated)
+ * ia_eudoxus_delta_chunk_t chunks[n_chunks]
+ * inline chunk data, in chunk order, for chunks with inline_data set
+ * @endcode
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Container magic: "IAEC". */
+#define IA_EUDOXUS_DELTA_MAGIC 0x49414543
+
+/** Container format version. */
+#define IA_EUDOXUS_DELTA_VERSION 1
+
+/** Default chunk size used by the eudoxus_delta tool. */
+#define IA_EUDOXUS_DELTA_DEFAULT_CHUNK (1024 * 1024)
+
+/** Container header. */
+typedef struct {
+    uint32_t magic;            /**< IA_EUDOXUS_DELTA_MAGIC. */
+    uint32_t version;          /**< IA_EUDOXUS_DELTA_VERSION. */
+    uint64_t automata_length;  /**< Length of the reassembled automata. */
+    uint64_t chunk_size;       /**< Chunk size; final chunk may be short. */
+    uint64_t n_chunks;         /**< Number of chunks. */
+    uint32_t base_path_length; /**< Length of the base path that follows. */
+    uint32_t reserved;         /**< Zero. */
+} ia_eudoxus_delta_header_t;
+
+/** Per-chunk entry.  Chunk i covers [i * chunk_size, ...). */
+typedef struct {
+    uint64_t hash;        /**< FNV-1a 64 of the chunk content. */
+    uint64_t length;      /**< Content length; chunk_size except last. */
+    uint8_t  inline_data; /**< 1: data in container; 0: read from base. */
+    uint8_t  pad[7];      /**< Zero. */
+} ia_eudoxus_delta_chunk_t;
+
+/**
+ * FNV-1a 64-bit hash; the container's content address.
+ */
+static inline uint64_t ia_eudoxus_delta_hash(
+    const uint8_t *data,
+    size_t         length
+)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _IA_EUDOXUS_DELTA_H_ */
@@ -78,6 +78,7 @@
 #include <clipp/ironbee.hpp>
 #include <clipp/limit_modifier.hpp>
 #include <clipp/modsec_audit_log_generator.hpp>
+#include <clipp/latency_consumer.hpp>
 #include <clipp/null_consumer.hpp>
 #include <clipp/parse_modifier.hpp>
 #include <clipp/pb_consumer.hpp>
@@ -91,6 +92,7 @@
 #include <clipp/raw_consumer.hpp>
 #include <clipp/raw_generator.hpp>
 #include <clipp/select_modifier.hpp>
+#include <clipp/shard_modifier.hpp>
 #include <clipp/split_modifier.hpp>
 #include <clipp/suricata_generator.hpp>
 #include <clipp/time_modifier.hpp>
@@ -256,6 +258,7 @@ component_t construct_ironbee_modifier(const string& arg);
  *                are ranges: @a i-j.
  **/
 component_t construct_select_modifier(const string& arg);
+component_t construct_shard_modifier(const string& arg);
 
 /**
  * Construct set modifier.
@@ -335,6 +338,7 @@ void help()
     "Consumers:\n"
     "  ironbee:<path>  -- Internal IronBee using <path> as configuration.\n"
     "  ironbee_threaded:<path>:<n> -- Internal IronBee using <n> threads\n"
+    "  ironbee_latency:<path> -- Internal IronBee; report latency/throughput\n"
     "                                 and <path> as configuration.\n"
     "  writepb:<path>  -- Output to protobuf file at <path>.\n"
     "  writehtp:<path> -- Output in HTP test format at <path>.\n"
@@ -608,6 +612,7 @@ int main(int argc, char** argv)
     // Declare consumers.
     component_factory_map_t consumer_factory_map = boost::assign::map_list_of
         ("ironbee",  construct_component<IronBeeConsumer>)
+        ("ironbee_latency", construct_component<LatencyConsumer>)
         ("ironbee_threaded",  construct_ironbee_threaded_consumer)
         ("writepb",  construct_component<PBConsumer>)
         ("writehtp", construct_component<HTPConsumer>)
@@ -632,6 +637,7 @@ int main(int argc, char** argv)
         ("edit",            construct_component<EditModifier>)
         ("limit",           construct_component<LimitModifier, size_t>)
         ("select",          construct_select_modifier)
+        ("shard",           construct_shard_modifier)
         ("set",             construct_set_add_modifier<SetModifier::REPLACE_EXISTING>)
         ("add",             construct_set_add_modifier<SetModifier::ADD>)
         ("addmissing",      construct_set_add_modifier<SetModifier::ADD_MISSING>)
@@ -1034,6 +1040,25 @@ component_t construct_splitheader_modifier(const string& arg)
     );
 }
 
+component_t construct_shard_modifier(const string& arg)
+{
+    vector<string> subargs = split_on_char(arg, '/');
+    if (subargs.size() != 2) {
+        throw runtime_error("@shard requires an argument of the form i/n.");
+    }
+    size_t shard;
+    size_t n_shards;
+    try {
+        shard    = boost::lexical_cast<size_t>(subargs[0]);
+        n_shards = boost::lexical_cast<size_t>(subargs[1]);
+    }
+    catch (boost::bad_lexical_cast&) {
+        throw runtime_error("@shard requires numeric i/n.");
+    }
+
+    return ShardModifier(shard, n_shards);
+}
+
 component_t construct_select_modifier(const string& arg)
 {
     if (arg.empty()) {
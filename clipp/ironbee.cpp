@@ -37,6 +37,8 @@
 #endif
 #include <boost/make_shared.hpp>
 #include <boost/thread.hpp>
+
+#include <deque>
 #ifdef __clang__
 #pragma clang diagnostic pop
 #endif
@@ -475,6 +477,14 @@ ib_status_t clipp_close(
 } // extern "C"
 
 // Move to new file?
+//
+// This pool is the only multi-transaction scheduler in the tree: the
+// engine itself is a passive library and every server (nginx, ATS,
+// httpd) supplies its own threading, so a work-stealing scheduler
+// module has no place to live in production deployments.  Within this
+// pool, work stealing would also buy nothing: all workers pull from one
+// shared bounded queue, which is the degenerate (and contention-wise
+// cheaper, at these worker counts) form of stealing.
 template <typename WorkType>
 class FunctionWorkerPool :
     private boost::noncopyable
@@ -483,29 +493,21 @@ class FunctionWorkerPool :
 
     void do_work()
     {
-        WorkType local_work;
         for (;;) {
+            WorkType local_work;
             {
                 lock_t lock(m_mutex);
-                ++m_num_workers_available;
-
-            }
-            m_worker_available_cv.notify_one();
-
-            {
-                lock_t lock(m_mutex);
-                while (! m_work_available) {
+                while (m_queue.empty() && ! m_shutdown) {
                     m_work_available_cv.wait(lock);
-                    if (m_shutdown) {
-                        return;
-                    }
                 }
-
-                local_work = m_work;
-                m_work_available = false;
-                --m_num_workers_available;
+                if (m_queue.empty()) {
+                    /* Shutdown and drained. */
+                    return;
+                }
+                local_work = m_queue.front();
+                m_queue.pop_front();
             }
-            m_work_accepted_barrier.wait();
+            m_space_available_cv.notify_one();
 
             m_work_function(local_work);
         }
@@ -518,9 +520,9 @@ public:
     ) :
         m_num_workers(num_workers),
         m_work_function(work_function),
-        m_work_accepted_barrier(2),
-        m_num_workers_available(0),
-        m_work_available(false),
+        // Enough depth that the producer stays ahead of the workers
+        // without a rendezvous per item.
+        m_max_queue(2 * num_workers + 1),
         m_shutdown(false)
     {
         for (size_t i = 0; i < num_workers; ++i) {
@@ -536,28 +538,20 @@ public:
         {
             lock_t lock(m_mutex);
 
-            while (m_num_workers_available == 0) {
-                m_worker_available_cv.wait(lock);
+            while (m_queue.size() >= m_max_queue) {
+                m_space_available_cv.wait(lock);
             }
-
-            m_work           = work;
-            m_work_available = true;
-
-            m_work_available_cv.notify_one();
+            m_queue.push_back(work);
         }
-        m_work_accepted_barrier.wait();
+        m_work_available_cv.notify_one();
     }
 
     void shutdown()
     {
         {
             lock_t lock(m_mutex);
-            while (m_num_workers_available < m_num_workers) {
-                m_worker_available_cv.wait(lock);
-            }
+            m_shutdown = true;
         }
-
-        m_shutdown = true;
         m_work_available_cv.notify_all();
 
         m_thread_group.join_all();
@@ -568,14 +562,12 @@ private:
     boost::function<void(WorkType)> m_work_function;
 
     boost::mutex                    m_mutex;
-    boost::condition_variable       m_worker_available_cv;
     boost::condition_variable       m_work_available_cv;
-    boost::barrier                  m_work_accepted_barrier;
+    boost::condition_variable       m_space_available_cv;
     boost::thread_group             m_thread_group;
-    size_t                          m_num_workers_available;
-    bool                            m_work_available;
+    std::deque<WorkType>            m_queue;
+    size_t                          m_max_queue;
     bool                            m_shutdown;
-    WorkType                        m_work;
 };
 
 } // Anonymous
@@ -0,0 +1,194 @@
+/*****************************************************************************
+ * Licensed to Qualys, Inc. (QUALYS) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * QUALYS licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+/**
+ * @file
+ * @brief IronBee --- CLIPP Latency Consumer Implementation
+ *
+ * @author Christopher Alfeld <calfeld@qualys.com>
+ */
+
+#include "latency_consumer.hpp"
+#include "ironbee.hpp"
+
+#include <boost/make_shared.hpp>
+
+#include <iomanip>
+#include <iostream>
+
+#include <stdint.h>
+#include <time.h>
+
+using namespace std;
+
+namespace IronBee {
+namespace CLIPP {
+
+namespace {
+
+//! Linear sub-buckets per power-of-two major bucket.
+const size_t c_sub_buckets = 16;
+//! Major (power of two of nanoseconds) buckets.
+const size_t c_major_buckets = 48;
+
+//! Current monotonic time in nanoseconds.
+uint64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+//! Index of the highest set bit of @a v; 0 for v == 0.
+size_t high_bit(uint64_t v)
+{
+    size_t bit = 0;
+    while (v >>= 1) {
+        ++bit;
+    }
+    return bit;
+}
+
+} // Anonymous
+
+struct LatencyConsumer::State
+{
+    explicit
+    State(const std::string& config_path) :
+        consumer(config_path),
+        total(0),
+        max_ns(0),
+        first_start_ns(0),
+        last_end_ns(0)
+    {
+        fill(
+            buckets, buckets + c_major_buckets * c_sub_buckets,
+            uint64_t(0)
+        );
+    }
+
+    ~State()
+    {
+        report();
+    }
+
+    //! Record one latency sample.
+    void record(uint64_t ns)
+    {
+        size_t major = high_bit(ns);
+        size_t minor = 0;
+
+        if (major >= c_major_buckets) {
+            major = c_major_buckets - 1;
+            minor = c_sub_buckets - 1;
+        }
+        else if (major >= 4) {
+            /* Top four bits below the high bit select the sub-bucket. */
+            minor = (ns >> (major - 4)) & (c_sub_buckets - 1);
+        }
+        ++buckets[major * c_sub_buckets + minor];
+        ++total;
+        if (ns > max_ns) {
+            max_ns = ns;
+        }
+    }
+
+    //! Representative (lower bound) value of a bucket in nanoseconds.
+    static uint64_t bucket_value(size_t idx)
+    {
+        size_t major = idx / c_sub_buckets;
+        size_t minor = idx % c_sub_buckets;
+
+        if (major < 4) {
+            return uint64_t(1) << major;
+        }
+        return (uint64_t(1) << major) |
+               (uint64_t(minor) << (major - 4));
+    }
+
+    //! Value at or below which @a fraction of samples fall.
+    uint64_t percentile(double fraction) const
+    {
+        uint64_t needed = uint64_t(fraction * total);
+        uint64_t seen   = 0;
+
+        for (size_t i = 0; i < c_major_buckets * c_sub_buckets; ++i) {
+            seen += buckets[i];
+            if (seen >= needed && buckets[i] > 0) {
+                return bucket_value(i);
+            }
+        }
+        return max_ns;
+    }
+
+    //! Write the percentile report to stderr.
+    void report() const
+    {
+        if (total == 0) {
+            cerr << "clipp latency: no samples." << endl;
+            return;
+        }
+        cerr << "clipp latency: " << total << " inputs" << fixed
+             << setprecision(3)
+             << "  p50="   << percentile(0.50)  / 1e6 << "ms"
+             << "  p90="   << percentile(0.90)  / 1e6 << "ms"
+             << "  p99="   << percentile(0.99)  / 1e6 << "ms"
+             << "  p99.9=" << percentile(0.999) / 1e6 << "ms"
+             << "  max="   << max_ns            / 1e6 << "ms"
+             << endl;
+
+        /* End to end throughput over the whole run. */
+        if (last_end_ns > first_start_ns) {
+            double seconds = (last_end_ns - first_start_ns) / 1e9;
+            cerr << "clipp throughput: " << setprecision(1)
+                 << (double(total) / seconds) << " inputs/s over "
+                 << setprecision(3) << seconds << "s"
+                 << endl;
+        }
+    }
+
+    IronBeeConsumer consumer;
+    uint64_t        buckets[c_major_buckets * c_sub_buckets];
+    uint64_t        total;
+    uint64_t        max_ns;
+    uint64_t        first_start_ns; /**< Start of the first input. */
+    uint64_t        last_end_ns;    /**< End of the latest input. */
+};
+
+LatencyConsumer::LatencyConsumer(const std::string& config_path) :
+    m_state(boost::make_shared<State>(config_path))
+{
+    // nop
+}
+
+bool LatencyConsumer::operator()(const Input::input_p& input)
+{
+    const uint64_t start = now_ns();
+    const bool     result = m_state->consumer(input);
+    const uint64_t end = now_ns();
+
+    if (m_state->first_start_ns == 0) {
+        m_state->first_start_ns = start;
+    }
+    m_state->last_end_ns = end;
+    m_state->record(end - start);
+
+    return result;
+}
+
+} // CLIPP
+} // IronBee
@@ -0,0 +1,61 @@
+/*****************************************************************************
+ * Licensed to Qualys, Inc. (QUALYS) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * QUALYS licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+/**
+ * @file
+ * @brief IronBee --- CLIPP Latency Consumer
+ *
+ * @author Christopher Alfeld <calfeld@qualys.com>
+ */
+
+#ifndef __IRONBEE_CLIPP__LATENCY_CONSUMER__
+#define __IRONBEE_CLIPP__LATENCY_CONSUMER__
+
+#include <clipp/input.hpp>
+
+#include <boost/shared_ptr.hpp>
+
+namespace IronBee {
+namespace CLIPP {
+
+/**
+ * CLIPP consumer that times an internal IronBee engine per input.
+ *
+ * As IronBeeConsumer, but the wall time of each input's dispatch is
+ * recorded in a log-scaled histogram (power-of-two major buckets with
+ * linear sub-buckets, HDR style).  A percentile report (p50, p90, p99,
+ * p99.9, max) and the end-to-end throughput over the run are written
+ * to stderr when the consumer is destroyed, making this the transaction
+ * throughput benchmark for any clipp generator chain.
+ **/
+class LatencyConsumer
+{
+public:
+    explicit
+    LatencyConsumer(const std::string& config_path);
+
+    bool operator()(const Input::input_p& input);
+
+private:
+    struct State;
+    boost::shared_ptr<State> m_state;
+};
+
+} // CLIPP
+} // IronBee
+
+#endif
@@ -53,6 +53,8 @@
 #include <netinet/in.h>
 #endif
 
+#include <zlib.h>
+
 using namespace std;
 
 namespace IronBee {
@@ -220,17 +222,50 @@ struct PBConsumer::State
         if (! output) {
             throw runtime_error("Could not open " + path + " for writing.");
         }
+        init_zlib();
     }
 
     explicit
     State(ostream* out) :
         output(out)
     {
-        // nop
+        init_zlib();
+    }
+
+    ~State()
+    {
+        if (zlib_ok) {
+            deflateEnd(&zs);
+        }
+    }
+
+    //! Initialize the reused deflate stream (gzip format, as
+    //! GzipOutputStream produced, so existing readers are unaffected).
+    void init_zlib()
+    {
+        memset(&zs, 0, sizeof(zs));
+        zlib_ok = (deflateInit2(
+            &zs,
+            Z_DEFAULT_COMPRESSION,
+            Z_DEFLATED,
+            15 + 16,  /* gzip wrapper */
+            8,
+            Z_DEFAULT_STRATEGY) == Z_OK);
     }
 
     boost::scoped_ptr<ofstream> file;
     ostream* output;
+
+    /* Reused across inputs: the message tree retains its allocated
+     * submessages and string capacity over Clear(), and the buffers
+     * and deflate state retain theirs, so steady-state recording makes
+     * no per-input allocations beyond payload growth.  (The bundled
+     * protobuf predates arenas; message reuse is its equivalent.) */
+    PB::Input   pb_input;    //!< Reused message tree.
+    std::string plain;       //!< Reused serialization buffer.
+    std::string compressed;  //!< Reused compression buffer.
+    z_stream    zs;          //!< Reused deflate state.
+    bool        zlib_ok;     //!< Deflate state initialized.
 };
 
 PBConsumer::PBConsumer()
@@ -256,8 +291,9 @@ bool PBConsumer::operator()(const Input::input_p& input)
         return false;
     }
 
-    PB::Input pb_input;
+    PB::Input& pb_input = m_state->pb_input;
 
+    pb_input.Clear();
     if (! input->id.empty()) {
         pb_input.set_id(input->id);
     }
@@ -300,19 +336,43 @@ bool PBConsumer::operator()(const Input::input_p& input)
         event->dispatch(delegate);
     }
 
-    string buffer;
-    google::protobuf::io::StringOutputStream output(&buffer);
-    google::protobuf::io::GzipOutputStream zipped_output(&output);
+    /* Serialize into the reused buffer, then gzip with the reused
+     * deflate state; both keep their capacity across inputs. */
+    if (! pb_input.SerializeToString(&m_state->plain)) {
+        return false;
+    }
+
+    if (! m_state->zlib_ok) {
+        return false;
+    }
 
-    pb_input.SerializeToZeroCopyStream(&zipped_output);
-    zipped_output.Close();
+    {
+        string& out = m_state->compressed;
+        size_t  bound;
 
-    uint32_t size = buffer.length();
-    uint32_t nsize = htonl(size);
-    m_state->output->write(
-        reinterpret_cast<const char*>(&nsize), sizeof(uint32_t)
-    );
-    m_state->output->write(buffer.data(), size);
+        deflateReset(&m_state->zs);
+        bound = deflateBound(&m_state->zs, m_state->plain.size());
+        if (out.size() < bound) {
+            out.resize(bound);
+        }
+
+        m_state->zs.next_in =
+            reinterpret_cast<Bytef*>(const_cast<char*>(m_state->plain.data()));
+        m_state->zs.avail_in = m_state->plain.size();
+        m_state->zs.next_out = reinterpret_cast<Bytef*>(&out[0]);
+        m_state->zs.avail_out = out.size();
+
+        if (deflate(&m_state->zs, Z_FINISH) != Z_STREAM_END) {
+            return false;
+        }
+
+        uint32_t size = m_state->zs.total_out;
+        uint32_t nsize = htonl(size);
+        m_state->output->write(
+            reinterpret_cast<const char*>(&nsize), sizeof(uint32_t)
+        );
+        m_state->output->write(out.data(), size);
+    }
 
     return true;
 }
@@ -49,6 +49,12 @@
 #include <fstream>
 #include <stdexcept>
 
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #if defined(HAVE_ARPA_INET_H)
 #include <arpa/inet.h>
 #elif defined(HAVE_NETINET_IN_H)
@@ -63,12 +69,45 @@ namespace CLIPP {
 struct PBGenerator::State
 {
     State(const std::string& path_) :
-        path(path_)
+        path(path_),
+        input(NULL),
+        map_base(NULL),
+        map_size(0),
+        map_offset(0)
     {
         if (path == "-") {
             input = &cin;
+            return;
+        }
+
+        /* Map regular files; chunks are then parsed straight out of the
+         * page cache with no per-input buffer or read call.  Anything
+         * unmappable falls back to the stream path below. */
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            struct stat file_info;
+            if (
+                fstat(fd, &file_info) == 0 &&
+                S_ISREG(file_info.st_mode) &&
+                file_info.st_size > 0
+            ) {
+                void* base = mmap(
+                    NULL, file_info.st_size,
+                    PROT_READ, MAP_PRIVATE,
+                    fd, 0
+                );
+                if (base != MAP_FAILED) {
+                    map_base = static_cast<const char*>(base);
+                    map_size = file_info.st_size;
+#ifdef MADV_SEQUENTIAL
+                    madvise(base, file_info.st_size, MADV_SEQUENTIAL);
+#endif
+                }
+            }
+            close(fd);
         }
-        else {
+
+        if (map_base == NULL) {
             input = new ifstream(path.c_str(), ios::binary);
             if (! *input) {
                 throw runtime_error("Could not open " + path + " for reading.");
@@ -78,13 +117,19 @@ struct PBGenerator::State
 
     ~State()
     {
-        if (path != "-") {
+        if (map_base != NULL) {
+            munmap(const_cast<char*>(map_base), map_size);
+        }
+        else if (path != "-") {
             delete input;
         }
     }
 
-    string   path;
-    istream* input;
+    string      path;
+    istream*    input;
+    const char* map_base;   //!< Mapped file or NULL.
+    size_t      map_size;   //!< Size of the mapping.
+    size_t      map_offset; //!< Read position in the mapping.
 };
 
 PBGenerator::PBGenerator()
@@ -264,30 +309,56 @@ struct pb_to_event :
 
 bool PBGenerator::operator()(Input::input_p& input)
 {
-    if (! *m_state->input) {
-        return false;
-    }
-
-    // Reset Input
-    *input = Input::Input();
-
     uint32_t raw_size;
     uint32_t size;
+    const char* chunk = NULL;
+    boost::scoped_array<char> buffer;
 
-    m_state->input->read(reinterpret_cast<char*>(&raw_size), sizeof(uint32_t));
-    if (! *m_state->input) {
-        return false;
+    if (m_state->map_base != NULL) {
+        /* Serve the chunk directly from the mapping. */
+        if (m_state->map_offset + sizeof(uint32_t) > m_state->map_size) {
+            return false;
+        }
+        memcpy(
+            &raw_size,
+            m_state->map_base + m_state->map_offset,
+            sizeof(uint32_t)
+        );
+        size = ntohl(raw_size);
+        m_state->map_offset += sizeof(uint32_t);
+        if (
+            size > m_state->map_size ||
+            m_state->map_offset > m_state->map_size - size
+        ) {
+            return false;
+        }
+        chunk = m_state->map_base + m_state->map_offset;
+        m_state->map_offset += size;
     }
-    size = ntohl(raw_size);
+    else {
+        if (! *m_state->input) {
+            return false;
+        }
 
-    boost::shared_ptr<data_t> data = boost::make_shared<data_t>();
-    input->source = data;
+        m_state->input->read(
+            reinterpret_cast<char*>(&raw_size), sizeof(uint32_t));
+        if (! *m_state->input) {
+            return false;
+        }
+        size = ntohl(raw_size);
 
-    boost::scoped_array<char> buffer(new char[size]);
+        buffer.reset(new char[size]);
+        m_state->input->read(buffer.get(), size);
+        chunk = buffer.get();
+    }
+
+    // Reset Input
+    *input = Input::Input();
 
-    m_state->input->read(buffer.get(), size);
+    boost::shared_ptr<data_t> data = boost::make_shared<data_t>();
+    input->source = data;
 
-    google::protobuf::io::ArrayInputStream in(buffer.get(), size);
+    google::protobuf::io::ArrayInputStream in(chunk, size);
     google::protobuf::io::GzipInputStream unzipped_in(&in);
 
     if (! data->pb_input.ParseFromZeroCopyStream(&unzipped_in)) {
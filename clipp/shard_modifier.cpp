@@ -0,0 +1,133 @@
+/*****************************************************************************
+ * Licensed to Qualys, Inc. (QUALYS) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * QUALYS licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+/**
+ * @file
+ * @brief IronBee --- CLIPP Shard Modifier Implementation
+ */
+
+#include "shard_modifier.hpp"
+
+#include <boost/foreach.hpp>
+#include <boost/make_shared.hpp>
+
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace IronBee {
+namespace CLIPP {
+
+namespace {
+
+//! FNV-1a accumulation over a buffer.
+uint64_t hash_buffer(uint64_t hash, const char* data, size_t length)
+{
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= (uint8_t)data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+//! Hash an input's connection identity.
+uint64_t hash_input(const Input::input_p& input, size_t position)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    bool     have_endpoints = false;
+
+    BOOST_FOREACH(
+        const Input::event_p& event,
+        input->connection.pre_transaction_events
+    ) {
+        if (event->which == Input::CONNECTION_OPENED) {
+            const Input::ConnectionEvent& open =
+                dynamic_cast<const Input::ConnectionEvent&>(*event);
+
+            hash = hash_buffer(hash, open.local_ip.data, open.local_ip.length);
+            hash = hash_buffer(
+                hash,
+                (const char*)&open.local_port, sizeof(open.local_port));
+            hash = hash_buffer(
+                hash, open.remote_ip.data, open.remote_ip.length);
+            hash = hash_buffer(
+                hash,
+                (const char*)&open.remote_port, sizeof(open.remote_port));
+            have_endpoints = true;
+            break;
+        }
+    }
+
+    if (! have_endpoints) {
+        /* No endpoints: fall back to the id and the stream position,
+         * which is identical for every process reading the same
+         * capture. */
+        hash = hash_buffer(hash, input->id.data(), input->id.size());
+        hash = hash_buffer(hash, (const char*)&position, sizeof(position));
+    }
+
+    return hash;
+}
+
+} // Anonymous
+
+struct ShardModifier::State
+{
+    size_t shard;
+    size_t n_shards;
+    size_t position;
+    size_t kept;
+};
+
+ShardModifier::ShardModifier(size_t shard, size_t n_shards) :
+    m_state(boost::make_shared<State>())
+{
+    if (n_shards == 0 || shard >= n_shards) {
+        throw runtime_error("@shard requires i/n with i < n and n > 0.");
+    }
+    m_state->shard    = shard;
+    m_state->n_shards = n_shards;
+    m_state->position = 0;
+    m_state->kept     = 0;
+}
+
+bool ShardModifier::operator()(Input::input_p& input)
+{
+    if (! input) {
+        /* End of stream: report this shard's share; summing the lines
+         * of all processes merges the summary. */
+        cerr << "@shard " << m_state->shard << "/" << m_state->n_shards
+             << ": kept " << m_state->kept
+             << " of "    << m_state->position
+             << " inputs" << endl;
+        return true;
+    }
+
+    size_t position = m_state->position;
+    ++m_state->position;
+
+    if (hash_input(input, position) % m_state->n_shards != m_state->shard) {
+        return false;
+    }
+
+    ++m_state->kept;
+    return true;
+}
+
+} // CLIPP
+} // IronBee
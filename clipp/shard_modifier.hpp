@@ -0,0 +1,67 @@
+/*****************************************************************************
+ * Licensed to Qualys, Inc. (QUALYS) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * QUALYS licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+/**
+ * @file
+ * @brief IronBee --- CLIPP Shard Modifier
+ */
+
+#ifndef __IRONBEE__CLIPP__SHARD_MODIFIER__
+#define __IRONBEE__CLIPP__SHARD_MODIFIER__
+
+#include <clipp/input.hpp>
+
+#include <boost/shared_ptr.hpp>
+
+namespace IronBee {
+namespace CLIPP {
+
+/**
+ * Deterministically keep 1 of @c n partitions of the input stream.
+ *
+ * Inputs are partitioned by a hash of their connection identity (the
+ * connection-opened endpoints when present, otherwise the input id and
+ * position), so N clipp processes given the same capture and
+ * @c \@shard:0/N .. \@shard:N-1/N replay disjoint, exhaustive subsets
+ * -- the basis for multi-process scale benchmarking against N engine
+ * instances.  At end of stream each process reports kept/total on
+ * standard error; summing those lines across processes merges the
+ * summary.
+ **/
+class ShardModifier
+{
+public:
+    /**
+     * Constructor.
+     *
+     * @param[in] shard Which partition to keep; in [0, @a n_shards).
+     * @param[in] n_shards Number of partitions.
+     **/
+    ShardModifier(size_t shard, size_t n_shards);
+
+    //! Call operator.
+    bool operator()(Input::input_p& in_out);
+
+private:
+    struct State;
+    boost::shared_ptr<State> m_state;
+};
+
+} // CLIPP
+} // IronBee
+
+#endif
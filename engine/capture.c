@@ -136,9 +136,10 @@ ib_status_t ib_capture_acquire(
     ib_status_t rc;
     ib_var_source_t *source;
 
-    /* Look up the capture list */
+    /* Look up the capture list.  The default collection is registered
+     * as an indexed source (core_vars), so the common case resolves to
+     * the registered source with no allocation and gets are indexed. */
     collection_name = get_collection_name(collection_name);
-    // @todo Acquire source at configuration time.
     rc = ib_var_source_acquire(&source,
         tx->mm,
         ib_engine_var_config_get(tx->ib),
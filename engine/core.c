@@ -599,153 +599,168 @@ static size_t ib_auditlog_gen_json_flist(ib_auditlog_part_t *part,
     }
 }
 
+/**
+ * Generate a header part by referencing wire bytes.
+ *
+ * Header names and values arrived on the wire and are written to the
+ * binary MIME part verbatim, so each line is emitted as chunks that
+ * alias the retained parsed-header byte strings -- name, ": ", value,
+ * CRLF -- with no per-line formatting buffer.  The part writer gathers
+ * chunks into vectored writes, and chunks stay valid until then by
+ * contract.  Only fields of unexpected type fall back to a formatted
+ * copy.
+ *
+ * @param[in] part Audit log part.
+ * @param[out] chunk Next chunk of data.
+ * @returns Size of @a chunk in bytes; 0 when the part is finished.
+ */
 static size_t ib_auditlog_gen_header_flist(ib_auditlog_part_t *part,
                                            const uint8_t **chunk)
 {
-    ib_engine_t *ib = part->log->ib;
-    ib_field_t *f;
-    uint8_t *rec;
-    int rlen;
-    ib_status_t rc;
+    /* Per-line emission state. */
+    typedef struct {
+        const ib_list_node_t *node;  /**< Field being emitted. */
+        int                   step;  /**< 0 name, 1 colon, 2 value, 3 CRLF. */
+        bool                  line;  /**< Field is the request/response line. */
+    } gen_state_t;
 
 #define CORE_HEADER_MAX_FIELD_LEN 8192
 
-    /* The gen_data field is used to store the current state. NULL
-     * means the part has not started yet and a -1 value
-     * means it is done. Anything else is a node in the event list.
-     */
+    ib_engine_t *ib = part->log->ib;
+    gen_state_t *st;
+    ib_status_t  rc;
+
+    if (part->gen_data == AUDITLOG_GEN_FINISHED) {
+        part->gen_data = AUDITLOG_GEN_NOTSTARTED;
+        *chunk = (const uint8_t *)"";
+        return 0;
+    }
+
     if (part->gen_data == AUDITLOG_GEN_NOTSTARTED) {
         ib_list_t *list = (ib_list_t *)part->part_data;
 
-        /* No data. */
         if (ib_list_elements(list) == 0) {
             ib_log_notice(ib, "No data in audit log part: %s", part->name);
             part->gen_data = AUDITLOG_GEN_NOTSTARTED;
             return 0;
         }
 
-        /* First should be a request/response line. */
-        part->gen_data = ib_list_first(list);
-        f = (ib_field_t *)ib_list_node_data((ib_list_node_t *)part->gen_data);
-        if ((f != NULL) && (f->type == IB_FTYPE_BYTESTR)) {
-            const ib_bytestr_t *bs;
-            rec = (uint8_t *)ib_mm_alloc(part->log->mm,
-                                         CORE_HEADER_MAX_FIELD_LEN);
-            if (rec == NULL) {
-                return 0;
-            }
-
-            rc = ib_field_value(f, ib_ftype_bytestr_out(&bs));
-            if (rc != IB_OK) {
-                return 0;
-            }
-
-            rlen = snprintf((char *)rec, CORE_HEADER_MAX_FIELD_LEN,
-                            "%" IB_BYTESTR_FMT "\r\n",
-                            IB_BYTESTR_FMT_PARAM(bs));
-
-            /* Verify size. */
-            if (rlen >= CORE_HEADER_MAX_FIELD_LEN) {
-                ib_log_notice(ib, "Item too large to log in part %s: %d bytes",
-                              part->name, rlen);
-                *chunk = (const uint8_t *)"\r\n";
-                part->gen_data = AUDITLOG_GEN_FINISHED;
-                return strlen(*(const char **)chunk);
-            }
-
-            *chunk = rec;
-
-            part->gen_data =
-                ib_list_node_next((ib_list_node_t *)part->gen_data);
-            if (part->gen_data == AUDITLOG_GEN_NOTSTARTED) {
-                part->gen_data = AUDITLOG_GEN_FINISHED;
-            }
-
-            return strlen(*(const char **)chunk);
+        st = (gen_state_t *)ib_mm_alloc(part->log->mm, sizeof(*st));
+        if (st == NULL) {
+            return 0;
         }
+        st->node = ib_list_first(list);
+        st->step = 0;
+        st->line = true;
+        part->gen_data = st;
     }
-    else if (part->gen_data == AUDITLOG_GEN_FINISHED) {
-        part->gen_data = AUDITLOG_GEN_NOTSTARTED;
-        *chunk = (const uint8_t *)"";
-        return 0;
-    }
-
-    /* Header Lines */
-    f = (ib_field_t *)ib_list_node_data((ib_list_node_t *)part->gen_data);
-    if (f == NULL) {
-        ib_log_notice(ib, "NULL field in part: %s", part->name);
-        *chunk = (const uint8_t *)"\r\n";
-        part->gen_data = AUDITLOG_GEN_FINISHED;
-        return strlen(*(const char **)chunk);
+    else {
+        st = (gen_state_t *)part->gen_data;
     }
 
-    rec = (uint8_t *)ib_mm_alloc(part->log->mm, CORE_HEADER_MAX_FIELD_LEN);
-    if (rec == NULL) {
-        *chunk = NULL;
-        return 0;
-    }
+    /* Emit the next non-empty chunk; empty names/values are skipped
+     * (a zero return would end the part). */
+    while (st->node != NULL) {
+        const ib_field_t *f =
+            (const ib_field_t *)ib_list_node_data_const(st->node);
+        const uint8_t *data = NULL;
+        size_t         data_len = 0;
 
-    /// @todo Quote values
-    switch(f->type) {
-    case IB_FTYPE_NULSTR:
-    {
-        const char *s;
-        rc = ib_field_value(f, ib_ftype_nulstr_out(&s));
-        if (rc != IB_OK) {
-            return 0;
+        if (f == NULL) {
+            st->node = ib_list_node_next_const(st->node);
+            st->step = 0;
+            st->line = false;
+            continue;
         }
 
-        rlen = snprintf((char *)rec, CORE_HEADER_MAX_FIELD_LEN,
-                        "%" IB_BYTESTR_FMT ": %s\r\n",
-                        IB_BYTESTRSL_FMT_PARAM(f->name, f->nlen),
-                        s);
-        break;
-    }
-    case IB_FTYPE_BYTESTR:
-    {
-        const ib_bytestr_t *bs;
-        rc = ib_field_value(f, ib_ftype_bytestr_out(&bs));
-        if (rc != IB_OK) {
-            return 0;
-        }
-        rlen = snprintf((char *)rec, CORE_HEADER_MAX_FIELD_LEN,
-                        "%" IB_BYTESTR_FMT ": "
-                        "%" IB_BYTESTR_FMT "\r\n",
-                        IB_BYTESTRSL_FMT_PARAM(f->name, f->nlen),
-                        IB_BYTESTR_FMT_PARAM(bs));
-        break;
-    }
-    default:
-        rlen = snprintf((char *)rec, CORE_HEADER_MAX_FIELD_LEN,
-                        "%" IB_BYTESTR_FMT ": IronBeeError - unhandled header type %d\r\n",
-                        IB_BYTESTRSL_FMT_PARAM(f->name, f->nlen),
+        switch (st->step) {
+        case 0:
+            /* Request/response line: the raw bytes; headers: the name. */
+            if (st->line) {
+                if (f->type == IB_FTYPE_BYTESTR) {
+                    const ib_bytestr_t *bs;
+                    rc = ib_field_value(f, ib_ftype_bytestr_out(&bs));
+                    if (rc == IB_OK && bs != NULL) {
+                        data = ib_bytestr_const_ptr(bs);
+                        data_len = ib_bytestr_length(bs);
+                    }
+                }
+                st->step = 3; /* Lines have no colon/value; CRLF next. */
+            }
+            else {
+                data = (const uint8_t *)f->name;
+                data_len = f->nlen;
+                st->step = 1;
+            }
+            break;
+        case 1:
+            data = (const uint8_t *)": ";
+            data_len = 2;
+            st->step = 2;
+            break;
+        case 2:
+            switch (f->type) {
+            case IB_FTYPE_BYTESTR: {
+                const ib_bytestr_t *bs;
+                rc = ib_field_value(f, ib_ftype_bytestr_out(&bs));
+                if (rc == IB_OK && bs != NULL) {
+                    data = ib_bytestr_const_ptr(bs);
+                    data_len = ib_bytestr_length(bs);
+                }
+                break;
+            }
+            case IB_FTYPE_NULSTR: {
+                const char *str;
+                rc = ib_field_value(f, ib_ftype_nulstr_out(&str));
+                if (rc == IB_OK && str != NULL) {
+                    data = (const uint8_t *)str;
+                    data_len = strlen(str);
+                }
+                break;
+            }
+            default: {
+                /* Unexpected type: formatted copy, as before. */
+                uint8_t *rec = (uint8_t *)ib_mm_alloc(
+                    part->log->mm, CORE_HEADER_MAX_FIELD_LEN);
+                if (rec != NULL) {
+                    int rlen = snprintf(
+                        (char *)rec, CORE_HEADER_MAX_FIELD_LEN,
+                        "IronBeeError - unhandled header type %d",
                         f->type);
-        break;
-    }
-
-    /* Verify size. */
-    if (rlen >= CORE_HEADER_MAX_FIELD_LEN) {
-        ib_log_notice(ib, "Item too large to log in part %s: %d bytes",
-                      part->name, rlen);
-        *chunk = (const uint8_t *)"\r\n";
-        part->gen_data = AUDITLOG_GEN_FINISHED;
-        return strlen(*(const char **)chunk);
-    }
-
-    *chunk = rec;
-
-    /* Stage the next chunk of data (header). */
-    part->gen_data = ib_list_node_next((ib_list_node_t *)part->gen_data);
+                    if (rlen > 0 && rlen < CORE_HEADER_MAX_FIELD_LEN) {
+                        data = rec;
+                        data_len = (size_t)rlen;
+                    }
+                }
+                break;
+            }
+            }
+            st->step = 3;
+            break;
+        case 3:
+        default:
+            data = (const uint8_t *)"\r\n";
+            data_len = 2;
+            st->node = ib_list_node_next_const(st->node);
+            st->step = 0;
+            st->line = false;
+            break;
+        }
 
-    /* Close the structure if there is no more data. */
-    if (part->gen_data == AUDITLOG_GEN_NOTSTARTED) {
-        part->gen_data = AUDITLOG_GEN_FINISHED;
+        if (data_len > 0) {
+            *chunk = data;
+            if (st->node == NULL) {
+                part->gen_data = AUDITLOG_GEN_FINISHED;
+            }
+            return data_len;
+        }
     }
 
-    return strlen(*(const char **)chunk);
+    part->gen_data = AUDITLOG_GEN_FINISHED;
+    *chunk = (const uint8_t *)"";
+    return 0;
 }
 
-
 static size_t ib_auditlog_gen_json_events(ib_auditlog_part_t *part,
                                           const uint8_t **chunk)
 {
@@ -1234,6 +1249,9 @@ static ib_status_t ib_auditlog_add_part_header(ib_auditlog_t *log)
                 ib_field_setv(tx_msg, ib_ftype_nulstr_in(e->msg));
             }
 
+            if (e->tags == NULL) {
+                continue;
+            }
             IB_LIST_LOOP(e->tags, tnode) {
                 char *tag = (char *)ib_list_node_data(tnode);
 
@@ -2027,8 +2045,17 @@ static ib_status_t core_hook_context_tx(ib_engine_t *ib,
         return rc;
     }
 
-    /* Set default options. */
-    tx->flags |= corecfg->inspection_engine_options;
+    /* Set default options.  Connections marked clean (allow:conn) skip
+     * inspection wholesale: no inspection options, allow-all set, so
+     * rule phases and body feeds are skipped while postprocessing and
+     * logging still run. */
+    if (ib_flags_all(tx->conn->flags, IB_CONN_FBYPASS)) {
+        ib_log_debug_tx(tx, "Connection marked clean; bypassing inspection.");
+        ib_tx_flags_set(tx, IB_TX_FALLOW_ALL);
+    }
+    else {
+        tx->flags |= corecfg->inspection_engine_options;
+    }
     tx->flags |= corecfg->protection_engine_options;
 
     /* Copy the configuration limits into the tx. */
@@ -2946,6 +2973,19 @@ static ib_status_t core_dir_param1(ib_cfgparser_t *cp,
                       "TODO: Handle Directive: %s \"%s\"",
                       name, p1_unescaped);
     }
+    else if (strcasecmp("InspectionBudgetUsec", name) == 0) {
+        ib_num_t budget;
+
+        rc = ib_type_atoi(p1_unescaped, 10, &budget);
+        if (rc != IB_OK || budget < 0) {
+            ib_cfg_log_error(cp,
+                             "%s requires a non-negative integer, not \"%s\".",
+                             name, p1_unescaped);
+            return IB_EINVAL;
+        }
+        rc = ib_context_set_num(ctx, "inspection_budget_usec", budget);
+        return rc;
+    }
     else if (strcasecmp("AuditEngine", name) == 0) {
         if (strcasecmp("RelevantOnly", p1_unescaped) == 0) {
             ib_log_info(ib,
@@ -3027,6 +3067,40 @@ static ib_status_t core_dir_param1(ib_cfgparser_t *cp,
         rc = ib_context_set_num(ctx, "auditlog_fmode", mode);
         return rc;
     }
+    else if (strcasecmp("ResponseBodySampleBudget", name) == 0) {
+        ib_num_t budget;
+        rc = ib_type_atoi(p1_unescaped, 10, &budget);
+        if (rc != IB_OK || budget < 0) {
+            ib_cfg_log_error(cp, "Invalid ResponseBodySampleBudget: %s", p1);
+            rc = IB_EINVAL;
+        }
+        else {
+            rc = ib_context_set_num(ctx, "response_sample_budget", budget);
+        }
+    }
+    else if (strcasecmp("ResponseBodySampleWindow", name) == 0) {
+        ib_num_t window;
+        rc = ib_type_atoi(p1_unescaped, 10, &window);
+        if (rc != IB_OK || window < 1) {
+            ib_cfg_log_error(cp, "Invalid ResponseBodySampleWindow: %s", p1);
+            rc = IB_EINVAL;
+        }
+        else {
+            rc = ib_context_set_num(ctx, "response_sample_window", window);
+        }
+    }
+    else if (strcasecmp("AuditLogZstdDictionary", name) == 0) {
+#ifdef HAVE_ZSTD
+        rc = ib_context_set_string(ctx, "auditlog_zstd_dict", p1_unescaped);
+#else
+        /* Accepting the directive would silently produce uncompressed
+         * audit logs the operator believes are compressed. */
+        ib_cfg_log_error(cp,
+            "AuditLogZstdDictionary: this build has no zstd support;"
+            " rebuild with zstd or remove the directive.");
+        rc = IB_EINVAL;
+#endif
+    }
     else if (strcasecmp("AuditLogBaseDir", name) == 0) {
         rc = ib_context_set_string(ctx, "auditlog_dir", p1_unescaped);
         return rc;
@@ -4099,6 +4173,21 @@ static IB_DIRMAP_INIT_STRUCTURE(core_directive_map) = {
         core_dir_param1,
         NULL
     ),
+    IB_DIRMAP_INIT_PARAM1(
+        "AuditLogZstdDictionary",
+        core_dir_param1,
+        NULL
+    ),
+    IB_DIRMAP_INIT_PARAM1(
+        "ResponseBodySampleBudget",
+        core_dir_param1,
+        NULL
+    ),
+    IB_DIRMAP_INIT_PARAM1(
+        "ResponseBodySampleWindow",
+        core_dir_param1,
+        NULL
+    ),
     IB_DIRMAP_INIT_PARAM1(
         "AuditLogSubDirFormat",
         core_dir_param1,
@@ -4157,6 +4246,11 @@ static IB_DIRMAP_INIT_STRUCTURE(core_directive_map) = {
         core_dir_loglevel,
         core_loglevels_map
     ),
+    IB_DIRMAP_INIT_PARAM1(
+        "InspectionBudgetUsec",
+        core_dir_param1,
+        NULL
+    ),
 
     /* TX DPI Initializers */
     IB_DIRMAP_INIT_PARAM2(
@@ -4448,6 +4542,9 @@ static ib_status_t core_init(ib_engine_t *ib,
     corecfg->auditlog_fmode       = 0600;
     corecfg->auditlog_parts       = IB_ALPARTS_DEFAULT;
     corecfg->auditlog_dir         = "/var/log/ironbee";
+    corecfg->auditlog_zstd_dict   = NULL;
+    corecfg->response_sample_budget = 0;
+    corecfg->response_sample_window = 16384;
     corecfg->auditlog_sdir_fmt    = "";
     corecfg->auditlog_index_fmt   = IB_LOGFORMAT_DEFAULT;
     corecfg->audit                = MODULE_NAME_STR;
@@ -4456,6 +4553,7 @@ static ib_status_t core_init(ib_engine_t *ib,
     corecfg->rule_base_path       = X_RULE_BASE_PATH;
     corecfg->rule_log_flags       = 0;
     corecfg->rule_log_level       = IB_LOG_INFO;
+    corecfg->inspection_budget_usec = 0;
     corecfg->rule_debug_str       = "error";
     corecfg->rule_debug_level     = IB_RULE_DLOG_ERROR;
     corecfg->inspection_engine_options = IB_IEOPT_DEFAULT;
@@ -4631,6 +4729,12 @@ static IB_CFGMAP_INIT_STRUCTURE(core_config_map) = {
         ib_core_cfg_t,
         rule_debug_level
     ),
+    IB_CFGMAP_INIT_ENTRY(
+        "inspection_budget_usec",
+        IB_FTYPE_NUM,
+        ib_core_cfg_t,
+        inspection_budget_usec
+    ),
 
     /* Buffering */
     IB_CFGMAP_INIT_ENTRY(
@@ -4689,6 +4793,24 @@ static IB_CFGMAP_INIT_STRUCTURE(core_config_map) = {
         ib_core_cfg_t,
         auditlog_index_fmt
     ),
+    IB_CFGMAP_INIT_ENTRY(
+        "auditlog_zstd_dict",
+        IB_FTYPE_NULSTR,
+        ib_core_cfg_t,
+        auditlog_zstd_dict
+    ),
+    IB_CFGMAP_INIT_ENTRY(
+        "response_sample_budget",
+        IB_FTYPE_NUM,
+        ib_core_cfg_t,
+        response_sample_budget
+    ),
+    IB_CFGMAP_INIT_ENTRY(
+        "response_sample_window",
+        IB_FTYPE_NUM,
+        ib_core_cfg_t,
+        response_sample_window
+    ),
     IB_CFGMAP_INIT_ENTRY(
         "inspection_engine_options",
         IB_FTYPE_NUM,
@@ -899,7 +899,6 @@ static ib_status_t act_setvar_execute(
     ib_field_t       *cur_field = NULL;
     ib_tx_t          *tx        = rule_exec->tx;
     ib_mm_t           mm        = tx->mm;
-    const ib_list_t  *result    = NULL; /* List of target fields: ib_field_t* */
     const ib_field_t *argument;
     ib_var_target_t  *expanded_target;
 
@@ -908,6 +907,12 @@ static ib_status_t act_setvar_execute(
     const char          *ts          = setvar_data->target_str;
     int                  tslen       = (int)setvar_data->target_str_len;
 
+    /* setvar may modify a field in place, invalidating pure operator
+     * results cached against that field's identity. */
+    if (rule_exec->op_results != NULL) {
+        ib_hash_clear(rule_exec->op_results);
+    }
+
     /* Expand target. */
     rc = ib_var_target_expand(
         setvar_data->target,
@@ -925,18 +930,15 @@ static ib_status_t act_setvar_execute(
         return rc;
     }
 
-    /* Remove target, recording results. */
-    rc = ib_var_target_get(
+    /* Fetch the current value; allocation free for trivial targets. */
+    rc = ib_var_target_get_single(
         expanded_target,
-        &result,
+        &cur_field,
         mm,
         tx->var_store
     );
     if (rc == IB_OK) {
-        if (result != NULL && ib_list_elements(result) > 0) {
-            cur_field = (ib_field_t *)ib_list_node_data_const(
-                ib_list_first_const(result));
-        }
+        /* cur_field set (or NULL for an empty result). */
     }
     else if (rc == IB_ENOENT) {
         cur_field = NULL;
@@ -1872,6 +1874,12 @@ static ib_status_t act_del_response_header_execute(
  *
  * @returns Status code
  */
+/** Instance data for the allow action. */
+typedef struct {
+    ib_flags_t flags; /**< Transaction flags to set. */
+    bool       conn;  /**< Also mark the whole connection clean. */
+} act_allow_t;
+
 static ib_status_t act_allow_create(
     ib_mm_t       mm,
     ib_context_t *ctx,
@@ -1880,8 +1888,9 @@ static ib_status_t act_allow_create(
     void         *cbdata
 )
 {
+    act_allow_t *idata;
     ib_flags_t flags = IB_TX_FNONE;
-    ib_flags_t *idata;
+    bool conn = false;
 
     if (parameters == NULL) {
         flags |= IB_TX_FALLOW_ALL;
@@ -1892,6 +1901,12 @@ static ib_status_t act_allow_create(
     else if (strcasecmp(parameters, "request") == 0) {
         flags |= IB_TX_FALLOW_REQUEST;
     }
+    else if (strcasecmp(parameters, "conn") == 0) {
+        /* The flow is judged clean: skip the rest of this transaction
+         * and every further transaction on the connection. */
+        flags |= IB_TX_FALLOW_ALL;
+        conn = true;
+    }
     else {
         return IB_EINVAL;
     }
@@ -1901,7 +1916,8 @@ static ib_status_t act_allow_create(
         return IB_EALLOC;
     }
 
-    *idata = flags;
+    idata->flags = flags;
+    idata->conn  = conn;
     *(void **)instance_data = idata;
 
     return IB_OK;
@@ -1923,8 +1939,13 @@ static ib_status_t act_allow_execute(
     assert(rule_exec != NULL);
     assert(rule_exec->tx != NULL);
 
-    const ib_flags_t *pflags = (const ib_flags_t *)data;
-    ib_flags_t set_flags = *pflags;
+    const act_allow_t *allow = (const act_allow_t *)data;
+    ib_flags_t set_flags = allow->flags;
+
+    /* Mark the whole connection clean if requested. */
+    if (allow->conn) {
+        ib_flags_set(rule_exec->tx->conn->flags, IB_CONN_FBYPASS);
+    }
 
     /* For post process, treat ALLOW_ALL like ALLOW_PHASE */
     if ( (rule_exec->rule->meta.phase == IB_PHASE_POSTPROCESS) &&
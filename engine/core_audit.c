@@ -28,6 +28,12 @@
 #include "core_private.h"
 #include "engine_private.h"
 
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include <pthread.h>
+
 #include <ironbee/context.h>
 #include <ironbee/core.h>
 #include <ironbee/engine_types.h>
@@ -35,6 +41,171 @@
 #include <ironbee/rule_logger.h>
 #include <ironbee/util.h>
 
+#ifdef HAVE_ZSTD
+
+/**
+ * @name Audit dictionary compression
+ *
+ * When AuditLogZstdDictionary is configured, every byte of an audit
+ * log flows through a zstd stream referencing a dictionary trained
+ * offline on the deployment's traffic -- header names and values that
+ * repeat across billions of events compress against the dictionary
+ * instead of being rediscovered per file.  The dictionary id is
+ * embedded in the zstd frame header (decoders check it) and echoed in
+ * the MIME header for humans.
+ *
+ * Dictionaries are loaded once per process, keyed by path, and shared
+ * by every context and engine referencing the same file.
+ */
+
+/**@{*/
+
+/** A loaded dictionary. */
+typedef struct audit_zstd_dict_t audit_zstd_dict_t;
+struct audit_zstd_dict_t {
+    audit_zstd_dict_t *next;    /**< Next loaded dictionary. */
+    char              *path;    /**< Dictionary file (malloc). */
+    ZSTD_CDict        *cdict;   /**< The digested dictionary. */
+    unsigned           dict_id; /**< Dictionary id. */
+};
+
+static audit_zstd_dict_t *c_audit_dicts = NULL;
+static pthread_mutex_t    c_audit_dicts_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Get (loading if needed) the dictionary at @a path.
+ *
+ * @returns The dictionary, or NULL if it cannot be loaded.
+ */
+static const audit_zstd_dict_t *audit_zstd_dict_get(
+    ib_engine_t *ib,
+    const char  *path
+)
+{
+    audit_zstd_dict_t *dict;
+    FILE              *fp = NULL;
+    char              *data = NULL;
+    long               size;
+
+    pthread_mutex_lock(&c_audit_dicts_lock);
+    for (dict = c_audit_dicts; dict != NULL; dict = dict->next) {
+        if (strcmp(dict->path, path) == 0) {
+            pthread_mutex_unlock(&c_audit_dicts_lock);
+            return dict;
+        }
+    }
+
+    fp = fopen(path, "rb");
+    if (fp == NULL ||
+        fseek(fp, 0, SEEK_END) != 0 ||
+        (size = ftell(fp)) <= 0)
+    {
+        goto fail;
+    }
+    rewind(fp);
+    data = malloc(size);
+    if (data == NULL || fread(data, 1, size, fp) != (size_t)size) {
+        goto fail;
+    }
+    fclose(fp);
+    fp = NULL;
+
+    dict = malloc(sizeof(*dict));
+    if (dict == NULL || (dict->path = strdup(path)) == NULL) {
+        free(dict);
+        goto fail;
+    }
+    dict->cdict = ZSTD_createCDict(data, size, ZSTD_CLEVEL_DEFAULT);
+    dict->dict_id = ZSTD_getDictID_fromDict(data, size);
+    free(data);
+    data = NULL;
+    if (dict->cdict == NULL) {
+        free(dict->path);
+        free(dict);
+        goto fail;
+    }
+
+    dict->next = c_audit_dicts;
+    c_audit_dicts = dict;
+    pthread_mutex_unlock(&c_audit_dicts_lock);
+    return dict;
+
+fail:
+    pthread_mutex_unlock(&c_audit_dicts_lock);
+    if (fp != NULL) {
+        fclose(fp);
+    }
+    free(data);
+    ib_log_error(ib, "Failed to load audit zstd dictionary \"%s\"", path);
+    return NULL;
+}
+
+/** Compression output buffer size per flush. */
+#define AUDIT_ZSTD_OUT_SZ (64 * 1024)
+
+/**
+ * Push @a len bytes through the log's compression stream to the file.
+ */
+static ib_status_t audit_zstd_write(
+    ib_core_audit_cfg_t *cfg,
+    const uint8_t       *data,
+    size_t               len,
+    ZSTD_EndDirective    mode
+)
+{
+    ZSTD_CCtx    *cctx = (ZSTD_CCtx *)cfg->zstd_stream;
+    ZSTD_inBuffer in = { data, len, 0 };
+    char          out_buf[AUDIT_ZSTD_OUT_SZ];
+
+    for (;;) {
+        ZSTD_outBuffer out = { out_buf, sizeof(out_buf), 0 };
+        size_t remaining = ZSTD_compressStream2(cctx, &out, &in, mode);
+
+        if (ZSTD_isError(remaining)) {
+            return IB_EUNKNOWN;
+        }
+        if (out.pos > 0 &&
+            fwrite(out_buf, out.pos, 1, cfg->fp) != 1)
+        {
+            return IB_EUNKNOWN;
+        }
+        if (mode == ZSTD_e_end ? (remaining == 0)
+                               : (in.pos == in.size))
+        {
+            break;
+        }
+    }
+
+    return IB_OK;
+}
+
+/**@}*/
+
+#endif /* HAVE_ZSTD */
+
+/**
+ * Write @a len bytes of part data to the audit log.
+ *
+ * Routed through the compression stream when one is configured;
+ * written directly otherwise.
+ */
+static ib_status_t audit_write_data(
+    ib_core_audit_cfg_t *cfg,
+    const uint8_t       *data,
+    size_t               len
+)
+{
+#ifdef HAVE_ZSTD
+    if (cfg->zstd_stream != NULL) {
+        return audit_zstd_write(cfg, data, len, ZSTD_e_continue);
+    }
+#endif
+    if (len > 0 && fwrite(data, len, 1, cfg->fp) != 1) {
+        return IB_EUNKNOWN;
+    }
+    return IB_OK;
+}
+
 #include <assert.h>
 #include <errno.h>
 #include <fcntl.h>
@@ -42,6 +213,7 @@
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 /* POSIX doesn't define O_BINARY */
 #ifndef O_BINARY
@@ -212,6 +384,31 @@ ib_status_t core_audit_open_auditfile(ib_engine_t *ib,
     cfg->full_path = audit_filename;
     cfg->temp_path = temp_filename;
 
+    /* Set up dictionary compression when configured; failures fall
+     * back to uncompressed logging. */
+    cfg->zstd_stream = NULL;
+    cfg->zstd_dict_id = 0;
+#ifdef HAVE_ZSTD
+    if (corecfg->auditlog_zstd_dict != NULL) {
+        const audit_zstd_dict_t *dict =
+            audit_zstd_dict_get(log->ib, corecfg->auditlog_zstd_dict);
+
+        if (dict != NULL) {
+            ZSTD_CCtx *cctx = ZSTD_createCCtx();
+
+            if (cctx != NULL &&
+                ! ZSTD_isError(ZSTD_CCtx_refCDict(cctx, dict->cdict)))
+            {
+                cfg->zstd_stream = cctx;
+                cfg->zstd_dict_id = dict->dict_id;
+            }
+            else if (cctx != NULL) {
+                ZSTD_freeCCtx(cctx);
+            }
+        }
+    }
+#endif
+
     /* Log it via the rule logger */
     ib_rule_log_add_audit(cfg->tx->rule_exec, audit_filename, false);
 
@@ -483,7 +680,23 @@ ib_status_t core_audit_write_header(ib_engine_t *ib,
     ib_core_audit_cfg_t *cfg = (ib_core_audit_cfg_t *)log->cfg_data;
     char header[256];
     size_t hlen;
-    int ret = snprintf(header, sizeof(header),
+    int ret;
+
+    if (cfg->zstd_dict_id != 0) {
+        ret = snprintf(header, sizeof(header),
+                       "MIME-Version: 1.0\r\n"
+                       "Content-Type: multipart/mixed; boundary=%s\r\n"
+                       "X-IronBee-AuditLog: type=multipart; version=%d; "
+                       "dictionary=%u\r\n"
+                       "\r\n"
+                       "This is a multi-part message in MIME format.\r\n"
+                       "\r\n",
+                       cfg->boundary,
+                       IB_AUDITLOG_VERSION,
+                       cfg->zstd_dict_id);
+    }
+    else {
+        ret = snprintf(header, sizeof(header),
                        "MIME-Version: 1.0\r\n"
                        "Content-Type: multipart/mixed; boundary=%s\r\n"
                        "X-IronBee-AuditLog: type=multipart; version=%d\r\n"
@@ -492,6 +705,7 @@ ib_status_t core_audit_write_header(ib_engine_t *ib,
                        "\r\n",
                        cfg->boundary,
                        IB_AUDITLOG_VERSION);
+    }
     if ((size_t)ret >= sizeof(header)) {
         /* Did not fit in buffer.  Since this is currently a more-or-less
          * fixed size, we abort here as this is a programming error.
@@ -500,7 +714,7 @@ ib_status_t core_audit_write_header(ib_engine_t *ib,
     }
 
     hlen = strlen(header);
-    if (fwrite(header, hlen, 1, cfg->fp) != 1) {
+    if (audit_write_data(cfg, (const uint8_t *)header, hlen) != IB_OK) {
         ib_log_error(ib,  "Failed to write audit log header.");
         return IB_EUNKNOWN;
     }
@@ -509,6 +723,44 @@ ib_status_t core_audit_write_header(ib_engine_t *ib,
     return IB_OK;
 }
 
+/** Chunks gathered per vectored write in core_audit_write_part(). */
+#define AUDIT_IOV_BATCH 64
+
+/**
+ * Write a full iovec array to @a fd, retrying on partial writes.
+ *
+ * @param[in] fd Descriptor to write to.
+ * @param[in,out] iov Vector of buffers; consumed entries are adjusted.
+ * @param[in] iovcnt Number of entries in @a iov.
+ *
+ * @returns
+ * - IB_OK on success.
+ * - IB_EUNKNOWN on write failure.
+ */
+static ib_status_t audit_writev_all(int fd, struct iovec *iov, int iovcnt)
+{
+    while (iovcnt > 0) {
+        ssize_t written = writev(fd, iov, iovcnt);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return IB_EUNKNOWN;
+        }
+        while ( (iovcnt > 0) && ((size_t)written >= iov[0].iov_len) ) {
+            written -= iov[0].iov_len;
+            ++iov;
+            --iovcnt;
+        }
+        if (iovcnt > 0) {
+            iov[0].iov_base = (char *)iov[0].iov_base + written;
+            iov[0].iov_len -= written;
+        }
+    }
+
+    return IB_OK;
+}
+
 ib_status_t core_audit_write_part(ib_engine_t *ib,
                                   ib_auditlog_part_t *part)
 {
@@ -516,9 +768,14 @@ ib_status_t core_audit_write_part(ib_engine_t *ib,
     ib_core_audit_cfg_t *cfg = (ib_core_audit_cfg_t *)log->cfg_data;
     const uint8_t *chunk;
     size_t chunk_size;
+    struct iovec iov[AUDIT_IOV_BATCH];
+    int n_iov = 0;
+    int fd;
 
     /* Write the MIME boundary and part header */
-    fprintf(cfg->fp,
+    {
+        char part_header[512];
+        int  plen = snprintf(part_header, sizeof(part_header),
             "\r\n--%s"
             "\r\nContent-Disposition: audit-log-part; name=\"%s\""
             "\r\nContent-Transfer-Encoding: binary"
@@ -527,19 +784,59 @@ ib_status_t core_audit_write_part(ib_engine_t *ib,
             cfg->boundary,
             part->name,
             part->content_type);
-
-    /* Write the part data. */
-    while((chunk_size = part->fn_gen(part, &chunk)) != 0) {
-        if (fwrite(chunk, chunk_size, 1, cfg->fp) != 1) {
-            ib_log_error(ib,  "Failed to write audit log part.");
-            fflush(cfg->fp);
+        if (plen <= 0 || (size_t)plen >= sizeof(part_header) ||
+            audit_write_data(
+                cfg, (const uint8_t *)part_header, (size_t)plen) != IB_OK)
+        {
+            ib_log_error(ib,  "Failed to write audit log part header.");
             return IB_EUNKNOWN;
         }
-        cfg->parts_written++;
     }
 
-    /* Finish the part. */
+#ifdef HAVE_ZSTD
+    /* Compressed logs stream every chunk through the dictionary
+     * compressor; vectored writes only apply to the raw file path. */
+    if (cfg->zstd_stream != NULL) {
+        while ((chunk_size = part->fn_gen(part, &chunk)) != 0) {
+            if (audit_write_data(cfg, chunk, chunk_size) != IB_OK) {
+                ib_log_error(ib,  "Failed to write audit log part.");
+                return IB_EUNKNOWN;
+            }
+            ++cfg->parts_written;
+        }
+        return IB_OK;
+    }
+#endif
+
+    /* The part data is written with vectored writes below, so the stdio
+     * buffer must be flushed first to keep ordering. */
     fflush(cfg->fp);
+    fd = fileno(cfg->fp);
+
+    /* Gather the part data and write it in batches of one vectored
+     * write each; chunks remain valid until then per
+     * ib_auditlog_part_gen_fn_t. */
+    while ((chunk_size = part->fn_gen(part, &chunk)) != 0) {
+        iov[n_iov].iov_base = (void *)chunk;
+        iov[n_iov].iov_len  = chunk_size;
+        ++n_iov;
+
+        if (n_iov == AUDIT_IOV_BATCH) {
+            if (audit_writev_all(fd, iov, n_iov) != IB_OK) {
+                ib_log_error(ib,  "Failed to write audit log part.");
+                return IB_EUNKNOWN;
+            }
+            cfg->parts_written += n_iov;
+            n_iov = 0;
+        }
+    }
+    if (n_iov > 0) {
+        if (audit_writev_all(fd, iov, n_iov) != IB_OK) {
+            ib_log_error(ib,  "Failed to write audit log part.");
+            return IB_EUNKNOWN;
+        }
+        cfg->parts_written += n_iov;
+    }
 
     return IB_OK;
 }
@@ -550,7 +847,13 @@ ib_status_t core_audit_write_footer(ib_engine_t *ib,
     ib_core_audit_cfg_t *cfg = (ib_core_audit_cfg_t *)log->cfg_data;
 
     if (cfg->parts_written > 0) {
-        fprintf(cfg->fp, "\r\n--%s--\r\n", cfg->boundary);
+        char footer[128];
+        int  flen = snprintf(
+            footer, sizeof(footer), "\r\n--%s--\r\n", cfg->boundary);
+
+        if (flen > 0 && (size_t)flen < sizeof(footer)) {
+            audit_write_data(cfg, (const uint8_t *)footer, (size_t)flen);
+        }
     }
 
     return IB_OK;
@@ -696,6 +999,14 @@ ib_status_t core_audit_close(ib_engine_t *ib, ib_auditlog_t *log)
 
     /* Close the audit log. */
     if (cfg->fp != NULL) {
+#ifdef HAVE_ZSTD
+        /* Finish the compression frame before closing. */
+        if (cfg->zstd_stream != NULL) {
+            audit_zstd_write(cfg, NULL, 0, ZSTD_e_end);
+            ZSTD_freeCCtx((ZSTD_CCtx *)cfg->zstd_stream);
+            cfg->zstd_stream = NULL;
+        }
+#endif
         fclose(cfg->fp);
         // Rename temp to real
         sys_rc = rename(cfg->temp_path, cfg->full_path);
@@ -715,11 +1026,7 @@ ib_status_t core_audit_close(ib_engine_t *ib, ib_auditlog_t *log)
     if ((cfg->index_fp != NULL) && (cfg->parts_written > 0)) {
         size_t written;
 
-        ib_rc = ib_lock_lock(log->ctx->auditlog->index_fp_lock);
-        if (ib_rc != IB_OK) {
-            goto cleanup;
-        }
-
+        /* Format outside the lock; only the write is serialized. */
         ib_rc = core_audit_get_index_line(ib, log, line,
                                           LOGFORMAT_MAX_LINE_LENGTH,
                                           &len);
@@ -727,11 +1034,16 @@ ib_status_t core_audit_close(ib_engine_t *ib, ib_auditlog_t *log)
         line[len + 1] = '\0';
 
         if ( (ib_rc != IB_ETRUNC) && (ib_rc != IB_OK) ) {
-            ib_lock_unlock(log->ctx->auditlog->index_fp_lock);
             goto cleanup;
         }
 
-        written = fwrite(line, len, 1, cfg->index_fp);
+        ib_rc = ib_lock_lock(log->ctx->auditlog->index_fp_lock);
+        if (ib_rc != IB_OK) {
+            goto cleanup;
+        }
+
+        /* One write including the line terminator. */
+        written = fwrite(line, len + 1, 1, cfg->index_fp);
 
         if (written == 0) {
             sys_rc = errno;
@@ -112,6 +112,12 @@ typedef struct core_site_selector_t {
     const ib_list_t       *locations;    /**< List of core_location_t* */
 } core_site_selector_t;
 
+/** An ordered reference to a selector, used by the host index. */
+typedef struct {
+    size_t                      order;    /**< Position in selector_list. */
+    const core_site_selector_t *selector; /**< The selector. */
+} core_selector_ref_t;
+
 
 /**
  * Find the first 'match any' location for the given site
@@ -408,9 +414,194 @@ static ib_status_t core_ctxsel_finalize(
         }
     }
 
+    /* Build the exact-hostname index over the selector list.  See
+     * ib_core_module_data_t::selector_host_index. */
+    {
+        ib_mm_t mm = ib_engine_mm_main_get(ib);
+        const ib_list_node_t *node;
+        size_t order = 0;
+
+        rc = ib_hash_create_nocase(&core_data->selector_host_index, mm);
+        if (rc != IB_OK) {
+            return rc;
+        }
+        rc = ib_list_create(&core_data->selector_fallback, mm);
+        if (rc != IB_OK) {
+            return rc;
+        }
+
+        IB_LIST_LOOP_CONST(core_data->selector_list, node) {
+            const core_site_selector_t *selector =
+                (const core_site_selector_t *)ib_list_node_data_const(node);
+            const ib_list_node_t *host_node;
+            bool on_fallback = false;
+
+            /* No hosts matches any hostname. */
+            if (
+                selector->hosts == NULL ||
+                ib_list_elements(selector->hosts) == 0
+            ) {
+                on_fallback = true;
+            }
+            else {
+                IB_LIST_LOOP_CONST(selector->hosts, host_node) {
+                    const core_host_t *core_host =
+                        (const core_host_t *)
+                            ib_list_node_data_const(host_node);
+
+                    if (
+                        core_host->match_any ||
+                        core_host->host.suffix != NULL
+                    ) {
+                        on_fallback = true;
+                    }
+                    else {
+                        /* Exact host: index it. */
+                        core_selector_ref_t *ref;
+                        ib_list_t *bucket = NULL;
+
+                        ref = ib_mm_alloc(mm, sizeof(*ref));
+                        if (ref == NULL) {
+                            return IB_EALLOC;
+                        }
+                        ref->order = order;
+                        ref->selector = selector;
+
+                        rc = ib_hash_get(
+                            core_data->selector_host_index,
+                            &bucket,
+                            core_host->host.hostname
+                        );
+                        if (rc == IB_ENOENT) {
+                            rc = ib_list_create(&bucket, mm);
+                            if (rc != IB_OK) {
+                                return rc;
+                            }
+                            rc = ib_hash_set(
+                                core_data->selector_host_index,
+                                core_host->host.hostname,
+                                bucket
+                            );
+                            if (rc != IB_OK) {
+                                return rc;
+                            }
+                        }
+                        else if (rc != IB_OK) {
+                            return rc;
+                        }
+                        rc = ib_list_push(bucket, ref);
+                        if (rc != IB_OK) {
+                            return rc;
+                        }
+                    }
+                }
+            }
+
+            if (on_fallback) {
+                core_selector_ref_t *ref = ib_mm_alloc(mm, sizeof(*ref));
+                if (ref == NULL) {
+                    return IB_EALLOC;
+                }
+                ref->order = order;
+                ref->selector = selector;
+                rc = ib_list_push(core_data->selector_fallback, ref);
+                if (rc != IB_OK) {
+                    return rc;
+                }
+            }
+
+            ++order;
+        }
+    }
+
     return IB_OK;
 }
 
+/**
+ * Evaluate a single site selector against a connection/transaction.
+ *
+ * This is the per-selector body of core_ctxsel_select(), shared by the
+ * indexed and full-scan paths.
+ *
+ * @param[in] ib Engine.
+ * @param[in] conn Connection.
+ * @param[in] tx Transaction; may be NULL.
+ * @param[in] ip_len Length of conn->local_ipstr.
+ * @param[in] selector Selector to evaluate.
+ * @param[out] pctx Set to the selected context on a match.
+ *
+ * @returns true iff the selector matched and @a pctx is set.
+ */
+static bool core_ctxsel_try_selector(
+    const ib_engine_t *ib,
+    const ib_conn_t *conn,
+    const ib_tx_t *tx,
+    size_t ip_len,
+    const core_site_selector_t *selector,
+    ib_context_t **pctx)
+{
+    const core_service_t *service = selector->service;
+    const core_location_t *location;
+    ib_context_t *ctx;
+    ib_status_t rc;
+    bool match;
+
+    ib_log_debug2(ib, "Looking for matching context against site=%s(%s)",
+                  (selector->site ? selector->site->site.id : "none"),
+                  (selector->site ? selector->site->site.name : "none"));
+
+    /*
+     * Check if the service matches the connection data.
+     */
+    if ( (service != NULL) && (! service->match_any) ) {
+        /* Check that the port matches the service (if specified) */
+        if ( (service->service.port >= 0) &&
+             (service->service.port != conn->local_port) ) {
+            return false;
+        }
+        /* Check that the address matches the service (if specified) */
+        if ( (service->service.ipstr != NULL) &&
+             (service->ip_len == ip_len) &&
+             (strcmp(service->service.ipstr, conn->local_ipstr) != 0) )
+        {
+            return false;
+        }
+    }
+    ib_log_debug2(ib, "Connection %s:%d matched context service.",
+                  conn->local_ipstr, conn->local_port);
+
+    /* Check if the hostname matches the transaction data. */
+    rc = core_ctxsel_match_host(ib, tx, selector->hosts, &match);
+    if (rc != IB_OK) {
+        /* todo: What is the right thing to do here? */
+        return false;
+    }
+    if (! match) {
+        return false;
+    }
+
+    /* Check if the location matches the transaction data. */
+    rc = core_ctxsel_match_location(ib, tx, selector->locations, &location);
+    if (rc != IB_OK) {
+        /* todo: What is the right thing to do here? */
+        return false;
+    }
+    if (location == NULL) {
+        return false;
+    }
+
+    /* Everything matches.  Use this selector's context. */
+    ctx = location->location.context;
+
+    ib_log_debug2(ib, "Selected context \"%s\" site=%s(%s) location=%s",
+                  ib_context_full_get(ctx),
+                  (selector->site ? selector->site->site.id : "none"),
+                  (selector->site ? selector->site->site.name : "none"),
+                  location->location.path);
+    *pctx = ctx;
+    return true;
+}
+
 /**
  * Select the correct context for a connection / transaction.
  *
@@ -423,6 +614,61 @@ static ib_status_t core_ctxsel_finalize(
  *
  * @returns Status code
  */
+/** Slots in the per-worker negative selection cache. */
+#define CTXSEL_NEG_SLOTS 64
+
+/** Longest hostname cached; longer ones always run full selection. */
+#define CTXSEL_NEG_MAX_HOST 64
+
+/** How long a no-site verdict stays valid (usec). */
+#define CTXSEL_NEG_TTL_USEC (10 * 1000000ULL)
+
+/**
+ * One cached no-site verdict.
+ *
+ * Scanner floods probe with junk Host headers and every probe walked
+ * full site selection before falling back to the main context.  The
+ * verdict depends only on (hostname, local address, local port) and
+ * the engine's selector tables, so it is cached per worker thread with
+ * exact key bytes -- a slot collision can only cause a spurious full
+ * walk, never a wrong main-context fallback -- and tagged with the
+ * engine so a reload's new selectors are never short-circuited by old
+ * verdicts.
+ */
+typedef struct {
+    const ib_engine_t *ib;                        /**< Engine identity. */
+    ib_time_t          until;                     /**< Valid until. */
+    uint16_t           port;                      /**< Local port. */
+    uint8_t            host_len;                  /**< Hostname length. */
+    uint8_t            ip_len;                    /**< Local IP length. */
+    char               host[CTXSEL_NEG_MAX_HOST]; /**< Hostname. */
+    char               ip[46];                    /**< Local IP. */
+} ctxsel_neg_entry_t;
+
+static __thread ctxsel_neg_entry_t c_ctxsel_neg[CTXSEL_NEG_SLOTS];
+
+/** Slot for a selection key (djb2 over host, ip, port). */
+static ctxsel_neg_entry_t *ctxsel_neg_slot(
+    const char *host,
+    size_t      host_len,
+    const char *ip,
+    size_t      ip_len,
+    uint16_t    port
+)
+{
+    size_t hash = 5381;
+
+    for (size_t i = 0; i < host_len; ++i) {
+        hash = hash * 33 + (unsigned char)host[i];
+    }
+    for (size_t i = 0; i < ip_len; ++i) {
+        hash = hash * 33 + (unsigned char)ip[i];
+    }
+    hash = hash * 33 + port;
+
+    return &c_ctxsel_neg[hash % CTXSEL_NEG_SLOTS];
+}
+
 static ib_status_t core_ctxsel_select(
     const ib_engine_t *ib,
     const ib_conn_t *conn,
@@ -459,73 +705,103 @@ static ib_status_t core_ctxsel_select(
     /* Get the length of the IP address string before the main loop */
     ip_len = strlen(conn->local_ipstr);
 
+    /* Consult the per-worker negative cache: a recent no-site verdict
+     * for this exact (hostname, local address, port) skips the
+     * selection walk entirely. */
+    if (tx->hostname != NULL) {
+        size_t host_len = strlen(tx->hostname);
+
+        if (host_len <= CTXSEL_NEG_MAX_HOST && ip_len <= sizeof(((ctxsel_neg_entry_t *)0)->ip)) {
+            const ctxsel_neg_entry_t *entry = ctxsel_neg_slot(
+                tx->hostname, host_len,
+                conn->local_ipstr, ip_len,
+                conn->local_port);
+
+            if (entry->ib == ib &&
+                entry->until >= ib_clock_coarse_get_time() &&
+                entry->host_len == host_len &&
+                entry->ip_len == ip_len &&
+                entry->port == conn->local_port &&
+                memcmp(entry->host, tx->hostname, host_len) == 0 &&
+                memcmp(entry->ip, conn->local_ipstr, ip_len) == 0)
+            {
+                *pctx = ib_context_main(ib);
+                return IB_OK;
+            }
+        }
+    }
+
     /*
      * Walk through the list of site selectors, return when the first matching
      * selector is found.  At any point in the loop if a non-match is found,
      * we continue to the top of the loop, and try the next selector.
      */
-    IB_LIST_LOOP_CONST(core_data->selector_list, node) {
-        const core_site_selector_t *selector =
-            (const core_site_selector_t *)ib_list_node_data_const(node);
-        const core_service_t *service = selector->service;
-        const core_location_t *location;
-        ib_context_t *ctx;
-        bool match;
-
-        ib_log_debug2(ib, "Looking for matching context against site=%s(%s)",
-                      (selector->site ? selector->site->site.id : "none"),
-                      (selector->site ? selector->site->site.name : "none"));
-
-        /*
-         * Check if the service matches the connection data.
-         */
-        if ( (service != NULL) && (! service->match_any) ) {
-            /* Check that the port matches the service (if specified) */
-            if ( (service->service.port >= 0) &&
-                 (service->service.port != conn->local_port) ) {
-                continue;
-            }
-            /* Check that the address matches the service (if specified) */
-            if ( (service->service.ipstr != NULL) &&
-                 (service->ip_len == ip_len) &&
-                 (strcmp(service->service.ipstr, conn->local_ipstr) != 0) )
+    /* Evaluate one selector; sets *pctx and returns true on a match. */
+    /* (Inline helper via macro-free function would need many params;
+     * keep as a statement expression style helper below.) */
+
+    if (
+        core_data->selector_host_index != NULL &&
+        tx != NULL &&
+        tx->hostname != NULL
+    ) {
+        /* Indexed path: order-merge the selectors registered for this
+         * exact hostname with the wildcard/suffix fallback selectors.
+         * Evaluation per selector is identical to the full scan, so the
+         * first match is the same selector the scan would choose;
+         * selectors skipped by the index carry only exact hostnames
+         * different from this transaction's and can never match. */
+        ib_list_t *bucket = NULL;
+        const ib_list_node_t *a_node = NULL;
+        const ib_list_node_t *b_node;
+
+        rc = ib_hash_get(
+            core_data->selector_host_index, &bucket, tx->hostname);
+        if (rc == IB_OK && bucket != NULL) {
+            a_node = ib_list_first_const(bucket);
+        }
+        b_node = ib_list_first_const(core_data->selector_fallback);
+
+        while (a_node != NULL || b_node != NULL) {
+            const core_selector_ref_t *a_ref = (a_node != NULL)
+                ? (const core_selector_ref_t *)
+                      ib_list_node_data_const(a_node)
+                : NULL;
+            const core_selector_ref_t *b_ref = (b_node != NULL)
+                ? (const core_selector_ref_t *)
+                      ib_list_node_data_const(b_node)
+                : NULL;
+            const core_site_selector_t *selector;
+
+            if (a_ref != NULL &&
+                (b_ref == NULL || a_ref->order < b_ref->order))
             {
-                continue;
+                selector = a_ref->selector;
+                a_node = ib_list_node_next_const(a_node);
+            }
+            else {
+                selector = b_ref->selector;
+                b_node = ib_list_node_next_const(b_node);
             }
-        }
-        ib_log_debug2(ib, "Connection %s:%d matched context service.",
-                      conn->local_ipstr, conn->local_port);
 
-        /* Check if the hostname matches the transaction data. */
-        rc = core_ctxsel_match_host(ib, tx, selector->hosts, &match);
-        if (rc != IB_OK) {
-            /* todo: What is the right thing to do here? */
-            continue;
-        }
-        if (! match) {
-            continue;
+            if (core_ctxsel_try_selector(
+                    ib, conn, tx, ip_len, selector, pctx))
+            {
+                return IB_OK;
+            }
         }
+    }
+    else {
+        IB_LIST_LOOP_CONST(core_data->selector_list, node) {
+            const core_site_selector_t *selector =
+                (const core_site_selector_t *)ib_list_node_data_const(node);
 
-        /* Check if the location matches the transaction data. */
-        rc = core_ctxsel_match_location(ib, tx, selector->locations, &location);
-        if (rc != IB_OK) {
-            /* todo: What is the right thing to do here? */
-            continue;
-        }
-        if (location == NULL) {
-            continue;
+            if (core_ctxsel_try_selector(
+                    ib, conn, tx, ip_len, selector, pctx))
+            {
+                return IB_OK;
+            }
         }
-
-        /* Everything matches.  Use this selector's context. */
-        ctx = location->location.context;
-
-        ib_log_debug2(ib, "Selected context \"%s\" site=%s(%s) location=%s",
-                      ib_context_full_get(ctx),
-                      (selector->site ? selector->site->site.id : "none"),
-                      (selector->site ? selector->site->site.name : "none"),
-                      location->location.path);
-        *pctx = ctx;
-        return IB_OK;
     }
 
     /*
@@ -536,6 +812,31 @@ static ib_status_t core_ctxsel_select(
         ib_log_notice(ib, "No matching site found for transaction:"
                       " IP=%s port=%u host=\"%s\"",
                       conn->local_ipstr, conn->local_port, tx->hostname);
+
+        /* Remember the verdict so repeated probes for this key cost
+         * one cache lookup instead of the walk. */
+        if (tx->hostname != NULL) {
+            size_t host_len = strlen(tx->hostname);
+
+            if (host_len <= CTXSEL_NEG_MAX_HOST &&
+                ip_len <= sizeof(((ctxsel_neg_entry_t *)0)->ip))
+            {
+                ctxsel_neg_entry_t *entry = ctxsel_neg_slot(
+                    tx->hostname, host_len,
+                    conn->local_ipstr, ip_len,
+                    conn->local_port);
+
+                entry->ib = NULL;  /* Invalid while the bytes change. */
+                memcpy(entry->host, tx->hostname, host_len);
+                memcpy(entry->ip, conn->local_ipstr, ip_len);
+                entry->host_len = (uint8_t)host_len;
+                entry->ip_len = (uint8_t)ip_len;
+                entry->port = conn->local_port;
+                entry->until =
+                    ib_clock_coarse_get_time() + CTXSEL_NEG_TTL_USEC;
+                entry->ib = ib;
+            }
+        }
     }
 
 select_main_context:
@@ -303,6 +303,93 @@ struct numop_instance_data_t {
 };
 typedef struct numop_instance_data_t numop_instance_data_t;
 
+/**
+ * Which of the "str" family of operators an instance serves.
+ *
+ * Passed as creation callback data so strop_create() only precomputes
+ * the specialization each operator actually uses.
+ */
+#define STROP_STREQ    ((void *)0)
+#define STROP_ISTREQ   ((void *)1)
+#define STROP_CONTAINS ((void *)2)
+
+/**
+ * Instance data for the "str" family of operators.
+ *
+ * When the parameter contains no var expansions -- the overwhelmingly
+ * common case -- the comparison is specialized at instance creation:
+ * the constant's length and (for short constants) word packing for
+ * streq, a case-folded copy for istreq so execution folds only the
+ * value side, and a Boyer-Moore-Horspool skip table for contains.
+ * Parameters that do expand fall back to the generic comparisons.
+ */
+typedef struct {
+    const ib_var_expand_t *expand;   /**< Parameter, for expansion. */
+    bool                   is_const; /**< No expansions; fields below set. */
+    const char            *cstr;     /**< Constant parameter. */
+    size_t                 cstr_len; /**< Length of cstr. */
+    uint64_t               cword;    /**< cstr packed into a word, low byte
+                                          first; valid when cstr_len <= 8. */
+    const char            *cfolded;  /**< tolower(cstr); istreq only. */
+    const uint8_t         *skip;     /**< Horspool skip table; contains
+                                          only, and only if cstr_len > 1. */
+} strop_instance_data_t;
+
+/**
+ * Pack up to 8 bytes into a word, low byte first.
+ */
+static uint64_t strop_pack_word(const char *s, size_t len)
+{
+    uint64_t word = 0;
+
+    assert(len <= 8);
+    for (size_t i = 0; i < len; ++i) {
+        word |= (uint64_t)(uint8_t)s[i] << (8 * i);
+    }
+
+    return word;
+}
+
+/**
+ * Find @a data's constant in @a haystack via the precomputed skip table.
+ *
+ * Matches ib_strstr() semantics: an empty needle matches at the start
+ * of any haystack.
+ */
+static
+const char *strop_contains_search(
+    const strop_instance_data_t *data,
+    const char                  *haystack,
+    size_t                       haystack_len
+)
+{
+    const char   *needle = data->cstr;
+    const size_t  needle_len = data->cstr_len;
+
+    if (needle_len == 0) {
+        return haystack;
+    }
+    if (haystack == NULL || needle_len > haystack_len) {
+        return NULL;
+    }
+    if (needle_len == 1) {
+        return (const char *)memchr(haystack, needle[0], haystack_len);
+    }
+
+    const uint8_t last = (uint8_t)needle[needle_len - 1];
+    size_t        i = 0;
+
+    while (i + needle_len <= haystack_len) {
+        const uint8_t c = (uint8_t)haystack[i + needle_len - 1];
+        if (c == last && memcmp(haystack + i, needle, needle_len - 1) == 0) {
+            return haystack + i;
+        }
+        i += data->skip[c];
+    }
+
+    return NULL;
+}
+
 /**
  * Create function for the "str" family of operators
  *
@@ -310,7 +397,8 @@ typedef struct numop_instance_data_t numop_instance_data_t;
  * @param[in]  mm Memory manager.
  * @param[in]  parameters Constant parameters
  * @param[out] instance_data Instance Data.
- * @param[in]  cbdata Callback data.
+ * @param[in]  cbdata Callback data; one of STROP_STREQ, STROP_ISTREQ
+ *             or STROP_CONTAINS.
  *
  * @returns Status code
  */
@@ -341,10 +429,15 @@ ib_status_t strop_create(
         return rc;
     }
 
-    ib_var_expand_t *data;
+    strop_instance_data_t *data = ib_mm_calloc(mm, sizeof(*data), 1);
+    if (data == NULL) {
+        return IB_EALLOC;
+    }
+
+    ib_var_expand_t *expand;
     // @todo Catch and report error_message and error_offset.
     rc = ib_var_expand_acquire(
-        &data,
+        &expand,
         mm,
         str, str_len,
         ib_engine_var_config_get(ib)
@@ -352,8 +445,44 @@ ib_status_t strop_create(
     if (rc != IB_OK) {
         return rc;
     }
+    data->expand = expand;
+
+    /* Specialize constant (non-expanding) parameters. */
+    if (! ib_var_expand_test(str, str_len)) {
+        data->is_const = true;
+        data->cstr     = str;
+        data->cstr_len = str_len;
+
+        if (str_len <= 8) {
+            data->cword = strop_pack_word(str, str_len);
+        }
+
+        if (cbdata == STROP_ISTREQ) {
+            char *folded = ib_mm_alloc(mm, str_len);
+            if (folded == NULL && str_len > 0) {
+                return IB_EALLOC;
+            }
+            for (size_t i = 0; i < str_len; ++i) {
+                folded[i] = tolower((unsigned char)str[i]);
+            }
+            data->cfolded = folded;
+        }
+
+        if (cbdata == STROP_CONTAINS && str_len > 1) {
+            uint8_t *skip = ib_mm_alloc(mm, 256);
+            if (skip == NULL) {
+                return IB_EALLOC;
+            }
+            memset(skip, (int)(str_len > 255 ? 255 : str_len), 256);
+            for (size_t i = 0; i + 1 < str_len; ++i) {
+                size_t s = str_len - 1 - i;
+                skip[(uint8_t)str[i]] = (uint8_t)(s > 255 ? 255 : s);
+            }
+            data->skip = skip;
+        }
+    }
 
-    *(ib_var_expand_t **)instance_data = data;
+    *(strop_instance_data_t **)instance_data = data;
 
     return IB_OK;
 }
@@ -389,18 +518,27 @@ ib_status_t op_streq_execute(
     bool         case_insensitive;
     case_insensitive = (cbdata != NULL);
 
+    const strop_instance_data_t *data =
+        (const strop_instance_data_t *)instance_data;
+
     const char  *expanded;
     size_t       expanded_length;
 
-    /* Expand the string */
-    rc = ib_var_expand_execute(
-        (const ib_var_expand_t *)instance_data,
-        &expanded, &expanded_length,
-        tx->mm,
-        tx->var_store
-    );
-    if (rc != IB_OK) {
-        return rc;
+    /* Constant parameters skip expansion entirely. */
+    if (data->is_const) {
+        expanded        = data->cstr;
+        expanded_length = data->cstr_len;
+    }
+    else {
+        rc = ib_var_expand_execute(
+            data->expand,
+            &expanded, &expanded_length,
+            tx->mm,
+            tx->var_store
+        );
+        if (rc != IB_OK) {
+            return rc;
+        }
     }
 
     /* Handle NUL-terminated strings and byte strings */
@@ -435,25 +573,40 @@ ib_status_t op_streq_execute(
 
         len = ib_bytestr_length(value);
 
-        if (len == expanded_length) {
-            if (case_insensitive) {
-                *result = 1;
-                const char *v = (const char *)ib_bytestr_const_ptr(value);
+        if (len != expanded_length) {
+            *result = 0;
+        }
+        else if (case_insensitive) {
+            const char *v = (const char *)ib_bytestr_const_ptr(value);
+            *result = 1;
+            if (data->is_const && data->cfolded != NULL) {
+                /* The constant side was folded at creation; only the
+                 * value side is folded per call. */
                 for (size_t i = 0; i < len; ++i) {
-                    if (tolower(expanded[i]) != tolower(v[i])) {
+                    if (tolower((unsigned char)v[i]) != data->cfolded[i]) {
                         *result = 0;
                         break;
                     }
                 }
             }
             else {
-                *result = (
-                    memcmp(ib_bytestr_const_ptr(value), expanded, len) == 0
-                );
+                for (size_t i = 0; i < len; ++i) {
+                    if (tolower(expanded[i]) != tolower(v[i])) {
+                        *result = 0;
+                        break;
+                    }
+                }
             }
         }
+        else if (data->is_const && len <= 8) {
+            /* Short constants compare as a single word. */
+            const char *v = (const char *)ib_bytestr_const_ptr(value);
+            *result = (strop_pack_word(v, len) == data->cword);
+        }
         else {
-            *result = 0;
+            *result = (
+                memcmp(ib_bytestr_const_ptr(value), expanded, len) == 0
+            );
         }
     }
     else {
@@ -503,18 +656,27 @@ ib_status_t op_contains_execute(
 
     ib_status_t  rc = IB_OK;
 
+    const strop_instance_data_t *data =
+        (const strop_instance_data_t *)instance_data;
+
     const char  *expanded;
     size_t       expanded_length;
 
-    /* Expand the string */
-    rc = ib_var_expand_execute(
-        (const ib_var_expand_t *)instance_data,
-        &expanded, &expanded_length,
-        tx->mm,
-        tx->var_store
-    );
-    if (rc != IB_OK) {
-        return rc;
+    /* Constant parameters skip expansion entirely. */
+    if (data->is_const) {
+        expanded        = data->cstr;
+        expanded_length = data->cstr_len;
+    }
+    else {
+        rc = ib_var_expand_execute(
+            data->expand,
+            &expanded, &expanded_length,
+            tx->mm,
+            tx->var_store
+        );
+        if (rc != IB_OK) {
+            return rc;
+        }
     }
 
     if (field->type == IB_FTYPE_NULSTR) {
@@ -524,7 +686,10 @@ ib_status_t op_contains_execute(
             return rc;
         }
 
-        if (memmem(s, strlen(s), expanded, expanded_length) == NULL) {
+        if (data->is_const) {
+            *result = (strop_contains_search(data, s, strlen(s)) != NULL);
+        }
+        else if (memmem(s, strlen(s), expanded, expanded_length) == NULL) {
             *result = 0;
         }
         else {
@@ -543,13 +708,24 @@ ib_status_t op_contains_execute(
             return IB_OK;
         }
 
-        *result = (
-            ib_strstr(
-                (const char *)ib_bytestr_const_ptr(str),
-                ib_bytestr_length(str),
-                expanded, expanded_length
-            ) != NULL
-        );
+        if (data->is_const) {
+            *result = (
+                strop_contains_search(
+                    data,
+                    (const char *)ib_bytestr_const_ptr(str),
+                    ib_bytestr_length(str)
+                ) != NULL
+            );
+        }
+        else {
+            *result = (
+                ib_strstr(
+                    (const char *)ib_bytestr_const_ptr(str),
+                    ib_bytestr_length(str),
+                    expanded, expanded_length
+                ) != NULL
+            );
+        }
     }
     else {
         return IB_EINVAL;
@@ -2030,8 +2206,8 @@ ib_status_t ib_core_operators_init(ib_engine_t *ib, ib_module_t *mod)
         NULL,
         ib,
         "streq",
-        IB_OP_CAPABILITY_CAPTURE,
-        strop_create, NULL,
+        IB_OP_CAPABILITY_CAPTURE | IB_OP_CAPABILITY_PURE,
+        strop_create, STROP_STREQ,
         NULL, NULL,
         op_streq_execute, NULL
     );
@@ -2044,8 +2220,8 @@ ib_status_t ib_core_operators_init(ib_engine_t *ib, ib_module_t *mod)
         NULL,
         ib,
         "istreq",
-        IB_OP_CAPABILITY_CAPTURE,
-        strop_create, NULL,
+        IB_OP_CAPABILITY_CAPTURE | IB_OP_CAPABILITY_PURE,
+        strop_create, STROP_ISTREQ,
         NULL, NULL,
         op_streq_execute, (void *)1
     );
@@ -2058,8 +2234,8 @@ ib_status_t ib_core_operators_init(ib_engine_t *ib, ib_module_t *mod)
         NULL,
         ib,
         "contains",
-        IB_OP_CAPABILITY_CAPTURE,
-        strop_create, NULL,
+        IB_OP_CAPABILITY_CAPTURE | IB_OP_CAPABILITY_PURE,
+        strop_create, STROP_CONTAINS,
         NULL, NULL,
         op_contains_execute, NULL
     );
@@ -2072,7 +2248,7 @@ ib_status_t ib_core_operators_init(ib_engine_t *ib, ib_module_t *mod)
         NULL,
         ib,
         "match",
-        IB_OP_CAPABILITY_CAPTURE,
+        IB_OP_CAPABILITY_CAPTURE | IB_OP_CAPABILITY_PURE,
         op_match_create, NULL,
         NULL, NULL,
         op_match_execute, NULL
@@ -2086,7 +2262,7 @@ ib_status_t ib_core_operators_init(ib_engine_t *ib, ib_module_t *mod)
         NULL,
         ib,
         "imatch",
-        IB_OP_CAPABILITY_CAPTURE,
+        IB_OP_CAPABILITY_CAPTURE | IB_OP_CAPABILITY_PURE,
         op_match_create, (void *)1,
         NULL, NULL,
         op_match_execute, /* Note: same as above. */ NULL
@@ -2100,7 +2276,7 @@ ib_status_t ib_core_operators_init(ib_engine_t *ib, ib_module_t *mod)
         NULL,
         ib,
         "ipmatch",
-        IB_OP_CAPABILITY_CAPTURE,
+        IB_OP_CAPABILITY_CAPTURE | IB_OP_CAPABILITY_PURE,
         op_ipmatch_create, NULL,
         NULL, NULL,
         op_ipmatch_execute, NULL
@@ -2114,7 +2290,7 @@ ib_status_t ib_core_operators_init(ib_engine_t *ib, ib_module_t *mod)
         NULL,
         ib,
         "ipmatch6",
-        IB_OP_CAPABILITY_CAPTURE,
+        IB_OP_CAPABILITY_CAPTURE | IB_OP_CAPABILITY_PURE,
         op_ipmatch6_create, NULL,
         NULL, NULL,
         op_ipmatch6_execute, NULL
@@ -2132,7 +2308,7 @@ ib_status_t ib_core_operators_init(ib_engine_t *ib, ib_module_t *mod)
         NULL,
         ib,
         "eq",
-        IB_OP_CAPABILITY_CAPTURE,
+        IB_OP_CAPABILITY_CAPTURE | IB_OP_CAPABILITY_PURE,
         op_numcmp_create, op_eq_execute,
         NULL, NULL,
         op_eq_execute, NULL
@@ -2146,7 +2322,7 @@ ib_status_t ib_core_operators_init(ib_engine_t *ib, ib_module_t *mod)
         NULL,
         ib,
         "ne",
-        IB_OP_CAPABILITY_CAPTURE,
+        IB_OP_CAPABILITY_CAPTURE | IB_OP_CAPABILITY_PURE,
         op_numcmp_create, op_ne_execute,
         NULL, NULL,
         op_ne_execute, NULL
@@ -2160,7 +2336,7 @@ ib_status_t ib_core_operators_init(ib_engine_t *ib, ib_module_t *mod)
         NULL,
         ib,
         "gt",
-        IB_OP_CAPABILITY_CAPTURE,
+        IB_OP_CAPABILITY_CAPTURE | IB_OP_CAPABILITY_PURE,
         op_numcmp_create, op_gt_execute,
         NULL, NULL,
         op_gt_execute, NULL
@@ -2174,7 +2350,7 @@ ib_status_t ib_core_operators_init(ib_engine_t *ib, ib_module_t *mod)
         NULL,
         ib,
         "lt",
-        IB_OP_CAPABILITY_CAPTURE,
+        IB_OP_CAPABILITY_CAPTURE | IB_OP_CAPABILITY_PURE,
         op_numcmp_create, op_lt_execute,
         NULL, NULL,
         op_lt_execute, NULL
@@ -2188,7 +2364,7 @@ ib_status_t ib_core_operators_init(ib_engine_t *ib, ib_module_t *mod)
         NULL,
         ib,
         "ge",
-        IB_OP_CAPABILITY_CAPTURE,
+        IB_OP_CAPABILITY_CAPTURE | IB_OP_CAPABILITY_PURE,
         op_numcmp_create, op_ge_execute,
         NULL, NULL,
         op_ge_execute, NULL
@@ -2202,7 +2378,7 @@ ib_status_t ib_core_operators_init(ib_engine_t *ib, ib_module_t *mod)
         NULL,
         ib,
         "le",
-        IB_OP_CAPABILITY_CAPTURE,
+        IB_OP_CAPABILITY_CAPTURE | IB_OP_CAPABILITY_PURE,
         op_numcmp_create, op_le_execute,
         NULL, NULL,
         op_le_execute, NULL
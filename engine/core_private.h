@@ -48,6 +48,20 @@ typedef struct {
     ib_context_t         *cur_ctx;        /**< Current context */
     ib_site_t            *cur_site;       /**< Current site */
     ib_site_location_t   *cur_location;   /**< Current location */
+
+    /**
+     * Exact-hostname index over selector_list.
+     *
+     * Maps hostname (case insensitive) to an ordered list of
+     * core_selector_ref_t for selectors carrying that exact host;
+     * selectors with wildcard or suffix hosts (or no hosts, which match
+     * anything) are on selector_fallback.  Selection order-merges the
+     * two lists by selector position, so results are identical to the
+     * full scan while sites with exact hostnames stop paying for each
+     * other.  NULL when no index was built.
+     */
+    ib_hash_t            *selector_host_index;
+    ib_list_t            *selector_fallback; /**< Ordered fallback list. */
 } ib_core_module_data_t;
 
 /** Core module transaction data */
@@ -26,6 +26,8 @@
 #include "core_stream_processor_private.h"
 
 #include <ironbee/stream_io.h>
+#include <ironbee/string.h>
+#include <ironbee/var.h>
 #include <ironbee/stream_processor.h>
 #include <ironbee/stream_pump.h>
 #include <ironbee/log.h>
@@ -37,8 +39,63 @@
 
 static const char *CORE_PROCESSOR_NAME_REQ = "req_raw";
 static const char *CORE_PROCESSOR_NAME_RESP = "resp_raw";
+static const char *CORE_PROCESSOR_NAME_SAMPLE = "resp_sample";
 static const char *CORE_PROCESSOR_TYPE = "raw";
 
+/** Overlap carried into each interior window so any match no longer
+ * than this, lying within one (overlap + window) region, is seen in
+ * full by automata and regex operators downstream. */
+#define SAMPLE_OVERLAP 256
+
+/** Interior stratum size: one random window is taken per stratum. */
+#define SAMPLE_STRATUM (1024 * 1024)
+
+/**
+ * Response body sampling processor instance.
+ *
+ * When a per-context budget is configured, large response bodies are
+ * inspected partially but with known coverage: the head passes
+ * through up to half the budget, the final bytes are held in a tail
+ * ring and emitted at end of body, and the interior is sampled one
+ * random window per stratum, each window preceded by the last
+ * SAMPLE_OVERLAP bytes of the stream so automata and regex operators
+ * are sound for any match contained in an emitted region.  The
+ * inspected fraction is recorded in the RESPONSE_BODY_COVERAGE var
+ * (a float in [0, 1]) for rules to reason about.  Bodies no larger
+ * than the head share (half the budget) pass through whole with
+ * coverage 1.
+ *
+ * This gates what downstream processors and stream rules inspect; the
+ * server's delivery of the response is unaffected.
+ */
+typedef struct {
+    ib_tx_t  *tx;            /**< The transaction. */
+    size_t    budget;        /**< Total bytes to inspect. */
+    size_t    window;        /**< Interior window size. */
+    size_t    head_left;     /**< Head bytes still passing through. */
+
+    size_t    total_in;      /**< Body bytes seen. */
+    size_t    total_out;     /**< Body bytes forwarded. */
+
+    /* Interior sampling state. */
+    size_t    stratum_off;   /**< Offset within the current stratum. */
+    size_t    win_start;     /**< Window start within the stratum. */
+    size_t    win_left;      /**< Bytes of the current window left. */
+    unsigned  seed;          /**< rand_r() state. */
+
+    /* Overlap ring: the last SAMPLE_OVERLAP bytes of the stream. */
+    uint8_t   overlap[SAMPLE_OVERLAP];
+    size_t    overlap_len;   /**< Valid bytes in overlap. */
+
+    /* Tail ring: the final bytes, emitted at end of body. */
+    uint8_t  *tail;          /**< Ring buffer of tail_cap bytes. */
+    size_t    tail_cap;      /**< Capacity of tail. */
+    size_t    tail_len;      /**< Valid bytes (<= tail_cap). */
+    size_t    tail_pos;      /**< Next write position. */
+
+    bool      finished;      /**< End of body handled. */
+} sample_inst_t;
+
 /**
  * The configuration data for a filter.
  */
@@ -294,6 +351,360 @@ static ib_status_t processor_exec_fn(
     return IB_OK;
 }
 
+/** Remember the last bytes of the stream in @a inst's rings. */
+static void sample_remember(
+    sample_inst_t *inst,
+    const uint8_t *data,
+    size_t         len
+)
+{
+    /* Overlap ring: keep the most recent SAMPLE_OVERLAP bytes. */
+    if (len >= SAMPLE_OVERLAP) {
+        memcpy(inst->overlap, data + len - SAMPLE_OVERLAP, SAMPLE_OVERLAP);
+        inst->overlap_len = SAMPLE_OVERLAP;
+    }
+    else {
+        size_t keep = SAMPLE_OVERLAP - len;
+
+        if (inst->overlap_len > keep) {
+            memmove(
+                inst->overlap,
+                inst->overlap + inst->overlap_len - keep,
+                keep);
+            inst->overlap_len = keep;
+        }
+        memcpy(inst->overlap + inst->overlap_len, data, len);
+        inst->overlap_len += len;
+    }
+
+    /* Tail ring. */
+    if (inst->tail_cap > 0) {
+        for (size_t i = 0; i < len; ++i) {
+            inst->tail[inst->tail_pos] = data[i];
+            inst->tail_pos = (inst->tail_pos + 1) % inst->tail_cap;
+        }
+        inst->tail_len += len;
+        if (inst->tail_len > inst->tail_cap) {
+            inst->tail_len = inst->tail_cap;
+        }
+    }
+}
+
+/** Emit @a len bytes at @a data as a fresh output segment. */
+static ib_status_t sample_emit(
+    sample_inst_t     *inst,
+    ib_stream_io_tx_t *io_tx,
+    const uint8_t     *data,
+    size_t             len
+)
+{
+    ib_stream_io_data_t *out;
+    uint8_t             *ptr;
+    ib_status_t          rc;
+
+    if (len == 0) {
+        return IB_OK;
+    }
+    rc = ib_stream_io_data_alloc(io_tx, len, &out, &ptr);
+    if (rc != IB_OK) {
+        return rc;
+    }
+    memcpy(ptr, data, len);
+    inst->total_out += len;
+    return ib_stream_io_data_put(io_tx, out);
+}
+
+/** Choose the next interior window start within a fresh stratum. */
+static void sample_next_window(sample_inst_t *inst)
+{
+    size_t range = SAMPLE_STRATUM - inst->window;
+
+    inst->stratum_off = 0;
+    inst->win_start = (size_t)rand_r(&inst->seed) % (range + 1);
+    inst->win_left = 0;
+}
+
+/** End of body: emit the tail ring and record coverage. */
+static ib_status_t sample_finish(
+    sample_inst_t     *inst,
+    ib_stream_io_tx_t *io_tx
+)
+{
+    ib_status_t rc;
+
+    if (inst->finished) {
+        return IB_OK;
+    }
+    inst->finished = true;
+
+    /* Emit the retained tail (already counted as seen). */
+    if (inst->tail_len > 0 && inst->total_in > inst->budget) {
+        size_t start = (inst->tail_pos + inst->tail_cap - inst->tail_len)
+                       % inst->tail_cap;
+
+        if (start + inst->tail_len <= inst->tail_cap) {
+            rc = sample_emit(inst, io_tx, inst->tail + start, inst->tail_len);
+        }
+        else {
+            size_t first = inst->tail_cap - start;
+
+            rc = sample_emit(inst, io_tx, inst->tail + start, first);
+            if (rc == IB_OK) {
+                rc = sample_emit(
+                    inst, io_tx, inst->tail, inst->tail_len - first);
+            }
+        }
+        if (rc != IB_OK) {
+            return rc;
+        }
+    }
+
+    /* Record the inspected fraction for rules. */
+    {
+        ib_var_source_t *source;
+        ib_field_t      *field;
+        ib_float_t       coverage =
+            (inst->total_in == 0)
+            ? 1.0
+            : (ib_float_t)inst->total_out / (ib_float_t)inst->total_in;
+
+        if (coverage > 1.0) {
+            coverage = 1.0;
+        }
+
+        rc = ib_var_source_acquire(
+            &source,
+            inst->tx->mm,
+            ib_engine_var_config_get(inst->tx->ib),
+            IB_S2SL("RESPONSE_BODY_COVERAGE"));
+        if (rc == IB_OK) {
+            rc = ib_field_create(
+                &field, inst->tx->mm,
+                IB_S2SL("RESPONSE_BODY_COVERAGE"),
+                IB_FTYPE_FLOAT,
+                ib_ftype_float_in(&coverage));
+            if (rc == IB_OK) {
+                ib_var_source_set(source, inst->tx->var_store, field);
+            }
+        }
+    }
+
+    return IB_OK;
+}
+
+/**
+ * Construct a sampling processor.
+ */
+static ib_status_t sample_create_fn(
+    void    *inst_data,
+    ib_tx_t *tx,
+    void    *cbdata
+)
+{
+    assert(inst_data != NULL);
+    assert(tx != NULL);
+
+    sample_inst_t *inst;
+    ib_core_cfg_t *corecfg = NULL;
+    ib_status_t    rc;
+
+    rc = ib_core_context_config(tx->ctx, &corecfg);
+    if (rc != IB_OK) {
+        return rc;
+    }
+
+    inst = ib_mm_calloc(tx->mm, sizeof(*inst), 1);
+    if (inst == NULL) {
+        return IB_EALLOC;
+    }
+
+    inst->tx     = tx;
+    inst->budget = (size_t)corecfg->response_sample_budget;
+    inst->window = (size_t)corecfg->response_sample_window;
+    if (inst->window > SAMPLE_STRATUM / 2) {
+        inst->window = SAMPLE_STRATUM / 2;
+    }
+    if (inst->window == 0) {
+        inst->window = 1;
+    }
+
+    /* Head gets half the budget; tail an eighth; interior the rest. */
+    inst->head_left = inst->budget / 2;
+    inst->tail_cap  = inst->budget / 8;
+    if (inst->tail_cap > 0) {
+        inst->tail = ib_mm_alloc(tx->mm, inst->tail_cap);
+        if (inst->tail == NULL) {
+            return IB_EALLOC;
+        }
+    }
+
+    /* Deterministic per transaction, varied across transactions. */
+    inst->seed = (unsigned)(uintptr_t)tx ^ (unsigned)tx->t.started;
+    sample_next_window(inst);
+
+    *(sample_inst_t **)inst_data = inst;
+    return IB_OK;
+}
+
+/**
+ * The sampling processor implementation.
+ */
+static ib_status_t sample_exec_fn(
+    void              *inst_data,
+    ib_tx_t           *tx,
+    ib_mm_t            mm_eval,
+    ib_stream_io_tx_t *io_tx,
+    void              *cbdata
+)
+{
+    assert(inst_data != NULL);
+    assert(tx != NULL);
+
+    sample_inst_t *inst = (sample_inst_t *)inst_data;
+    ib_status_t    rc;
+
+    while (ib_stream_io_data_depth(io_tx) > 0) {
+        ib_stream_io_data_t *data;
+        uint8_t             *ptr;
+        size_t               len;
+        ib_stream_io_type_t  type;
+
+        rc = ib_stream_io_data_take(io_tx, &data, &ptr, &len, &type);
+        if (rc != IB_OK) {
+            return rc;
+        }
+
+        if (type == IB_STREAM_IO_FLUSH) {
+            /* End of body: tail, coverage, then the flush itself. */
+            rc = sample_finish(inst, io_tx);
+            if (rc != IB_OK) {
+                ib_stream_io_data_unref(io_tx, data);
+                return rc;
+            }
+            rc = ib_stream_io_data_put(io_tx, data);
+            if (rc != IB_OK) {
+                return rc;
+            }
+            continue;
+        }
+        if (ptr == NULL || len == 0) {
+            rc = ib_stream_io_data_put(io_tx, data);
+            if (rc != IB_OK) {
+                return rc;
+            }
+            continue;
+        }
+
+        inst->total_in += len;
+
+        /* Within budget so far: pass everything through. */
+        if (inst->head_left >= len) {
+            inst->head_left -= len;
+            inst->total_out += len;
+            sample_remember(inst, ptr, len);
+            rc = ib_stream_io_data_put(io_tx, data);
+            if (rc != IB_OK) {
+                return rc;
+            }
+            continue;
+        }
+
+        /* Head boundary or interior: walk the chunk. */
+        {
+            size_t off = 0;
+
+            /* Finish the head. */
+            if (inst->head_left > 0) {
+                ib_stream_io_data_t *slice;
+
+                rc = ib_stream_io_data_slice(
+                    io_tx, data, 0, inst->head_left, &slice, NULL);
+                if (rc != IB_OK) {
+                    ib_stream_io_data_unref(io_tx, data);
+                    return rc;
+                }
+                inst->total_out += inst->head_left;
+                rc = ib_stream_io_data_put(io_tx, slice);
+                if (rc != IB_OK) {
+                    ib_stream_io_data_unref(io_tx, data);
+                    return rc;
+                }
+                off = inst->head_left;
+                inst->head_left = 0;
+            }
+
+            /* Interior: emit the current stratum's window when the
+             * cursor crosses it; everything is remembered for the
+             * overlap and tail rings. */
+            while (off < len) {
+                size_t span = len - off;
+
+                if (inst->win_left > 0) {
+                    /* In a window: forward. */
+                    ib_stream_io_data_t *slice;
+
+                    if (span > inst->win_left) {
+                        span = inst->win_left;
+                    }
+                    rc = ib_stream_io_data_slice(
+                        io_tx, data, off, span, &slice, NULL);
+                    if (rc != IB_OK) {
+                        ib_stream_io_data_unref(io_tx, data);
+                        return rc;
+                    }
+                    inst->total_out += span;
+                    rc = ib_stream_io_data_put(io_tx, slice);
+                    if (rc != IB_OK) {
+                        ib_stream_io_data_unref(io_tx, data);
+                        return rc;
+                    }
+                    inst->win_left -= span;
+                }
+                else if (inst->stratum_off < inst->win_start) {
+                    /* Skipping toward the window. */
+                    size_t to_window = inst->win_start - inst->stratum_off;
+
+                    if (span > to_window) {
+                        span = to_window;
+                    }
+                }
+                else if (inst->stratum_off == inst->win_start) {
+                    /* Window opens here: emit the overlap prefix, then
+                     * start forwarding. */
+                    rc = sample_emit(
+                        inst, io_tx, inst->overlap, inst->overlap_len);
+                    if (rc != IB_OK) {
+                        ib_stream_io_data_unref(io_tx, data);
+                        return rc;
+                    }
+                    inst->win_left = inst->window;
+                    continue;  /* Re-enter with win_left set. */
+                }
+                else {
+                    /* Past the window: skip out the stratum. */
+                    size_t to_end = SAMPLE_STRATUM - inst->stratum_off;
+
+                    if (span > to_end) {
+                        span = to_end;
+                    }
+                }
+
+                sample_remember(inst, ptr + off, span);
+                off += span;
+                inst->stratum_off += span;
+
+                if (inst->stratum_off >= SAMPLE_STRATUM) {
+                    sample_next_window(inst);
+                }
+            }
+        }
+
+        ib_stream_io_data_unref(io_tx, data);
+    }
+
+    return IB_OK;
+}
+
 ib_status_t ib_core_stream_processor_init(
     ib_engine_t *ib,
     ib_module_t *core_module
@@ -352,6 +763,19 @@ ib_status_t ib_core_stream_processor_init(
         goto cleanup;
     }
 
+    rc = ib_stream_processor_registry_register(
+        ib_engine_stream_processor_registry(ib),
+        CORE_PROCESSOR_NAME_SAMPLE,
+        core_types,
+        sample_create_fn, NULL,
+        sample_exec_fn, NULL,
+        NULL, NULL
+    );
+    if (rc != IB_OK) {
+        ib_log_alert(ib, "Failed to register core module's sampling processor.");
+        goto cleanup;
+    }
+
 cleanup:
     ib_mpool_lite_destroy(mpl);
     return rc;
@@ -376,6 +800,19 @@ ib_status_t ib_core_stream_processor_tx_init(
         return rc;
     }
 
+    /* When a sampling budget is configured, gate response inspection
+     * behind the sampler (after the raw buffer processor, so audit
+     * logging still sees the unsampled body up to its own limits). */
+    if (corecfg->response_sample_budget > 0) {
+        rc = ib_stream_pump_processor_insert(
+            ib_tx_response_body_pump(tx),
+            CORE_PROCESSOR_NAME_SAMPLE,
+            1);
+        if (rc != IB_OK) {
+            return rc;
+        }
+    }
+
     /* Create the request processor and place it at index 0. */
     rc = ib_stream_pump_processor_insert(
         ib_tx_request_body_pump(tx),
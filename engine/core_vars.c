@@ -56,6 +56,7 @@ typedef struct {
 } indexed_key_t;
 indexed_key_t indexed_keys[] = {
 {"ARGS",                  IB_PHASE_REQUEST_HEADER,  IB_PHASE_REQUEST},
+{"CAPTURE",               IB_PHASE_NONE,            IB_PHASE_NONE},
 {"FLAGS",                 IB_PHASE_NONE,            IB_PHASE_NONE},
 {"auth_password",         IB_PHASE_REQUEST_HEADER,  IB_PHASE_REQUEST_HEADER},
 {"auth_type",             IB_PHASE_REQUEST_HEADER,  IB_PHASE_REQUEST_HEADER},
@@ -243,6 +244,116 @@ static void core_gen_tx_bytestr_alias2(
     core_gen_tx_bytestr_alias(tx, name, bytestr);
 }
 
+static void core_gen_conn_bytestr_alias2(
+    ib_tx_t *tx,
+    const char *name,
+    const char *val, size_t val_length
+)
+{
+    assert(tx != NULL);
+    assert(tx->conn != NULL);
+    assert(tx->conn->var_store != NULL);
+    assert(name != NULL);
+    assert(val != NULL);
+
+    ib_conn_t *conn = tx->conn;
+    ib_status_t rc;
+    ib_bytestr_t *bytestr;
+    ib_field_t *f;
+    ib_var_source_t *source;
+
+    rc = ib_bytestr_alias_mem(
+        &bytestr,
+        conn->mm,
+        (const uint8_t *)val,
+        val_length
+    );
+    if (rc != IB_OK) {
+        ib_log_notice_tx(tx, "Error creating alias for \"%s\" var: %s",
+                         name, ib_status_to_string(rc));
+        return;
+    }
+
+    rc = ib_field_create_no_copy(
+        &f,
+        conn->mm,
+        name, strlen(name),
+        IB_FTYPE_BYTESTR,
+        bytestr
+    );
+    if (rc != IB_OK) {
+        ib_log_notice_tx(tx, "Error creating \"%s\" var: %s",
+                         name, ib_status_to_string(rc));
+        return;
+    }
+
+    rc = ib_var_source_acquire(
+        &source,
+        conn->mm,
+        ib_var_store_config(conn->var_store),
+        name, strlen(name)
+    );
+    if (rc != IB_OK) {
+        ib_log_notice_tx(tx, "Error acquiring \"%s\" var: %s",
+                         name, ib_status_to_string(rc));
+        return;
+    }
+
+    rc = ib_var_source_set(source, conn->var_store, f);
+    if (rc != IB_OK) {
+        ib_log_notice_tx(tx,
+            "Error adding \"%s\" var to connection: %s",
+            name, ib_status_to_string(rc)
+        );
+    }
+}
+
+static void core_gen_conn_numeric(ib_tx_t *tx,
+                                  const char *name,
+                                  ib_num_t val)
+{
+    assert(tx != NULL);
+    assert(tx->conn != NULL);
+    assert(tx->conn->var_store != NULL);
+    assert(name != NULL);
+
+    ib_conn_t *conn = tx->conn;
+    ib_field_t *f;
+    ib_num_t num = val;
+    ib_status_t rc;
+    ib_var_source_t *source;
+
+    rc = ib_field_create(&f, conn->mm,
+                         name, strlen(name),
+                         IB_FTYPE_NUM,
+                         &num);
+    if (rc != IB_OK) {
+        ib_log_notice_tx(tx, "Error creating \"%s\" field: %s",
+                         name, ib_status_to_string(rc));
+        return;
+    }
+
+    rc = ib_var_source_acquire(
+        &source,
+        conn->mm,
+        ib_var_store_config(conn->var_store),
+        name, strlen(name)
+    );
+    if (rc != IB_OK) {
+        ib_log_notice_tx(tx, "Error acquiring \"%s\" var: %s",
+                         name, ib_status_to_string(rc));
+        return;
+    }
+
+    rc = ib_var_source_set(source, conn->var_store, f);
+    if (rc != IB_OK) {
+        ib_log_notice_tx(tx,
+            "Error adding \"%s\" var to connection: %s",
+            name, ib_status_to_string(rc)
+        );
+    }
+}
+
 static void core_gen_tx_numeric(ib_tx_t *tx,
                                 const char *name,
                                 ib_num_t val)
@@ -339,10 +450,27 @@ static ib_status_t core_gen_early_var_sources(ib_engine_t *ib,
 
     ib_conn_t *conn = tx->conn;
 
-    core_gen_tx_bytestr_alias2(tx, "server_addr", IB_S2SL(conn->local_ipstr));
-    core_gen_tx_numeric(tx, "server_port", conn->local_port);
-    core_gen_tx_bytestr_alias2(tx, "remote_addr", IB_S2SL(conn->remote_ipstr));
-    core_gen_tx_numeric(tx, "remote_port", conn->remote_port);
+    /* Connection-constant values are written once into the connection
+     * store and read through, copy-on-write, by every transaction store
+     * on the connection. */
+    if (conn->var_store != NULL) {
+        if (conn->tx_count <= 1) {
+            core_gen_conn_bytestr_alias2(
+                tx, "server_addr", IB_S2SL(conn->local_ipstr));
+            core_gen_conn_numeric(tx, "server_port", conn->local_port);
+            core_gen_conn_bytestr_alias2(
+                tx, "remote_addr", IB_S2SL(conn->remote_ipstr));
+            core_gen_conn_numeric(tx, "remote_port", conn->remote_port);
+        }
+    }
+    else {
+        core_gen_tx_bytestr_alias2(
+            tx, "server_addr", IB_S2SL(conn->local_ipstr));
+        core_gen_tx_numeric(tx, "server_port", conn->local_port);
+        core_gen_tx_bytestr_alias2(
+            tx, "remote_addr", IB_S2SL(conn->remote_ipstr));
+        core_gen_tx_numeric(tx, "remote_port", conn->remote_port);
+    }
     core_gen_tx_numeric(tx, "conn_tx_count", tx->conn->tx_count);
 
     return IB_OK;
@@ -47,6 +47,9 @@
 #include <ironbee/module.h>
 #include <ironbee/server.h>
 #include <ironbee/state_notify.h>
+#include <ironbee/stats.h>
+
+#include "probes.h"
 #include <ironbee/stream_processor.h>
 #include <ironbee/stream_pump.h>
 #include <ironbee/string.h>
@@ -485,6 +488,12 @@ ib_status_t ib_engine_create(ib_engine_t **pib,
         goto failed;
     }
 
+    /* Create the pure operator instance dedup table */
+    rc = ib_hash_create(&(ib->operator_inst_cache), mm);
+    if (rc != IB_OK) {
+        goto failed;
+    }
+
     /* Create a hash to hold actions by name */
     rc = ib_hash_create_nocase(&(ib->actions), mm);
     if (rc != IB_OK) {
@@ -669,7 +678,16 @@ ib_status_t ib_engine_config_finished(ib_engine_t *ib)
     }
 
     /* Initialize (and close) the main configuration context.
-     * Note: The context can be NULL for unit tests. */
+     * Note: The context can be NULL for unit tests.
+     *
+     * Parallelizing context configuration has been considered and does
+     * not fit this architecture: site and location contexts close one by
+     * one as the parser leaves their blocks, interleaved with parsing,
+     * and every context-close hook (rule indexing, var registration,
+     * operator creation) mutates engine-wide structures under the
+     * single-threaded configuration contract those APIs document.  The
+     * parallelism that is safe lives below this level, e.g. the Eudoxus
+     * compiler's concurrent id-width candidates. */
     if (ib->ctx != NULL) {
         ib_status_t tmp = ib_context_close(ib->ctx);
         if (tmp != IB_OK) {
@@ -732,6 +750,13 @@ ib_mm_t ib_engine_mm_main_get(const ib_engine_t *ib)
     return ib_mm_mpool(ib->mp);
 }
 
+ib_mpool_t *ib_engine_pool_main_get(const ib_engine_t *ib)
+{
+    assert(ib != NULL);
+
+    return ib->mp;
+}
+
 ib_mm_t ib_engine_mm_config_get(const ib_engine_t *ib)
 {
     return ib_mm_mpool(ib->config_mp);
@@ -1030,7 +1055,7 @@ ib_status_t ib_conn_create(ib_engine_t *ib,
 
     /* Mark time. */
     ib_clock_gettimeofday(&(conn->tv_created));
-    conn->t.started = ib_clock_get_time();
+    conn->t.started = ib_clock_coarse_get_time();
 
     /* Name the connection pool */
     snprintf(namebuf, sizeof(namebuf), "conn[%p]", (void *)conn);
@@ -1051,6 +1076,19 @@ ib_status_t ib_conn_create(ib_engine_t *ib,
         goto failed;
     }
 
+    /* Create the connection-scoped var store.  Transaction var stores
+     * read through to this store (copy-on-write). */
+    rc = ib_var_store_acquire(&conn->var_store, conn->mm, ib->var_config);
+    if (rc != IB_OK) {
+        goto failed;
+    }
+
+    /* Intern table for repeated header names/values on this connection. */
+    rc = ib_hash_create(&conn->header_intern, conn->mm);
+    if (rc != IB_OK) {
+        goto failed;
+    }
+
     *pconn = conn;
 
     return IB_OK;
@@ -1135,14 +1173,31 @@ ib_status_t ib_tx_create(ib_tx_t **ptx,
     assert(corecfg != NULL);
 
     /* Create a sub-pool from the connection memory pool for each
-     * transaction and allocate from it.
+     * transaction and allocate from it, reusing the connection's cached
+     * (cleared) transaction pool when one is available.
      *
      * Preallocate some pages.
      */
-    rc = ib_mpool_create(&pool, "tx", conn->mp);
-    if (rc != IB_OK) {
-        rc = IB_EALLOC;
-        goto failed;
+    if (conn->tx_pool_cache != NULL) {
+        pool = conn->tx_pool_cache;
+        conn->tx_pool_cache = NULL;
+    }
+    else if (ib->tx_pagesize > 4096) {
+        /* Size fresh pools from the observed usage histogram; see
+         * tx_size_hist in the engine structure. */
+        rc = ib_mpool_create_ex(
+            &pool, "tx", conn->mp, ib->tx_pagesize, NULL, NULL);
+        if (rc != IB_OK) {
+            rc = IB_EALLOC;
+            goto failed;
+        }
+    }
+    else {
+        rc = ib_mpool_create(&pool, "tx", conn->mp);
+        if (rc != IB_OK) {
+            rc = IB_EALLOC;
+            goto failed;
+        }
     }
     mm = ib_mm_mpool(pool);
     tx = (ib_tx_t *)ib_mm_calloc(mm, 1, sizeof(*tx));
@@ -1157,7 +1212,7 @@ ib_status_t ib_tx_create(ib_tx_t **ptx,
 
     /* Mark time. */
     ib_clock_gettimeofday(&tx->tv_created);
-    tx->t.started = ib_clock_get_time();
+    tx->t.started = ib_clock_coarse_get_time();
 
     tx->ib = ib;
     tx->mp = pool;
@@ -1175,9 +1230,22 @@ ib_status_t ib_tx_create(ib_tx_t **ptx,
 
     ++conn->tx_count;
     ib_tx_generate_id(tx);
-
-    /* Create data */
-    rc = ib_var_store_acquire(&tx->var_store, tx->mm, tx->ib->var_config);
+    ib_stats_add(ib, IB_STAT_TX_STARTED, 1);
+    IB_PROBE_TX_STARTED(tx, tx->id);
+
+    /* Create data.  The tx store snapshots the connection store
+     * copy-on-write: connection-scoped values are read through without
+     * per-transaction copies, and writes shadow them locally. */
+    if (conn->var_store != NULL) {
+        rc = ib_var_store_acquire_child(
+            &tx->var_store,
+            tx->mm,
+            conn->var_store
+        );
+    }
+    else {
+        rc = ib_var_store_acquire(&tx->var_store, tx->mm, tx->ib->var_config);
+    }
     if (rc != IB_OK) {
         ib_log_alert_tx(tx,
                         "Error creating tx var store: %s",
@@ -1316,6 +1384,82 @@ ib_stream_pump_t *ib_tx_request_body_pump(ib_tx_t *tx) {
     return tx->request_body_pump;
 }
 
+size_t ib_engine_tx_pagesize(const ib_engine_t *ib)
+{
+    assert(ib != NULL);
+
+    return (ib->tx_pagesize > 4096) ? ib->tx_pagesize : 4096;
+}
+
+bool ib_tx_body_notification_needed(
+    const ib_tx_t *tx,
+    bool           response
+)
+{
+    assert(tx != NULL);
+
+    ib_core_cfg_t       *corecfg = NULL;
+    ib_stream_pump_t    *pump;
+    const ib_list_t     *processors;
+    ib_rule_phase_num_t  phase;
+    ib_state_t           state;
+
+    /* Unknown configuration: deliver everything. */
+    if (ib_core_context_config(tx->ctx, &corecfg) != IB_OK) {
+        return true;
+    }
+
+    /* Modules consuming body data via hooks on the body-data state --
+     * e.g. the parser module feeding libhtp to populate ARGS -- need
+     * every segment. */
+    state = response ? response_body_data_state : request_body_data_state;
+    if (tx->ib->hooks[state] != NULL &&
+        ib_list_elements(tx->ib->hooks[state]) > 0)
+    {
+        return true;
+    }
+
+    /* Any processor beyond the core raw buffer consumes segments. */
+    pump = response
+        ? tx->response_body_pump
+        : tx->request_body_pump;
+    if (pump == NULL) {
+        return true;
+    }
+    processors = ib_stream_pump_processor_list(pump);
+    if (processors == NULL || ib_list_elements(processors) > 1) {
+        return true;
+    }
+
+    /* The raw buffer processor itself only matters when it may buffer
+     * body for audit. */
+    if (response) {
+        if (corecfg->limits.response_body_log_limit != 0) {
+            return true;
+        }
+    }
+    else {
+        if (corecfg->limits.request_body_log_limit != 0) {
+            return true;
+        }
+    }
+
+    /* Stream body rules or injectors for the phase consume segments. */
+    phase = response
+        ? IB_PHASE_RESPONSE_BODY_STREAM
+        : IB_PHASE_REQUEST_BODY_STREAM;
+    if (tx->ctx->rules != NULL &&
+        tx->ctx->rules->ruleset.phases[phase].n_runnable > 0)
+    {
+        return true;
+    }
+    if (ib_list_elements(tx->ib->rule_engine->injection_cbs[phase]) > 0) {
+        return true;
+    }
+
+    return false;
+}
+
 ib_status_t ib_tx_server_error(
     ib_tx_t *tx,
     int status
@@ -1429,7 +1573,58 @@ void ib_tx_destroy(ib_tx_t *tx)
     }
 
     /// @todo Probably need to update state???
-    ib_engine_pool_release(tx->ib, tx->mp);
+
+    ib_stats_add(tx->ib, IB_STAT_TX_FINISHED, 1);
+    IB_PROBE_TX_FINISHED(tx, tx->id);
+
+    /* Sample the pool's requested bytes into the engine's histogram
+     * (one atomic increment) before clearing releases the totals; the
+     * adaptive transaction page size is derived from these. */
+    {
+        ib_engine_t *engine = tx->ib;
+        size_t       used = ib_mpool_inuse(tx->mp);
+        size_t       bucket = 0;
+
+        while (bucket + 1 < 12 && ((size_t)4096 << bucket) < used) {
+            ++bucket;
+        }
+        __sync_fetch_and_add(&engine->tx_size_hist[bucket], 1);
+
+        /* Recompute the page size every few thousand transactions:
+         * the smallest power-of-two page covering ~95% of pools. */
+        if ((__sync_fetch_and_add(&engine->tx_size_samples, 1) & 0xFFF) ==
+            0xFFF)
+        {
+            uint64_t total = 0;
+            uint64_t acc = 0;
+            size_t   choice = 0;
+
+            for (size_t i = 0; i < 12; ++i) {
+                total += engine->tx_size_hist[i];
+            }
+            for (size_t i = 0; i < 12; ++i) {
+                acc += engine->tx_size_hist[i];
+                if (acc * 100 >= total * 95) {
+                    choice = i;
+                    break;
+                }
+            }
+            engine->tx_pagesize = (size_t)4096 << choice;
+        }
+    }
+
+    /* Recycle the transaction pool on its connection if the cache slot
+     * is free; clearing runs cleanups but keeps the pages.  Read what we
+     * need first: clearing releases the tx object itself. */
+    if (conn->tx_pool_cache == NULL) {
+        ib_mpool_t *pool = tx->mp;
+
+        ib_mpool_clear(pool);
+        conn->tx_pool_cache = pool;
+    }
+    else {
+        ib_engine_pool_release(tx->ib, tx->mp);
+    }
 }
 
 /* -- Blocking -- */
@@ -1522,6 +1717,8 @@ ib_status_t ib_tx_block(ib_tx_t *tx)
     /* If we reach here, update the truths we know. */
     tx->is_blocked = true;
     tx->is_allowed = false;
+    ib_stats_add(tx->ib, IB_STAT_BLOCKS, 1);
+    IB_PROBE_TX_BLOCKED(tx, tx->id);
 
     /* Update the flags for legacy use (advisory until it is applied). */
     ib_tx_flags_set(tx, IB_TX_FBLOCK_ADVISORY);
@@ -2330,6 +2527,32 @@ ib_status_t ib_context_close(ib_context_t *ctx)
         }
     }
 
+    /* Flatten per-module config pointers for O(1) runtime lookup; the
+     * close notification above was the last point they could change. */
+    {
+        size_t count = ib_array_elements(ctx->cfgdata);
+
+        ctx->module_cfg_count = 0;
+        ctx->module_cfg = NULL;
+        if (count > 0) {
+            ctx->module_cfg = ib_mm_calloc(
+                ctx->mm, count, sizeof(*ctx->module_cfg));
+            if (ctx->module_cfg == NULL) {
+                return IB_EALLOC;
+            }
+            for (size_t i = 0; i < count; ++i) {
+                ib_context_data_t *cfgdata = NULL;
+
+                if (ib_array_get(ctx->cfgdata, i, (void *)&cfgdata) == IB_OK &&
+                    cfgdata != NULL)
+                {
+                    ctx->module_cfg[i] = cfgdata->data;
+                }
+            }
+            ctx->module_cfg_count = count;
+        }
+    }
+
     ctx->state = CTX_CLOSED;
     return IB_OK;
 }
@@ -2666,6 +2889,17 @@ ib_status_t ib_context_module_config(const ib_context_t *ctx,
     ib_context_data_t *cfgdata;
     ib_status_t rc;
 
+    /* Closed contexts serve the flattened table: one indexed load on
+     * the per-rule-execution path. */
+    if (ctx->module_cfg != NULL) {
+        if (m->idx >= ctx->module_cfg_count) {
+            *(void **)pcfg = NULL;
+            return IB_ENOENT;
+        }
+        *(void **)pcfg = ctx->module_cfg[m->idx];
+        return (ctx->module_cfg[m->idx] != NULL) ? IB_OK : IB_EINVAL;
+    }
+
     rc = ib_array_get(ctx->cfgdata, m->idx, (void *)&cfgdata);
     if (rc != IB_OK) {
         *(void **)pcfg = NULL;
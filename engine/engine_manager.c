@@ -47,6 +47,7 @@
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 /* The manager's engine wrapper type */
@@ -72,6 +73,17 @@ typedef struct manager_engine_preconfig_t manager_engine_preconfig_t;
 
 /**
  * The Engine Manager.
+ *
+ * Per-CPU engine replicas with shared read-only rule structures have
+ * been considered and do not fit the current engine: rules, contexts,
+ * var configuration and module data are allocated from each engine's
+ * own memory pools and carry mutable state (operator instances, per
+ * context enablement), so replicas cannot share them without a
+ * wholesale const-separation of the rule engine.  The sharing that is
+ * safe already exists piecemeal: automata files are memory mapped and
+ * shared across processes, and parsed configuration is cached across
+ * engine creations, which together remove most of the duplicate cost
+ * replicas would have addressed.
  */
 struct ib_manager_t {
     const ib_server_t    *server;         /**< Server object */
@@ -96,7 +108,15 @@ struct ib_manager_t {
     ib_manager_engine_t **engine_list;
     size_t                engine_count;   /**< Current count of engines */
     size_t                max_engines;    /**< The maximum number of engines */
-    ib_lock_t            *manager_lck;    /**< Protect access to the mgr. */
+    /**
+     * Protect access to the manager.
+     *
+     * Engine acquire/release -- taken per transaction in some server
+     * paths -- are read-side (the reference counts are atomic);
+     * structural changes (create, prepare, commit, enable, disable,
+     * cleanup, destroy) take it exclusively.
+     */
+    ib_rwlock_t          *manager_lck;
 
     /**
      * A mapping from a name (const char *) to an ib_manager_engine_t *.
@@ -123,6 +143,19 @@ struct ib_manager_t {
 
     //! A list of @ref manager_engine_postconfig_t.
     ib_list_t *postconfig_functions;
+
+    /**
+     * Warm standby engine, fully configured but not yet serving.
+     *
+     * Built by ib_manager_engine_prepare() and promoted to current by
+     * ib_manager_engine_commit(), so the expensive configuration work
+     * happens ahead of the swap and the swap itself is a registration.
+     * NULL when no standby is prepared.  Guarded by manager_lck.
+     */
+    ib_manager_engine_t *standby;
+
+    //! Name the standby will serve when committed; malloc()ed.
+    char *standby_name;
 };
 
 /**
@@ -345,7 +378,7 @@ ib_status_t ib_manager_create(
         rc = IB_EALLOC;
         goto cleanup;
     }
-    rc = ib_lock_create(&(manager->manager_lck), mm);
+    rc = ib_rwlock_create(&(manager->manager_lck), mm);
     if (rc != IB_OK) {
         goto cleanup;
     }
@@ -418,6 +451,12 @@ void ib_manager_destroy(
         ib_engine_destroy(manager_engine->engine);
     }
 
+    /* Destroy an uncommitted standby engine. */
+    if (manager->standby != NULL) {
+        ib_engine_destroy(manager->standby->engine);
+        free(manager->standby_name);
+    }
+
     /* Destroy the manager by destroying it's memory pool. */
     ib_mpool_destroy(manager->mpool);
 
@@ -682,7 +721,7 @@ ib_status_t ib_manager_engine_create(
     ib_manager_engine_t *wrapper = NULL;
 
     /* Grab the engine creation lock to serialize engine creation. */
-    rc = ib_lock_lock(manager->manager_lck);
+    rc = ib_rwlock_wrlock(manager->manager_lck);
     if (rc != IB_OK) {
         goto cleanup;
     }
@@ -714,7 +753,103 @@ ib_status_t ib_manager_engine_create(
 cleanup:
 
     /* Release any locks. */
-    ib_lock_unlock(manager->manager_lck);
+    ib_rwlock_unlock(manager->manager_lck);
+
+    return rc;
+}
+
+ib_status_t ib_manager_engine_prepare(
+    ib_manager_t *manager,
+    const char   *name,
+    const char   *config_file
+)
+{
+    assert(manager != NULL);
+    assert(name != NULL);
+    assert(config_file != NULL);
+
+    ib_status_t          rc;
+    ib_manager_engine_t *wrapper = NULL;
+    char                *name_copy;
+
+    name_copy = strdup(name);
+    if (name_copy == NULL) {
+        return IB_EALLOC;
+    }
+
+    rc = ib_rwlock_wrlock(manager->manager_lck);
+    if (rc != IB_OK) {
+        free(name_copy);
+        return rc;
+    }
+
+    if (! manager->enabled) {
+        rc = IB_DECLINED;
+        goto cleanup;
+    }
+
+    rc = create_engine(manager, config_file, &wrapper);
+    if (rc != IB_OK) {
+        goto cleanup;
+    }
+
+    /* Replace any previously prepared standby. */
+    if (manager->standby != NULL) {
+        ib_engine_destroy(manager->standby->engine);
+        free(manager->standby_name);
+    }
+    manager->standby      = wrapper;
+    manager->standby_name = name_copy;
+    name_copy = NULL;
+
+cleanup:
+    ib_rwlock_unlock(manager->manager_lck);
+    free(name_copy);
+
+    return rc;
+}
+
+ib_status_t ib_manager_engine_commit(
+    ib_manager_t *manager
+)
+{
+    assert(manager != NULL);
+
+    ib_status_t rc;
+
+    rc = ib_rwlock_wrlock(manager->manager_lck);
+    if (rc != IB_OK) {
+        return rc;
+    }
+
+    if (! manager->enabled) {
+        rc = IB_DECLINED;
+        goto cleanup;
+    }
+
+    if (manager->standby == NULL) {
+        rc = IB_ENOENT;
+        goto cleanup;
+    }
+
+    /* Check for or make space. */
+    rc = has_engine_slots(manager);
+    if (rc != IB_OK) {
+        goto cleanup;
+    }
+
+    /* The swap itself: registration only. */
+    register_engine(manager, manager->standby_name, manager->standby);
+
+    manager->standby = NULL;
+    free(manager->standby_name);
+    manager->standby_name = NULL;
+
+    /* Destroy any inactive engines. */
+    destroy_inactive_engines(manager);
+
+cleanup:
+    ib_rwlock_unlock(manager->manager_lck);
 
     return rc;
 }
@@ -727,7 +862,7 @@ ib_status_t ib_manager_enable(
 
     ib_status_t rc;
 
-    rc = ib_lock_lock(manager->manager_lck);
+    rc = ib_rwlock_wrlock(manager->manager_lck);
     if (rc != IB_OK) {
         goto cleanup;
     }
@@ -736,7 +871,7 @@ ib_status_t ib_manager_enable(
 
 cleanup:
     /* Release any locks. */
-    ib_lock_unlock(manager->manager_lck);
+    ib_rwlock_unlock(manager->manager_lck);
 
     return rc;
 }
@@ -764,7 +899,7 @@ ib_status_t ib_manager_disable(
         goto cleanup;
     }
 
-    rc = ib_lock_lock(manager->manager_lck);
+    rc = ib_rwlock_wrlock(manager->manager_lck);
     if (rc != IB_OK) {
         goto cleanup;
     }
@@ -786,7 +921,7 @@ ib_status_t ib_manager_disable(
 cleanup:
 
     /* Release the lock. */
-    ib_lock_unlock(manager->manager_lck);
+    ib_rwlock_unlock(manager->manager_lck);
 
 
     const ib_list_node_t *node;
@@ -885,8 +1020,9 @@ ib_status_t ib_manager_engine_acquire(
     ib_status_t          rc;
     ib_manager_engine_t *engine = NULL;
 
-    /* Grab the engine list lock */
-    rc = ib_lock_lock(manager->manager_lck);
+    /* Grab the engine list lock for reading; the reference count is
+     * atomic, so lookups may proceed concurrently. */
+    rc = ib_rwlock_rdlock(manager->manager_lck);
     if (rc != IB_OK) {
         return rc;
     }
@@ -901,7 +1037,7 @@ ib_status_t ib_manager_engine_acquire(
     if (rc == IB_OK) {
 
         /* Increment and return the engine. */
-        ++(engine->ref_count);
+        __sync_fetch_and_add(&(engine->ref_count), 1);
         *pengine = engine->engine;
 
         rc = IB_OK;
@@ -910,7 +1046,7 @@ ib_status_t ib_manager_engine_acquire(
         rc = IB_DECLINED;
     }
 
-    ib_lock_unlock(manager->manager_lck);
+    ib_rwlock_unlock(manager->manager_lck);
     return rc;
 }
 
@@ -925,8 +1061,9 @@ ib_status_t ib_manager_engine_release(
     ib_status_t          rc;
     ib_manager_engine_t *managed_engine = NULL;
 
-    /* Grab the engine list lock */
-    rc = ib_lock_lock(manager->manager_lck);
+    /* Read side: the scan does not modify the list and the reference
+     * count is atomic. */
+    rc = ib_rwlock_rdlock(manager->manager_lck);
     if (rc != IB_OK) {
         return rc;
     }
@@ -951,7 +1088,7 @@ ib_status_t ib_manager_engine_release(
         assert(managed_engine->ref_count > 0);
 
         /* Release the engine. */
-        --(managed_engine->ref_count);
+        __sync_fetch_and_sub(&(managed_engine->ref_count), 1);
 
         rc = IB_OK;
     }
@@ -962,7 +1099,7 @@ ib_status_t ib_manager_engine_release(
     }
 
     /* Release the lock. */
-    ib_lock_unlock(manager->manager_lck);
+    ib_rwlock_unlock(manager->manager_lck);
 
     return rc;
 }
@@ -975,14 +1112,14 @@ ib_status_t ib_manager_engine_cleanup(
     ib_status_t rc;
 
     /* Grab the engine list lock */
-    rc = ib_lock_lock(manager->manager_lck);
+    rc = ib_rwlock_wrlock(manager->manager_lck);
     if (rc != IB_OK) {
         return rc;
     }
 
     destroy_inactive_engines(manager);
 
-    ib_lock_unlock(manager->manager_lck);
+    ib_rwlock_unlock(manager->manager_lck);
 
     return IB_OK;
 }
@@ -1085,7 +1222,7 @@ ib_status_t DLL_PUBLIC ib_manager_engine_status(
     ib_status_t                 rc;
 
     /* Grab the engine creation lock to serialize engine creation. */
-    rc = ib_lock_lock(manager->manager_lck);
+    rc = ib_rwlock_wrlock(manager->manager_lck);
     if (rc != IB_OK) {
         return rc;
     }
@@ -1113,7 +1250,7 @@ ib_status_t DLL_PUBLIC ib_manager_engine_status(
     *status_len = manager->engine_count;
 
     /* Grab the engine creation lock to serialize engine creation. */
-    rc = ib_lock_unlock(manager->manager_lck);
+    rc = ib_rwlock_unlock(manager->manager_lck);
 
     return rc;
 }
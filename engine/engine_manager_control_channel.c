@@ -30,7 +30,12 @@
 #include <ironbee/hash.h>
 #include <ironbee/mm.h>
 #include <ironbee/mm_mpool_lite.h>
+#include <ironbee/mpool.h>
 #include <ironbee/mpool_lite.h>
+#include <ironbee/rule_engine.h>
+#include <ironbee/rule_profiler.h>
+#include <ironbee/stats.h>
+#include <ironbee/string.h>
 
 #ifdef HAVE_VALGRIND
 #include <valgrind/memcheck.h>
@@ -39,8 +44,12 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/time.h>
@@ -231,6 +240,540 @@ static ib_status_t manager_diag_valgrind_added(
 }
 
 
+/**
+ * Control the rule execution profiler of the current engine.
+ *
+ * The arguments are one of @c enable, @c disable, @c reset or
+ * @c report @c [n] where @c n limits the number of rules reported
+ * (default 25).
+ *
+ * @param[in] mm Memory manager for allocations of @a result and other
+ *            allocations that should live until the response is sent.
+ * @param[in] name The name this command is called by.
+ * @param[in] args The command arguments.
+ * @param[out] result Set to a report or a status message.
+ * @param[in] cbdata The @ref ib_manager_t * to act on.
+ *
+ * @returns
+ * - IB_OK on success.
+ * - IB_EINVAL on an unknown subcommand.
+ * - Other on engine acquisition or profiler failure.
+ */
+static ib_status_t manager_diag_rule_profile(
+    ib_mm_t      mm,
+    const char  *name,
+    const char  *args,
+    const char **result,
+    void        *cbdata
+)
+{
+    assert(args != NULL);
+    assert(cbdata != NULL);
+
+    ib_manager_t *manager = (ib_manager_t *)cbdata;
+    ib_engine_t  *engine;
+    ib_status_t   rc;
+
+    rc = ib_manager_engine_acquire(
+        manager,
+        IB_MANAGER_ENGINE_NAME_DEFAULT,
+        &engine
+    );
+    if (rc != IB_OK) {
+        *result = "No engine available.";
+        return rc;
+    }
+
+    if (strcmp(args, "enable") == 0) {
+        rc = ib_rule_profiler_enable(engine);
+        *result = (rc == IB_OK) ?
+            "Rule profiling enabled." :
+            "Failed to enable rule profiling.";
+    }
+    else if (strcmp(args, "disable") == 0) {
+        rc = ib_rule_profiler_disable(engine);
+        *result = "Rule profiling disabled.";
+    }
+    else if (strcmp(args, "reset") == 0) {
+        rc = ib_rule_profiler_reset(engine);
+        *result = "Rule profiling counters reset.";
+    }
+    else if (strcmp(args, "sites") == 0) {
+        rc = ib_rule_profiler_site_report(engine, mm, result);
+    }
+    else if (strncmp(args, "report", sizeof("report") - 1) == 0) {
+        size_t      limit = 25;
+        const char *num = args + sizeof("report") - 1;
+
+        while (*num == ' ') {
+            ++num;
+        }
+        if (*num != '\0') {
+            limit = strtoul(num, NULL, 10);
+            if (limit == 0) {
+                limit = 25;
+            }
+        }
+
+        rc = ib_rule_profiler_report(engine, mm, limit, result);
+    }
+    else {
+        *result = "Usage: rule_profile enable|disable|reset|report [n]|sites";
+        rc = IB_EINVAL;
+    }
+
+    ib_manager_engine_release(manager, engine);
+
+    return rc;
+}
+
+/**
+ * Report the current engine's statistics counters.
+ *
+ * @param[in] mm Memory manager for allocations of @a result and other
+ *            allocations that should live until the response is sent.
+ * @param[in] name The name this command is called by.
+ * @param[in] args The command arguments. Ignored.
+ * @param[out] result Set to the rendered counters.
+ * @param[in] cbdata The @ref ib_manager_t * to act on.
+ *
+ * @returns
+ * - IB_OK on success.
+ * - Other on engine acquisition or allocation failure.
+ */
+static ib_status_t manager_diag_stats(
+    ib_mm_t      mm,
+    const char  *name,
+    const char  *args,
+    const char **result,
+    void        *cbdata
+)
+{
+    assert(cbdata != NULL);
+
+    ib_manager_t *manager = (ib_manager_t *)cbdata;
+    ib_engine_t  *engine;
+    ib_status_t   rc;
+    char         *answer;
+    size_t        answer_sz = 256;
+    size_t        used = 0;
+
+    rc = ib_manager_engine_acquire(
+        manager,
+        IB_MANAGER_ENGINE_NAME_DEFAULT,
+        &engine
+    );
+    if (rc != IB_OK) {
+        *result = "No engine available.";
+        return rc;
+    }
+
+    answer = ib_mm_alloc(mm, answer_sz);
+    if (answer == NULL) {
+        ib_manager_engine_release(manager, engine);
+        return IB_EALLOC;
+    }
+
+    for (int i = 0; i < IB_STAT_MAX; ++i) {
+        used += snprintf(
+            answer + used,
+            (used < answer_sz) ? answer_sz - used : 0,
+            "%s=%llu%s",
+            ib_stats_name((ib_stat_t)i),
+            (unsigned long long)ib_stats_get(engine, (ib_stat_t)i),
+            (i + 1 < IB_STAT_MAX) ? " " : ""
+        );
+    }
+    used += snprintf(
+        answer + used,
+        (used < answer_sz) ? answer_sz - used : 0,
+        " tx_pagesize=%zu",
+        ib_engine_tx_pagesize(engine)
+    );
+
+    ib_manager_engine_release(manager, engine);
+
+    *result = answer;
+    return IB_OK;
+}
+
+/**
+ * Report live memory use of the current engine's pool tree.
+ *
+ * The arguments are one of nothing or @c tree @c [n] for the usage
+ * report with the top @c n consumers (default 10), @c analyze for
+ * ib_mpool_analyze(), or @c debug for ib_mpool_debug_report().  This
+ * turns "worker RSS grew 100MB" from a core-dump investigation into a
+ * one-line query; note the heavier subcommands are slow and walk live
+ * structures, so prefer them on a quiesced or drained worker.
+ *
+ * @param[in] mm Memory manager for allocations of @a result and other
+ *            allocations that should live until the response is sent.
+ * @param[in] name The name this command is called by.
+ * @param[in] args The command arguments.
+ * @param[out] result Set to the report.
+ * @param[in] cbdata The @ref ib_manager_t * to act on.
+ *
+ * @returns
+ * - IB_OK on success.
+ * - IB_EINVAL on an unknown subcommand.
+ * - IB_EALLOC on allocation failure.
+ * - Other on engine acquisition failure.
+ */
+static ib_status_t manager_diag_memory(
+    ib_mm_t      mm,
+    const char  *name,
+    const char  *args,
+    const char **result,
+    void        *cbdata
+)
+{
+    assert(args != NULL);
+    assert(cbdata != NULL);
+
+    ib_manager_t *manager = (ib_manager_t *)cbdata;
+    ib_engine_t  *engine;
+    ib_status_t   rc;
+    char         *report = NULL;
+
+    rc = ib_manager_engine_acquire(
+        manager,
+        IB_MANAGER_ENGINE_NAME_DEFAULT,
+        &engine
+    );
+    if (rc != IB_OK) {
+        *result = "No engine available.";
+        return rc;
+    }
+
+    if (*args == '\0' || strncmp(args, "tree", sizeof("tree") - 1) == 0) {
+        size_t      top_n = 10;
+        const char *num = args;
+
+        if (*num != '\0') {
+            num += sizeof("tree") - 1;
+            while (*num == ' ') {
+                ++num;
+            }
+            if (*num != '\0') {
+                top_n = strtoul(num, NULL, 10);
+            }
+        }
+
+        report = ib_mpool_usage_report(ib_engine_pool_main_get(engine), top_n);
+        rc = (report != NULL) ? IB_OK : IB_EALLOC;
+    }
+    else if (strcmp(args, "analyze") == 0) {
+        report = ib_mpool_analyze(ib_engine_pool_main_get(engine));
+        rc = (report != NULL) ? IB_OK : IB_EALLOC;
+    }
+    else if (strcmp(args, "debug") == 0) {
+        report = ib_mpool_debug_report(ib_engine_pool_main_get(engine));
+        rc = (report != NULL) ? IB_OK : IB_EALLOC;
+    }
+    else {
+        *result = "Usage: memory [tree [n]|analyze|debug]";
+        rc = IB_EINVAL;
+    }
+
+    ib_manager_engine_release(manager, engine);
+
+    if (report != NULL) {
+        /* The reports are malloced; copy into the response lifetime. */
+        *result = ib_mm_strdup(mm, report);
+        free(report);
+        if (*result == NULL) {
+            rc = IB_EALLOC;
+        }
+    }
+
+    return rc;
+}
+
+/**
+ * Reorder phase rules by measured cost (see ib_rule_engine_reorder()).
+ *
+ * @param[in] mm Memory manager for @a result.
+ * @param[in] name The name this command is called by.
+ * @param[in] args Ignored.
+ * @param[out] result A confirmation message.
+ * @param[in] cbdata The @ref ib_manager_t * to act on.
+ *
+ * @returns
+ * - IB_OK on success.
+ * - Other on engine acquisition or reorder failure.
+ */
+static ib_status_t manager_diag_rule_reorder(
+    ib_mm_t      mm,
+    const char  *name,
+    const char  *args,
+    const char **result,
+    void        *cbdata
+)
+{
+    assert(cbdata != NULL);
+
+    ib_manager_t *manager = (ib_manager_t *)cbdata;
+    ib_engine_t  *engine;
+    ib_status_t   rc;
+
+    rc = ib_manager_engine_acquire(
+        manager,
+        IB_MANAGER_ENGINE_NAME_DEFAULT,
+        &engine
+    );
+    if (rc != IB_OK) {
+        *result = "No engine available.";
+        return rc;
+    }
+
+    rc = ib_rule_engine_reorder(engine);
+
+    ib_manager_engine_release(manager, engine);
+
+    *result = (rc == IB_OK)
+        ? "Rules reordered by measured cost."
+        : "Reorder failed.";
+    return rc;
+}
+
+/**
+ * @name Shared-memory stats publishing
+ *
+ * The `stats_shm` command maps a POSIX shared-memory segment and
+ * starts a publisher thread that copies the engine counters into it on
+ * a fixed cadence.  A telemetry agent maps the same segment and reads
+ * it lock free, so polling -- at any frequency, from any number of
+ * agents -- costs the engine nothing beyond the publisher's own
+ * heartbeat; no socket round trip enters the worker event loops.
+ *
+ * Readers use the sequence field as a seqlock: read @c seq, and if it
+ * is even, read the values and re-read @c seq; if it changed (or was
+ * odd), retry.  The layout is self-describing (counter names are
+ * written once at initialization) and guarded by a magic word written
+ * last, which is cleared again when publishing stops.
+ */
+
+/**@{*/
+
+/** Magic identifying an initialized stats segment ("IBST"). */
+#define STATS_SHM_MAGIC 0x49425354
+
+/** Layout version. */
+#define STATS_SHM_VERSION 1
+
+/** Publisher cadence in microseconds. */
+#define STATS_SHM_INTERVAL_USEC 100000
+
+/** Bytes reserved per counter name, including the terminator. */
+#define STATS_SHM_NAME_SZ 24
+
+/** The shared segment layout. */
+typedef struct {
+    uint32_t magic;          /**< STATS_SHM_MAGIC; written last. */
+    uint32_t version;        /**< STATS_SHM_VERSION. */
+    uint32_t n_stats;        /**< Number of counters published. */
+    uint32_t seq;            /**< Seqlock; odd while updating. */
+    uint64_t timestamp_usec; /**< Publish time (gettimeofday). */
+    uint64_t values[IB_STAT_MAX];                  /**< Counters. */
+    char     names[IB_STAT_MAX][STATS_SHM_NAME_SZ]; /**< Counter names. */
+} stats_shm_layout_t;
+
+/** The (single, process-wide) publisher. */
+typedef struct {
+    ib_manager_t       *manager; /**< Manager to read engines from. */
+    char               *path;    /**< Segment name (malloc). */
+    stats_shm_layout_t *map;     /**< The mapped segment. */
+    pthread_t           thread;  /**< Publisher thread. */
+    volatile bool       stop;    /**< Tells the thread to exit. */
+    bool                running; /**< Thread started. */
+} stats_shm_publisher_t;
+
+static stats_shm_publisher_t c_stats_shm;
+static pthread_mutex_t       c_stats_shm_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Publisher thread: snapshot the counters into the segment.
+ */
+static void *stats_shm_publish(void *arg)
+{
+    stats_shm_publisher_t *pub = (stats_shm_publisher_t *)arg;
+
+    while (! pub->stop) {
+        ib_engine_t *engine;
+
+        if (ib_manager_engine_acquire(
+                pub->manager,
+                IB_MANAGER_ENGINE_NAME_DEFAULT,
+                &engine) == IB_OK)
+        {
+            struct timeval tv;
+
+            gettimeofday(&tv, NULL);
+
+            ++pub->map->seq;             /* Odd: update in progress. */
+            __sync_synchronize();
+            for (int i = 0; i < IB_STAT_MAX; ++i) {
+                pub->map->values[i] = ib_stats_get(engine, (ib_stat_t)i);
+            }
+            pub->map->timestamp_usec =
+                (uint64_t)tv.tv_sec * 1000000 + (uint64_t)tv.tv_usec;
+            __sync_synchronize();
+            ++pub->map->seq;             /* Even: consistent. */
+
+            ib_manager_engine_release(pub->manager, engine);
+        }
+
+        usleep(STATS_SHM_INTERVAL_USEC);
+    }
+
+    return NULL;
+}
+
+/**
+ * Stop the publisher, invalidate and unlink the segment.
+ *
+ * Registered as a cleanup on the channel's memory manager, so the
+ * thread is joined before the manager it reads from is destroyed.
+ */
+static void stats_shm_stop(void *cbdata)
+{
+    pthread_mutex_lock(&c_stats_shm_lock);
+    if (c_stats_shm.running) {
+        c_stats_shm.stop = true;
+        pthread_join(c_stats_shm.thread, NULL);
+        c_stats_shm.map->magic = 0;  /* Tell readers we are gone. */
+        __sync_synchronize();
+        munmap(c_stats_shm.map, sizeof(*c_stats_shm.map));
+        shm_unlink(c_stats_shm.path);
+        free(c_stats_shm.path);
+        memset(&c_stats_shm, 0, sizeof(c_stats_shm));
+    }
+    pthread_mutex_unlock(&c_stats_shm_lock);
+}
+
+/**
+ * The `stats_shm` command: publish stats to the named shm segment.
+ *
+ * @param[in] mm Memory manager for allocations of @a result.
+ * @param[in] name The name this command is called by.
+ * @param[in] args The shm segment name (e.g. "/ironbee.stats").
+ * @param[out] result A human-readable confirmation or error.
+ * @param[in] cbdata The @ref ib_engine_manager_control_channel_t.
+ *
+ * @returns
+ * - IB_OK on success.
+ * - IB_EINVAL on a missing or malformed segment name or map failure.
+ * - IB_EEXIST if a publisher is already running.
+ */
+static ib_status_t manager_diag_stats_shm(
+    ib_mm_t      mm,
+    const char  *name,
+    const char  *args,
+    const char **result,
+    void        *cbdata
+)
+{
+    assert(cbdata != NULL);
+
+    ib_engine_manager_control_channel_t *channel =
+        (ib_engine_manager_control_channel_t *)cbdata;
+    stats_shm_layout_t *map;
+    int                 fd;
+    ib_status_t         rc = IB_OK;
+
+    if (args == NULL || args[0] != '/') {
+        *result = "Usage: stats_shm /segment-name";
+        return IB_EINVAL;
+    }
+
+    pthread_mutex_lock(&c_stats_shm_lock);
+
+    if (c_stats_shm.running) {
+        *result = "Stats publisher already running.";
+        rc = IB_EEXIST;
+        goto unlock;
+    }
+
+    fd = shm_open(args, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        *result = "Failed to open shm segment.";
+        rc = IB_EINVAL;
+        goto unlock;
+    }
+    if (ftruncate(fd, sizeof(*map)) != 0) {
+        close(fd);
+        shm_unlink(args);
+        *result = "Failed to size shm segment.";
+        rc = IB_EINVAL;
+        goto unlock;
+    }
+    map = (stats_shm_layout_t *)mmap(
+        NULL, sizeof(*map), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        shm_unlink(args);
+        *result = "Failed to map shm segment.";
+        rc = IB_EINVAL;
+        goto unlock;
+    }
+
+    /* Initialize the segment; the magic goes in last so a reader
+     * never sees a half-built layout. */
+    memset(map, 0, sizeof(*map));
+    map->version = STATS_SHM_VERSION;
+    map->n_stats = IB_STAT_MAX;
+    for (int i = 0; i < IB_STAT_MAX; ++i) {
+        strncpy(map->names[i],
+                ib_stats_name((ib_stat_t)i),
+                STATS_SHM_NAME_SZ - 1);
+    }
+    __sync_synchronize();
+    map->magic = STATS_SHM_MAGIC;
+
+    c_stats_shm.manager = channel->manager;
+    c_stats_shm.map     = map;
+    c_stats_shm.stop    = false;
+    c_stats_shm.path    = strdup(args);
+    if (c_stats_shm.path == NULL) {
+        munmap(map, sizeof(*map));
+        shm_unlink(args);
+        memset(&c_stats_shm, 0, sizeof(c_stats_shm));
+        rc = IB_EALLOC;
+        goto unlock;
+    }
+
+    if (pthread_create(
+            &c_stats_shm.thread, NULL, stats_shm_publish, &c_stats_shm) != 0)
+    {
+        munmap(map, sizeof(*map));
+        shm_unlink(args);
+        free(c_stats_shm.path);
+        memset(&c_stats_shm, 0, sizeof(c_stats_shm));
+        *result = "Failed to start publisher thread.";
+        rc = IB_EOTHER;
+        goto unlock;
+    }
+    c_stats_shm.running = true;
+
+    /* Join the publisher before the manager goes away. */
+    ib_mm_register_cleanup(channel->mm, stats_shm_stop, NULL);
+
+    {
+        char *answer = ib_mm_alloc(mm, 128);
+        if (answer != NULL) {
+            snprintf(answer, 128, "Publishing stats to shm %s.", args);
+            *result = answer;
+        }
+    }
+
+unlock:
+    pthread_mutex_unlock(&c_stats_shm_lock);
+    return rc;
+}
+
+/**@}*/
+
 /**
  * Disable manager command.
  *
@@ -347,6 +890,70 @@ static ib_status_t manager_cmd_engine_create(
     return ib_manager_engine_create(manager, name, file);
 }
 
+/**
+ * As manager_cmd_engine_create() but prepares a warm standby engine.
+ *
+ * @sa ib_manager_engine_prepare()
+ */
+static ib_status_t manager_cmd_engine_prepare(
+    ib_mm_t      mm,
+    const char  *cmd_name,
+    const char  *args,
+    const char **result,
+    void        *cbdata
+)
+{
+    assert(args != NULL);
+    assert(cbdata != NULL);
+
+    ib_manager_t *manager = (ib_manager_t *)cbdata;
+    char *name;
+    char *file;
+
+    /* Copy the argument so we can modify it. */
+    name = ib_mm_strdup(mm, args);
+    if (name == NULL) {
+        return IB_EALLOC;
+    }
+
+    /* Find the first = character. */
+    file = index(name, '=');
+
+    /* If there is no = character, then the whole arg is the file name. */
+    if (file == NULL) {
+        file = name;                           /* Whole string is file. */
+        name = IB_MANAGER_ENGINE_NAME_DEFAULT; /* Use default for name. */
+    }
+
+    /* Otherwise, the first part is `name` and the second part is `file`. */
+    else {
+        *file = '\0'; /* Tag the end of the name with a \0. */
+        ++file;       /* Point file to the start of the file name. */
+    }
+
+    return ib_manager_engine_prepare(manager, name, file);
+}
+
+/**
+ * Promote the prepared standby engine to current.
+ *
+ * @sa ib_manager_engine_commit()
+ */
+static ib_status_t manager_cmd_engine_commit(
+    ib_mm_t      mm,
+    const char  *cmd_name,
+    const char  *args,
+    const char **result,
+    void        *cbdata
+)
+{
+    assert(cbdata != NULL);
+
+    ib_manager_t *manager = (ib_manager_t *)cbdata;
+
+    return ib_manager_engine_commit(manager);
+}
+
 /**
  * Call ib_manager_engine_create(); Args is the path to the config file.
  *
@@ -1137,6 +1744,8 @@ ib_status_t ib_engine_manager_control_manager_ctrl_register(
         { "disable",       manager_cmd_disable },
         { "cleanup",       manager_cmd_cleanup },
         { "engine_create", manager_cmd_engine_create },
+        { "engine_prepare", manager_cmd_engine_prepare },
+        { "engine_commit", manager_cmd_engine_commit },
         { "engine_status", manager_cmd_engine_status },
         { NULL,            NULL }
     };
@@ -1175,6 +1784,10 @@ ib_status_t DLL_PUBLIC ib_engine_manager_control_manager_diag_register(
         { "valgrind",       manager_diag_valgrind },
         { "valgrind_added", manager_diag_valgrind_added },
         { "version",        manager_diag_version },
+        { "memory",         manager_diag_memory },
+        { "rule_profile",   manager_diag_rule_profile },
+        { "rule_reorder",   manager_diag_rule_reorder },
+        { "stats",          manager_diag_stats },
         { NULL,             NULL }
     };
 
@@ -1190,6 +1803,18 @@ ib_status_t DLL_PUBLIC ib_engine_manager_control_manager_diag_register(
         }
     }
 
+    /* stats_shm needs the channel (for its memory manager), not just
+     * the manager, as callback data. */
+    rc = ib_engine_manager_control_cmd_register(
+        channel,
+        "stats_shm",
+        manager_diag_stats_shm,
+        channel
+    );
+    if (rc != IB_OK) {
+        return rc;
+    }
+
     return IB_OK;
 }
 
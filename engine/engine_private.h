@@ -144,8 +144,39 @@ typedef struct ib_block_post_hook_t ib_block_post_hook_t;
 /**
  * Engine handle.
  */
+/** Shards for the striped engine statistics counters. */
+#define IB_STATS_SHARDS 16
+
+/** One cache-line sized shard of engine counters. */
+typedef struct {
+    uint64_t counters[8]; /**< Room for IB_STAT_MAX counters, padded. */
+} ib_stats_shard_t;
+
 struct ib_engine_t {
     ib_mpool_t            *mp;              /**< Primary memory pool */
+
+    /**
+     * Engine statistics, striped by thread; see stats.h.
+     *
+     * Each shard is its own cache line so concurrent workers bumping
+     * counters rarely share one.
+     */
+    ib_stats_shard_t       stats[IB_STATS_SHARDS];
+
+    /**
+     * Transaction pool usage histogram and adaptive page size.
+     *
+     * At transaction destruction the pool's requested-byte total is
+     * bucketed (power-of-two buckets from 4KB) with an atomic
+     * increment; ib_tx_create() sizes fresh transaction pools from the
+     * histogram's high percentile so API-style traffic gets small
+     * pages while upload-heavy deployments avoid page chaining.  The
+     * chosen size is recomputed cheaply every few thousand
+     * transactions and reported via the controller stats command.
+     */
+    uint64_t               tx_size_hist[12];  /**< 4KB << bucket. */
+    size_t                 tx_pagesize;       /**< Current choice; 0 auto. */
+    uint64_t               tx_size_samples;   /**< Total samples. */
     ib_mpool_t            *config_mp;       /**< Config memory pool */
     ib_mpool_t            *temp_mp;         /**< Temp memory pool for config */
     ib_var_store_t        *var_store;       /**< Var store */
@@ -167,6 +198,18 @@ struct ib_engine_t {
     ib_hash_t             *tfns;            /**< Hash tracking transforms */
     ib_hash_t             *operators;       /**< Operators by name */
     ib_hash_t             *stream_operators;/**< Stream operators by name*/
+
+    /**
+     * Dedup table of pure operator instances.
+     *
+     * Keyed by (operator, context, parameters); see
+     * ib_operator_inst_create().  Instances of operators carrying
+     * IB_OP_CAPABILITY_PURE are immutable at execution time and shared
+     * between rules with identical parameters, which also lets the
+     * per-transaction operator result cache hit across those rules.
+     * Configuration-time use only, like the registries above.
+     */
+    ib_hash_t             *operator_inst_cache;
     ib_hash_t             *actions;         /**< Hash tracking rules */
     ib_rule_engine_t      *rule_engine;     /**< Rule engine data */
     ib_logger_t           *logger;          /**< The engine log object. */
@@ -222,6 +265,19 @@ struct ib_context_t {
     ib_mm_t               mm;          /**< Memory manager */
     ib_cfgmap_t          *cfg;         /**< Config map */
     ib_array_t           *cfgdata;     /**< Config data */
+
+    /**
+     * Dense per-module config pointers, flattened at context close.
+     *
+     * Indexed by module index; entries are the module's config data
+     * (what ib_context_module_config() returns) or NULL.  Built once
+     * the context closes -- configs exist per (context, module) by
+     * then and their pointers no longer change -- so the
+     * per-rule-execution lookup is a single indexed load instead of
+     * the chunked-array arithmetic of cfgdata.  NULL until close.
+     */
+    void                **module_cfg;
+    size_t                module_cfg_count; /**< Entries in module_cfg. */
     ib_context_t         *parent;      /**< Parent context */
     ib_list_t            *children;    /**< Child contexts */
     ib_ctype_t            ctype;       /**< Context type */
@@ -27,6 +27,7 @@
 #include <ironbee/logevent.h>
 #include <ironbee/mm_mpool_lite.h>
 #include <ironbee/state_notify.h>
+#include <ironbee/stats.h>
 
 #include <assert.h>
 #if defined(__cplusplus) && !defined(__STDC_FORMAT_MACROS)
@@ -120,73 +121,65 @@ ib_status_t ib_logevent_create(ib_logevent_t **ple,
      */
 #define IB_LEVENT_MSG_BUF_SIZE 1024
 
-    ib_mpool_lite_t *mpl;
-    ib_mm_t mpl_mm;
-    char *buf;
+    char buf[IB_LEVENT_MSG_BUF_SIZE];
     va_list ap;
-    int len = 0;
     ib_status_t rc;
+    int len = 0;
+    size_t rule_id_len;
+    size_t msg_len;
+    char *strings;
 
-    rc = ib_mpool_lite_create(&mpl);
-    if (rc != IB_OK) {
-        return rc;
-    }
-    mpl_mm = ib_mm_mpool_lite(mpl);
-
-    buf = ib_mm_alloc(mpl_mm, IB_LEVENT_MSG_BUF_SIZE);
-    if (buf == NULL) {
-        rc = IB_EALLOC;
-        goto return_rc;
+    /*
+     * Generate the message on the stack, replacing the last three
+     * characters with "..." if truncation is required.
+     */
+    va_start(ap, fmt);
+    len = vsnprintf(buf, IB_LEVENT_MSG_BUF_SIZE, fmt, ap);
+    if (len >= IB_LEVENT_MSG_BUF_SIZE) {
+        memcpy(buf + (IB_LEVENT_MSG_BUF_SIZE - 4), "...", 3);
     }
+    va_end(ap);
 
-    *ple = (ib_logevent_t *)ib_mm_calloc(mm, 1, sizeof(**ple));
+    /* One allocation for the event and both strings: events arrive in
+     * bursts exactly when the engine is busiest, so each is a single
+     * pool bump rather than several. */
+    rule_id_len = strlen(rule_id) + 1;
+    msg_len     = strlen(buf) + 1;
+    *ple = (ib_logevent_t *)ib_mm_calloc(
+        mm, 1, sizeof(**ple) + rule_id_len + msg_len);
     if (*ple == NULL) {
-        rc = IB_EALLOC;
-        goto return_rc;
+        return IB_EALLOC;
     }
+    strings = (char *)(*ple + 1);
 
     (*ple)->event_id   = 0;
     (*ple)->mm         = mm;
-    (*ple)->rule_id    = ib_mm_strdup(mm, rule_id);
     (*ple)->type       = type;
     (*ple)->rec_action = rec_action;
     (*ple)->confidence = confidence;
     (*ple)->severity   = severity;
     (*ple)->suppress   = IB_LEVENT_SUPPRESS_NONE;
 
-    if ((*ple)->rule_id == NULL) {
-        rc = IB_EALLOC;
-        goto return_rc;
-    }
+    memcpy(strings, rule_id, rule_id_len);
+    (*ple)->rule_id = strings;
+    memcpy(strings + rule_id_len, buf, msg_len);
+    (*ple)->msg = strings + rule_id_len;
 
-    rc = ib_list_create(&((*ple)->tags), mm);
+    /* FFI consumers (lua/ironbee/logevent.lua) iterate tags without a
+     * NULL guard, so the list always exists, even when empty. */
+    rc = ib_list_create(&(*ple)->tags, mm);
     if (rc != IB_OK) {
-        goto return_rc;
-    }
-
-    /*
-     * Generate the message, replacing the last three characters
-     * with "..." if truncation is required.
-     */
-    va_start(ap, fmt);
-    len = vsnprintf(buf, IB_LEVENT_MSG_BUF_SIZE, fmt, ap);
-    if (len >= IB_LEVENT_MSG_BUF_SIZE) {
-        memcpy(buf + (IB_LEVENT_MSG_BUF_SIZE - 4), "...", 3);
+        return rc;
     }
-    va_end(ap);
 
-    /* Copy the formatted message. */
-    (*ple)->msg = ib_mm_strdup(mm, buf);
-
-return_rc:
-    ib_mpool_lite_destroy(mpl);
-    return rc;
+    return IB_OK;
 }
 
 ib_status_t ib_logevent_tag_add(ib_logevent_t *le,
                                 const char *tag)
 {
     assert(le != NULL);
+
     assert(le->tags != NULL);
 
     char *tag_copy;
@@ -238,6 +231,8 @@ ib_status_t ib_logevent_add(ib_tx_t       *tx,
         return rc;
     }
 
+    ib_stats_add(tx->ib, IB_STAT_LOGEVENTS, 1);
+
     rc = ib_engine_notify_logevent(tx->ib, tx, e);
 
     return rc;
@@ -26,6 +26,7 @@
 
 #include <ironbee/logger.h>
 #include <ironbee/mm_mpool_lite.h>
+#include <ironbee/queue_mpsc.h>
 #include <ironbee/string.h>
 #include <ironbee/type_convert.h>
 
@@ -35,6 +36,20 @@
 /**
  * A collection of callbacks and function pointer that implement a logger.
  */
+/**
+ * A node in a writer's record queue.
+ *
+ * Nodes are malloc()ed by the producer, pushed onto
+ * ib_logger_writer_t::records, and free()d by the consumer after the
+ * record is handled.  The queue node is first so a drained
+ * @ref ib_queue_mpsc_node_t is also a logger_record_node_t.
+ */
+typedef struct logger_record_node_t logger_record_node_t;
+struct logger_record_node_t {
+    ib_queue_mpsc_node_t  node;   /**< Queue linkage; must be first. */
+    void                 *record; /**< Formatted log record. */
+};
+
 struct ib_logger_writer_t {
     ib_logger_open_fn_t    open_fn;     /**< Open the logger. */
     void                  *open_data;   /**< Callback data. */
@@ -45,8 +60,15 @@ struct ib_logger_writer_t {
     ib_logger_format_t    *format;      /**< Format a message.  */
     ib_logger_record_fn_t  record_fn;   /**< Signal a record is ready. */
     void                  *record_data; /**< Callback data. */
-    ib_queue_t            *records;     /**< Records for the log writer. */
-    ib_lock_t             *records_lck; /**< Guard the queue. */
+
+    /**
+     * Lock-free multi-producer, single-consumer record queue.
+     *
+     * Producers push @ref logger_record_node_t; ib_logger_dequeue()
+     * drains the whole queue and handles records in submission order.
+     * The queue's approximate depth provides backpressure.
+     */
+    ib_queue_mpsc_t        records;
 };
 
 //! Identify the type of a logger callback function.
@@ -258,42 +280,27 @@ static ib_status_t logger_write(
         return rc;
     }
 
-    rc = ib_lock_lock(writer->records_lck);
-    if (rc != IB_OK) {
-        return rc;
-    }
-
     /* Busy-wait until the queue has space available.
      * This is emergency code to avoid a crash at the cost of a slowdown. */
-    while (ib_queue_size(writer->records) >= MAX_QUEUE_DEPTH) {
-        rc = ib_lock_unlock(writer->records_lck);
-        if (rc != IB_OK) {
-            return rc;
-        }
-
+    while (ib_queue_mpsc_depth(&writer->records) >= MAX_QUEUE_DEPTH) {
         /* TODO - The number of times we need to sleep should be
          *        audited. It is a good indicator of excessive logging or
          *        proxy load. */
         sleep(1);
-        rc = ib_lock_lock(writer->records_lck);
-        if (rc != IB_OK) {
-            return rc;
-        }
     }
 
-    rc = ib_queue_push_front(writer->records, rec);
-    if (rc != IB_OK) {
-        return rc;
+    logger_record_node_t *node = malloc(sizeof(*node));
+    if (node == NULL) {
+        return IB_EALLOC;
     }
+    node->record = rec;
 
-    /* If the queue is size=1, unlock and notify writers. */
-    if (ib_queue_size(writer->records) == 1) {
-        ib_lock_unlock(writer->records_lck);
+    /* If the queue was empty, notify writers. */
+    if (ib_queue_mpsc_push(&writer->records, &node->node)) {
         rc = writer->record_fn(logger, writer, writer->record_data);
         return rc;
     }
 
-    ib_lock_unlock(writer->records_lck);
     return rc;
 }
 
@@ -688,21 +695,7 @@ ib_status_t ib_logger_writer_add(
     writer->format      = format;
     writer->record_fn   = record_fn;
     writer->record_data = record_data;
-    rc = ib_queue_create(&(writer->records), logger->mm, IB_QUEUE_NEVER_SHRINK);
-    if (rc != IB_OK) {
-        return rc;
-    }
-    writer->records_lck = ib_mm_alloc(
-        logger->mm,
-        sizeof(*(writer->records_lck)));
-    if (writer->records_lck == NULL) {
-        return IB_EALLOC;
-    }
-    rc = ib_lock_create(&(writer->records_lck), logger->mm)
-    ;
-    if (rc != IB_OK) {
-        return rc;
-    }
+    ib_queue_mpsc_init(&writer->records);
 
     rc = ib_list_push(logger->writers, writer);
     if (rc != IB_OK) {
@@ -872,9 +865,7 @@ ib_status_t ib_logger_dequeue(
 {
     assert(logger != NULL);
     assert(writer != NULL);
-    assert(writer->records != NULL);
 
-    ib_status_t rc;
     logger_handler_cbdata_t logger_handler_cbdata = {
         .logger    = logger,
         .user_fn   = handler,
@@ -883,19 +874,17 @@ ib_status_t ib_logger_dequeue(
         .free_data = writer->format->format_free_cbdata
     };
 
-    rc = ib_lock_lock(writer->records_lck);
-    if (rc != IB_OK) {
-        return rc;
-    }
-
-    rc = ib_queue_dequeue_all_to_function(
-        writer->records,
-        logger_handler,
-        &logger_handler_cbdata);
+    /* Take the whole queue; nodes arrive in submission order. */
+    ib_queue_mpsc_node_t *qnode = ib_queue_mpsc_drain(&writer->records);
 
-    ib_lock_unlock(writer->records_lck);
+    while (qnode != NULL) {
+        logger_record_node_t *node = (logger_record_node_t *)qnode;
+        qnode = qnode->next;
+        logger_handler(node->record, &logger_handler_cbdata);
+        free(node);
+    }
 
-    return rc;
+    return IB_OK;
 }
 
 size_t ib_logger_writer_count(ib_logger_t *logger) {
@@ -28,6 +28,8 @@
 
 #include "engine_private.h"
 
+#include <ironbee/context.h>
+
 #include <assert.h>
 
 struct ib_operator_t {
@@ -326,6 +328,40 @@ ib_status_t ib_operator_inst_create(
     ib_operator_inst_t *local_op_inst;
     ib_status_t rc;
 
+    /* Pure operator instances are immutable at execution time, so rules
+     * with the same operator, context and parameters share one
+     * instance.  Creation is configuration time only, so the engine
+     * wide table needs no locking.  The key is (op, ctx, parameters);
+     * oversize parameters simply skip deduplication. */
+    char   dedup_key[512];
+    size_t dedup_key_len = 0;
+    ib_engine_t *ib = ib_context_get_engine(ctx);
+
+    if (
+        (op->capabilities & IB_OP_CAPABILITY_PURE) != 0 &&
+        (parameters == NULL ||
+         strlen(parameters) <= sizeof(dedup_key) - 2 * sizeof(void *) - 1)
+    ) {
+        memcpy(dedup_key, &op, sizeof(void *));
+        memcpy(dedup_key + sizeof(void *), &ctx, sizeof(void *));
+        dedup_key_len = 2 * sizeof(void *);
+        if (parameters != NULL) {
+            size_t len = strlen(parameters);
+            memcpy(dedup_key + dedup_key_len, parameters, len);
+            dedup_key_len += len;
+        }
+
+        rc = ib_hash_get_ex(
+            ib->operator_inst_cache,
+            &local_op_inst,
+            dedup_key, dedup_key_len
+        );
+        if (rc == IB_OK) {
+            *op_inst = local_op_inst;
+            return IB_OK;
+        }
+    }
+
     local_op_inst =
         (ib_operator_inst_t *)ib_mm_alloc(mm, sizeof(*local_op_inst));
     if (local_op_inst == NULL) {
@@ -367,6 +403,22 @@ ib_status_t ib_operator_inst_create(
         }
     }
 
+    /* Record pure instances for sharing.  The shared instance must not
+     * outlive its memory manager, so only instances created from the
+     * engine's own main manager are recorded. */
+    if (dedup_key_len > 0 && ib_mm_same(mm, ib_engine_mm_main_get(ib))) {
+        const char *key_copy = ib_mm_memdup(
+            ib_engine_mm_main_get(ib), dedup_key, dedup_key_len);
+
+        if (key_copy != NULL) {
+            ib_hash_set_ex(
+                ib->operator_inst_cache,
+                key_copy, dedup_key_len,
+                local_op_inst
+            );
+        }
+    }
+
     *op_inst = local_op_inst;
 
     return IB_OK;
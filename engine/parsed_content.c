@@ -103,6 +103,97 @@ ib_parsed_headers_t * ib_parsed_headers_gen(
 }
 
 
+/** Intern tables stop growing past this many entries. */
+#define PARSED_HEADERS_INTERN_MAX 1024
+
+/**
+ * Produce the byte string for a header name or value.
+ *
+ * Without an intern table (or on a table miss past the growth cap)
+ * this duplicates into the headers' memory as always.  With one, a
+ * repeated string is shared from the table and a new string is copied
+ * once into the table's (typically connection) lifetime.
+ */
+static ib_status_t parsed_headers_bytestr(
+    ib_parsed_headers_t *headers,
+    const char          *data,
+    size_t               data_len,
+    ib_bytestr_t       **out
+)
+{
+    ib_status_t rc;
+
+    if (headers->intern != NULL) {
+        ib_bytestr_t *shared;
+
+        rc = ib_hash_get_ex(headers->intern, &shared, data, data_len);
+        if (rc == IB_OK) {
+            *out = shared;
+            return IB_OK;
+        }
+
+        if (ib_hash_size(headers->intern) < PARSED_HEADERS_INTERN_MAX) {
+            rc = ib_bytestr_dup_mem(
+                &shared, headers->intern_mm, (const uint8_t *)data, data_len);
+            if (rc != IB_OK) {
+                return rc;
+            }
+            /* Key from the interned copy: it shares the table's
+             * lifetime.  On insert failure, fall through to a plain
+             * per-header copy. */
+            rc = ib_hash_set_ex(
+                headers->intern,
+                (const char *)ib_bytestr_const_ptr(shared), data_len,
+                shared);
+            if (rc == IB_OK) {
+                *out = shared;
+                return IB_OK;
+            }
+        }
+    }
+
+    return ib_bytestr_dup_mem(
+        out, headers->mm, (const uint8_t *)data, data_len);
+}
+
+void ib_parsed_headers_intern(
+    ib_parsed_headers_t *headers,
+    ib_hash_t           *intern,
+    ib_mm_t              intern_mm
+)
+{
+    assert(headers != NULL);
+
+    headers->intern    = intern;
+    headers->intern_mm = intern_mm;
+}
+
+ib_status_t ib_parsed_headers_append_header(
+    ib_parsed_headers_t *headers,
+    ib_parsed_header_t  *element
+)
+{
+    assert(headers != NULL);
+    assert(element != NULL);
+    assert(element->name != NULL);
+    assert(element->value != NULL);
+
+    element->next = NULL;
+
+    if (headers->head == NULL) {
+        headers->head = element;
+        headers->tail = element;
+        headers->size = 1;
+    }
+    else {
+        headers->tail->next = element;
+        headers->tail = element;
+        ++(headers->size);
+    }
+
+    return IB_OK;
+}
+
 ib_status_t ib_parsed_headers_add(
     ib_parsed_headers_t *headers,
     const char          *name,
@@ -124,20 +215,12 @@ ib_status_t ib_parsed_headers_add(
         return IB_EALLOC;
     }
 
-    rc = ib_bytestr_dup_mem(
-        &ele->name,
-        headers->mm,
-        (const uint8_t *)name, name_len
-    );
+    rc = parsed_headers_bytestr(headers, name, name_len, &ele->name);
     if (rc != IB_OK) {
         return rc;
     }
 
-    rc = ib_bytestr_dup_mem(
-        &ele->value,
-        headers->mm,
-        (const uint8_t *)value, value_len
-    );
+    rc = parsed_headers_bytestr(headers, value, value_len, &ele->value);
     if (rc != IB_OK) {
         return rc;
     }
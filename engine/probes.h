@@ -0,0 +1,62 @@
+/*****************************************************************************
+ * Licensed to Qualys, Inc. (QUALYS) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * QUALYS licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#ifndef _IB_PROBES_H_
+#define _IB_PROBES_H_
+
+/**
+ * @file
+ * @brief IronBee --- USDT Probe Points
+ *
+ * Static tracepoints for perf/systemtap/bpftrace, compiled in when
+ * <sys/sdt.h> is available and free (a nop instruction plus an ELF
+ * note) when no tracer is attached.  Without the header the macros
+ * compile away entirely.
+ *
+ * Provider: ironbee.  Probes:
+ * - tx_started(tx, id)
+ * - tx_finished(tx, id)
+ * - tx_blocked(tx, id)
+ * - phase_start(tx, phase)
+ * - phase_finish(tx, phase)
+ *
+ * @author Nick LeRoy <nleroy@qualys.com>
+ */
+
+#include "ironbee_config_auto.h"
+
+#ifdef HAVE_SYS_SDT_H
+
+#include <sys/sdt.h>
+
+#define IB_PROBE_TX_STARTED(tx, id)   DTRACE_PROBE2(ironbee, tx_started, (tx), (id))
+#define IB_PROBE_TX_FINISHED(tx, id)  DTRACE_PROBE2(ironbee, tx_finished, (tx), (id))
+#define IB_PROBE_TX_BLOCKED(tx, id)   DTRACE_PROBE2(ironbee, tx_blocked, (tx), (id))
+#define IB_PROBE_PHASE_START(tx, ph)  DTRACE_PROBE2(ironbee, phase_start, (tx), (ph))
+#define IB_PROBE_PHASE_FINISH(tx, ph) DTRACE_PROBE2(ironbee, phase_finish, (tx), (ph))
+
+#else /* HAVE_SYS_SDT_H */
+
+#define IB_PROBE_TX_STARTED(tx, id)
+#define IB_PROBE_TX_FINISHED(tx, id)
+#define IB_PROBE_TX_BLOCKED(tx, id)
+#define IB_PROBE_PHASE_START(tx, ph)
+#define IB_PROBE_PHASE_FINISH(tx, ph)
+
+#endif /* HAVE_SYS_SDT_H */
+
+#endif /* _IB_PROBES_H_ */
@@ -29,6 +29,7 @@
 
 #include "engine_private.h"
 #include "rule_logger_private.h"
+#include "probes.h"
 
 #include <ironbee/action.h>
 #include <ironbee/bytestr.h>
@@ -46,6 +47,7 @@
 #include <ironbee/string.h>
 #include <ironbee/transformation.h>
 #include <ironbee/util.h>
+#include <ironbee/var.h>
 
 #include <assert.h>
 #include <inttypes.h>
@@ -582,6 +584,14 @@ ib_status_t ib_rule_exec_create(ib_tx_t *tx, ib_rule_exec_t **rule_exec)
         return rc;
     }
 
+    /* Create the pure operator result cache */
+    rc = ib_hash_create(&(exec->op_results), tx->mm);
+    if (rc != IB_OK) {
+        ib_rule_log_tx_error(tx, "Failed to create operator result cache: %s",
+                             ib_status_to_string(rc));
+        return rc;
+    }
+
     /* Create the TX log object */
     rc = ib_rule_log_tx_create(exec, &(exec->tx_log));
     if (rc != IB_OK) {
@@ -592,11 +602,15 @@ ib_status_t ib_rule_exec_create(ib_tx_t *tx, ib_rule_exec_t **rule_exec)
     /* No current rule, target, etc. */
     exec->rule = NULL;
     exec->target = NULL;
+    exec->phase_rules_for = IB_PHASE_NONE;
     exec->cur_status = IB_OK;
     exec->cur_result = 0;
     exec->rule_status = IB_OK;
     exec->rule_result = 0;
     exec->exec_log = NULL;
+    exec->defer_node = NULL;
+    exec->defer_phase = IB_PHASE_NONE;
+    exec->defer_state = tx_started_state;
 
 #ifdef IB_RULE_TRACE
     exec->traces = ib_mm_calloc(
@@ -613,6 +627,240 @@ ib_status_t ib_rule_exec_create(ib_tx_t *tx, ib_rule_exec_t **rule_exec)
     return IB_OK;
 }
 
+bool ib_rule_exec_is_deferred(const ib_rule_exec_t *rule_exec)
+{
+    assert(rule_exec != NULL);
+
+    return rule_exec->defer_node != NULL;
+}
+
+/* Forward declaration; defined with the phase execution code below. */
+static ib_status_t execute_phase_rule_list(
+    ib_engine_t                *ib,
+    ib_tx_t                    *tx,
+    ib_state_t                  state,
+    const ib_rule_phase_meta_t *meta,
+    const ib_list_node_t       *start_node
+);
+
+/**
+ * May @a rule move relative to its neighbors without changing
+ * semantics?
+ *
+ * Conservative: chained rules keep their anchors, and any action other
+ * than pure reporting (event, logdata) -- blocks, allows, setvar and
+ * friends -- pins the rule as an ordering barrier, since moving it
+ * would change what later rules observe or whether they run.
+ */
+static bool rule_is_reorderable(const ib_rule_t *rule)
+{
+    static const char *reporting_actions[] = { "event", "logdata", NULL };
+    const ib_list_t *action_lists[3];
+
+    if (rule->chained_rule != NULL || rule->chained_from != NULL) {
+        return false;
+    }
+    if (ib_flags_all(rule->flags, IB_RULE_FLAG_EXTERNAL)) {
+        /* External (scripted) rules can have arbitrary side effects. */
+        return false;
+    }
+    if (ib_flags_all(rule->flags, IB_RULE_FLAG_CAPTURE)) {
+        /* Capturing rules write the CAPTURE collection, a var later
+         * rules read; capture is a rule flag, not an action, so the
+         * action filter below never sees it. */
+        return false;
+    }
+
+    action_lists[0] = rule->true_actions;
+    action_lists[1] = rule->false_actions;
+    action_lists[2] = rule->aux_actions;
+    for (int i = 0; i < 3; ++i) {
+        const ib_list_node_t *node;
+
+        if (action_lists[i] == NULL) {
+            continue;
+        }
+        IB_LIST_LOOP_CONST(action_lists[i], node) {
+            const ib_action_inst_t *inst =
+                (const ib_action_inst_t *)ib_list_node_data_const(node);
+            const char *name = ib_action_name(ib_action_inst_action(inst));
+            bool ok = false;
+
+            for (int j = 0; reporting_actions[j] != NULL; ++j) {
+                if (strcmp(name, reporting_actions[j]) == 0) {
+                    ok = true;
+                    break;
+                }
+            }
+            if (! ok) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Reorder one phase's runnable array by measured cost.
+ *
+ * Within each maximal run of consecutive reorderable rules, rules with
+ * enough profiler samples are stably sorted by ascending mean ticks,
+ * so cheap discriminators run before expensive rarely-deciding rules;
+ * unsampled rules and barriers (see rule_is_reorderable()) keep their
+ * positions, preserving declared order across them.  The new array is
+ * published with a single pointer store after a release barrier;
+ * executions snapshot the pointer once, so a swap mid-transaction is
+ * never observed as a mixed order.
+ */
+static ib_status_t reorder_ruleset_phase(
+    ib_engine_t        *ib,
+    ib_context_t       *ctx,
+    ib_ruleset_phase_t *ruleset_phase
+)
+{
+    const ib_rule_profiler_t *profiler = ib->rule_engine->profiler;
+    ib_rule_t **reordered;
+    uint64_t   *score;
+    size_t      n = ruleset_phase->n_runnable;
+
+    /* Meaningful means below this many samples are noise. */
+    static const uint64_t MIN_SAMPLES = 16;
+
+    if (n < 2) {
+        return IB_OK;
+    }
+
+    reordered = ib_mm_alloc(ctx->mm, n * sizeof(*reordered));
+    score     = ib_mm_alloc(ctx->mm, n * sizeof(*score));
+    if (reordered == NULL || score == NULL) {
+        return IB_EALLOC;
+    }
+    memcpy(reordered, ruleset_phase->runnable, n * sizeof(*reordered));
+
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t mean = 0;
+        uint64_t samples = 0;
+
+        score[i] = UINT64_MAX;  /* Unsampled: never moved. */
+        if (ib_rule_profiler_mean(
+                profiler, reordered[i], &mean, &samples) == IB_OK &&
+            samples >= MIN_SAMPLES)
+        {
+            score[i] = mean;
+        }
+    }
+
+    /* Stable insertion sort within runs of reorderable, sampled rules. */
+    {
+        size_t run_start = 0;
+
+        for (size_t i = 0; i <= n; ++i) {
+            bool barrier =
+                (i == n) ||
+                (! rule_is_reorderable(reordered[i])) ||
+                (score[i] == UINT64_MAX);
+
+            if (barrier) {
+                for (size_t a = run_start + 1; a < i; ++a) {
+                    ib_rule_t *rule_tmp = reordered[a];
+                    uint64_t   score_tmp = score[a];
+                    size_t     b = a;
+
+                    while (b > run_start && score[b - 1] > score_tmp) {
+                        reordered[b] = reordered[b - 1];
+                        score[b] = score[b - 1];
+                        --b;
+                    }
+                    reordered[b] = rule_tmp;
+                    score[b] = score_tmp;
+                }
+                run_start = i + 1;
+            }
+        }
+    }
+
+    /* Publish atomically; the count is unchanged. */
+    __sync_synchronize();
+    ruleset_phase->runnable = reordered;
+
+    return IB_OK;
+}
+
+/**
+ * Reorder @a ctx's phases and recurse into child contexts.
+ */
+static ib_status_t rule_engine_reorder_ctx(ib_engine_t *ib, ib_context_t *ctx)
+{
+    ib_status_t rc;
+
+    if (ctx->rules != NULL) {
+        for (int phase = IB_PHASE_NONE; phase < IB_RULE_PHASE_COUNT; ++phase) {
+            rc = reorder_ruleset_phase(
+                ib, ctx, &ctx->rules->ruleset.phases[phase]);
+            if (rc != IB_OK) {
+                return rc;
+            }
+        }
+    }
+
+    if (ctx->children != NULL) {
+        const ib_list_node_t *node;
+
+        IB_LIST_LOOP_CONST(ctx->children, node) {
+            rc = rule_engine_reorder_ctx(
+                ib, (ib_context_t *)ib_list_node_data_const(node));
+            if (rc != IB_OK) {
+                return rc;
+            }
+        }
+    }
+
+    return IB_OK;
+}
+
+ib_status_t ib_rule_engine_reorder(ib_engine_t *ib)
+{
+    assert(ib != NULL);
+
+    return rule_engine_reorder_ctx(ib, ib_context_main(ib));
+}
+
+ib_status_t ib_rule_exec_resume(ib_rule_exec_t *rule_exec)
+{
+    assert(rule_exec != NULL);
+    assert(rule_exec->tx != NULL);
+
+    const ib_rule_phase_meta_t *meta;
+    const ib_list_node_t       *start;
+    ib_state_t                  state;
+    ib_status_t                 rc;
+
+    if (rule_exec->defer_node == NULL) {
+        return IB_EINVAL;
+    }
+
+    rc = find_phase_meta(rule_exec->defer_phase, &meta);
+    if (rc != IB_OK) {
+        return rc;
+    }
+
+    start = rule_exec->defer_node;
+    state = rule_exec->defer_state;
+
+    /* Unpark; a further defer in the remaining rules parks again. */
+    rule_exec->defer_node  = NULL;
+    rule_exec->defer_phase = IB_PHASE_NONE;
+
+    rule_exec->phase = meta->phase_num;
+    rule_exec->is_stream = false;
+
+    /* Re-execute from the deferring rule, inclusive: its operator now
+     * returns the completed result synchronously. */
+    return execute_phase_rule_list(
+        rule_exec->ib, rule_exec->tx, state, meta, start);
+}
+
 /**
  * Push a rule onto the rule execution object's rule stack
  *
@@ -808,9 +1056,75 @@ static ib_status_t execute_tfn_single(const ib_rule_exec_t  *rule_exec,
     return IB_OK;
 }
 
+/**
+ * Execute one transformation step with execution logging.
+ *
+ * @param[in] rule_exec The rule execution object
+ * @param[in] tfn_inst The transformation instance to execute
+ * @param[in] in_field Input value for the step
+ * @param[out] out Pointer to field in which to store the result
+ *
+ * @returns Status code
+ */
+static ib_status_t execute_tfn_step(const ib_rule_exec_t *rule_exec,
+                                    const ib_transformation_inst_t *tfn_inst,
+                                    const ib_field_t *in_field,
+                                    const ib_field_t **out)
+{
+    assert(rule_exec != NULL);
+    assert(tfn_inst != NULL);
+    assert(out != NULL);
+
+    ib_status_t rc;
+
+    /* Run it */
+    ib_rule_log_trace(
+        rule_exec,
+        "Executing transformation %s",
+        ib_transformation_name(
+            ib_transformation_inst_transformation(tfn_inst)
+        ));
+    ib_rule_log_exec_tfn_inst_add(rule_exec->exec_log, tfn_inst);
+    rc = execute_tfn_single(rule_exec, tfn_inst, in_field, out);
+    if (rc != IB_OK) {
+        ib_rule_log_error(
+            rule_exec,
+            "Error executing target transformation %s: %s",
+            ib_transformation_name(
+                ib_transformation_inst_transformation(tfn_inst)
+            ),
+            ib_status_to_string(rc)
+        );
+    }
+    ib_rule_log_exec_tfn_inst_fin(
+        rule_exec->exec_log,
+        tfn_inst,
+        in_field,
+        *out,
+        rc);
+
+    /* Verify that out isn't NULL */
+    if (*out == NULL) {
+        ib_rule_log_error(
+            rule_exec,
+            "Target transformation %s returned NULL",
+            ib_transformation_name(
+                ib_transformation_inst_transformation(tfn_inst)
+            )
+        );
+        return IB_EINVAL;
+    }
+
+    return IB_OK;
+}
+
 /**
  * Execute list of transformations on a target.
  *
+ * Walks the target's compiled transformation array when the owning rule
+ * has been compiled (see compile_rule_program()), falling back to the
+ * configuration-time list otherwise.
+ *
  * @param[in] rule_exec The rule execution object
  * @param[in] value Initial value of the target field
  * @param[out] result Pointer to field in which to store the result
@@ -824,76 +1138,59 @@ static ib_status_t execute_tfns(const ib_rule_exec_t *rule_exec,
     assert(rule_exec != NULL);
     assert(result != NULL);
 
-    ib_status_t           rc;
-    const ib_list_node_t *node = NULL;
-    const ib_field_t     *in_field;
-    const ib_field_t     *out = NULL;
+    ib_status_t             rc;
+    const ib_rule_target_t *target = rule_exec->target;
+    const ib_list_node_t   *node = NULL;
+    const ib_field_t       *in_field;
+    const ib_field_t       *out = NULL;
 
     /* No transformations?  Do nothing. */
     if (value == NULL) {
         *result = NULL;
         return IB_OK;
     }
-    else if (ib_list_elements(rule_exec->target->tfn_list) == 0) {
+    else if (ib_list_elements(target->tfn_list) == 0) {
         *result = value;
         ib_rule_log_trace(rule_exec, "No transformations");
         return IB_OK;
     }
 
     ib_rule_log_trace(rule_exec, "Executing %zd transformations",
-                      ib_list_elements(rule_exec->target->tfn_list));
+                      ib_list_elements(target->tfn_list));
 
     /*
      * Loop through all of the target's transformations.
      */
     in_field = value;
-    IB_LIST_LOOP_CONST(rule_exec->target->tfn_list, node) {
-        const ib_transformation_inst_t  *tfn_inst =
-            (const ib_transformation_inst_t *)ib_list_node_data_const(node);
+    if (target->tfn_array != NULL) {
+        for (size_t i = 0;  i < target->n_tfns;  ++i) {
+            rc = execute_tfn_step(rule_exec, target->tfn_array[i],
+                                  in_field, &out);
+            if (rc != IB_OK) {
+                return rc;
+            }
 
-        /* Run it */
-        ib_rule_log_trace(
-            rule_exec,
-            "Executing transformation %s",
-            ib_transformation_name(
-                ib_transformation_inst_transformation(tfn_inst)
-            ));
-        ib_rule_log_exec_tfn_inst_add(rule_exec->exec_log, tfn_inst);
-        rc = execute_tfn_single(rule_exec, tfn_inst, in_field, &out);
-        if (rc != IB_OK) {
-            ib_rule_log_error(
-                rule_exec,
-                "Error executing target transformation %s: %s",
-                ib_transformation_name(
-                    ib_transformation_inst_transformation(tfn_inst)
-                ),
-                ib_status_to_string(rc)
-            );
-        }
-        ib_rule_log_exec_tfn_inst_fin(
-            rule_exec->exec_log,
-            tfn_inst,
-            in_field,
-            out,
-            rc);
-
-        /* Verify that out isn't NULL */
-        if (out == NULL) {
-            ib_rule_log_error(
-                rule_exec,
-                "Target transformation %s returned NULL",
-                ib_transformation_name(
-                    ib_transformation_inst_transformation(tfn_inst)
-                )
-            );
-            return IB_EINVAL;
+            /* The output of the step is input for the next step. */
+            in_field = out;
         }
+    }
+    else {
+        IB_LIST_LOOP_CONST(target->tfn_list, node) {
+            const ib_transformation_inst_t  *tfn_inst =
+                (const ib_transformation_inst_t *)
+                    ib_list_node_data_const(node);
+
+            rc = execute_tfn_step(rule_exec, tfn_inst, in_field, &out);
+            if (rc != IB_OK) {
+                return rc;
+            }
 
-        /* The output of the operator is now input for the next field op. */
-        in_field = out;
+            /* The output of the step is input for the next step. */
+            in_field = out;
+        }
     }
 
-    /* The output of the final operator is the result */
+    /* The output of the final step is the result */
     *result = out;
 
     /* Done. */
@@ -1499,6 +1796,14 @@ static void exe_op_trace_values(ib_rule_exec_t *rule_exec,
  *
  * @returns Status code
  */
+/**
+ * A cached pure operator result; see ib_rule_exec_t::op_results.
+ */
+typedef struct {
+    ib_status_t op_rc;  /**< Status the operator returned. */
+    ib_num_t    result; /**< Result the operator produced. */
+} op_result_cache_entry_t;
+
 static ib_status_t execute_phase_operator(ib_rule_exec_t *rule_exec,
                                           const ib_field_t *value,
                                           int recursion)
@@ -1548,6 +1853,11 @@ static ib_status_t execute_phase_operator(ib_rule_exec_t *rule_exec,
 
             /* Recursive call. */
             rc = execute_phase_operator(rule_exec, nvalue, recursion);
+            if (rc == IB_DEFER) {
+                /* Parks the phase; the rule re-executes on resume. */
+                rule_exec_pop_value(rule_exec, pushed);
+                return rc;
+            }
             if (rc != IB_OK) {
                 ib_rule_log_warn(rule_exec,
                                  "Error executing list element #%d: %s",
@@ -1564,6 +1874,37 @@ static ib_status_t execute_phase_operator(ib_rule_exec_t *rule_exec,
     else {
         ib_num_t    result = 0;
         ib_status_t op_rc = IB_OK;
+        bool        cached = false;
+        bool        cacheable;
+        /* Cache key: (operator instance, value field) pointer pair. */
+        const void *cache_key[2];
+
+        /* Pure operator executions without capture are cached per
+         * transaction: the same instance applied to the same field
+         * yields the same result. */
+        cacheable =
+            (value != NULL) &&
+            (get_capture(rule_exec) == NULL) &&
+            ib_flags_all(
+                ib_operator_capabilities(
+                    ib_operator_inst_operator(opinst->opinst)),
+                IB_OP_CAPABILITY_PURE);
+        if (cacheable) {
+            op_result_cache_entry_t *entry;
+
+            cache_key[0] = opinst->opinst;
+            cache_key[1] = value;
+            rc = ib_hash_get_ex(
+                rule_exec->op_results,
+                &entry,
+                (const char *)cache_key, sizeof(cache_key)
+            );
+            if (rc == IB_OK) {
+                op_rc  = entry->op_rc;
+                result = entry->result;
+                cached = true;
+            }
+        }
 
         /* Fill in the FIELD* fields */
         rc = set_target_fields(rule_exec, value);
@@ -1573,51 +1914,83 @@ static ib_status_t execute_phase_operator(ib_rule_exec_t *rule_exec,
                               ib_status_to_string(rc));
         }
 
-        {
-            ib_list_node_t *node;
-            IB_LIST_LOOP(rule_exec->ib->rule_engine->hooks.pre_operator, node) {
-                const ib_rule_pre_operator_hook_t *hook =
-                    (const ib_rule_pre_operator_hook_t *)
-                        ib_list_node_data_const(node);
-                hook->fn(
-                    rule_exec,
-                    opinst->opinst,
-                    opinst->invert,
-                    value,
-                    hook->data
-                );
+        if (! cached) {
+            {
+                ib_list_node_t *node;
+                IB_LIST_LOOP(
+                    rule_exec->ib->rule_engine->hooks.pre_operator, node)
+                {
+                    const ib_rule_pre_operator_hook_t *hook =
+                        (const ib_rule_pre_operator_hook_t *)
+                            ib_list_node_data_const(node);
+                    hook->fn(
+                        rule_exec,
+                        opinst->opinst,
+                        opinst->invert,
+                        value,
+                        hook->data
+                    );
+                }
             }
-        }
 
-        /* @todo remove the cast-away of the constness of value */
-        op_rc = ib_operator_inst_execute(
-            opinst->opinst,
-            rule_exec->tx,
-            (ib_field_t *)value,
-            get_capture(rule_exec),
-            &result
-        );
-        if (op_rc != IB_OK) {
-            ib_rule_log_warn(rule_exec, "Operator returned an error: %s",
-                             ib_status_to_string(op_rc));
-        }
+            /* @todo remove the cast-away of the constness of value */
+            op_rc = ib_operator_inst_execute(
+                opinst->opinst,
+                rule_exec->tx,
+                (ib_field_t *)value,
+                get_capture(rule_exec),
+                &result
+            );
+            if (op_rc == IB_DEFER) {
+                /* The operator started an asynchronous operation; park
+                 * the phase.  No result yet, so skip caching, actions
+                 * and result bookkeeping: the rule re-executes when the
+                 * server calls ib_rule_exec_resume(). */
+                clear_target_fields(rule_exec);
+                return IB_DEFER;
+            }
+            if (op_rc != IB_OK) {
+                ib_rule_log_warn(rule_exec, "Operator returned an error: %s",
+                                 ib_status_to_string(op_rc));
+            }
 
-        {
-            ib_list_node_t *node;
-            IB_LIST_LOOP(rule_exec->ib->rule_engine->hooks.post_operator, node) {
-                const ib_rule_post_operator_hook_t *hook =
-                    (const ib_rule_post_operator_hook_t *)
-                        ib_list_node_data_const(node);
-                hook->fn(
-                    rule_exec,
-                    opinst->opinst,
-                    opinst->invert,
-                    value,
-                    op_rc,
-                    result,
-                    get_capture(rule_exec),
-                    hook->data
-                );
+            {
+                ib_list_node_t *node;
+                IB_LIST_LOOP(
+                    rule_exec->ib->rule_engine->hooks.post_operator, node)
+                {
+                    const ib_rule_post_operator_hook_t *hook =
+                        (const ib_rule_post_operator_hook_t *)
+                            ib_list_node_data_const(node);
+                    hook->fn(
+                        rule_exec,
+                        opinst->opinst,
+                        opinst->invert,
+                        value,
+                        op_rc,
+                        result,
+                        get_capture(rule_exec),
+                        hook->data
+                    );
+                }
+            }
+
+            /* Record the result for other rules in this transaction. */
+            if (cacheable) {
+                op_result_cache_entry_t *entry = ib_mm_alloc(
+                    rule_exec->tx->mm, sizeof(*entry));
+                const void *key_copy = ib_mm_memdup(
+                    rule_exec->tx->mm, cache_key, sizeof(cache_key));
+
+                if (entry != NULL && key_copy != NULL) {
+                    entry->op_rc  = op_rc;
+                    entry->result = result;
+                    ib_hash_set_ex(
+                        rule_exec->op_results,
+                        (const char *)key_copy, sizeof(cache_key),
+                        entry
+                    );
+                }
             }
         }
 
@@ -1723,6 +2096,21 @@ static ib_status_t execute_phase_rule_targets(ib_rule_exec_t *rule_exec)
     /* Log what we're going to do */
     ib_rule_log_debug(rule_exec, "Executing rule");
 
+    /* On shape-specialized executors (straight-line variants for the
+     * dominant rule shapes, dispatched by a tag computed at context
+     * close): considered and rejected.  What the common shapes pay in
+     * this loop is either already specialized at a lower layer --
+     * targets and transformations are flattened arrays, input-absent
+     * rules are skipped before dispatch, pure operator results are
+     * cached per transaction, and the streq family compares constants
+     * pre-compiled at instance creation -- or is semantically required
+     * for every shape: the single/list wrap and unwrap, the
+     * FIELD_NAME_FULL value stack, capture, and execution logging.  A
+     * per-shape clone of this body would duplicate that required part
+     * per variant and make every future semantic fix a multi-site
+     * change, for the few branches that remain.  Keep the machinery in
+     * one place and specialize mechanisms, not the interpreter loop. */
+
     /* If this is a no-target rule (i.e. action), do nothing */
     if (ib_flags_all(rule->flags, IB_RULE_FLAG_NO_TGT)) {
         assert(ib_list_elements(rule->target_fields) == 1);
@@ -1734,21 +2122,34 @@ static ib_status_t execute_phase_rule_targets(ib_rule_exec_t *rule_exec)
     ib_rule_log_debug(rule_exec, "Operating on %zd fields.",
                       ib_list_elements(rule->target_fields));
 
-    /* Loop through all of the fields.
+    /* Loop through all of the fields, preferring the compiled target
+     * array over the configuration-time list when available.
      *
      * @todo The current behavior is to keep running even after an operator
      * returns an error.  This needs further discussion to determine what the
      * correct behavior should be.
      */
-    IB_LIST_LOOP(rule->target_fields, node) {
+    const size_t n_targets =
+        (rule->target_array != NULL)
+        ? rule->n_targets
+        : ib_list_elements(rule->target_fields);
+    node = ib_list_first(rule->target_fields);
+    for (size_t tgt_n = 0;  tgt_n < n_targets;  ++tgt_n) {
         ib_status_t         getrc;
         ib_list_t          *result     = NULL;
         ib_field_t         *value      = NULL; /* Var. */
         const ib_field_t   *tfnvalue   = NULL; /* Var value after tfns */
         bool                pushed     = true;
         bool                pop_target = false;
-        ib_rule_target_t   *target     =
-            (ib_rule_target_t *)ib_list_node_data(node);
+        ib_rule_target_t   *target;
+
+        if (rule->target_array != NULL) {
+            target = rule->target_array[tgt_n];
+        }
+        else {
+            target = (ib_rule_target_t *)ib_list_node_data(node);
+            node = ib_list_node_next(node);
+        }
 
         assert(target != NULL);
 
@@ -1915,6 +2316,10 @@ static ib_status_t execute_phase_rule_targets(ib_rule_exec_t *rule_exec)
 
                 rc = execute_phase_operator(rule_exec, node_value,
                                             MAX_LIST_RECURSION);
+                if (rc == IB_DEFER) {
+                    rule_exec_pop_value(rule_exec, lpushed);
+                    return rc;
+                }
                 if (rc != IB_OK) {
                     ib_rule_log_error(rule_exec,
                                       "Operator returned an error: %s",
@@ -1929,6 +2334,10 @@ static ib_status_t execute_phase_rule_targets(ib_rule_exec_t *rule_exec)
         else {
             ib_rule_log_trace(rule_exec, "Calling exop on single target");
             rc = execute_phase_operator(rule_exec, tfnvalue, MAX_LIST_RECURSION);
+            if (rc == IB_DEFER) {
+                rule_exec_pop_value(rule_exec, pushed);
+                return rc;
+            }
             if (rc != IB_OK) {
                 ib_rule_log_error(rule_exec,
                                   "Operator returned an error: %s",
@@ -1971,6 +2380,7 @@ static ib_status_t execute_phase_rule(ib_rule_exec_t *rule_exec,
 {
     ib_status_t         rc = IB_OK;
     ib_status_t         trc;          /* Temporary status code */
+    uint64_t            profile_start = 0;
 #ifdef IB_RULE_TRACE
     ib_time_t pre_time;
     ib_time_t post_time;
@@ -2019,11 +2429,23 @@ static ib_status_t execute_phase_rule(ib_rule_exec_t *rule_exec,
         pre_time = ib_clock_get_time();
     }
 #endif
+    if (ib_rule_profiler_is_enabled(rule_exec->ib->rule_engine->profiler)) {
+        profile_start = ib_rule_profiler_ticks();
+    }
     trc = execute_phase_rule_targets(rule_exec);
     if (trc != IB_OK) {
         rc = trc;
         goto cleanup;
     }
+    if (profile_start != 0) {
+        ib_rule_profiler_record(
+            rule_exec->ib->rule_engine->profiler,
+            rule,
+            rule_exec->tx->ctx,
+            ib_rule_profiler_ticks() - profile_start,
+            rule_exec->rule_result != 0
+        );
+    }
 #ifdef IB_RULE_TRACE
     if (rule->flags & IB_RULE_FLAG_TRACE) {
         post_time = ib_clock_get_time();
@@ -2049,7 +2471,12 @@ static ib_status_t execute_phase_rule(ib_rule_exec_t *rule_exec,
                           ib_rule_id(rule->chained_rule));
         trc = execute_phase_rule(rule_exec, rule->chained_rule, recursion);
 
-        if (trc != IB_OK) {
+        if (trc == IB_DEFER) {
+            /* The whole chain re-executes from its first rule on
+             * resume; pure operator results are served from cache. */
+            rc = trc;
+        }
+        else if (trc != IB_OK) {
             ib_rule_log_error(rule_exec,
                               "Error executing chained rule \"%s\": %s",
                               ib_rule_id(rule->chained_rule),
@@ -2098,6 +2525,42 @@ static bool rule_is_runnable(const ib_rule_ctx_data_t *ctx_rule)
     return true;
 }
 
+/**
+ * Check if any of a rule's target sources may be set.
+ *
+ * Only valid for rules carrying IB_RULE_FLAG_INDEXED.  Indexed sources
+ * are checked exactly with a constant time array access; unindexed
+ * sources are checked against the var store's existence bloom filter,
+ * which can report "maybe set" spuriously but never misses a set (see
+ * ib_var_source_maybe_set()).
+ *
+ * @param[in] rule Rule to check
+ * @param[in] var_store Transaction var store
+ *
+ * @returns true if at least one target source may have a value,
+ *          otherwise false
+ */
+static bool rule_inputs_present(const ib_rule_t *rule,
+                                ib_var_store_t *var_store)
+{
+    assert(rule != NULL);
+    assert(rule->indexed_sources != NULL);
+    assert(var_store != NULL);
+
+    const ib_list_node_t *node;
+
+    IB_LIST_LOOP_CONST(rule->indexed_sources, node) {
+        const ib_var_source_t *source =
+            (const ib_var_source_t *)ib_list_node_data_const(node);
+
+        if (ib_var_source_maybe_set(source, var_store)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 /**
  * Check if allow affects the current rule
  *
@@ -2243,31 +2706,35 @@ static ib_status_t inject_rules(const ib_engine_t *ib,
 /**
  * Append context rules onto the rule execution object's phase rule list
  *
+ * The enable/valid tests were already decided when the context closed
+ * (see build_runnable_array()), so this just walks the phase's dense
+ * runnable array.
+ *
  * @param[in] ib IronBee engine
  * @param[in] phase_meta Phase meta data
- * @param[in] rule_list List of context rules to append
+ * @param[in] ruleset_phase Phase ruleset whose runnable rules to append
  * @param[in,out] rule_exec Rule execution object
  *
  * @returns Status code
  */
 static ib_status_t append_context_rules(const ib_engine_t *ib,
                                         const ib_rule_phase_meta_t *phase_meta,
-                                        const ib_list_t *rule_list,
+                                        const ib_ruleset_phase_t *ruleset_phase,
                                         ib_rule_exec_t *rule_exec)
 {
     assert(ib != NULL);
     assert(phase_meta != NULL);
     assert(rule_exec != NULL);
-    assert(rule_list != NULL);
-
-    const ib_list_node_t *node;
+    assert(ruleset_phase != NULL);
 
-    IB_LIST_LOOP_CONST(rule_list, node) {
-        const ib_rule_ctx_data_t *ctx_rule =
-            (const ib_rule_ctx_data_t *)ib_list_node_data_const(node);
+    /* Snapshot the array pointer once: a concurrent reorder swaps the
+     * pointer atomically and never changes the count, so this list is
+     * always one coherent order. */
+    {
+        ib_rule_t *const *runnable = ruleset_phase->runnable;
 
-        if (rule_is_runnable(ctx_rule)) {
-            ib_list_push(rule_exec->phase_rules, ctx_rule->rule);
+        for (size_t i = 0; i < ruleset_phase->n_runnable; ++i) {
+            ib_list_push(rule_exec->phase_rules, runnable[i]);
         }
     }
 
@@ -2275,31 +2742,290 @@ static ib_status_t append_context_rules(const ib_engine_t *ib,
 }
 
 /**
- * Run a set of phase rules.
+ * Execute a phase's rule list from @a start_node to completion.
+ *
+ * Factored out of run_phase_rules() so ib_rule_exec_resume() can
+ * continue a parked phase from the deferring rule.
+ *
+ * On sharding this loop across threads: partitioning a phase's
+ * "independent" rules onto a pool has been considered for very large
+ * phases and rejected.  Independence analyzable from target/action
+ * metadata covers the var store, but every rule execution also writes
+ * the shared execution object (rule/target/value stacks, exec log),
+ * the capture collection, the per-transaction operator result cache,
+ * transaction flags and the logevent list -- none of which is
+ * synchronized, by design: one thread drives a transaction at a time
+ * everywhere in this engine, which is also what lets operators and
+ * actions stay lock free.  The effective levers for large phases are
+ * the ones this loop already uses (the dense runnable arrays, indexed
+ * input skipping, the pure-operator cache, the inspection budget) plus
+ * deferring operators for work that genuinely leaves the thread.  Runs block/allow
+ * handling, the inspection budget and the end-of-phase bookkeeping;
+ * when an operator defers, the position is parked in the rule
+ * execution object and IB_DEFER is returned with the bookkeeping
+ * still pending.
  *
  * @param[in] ib Engine.
- * @param[in,out] tx Transaction.
- * @param[in] state State.
- * @param[in] cbdata Callback data (actually phase_rule_cbdata_t).
+ * @param[in] tx Transaction.
+ * @param[in] state State the phase was notified as (for logging).
+ * @param[in] meta Phase meta data.
+ * @param[in] start_node Node in the phase rule list to start at, or
+ *            NULL for the beginning.
  *
- * @returns
- *   - IB_OK on success.
- *   - IB_DECLINED if the httpd plugin declines to block the traffic.
+ * @returns Status code; IB_DEFER when parked.
  */
-static ib_status_t run_phase_rules(ib_engine_t *ib,
-                                   ib_tx_t *tx,
-                                   ib_state_t state,
-                                   void *cbdata)
+static ib_status_t execute_phase_rule_list(
+    ib_engine_t                *ib,
+    ib_tx_t                    *tx,
+    ib_state_t                  state,
+    const ib_rule_phase_meta_t *meta,
+    const ib_list_node_t       *start_node
+)
 {
     assert(ib != NULL);
     assert(tx != NULL);
-    assert(tx->ctx != NULL);
-    assert(cbdata != NULL);
+    assert(tx->rule_exec != NULL);
+    assert(meta != NULL);
 
-    /* If this is an empty request, ignore the transaction */
-    if (! ib_flags_any(tx->flags, IB_TX_FREQ_HAS_DATA | IB_TX_FRES_HAS_DATA)) {
-        return IB_OK;
-    }
+    ib_context_t         *ctx = tx->ctx;
+    ib_rule_exec_t       *rule_exec = tx->rule_exec;
+    const ib_list_node_t *node = NULL;
+    ib_status_t           rc = IB_OK;
+
+    /* Inspection budget: when configured, rules stop (fail open) once
+     * the transaction exceeds its time budget. */
+    ib_time_t inspection_deadline = 0;
+    {
+        ib_core_cfg_t *corecfg = NULL;
+
+        if (ib_core_context_config(ctx, &corecfg) == IB_OK &&
+            corecfg->inspection_budget_usec > 0)
+        {
+            inspection_deadline =
+                tx->t.started + (ib_time_t)corecfg->inspection_budget_usec;
+        }
+    }
+    unsigned int budget_check = 0;
+
+    /*
+     * Loop through all of the rules for this phase, execute them.
+     *
+     * @todo The current behavior is to keep running even after rule execution
+     * returns an error.  This needs further discussion to determine what the
+     * correct behavior should be.
+     */
+    for (node = (start_node != NULL)
+             ? start_node
+             : ib_list_first_const(rule_exec->phase_rules);
+         node != NULL;
+         node = ib_list_node_next_const(node))
+    {
+        const ib_rule_t *rule =
+            (const ib_rule_t *)ib_list_node_data_const(node);
+        ib_status_t      rule_rc;
+
+        assert(
+            rule->meta.phase == meta->phase_num ||
+            rule->meta.phase == IB_PHASE_NONE
+        );
+
+#ifdef __GNUC__
+        /* Pull the next rule's hot line (index, flags, operator
+         * pointer) toward the cache while this rule executes; the
+         * dependent loads between rules otherwise stall the loop.
+         * The list node itself rides along with the data load above. */
+        {
+            const ib_list_node_t *prefetch_node =
+                ib_list_node_next_const(node);
+
+            if (prefetch_node != NULL) {
+                __builtin_prefetch(
+                    ib_list_node_data_const(prefetch_node), 0, 1);
+            }
+        }
+#endif
+
+        /* Allow (skip) this phase? */
+        if (rule_allow(tx, meta, true)) {
+            break;
+        }
+
+        /* Enforce the inspection budget with a cheap check: one clock
+         * read per 16 rules. */
+        if (inspection_deadline != 0 && (++budget_check & 0xf) == 0) {
+            if (ib_clock_get_time() > inspection_deadline) {
+                ib_rule_log_warn(rule_exec,
+                                 "Inspection budget exhausted; "
+                                 "skipping remaining rules (fail open).");
+                ib_tx_flags_set(tx, IB_TX_FALLOW_ALL);
+                break;
+            }
+        }
+
+        /* Skip rules none of whose indexed inputs have been set; such
+         * rules cannot match (see build_target_source_index()).  The
+         * packed dispatch record keeps this decision off the rule
+         * object's cache lines; rules without a record (injected, or
+         * contexts not yet closed) use the rule's own metadata. */
+        if (ctx->rules->dispatch != NULL &&
+            rule->meta.index < ctx->rules->n_dispatch)
+        {
+            const ib_rule_dispatch_t *d =
+                &ctx->rules->dispatch[rule->meta.index];
+
+            if (d->src_count > 0) {
+                bool present = false;
+
+                for (uint16_t s = 0; s < d->src_count; ++s) {
+                    if (ib_var_source_maybe_set(
+                            (ib_var_source_t *)ctx->rules->
+                                dispatch_sources[d->src_start + s],
+                            tx->var_store))
+                    {
+                        present = true;
+                        break;
+                    }
+                }
+                if (! present) {
+                    continue;
+                }
+            }
+        }
+        else if (ib_flags_all(rule->flags, IB_RULE_FLAG_INDEXED) &&
+                 ! rule_inputs_present(rule, tx->var_store))
+        {
+            continue;
+        }
+
+        /* Execute the rule, it's actions and chains */
+        rule_rc = execute_phase_rule(rule_exec, rule, MAX_CHAIN_RECURSION);
+
+        /* A deferring operator parks the phase here; the server resumes
+         * from this rule via ib_rule_exec_resume().  End-of-phase
+         * bookkeeping waits for the resume. */
+        if (rule_rc == IB_DEFER) {
+            rule_exec->defer_node  = node;
+            rule_exec->defer_phase = meta->phase_num;
+            rule_exec->defer_state = state;
+            ib_rule_log_debug(rule_exec,
+                              "Phase %d/\"%s\" deferred at rule \"%s\"",
+                              meta->phase_num, phase_name(meta),
+                              ib_rule_id(rule));
+            return IB_DEFER;
+        }
+
+        /* Handle block/allow actions. */
+        if (ib_flags_all(tx->flags, IB_TX_FALLOW_ALL) ) {
+            bool allow_rc;
+            ib_rule_log_debug(rule_exec,
+                              "Rule resulted in allow "
+                              "(aborting rule processing): %s",
+                              ib_status_to_string(rule_rc));
+            allow_rc = ib_tx_allow(rule_exec->tx);
+            if (allow_rc != IB_OK && allow_rc != IB_DECLINED) {
+                ib_rule_log_error(rule_exec, "Failed to allow: %s",
+                                  ib_status_to_string(allow_rc));
+                if (rule_rc == IB_OK) {
+                    rule_rc = allow_rc;
+                }
+            }
+            else {
+                if (allow_rc == IB_DECLINED) {
+                    ib_rule_log_info(rule_exec, "Declined to allow.");
+                }
+                goto finish;
+            }
+        }
+        else if (ib_flags_all(tx->flags, IB_TX_FBLOCK_IMMEDIATE) ) {
+            bool block_rc;
+            ib_rule_log_debug(rule_exec,
+                              "Rule resulted in immediate block "
+                              "(aborting rule processing): %s",
+                              ib_status_to_string(rule_rc));
+            block_rc = ib_tx_block(rule_exec->tx);
+            if (block_rc != IB_OK && block_rc != IB_DECLINED) {
+                ib_rule_log_error(rule_exec, "Failed to block: %s",
+                                  ib_status_to_string(block_rc));
+                if (rule_rc == IB_OK) {
+                    rule_rc = block_rc;
+                }
+            }
+            else {
+                if (block_rc == IB_DECLINED) {
+                    ib_rule_log_info(rule_exec, "Declined to block.");
+                }
+                goto finish;
+            }
+        }
+        else if (ib_flags_any(tx->flags, IB_TX_FALLOW_PHASE | IB_TX_FALLOW_REQUEST) ) {
+            ib_rule_log_debug(rule_exec,
+                              "Rule resulted in temporary allow "
+                              "(aborting rule processing for this phase): %s",
+                              ib_status_to_string(rule_rc));
+            break;
+        }
+
+        if ( (rc == IB_OK) && (rule_rc != IB_OK) ) {
+            rc = rule_rc;
+        }
+    }
+
+    if (ib_flags_all(tx->flags, IB_TX_FBLOCK_PHASE) ) {
+        ib_rule_log_tx_debug(tx, "Rule(s) resulted in phase block");
+        rc = ib_tx_block(rule_exec->tx);
+        if (rc == IB_DECLINED) {
+            ib_rule_log_info(rule_exec, "Declined to block.");
+            rc = IB_OK;
+        }
+        else if (rc != IB_OK) {
+            ib_rule_log_tx_error(tx,
+                                 "Failed to block phase: %s",
+                                 ib_status_to_string(rc));
+        }
+    }
+
+    /* Log the end of the tx event */
+finish:
+    IB_PROBE_PHASE_FINISH(tx, meta->phase_num);
+    ib_rule_log_tx_event_end(rule_exec, state);
+
+    /* Clear the phase allow flag. */
+    ib_flags_clear(tx->flags, IB_TX_FALLOW_PHASE);
+
+    /*
+     * @todo Eat errors for now.  Unless something Really Bad(TM) has
+     * occurred, return IB_OK to the engine.  A bigger discussion of if / how
+     * such errors should be propagated needs to occur.
+     */
+    return rc;
+}
+
+/**
+ * Run a set of phase rules.
+ *
+ * @param[in] ib Engine.
+ * @param[in,out] tx Transaction.
+ * @param[in] state State.
+ * @param[in] cbdata Callback data (actually phase_rule_cbdata_t).
+ *
+ * @returns
+ *   - IB_OK on success.
+ *   - IB_DECLINED if the httpd plugin declines to block the traffic.
+ */
+static ib_status_t run_phase_rules(ib_engine_t *ib,
+                                   ib_tx_t *tx,
+                                   ib_state_t state,
+                                   void *cbdata)
+{
+    assert(ib != NULL);
+    assert(tx != NULL);
+    assert(tx->ctx != NULL);
+    assert(cbdata != NULL);
+
+    /* If this is an empty request, ignore the transaction */
+    if (! ib_flags_any(tx->flags, IB_TX_FREQ_HAS_DATA | IB_TX_FRES_HAS_DATA)) {
+        return IB_OK;
+    }
 
     /* The rule execution object isn't created if tx_started never notified.
      * This can happen if a connection is created to ATS, but no data
@@ -2326,6 +3052,16 @@ static ib_status_t run_phase_rules(ib_engine_t *ib,
     rules = ruleset_phase->rule_list;
     assert(rules != NULL);
 
+    /* A parked phase must be resumed before any further state may be
+     * processed; see ib_rule_exec_resume(). */
+    if (rule_exec->defer_node != NULL) {
+        ib_log_error_tx(tx,
+                        "Rule engine: %s notified while phase %d is "
+                        "parked on a deferred operator.",
+                        ib_state_name(state), rule_exec->defer_phase);
+        return IB_EINVAL;
+    }
+
     /* Log the transaction event start */
     ib_rule_log_tx_event_start(rule_exec, state);
     ib_rule_log_phase(rule_exec,
@@ -2379,6 +3115,8 @@ static ib_status_t run_phase_rules(ib_engine_t *ib,
     rule_exec->phase = meta->phase_num;
     rule_exec->is_stream = false;
     ib_list_clear(rule_exec->phase_rules);
+    rule_exec->phase_rules_for = IB_PHASE_NONE;
+    IB_PROBE_PHASE_START(tx, meta->phase_num);
 
     /* Invoke all of the rule injectors */
     rc = inject_rules(ib, meta, rule_exec);
@@ -2387,7 +3125,7 @@ static ib_status_t run_phase_rules(ib_engine_t *ib,
     }
 
     /* Add all of the enabled "normal" rules to the list */
-    rc = append_context_rules(ib, meta, rules, rule_exec);
+    rc = append_context_rules(ib, meta, ruleset_phase, rule_exec);
     if (rc != IB_OK) {
         return IB_EINVAL;
     }
@@ -2408,103 +3146,14 @@ static ib_status_t run_phase_rules(ib_engine_t *ib,
                          meta->phase_num, phase_name(meta),
                          ib_context_full_get(ctx));
 
-    /*
-     * Loop through all of the rules for this phase, execute them.
-     *
-     * @todo The current behavior is to keep running even after rule execution
-     * returns an error.  This needs further discussion to determine what the
-     * correct behavior should be.
-     */
-    IB_LIST_LOOP_CONST(rule_exec->phase_rules, node) {
-        const ib_rule_t *rule =
-            (const ib_rule_t *)ib_list_node_data_const(node);
-        ib_status_t      rule_rc;
-
-        assert(
-            rule->meta.phase == meta->phase_num ||
-            rule->meta.phase == IB_PHASE_NONE
-        );
-
-        /* Allow (skip) this phase? */
-        if (rule_allow(tx, meta, true)) {
-            break;
-        }
-
-        /* Execute the rule, it's actions and chains */
-        rule_rc = execute_phase_rule(rule_exec, rule, MAX_CHAIN_RECURSION);
-
-        /* Handle block/allow actions. */
-        if (ib_flags_all(tx->flags, IB_TX_FALLOW_ALL) ) {
-            bool allow_rc;
-            ib_rule_log_debug(rule_exec,
-                              "Rule resulted in allow "
-                              "(aborting rule processing): %s",
-                              ib_status_to_string(rule_rc));
-            allow_rc = ib_tx_allow(rule_exec->tx);
-            if (allow_rc != IB_OK && allow_rc != IB_DECLINED) {
-                ib_rule_log_error(rule_exec, "Failed to allow: %s",
-                                  ib_status_to_string(allow_rc));
-                if (rule_rc == IB_OK) {
-                    rule_rc = allow_rc;
-                }
-            }
-            else {
-                if (allow_rc == IB_DECLINED) {
-                    ib_rule_log_info(rule_exec, "Declined to allow.");
-                }
-                goto finish;
-            }
-        }
-        else if (ib_flags_all(tx->flags, IB_TX_FBLOCK_IMMEDIATE) ) {
-            bool block_rc;
-            ib_rule_log_debug(rule_exec,
-                              "Rule resulted in immediate block "
-                              "(aborting rule processing): %s",
-                              ib_status_to_string(rule_rc));
-            block_rc = ib_tx_block(rule_exec->tx);
-            if (block_rc != IB_OK && block_rc != IB_DECLINED) {
-                ib_rule_log_error(rule_exec, "Failed to block: %s",
-                                  ib_status_to_string(block_rc));
-                if (rule_rc == IB_OK) {
-                    rule_rc = block_rc;
-                }
-            }
-            else {
-                if (block_rc == IB_DECLINED) {
-                    ib_rule_log_info(rule_exec, "Declined to block.");
-                }
-                goto finish;
-            }
-        }
-        else if (ib_flags_any(tx->flags, IB_TX_FALLOW_PHASE | IB_TX_FALLOW_REQUEST) ) {
-            ib_rule_log_debug(rule_exec,
-                              "Rule resulted in temporary allow "
-                              "(aborting rule processing for this phase): %s",
-                              ib_status_to_string(rule_rc));
-            break;
-        }
-
-        if ( (rc == IB_OK) && (rule_rc != IB_OK) ) {
-            rc = rule_rc;
-        }
-    }
-
-    if (ib_flags_all(tx->flags, IB_TX_FBLOCK_PHASE) ) {
-        ib_rule_log_tx_debug(tx, "Rule(s) resulted in phase block");
-        rc = ib_tx_block(rule_exec->tx);
-        if (rc == IB_DECLINED) {
-            ib_rule_log_info(rule_exec, "Declined to block.");
-            rc = IB_OK;
-        }
-        else if (rc != IB_OK) {
-            ib_rule_log_tx_error(tx,
-                                 "Failed to block phase: %s",
-                                 ib_status_to_string(rc));
-        }
-    }
+    /* Execute the phase's rules; end-of-phase bookkeeping is done
+     * there (or, when an operator defers, at resume). */
+    rc = execute_phase_rule_list(ib, tx, state, meta, NULL);
+    return rc;
 
     /* Log the end of the tx event */
 finish:
+    IB_PROBE_PHASE_FINISH(tx, meta->phase_num);
     ib_rule_log_tx_event_end(rule_exec, state);
 
     /* Clear the phase allow flag. */
@@ -2759,6 +3408,17 @@ static ib_status_t run_stream_rules(ib_engine_t *ib,
     ib_rule_exec_t           *rule_exec = tx->rule_exec;
     ib_status_t               rc;
 
+    /* A parked phase shares the execution object (and its rule list);
+     * the server must resume it before notifying more data.  See
+     * ib_rule_exec_resume(). */
+    if (rule_exec->defer_node != NULL) {
+        ib_log_error_tx(tx,
+                        "Rule engine: %s notified while phase %d is "
+                        "parked on a deferred operator.",
+                        ib_state_name(state), rule_exec->defer_phase);
+        return IB_EINVAL;
+    }
+
     /* Log the transaction event start */
     ib_rule_log_tx_event_start(rule_exec, state);
     ib_rule_log_phase(rule_exec,
@@ -2770,6 +3430,27 @@ static ib_status_t run_stream_rules(ib_engine_t *ib,
         return IB_OK;
     }
 
+    /* Once the transaction is blocked, stream data keeps arriving (the
+     * server may still be draining the body), but running stream rules
+     * on it is pure waste: the decision is made.  Skip the phase, as
+     * the phase rule runner does; postprocess and logging are phase
+     * (not stream) rules and are unaffected. */
+    if (ib_flags_any(tx->flags, IB_TX_FBLOCK_PHASE | IB_TX_FBLOCK_IMMEDIATE)) {
+        rc = ib_tx_block(rule_exec->tx);
+        if (rc != IB_OK && rc != IB_DECLINED) {
+            ib_rule_log_error(rule_exec, "Failed to block: %s",
+                              ib_status_to_string(rc));
+        }
+        else {
+            ib_log_debug_tx(tx,
+                            "Not executing rules for stream %d/\"%s\" "
+                            "in context \"%s\": transaction was blocked.",
+                            meta->phase_num, phase_name(meta),
+                            ib_context_full_get(ctx));
+            return IB_OK;
+        }
+    }
+
     /* Sanity check */
     if (ruleset_phase->phase_num != meta->phase_num) {
         ib_rule_log_error(rule_exec,
@@ -2782,18 +3463,30 @@ static ib_status_t run_stream_rules(ib_engine_t *ib,
     /* Setup for rule execution */
     rule_exec->phase = meta->phase_num;
     rule_exec->is_stream = true;
-    ib_list_clear(rule_exec->phase_rules);
 
-    /* Invoke all of the rule injectors */
-    rc = inject_rules(ib, meta, rule_exec);
-    if (rc != IB_OK) {
-        return IB_EINVAL;
-    }
+    /* Body stream phases run once per data chunk.  When no injector is
+     * registered for the phase, the rule list cannot change between
+     * chunks, so reuse the one built for the previous chunk. */
+    if (rule_exec->phase_rules_for != meta->phase_num) {
+        bool reusable = (ib_list_elements(
+            ib->rule_engine->injection_cbs[meta->phase_num]) == 0);
 
-    /* Add all of the enabled "normal" rules to the list */
-    rc = append_context_rules(ib, meta, rules, rule_exec);
-    if (rc != IB_OK) {
-        return IB_EINVAL;
+        ib_list_clear(rule_exec->phase_rules);
+
+        /* Invoke all of the rule injectors */
+        rc = inject_rules(ib, meta, rule_exec);
+        if (rc != IB_OK) {
+            return IB_EINVAL;
+        }
+
+        /* Add all of the enabled "normal" rules to the list */
+        rc = append_context_rules(ib, meta, ruleset_phase, rule_exec);
+        if (rc != IB_OK) {
+            return IB_EINVAL;
+        }
+
+        rule_exec->phase_rules_for =
+            reusable ? meta->phase_num : IB_PHASE_NONE;
     }
 
     /* Are there any rules?  If not, do a quick exit */
@@ -3102,6 +3795,10 @@ static ib_status_t init_ruleset(ib_engine_t *ib,
                          ib_status_to_string(rc));
             return rc;
         }
+
+        /* Populated when the context closes. */
+        ruleset_phase->runnable = NULL;
+        ruleset_phase->n_runnable = 0;
     }
 
     /* Create a hash to hold rules indexed by ID */
@@ -3269,6 +3966,15 @@ static ib_status_t create_rule_engine(const ib_engine_t *ib,
         return rc;
     }
 
+    /* Create the execution profiler (disabled until requested). */
+    rc = ib_rule_profiler_create(&(rule_engine->profiler), mm);
+    if (rc != IB_OK) {
+        ib_log_error(ib,
+                     "Error creating rule engine profiler: %s",
+                     ib_status_to_string(rc));
+        return rc;
+    }
+
     /* Create the injection cb lists */
     for (phase = IB_PHASE_NONE; phase < IB_RULE_PHASE_COUNT; ++phase) {
         rc = ib_list_create(&(rule_engine->injection_cbs[phase]), mm);
@@ -3712,6 +4418,178 @@ bool ib_rule_is_marked(const ib_rule_t *rule) {
     return ib_flags_any(rule->flags, IB_RULE_FLAG_MARK);
 }
 
+/**
+ * Build the target var-source dispatch index for a rule.
+ *
+ * This, together with compile_rule_program(), is the compiled per-rule
+ * target projection.  A context-level projection going further -- a set
+ * of all sources any enabled rule reads, so var generation could skip
+ * unused fields -- has been considered and is unsound as stated: rules
+ * also read sources through target expansions, action parameters
+ * (setvar values), and module code, none of which are enumerable from
+ * the target lists, and a missed read would silently disable
+ * inspection of that field.
+ *
+ * Examines the targets of @a rule.  The backing var sources are recorded
+ * in the rule and IB_RULE_FLAG_INDEXED is set, allowing phase dispatch to
+ * skip the rule in transactions where none of its inputs have been set:
+ * indexed sources are checked exactly, unindexed ones against the var
+ * store's existence bloom filter (ib_var_source_maybe_set()).  Rules whose
+ * operators are inverted or accept NULL input, and rules with false
+ * actions, can fire on absent inputs and are left on the slow path.
+ *
+ * The index depends only on the rule's target list, so it is built once per
+ * rule no matter how many contexts the rule is enabled in.
+ *
+ * @param[in] ib IronBee engine
+ * @param[in,out] rule Rule to index
+ *
+ * @returns Status code
+ */
+static ib_status_t build_target_source_index(ib_engine_t *ib,
+                                             ib_rule_t *rule)
+{
+    assert(ib != NULL);
+    assert(rule != NULL);
+
+    const ib_list_node_t *node;
+    ib_list_t            *sources;
+    ib_status_t           rc;
+
+    /* Already built (the rule is enabled in an outer context). */
+    if (rule->indexed_sources != NULL) {
+        return IB_OK;
+    }
+
+    /* Inverted operators, operators accepting NULL input, and false
+     * actions can fire on absent inputs. */
+    if ( (rule->opinst != NULL) && rule->opinst->invert ) {
+        return IB_OK;
+    }
+    if ( (rule->opinst != NULL) &&
+         ib_flags_all(
+             ib_operator_capabilities(
+                 ib_operator_inst_operator(rule->opinst->opinst)),
+             IB_OP_CAPABILITY_ALLOW_NULL) )
+    {
+        return IB_OK;
+    }
+    if ( (rule->false_actions != NULL) &&
+         (ib_list_elements(rule->false_actions) != 0) )
+    {
+        return IB_OK;
+    }
+    if ( (rule->target_fields == NULL) ||
+         (ib_list_elements(rule->target_fields) == 0) )
+    {
+        return IB_OK;
+    }
+
+    rc = ib_list_create(&sources, ib_engine_mm_main_get(ib));
+    if (rc != IB_OK) {
+        return rc;
+    }
+
+    IB_LIST_LOOP_CONST(rule->target_fields, node) {
+        ib_rule_target_t *target =
+            (ib_rule_target_t *)ib_list_node_data_const(node);
+        ib_var_source_t  *source;
+
+        if (target->target == NULL) {
+            return IB_OK;
+        }
+        source = ib_var_target_source(target->target);
+        rc = ib_list_push(sources, source);
+        if (rc != IB_OK) {
+            return rc;
+        }
+    }
+
+    rule->indexed_sources = sources;
+    ib_flags_set(rule->flags, IB_RULE_FLAG_INDEXED);
+
+    return IB_OK;
+}
+
+/**
+ * Compile a rule's target and transformation chains into flat arrays.
+ *
+ * Flattens the rule's target list and each target's transformation list
+ * into contiguous arrays so that phase execution walks arrays instead of
+ * chasing @ref ib_list_t nodes.  The arrays alias the instances owned by
+ * the lists; the lists remain authoritative at configuration time.
+ *
+ * Like build_target_source_index(), this depends only on the rule's
+ * target list and is built once per rule no matter how many contexts the
+ * rule is enabled in.
+ *
+ * @param[in] ib IronBee engine
+ * @param[in,out] rule Rule to compile
+ *
+ * @returns Status code
+ */
+static ib_status_t compile_rule_program(ib_engine_t *ib,
+                                        ib_rule_t *rule)
+{
+    assert(ib != NULL);
+    assert(rule != NULL);
+
+    const ib_list_node_t  *node;
+    ib_rule_target_t     **targets;
+    ib_mm_t                mm = ib_engine_mm_main_get(ib);
+    size_t                 n;
+    size_t                 i = 0;
+
+    /* Already compiled (the rule is enabled in an outer context). */
+    if (rule->target_array != NULL) {
+        return IB_OK;
+    }
+
+    n = ib_list_elements(rule->target_fields);
+    if (n == 0) {
+        return IB_OK;
+    }
+
+    targets = ib_mm_alloc(mm, n * sizeof(*targets));
+    if (targets == NULL) {
+        return IB_EALLOC;
+    }
+
+    IB_LIST_LOOP_CONST(rule->target_fields, node) {
+        ib_rule_target_t *target =
+            (ib_rule_target_t *)ib_list_node_data_const(node);
+        size_t            n_tfns = ib_list_elements(target->tfn_list);
+
+        targets[i++] = target;
+
+        if ( (n_tfns == 0) || (target->tfn_array != NULL) ) {
+            target->n_tfns = n_tfns;
+            continue;
+        }
+
+        const ib_transformation_inst_t **tfns =
+            ib_mm_alloc(mm, n_tfns * sizeof(*tfns));
+        if (tfns == NULL) {
+            return IB_EALLOC;
+        }
+
+        size_t                j = 0;
+        const ib_list_node_t *tfn_node;
+        IB_LIST_LOOP_CONST(target->tfn_list, tfn_node) {
+            tfns[j++] = (const ib_transformation_inst_t *)
+                ib_list_node_data_const(tfn_node);
+        }
+
+        target->tfn_array = tfns;
+        target->n_tfns    = n_tfns;
+    }
+
+    rule->target_array = targets;
+    rule->n_targets    = n;
+
+    return IB_OK;
+}
+
 /**
  * Close a context for the rule engine.
  *
@@ -3922,6 +4800,39 @@ static ib_status_t rule_engine_ctx_close(ib_engine_t *ib,
         assert(ruleset_phase->phase_meta == rule->phase_meta);
         phase_rule_list = ruleset_phase->rule_list;
 
+        /* Build the dispatch index so phase execution can skip the rule
+         * when none of its inputs are present in a transaction. */
+        rc = build_target_source_index(ib, rule);
+        if (rc != IB_OK) {
+            ib_log_error(ib,
+                         "Error indexing rule targets \"%s\" context=\"%s\": %s",
+                         ib_rule_id(rule),
+                         ib_context_full_get(ctx),
+                         ib_status_to_string(rc));
+            return rc;
+        }
+
+        /* Flatten the target/transformation chains of the rule and any
+         * rules chained from it for execution. */
+        {
+            ib_rule_t *chain_rule;
+            for (chain_rule = rule;
+                 chain_rule != NULL;
+                 chain_rule = chain_rule->chained_rule)
+            {
+                rc = compile_rule_program(ib, chain_rule);
+                if (rc != IB_OK) {
+                    ib_log_error(ib,
+                                 "Error compiling rule \"%s\" "
+                                 "context=\"%s\": %s",
+                                 ib_rule_id(chain_rule),
+                                 ib_context_full_get(ctx),
+                                 ib_status_to_string(rc));
+                    return rc;
+                }
+            }
+        }
+
         /* Add it to the list */
         rc = ib_list_push(phase_rule_list, (void *)ctx_rule);
         if (rc != IB_OK) {
@@ -3944,6 +4855,111 @@ static ib_status_t rule_engine_ctx_close(ib_engine_t *ib,
                      ib_context_full_get(ctx));
     }
 
+    /* Step 6: Partition each phase into its dense runnable array.
+     * Context rule flags are fixed from here on, so the per-rule
+     * enable/valid tests are decided now instead of per transaction. */
+    for (ib_rule_phase_num_t phase_num = IB_PHASE_NONE;
+         phase_num < IB_RULE_PHASE_COUNT;
+         ++phase_num)
+    {
+        ib_ruleset_phase_t   *ruleset_phase =
+            &(ctx->rules->ruleset.phases[phase_num]);
+        const ib_list_node_t *rnode;
+        size_t                n = 0;
+
+        IB_LIST_LOOP_CONST(ruleset_phase->rule_list, rnode) {
+            const ib_rule_ctx_data_t *ctx_rule =
+                (const ib_rule_ctx_data_t *)ib_list_node_data_const(rnode);
+            if (rule_is_runnable(ctx_rule)) {
+                ++n;
+            }
+        }
+
+        ruleset_phase->runnable = NULL;
+        ruleset_phase->n_runnable = 0;
+        if (n == 0) {
+            continue;
+        }
+
+        ruleset_phase->runnable =
+            ib_mm_alloc(ctx->mm, n * sizeof(*(ruleset_phase->runnable)));
+        if (ruleset_phase->runnable == NULL) {
+            return IB_EALLOC;
+        }
+
+        IB_LIST_LOOP_CONST(ruleset_phase->rule_list, rnode) {
+            const ib_rule_ctx_data_t *ctx_rule =
+                (const ib_rule_ctx_data_t *)ib_list_node_data_const(rnode);
+            if (rule_is_runnable(ctx_rule)) {
+                ruleset_phase->runnable[ruleset_phase->n_runnable] =
+                    ctx_rule->rule;
+                ++(ruleset_phase->n_runnable);
+            }
+        }
+        assert(ruleset_phase->n_runnable == n);
+    }
+
+    /* Step 7: Pack the dispatch records: per-rule input-source ranges
+     * into one shared array, so the per-transaction skip decision
+     * reads 8 bytes and a source range instead of the rule's flag
+     * word and source list nodes. */
+    {
+        size_t   n_rules = ib->rule_engine->index_limit;
+        size_t   n_sources = 0;
+        size_t   src_off = 0;
+        ib_rule_dispatch_t     *dispatch;
+        const ib_var_source_t **sources;
+        const ib_list_node_t   *dnode;
+
+        IB_LIST_LOOP(all_rules, node) {
+            const ib_rule_ctx_data_t *ctx_rule =
+                (const ib_rule_ctx_data_t *)ib_list_node_data(node);
+
+            if (ib_flags_all(ctx_rule->rule->flags, IB_RULE_FLAG_INDEXED) &&
+                ctx_rule->rule->indexed_sources != NULL)
+            {
+                n_sources +=
+                    ib_list_elements(ctx_rule->rule->indexed_sources);
+            }
+        }
+
+        dispatch = ib_mm_calloc(ctx->mm, n_rules, sizeof(*dispatch));
+        sources = (n_sources > 0)
+            ? ib_mm_alloc(ctx->mm, n_sources * sizeof(*sources))
+            : NULL;
+        if (dispatch == NULL || (n_sources > 0 && sources == NULL)) {
+            return IB_EALLOC;
+        }
+
+        IB_LIST_LOOP(all_rules, node) {
+            const ib_rule_ctx_data_t *ctx_rule =
+                (const ib_rule_ctx_data_t *)ib_list_node_data(node);
+            const ib_rule_t *rule = ctx_rule->rule;
+
+            if (rule->meta.index >= n_rules) {
+                continue;
+            }
+            if (! ib_flags_all(rule->flags, IB_RULE_FLAG_INDEXED) ||
+                rule->indexed_sources == NULL)
+            {
+                continue;
+            }
+
+            dispatch[rule->meta.index].src_start = (uint32_t)src_off;
+            IB_LIST_LOOP_CONST(rule->indexed_sources, dnode) {
+                sources[src_off] =
+                    (const ib_var_source_t *)ib_list_node_data_const(dnode);
+                ++src_off;
+            }
+            dispatch[rule->meta.index].src_count = (uint16_t)(
+                src_off - dispatch[rule->meta.index].src_start);
+        }
+
+        ctx->rules->dispatch = dispatch;
+        ctx->rules->n_dispatch = n_rules;
+        ctx->rules->dispatch_sources = sources;
+    }
+
     /* Initialize var sources */
     {
         ib_rule_engine_t *re = ib->rule_engine;
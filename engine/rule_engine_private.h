@@ -29,6 +29,8 @@
 
 #include <ironbee/clock.h>
 #include <ironbee/rule_engine.h>
+#include <ironbee/rule_profiler.h>
+#include <ironbee/transformation.h>
 #include <ironbee/types.h>
 
 /**
@@ -43,11 +45,19 @@ typedef struct {
 /**
  * Ruleset for a single phase.
  *  rule_list is a list of pointers to ib_rule_ctx_data_t objects.
+ *
+ * The runnable array is the phase's execution partition, computed when
+ * the context closes: context rule flags are fixed from then on, so the
+ * per-rule enable/valid tests are decided once here and transactions
+ * iterate a dense array with no flag branches.
  */
 typedef struct {
     ib_rule_phase_num_t         phase_num;   /**< Phase number */
     const ib_rule_phase_meta_t *phase_meta;  /**< Rule phase meta-data */
     ib_list_t                  *rule_list;   /**< Rules to execute in phase */
+    ib_rule_t                 **runnable;    /**< Rules passing the context
+                                                  enable/valid checks */
+    size_t                      n_runnable;  /**< Length of runnable */
 } ib_ruleset_phase_t;
 
 /**
@@ -58,6 +68,22 @@ typedef struct {
     ib_ruleset_phase_t phases[IB_RULE_PHASE_COUNT];
 } ib_ruleset_t;
 
+/**
+ * Packed per-rule dispatch record; the phase loop's hot data.
+ *
+ * Indexed by rule index.  The input-presence skip -- the decision made
+ * for every rule of every phase of every transaction -- reads this
+ * record and the shared source array instead of chasing the rule's
+ * flag word and source list nodes across the rule object's cache
+ * lines; cold metadata (ids, messages) stays in @ref ib_rule_t and is
+ * only touched by rules that actually execute.
+ */
+typedef struct {
+    uint32_t src_start; /**< First entry in dispatch_sources. */
+    uint16_t src_count; /**< Sources to check; 0 = always run. */
+    uint16_t unused;    /**< Padding. */
+} ib_rule_dispatch_t;
+
 /**
  * Rules data for each context.
  */
@@ -67,6 +93,17 @@ struct ib_rule_context_t {
     ib_hash_t             *rule_hash;    /**< Hash of rules (by rule-id) */
     ib_list_t             *enable_list;  /**< Enable All/IDs/tags */
     ib_rule_parser_data_t  parser_data;  /**< Rule parser specific data */
+
+    /**
+     * Dispatch records, indexed by rule index; see
+     * @ref ib_rule_dispatch_t.  Built at context close; NULL until
+     * then (the flag/list fallback is used).
+     */
+    ib_rule_dispatch_t     *dispatch;
+    size_t                  n_dispatch;  /**< Records in dispatch. */
+
+    /** Shared source array the dispatch records index into. */
+    const ib_var_source_t **dispatch_sources;
 };
 
 /**
@@ -76,6 +113,17 @@ struct ib_rule_target_t {
     ib_var_target_t *target;
     const char      *target_str; /**< The target string */
     ib_list_t       *tfn_list;   /**< List of transformations */
+
+    /**
+     * Flattened transformation chain.
+     *
+     * Built from tfn_list by compile_rule_program() at context close so
+     * that execution walks a contiguous array instead of chasing list
+     * nodes.  NULL until the rule is compiled; tfn_list remains
+     * authoritative at configuration time.
+     */
+    const ib_transformation_inst_t **tfn_array;
+    size_t                           n_tfns; /**< Elements in tfn_array */
 };
 
 
@@ -103,6 +151,15 @@ struct ib_rule_engine_t {
         ib_var_source_t *field_name_full;
     } source;
 
+    /**
+     * Rule execution profiler.
+     *
+     * Always created with the rule engine; accumulation is off until
+     * enabled at runtime (typically via the engine manager control
+     * channel).
+     */
+    ib_rule_profiler_t *profiler;
+
     /* Hooks */
     struct {
         ib_list_t *pre_rule;
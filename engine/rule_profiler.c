@@ -0,0 +1,536 @@
+/*****************************************************************************
+ * Licensed to Qualys, Inc. (QUALYS) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * QUALYS licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+/**
+ * @file
+ * @brief IronBee --- Rule Execution Profiler
+ *
+ * @author Nick LeRoy <nleroy@qualys.com>
+ */
+
+#include "ironbee_config_auto.h"
+
+#include <ironbee/rule_profiler.h>
+
+#include "engine_private.h"
+#include "rule_engine_private.h"
+
+#include <ironbee/clock.h>
+#include <ironbee/context.h>
+#include <ironbee/mm.h>
+#include <ironbee/string.h>
+
+#include <assert.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Accumulated counts for a single rule.
+ *
+ * Updated with atomic additions by worker threads; torn reads while a
+ * report is rendered are acceptable for profiling purposes.
+ */
+typedef struct {
+    const ib_rule_t *rule;    /**< Rule this slot belongs to. */
+    uint64_t         ticks;   /**< Accumulated execution ticks. */
+    uint64_t         n;       /**< Number of invocations. */
+    uint64_t         matched; /**< Invocations whose rule matched. */
+} ib_rule_profiler_slot_t;
+
+/** Entries per context in the heavy-hitter sketch. */
+#define RULE_PROFILER_TOPK 16
+
+/** Contexts tracked; beyond this, extra contexts are not sketched. */
+#define RULE_PROFILER_MAX_CTX 64
+
+/** One heavy hitter. */
+typedef struct {
+    const ib_rule_t *rule;    /**< The rule. */
+    uint64_t         ticks;   /**< Estimated ticks (space-saving). */
+    uint64_t         count;   /**< Executions since occupying the slot. */
+    uint64_t         matched; /**< Matches since occupying the slot. */
+} ib_rule_profiler_topk_t;
+
+/**
+ * Per-context heavy-hitter sketch.
+ *
+ * A space-saving sketch over execution ticks: a hit adds to its slot
+ * with atomic additions (the ~tens-of-ns hot path), and a rule not in
+ * the sketch evicts the cheapest slot under the profiler's sketch
+ * lock, inheriting its tick estimate -- the standard overestimate
+ * that keeps true heavy hitters in the table.  Multi-tenant
+ * deployments read per-site attributions from these, including for
+ * main-context rules whose global numbers blend every site's traffic.
+ */
+typedef struct {
+    const ib_context_t      *ctx;                        /**< Site. */
+    ib_rule_profiler_topk_t  slots[RULE_PROFILER_TOPK];  /**< Hitters. */
+} ib_rule_profiler_sketch_t;
+
+/**
+ * Rule profiler.
+ */
+struct ib_rule_profiler_t {
+    ib_mm_t                  mm;      /**< Memory manager for the slots. */
+    ib_rule_profiler_slot_t *slots;   /**< Slot per rule index; lazy. */
+    size_t                   n_slots; /**< Number of slots. */
+    bool                     enabled; /**< Accumulate samples? */
+
+    /** Per-context sketches; entries appended as contexts are seen. */
+    ib_rule_profiler_sketch_t sketches[RULE_PROFILER_MAX_CTX];
+    size_t                    n_sketches; /**< Sketches in use. */
+    pthread_mutex_t           sketch_lock; /**< Guards creation/eviction. */
+};
+
+uint64_t ib_rule_profiler_ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    uint32_t lo;
+    uint32_t hi;
+    __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+    return ((uint64_t)hi << 32) | lo;
+#else
+    return (uint64_t)ib_clock_precise_get_time();
+#endif
+}
+
+ib_status_t ib_rule_profiler_create(
+    ib_rule_profiler_t **profiler,
+    ib_mm_t              mm
+)
+{
+    assert(profiler != NULL);
+
+    ib_rule_profiler_t *prof;
+
+    prof = (ib_rule_profiler_t *)ib_mm_calloc(mm, 1, sizeof(*prof));
+    if (prof == NULL) {
+        return IB_EALLOC;
+    }
+
+    prof->mm = mm;
+    if (pthread_mutex_init(&prof->sketch_lock, NULL) != 0) {
+        return IB_EALLOC;
+    }
+
+    *profiler = prof;
+    return IB_OK;
+}
+
+bool ib_rule_profiler_is_enabled(
+    const ib_rule_profiler_t *profiler
+)
+{
+    assert(profiler != NULL);
+
+    return profiler->enabled;
+}
+
+/**
+ * Update @a ctx's heavy-hitter sketch with one execution of @a rule.
+ */
+static void sketch_record(
+    ib_rule_profiler_t *profiler,
+    const ib_context_t *ctx,
+    const ib_rule_t    *rule,
+    uint64_t            ticks,
+    bool                matched
+)
+{
+    ib_rule_profiler_sketch_t *sketch = NULL;
+
+    /* Find the context's sketch; the array only grows, so a racing
+     * reader sees either the entry or a miss. */
+    for (size_t i = 0; i < profiler->n_sketches; ++i) {
+        if (profiler->sketches[i].ctx == ctx) {
+            sketch = &profiler->sketches[i];
+            break;
+        }
+    }
+    if (sketch == NULL) {
+        pthread_mutex_lock(&profiler->sketch_lock);
+        for (size_t i = 0; i < profiler->n_sketches; ++i) {
+            if (profiler->sketches[i].ctx == ctx) {
+                sketch = &profiler->sketches[i];
+                break;
+            }
+        }
+        if (sketch == NULL && profiler->n_sketches < RULE_PROFILER_MAX_CTX) {
+            sketch = &profiler->sketches[profiler->n_sketches];
+            sketch->ctx = ctx;
+            __sync_synchronize();
+            ++profiler->n_sketches;
+        }
+        pthread_mutex_unlock(&profiler->sketch_lock);
+        if (sketch == NULL) {
+            return;  /* Context table full; not sketched. */
+        }
+    }
+
+    /* Hit: atomic additions, the hot path. */
+    for (size_t i = 0; i < RULE_PROFILER_TOPK; ++i) {
+        if (sketch->slots[i].rule == rule) {
+            __sync_fetch_and_add(&sketch->slots[i].ticks, ticks);
+            __sync_fetch_and_add(&sketch->slots[i].count, 1);
+            if (matched) {
+                __sync_fetch_and_add(&sketch->slots[i].matched, 1);
+            }
+            return;
+        }
+    }
+
+    /* Miss: occupy an empty slot or evict the cheapest (space-saving:
+     * the newcomer inherits the evicted estimate, overestimating so
+     * true heavy hitters cannot be displaced by noise). */
+    pthread_mutex_lock(&profiler->sketch_lock);
+    {
+        size_t   min_i = 0;
+        uint64_t min_ticks = UINT64_MAX;
+
+        for (size_t i = 0; i < RULE_PROFILER_TOPK; ++i) {
+            if (sketch->slots[i].rule == rule) {
+                /* Raced another evictor; fall through to a plain add. */
+                __sync_fetch_and_add(&sketch->slots[i].ticks, ticks);
+                __sync_fetch_and_add(&sketch->slots[i].count, 1);
+                if (matched) {
+                    __sync_fetch_and_add(&sketch->slots[i].matched, 1);
+                }
+                pthread_mutex_unlock(&profiler->sketch_lock);
+                return;
+            }
+            if (sketch->slots[i].rule == NULL) {
+                min_i = i;
+                min_ticks = 0;
+                break;
+            }
+            if (sketch->slots[i].ticks < min_ticks) {
+                min_ticks = sketch->slots[i].ticks;
+                min_i = i;
+            }
+        }
+
+        sketch->slots[min_i].rule    = rule;
+        sketch->slots[min_i].ticks   = min_ticks + ticks;
+        sketch->slots[min_i].count   = 1;
+        sketch->slots[min_i].matched = matched ? 1 : 0;
+    }
+    pthread_mutex_unlock(&profiler->sketch_lock);
+}
+
+void ib_rule_profiler_record(
+    ib_rule_profiler_t *profiler,
+    const ib_rule_t    *rule,
+    const ib_context_t *ctx,
+    uint64_t            ticks,
+    bool                matched
+)
+{
+    assert(profiler != NULL);
+    assert(rule != NULL);
+
+    ib_rule_profiler_slot_t *slot;
+
+    if ( (! profiler->enabled) ||
+         (profiler->slots == NULL) ||
+         (rule->meta.index >= profiler->n_slots) )
+    {
+        return;
+    }
+
+    slot = &profiler->slots[rule->meta.index];
+    slot->rule = rule;
+    __sync_fetch_and_add(&slot->ticks, ticks);
+    __sync_fetch_and_add(&slot->n, 1);
+    if (matched) {
+        __sync_fetch_and_add(&slot->matched, 1);
+    }
+
+    if (ctx != NULL) {
+        sketch_record(profiler, ctx, rule, ticks, matched);
+    }
+}
+
+ib_status_t ib_rule_profiler_mean(
+    const ib_rule_profiler_t *profiler,
+    const ib_rule_t          *rule,
+    uint64_t                 *mean_ticks,
+    uint64_t                 *n
+)
+{
+    assert(profiler != NULL);
+    assert(rule != NULL);
+    assert(mean_ticks != NULL);
+    assert(n != NULL);
+
+    const ib_rule_profiler_slot_t *slot;
+
+    if ( (profiler->slots == NULL) ||
+         (rule->meta.index >= profiler->n_slots) )
+    {
+        return IB_ENOENT;
+    }
+    slot = &profiler->slots[rule->meta.index];
+    if (slot->n == 0) {
+        return IB_ENOENT;
+    }
+
+    *mean_ticks = slot->ticks / slot->n;
+    *n = slot->n;
+    return IB_OK;
+}
+
+ib_status_t ib_rule_profiler_enable(
+    ib_engine_t *ib
+)
+{
+    assert(ib != NULL);
+    assert(ib->rule_engine != NULL);
+
+    ib_rule_profiler_t *profiler = ib->rule_engine->profiler;
+
+    assert(profiler != NULL);
+
+    /* Build the slot table on first enable.  index_limit is stable once
+     * configuration is complete, which is the earliest the control
+     * channel can reach us. */
+    if (profiler->slots == NULL) {
+        size_t n_slots = ib->rule_engine->index_limit;
+
+        if (n_slots > 0) {
+            profiler->slots = (ib_rule_profiler_slot_t *)ib_mm_calloc(
+                profiler->mm,
+                n_slots,
+                sizeof(*profiler->slots)
+            );
+            if (profiler->slots == NULL) {
+                return IB_EALLOC;
+            }
+            profiler->n_slots = n_slots;
+        }
+    }
+
+    profiler->enabled = true;
+    return IB_OK;
+}
+
+ib_status_t ib_rule_profiler_disable(
+    ib_engine_t *ib
+)
+{
+    assert(ib != NULL);
+    assert(ib->rule_engine != NULL);
+    assert(ib->rule_engine->profiler != NULL);
+
+    ib->rule_engine->profiler->enabled = false;
+    return IB_OK;
+}
+
+ib_status_t ib_rule_profiler_reset(
+    ib_engine_t *ib
+)
+{
+    {
+        ib_rule_profiler_t *profiler = ib->rule_engine->profiler;
+
+        pthread_mutex_lock(&profiler->sketch_lock);
+        memset(profiler->sketches, 0, sizeof(profiler->sketches));
+        profiler->n_sketches = 0;
+        pthread_mutex_unlock(&profiler->sketch_lock);
+    }
+
+    assert(ib != NULL);
+    assert(ib->rule_engine != NULL);
+    assert(ib->rule_engine->profiler != NULL);
+
+    ib_rule_profiler_t *profiler = ib->rule_engine->profiler;
+
+    if (profiler->slots != NULL) {
+        memset(
+            profiler->slots,
+            0,
+            profiler->n_slots * sizeof(*profiler->slots)
+        );
+    }
+
+    return IB_OK;
+}
+
+/**
+ * Compare two profiler slots by accumulated ticks, descending.
+ *
+ * @param[in] lhs Left slot.
+ * @param[in] rhs Right slot.
+ *
+ * @returns -1, 0 or 1 as qsort expects.
+ */
+static int slot_cmp(const void *lhs, const void *rhs)
+{
+    const ib_rule_profiler_slot_t *l = (const ib_rule_profiler_slot_t *)lhs;
+    const ib_rule_profiler_slot_t *r = (const ib_rule_profiler_slot_t *)rhs;
+
+    if (l->ticks > r->ticks) {
+        return -1;
+    }
+    if (l->ticks < r->ticks) {
+        return 1;
+    }
+    return 0;
+}
+
+ib_status_t ib_rule_profiler_site_report(
+    ib_engine_t  *ib,
+    ib_mm_t       mm,
+    const char  **report
+)
+{
+    assert(ib != NULL);
+    assert(ib->rule_engine != NULL);
+    assert(report != NULL);
+
+    ib_rule_profiler_t *profiler = ib->rule_engine->profiler;
+    char               *answer;
+    size_t              answer_sz;
+    size_t              answer_len = 0;
+    size_t              n_sketches = profiler->n_sketches;
+
+    if (n_sketches == 0) {
+        *report = "No per-site samples recorded.\n";
+        return IB_OK;
+    }
+
+    /* A header per context plus a line per slot. */
+    answer_sz = n_sketches * (RULE_PROFILER_TOPK + 1) * 128;
+    answer = (char *)ib_mm_alloc(mm, answer_sz);
+    if (answer == NULL) {
+        return IB_EALLOC;
+    }
+
+    for (size_t i = 0; i < n_sketches && answer_len < answer_sz; ++i) {
+        const ib_rule_profiler_sketch_t *sketch = &profiler->sketches[i];
+
+        answer_len += snprintf(
+            answer + answer_len, answer_sz - answer_len,
+            "site %s\n",
+            ib_context_full_get(sketch->ctx));
+
+        for (size_t j = 0;
+             j < RULE_PROFILER_TOPK && answer_len < answer_sz;
+             ++j)
+        {
+            const ib_rule_profiler_topk_t *slot = &sketch->slots[j];
+
+            if (slot->rule == NULL) {
+                continue;
+            }
+            answer_len += snprintf(
+                answer + answer_len, answer_sz - answer_len,
+                "  %-40s %16" PRIu64 " %12" PRIu64 " %12" PRIu64 "\n",
+                ib_rule_id(slot->rule),
+                slot->ticks,
+                slot->count,
+                slot->matched);
+        }
+    }
+
+    *report = answer;
+    return IB_OK;
+}
+
+ib_status_t ib_rule_profiler_report(
+    ib_engine_t  *ib,
+    ib_mm_t       mm,
+    size_t        limit,
+    const char  **report
+)
+{
+    assert(ib != NULL);
+    assert(ib->rule_engine != NULL);
+    assert(report != NULL);
+
+    ib_rule_profiler_t      *profiler = ib->rule_engine->profiler;
+    ib_rule_profiler_slot_t *snapshot;
+    size_t                   n_used = 0;
+    char                    *answer;
+    size_t                   answer_sz;
+    size_t                   answer_len = 0;
+
+    assert(profiler != NULL);
+
+    if ( (profiler->slots == NULL) || (profiler->n_slots == 0) ) {
+        *report = "No samples recorded.\n";
+        return IB_OK;
+    }
+
+    /* Snapshot the populated slots so sorting does not fight the
+     * workers' atomic updates. */
+    snapshot = (ib_rule_profiler_slot_t *)ib_mm_alloc(
+        mm,
+        profiler->n_slots * sizeof(*snapshot)
+    );
+    if (snapshot == NULL) {
+        return IB_EALLOC;
+    }
+    for (size_t i = 0;  i < profiler->n_slots;  ++i) {
+        if ( (profiler->slots[i].rule != NULL) &&
+             (profiler->slots[i].n > 0) )
+        {
+            snapshot[n_used++] = profiler->slots[i];
+        }
+    }
+
+    if (n_used == 0) {
+        *report = "No samples recorded.\n";
+        return IB_OK;
+    }
+
+    qsort(snapshot, n_used, sizeof(*snapshot), slot_cmp);
+
+    if (limit < n_used) {
+        n_used = limit;
+    }
+
+    /* One line per rule plus a header; 128 bytes is ample per line. */
+    answer_sz = (n_used + 1) * 128;
+    answer = (char *)ib_mm_alloc(mm, answer_sz);
+    if (answer == NULL) {
+        return IB_EALLOC;
+    }
+
+    answer_len += snprintf(
+        answer,
+        answer_sz,
+        "%-40s %16s %12s %12s %12s\n",
+        "rule", "ticks", "count", "ticks/call", "matched"
+    );
+    for (size_t i = 0;  i < n_used && answer_len < answer_sz;  ++i) {
+        answer_len += snprintf(
+            answer + answer_len,
+            answer_sz - answer_len,
+            "%-40s %16" PRIu64 " %12" PRIu64 " %12" PRIu64 " %12" PRIu64 "\n",
+            ib_rule_id(snapshot[i].rule),
+            snapshot[i].ticks,
+            snapshot[i].n,
+            snapshot[i].ticks / snapshot[i].n,
+            snapshot[i].matched
+        );
+    }
+
+    *report = answer;
+    return IB_OK;
+}
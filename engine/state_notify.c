@@ -371,6 +371,15 @@ static ib_status_t ib_state_notify_tx(ib_engine_t *ib,
             ib_log_debug_tx(tx, "Hook declined: %s",
                             ib_state_name(state));
         }
+        else if (rc == IB_DEFER) {
+            /* An operator parked the phase (see ib_rule_exec_resume()).
+             * Stop dispatching and surface the defer to the server.
+             * Hooks registered after this one for the same state are
+             * skipped for this transaction; deferring operators are
+             * expected only in the rule engine's phase hooks. */
+            ib_log_debug_tx(tx, "Hook deferred: %s", ib_state_name(state));
+            return IB_DEFER;
+        }
         else if (rc != IB_OK) {
             log_hook_failure(ib, state, rc, hook->callback.tx);
         }
@@ -398,7 +407,7 @@ ib_status_t ib_state_notify_request_started(
     }
 
     /* Mark the time. */
-    tx->t.request_started = ib_clock_get_time();
+    tx->t.request_started = ib_clock_coarse_get_time();
 
     ib_tx_flags_set(tx, IB_TX_FREQ_STARTED);
 
@@ -543,7 +552,7 @@ ib_status_t ib_state_notify_conn_closed(ib_engine_t *ib,
     }
 
     /* Mark the time. */
-    conn->t.finished = ib_clock_get_time();
+    conn->t.finished = ib_clock_coarse_get_time();
 
     ib_flags_set(conn->flags, IB_CONN_FCLOSED);
 
@@ -678,7 +687,7 @@ ib_status_t ib_state_notify_request_header_data(ib_engine_t *ib,
 
     /* Mark the time. */
     if (tx->t.request_started == 0) {
-        tx->t.request_started = ib_clock_get_time();
+        tx->t.request_started = ib_clock_coarse_get_time();
     }
 
     if ( tx->request_header == NULL ) {
@@ -745,7 +754,7 @@ ib_status_t ib_state_notify_request_header_finished(ib_engine_t *ib,
     }
 
     /* Mark the time. */
-    tx->t.request_header = ib_clock_get_time();
+    tx->t.request_header = ib_clock_coarse_get_time();
 
     ib_tx_flags_set(tx, IB_TX_FREQ_HEADER);
 
@@ -779,10 +788,23 @@ ib_status_t ib_state_notify_request_header_finished(ib_engine_t *ib,
     return IB_OK;
 }
 
-ib_status_t ib_state_notify_request_body_data(ib_engine_t *ib,
-                                              ib_tx_t *tx,
-                                              const char *data,
-                                              size_t data_length)
+/**
+ * Implementation of ib_state_notify_request_body_data().
+ *
+ * @param[in] ib Engine.
+ * @param[in] tx Transaction.
+ * @param[in] data Body data.
+ * @param[in] data_length Length of @a data.
+ * @param[in] alias Alias @a data into the stream system instead of
+ *            copying; the caller then guarantees transaction lifetime.
+ *
+ * @returns Status code.
+ */
+static ib_status_t state_notify_request_body_data(ib_engine_t *ib,
+                                                  ib_tx_t *tx,
+                                                  const char *data,
+                                                  size_t data_length,
+                                                  bool alias)
 {
     assert(ib != NULL);
     assert(ib->cfg_state == CFG_FINISHED);
@@ -838,7 +860,7 @@ ib_status_t ib_state_notify_request_body_data(ib_engine_t *ib,
 
     /* On the first call, record the time and mark that there is a body. */
     if (tx->t.request_body == 0) {
-        tx->t.request_body = ib_clock_get_time();
+        tx->t.request_body = ib_clock_coarse_get_time();
         ib_tx_flags_set(tx, IB_TX_FREQ_BODY);
         tx->request_body_len = data_length;
     }
@@ -853,10 +875,18 @@ ib_status_t ib_state_notify_request_body_data(ib_engine_t *ib,
     }
 
     /* Pass data through streaming system. */
-    rc = ib_stream_pump_process(
-        ib_tx_request_body_pump(tx),
-        (const uint8_t *)data,
-        data_length);
+    if (alias) {
+        rc = ib_stream_pump_process_alias(
+            ib_tx_request_body_pump(tx),
+            (const uint8_t *)data,
+            data_length);
+    }
+    else {
+        rc = ib_stream_pump_process(
+            ib_tx_request_body_pump(tx),
+            (const uint8_t *)data,
+            data_length);
+    }
     if (rc != IB_OK) {
         return rc;
     }
@@ -864,6 +894,64 @@ ib_status_t ib_state_notify_request_body_data(ib_engine_t *ib,
     return IB_OK;
 }
 
+ib_status_t ib_state_notify_request_body_data(ib_engine_t *ib,
+                                              ib_tx_t *tx,
+                                              const char *data,
+                                              size_t data_length)
+{
+    return state_notify_request_body_data(ib, tx, data, data_length, false);
+}
+
+ib_status_t ib_state_notify_request_body_data_alias(ib_engine_t *ib,
+                                                    ib_tx_t *tx,
+                                                    const char *data,
+                                                    size_t data_length)
+{
+    return state_notify_request_body_data(ib, tx, data, data_length, true);
+}
+
+ib_status_t ib_state_notify_request(
+    ib_engine_t          *ib,
+    ib_tx_t              *tx,
+    ib_parsed_req_line_t *line,
+    ib_parsed_headers_t  *headers,
+    const char           *data,
+    size_t                data_length)
+{
+    assert(ib != NULL);
+    assert(tx != NULL);
+
+    ib_status_t rc;
+
+    if (line != NULL) {
+        rc = ib_state_notify_request_started(ib, tx, line);
+        if (rc != IB_OK) {
+            return rc;
+        }
+    }
+
+    if (headers != NULL) {
+        rc = ib_state_notify_request_header_data(ib, tx, headers);
+        if (rc != IB_OK) {
+            return rc;
+        }
+    }
+
+    rc = ib_state_notify_request_header_finished(ib, tx);
+    if (rc != IB_OK) {
+        return rc;
+    }
+
+    if (data != NULL && data_length > 0) {
+        rc = ib_state_notify_request_body_data(ib, tx, data, data_length);
+        if (rc != IB_OK) {
+            return rc;
+        }
+    }
+
+    return ib_state_notify_request_finished(ib, tx);
+}
+
 ib_status_t ib_state_notify_request_finished(ib_engine_t *ib,
                                              ib_tx_t *tx)
 {
@@ -899,7 +987,7 @@ ib_status_t ib_state_notify_request_finished(ib_engine_t *ib,
     }
 
     /* Mark the time. */
-    tx->t.request_finished = ib_clock_get_time();
+    tx->t.request_finished = ib_clock_coarse_get_time();
 
     ib_tx_flags_set(tx, IB_TX_FREQ_FINISHED);
 
@@ -949,7 +1037,7 @@ ib_status_t ib_state_notify_response_started(ib_engine_t *ib,
         return IB_OK;
     }
 
-    tx->t.response_started = ib_clock_get_time();
+    tx->t.response_started = ib_clock_coarse_get_time();
 
     /* Validate. */
     if (ib_flags_all(tx->flags, IB_TX_FRES_STARTED)) {
@@ -969,7 +1057,7 @@ ib_status_t ib_state_notify_response_started(ib_engine_t *ib,
     }
 
     /* Mark the time. */
-    tx->t.response_started = ib_clock_get_time();
+    tx->t.response_started = ib_clock_coarse_get_time();
 
     ib_tx_flags_set(tx, IB_TX_FRES_STARTED);
 
@@ -1011,7 +1099,7 @@ ib_status_t ib_state_notify_response_header_data(ib_engine_t *ib,
 
     /* Mark the time. */
     if (tx->t.response_started == 0) {
-        tx->t.response_started = ib_clock_get_time();
+        tx->t.response_started = ib_clock_coarse_get_time();
     }
 
     if ( tx->response_header == NULL ) {
@@ -1101,7 +1189,7 @@ ib_status_t ib_state_notify_response_header_finished(ib_engine_t *ib,
     }
 
     /* Mark the time. */
-    tx->t.response_header = ib_clock_get_time();
+    tx->t.response_header = ib_clock_coarse_get_time();
 
     ib_tx_flags_set(tx, IB_TX_FRES_HEADER);
 
@@ -1167,7 +1255,7 @@ ib_status_t ib_state_notify_response_body_data(ib_engine_t *ib,
 
     /* On the first call, record the time and mark that there is a body. */
     if (tx->t.response_body == 0) {
-        tx->t.response_body = ib_clock_get_time();
+        tx->t.response_body = ib_clock_coarse_get_time();
         ib_tx_flags_set(tx, IB_TX_FRES_HAS_DATA);
         ib_tx_flags_set(tx, IB_TX_FRES_BODY);
         tx->response_body_len = data_length;
@@ -1194,6 +1282,48 @@ ib_status_t ib_state_notify_response_body_data(ib_engine_t *ib,
     return IB_OK;
 }
 
+ib_status_t ib_state_notify_response(
+    ib_engine_t           *ib,
+    ib_tx_t               *tx,
+    ib_parsed_resp_line_t *line,
+    ib_parsed_headers_t   *headers,
+    const char            *data,
+    size_t                 data_length)
+{
+    assert(ib != NULL);
+    assert(tx != NULL);
+
+    ib_status_t rc;
+
+    if (line != NULL) {
+        rc = ib_state_notify_response_started(ib, tx, line);
+        if (rc != IB_OK) {
+            return rc;
+        }
+    }
+
+    if (headers != NULL) {
+        rc = ib_state_notify_response_header_data(ib, tx, headers);
+        if (rc != IB_OK) {
+            return rc;
+        }
+    }
+
+    rc = ib_state_notify_response_header_finished(ib, tx);
+    if (rc != IB_OK) {
+        return rc;
+    }
+
+    if (data != NULL && data_length > 0) {
+        rc = ib_state_notify_response_body_data(ib, tx, data, data_length);
+        if (rc != IB_OK) {
+            return rc;
+        }
+    }
+
+    return ib_state_notify_response_finished(ib, tx);
+}
+
 ib_status_t ib_state_notify_response_finished(ib_engine_t *ib,
                                               ib_tx_t *tx)
 {
@@ -1229,7 +1359,7 @@ ib_status_t ib_state_notify_response_finished(ib_engine_t *ib,
     }
 
     /* Mark the time. */
-    tx->t.response_finished = ib_clock_get_time();
+    tx->t.response_finished = ib_clock_coarse_get_time();
 
     ib_tx_flags_set(tx, IB_TX_FRES_FINISHED);
 
@@ -1258,7 +1388,7 @@ ib_status_t ib_state_notify_response_finished(ib_engine_t *ib,
     }
 
     /* Mark the time. */
-    tx->t.finished = ib_clock_get_time();
+    tx->t.finished = ib_clock_coarse_get_time();
 
     /* Signal that all data should leave the pipeline. */
     rc = ib_stream_pump_close(ib_tx_request_body_pump(tx));
@@ -1274,6 +1404,16 @@ ib_status_t ib_state_notify_response_finished(ib_engine_t *ib,
     return IB_OK;
 }
 
+/* A background, time-sliced queue for post-response analysis has been
+ * considered and does not fit the ownership model: the server owns the
+ * transaction and destroys it (with all its pools, parser memory and
+ * var data) immediately after the logging state, so deferred work would
+ * need deep copies of everything it reads -- at which point it is an
+ * external analytics pipeline, which the audit log and txlog formats
+ * already feed.  Post-response inspection that must see live data runs
+ * here, in the postprocess state, which already executes after the
+ * response has left and is exempt from allow-all skipping and the
+ * inspection budget's fail-open. */
 ib_status_t ib_state_notify_postprocess(ib_engine_t *ib,
                                         ib_tx_t *tx)
 {
@@ -1291,7 +1431,7 @@ ib_status_t ib_state_notify_postprocess(ib_engine_t *ib,
     }
 
     /* Mark time. */
-    tx->t.postprocess = ib_clock_get_time();
+    tx->t.postprocess = ib_clock_coarse_get_time();
 
     ib_tx_flags_set(tx, IB_TX_FPOSTPROCESS);
 
@@ -0,0 +1,104 @@
+/*****************************************************************************
+ * Licensed to Qualys, Inc. (QUALYS) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * QUALYS licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+/**
+ * @file
+ * @brief IronBee --- Engine Statistics Implementation
+ *
+ * @author Nick LeRoy <nleroy@qualys.com>
+ */
+
+#include "ironbee_config_auto.h"
+
+#include <ironbee/stats.h>
+
+#include "engine_private.h"
+
+#include <assert.h>
+#include <pthread.h>
+
+/* The shard array must have room for every counter. */
+typedef char ib_stats_shard_fits_assert[
+    (IB_STAT_MAX <= sizeof(((ib_stats_shard_t *)0)->counters) /
+                    sizeof(((ib_stats_shard_t *)0)->counters[0])) ? 1 : -1
+];
+
+/** Shard index for the calling thread. */
+static size_t ib_stats_shard(void)
+{
+    /* Thread ids are pointer-like; mix the non-alignment bits. */
+    uintptr_t id = (uintptr_t)pthread_self();
+    return (size_t)((id >> 10) % IB_STATS_SHARDS);
+}
+
+void ib_stats_add(
+    ib_engine_t *ib,
+    ib_stat_t    stat,
+    uint64_t     delta
+)
+{
+    assert(ib != NULL);
+    assert(stat < IB_STAT_MAX);
+
+    __sync_fetch_and_add(
+        &ib->stats[ib_stats_shard()].counters[stat],
+        delta
+    );
+}
+
+uint64_t ib_stats_get(
+    const ib_engine_t *ib,
+    ib_stat_t          stat
+)
+{
+    assert(ib != NULL);
+    assert(stat < IB_STAT_MAX);
+
+    uint64_t total = 0;
+
+    for (size_t i = 0; i < IB_STATS_SHARDS; ++i) {
+        total += ib->stats[i].counters[stat];
+    }
+
+    return total;
+}
+
+const char *ib_stats_name(
+    ib_stat_t stat
+)
+{
+    switch (stat) {
+    case IB_STAT_TX_STARTED:
+        return "tx_started";
+    case IB_STAT_TX_FINISHED:
+        return "tx_finished";
+    case IB_STAT_BLOCKS:
+        return "blocks";
+    case IB_STAT_LOGEVENTS:
+        return "logevents";
+    case IB_STAT_AUTOMATA_BYTES:
+        return "automata_bytes";
+    case IB_STAT_AUTOMATA_NODES:
+        return "automata_nodes";
+    case IB_STAT_AUTOMATA_OUTPUTS:
+        return "automata_outputs";
+    case IB_STAT_AUTOMATA_DEFAULTS:
+        return "automata_defaults";
+    default:
+        return "unknown";
+    }
+}
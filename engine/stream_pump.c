@@ -251,6 +251,44 @@ ib_status_t ib_stream_pump_process(
     return rc;
 }
 
+ib_status_t ib_stream_pump_process_alias(
+    ib_stream_pump_t *pump,
+    const uint8_t    *data,
+    size_t            data_len
+)
+{
+    assert(pump != NULL);
+
+    ib_status_t        rc;
+    ib_stream_io_tx_t *io_tx;
+
+    /* If the user asked us to operate on nothing, that's OK! Do nothing. */
+    if (data == NULL || data_len == 0) {
+        return IB_OK;
+    }
+
+    rc = ib_stream_io_tx_create(&io_tx, pump->io);
+    if (rc != IB_OK) {
+        ib_log_alert_tx(pump->tx, "Failed to create io transaction.");
+        return rc;
+    }
+
+    rc = ib_stream_io_tx_data_alias_add(io_tx, data, data_len);
+    if (rc != IB_OK) {
+        ib_log_alert_tx(pump->tx, "Failed to add data to io transaction.");
+        return rc;
+    }
+
+    /* Setup and run the processor. */
+    rc = stream_pump_process_setup_and_run(pump, io_tx);
+    if (rc != IB_OK) {
+        ib_log_alert_tx(pump->tx, "Failed to setup and run pump.");
+        return rc;
+    }
+
+    return rc;
+}
+
 ib_status_t ib_stream_pump_flush(
     ib_stream_pump_t *pump
 )
@@ -36,6 +36,9 @@
 #endif
 #include <boost/filesystem.hpp>
 #include <boost/thread.hpp>
+
+#include <fstream>
+#include <string>
 #ifdef __clang__
 #pragma clang diagnostic pop
 #endif
@@ -282,3 +285,145 @@ TEST_F(EngMgrCtrlChanTest, diag_version)
 
     ASSERT_FALSE(boost::filesystem::exists("./tmp.sock"));
 }
+
+/**
+ * Fixture for the manager diagnostic commands, which need a managed
+ * engine to act on.
+ */
+class EngMgrCtrlChanDiagTest : public EngMgrCtrlChanTest
+{
+public:
+    void SetUp()
+    {
+        EngMgrCtrlChanTest::SetUp();
+
+        ASSERT_EQ(
+            IB_OK,
+            ib_manager_engine_create(
+                EngineManager(),
+                IB_MANAGER_ENGINE_NAME_DEFAULT,
+                createIronBeeConfig().c_str()
+            )
+        );
+
+        ASSERT_EQ(
+            IB_OK,
+            ib_engine_manager_control_channel_create(
+                &m_channel,
+                MainMM(),
+                EngineManager()
+            )
+        );
+        ASSERT_EQ(
+            IB_OK,
+            ib_engine_manager_control_channel_socket_path_set(
+                m_channel, "./tmp.sock")
+        );
+        ASSERT_EQ(
+            IB_OK,
+            ib_engine_manager_control_manager_diag_register(m_channel)
+        );
+        ASSERT_EQ(
+            IB_OK,
+            ib_engine_manager_control_channel_start(m_channel)
+        );
+    }
+
+    virtual void TearDown()
+    {
+        ib_engine_manager_control_channel_stop(m_channel);
+        EngMgrCtrlChanTest::TearDown();
+    }
+
+    //! Send @a command over the channel and collect the response.
+    ib_status_t SendCommand(const char* command, const char** response)
+    {
+        boost::packaged_task<ib_status_t> pt(
+            boost::bind(
+                ib_engine_manager_control_send,
+                "./tmp.sock",
+                command,
+                MainMM(),
+                response
+            )
+        );
+        boost::shared_future<ib_status_t> fut(pt.get_future());
+        boost::thread thr(boost::move(pt));
+
+        ib_status_t recv_rc = ib_engine_manager_control_recv(m_channel, true);
+        thr.join();
+        if (recv_rc != IB_OK) {
+            return recv_rc;
+        }
+
+        return fut.get();
+    }
+
+private:
+    std::string createIronBeeConfig()
+    {
+        using ::testing::TestInfo;
+        using ::testing::UnitTest;
+
+        const TestInfo* const info =
+            UnitTest::GetInstance()->current_test_info();
+
+        const std::string configFile =
+            std::string(info->test_case_name()) +
+            "." +
+            std::string(info->name()) +
+            ".config";
+
+        std::ofstream o(configFile.c_str());
+        o <<
+            "# A basic ironbee configuration\n"
+            "# for getting an engine up-and-running.\n"
+            "SensorId       B9C1B52B-C24A-4309-B9F9-0EF4CD577A3E\n"
+            "SensorName     UnitTesting\n"
+            "SensorHostname unit-testing.sensor.tld\n"
+            "AuditEngine Off\n"
+            "<Site test-site>\n"
+            "    SiteId AAAABBBB-1111-2222-3333-000000000000\n"
+            "    Hostname somesite.com\n"
+            "</Site>\n";
+        o.close();
+
+        return configFile;
+    }
+
+    ib_engine_manager_control_channel_t* m_channel;
+};
+
+TEST_F(EngMgrCtrlChanDiagTest, diag_stats)
+{
+    const char* response;
+
+    ASSERT_EQ(IB_OK, SendCommand("stats", &response));
+
+    /* Counter rendering plus the adaptive transaction page size. */
+    EXPECT_PRED_FORMAT2(
+        ::testing::IsSubstring, "tx_started=", response);
+    EXPECT_PRED_FORMAT2(
+        ::testing::IsSubstring, "tx_pagesize=", response);
+}
+
+TEST_F(EngMgrCtrlChanDiagTest, diag_memory)
+{
+    const char* response;
+
+    ASSERT_EQ(IB_OK, SendCommand("memory", &response));
+    EXPECT_PRED_FORMAT2(
+        ::testing::IsSubstring, "Pool tree:", response);
+    EXPECT_PRED_FORMAT2(
+        ::testing::IsSubstring, "Top consumers:", response);
+
+    /* The tree subcommand with an explicit top-n. */
+    ASSERT_EQ(IB_OK, SendCommand("memory tree 3", &response));
+    EXPECT_PRED_FORMAT2(
+        ::testing::IsSubstring, "Pool tree:", response);
+
+    /* The analyze report is served through the same command. */
+    ASSERT_EQ(IB_OK, SendCommand("memory analyze", &response));
+    ASSERT_TRUE(response != NULL);
+    EXPECT_TRUE(*response != '\0');
+}
@@ -25,13 +25,17 @@ extern "C" {
 
 #include "util/kvstore_private.h"
 #include <ironbee/kvstore.h>
+#include <ironbee/kvstore_filelog.h>
 #include <ironbee/kvstore_filesystem.h>
+#include <ironbee/kvstore_shm.h>
 #include <ironbee/mm.h>
 #include <ironbee/util.h>
 #include <ironbee/uuid.h>
 #include <ironbee/mm_mpool.h>
 
 #include <errno.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 }
 
@@ -170,3 +174,242 @@ TEST_F(TestKVStore, test_removes) {
 
     ASSERT_FALSE(result);
 }
+
+class TestKVStoreFilelog : public testing::Test
+{
+    public:
+
+    ib_kvstore_t kvstore;
+    ib_mpool_t *mp;
+    ib_mm_t mm;
+
+    virtual void SetUp() {
+        unlink("TestKVStoreFilelog.log");
+        ib_uuid_initialize();
+        ASSERT_EQ(
+            IB_OK,
+            ib_kvstore_filelog_init(&kvstore, "TestKVStoreFilelog.log", 16));
+        ib_mpool_create(&mp, "TestKVStoreFilelog", NULL);
+        mm = ib_mm_mpool(mp);
+    }
+
+    virtual void TearDown() {
+        ib_kvstore_destroy(&kvstore);
+        ib_mpool_destroy(mp);
+        ib_uuid_shutdown();
+    }
+
+    void write(ib_kvstore_t *store, const char *key, const char *value) {
+        ib_kvstore_key_t   *k;
+        ib_kvstore_value_t *v;
+
+        ASSERT_EQ(
+            IB_OK,
+            ib_kvstore_key_create(
+                &k,
+                mm,
+                reinterpret_cast<const uint8_t *>(key), strlen(key)));
+        ASSERT_EQ(IB_OK, ib_kvstore_value_create(&v, mm));
+        ib_kvstore_value_value_set(
+            v,
+            reinterpret_cast<const uint8_t *>(value),
+            strlen(value));
+        ib_kvstore_value_type_set(v, "txt", 3);
+        ib_kvstore_value_expiration_set(v, 3600 * 1000000LU);
+        ASSERT_EQ(IB_OK, ib_kvstore_set(store, NULL, k, v));
+    }
+
+    ib_status_t read(ib_kvstore_t *store, const char *key, std::string *out) {
+        ib_kvstore_key_t   *k;
+        ib_kvstore_value_t *result;
+        const uint8_t      *data;
+        size_t              data_length;
+        ib_status_t         rc;
+
+        rc = ib_kvstore_key_create(
+            &k, mm, reinterpret_cast<const uint8_t *>(key), strlen(key));
+        if (rc != IB_OK) {
+            return rc;
+        }
+        rc = ib_kvstore_get(store, NULL, mm, k, &result);
+        if (rc != IB_OK) {
+            return rc;
+        }
+        ib_kvstore_value_value_get(result, &data, &data_length);
+        out->assign(reinterpret_cast<const char *>(data), data_length);
+        return IB_OK;
+    }
+};
+
+TEST_F(TestKVStoreFilelog, test_init) {
+    /* Nop */
+}
+
+TEST_F(TestKVStoreFilelog, test_write_read_overwrite) {
+    std::string value;
+
+    write(&kvstore, "k1", "first");
+    write(&kvstore, "k1", "second");
+    write(&kvstore, "k2", "other");
+
+    ASSERT_EQ(IB_OK, read(&kvstore, "k1", &value));
+    ASSERT_EQ("second", value);
+    ASSERT_EQ(IB_OK, read(&kvstore, "k2", &value));
+    ASSERT_EQ("other", value);
+}
+
+TEST_F(TestKVStoreFilelog, test_removes) {
+    std::string value;
+
+    write(&kvstore, "k3", "doomed");
+    {
+        ib_kvstore_key_t *k;
+        ASSERT_EQ(
+            IB_OK,
+            ib_kvstore_key_create(
+                &k, mm, reinterpret_cast<const uint8_t *>("k3"), 2));
+        ASSERT_EQ(IB_OK, ib_kvstore_remove(&kvstore, k));
+    }
+    ASSERT_EQ(IB_ENOENT, read(&kvstore, "k3", &value));
+}
+
+TEST_F(TestKVStoreFilelog, test_reattach) {
+    ib_kvstore_t reattached;
+    std::string  value;
+
+    write(&kvstore, "k4", "durable");
+    ib_kvstore_destroy(&kvstore);
+
+    /* A second open of the same file sees the record; the slot count
+     * of the existing file wins. */
+    ASSERT_EQ(
+        IB_OK,
+        ib_kvstore_filelog_init(&reattached, "TestKVStoreFilelog.log", 99));
+    ASSERT_EQ(IB_OK, read(&reattached, "k4", &value));
+    ASSERT_EQ("durable", value);
+    ib_kvstore_destroy(&reattached);
+
+    /* Leave a store for TearDown to destroy. */
+    ASSERT_EQ(
+        IB_OK,
+        ib_kvstore_filelog_init(&kvstore, "TestKVStoreFilelog.log", 16));
+}
+
+TEST_F(TestKVStoreFilelog, test_compact) {
+    std::string value;
+
+    write(&kvstore, "k5", "first");
+    write(&kvstore, "k5", "second");
+    write(&kvstore, "k6", "keep");
+
+    ASSERT_EQ(IB_OK, ib_kvstore_filelog_compact(&kvstore));
+
+    ASSERT_EQ(IB_OK, read(&kvstore, "k5", &value));
+    ASSERT_EQ("second", value);
+    ASSERT_EQ(IB_OK, read(&kvstore, "k6", &value));
+    ASSERT_EQ("keep", value);
+    ASSERT_EQ(IB_ENOENT, read(&kvstore, "nope", &value));
+}
+
+class TestKVStoreShm : public testing::Test
+{
+    public:
+
+    ib_kvstore_t kvstore;
+    ib_mpool_t *mp;
+    ib_mm_t mm;
+
+    virtual void SetUp() {
+        shm_unlink("/TestKVStoreShm");
+        ib_uuid_initialize();
+        ASSERT_EQ(
+            IB_OK,
+            ib_kvstore_shm_init(&kvstore, "/TestKVStoreShm", 16, 128));
+        ASSERT_EQ(IB_OK, ib_kvstore_connect(&kvstore));
+        ib_mpool_create(&mp, "TestKVStoreShm", NULL);
+        mm = ib_mm_mpool(mp);
+    }
+
+    virtual void TearDown() {
+        ib_kvstore_destroy(&kvstore);
+        shm_unlink("/TestKVStoreShm");
+        ib_mpool_destroy(mp);
+        ib_uuid_shutdown();
+    }
+
+    void make_pair(
+        const char          *key,
+        const char          *value,
+        ib_kvstore_key_t   **k,
+        ib_kvstore_value_t **v
+    ) {
+        ASSERT_EQ(
+            IB_OK,
+            ib_kvstore_key_create(
+                k,
+                mm,
+                reinterpret_cast<const uint8_t *>(key), strlen(key)));
+        ASSERT_EQ(IB_OK, ib_kvstore_value_create(v, mm));
+        ib_kvstore_value_value_set(
+            *v,
+            reinterpret_cast<const uint8_t *>(value),
+            strlen(value));
+        ib_kvstore_value_type_set(*v, "txt", 3);
+        ib_kvstore_value_expiration_set(*v, 3600 * 1000000LU);
+    }
+};
+
+TEST_F(TestKVStoreShm, test_init) {
+    /* Nop */
+}
+
+TEST_F(TestKVStoreShm, test_write_read_remove) {
+    ib_kvstore_key_t   *k;
+    ib_kvstore_value_t *v;
+    ib_kvstore_value_t *result;
+    const uint8_t      *data;
+    size_t              data_length;
+
+    make_pair("k1", "value", &k, &v);
+    ASSERT_EQ(IB_OK, ib_kvstore_set(&kvstore, NULL, k, v));
+
+    ASSERT_EQ(IB_OK, ib_kvstore_get(&kvstore, NULL, mm, k, &result));
+    ib_kvstore_value_value_get(result, &data, &data_length);
+    ASSERT_EQ(5UL, data_length);
+    ASSERT_EQ(0, memcmp(data, "value", 5));
+
+    ASSERT_EQ(IB_OK, ib_kvstore_remove(&kvstore, k));
+    ASSERT_EQ(IB_ENOENT, ib_kvstore_get(&kvstore, NULL, mm, k, &result));
+}
+
+TEST_F(TestKVStoreShm, test_shared_between_handles) {
+    ib_kvstore_t        other;
+    ib_kvstore_key_t   *k;
+    ib_kvstore_value_t *v;
+    ib_kvstore_value_t *result;
+    const uint8_t      *data;
+    size_t              data_length;
+
+    make_pair("k2", "shared", &k, &v);
+    ASSERT_EQ(IB_OK, ib_kvstore_set(&kvstore, NULL, k, v));
+
+    /* A second handle on the same segment name sees the record. */
+    ASSERT_EQ(
+        IB_OK,
+        ib_kvstore_shm_init(&other, "/TestKVStoreShm", 16, 128));
+    ASSERT_EQ(IB_OK, ib_kvstore_connect(&other));
+    ASSERT_EQ(IB_OK, ib_kvstore_get(&other, NULL, mm, k, &result));
+    ib_kvstore_value_value_get(result, &data, &data_length);
+    ASSERT_EQ(6UL, data_length);
+    ASSERT_EQ(0, memcmp(data, "shared", 6));
+    ib_kvstore_destroy(&other);
+}
+
+TEST_F(TestKVStoreShm, test_oversize_rejected) {
+    ib_kvstore_key_t   *k;
+    ib_kvstore_value_t *v;
+    std::string         big(256, 'x');
+
+    make_pair("k3", big.c_str(), &k, &v);
+    ASSERT_EQ(IB_EINVAL, ib_kvstore_set(&kvstore, NULL, k, v));
+}
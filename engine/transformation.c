@@ -79,6 +79,30 @@ struct ib_transformation_inst_t
     void *instance_data;
 };
 
+/**
+ * One memoized transformation result, chained off ib_field_t::tfn_memo.
+ *
+ * Keyed by transformation definition and parameter string (not
+ * instance), so distinct rule targets applying the same transformation
+ * to the same field share one result.
+ */
+typedef struct field_tfn_memo_t field_tfn_memo_t;
+struct field_tfn_memo_t {
+    const ib_transformation_t *tfn;        /**< Definition applied. */
+    const char                *parameters; /**< Parameters, or NULL. */
+    const ib_field_t          *result;     /**< The memoized result. */
+    field_tfn_memo_t          *next;       /**< Next memo entry. */
+};
+
+/** NULL-safe parameter string equality. */
+static bool tfn_parameters_equal(const char *a, const char *b)
+{
+    if (a == NULL || b == NULL) {
+        return a == b;
+    }
+    return strcmp(a, b) == 0;
+}
+
 ib_status_t ib_transformation_create(
     ib_transformation_t            **tfn,
     ib_mm_t                          mm,
@@ -185,6 +209,17 @@ ib_status_t ib_transformation_create_and_register(
     return IB_OK;
 }
 
+/*
+ * On making this registry a dense array for runtime: there is no
+ * runtime to serve.  Every caller of this lookup -- rule target and
+ * modifier parsing, setvar's transformation suffixes, InitVar and
+ * collection initialization -- runs at configuration time, and what
+ * rules carry into execution are instance pointers (flattened into
+ * arrays at context close), which is a stronger guarantee than an
+ * integer id: no registry of any shape is consulted inside a
+ * transaction.  The same holds for operators and actions, whose
+ * instances are likewise resolved at rule parse.
+ */
 ib_status_t ib_transformation_lookup(
     ib_engine_t                *ib,
     const char                 *name,
@@ -392,6 +427,37 @@ ib_status_t ib_transformation_inst_execute(
         out = fnew;
     }
     else {
+        /* Memoize scalar results on the input field: rule sets apply
+         * the same transformation (lowercase, trim, ...) to the same
+         * hot fields many times per transaction, and a transformation
+         * is a pure function of its definition, parameters and input.
+         * Keyed by definition and parameter string so distinct rule
+         * targets share results; only engaged when the caller's memory
+         * manager is the field's own, so a memoized result never
+         * outlives a lifetime the caller assumed shorter.  List
+         * results are not memoized (collections grow between phases);
+         * their elements memoize individually above, and dynamic
+         * fields never are (their values change without mutation). */
+        const bool memoizable =
+            ib_mm_same(mm, fin->mm) && ! ib_field_is_dynamic(fin);
+
+        if (memoizable) {
+            const field_tfn_memo_t *entry;
+
+            for (entry = (const field_tfn_memo_t *)fin->tfn_memo;
+                 entry != NULL;
+                 entry = entry->next)
+            {
+                if (entry->tfn == tfn &&
+                    tfn_parameters_equal(
+                        entry->parameters, tfn_inst->parameters))
+                {
+                    *fout = entry->result;
+                    return IB_OK;
+                }
+            }
+        }
+
         /* Don't unroll */
         rc = tfn->execute_fn(
             mm,
@@ -407,6 +473,20 @@ ib_status_t ib_transformation_inst_execute(
         if (out == NULL) {
             return IB_EINVAL;
         }
+
+        if (memoizable) {
+            field_tfn_memo_t *entry = ib_mm_alloc(mm, sizeof(*entry));
+
+            if (entry != NULL) {
+                entry->tfn        = tfn;
+                entry->parameters = tfn_inst->parameters;
+                entry->result     = out;
+                entry->next       = (field_tfn_memo_t *)fin->tfn_memo;
+                /* The memo is hidden mutable state on a logically
+                 * unchanged field. */
+                ((ib_field_t *)fin)->tfn_memo = entry;
+            }
+        }
     }
 
     assert(rc == IB_OK);
@@ -28,12 +28,14 @@
 
 #include <ironbee/array.h>
 #include <ironbee/hash.h>
+#include <ironbee/list.h>
 #include <ironbee/mm_mpool_lite.h>
 #include <ironbee/string_assembly.h>
 
 #include <assert.h>
 #include <inttypes.h>
 #include <stdio.h>
+#include <string.h>
 
 /* types */
 
@@ -45,6 +47,17 @@ struct ib_var_config_t
     /** Hash of keys to index.  Value `ib_var_source_t *` */
     ib_hash_t *index_by_name;
 
+    /**
+     * Interned unindexed sources.  Value `ib_var_source_t *`.
+     *
+     * Configuration-time acquisitions of unindexed sources (those using
+     * the configuration's own memory manager) are interned here so that
+     * repeated acquisitions of the same name share one source instead of
+     * allocating one per call.  Like registration, interning must only
+     * happen during configuration.
+     */
+    ib_hash_t *interned;
+
     /** Next index to use. */
     size_t next_index;
 };
@@ -59,6 +72,38 @@ struct ib_var_store_t
     ib_hash_t *hash;
     /** Array of source index to value.  Value: `ib_field_t *` */
     ib_array_t *array;
+    /** Parent store gets fall through to; NULL if none. */
+    const ib_var_store_t *parent;
+
+    /**
+     * Store generation: incremented on every ib_var_source_set().
+     *
+     * Together with index_generations this provides dirty tracking:
+     * consumers record a generation and later ask whether a source has
+     * been set since.  See ib_var_store_generation() and
+     * ib_var_source_generation().
+     */
+    uint64_t generation;
+
+    /**
+     * Generation at which each indexed source was last set.
+     *
+     * Sized by the configuration's index count; NULL when there are no
+     * indexed sources.
+     */
+    uint64_t *index_generations;
+
+    /**
+     * Bloom filter over the names of unindexed sources set in this
+     * store.
+     *
+     * A clear pair of bits means the name was certainly never set in
+     * this store (ancestors are walked separately); set bits mean
+     * maybe.  Bits are only ever set, so a cleared value can at worst
+     * cost a false "maybe".  Names hash case insensitively, matching
+     * the store hash.  See ib_var_source_maybe_set().
+     */
+    uint64_t unindexed_bloom[4];
 };
 
 struct ib_var_source_t
@@ -99,6 +144,16 @@ struct ib_var_source_t
      * to allow valgrind to catch inappropriate uses of it.
      **/
     size_t index;
+
+    /**
+     * Bloom bit positions derived from the case-folded name.
+     *
+     * Used by ib_var_source_set() and ib_var_source_maybe_set() for
+     * unindexed existence pre-checks; meaningless but initialized for
+     * indexed sources.
+     **/
+    uint32_t bloom_bit_a;
+    uint32_t bloom_bit_b;
 };
 
 struct ib_var_filter_t
@@ -155,6 +210,40 @@ struct ib_var_expand_t
 
 /* helpers */
 
+/**
+ * Compute the two bloom bit positions for a source name.
+ *
+ * Names are folded to lower case so the bits agree with the
+ * case-insensitive store hash.
+ *
+ * @param[in]  name        Source name.
+ * @param[in]  name_length Length of @a name.
+ * @param[out] bit_a       First bit position, in [0, 256).
+ * @param[out] bit_b       Second bit position, in [0, 256).
+ **/
+static void source_bloom_bits(
+    const char *name,
+    size_t      name_length,
+    uint32_t   *bit_a,
+    uint32_t   *bit_b
+)
+{
+    uint32_t h1 = 5381;
+    uint32_t h2 = 0;
+
+    for (size_t i = 0; i < name_length; ++i) {
+        uint32_t c = (unsigned char)name[i];
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+        h1 = h1 * 33 + c;
+        h2 = c + (h2 << 6) + (h2 << 16) - h2;
+    }
+
+    *bit_a = h1 % 256;
+    *bit_b = h2 % 256;
+}
+
 /**
  * Convert a field to a string.
  *
@@ -249,6 +338,11 @@ ib_status_t ib_var_config_acquire(
         return rc;
     }
 
+    rc = ib_hash_create_nocase(&local_config->interned, mm);
+    if (rc != IB_OK) {
+        return rc;
+    }
+
     *config = local_config;
 
     return IB_OK;
@@ -282,8 +376,13 @@ ib_status_t ib_var_store_acquire(
         return IB_EALLOC;
     }
 
-    local_store->config = config;
-    local_store->mm     = mm;
+    local_store->config            = config;
+    local_store->mm                = mm;
+    local_store->parent            = NULL;
+    local_store->generation        = 0;
+    local_store->index_generations = NULL;
+    memset(local_store->unindexed_bloom, 0,
+           sizeof(local_store->unindexed_bloom));
 
     rc = ib_hash_create_nocase(&local_store->hash, mm);
     if (rc != IB_OK) {
@@ -300,6 +399,15 @@ ib_status_t ib_var_store_acquire(
         if (rc != IB_OK) {
             return rc;
         }
+
+        local_store->index_generations = ib_mm_calloc(
+            mm,
+            local_store->config->next_index,
+            sizeof(*local_store->index_generations)
+        );
+        if (local_store->index_generations == NULL) {
+            return IB_EALLOC;
+        }
     }
 
     *store = local_store;
@@ -307,6 +415,36 @@ ib_status_t ib_var_store_acquire(
     return IB_OK;
 }
 
+ib_status_t ib_var_store_acquire_child(
+    ib_var_store_t       **store,
+    ib_mm_t                mm,
+    const ib_var_store_t  *parent
+)
+{
+    assert(store  != NULL);
+    assert(parent != NULL);
+
+    ib_status_t rc;
+
+    rc = ib_var_store_acquire(store, mm, parent->config);
+    if (rc != IB_OK) {
+        return rc;
+    }
+
+    (*store)->parent = parent;
+
+    return IB_OK;
+}
+
+const ib_var_store_t *ib_var_store_parent(
+    const ib_var_store_t *store
+)
+{
+    assert(store != NULL);
+
+    return store->parent;
+}
+
 const ib_var_config_t *ib_var_store_config(
     const ib_var_store_t *store
 )
@@ -335,6 +473,231 @@ void ib_var_store_export(
 
     /* Ignore return code.  Can only be IB_ENOENT */
     ib_hash_get_all(store->hash, result);
+
+    /* Append parent values not shadowed by this store. */
+    if (store->parent != NULL) {
+        ib_list_t            *parent_values;
+        const ib_list_node_t *node;
+        ib_status_t           rc;
+
+        rc = ib_list_create(&parent_values, store->mm);
+        if (rc != IB_OK) {
+            /* Best effort; exporting only the local values. */
+            return;
+        }
+        ib_var_store_export((ib_var_store_t *)store->parent, parent_values);
+
+        IB_LIST_LOOP_CONST(parent_values, node) {
+            ib_field_t *field =
+                (ib_field_t *)ib_list_node_data_const(node);
+            ib_field_t *shadow;
+
+            rc = ib_hash_get_ex(
+                store->hash,
+                &shadow,
+                field->name, field->nlen
+            );
+            if (rc == IB_ENOENT) {
+                ib_list_push(result, field);
+            }
+        }
+    }
+}
+
+/**
+ * Append one flat export record for @a field to @a out.
+ *
+ * See ib_var_store_export_flat() for the record format.
+ */
+static ib_status_t var_export_flat_field(
+    const ib_field_t *field,
+    ib_vector_t      *out
+)
+{
+    ib_status_t rc;
+    uint8_t     type = (uint8_t)field->type;
+    uint32_t    len32;
+    char        numbuf[32];
+    const char *value = NULL;
+    size_t      value_len = 0;
+    const ib_list_t *children = NULL;
+
+    switch (field->type) {
+    case IB_FTYPE_NUM: {
+        ib_num_t n;
+        rc = ib_field_value(field, ib_ftype_num_out(&n));
+        if (rc != IB_OK) {
+            return rc;
+        }
+        value_len = snprintf(numbuf, sizeof(numbuf), "%" PRId64, n);
+        value = numbuf;
+        break;
+    }
+    case IB_FTYPE_FLOAT: {
+        ib_float_t f;
+        rc = ib_field_value(field, ib_ftype_float_out(&f));
+        if (rc != IB_OK) {
+            return rc;
+        }
+        value_len = snprintf(numbuf, sizeof(numbuf), "%Lf", f);
+        value = numbuf;
+        break;
+    }
+    case IB_FTYPE_TIME: {
+        ib_time_t t;
+        rc = ib_field_value(field, ib_ftype_time_out(&t));
+        if (rc != IB_OK) {
+            return rc;
+        }
+        value_len = snprintf(
+            numbuf, sizeof(numbuf), "%" PRIu64, (uint64_t)t);
+        value = numbuf;
+        break;
+    }
+    case IB_FTYPE_NULSTR: {
+        const char *s;
+        rc = ib_field_value(field, ib_ftype_nulstr_out(&s));
+        if (rc != IB_OK) {
+            return rc;
+        }
+        value = (s == NULL) ? "" : s;
+        value_len = strlen(value);
+        break;
+    }
+    case IB_FTYPE_BYTESTR: {
+        const ib_bytestr_t *bs;
+        rc = ib_field_value(field, ib_ftype_bytestr_out(&bs));
+        if (rc != IB_OK) {
+            return rc;
+        }
+        if (bs != NULL && ib_bytestr_const_ptr(bs) != NULL) {
+            value = (const char *)ib_bytestr_const_ptr(bs);
+            value_len = ib_bytestr_length(bs);
+        }
+        break;
+    }
+    case IB_FTYPE_LIST:
+        if (! ib_field_is_dynamic(field)) {
+            rc = ib_field_value(field, ib_ftype_list_out(&children));
+            if (rc != IB_OK) {
+                return rc;
+            }
+        }
+        break;
+    default:
+        /* Unknown/generic: empty value keeps consumers aligned. */
+        break;
+    }
+
+    /* Dynamic fields are not evaluated; record them empty. */
+    if (ib_field_is_dynamic(field) && field->type != IB_FTYPE_LIST) {
+        value = NULL;
+        value_len = 0;
+    }
+
+    rc = ib_vector_append(out, &type, sizeof(type));
+    if (rc != IB_OK) {
+        return rc;
+    }
+    len32 = (uint32_t)field->nlen;
+    rc = ib_vector_append(out, &len32, sizeof(len32));
+    if (rc != IB_OK) {
+        return rc;
+    }
+    rc = ib_vector_append(out, field->name, field->nlen);
+    if (rc != IB_OK) {
+        return rc;
+    }
+
+    if (field->type == IB_FTYPE_LIST) {
+        const ib_list_node_t *node;
+
+        len32 = (children == NULL) ? 0 : (uint32_t)ib_list_elements(children);
+        rc = ib_vector_append(out, &len32, sizeof(len32));
+        if (rc != IB_OK) {
+            return rc;
+        }
+        if (children != NULL) {
+            IB_LIST_LOOP_CONST(children, node) {
+                rc = var_export_flat_field(
+                    (const ib_field_t *)ib_list_node_data_const(node),
+                    out);
+                if (rc != IB_OK) {
+                    return rc;
+                }
+            }
+        }
+        return IB_OK;
+    }
+
+    len32 = (uint32_t)value_len;
+    rc = ib_vector_append(out, &len32, sizeof(len32));
+    if (rc != IB_OK) {
+        return rc;
+    }
+    if (value_len > 0) {
+        rc = ib_vector_append(out, value, value_len);
+        if (rc != IB_OK) {
+            return rc;
+        }
+    }
+
+    return IB_OK;
+}
+
+ib_status_t ib_var_store_export_flat(
+    ib_var_store_t *store,
+    const char     *name,
+    size_t          name_length,
+    ib_vector_t    *out
+)
+{
+    assert(store != NULL);
+    assert(out   != NULL);
+
+    ib_status_t rc;
+
+    rc = ib_vector_truncate(out, 0);
+    if (rc != IB_OK) {
+        return rc;
+    }
+
+    if (name != NULL) {
+        ib_field_t *field;
+
+        rc = ib_hash_get_ex(store->hash, &field, name, name_length);
+        if (rc == IB_ENOENT && store->parent != NULL) {
+            return ib_var_store_export_flat(
+                (ib_var_store_t *)store->parent, name, name_length, out);
+        }
+        if (rc != IB_OK) {
+            return rc;
+        }
+        return var_export_flat_field(field, out);
+    }
+
+    /* All fields, one pass; parents merged child-shadowed. */
+    {
+        ib_list_t            *fields;
+        const ib_list_node_t *node;
+
+        rc = ib_list_create(&fields, store->mm);
+        if (rc != IB_OK) {
+            return rc;
+        }
+        ib_var_store_export(store, fields);
+
+        IB_LIST_LOOP_CONST(fields, node) {
+            rc = var_export_flat_field(
+                (const ib_field_t *)ib_list_node_data_const(node),
+                out);
+            if (rc != IB_OK) {
+                return rc;
+            }
+        }
+    }
+
+    return IB_OK;
 }
 
 /* var_source */
@@ -385,6 +748,10 @@ ib_status_t ib_var_source_register(
     local_source->final_phase   = final_phase;
     local_source->is_indexed    = true;
     local_source->index         = config->next_index;
+    source_bloom_bits(
+        local_source->name, name_length,
+        &local_source->bloom_bit_a, &local_source->bloom_bit_b
+    );
 
     rc = ib_hash_set_ex(
         config->index_by_name,
@@ -485,6 +852,14 @@ ib_status_t ib_var_source_get(
 
         /* Array only errors if out of band, i.e., not set. */
         if (rc != IB_OK || local_field == NULL) {
+            /* Fall through to the parent store, if any. */
+            if (store->parent != NULL) {
+                return ib_var_source_get(
+                    source,
+                    field,
+                    (ib_var_store_t *)store->parent
+                );
+            }
             return IB_ENOENT;
         }
         if (field != NULL) {
@@ -493,11 +868,22 @@ ib_status_t ib_var_source_get(
         return rc;
     }
     else {
-        return ib_hash_get_ex(
+        ib_status_t rc;
+
+        rc = ib_hash_get_ex(
             store->hash,
             field,
             source->name, source->name_length
         );
+        /* Fall through to the parent store, if any. */
+        if (rc == IB_ENOENT && store->parent != NULL) {
+            return ib_var_source_get(
+                source,
+                field,
+                (ib_var_store_t *)store->parent
+            );
+        }
+        return rc;
     }
 }
 
@@ -538,11 +924,24 @@ ib_status_t ib_var_source_set(
         field->nlen = source->name_length;
     }
 
+    /* Track the write for dirty checking. */
+    ++store->generation;
+
     if (source->is_indexed) {
         rc = ib_array_setn(store->array, source->index, field);
         if (rc != IB_OK) {
             return rc;
         }
+        store->index_generations[source->index] = store->generation;
+    }
+    else {
+        /* Record the name in the existence bloom filter so rules whose
+         * targets were certainly never set can be skipped without a
+         * hash lookup.  See ib_var_source_maybe_set(). */
+        store->unindexed_bloom[source->bloom_bit_a >> 6] |=
+            (uint64_t)1 << (source->bloom_bit_a & 63);
+        store->unindexed_bloom[source->bloom_bit_b >> 6] |=
+            (uint64_t)1 << (source->bloom_bit_b & 63);
     }
     return ib_hash_set_ex(
         store->hash,
@@ -551,6 +950,74 @@ ib_status_t ib_var_source_set(
     );
 }
 
+bool ib_var_source_maybe_set(
+    const ib_var_source_t *source,
+    ib_var_store_t        *store
+)
+{
+    assert(source != NULL);
+    assert(store  != NULL);
+
+    if (source->is_indexed) {
+        ib_field_t *field = NULL;
+
+        return ib_var_source_get(source, &field, store) == IB_OK;
+    }
+
+    /* Walk this store and its ancestors: gets fall through to parents,
+     * so a name set anywhere in the chain may be visible here. */
+    for (const ib_var_store_t *s = store; s != NULL; s = s->parent) {
+        if (
+            (s->unindexed_bloom[source->bloom_bit_a >> 6] &
+             ((uint64_t)1 << (source->bloom_bit_a & 63))) &&
+            (s->unindexed_bloom[source->bloom_bit_b >> 6] &
+             ((uint64_t)1 << (source->bloom_bit_b & 63)))
+        ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+uint64_t ib_var_store_generation(
+    const ib_var_store_t *store
+)
+{
+    assert(store != NULL);
+
+    return store->generation;
+}
+
+const uint64_t *ib_var_store_generation_ptr(
+    const ib_var_store_t *store
+)
+{
+    assert(store != NULL);
+
+    return &store->generation;
+}
+
+uint64_t ib_var_source_generation(
+    const ib_var_source_t *source,
+    const ib_var_store_t  *store
+)
+{
+    assert(source != NULL);
+    assert(store  != NULL);
+
+    /* Unindexed sources are not tracked individually; report the store
+     * generation so callers always treat them as possibly changed. */
+    if (! source->is_indexed || store->index_generations == NULL) {
+        return store->generation;
+    }
+
+    /* A source set in the parent before this store existed predates any
+     * generation recorded here; parent stores are written only before
+     * their children run, so generation zero is correct for them. */
+    return store->index_generations[source->index];
+}
+
 ib_status_t ib_var_source_acquire(
     ib_var_source_t       **source,
     ib_mm_t                 mm,
@@ -576,10 +1043,34 @@ ib_status_t ib_var_source_acquire(
 
     if (rc == IB_ENOENT) {
         /* Non-indexed. */
+        bool intern;
+
         if (ib_mm_is_null(mm)) {
             return IB_ENOENT;
         }
 
+        /* Configuration-time acquisitions, identified by use of the
+         * configuration's own memory manager, are interned so that the
+         * same unindexed name yields one shared source.  Like
+         * registration, this only happens during configuration, so the
+         * intern table sees no concurrent writes. */
+        intern =
+            (mm.alloc      == config->mm.alloc) &&
+            (mm.alloc_data == config->mm.alloc_data);
+        if (intern) {
+            rc = ib_hash_get_ex(
+                config->interned,
+                &local_source,
+                name, name_length
+            );
+            if (rc == IB_OK) {
+                if (source != NULL) {
+                    *source = local_source;
+                }
+                return IB_OK;
+            }
+        }
+
         local_source = ib_mm_alloc(mm, sizeof(*local_source));
         if (local_source == NULL) {
             return IB_EALLOC;
@@ -594,8 +1085,23 @@ ib_status_t ib_var_source_acquire(
         local_source->initial_phase = IB_PHASE_NONE;
         local_source->final_phase   = IB_PHASE_NONE;
         local_source->is_indexed    = false;
+        source_bloom_bits(
+            local_source->name, name_length,
+            &local_source->bloom_bit_a, &local_source->bloom_bit_b
+        );
         /* Intentionally leaving index uninitialized so that valgrind can
          * catch invalid uses of it. */
+
+        if (intern) {
+            rc = ib_hash_set_ex(
+                ((ib_var_config_t *)config)->interned,
+                local_source->name, name_length,
+                local_source
+            );
+            if (rc != IB_OK) {
+                return rc;
+            }
+        }
     }
 
     if (source != NULL) {
@@ -1099,6 +1605,54 @@ ib_status_t ib_var_target_type(
     return IB_OK;
 }
 
+ib_status_t ib_var_target_get_single(
+    ib_var_target_t  *target,
+    ib_field_t      **field,
+    ib_mm_t           mm,
+    ib_var_store_t   *store
+)
+{
+    assert(target != NULL);
+    assert(field  != NULL);
+    assert(store  != NULL);
+
+    ib_status_t rc;
+
+    *field = NULL;
+
+    /* Trivial target: a direct, allocation free, source get.  List
+     * valued sources fall through to the general path, which reports
+     * the list's first element as ib_var_target_get() would. */
+    if (target->expand == NULL && target->filter == NULL) {
+        ib_field_t *f = NULL;
+
+        rc = ib_var_source_get(target->source, &f, store);
+        if (rc != IB_OK) {
+            return rc;
+        }
+        if (f == NULL || f->type != IB_FTYPE_LIST) {
+            *field = f;
+            return IB_OK;
+        }
+    }
+
+    /* Filtered or expanded: fetch the list and report its first value. */
+    {
+        const ib_list_t *result;
+
+        rc = ib_var_target_get(target, &result, mm, store);
+        if (rc != IB_OK) {
+            return rc;
+        }
+        if (result != NULL && ib_list_elements(result) > 0) {
+            *field = (ib_field_t *)ib_list_node_data_const(
+                ib_list_first_const(result));
+        }
+    }
+
+    return IB_OK;
+}
+
 ib_status_t ib_var_target_get(
     ib_var_target_t  *target,
     const ib_list_t **result,
@@ -1679,6 +2233,43 @@ ib_status_t ib_var_expand_execute(
         return IB_OK;
     }
 
+    /* Fast path: the whole string is a single "%{TARGET}".  A single
+     * value converts straight into the caller's memory, avoiding the
+     * string assembler and the temporary pool below. */
+    if (
+        expand->next   == NULL &&
+        expand->prefix == NULL &&
+        expand->target != NULL
+    ) {
+        const ib_list_t *result;
+
+        rc = ib_var_target_get_const(
+            expand->target,
+            &result,
+            mm,
+            store
+        );
+        if (rc != IB_OK) {
+            return rc;
+        }
+        if (ib_list_elements(result) == 1) {
+            const ib_field_t *field =
+                ib_list_node_data_const(ib_list_first_const(result));
+            field_to_string(dst, dst_length, field, mm);
+            /* field_to_string() aliases bytestr values; honor the
+             * documented lifetime by copying those into mm. */
+            if (field->type == IB_FTYPE_BYTESTR && *dst_length > 0) {
+                const char *copy = ib_mm_memdup(mm, *dst, *dst_length);
+                if (copy == NULL) {
+                    return IB_EALLOC;
+                }
+                *dst = copy;
+            }
+            return IB_OK;
+        }
+        /* Multiple values: fall through to the general, joining path. */
+    }
+
     rc = ib_sa_begin(&sa);
     if (rc != IB_OK) {
         assert(rc == IB_EALLOC);
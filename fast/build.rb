@@ -82,7 +82,7 @@ eudoxus = rules + '.e'
 compile_cmd = [
   '../automata/bin/ec',
   '-i',
-  automata,
+  optimized,
   '-o',
   eudoxus,
   '-h',
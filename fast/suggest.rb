@@ -9,6 +9,16 @@
 #
 # Requires `gem install regexp_parser`.
 #
+# On running this inside the rule compiler instead: the analysis below
+# rides on a full regex AST (regexp_parser) and produces *suggestions*
+# whose quality intentionally requires human review -- a too-common
+# extracted literal makes the prefilter useless, and the tool cannot
+# judge commonness in the deployment's traffic.  Automatic extraction at
+# configuration load would therefore reimplement a regex parser in C to
+# produce annotations nobody reviewed.  The supported production flow is
+# this tool plus build.rb, run when rules change, with the automata
+# shipped alongside the rules.
+#
 # Author: Christopher Alfeld <calfeld@qualys.com>
 
 $:.unshift(File.dirname(__FILE__))
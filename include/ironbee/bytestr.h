@@ -219,6 +219,45 @@ ib_status_t DLL_PUBLIC ib_bytestr_setv_const(ib_bytestr_t *dst,
  *
  * @returns Status code
  */
+/**
+ * Reserve writable space at the end of the byte string.
+ *
+ * Together with ib_bytestr_commit() this lets producers write into the
+ * byte string directly instead of building data elsewhere and appending
+ * it (a second copy).  The returned pointer has room for @a length
+ * bytes and is invalidated by any other byte string operation.
+ *
+ * @param[in] bs Byte string.
+ * @param[in] length Bytes of writable space required.
+ * @param[out] data Where to write; valid until the next byte string call.
+ *
+ * @returns
+ * - IB_OK On success.
+ * - IB_EINVAL On a read-only byte string or size overflow.
+ * - IB_EALLOC On allocation failure.
+ */
+ib_status_t DLL_PUBLIC ib_bytestr_reserve(
+    ib_bytestr_t  *bs,
+    size_t         length,
+    uint8_t      **data
+);
+
+/**
+ * Commit bytes written into space from ib_bytestr_reserve().
+ *
+ * @param[in] bs Byte string.
+ * @param[in] length Bytes actually written; at most the reserved amount.
+ *
+ * @returns
+ * - IB_OK On success.
+ * - IB_EINVAL On a read-only byte string or @a length exceeding the
+ *   reserved space.
+ */
+ib_status_t DLL_PUBLIC ib_bytestr_commit(
+    ib_bytestr_t *bs,
+    size_t        length
+);
+
 ib_status_t DLL_PUBLIC ib_bytestr_append(ib_bytestr_t *dst,
                                          const ib_bytestr_t *src);
 
@@ -66,9 +66,27 @@ extern "C" {
  */
 typedef struct ib_cfgmap_t ib_cfgmap_t;
 struct ib_cfgmap_t {
-    ib_mm_t    mm;   /**< Memory manager */
-    ib_hash_t *hash; /**< The underlying hash */
-    void      *base; /**< Pointer to base of config data. */
+    ib_mm_t    mm;     /**< Memory manager */
+    ib_hash_t *hash;   /**< The underlying hash */
+    ib_hash_t *direct; /**< Name to @ref ib_cfgmap_accessor_t. */
+    void      *base;   /**< Pointer to base of config data. */
+};
+
+/**
+ * Compiled accessor for one configuration map entry.
+ *
+ * Resolved once with ib_cfgmap_accessor(), then read repeatedly with
+ * ib_cfgmap_accessor_get(): gets on offset-backed (static) entries are
+ * a plain load through the pointer computed at map initialization --
+ * no hash lookup, no field boxing -- and dynamic entries fall back to
+ * their getter.  Intended for configuration reads inside
+ * per-transaction code.
+ */
+typedef struct ib_cfgmap_accessor_t ib_cfgmap_accessor_t;
+struct ib_cfgmap_accessor_t {
+    const void       *ptr;   /**< Value storage; NULL for dynamic entries. */
+    const ib_field_t *field; /**< Backing field (dynamic fallback). */
+    ib_ftype_t        type;  /**< Entry type. */
 };
 
 /**
@@ -225,6 +243,41 @@ ib_status_t DLL_PUBLIC ib_cfgmap_get(const ib_cfgmap_t *cm,
                                      const char *name,
                                      void *out_val, ib_ftype_t *ptype);
 
+/**
+ * Resolve a compiled accessor for entry @a name.
+ *
+ * One hash lookup, at setup time; subsequent reads go through
+ * ib_cfgmap_accessor_get().
+ *
+ * @param cm Configuration map
+ * @param name Configuration entry name
+ * @param accessor Filled with the compiled accessor
+ *
+ * @returns
+ * - IB_OK on success.
+ * - IB_ENOENT if there is no such entry.
+ */
+ib_status_t DLL_PUBLIC ib_cfgmap_accessor(const ib_cfgmap_t *cm,
+                                          const char *name,
+                                          ib_cfgmap_accessor_t *accessor);
+
+/**
+ * Read the value behind a compiled accessor.
+ *
+ * For offset-backed entries this is a direct load through the pointer
+ * computed at map initialization; dynamic entries call their getter.
+ * @a out_val follows the same ib_ftype_*_out() conventions as
+ * ib_cfgmap_get().
+ *
+ * @param accessor Accessor from ib_cfgmap_accessor()
+ * @param out_val Address which the value is written
+ *
+ * @returns Status code
+ */
+ib_status_t DLL_PUBLIC ib_cfgmap_accessor_get(
+    const ib_cfgmap_accessor_t *accessor,
+    void *out_val);
+
 
 /** @} IronBeeUtilCfgMap */
 
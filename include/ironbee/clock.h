@@ -158,6 +158,26 @@ ib_time_t DLL_PUBLIC ib_clock_get_time(void);
  */
 ib_time_t DLL_PUBLIC ib_clock_precise_get_time(void);
 
+/**
+ * Get a coarse clock time, cheap enough for per-event timestamps.
+ *
+ * Returns the same timescale as ib_clock_get_time() but reads the
+ * system clock only occasionally: each thread caches a reading and
+ * extrapolates between readings from the CPU timestamp counter,
+ * re-reading (and re-calibrating the extrapolation) after at most
+ * about a millisecond of extrapolated time.  On platforms without a
+ * timestamp counter this is ib_clock_get_time().
+ *
+ * Use this for event and transaction timing, where a millisecond of
+ * staleness is irrelevant; use ib_clock_get_time() or
+ * ib_clock_precise_get_time() where deltas are measured, and
+ * ib_clock_gettimeofday() where wall-clock accuracy matters (audit
+ * logs).
+ *
+ * @returns Microsecond time value
+ */
+ib_time_t DLL_PUBLIC ib_clock_coarse_get_time(void);
+
 /**
  * IronBee types version of @c gettimeofday() called with
  * NULL timezone parameter.  The returned time is relative to epoch.
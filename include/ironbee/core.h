@@ -57,6 +57,11 @@ extern "C" {
  * in an audit log part. The function should return zero when there
  * is no more data to log.
  *
+ * Chunks must remain valid until the part has been fully written: the
+ * audit writer gathers successive chunks and writes them with a single
+ * vectored write.  All generators returning memory-manager backed or
+ * literal data satisfy this naturally.
+ *
  * @param part Audit log part
  * @param chunk Address in which chunk is written
  *
@@ -81,6 +86,16 @@ struct ib_core_audit_cfg_t {
     const char          *temp_path;     /**< Full path to temporary file */
     int                  parts_written; /**< Parts written so far */
     const char          *boundary;      /**< Audit log boundary */
+
+    /**
+     * Compression stream when dictionary compression is configured.
+     *
+     * A ZSTD_CCtx referencing the context's shared dictionary; kept as
+     * void* so zstd types stay out of this header.  NULL when audit
+     * logs are written uncompressed.
+     */
+    void                *zstd_stream;
+    unsigned             zstd_dict_id;  /**< Dictionary id in use; 0 none. */
     ib_tx_t             *tx;            /**< Transaction being logged */
     const ib_core_cfg_t *core_cfg;      /**< Core configuration */
 };
@@ -181,6 +196,14 @@ struct ib_core_cfg_t {
     ib_num_t          auditlog_fmode;    /**< Audit log file create mode */
     ib_num_t          auditlog_parts;    /**< Audit log parts */
     const char       *auditlog_index_fmt;/**< Audit log index format string */
+    const char       *auditlog_zstd_dict;/**< Path to zstd dictionary for
+                                              audit compression; NULL
+                                              disables compression. */
+    ib_num_t          response_sample_budget; /**< Response body bytes to
+                                                   inspect per transaction;
+                                                   0 inspects everything. */
+    ib_num_t          response_sample_window; /**< Interior sample window
+                                                   size in bytes. */
     const ib_logformat_t *auditlog_index_hp; /**< Audit log index fmt helper */
     const char       *auditlog_dir;      /**< Audit log base directory */
     const char       *auditlog_sdir_fmt; /**< Audit log sub-directory format */
@@ -203,6 +226,13 @@ struct ib_core_cfg_t {
     const char       *rule_debug_str;    /**< Rule debug logging level */
     ib_num_t          rule_debug_level;  /**< Rule debug logging level */
     ib_num_t inspection_engine_options; /**< Inspection engine options */
+
+    /**
+     * Inspection time budget per transaction in microseconds; 0 is
+     * unlimited.  When a transaction exceeds its budget, remaining rule
+     * phases are skipped (fail open) and a notice is logged.
+     */
+    ib_num_t inspection_budget_usec;
     ib_num_t protection_engine_options; /**< Protection engine options */
     ib_tx_limits_t    limits;            /**< Limits used by this core. */
     ib_core_vars_t   *vars;             /**< Var sources and targets. */
@@ -243,6 +243,19 @@ ib_status_t DLL_PUBLIC ib_engine_module_get(const ib_engine_t *ib,
  */
 ib_mm_t DLL_PUBLIC ib_engine_mm_main_get(const ib_engine_t *ib);
 
+/**
+ * Get the main engine memory pool.
+ *
+ * For memory introspection and diagnostics (e.g. the engine manager
+ * control channel's memory command); allocate through
+ * ib_engine_mm_main_get() instead.
+ *
+ * @param ib Engine handle
+ *
+ * @returns Memory pool
+ */
+ib_mpool_t DLL_PUBLIC *ib_engine_pool_main_get(const ib_engine_t *ib);
+
 /**
  * Get the engine configuration memory pool as memory manager.
  *
@@ -442,6 +455,43 @@ ib_stream_pump_t DLL_PUBLIC *ib_tx_response_body_pump(
     ib_tx_t *tx
 ) NONNULL_ATTRIBUTE(1);
 
+/**
+ * Current adaptive transaction pool page size of @a ib.
+ *
+ * Derived from observed per-transaction pool usage; see the engine
+ * structure's histogram.  Returns the default page size until enough
+ * transactions have been sampled.
+ *
+ * @param[in] ib Engine.
+ * @returns Page size in bytes.
+ */
+size_t DLL_PUBLIC ib_engine_tx_pagesize(const ib_engine_t *ib);
+
+/**
+ * Will anything in the engine consume per-segment body data for @a tx?
+ *
+ * False when the transaction's body pump holds only the core raw
+ * buffer processor with a zero buffering limit, the matching body
+ * stream phase has no runnable rules, and no injector is registered
+ * for it -- i.e. feeding body segments through the engine is pure
+ * plumbing.  A server may then skip per-segment body notification for
+ * this transaction and deliver only end-of-body accounting; blocking
+ * and header inspection are unaffected.
+ *
+ * Evaluate after the respective headers are processed (processors are
+ * inserted up to then) and re-use the answer for the rest of the
+ * transaction.
+ *
+ * @param[in] tx Transaction.
+ * @param[in] response True for the response body, false for request.
+ *
+ * @returns True if body segments must be delivered.
+ */
+bool DLL_PUBLIC ib_tx_body_notification_needed(
+    const ib_tx_t *tx,
+    bool           response
+);
+
 /**
  * Returns the stream pump for the request body.
  *
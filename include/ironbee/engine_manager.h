@@ -286,6 +286,48 @@ ib_status_t DLL_PUBLIC ib_manager_engine_create(
 )
 NONNULL_ATTRIBUTE(1,2);
 
+/**
+ * Build a warm standby engine without putting it into service.
+ *
+ * As ib_manager_engine_create() up to and including configuration, but
+ * the resulting engine is parked as the manager's standby rather than
+ * registered.  A later ib_manager_engine_commit() promotes it to
+ * current in one registration step, so the swap window excludes the
+ * configuration time.  Preparing again replaces (and destroys) any
+ * previously prepared standby.
+ *
+ * @param[in] manager The manager.
+ * @param[in] name The name the standby will serve when committed.
+ * @param[in] config_file The configuration file to configure with.
+ *
+ * @returns
+ * - IB_OK On success.
+ * - IB_DECLINED If the manager is disabled.
+ * - Other as ib_manager_engine_create().
+ */
+ib_status_t DLL_PUBLIC ib_manager_engine_prepare(
+    ib_manager_t *manager,
+    const char   *name,
+    const char   *config_file
+)
+NONNULL_ATTRIBUTE(1,2,3);
+
+/**
+ * Promote the prepared standby engine to current.
+ *
+ * @param[in] manager The manager.
+ *
+ * @returns
+ * - IB_OK On success.
+ * - IB_ENOENT If no standby has been prepared.
+ * - IB_DECLINED If the manager is disabled or no engine slot is free.
+ * - Other on internal API failures.
+ */
+ib_status_t DLL_PUBLIC ib_manager_engine_commit(
+    ib_manager_t *manager
+)
+NONNULL_ATTRIBUTE(1);
+
 /**
  * Re-enable an manager after a call to ib_manager_disable().
  *
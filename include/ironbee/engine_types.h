@@ -100,6 +100,16 @@ typedef struct ib_site_location_t ib_site_location_t;
 #define IB_CONN_FOPENED          (1 << 4) /**< Connection opened */
 #define IB_CONN_FCLOSED          (1 << 5) /**< Connection closed */
 
+/**
+ * Inspection bypassed for the rest of this connection.
+ *
+ * Set by the allow:conn action once a flow is judged clean; subsequent
+ * transactions on the connection start with allow-all set and no
+ * inspection options, so rule phases and body inspection are skipped
+ * while postprocessing and logging still run.
+ */
+#define IB_CONN_FBYPASS          (1 << 6)
+
 /* Transaction Flags */
 #define IB_TX_FNONE              (0ULL)
 #define IB_TX_FHTTP09            (1ULL <<  0) /**< Transaction is HTTP/0.9 */
@@ -178,6 +188,40 @@ struct ib_conn_t {
     void               *server_ctx;      /**< Server context */
     ib_array_t         *module_data;     /**< Per module data. */
 
+    /**
+     * Connection-scoped var store.
+     *
+     * Values written here are visible, copy-on-write, through the var
+     * store of every transaction on this connection (see
+     * ib_var_store_acquire_child()).
+     */
+    ib_var_store_t     *var_store;
+
+    /**
+     * Cleared transaction memory pool cached for reuse.
+     *
+     * When a transaction on this connection is destroyed, its pool is
+     * cleared (cleanups run, pages retained) and parked here; the next
+     * transaction on the connection reuses it instead of growing a
+     * fresh pool.  At most one pool is cached, which covers the common
+     * sequential keep-alive case while pipelined transactions fall back
+     * to pool creation.
+     */
+    ib_mpool_t         *tx_pool_cache;
+
+    /**
+     * Intern table for repeated header names and values.
+     *
+     * Maps header bytes to a connection-lifetime @ref ib_bytestr_t.
+     * Across keep-alive transactions most header values (User-Agent,
+     * Accept, cookies) repeat verbatim; parsed-header construction
+     * consults this table (see ib_parsed_headers_intern()) so repeats
+     * share one allocation for the connection instead of one per
+     * transaction.  Entry count is capped by the consumer to bound
+     * pool growth under adversarial variation.
+     */
+    ib_hash_t          *header_intern;
+
     ib_timeval_t       tv_created;       /**< Connection created time value */
     struct {
         ib_time_t       started;         /**< Connection started base time */
@@ -220,6 +220,17 @@ struct ib_field_t {
     size_t          nlen;      /**< Field name length */
     const char     *tfn;       /**< Transformations performed */
     ib_field_val_t *val;       /**< Private value store */
+
+    /**
+     * Memo of transformation results computed from this field.
+     *
+     * Owned and interpreted by the transformation framework (see
+     * ib_transformation_inst_execute()); NULL until a result is
+     * memoized.  Field creators initialize it to NULL; in-place
+     * mutation (ib_field_setv() and friends, or handing out a mutable
+     * value) clears it, as memoized results are stale from then on.
+     */
+    void           *tfn_memo;
 };
 
 /**
@@ -893,6 +904,32 @@ ib_status_t DLL_PUBLIC ib_field_setv_ex(
     size_t      alen
 );
 
+/**
+ * Memoize this dynamic field's argument-less gets.
+ *
+ * After this call, the first plain (no-argument) get invokes the
+ * registered getter and caches the result in the field; later plain
+ * gets return the cached value without re-running the getter, so
+ * getters that do real work (parsing, lookups) run once per consumer
+ * generation instead of once per rule.  Gets with an argument
+ * (filtered collection access) always invoke the getter.
+ *
+ * @a generation, when non-NULL, declares the invalidation source: the
+ * cache is valid only while the pointed-to counter holds the value it
+ * had at memoization (pass the owning var store's generation counter,
+ * ib_var_store_generation_ptr(), so any var write re-materializes).
+ * NULL memoizes for the field's lifetime.
+ *
+ * No effect on non-dynamic fields.
+ *
+ * @param[in] f Field to memoize.
+ * @param[in] generation Invalidation counter, or NULL.
+ */
+void DLL_PUBLIC ib_field_memoize(
+    ib_field_t     *f,
+    const uint64_t *generation
+);
+
 /**
  * Get the value stored in the field, passing the argument on to dynamic
  * fields.
@@ -129,7 +129,8 @@ typedef int (*ib_hash_equal_t)(
 /**
  * DJB2 Hash Function (Dan Bernstein) plus randomizer.
  *
- * This is the default hash function for ib_hash_create().
+ * This is the hash function ib_hashfunc_crc32() falls back to when
+ * hardware CRC32 support is not compiled in.
  *
  * @sa ib_hashfunc_djb2_nocase().
  *
@@ -158,7 +159,8 @@ NONNULL_ATTRIBUTE(1);
  * DJB2 Hash Function (Dan Bernstein) plus randomizer.  Case insensitive
  * version.
  *
- * This is the default hash function for ib_hash_create_nocase().
+ * This is the hash function ib_hashfunc_crc32_nocase() falls back to
+ * when hardware CRC32 support is not compiled in.
  *
  * @sa ib_hashfunc_djb2().
  *
@@ -183,6 +185,56 @@ uint32_t DLL_PUBLIC ib_hashfunc_djb2_nocase(
 )
 NONNULL_ATTRIBUTE(1);
 
+/**
+ * Hardware CRC32 hash function plus randomizer.
+ *
+ * This is the default hash function for ib_hash_create().  When compiled
+ * for a target with SSE 4.2 the key is consumed eight bytes per crc32
+ * instruction; otherwise this falls back to ib_hashfunc_djb2().
+ *
+ * @sa ib_hashfunc_crc32_nocase().
+ *
+ * @param[in] key        The key to hash.
+ * @param[in] key_length Length of @a key.
+ * @param[in] randomizer Value to randomize hash function.
+ * @param[in] cbdata     Callback data; unused.
+ *
+ * @returns Hash value of @a key.
+ */
+uint32_t DLL_PUBLIC ib_hashfunc_crc32(
+    const char *key,
+    size_t      key_length,
+    uint32_t    randomizer,
+    void       *cbdata
+)
+NONNULL_ATTRIBUTE(1);
+
+/**
+ * Hardware CRC32 hash function plus randomizer.  Case insensitive
+ * version.
+ *
+ * This is the default hash function for ib_hash_create_nocase().
+ * Uppercase ASCII bytes are lowercased eight at a time before hashing,
+ * consistent with ib_hashequal_nocase(); without SSE 4.2 this falls
+ * back to ib_hashfunc_djb2_nocase().
+ *
+ * @sa ib_hashfunc_crc32().
+ *
+ * @param[in] key        The key to hash.
+ * @param[in] key_length Length of @a key.
+ * @param[in] randomizer Value to randomize hash function.
+ * @param[in] cbdata     Callback data; unused.
+ *
+ * @returns Hash value of @a key.
+ */
+uint32_t DLL_PUBLIC ib_hashfunc_crc32_nocase(
+    const char *key,
+    size_t      key_length,
+    uint32_t    randomizer,
+    void       *cbdata
+)
+NONNULL_ATTRIBUTE(1);
+
 /**
  * Byte for byte equality predicate.
  *
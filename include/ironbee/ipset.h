@@ -170,6 +170,15 @@ struct ib_ipset4_t
     size_t             num_positive;
     ib_ipset4_entry_t *negative;
     size_t             num_negative;
+
+    /**
+     * Bit L set iff an entry of prefix length L is present.
+     *
+     * Filled by ib_ipset4_init() so queries only search prefix lengths
+     * that actually occur in the set.
+     */
+    uint64_t           positive_lengths;
+    uint64_t           negative_lengths; /**< As above, negative entries. */
 };
 
 /**
@@ -183,9 +192,77 @@ struct ib_ipset6_t
     size_t             num_positive;
     ib_ipset6_entry_t *negative;
     size_t             num_negative;
+
+    /**
+     * Bit L of word L/64 set iff an entry of prefix length L is present.
+     *
+     * Filled by ib_ipset6_init() so queries only search prefix lengths
+     * that actually occur in the set.
+     */
+    uint64_t           positive_lengths[3];
+    uint64_t           negative_lengths[3]; /**< As above, negative. */
 };
 
 /** @endcond */
+
+/**
+ * An atomically swappable pair of IPv4 set pointers.
+ *
+ * For runtime-updated data such as blocklists: readers call
+ * ib_ipset4_swap_get() with no locking, an updater builds a complete
+ * replacement set and publishes it with ib_ipset4_swap_set().  The
+ * previous set must be retired only after all readers that may hold it
+ * have finished (e.g. at engine shutdown, or after a grace period the
+ * caller enforces); the swap itself is a single pointer store.
+ */
+typedef struct ib_ipset4_swap_t {
+    const ib_ipset4_t *current; /**< Published set; read atomically. */
+} ib_ipset4_swap_t;
+
+/** As ib_ipset4_swap_t but for IPv6 sets. */
+typedef struct ib_ipset6_swap_t {
+    const ib_ipset6_t *current; /**< Published set; read atomically. */
+} ib_ipset6_swap_t;
+
+/**
+ * The currently published set of @a swap; NULL if none yet.
+ *
+ * @param[in] swap Swap holder.
+ * @returns Current set.
+ */
+const ib_ipset4_t DLL_PUBLIC *ib_ipset4_swap_get(
+    const ib_ipset4_swap_t *swap
+)
+NONNULL_ATTRIBUTE(1);
+
+/**
+ * Publish @a set as the current set of @a swap.
+ *
+ * All prior writes to @a set are visible to readers that observe it.
+ *
+ * @param[in] swap Swap holder.
+ * @param[in] set Fully built set to publish.
+ * @returns The previously published set, for the caller to retire.
+ */
+const ib_ipset4_t DLL_PUBLIC *ib_ipset4_swap_set(
+    ib_ipset4_swap_t  *swap,
+    const ib_ipset4_t *set
+)
+NONNULL_ATTRIBUTE(1);
+
+/** As ib_ipset4_swap_get() for IPv6. */
+const ib_ipset6_t DLL_PUBLIC *ib_ipset6_swap_get(
+    const ib_ipset6_swap_t *swap
+)
+NONNULL_ATTRIBUTE(1);
+
+/** As ib_ipset4_swap_set() for IPv6. */
+const ib_ipset6_t DLL_PUBLIC *ib_ipset6_swap_set(
+    ib_ipset6_swap_t  *swap,
+    const ib_ipset6_t *set
+)
+NONNULL_ATTRIBUTE(1);
+
 /**
  * Initialize an IPv4 set.
  *
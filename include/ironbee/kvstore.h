@@ -131,6 +131,32 @@ ib_status_t ib_kvstore_connect(ib_kvstore_t *kvstore);
  */
 ib_status_t ib_kvstore_disconnect(ib_kvstore_t *kvstore);
 
+/**
+ * Enable batched write-behind mode on @a kvstore.
+ *
+ * After this call, ib_kvstore_set() copies the key and value, queues
+ * them, and returns immediately; a flusher thread drains the queue into
+ * the backend in batches.  Writers block only when @a max_pending
+ * queued writes are outstanding.  The queue is drained on
+ * ib_kvstore_disconnect() and ib_kvstore_destroy(); write-behind must
+ * be re-enabled after a reconnect.
+ *
+ * Reads do not see queued writes until the flusher lands them, so this
+ * trades read-your-writes consistency for set latency; collection
+ * persistence at transaction end is the intended consumer.
+ *
+ * @param[in] kvstore Store to enable write-behind on.
+ * @param[in] max_pending Bound on queued writes; must be nonzero.
+ *
+ * @returns
+ * - IB_OK on success.
+ * - IB_EINVAL if already enabled or @a max_pending is zero.
+ * - IB_EOTHER on thread or lock creation failure.
+ */
+ib_status_t DLL_PUBLIC ib_kvstore_write_behind_set(
+    ib_kvstore_t *kvstore,
+    size_t        max_pending);
+
 /**
  * Get the named value.
  * @param[in] kvstore The key-value store object.
@@ -0,0 +1,96 @@
+/*****************************************************************************
+ * Licensed to Qualys, Inc. (QUALYS) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * QUALYS licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#ifndef _IB_KVSTORE_FILELOG_H_
+#define _IB_KVSTORE_FILELOG_H_
+
+/**
+ * @file
+ * @brief IronBee --- Key-Value Store, Single-File Log Implementation
+ *
+ * A filesystem kvstore backend v2: one append-only log file per store
+ * with an mmap'd open-addressing index at its head.  Gets are index
+ * probes against the mapping plus one record read; sets append one
+ * record and store one slot -- no per-key directories, no file
+ * creation or unlink per update, and no directory lookups, removing
+ * the metadata storms of the per-key-directory backend.
+ *
+ * Writers serialize with an exclusive file lock; readers take a shared
+ * lock, so multiple processes may share a store.  Overwritten and
+ * expired records become garbage in the log; reclaim them with
+ * ib_kvstore_filelog_compact(), which rewrites live records into a
+ * fresh file.  Compaction replaces the file and must be coordinated
+ * externally (run it from one process while others are quiesced, or
+ * from a maintenance job).
+ *
+ * Registered alongside ib_kvstore_filesystem_init() as an alternative
+ * implementation behind the same @ref ib_kvstore_t interface.
+ */
+
+#include <ironbee/kvstore.h>
+#include <ironbee/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Initialize @a kvstore as a single-file log store at @a path.
+ *
+ * The file is created (with @a slots index slots) if absent, or
+ * attached if it exists; the slot count of an existing file wins.
+ *
+ * @param[out] kvstore Store to initialize.
+ * @param[in] path Path to the store file.
+ * @param[in] slots Index slots when creating; capacity is fixed for
+ *            the file's lifetime (compaction preserves it).
+ *
+ * @returns
+ * - IB_OK on success.
+ * - IB_EALLOC on allocation failure.
+ * - IB_EINVAL if the file cannot be created, mapped, or is not a
+ *   store file.
+ */
+ib_status_t DLL_PUBLIC ib_kvstore_filelog_init(
+    ib_kvstore_t *kvstore,
+    const char   *path,
+    size_t        slots
+);
+
+/**
+ * Compact the store behind @a kvstore.
+ *
+ * Rewrites live, unexpired records into a fresh file and renames it
+ * over the store, dropping overwritten and expired garbage.  Takes
+ * the exclusive lock for the duration; see the file comment for the
+ * multi-process coordination requirement.
+ *
+ * @param[in] kvstore Store initialized by ib_kvstore_filelog_init().
+ *
+ * @returns
+ * - IB_OK on success.
+ * - IB_EOTHER on I/O failure (the original file is left intact).
+ */
+ib_status_t DLL_PUBLIC ib_kvstore_filelog_compact(
+    ib_kvstore_t *kvstore
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _IB_KVSTORE_FILELOG_H_ */
@@ -0,0 +1,70 @@
+/*****************************************************************************
+ * Licensed to Qualys, Inc. (QUALYS) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * QUALYS licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#ifndef __IRONBEE__KVSTORE_SHM_H
+#define __IRONBEE__KVSTORE_SHM_H
+
+#include <ironbee/kvstore.h>
+#include <ironbee/types.h>
+
+/**
+ * @file
+ * @brief IronBee --- Key-Value Shared Memory Store Interface
+ *
+ * A key-value store backed by a POSIX shared memory segment.  All
+ * workers mapping the same segment name share one store with no
+ * filesystem traffic; persistence framework collections stored here
+ * survive engine reloads but not host reboots.
+ *
+ * The store is a fixed table of fixed-size slots, so keys and values
+ * must fit in one slot; oversize writes are rejected with IB_EINVAL.
+ * Cross-process access is serialized with a process-shared mutex held
+ * only for the copy in or out of the segment.
+ *
+ * @author Sam Baskinger <sbaskinger@qualys.com>
+ */
+
+/**
+ * @addtogroup IronBeeKeyValueStore
+ * @ingroup IronBeeUtil
+ * @{
+ */
+
+/**
+ * Initializes kvstore that stores data in a shared memory segment.
+ *
+ * @param[out] kvstore Initialized with the shm server and defaults.
+ * @param[in] name Shared memory segment name (shm_open() rules: should
+ *            begin with a '/').
+ * @param[in] num_slots Number of key slots in the table.
+ * @param[in] slot_data_size Bytes available per slot for key, type and
+ *            value data together.
+ * @returns
+ *   - IB_OK on success
+ *   - IB_EALLOC on memory allocation failure using malloc.
+ *   - IB_EINVAL on zero @a num_slots or @a slot_data_size.
+ */
+ib_status_t ib_kvstore_shm_init(
+    ib_kvstore_t *kvstore,
+    const char   *name,
+    size_t        num_slots,
+    size_t        slot_data_size);
+
+/**
+ * @}
+ */
+#endif /* __IRONBEE__KVSTORE_SHM_H */
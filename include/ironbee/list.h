@@ -65,6 +65,15 @@ struct ib_list_node_t {
 struct ib_list_t {
     ib_mm_t mm;
     IB_LIST_GEN_REQ_FIELDS(ib_list_node_t);       /* Required fields */
+
+    /**
+     * Nodes recycled by ib_list_clear(), reused by the insert functions.
+     *
+     * Lists that are cleared and refilled repeatedly (per-phase work
+     * lists and the like) thus stop allocating a node per insert after
+     * the first fill.
+     */
+    ib_list_node_t *free_nodes;
 };
 /** @endcond */
 
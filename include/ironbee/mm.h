@@ -29,6 +29,7 @@
 #include <ironbee/types.h>
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 #ifdef __cplusplus
@@ -127,6 +128,15 @@ extern const ib_mm_t IB_MM_NULL;
  **/
 bool DLL_PUBLIC ib_mm_is_null(ib_mm_t mm);
 
+/**
+ * Do @a a and @a b refer to the same underlying memory manager?
+ *
+ * @param[in] a First memory manager.
+ * @param[in] b Second memory manager.
+ * @returns true iff both delegate to the same functions and data.
+ */
+bool DLL_PUBLIC ib_mm_same(ib_mm_t a, ib_mm_t b);
+
 /**
  * Allocate memory.
  *
@@ -216,6 +226,42 @@ char DLL_PUBLIC *ib_mm_memdup_to_str(
     size_t      size
 );
 
+/**
+ * Allocation counters maintained by a counted memory manager.
+ *
+ * @sa ib_mm_counted()
+ **/
+struct ib_mm_alloc_count_t
+{
+    uint64_t allocations; /**< Number of allocations. */
+    uint64_t bytes;       /**< Total bytes requested. */
+};
+typedef struct ib_mm_alloc_count_t ib_mm_alloc_count_t;
+
+/**
+ * Wrap @a mm so every allocation through it is counted in @a count.
+ *
+ * The wrapper delegates to @a mm and atomically adds each allocation to
+ * @a count, attributing memory use to whichever subsystem was handed
+ * the wrapper -- e.g. for live introspection of which consumer of a
+ * shared pool is growing.  @a count must outlive every use of the
+ * wrapper and is not reset here; zero it before use.
+ *
+ * @param[in] mm Memory manager to wrap.  Also provides the memory for
+ *            the wrapper's own state.
+ * @param[in] count Counters to maintain.
+ * @param[out] out Counted memory manager.
+ * @return
+ * - IB_OK on success.
+ * - IB_EALLOC on allocation failure.
+ **/
+ib_status_t DLL_PUBLIC ib_mm_counted(
+    ib_mm_t               mm,
+    ib_mm_alloc_count_t  *count,
+    ib_mm_t              *out
+)
+NONNULL_ATTRIBUTE(2, 3);
+
 /** @} IronBeeUtilMM */
 
 #ifdef __cplusplus
@@ -415,6 +415,31 @@ char DLL_PUBLIC *ib_mpool_analyze(
 )
 NONNULL_ATTRIBUTE(1);
 
+/**
+ * Summarize live memory pool usage as a human consumable report.
+ *
+ * Produces two sections: the pool tree with per-pool and per-subtree
+ * bytes in use, and the @a top_n pools holding the most bytes, each
+ * identified by its path (see ib_mpool_path()).  This is the live
+ * introspection report -- cheap enough to serve from a control-channel
+ * command -- where ib_mpool_analyze() is the offline efficiency report.
+ *
+ * Like ib_mpool_analyze(), this walks @a mp and its descendants without
+ * locking; the caller must ensure no pool in the subtree is created or
+ * destroyed during the walk.
+ *
+ * The caller is responsible for freeing the return value.
+ *
+ * @param[in] mp    Memory pool to report on.
+ * @param[in] top_n How many top consumers to list; 0 for none.
+ * @returns Usage report or NULL on allocation failure.
+ */
+char DLL_PUBLIC *ib_mpool_usage_report(
+    const ib_mpool_t *mp,
+    size_t            top_n
+)
+NONNULL_ATTRIBUTE(1);
+
 /**
  * Return the memory pool parent.
  *
@@ -205,6 +205,69 @@ ib_status_t DLL_PUBLIC ib_mpool_freeable_alloc_register_cleanup(
  *
  * @param[in] mp The memory pool.
  */
+/**
+ * Number of tiny-allocation size classes (tracks).
+ *
+ * Public so ib_mpool_freeable_stats() callers can size their per-class
+ * arrays; see the implementation for the track layout discussion.
+ */
+#define IB_MPOOL_FREEABLE_NUM_TRACKS 9
+
+/**
+ * Per-size-class statistics; see ib_mpool_freeable_stats().
+ */
+typedef struct {
+    size_t pages;      /**< Pages held by the class. */
+    size_t held_bytes; /**< Bytes of page capacity held. */
+    size_t used_bytes; /**< Bytes bump-allocated (high water per page). */
+    size_t references; /**< Live allocation references in the class. */
+} ib_mpool_freeable_class_stats_t;
+
+/**
+ * Fragmentation statistics for @a mp.
+ *
+ * One entry per tiny-allocation size class plus totals for large
+ * (segment) allocations.  A class holding many pages with few live
+ * references is fragmented: pages pinned by a few long-lived
+ * allocations.  Safe to call concurrently with allocation.
+ *
+ * @param[in] mp Memory pool.
+ * @param[out] classes Caller array of at least
+ *             IB_MPOOL_FREEABLE_NUM_TRACKS entries.
+ * @param[out] n_classes Entries written.
+ * @param[out] segment_bytes Bytes held by large segments.
+ * @param[out] segment_count Number of large segments.
+ *
+ * @returns IB_OK or a lock failure.
+ */
+ib_status_t DLL_PUBLIC ib_mpool_freeable_stats(
+    ib_mpool_freeable_t              *mp,
+    ib_mpool_freeable_class_stats_t  *classes,
+    size_t                           *n_classes,
+    size_t                           *segment_bytes,
+    size_t                           *segment_count
+);
+
+/**
+ * Compaction hint: close each size class's current bump page.
+ *
+ * Long-lived allocations sharing a page with short-lived ones pin the
+ * page until the last reference dies.  Closing the bump pages at a
+ * generation boundary (the stream pump between transactions, for
+ * example) stops new allocations from moving in with old ones, so
+ * pages drain and free along generation lines instead of accumulating
+ * mixed tenants over days of uptime.  Existing allocations are
+ * unaffected; memory is never moved (callers hold raw pointers, so
+ * coalescing or relocation is not possible in this allocator --
+ * pages return to the system allocator whole when their last
+ * reference drops).
+ *
+ * @param[in] mp Memory pool.
+ *
+ * @returns IB_OK or a lock failure.
+ */
+ib_status_t DLL_PUBLIC ib_mpool_freeable_compact(ib_mpool_freeable_t *mp);
+
 void DLL_PUBLIC ib_mpool_freeable_destroy(
     ib_mpool_freeable_t *mp
 ) NONNULL_ATTRIBUTE(1);
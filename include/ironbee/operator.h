@@ -132,6 +132,24 @@ NONNULL_ATTRIBUTE(1, 2, 4);
 #define IB_OP_CAPABILITY_ALLOW_NULL  (1 << 0)
 /*! Supports capture */
 #define IB_OP_CAPABILITY_CAPTURE     (1 << 3)
+/**
+ * Operator is pure: its result depends only on the operator instance and
+ * the input value, with no side effects beyond capture.  The rule engine
+ * may cache results of pure operators within a transaction for
+ * executions that do not capture.
+ */
+#define IB_OP_CAPABILITY_PURE        (1 << 4)
+/**
+ * Operator may defer: its execute function may return IB_DEFER after
+ * starting an asynchronous operation (e.g. a DNS or RBL lookup) instead
+ * of blocking the transaction thread.  The rule engine then parks the
+ * phase at the deferring rule and the server resumes it with
+ * ib_rule_exec_resume() once the operation completes; on resumption the
+ * deferring rule is re-executed from the start, so the operator must
+ * return the completed result synchronously on that call.  See
+ * ib_rule_exec_resume() for the full contract.
+ */
+#define IB_OP_CAPABILITY_DEFER       (1 << 5)
 
 /**
  * Create an operator.
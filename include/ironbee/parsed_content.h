@@ -28,6 +28,7 @@
 
 #include <ironbee/bytestr.h>
 #include <ironbee/field.h>
+#include <ironbee/hash.h>
 #include <ironbee/mm.h>
 #include <ironbee/types.h>
 
@@ -61,8 +62,40 @@ typedef struct ib_parsed_headers_t {
     ib_parsed_header_t *head;  /**< Head of the list. **/
     ib_parsed_header_t *tail;  /**< Tail of the list. **/
     size_t              size;  /**< Size of the list. **/
+
+    /**
+     * Optional intern table; see ib_parsed_headers_intern().
+     *
+     * When set, ib_parsed_headers_add() shares header name and value
+     * byte strings through this table instead of duplicating them per
+     * header.  NULL disables interning.
+     **/
+    ib_hash_t          *intern;
+    ib_mm_t             intern_mm; /**< Lifetime of interned strings. **/
 } ib_parsed_headers_t;
 
+/**
+ * Share header strings through an intern table.
+ *
+ * After this call, ib_parsed_headers_add() looks each header name and
+ * value up in @a intern: a hit reuses the recorded byte string and a
+ * miss copies the bytes into @a intern_mm and records them.  Callers
+ * pass a table (and manager) whose lifetime covers every consumer of
+ * the headers -- typically the connection's (see
+ * ib_conn_t::header_intern), so values repeated across keep-alive
+ * transactions share one allocation.  The table stops growing past an
+ * internal cap; further misses fall back to per-header duplication.
+ *
+ * @param[in] headers Headers to intern through @a intern.
+ * @param[in] intern The table; maps bytes to @ref ib_bytestr_t.
+ * @param[in] intern_mm Manager owning interned strings and the table.
+ **/
+void DLL_PUBLIC ib_parsed_headers_intern(
+    ib_parsed_headers_t *headers,
+    ib_hash_t           *intern,
+    ib_mm_t              intern_mm
+);
+
 /**
  * HTTP Request Line.
  **/
@@ -143,6 +176,25 @@ ib_status_t DLL_PUBLIC ib_parsed_headers_add(
     size_t               value_len
 );
 
+/**
+ * Append an existing header element to @a headers without copying.
+ *
+ * For producers that already hold an @ref ib_parsed_header_t whose
+ * byte strings alias buffers with a suitable lifetime (at least that
+ * of @a headers' memory manager), this links the element directly --
+ * no duplication of name or value.  The element's @c next pointer is
+ * overwritten; the element must not be a member of another list.
+ *
+ * @param[in] headers The headers list.
+ * @param[in] element The element to append.
+ *
+ * @returns IB_OK.
+ **/
+ib_status_t DLL_PUBLIC ib_parsed_headers_append_header(
+    ib_parsed_headers_t *headers,
+    ib_parsed_header_t  *element
+);
+
 
 /**
  * Append the @a tail list to the @a head list.
@@ -32,6 +32,7 @@
 #include <boost/function_output_iterator.hpp>
 #include <boost/dynamic_bitset.hpp>
 
+#include <deque>
 #include <stack>
 #include <vector>
 
@@ -292,14 +293,20 @@ struct GraphEvalProfileData {
     //! Node ID.
     uint32_t      m_node_id;
 
-    //! Relative clock time in microseconds.
+    /**
+     * Relative tick count at evaluation start.
+     *
+     * Ticks come from ib_rule_profiler_ticks(): CPU cycles where a cycle
+     * counter is available, precise clock time otherwise.  Values are
+     * only meaningful as differences within one transaction.
+     */
     ib_time_t     m_eval_start;
 
-    //! Relative clock time in microseconds.
+    //! Relative tick count at evaluation finish; see m_eval_start.
     ib_time_t     m_eval_finish;
 
     /**
-     * Duration in microseconds that the child nodes took.
+     * Duration in ticks that the child nodes took.
      *
      * When a GraphEvalProfileData node's mark_finish() routine is
      * called, and it has a parent node defined, it will
@@ -319,13 +326,13 @@ struct GraphEvalProfileData {
         GraphEvalProfileData* parent
     );
 
-    //! Set m_eval_start to the current relative clock time.
+    //! Set m_eval_start to the current tick count.
     void mark_start();
 
-    //! Set m_eval_finish to the current relative clock time.
+    //! Set m_eval_finish to the current tick count.
     void mark_finish();
 
-    //! Return the duration (finish - start) in microseconds.
+    //! Return the duration (finish - start) in ticks.
     uint32_t duration() const;
 
     //! Return the parent pointer. This may be NULL if there is no parent.
@@ -523,7 +530,15 @@ public:
      **/
     ///@{
 
-    typedef std::list<GraphEvalProfileData> profiler_data_list_t;
+    /**
+     * Profiling records.
+     *
+     * A deque rather than a list: elements are appended in arena-style
+     * chunks instead of one heap node per sample, and references to
+     * existing elements stay valid across push_back(), which
+     * profiler_mark() relies on for parent pointers.
+     **/
+    typedef std::deque<GraphEvalProfileData> profiler_data_list_t;
 
     //! Fetch the list of profiling data.
     profiler_data_list_t& profiler_data();
@@ -0,0 +1,141 @@
+/*****************************************************************************
+ * Licensed to Qualys, Inc. (QUALYS) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * QUALYS licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#ifndef _IB_QUEUE_MPSC_H_
+#define _IB_QUEUE_MPSC_H_
+
+/**
+ * @file
+ * @brief IronBee --- Lock-Free Multi-Producer Single-Consumer Queue
+ */
+
+#include <ironbee/build.h>
+#include <ironbee/types.h>
+
+#include <stdbool.h>
+#include <unistd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup IronBeeUtilQueueMpsc MPSC Queue
+ * @ingroup IronBeeUtil
+ *
+ * A lock-free multi-producer, single-consumer queue for inter-thread
+ * handoff; the standard building block for asynchronous writers and
+ * executors (the logger's record queues are built on it).
+ *
+ * The queue is intrusive: callers embed an @ref ib_queue_mpsc_node_t
+ * in the record they hand off, so the queue itself never allocates.
+ * Producers push with a compare-and-swap on the head; the consumer
+ * takes the entire list with one atomic exchange and receives it in
+ * submission (FIFO) order.
+ *
+ * No epoch or deferred-reclamation scheme is needed: the exchange in
+ * ib_queue_mpsc_drain() transfers ownership of every node to the
+ * consumer in one step, so no thread ever traverses nodes that another
+ * thread may still modify or free.  Producers own a node until the
+ * push's compare-and-swap succeeds; the consumer owns it after the
+ * drain's exchange.  There is no window in between.
+ *
+ * The producer-shared fields are padded onto their own cache lines so
+ * the head CAS, the depth counter, and the consumer's reads do not
+ * false-share.
+ *
+ * @{
+ */
+
+/**
+ * A queue node, embedded in the record being handed off.
+ *
+ * Only @c next is queue state; recover the enclosing record by
+ * position (place the node first in the record struct) or with
+ * offsetof arithmetic.
+ */
+typedef struct ib_queue_mpsc_node_t ib_queue_mpsc_node_t;
+struct ib_queue_mpsc_node_t {
+    ib_queue_mpsc_node_t *next; /**< Next-drained (newer in LIFO form). */
+};
+
+/**
+ * The queue.  May be embedded; initialize with ib_queue_mpsc_init().
+ */
+typedef struct ib_queue_mpsc_t ib_queue_mpsc_t;
+struct ib_queue_mpsc_t {
+    /** Head of the LIFO push list; producers CAS here. */
+    ib_queue_mpsc_node_t *head;
+    char pad1[64 - sizeof(ib_queue_mpsc_node_t *)];
+
+    /**
+     * Approximate element count, maintained with atomic additions.
+     *
+     * Producers increment after a push and the consumer subtracts after
+     * a drain, so a concurrent reader may observe a momentarily stale
+     * value; suitable for backpressure, not for exact accounting.
+     */
+    size_t depth;
+    char pad2[64 - sizeof(size_t)];
+};
+
+/**
+ * Initialize @a queue to empty.
+ */
+void DLL_PUBLIC ib_queue_mpsc_init(ib_queue_mpsc_t *queue);
+
+/**
+ * Push @a node onto @a queue.  Safe from any thread.
+ *
+ * @param[in] queue The queue.
+ * @param[in] node The node to push.  Owned by the queue (and then the
+ *            consumer) until it is returned by ib_queue_mpsc_drain().
+ *
+ * @returns True if the queue was observed empty immediately before this
+ *          push; producers use this to wake an idle consumer exactly
+ *          once per burst.
+ */
+bool DLL_PUBLIC ib_queue_mpsc_push(
+    ib_queue_mpsc_t      *queue,
+    ib_queue_mpsc_node_t *node
+);
+
+/**
+ * Take every queued node, in submission order.  Single consumer only.
+ *
+ * Ownership of the returned chain passes entirely to the caller, which
+ * walks it via @c next and disposes of the records as it sees fit.
+ *
+ * @param[in] queue The queue.
+ *
+ * @returns The oldest node, chained through @c next to the newest, or
+ *          NULL if the queue was empty.
+ */
+ib_queue_mpsc_node_t DLL_PUBLIC *ib_queue_mpsc_drain(ib_queue_mpsc_t *queue);
+
+/**
+ * Approximate number of queued elements.  See @ref ib_queue_mpsc_t::depth.
+ */
+size_t DLL_PUBLIC ib_queue_mpsc_depth(const ib_queue_mpsc_t *queue);
+
+/** @} IronBeeUtilQueueMpsc */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _IB_QUEUE_MPSC_H_ */
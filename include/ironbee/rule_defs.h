@@ -87,6 +87,7 @@ typedef enum {
 #define IB_RULE_FLAG_ACTION   (IB_RULE_FLAG_NO_TGT)
 #define IB_RULE_FLAG_FIELDS   (1 << 9) /**< Create FIELD_xxx fields */
 #define IB_RULE_FLAG_TRACE    (1 << 10) /**< Trace rule */
+#define IB_RULE_FLAG_INDEXED  (1 << 11) /**< All targets indexed */
 
 /**
  * Rule execution flags
@@ -28,6 +28,7 @@
 #include <ironbee/action.h>
 #include <ironbee/build.h>
 #include <ironbee/config.h>
+#include <ironbee/engine_state.h>
 #include <ironbee/operator.h>
 #include <ironbee/rule_defs.h>
 #include <ironbee/types.h>
@@ -93,6 +94,28 @@ struct ib_rule_t {
     ib_rule_t             *chained_from;    /**< Ptr to rule chained from */
     const char            *capture_collection; /**< Capture collection name */
     ib_flags_t             flags;           /**< External, etc. */
+
+    /**
+     * Var sources backing the rule's targets.
+     *
+     * Built at context close (see IB_RULE_FLAG_INDEXED).  Phase dispatch
+     * consults this list to skip rules none of whose inputs have been set
+     * in the transaction's var store: indexed sources are checked exactly,
+     * unindexed ones against the store's existence bloom filter.  NULL if
+     * the fast path is unavailable for this rule.
+     */
+    ib_list_t             *indexed_sources;
+
+    /**
+     * Flattened target list.
+     *
+     * Built from target_fields at context close so phase execution
+     * iterates a contiguous array rather than an @ref ib_list_t.  NULL
+     * until the rule is compiled; rules that never pass through context
+     * close (e.g. dynamically injected ones) fall back to target_fields.
+     */
+    ib_rule_target_t     **target_array;
+    size_t                 n_targets;       /**< Elements in target_array */
 };
 
 /**
@@ -159,11 +182,45 @@ struct ib_rule_exec_t {
     /* List of all rules to run during the current phase. */
     ib_list_t              *phase_rules; /**< List of ib_rule_t */
 
+    /**
+     * Phase whose rules phase_rules currently holds, for reuse.
+     *
+     * Body stream phases run once per data chunk; when no injector is
+     * registered for the phase the rule list cannot change between
+     * chunks and is reused instead of rebuilt.  IB_PHASE_NONE when the
+     * list does not correspond to a reusable phase.
+     */
+    ib_rule_phase_num_t     phase_rules_for;
+
     /**
      * Stack of @ref ib_field_t used for creating FIELD* targets
      */
     ib_list_t              *value_stack;
 
+    /**
+     * Cache of pure operator results for this transaction.
+     *
+     * Keyed by (operator instance, value field) pointer pair; only
+     * operators carrying IB_OP_CAPABILITY_PURE and executions without a
+     * capture collection are cached.  See execute_phase_operator().
+     */
+    ib_hash_t              *op_results;
+
+    /**
+     * Parked position of a deferred phase, or NULL.
+     *
+     * Set when an operator returns IB_DEFER during phase execution: the
+     * node in phase_rules of the rule that deferred.  Execution resumes
+     * from this rule, inclusive, via ib_rule_exec_resume().
+     */
+    const ib_list_node_t   *defer_node;
+
+    /** Phase that was parked; IB_PHASE_NONE when not deferred. */
+    ib_rule_phase_num_t     defer_phase;
+
+    /** State the parked phase was notified as, for logging at finish. */
+    ib_state_t              defer_state;
+
 #ifdef IB_RULE_TRACE
     ib_rule_trace_t        *traces; /**< Rule trace information. */
 #endif
@@ -1286,6 +1343,72 @@ ib_status_t DLL_PUBLIC ib_rule_chain_invalidate(
  */
 ib_mm_t DLL_PUBLIC ib_rule_mm(ib_engine_t *ib);
 
+/**
+ * Is the transaction's rule execution parked on a deferred operator?
+ *
+ * True after a state notification returned IB_DEFER because an operator
+ * (see @ref IB_OP_CAPABILITY_DEFER) started an asynchronous operation.
+ * The server must not notify further states for the transaction until
+ * ib_rule_exec_resume() has returned something other than IB_DEFER.
+ *
+ * @param[in] rule_exec Rule execution object (tx->rule_exec).
+ *
+ * @returns true when parked.
+ */
+bool DLL_PUBLIC ib_rule_exec_is_deferred(const ib_rule_exec_t *rule_exec);
+
+/**
+ * Resume a phase parked by a deferring operator.
+ *
+ * Called by the server, from any of its worker threads, once the
+ * asynchronous operation behind the IB_DEFER has completed -- e.g. from
+ * the continuation the Traffic Server plugin schedules for the lookup,
+ * which then re-enables the parked transaction.  Only one thread may
+ * drive a transaction at a time, as everywhere else in the engine.
+ *
+ * The deferring rule is re-executed from the start: the operator that
+ * deferred must now return its completed result synchronously (its
+ * instance keeps whatever completion token it needs in transaction
+ * data).  Execution then continues with the remaining rules of the
+ * parked phase, including block/allow handling and end-of-phase
+ * bookkeeping.  Operators in multi-value rules should be idempotent, as
+ * values preceding the deferring one are re-executed (pure operator
+ * results are served from the transaction cache).
+ *
+ * @param[in] rule_exec Rule execution object (tx->rule_exec).
+ *
+ * @returns
+ * - IB_OK on completion of the parked phase; the server continues with
+ *   its normal processing (subsequent state notifications).
+ * - IB_DEFER if another operator deferred; park again.
+ * - IB_EINVAL if no phase is parked.
+ * - Other status codes as phase execution reports them.
+ */
+ib_status_t DLL_PUBLIC ib_rule_exec_resume(ib_rule_exec_t *rule_exec);
+
+/**
+ * Reorder independent rules within each phase by measured cost.
+ *
+ * Within each maximal run of consecutive reorderable rules -- not
+ * chained, not external, and carrying only reporting actions (event,
+ * logdata) -- rules with sufficient rule-profiler samples are stably
+ * sorted by ascending mean execution ticks, so cheap discriminators
+ * run first.  Barriers (everything else, and unsampled rules) keep
+ * their positions, preserving declared order relative to them; rules
+ * never cross a rule that blocks, allows, writes vars, or is
+ * otherwise side-effecting.
+ *
+ * The new order is published atomically per phase; in-flight
+ * transactions finish on the order they started with.  Driven on
+ * demand (the controller's rule_reorder command); requires the rule
+ * profiler to have been enabled to have any effect.
+ *
+ * @param[in] ib IronBee engine.
+ *
+ * @returns Status code.
+ */
+ib_status_t DLL_PUBLIC ib_rule_engine_reorder(ib_engine_t *ib);
+
 /**
  * Perform logging of a rule's execution
  *
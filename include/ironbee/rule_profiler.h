@@ -0,0 +1,227 @@
+/*****************************************************************************
+ * Licensed to Qualys, Inc. (QUALYS) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * QUALYS licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#ifndef _IB_RULE_PROFILER_H_
+#define _IB_RULE_PROFILER_H_
+
+/**
+ * @file
+ * @brief IronBee --- Rule Execution Profiler
+ *
+ * A sampling profiler that accumulates per-rule tick and invocation counts
+ * at runtime.  Unlike rule-debug logging (see rule_logger.h) it is cheap
+ * enough to enable in production: when enabled, each rule execution costs
+ * two timestamp reads and two atomic additions; when disabled, a single
+ * flag test.
+ *
+ * Counts are queryable and resettable at runtime, typically through the
+ * engine manager control channel (see engine_manager_control_channel.h).
+ *
+ * @author Nick LeRoy <nleroy@qualys.com>
+ */
+
+#include <ironbee/engine.h>
+#include <ironbee/mm.h>
+#include <ironbee/rule_engine.h>
+#include <ironbee/types.h>
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup IronBeeRuleProfiler Rule Execution Profiler
+ * @ingroup IronBeeRule
+ *
+ * @{
+ */
+
+/** Rule profiler type. */
+typedef struct ib_rule_profiler_t ib_rule_profiler_t;
+
+/**
+ * Create a rule profiler.
+ *
+ * The profiler is created disabled; enable it with
+ * ib_rule_profiler_enable().
+ *
+ * @param[out] profiler The new profiler.
+ * @param[in] mm Memory manager to allocate out of.
+ *
+ * @returns
+ * - IB_OK on success.
+ * - IB_EALLOC on allocation failure.
+ */
+ib_status_t DLL_PUBLIC ib_rule_profiler_create(
+    ib_rule_profiler_t **profiler,
+    ib_mm_t              mm
+);
+
+/**
+ * Read the profiler's tick counter.
+ *
+ * Uses the CPU cycle counter where available (rdtsc on x86), falling back
+ * to ib_clock_precise_get_time().  Values are only meaningful as
+ * differences and only comparable within one profiler report.
+ *
+ * @returns Current tick count.
+ */
+uint64_t DLL_PUBLIC ib_rule_profiler_ticks(void);
+
+/**
+ * Check if @a profiler is accumulating samples.
+ *
+ * @param[in] profiler Profiler to check.
+ *
+ * @returns true if enabled, otherwise false.
+ */
+bool DLL_PUBLIC ib_rule_profiler_is_enabled(
+    const ib_rule_profiler_t *profiler
+);
+
+/**
+ * Record one execution of @a rule taking @a ticks.
+ *
+ * Counter updates are atomic so workers may record concurrently.  Does
+ * nothing if the profiler is disabled or @a rule falls outside the slot
+ * table built when the profiler was enabled.
+ *
+ * @param[in] profiler Profiler to record into.
+ * @param[in] rule Rule that executed.
+ * @param[in] ticks Ticks spent executing @a rule.
+ */
+void DLL_PUBLIC ib_rule_profiler_record(
+    ib_rule_profiler_t *profiler,
+    const ib_rule_t    *rule,
+    const ib_context_t *ctx,
+    uint64_t            ticks,
+    bool                matched
+);
+
+/**
+ * Render the per-context heavy-hitter report.
+ *
+ * One section per context seen since enable/reset, listing its most
+ * expensive rules (space-saving estimates over execution ticks, with
+ * execution and match counts), so multi-tenant deployments can
+ * attribute rule cost per site -- including main-context rules whose
+ * global numbers blend all sites.
+ *
+ * @param[in] ib Engine.
+ * @param[in] mm Memory manager for @a report.
+ * @param[out] report The rendered report (NUL terminated).
+ *
+ * @returns IB_OK or IB_EALLOC.
+ */
+ib_status_t DLL_PUBLIC ib_rule_profiler_site_report(
+    ib_engine_t  *ib,
+    ib_mm_t       mm,
+    const char  **report
+);
+
+/**
+ * Mean execution cost of @a rule in ticks, and its match rate.
+ *
+ * @param[in] profiler Profiler to read.
+ * @param[in] rule Rule to report on.
+ * @param[out] mean_ticks Mean ticks per invocation; 0 when unsampled.
+ * @param[out] n Invocations sampled.
+ *
+ * @returns IB_OK, or IB_ENOENT if the rule has no samples.
+ */
+ib_status_t DLL_PUBLIC ib_rule_profiler_mean(
+    const ib_rule_profiler_t *profiler,
+    const ib_rule_t          *rule,
+    uint64_t                 *mean_ticks,
+    uint64_t                 *n
+);
+
+/**
+ * Enable profiling for @a ib.
+ *
+ * Builds the per-rule slot table on first use; call only after
+ * configuration is complete so all rules have been assigned indexes.
+ *
+ * @param[in] ib IronBee engine.
+ *
+ * @returns
+ * - IB_OK on success.
+ * - IB_EALLOC on slot table allocation failure.
+ */
+ib_status_t DLL_PUBLIC ib_rule_profiler_enable(
+    ib_engine_t *ib
+);
+
+/**
+ * Disable profiling for @a ib.
+ *
+ * Accumulated counts are retained and reported by
+ * ib_rule_profiler_report() until ib_rule_profiler_reset() is called.
+ *
+ * @param[in] ib IronBee engine.
+ *
+ * @returns IB_OK.
+ */
+ib_status_t DLL_PUBLIC ib_rule_profiler_disable(
+    ib_engine_t *ib
+);
+
+/**
+ * Reset all accumulated counts for @a ib.
+ *
+ * @param[in] ib IronBee engine.
+ *
+ * @returns IB_OK.
+ */
+ib_status_t DLL_PUBLIC ib_rule_profiler_reset(
+    ib_engine_t *ib
+);
+
+/**
+ * Render a report of the most expensive rules for @a ib.
+ *
+ * Rules are ranked by accumulated ticks.  One line is produced per rule:
+ * rule id, total ticks, invocation count and mean ticks per invocation.
+ *
+ * @param[in] ib IronBee engine.
+ * @param[in] mm Memory manager for @a report; should live until the
+ *            report has been consumed.
+ * @param[in] limit Maximum number of rules to report.
+ * @param[out] report The rendered report.
+ *
+ * @returns
+ * - IB_OK on success.
+ * - IB_EALLOC on allocation failure.
+ */
+ib_status_t DLL_PUBLIC ib_rule_profiler_report(
+    ib_engine_t  *ib,
+    ib_mm_t       mm,
+    size_t        limit,
+    const char  **report
+);
+
+/**
+ * @} IronBeeRuleProfiler
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _IB_RULE_PROFILER_H_ */
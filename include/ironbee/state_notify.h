@@ -135,6 +135,54 @@ ib_status_t DLL_PUBLIC ib_state_notify_request_body_data(ib_engine_t *ib,
                                                          const char *data,
                                                          size_t data_length);
 
+/**
+ * As ib_state_notify_request_body_data() but alias @a data instead of
+ * copying it into the stream system.
+ *
+ * The caller must guarantee @a data remains valid and unchanged for the
+ * life of the transaction; server buffers allocated from a per-request
+ * pool satisfy this.  See ib_stream_pump_process_alias().
+ *
+ * @param ib Engine handle
+ * @param tx Transaction
+ * @param data Transaction data
+ * @param data_length Length of @a data.
+ *
+ * @returns Status code
+ */
+ib_status_t DLL_PUBLIC ib_state_notify_request_body_data_alias(
+    ib_engine_t *ib,
+    ib_tx_t *tx,
+    const char *data,
+    size_t data_length);
+
+/**
+ * Notify a complete request in one call.
+ *
+ * Equivalent to notifying request started (with @a line), header data
+ * (with @a headers), header finished, body data (if @a data is
+ * non-NULL) and request finished in sequence.  Servers that hold the
+ * whole request -- buffered and pipelined processing in particular --
+ * avoid five engine round trips per request.  Each step stops the
+ * sequence on error.
+ *
+ * @param ib Engine handle
+ * @param tx Transaction
+ * @param line Request line; may be NULL if already notified
+ * @param headers Parsed headers; may be NULL if none
+ * @param data Body data; may be NULL if none
+ * @param data_length Length of @a data
+ *
+ * @returns Status code of the first failing step, or IB_OK
+ */
+ib_status_t DLL_PUBLIC ib_state_notify_request(
+    ib_engine_t              *ib,
+    ib_tx_t                  *tx,
+    ib_parsed_req_line_t     *line,
+    ib_parsed_headers_t      *headers,
+    const char               *data,
+    size_t                    data_length);
+
 /**
  * Notify the state machine that the entire request is finished.
  *
@@ -204,6 +252,28 @@ ib_status_t DLL_PUBLIC ib_state_notify_response_body_data(ib_engine_t *ib,
                                                           const char *data,
                                                           size_t data_length);
 
+/**
+ * Notify a complete response in one call.
+ *
+ * As ib_state_notify_request() but for the response states.
+ *
+ * @param ib Engine handle
+ * @param tx Transaction
+ * @param line Response line; may be NULL if already notified
+ * @param headers Parsed headers; may be NULL if none
+ * @param data Body data; may be NULL if none
+ * @param data_length Length of @a data
+ *
+ * @returns Status code of the first failing step, or IB_OK
+ */
+ib_status_t DLL_PUBLIC ib_state_notify_response(
+    ib_engine_t              *ib,
+    ib_tx_t                  *tx,
+    ib_parsed_resp_line_t    *line,
+    ib_parsed_headers_t      *headers,
+    const char               *data,
+    size_t                    data_length);
+
 /**
  * Notify the state machine that the entire response is finished.
  *
@@ -0,0 +1,110 @@
+/*****************************************************************************
+ * Licensed to Qualys, Inc. (QUALYS) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * QUALYS licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#ifndef _IB_STATS_H_
+#define _IB_STATS_H_
+
+/**
+ * @file
+ * @brief IronBee --- Engine Statistics
+ *
+ * Cheap engine-wide counters.  Updates are atomic additions striped
+ * across cache-line sized shards indexed by thread, so concurrent
+ * workers rarely contend on a line; reads sum the shards and are
+ * intended for observability, not exact accounting.
+ *
+ * @author Nick LeRoy <nleroy@qualys.com>
+ */
+
+#include <ironbee/engine.h>
+#include <ironbee/types.h>
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup IronBeeEngineStats Engine Statistics
+ * @ingroup IronBeeEngine
+ * @{
+ */
+
+/** The engine-wide counters. */
+typedef enum {
+    IB_STAT_TX_STARTED,        /**< Transactions created. */
+    IB_STAT_TX_FINISHED,       /**< Transactions destroyed. */
+    IB_STAT_BLOCKS,            /**< Transactions blocked. */
+    IB_STAT_LOGEVENTS,         /**< Log events generated. */
+    IB_STAT_AUTOMATA_BYTES,    /**< Bytes scanned by automata. */
+    IB_STAT_AUTOMATA_NODES,    /**< Automata node transitions. */
+    IB_STAT_AUTOMATA_OUTPUTS,  /**< Automata outputs fired. */
+    IB_STAT_AUTOMATA_DEFAULTS, /**< Automata default (failure) edges. */
+    IB_STAT_MAX                /**< Number of counters; not a counter. */
+} ib_stat_t;
+
+/**
+ * Add @a delta to counter @a stat of @a ib.
+ *
+ * Safe from any thread; cost is one atomic addition on a striped line.
+ *
+ * @param[in] ib Engine.
+ * @param[in] stat Counter to bump.
+ * @param[in] delta Amount to add.
+ */
+void DLL_PUBLIC ib_stats_add(
+    ib_engine_t *ib,
+    ib_stat_t    stat,
+    uint64_t     delta
+);
+
+/**
+ * Current value of counter @a stat of @a ib.
+ *
+ * Sums the shards; momentarily torn values are acceptable for
+ * observability.
+ *
+ * @param[in] ib Engine.
+ * @param[in] stat Counter to read.
+ *
+ * @returns Counter value.
+ */
+uint64_t DLL_PUBLIC ib_stats_get(
+    const ib_engine_t *ib,
+    ib_stat_t          stat
+);
+
+/**
+ * Short name of @a stat for reporting.
+ *
+ * @param[in] stat Counter.
+ * @returns Static name string.
+ */
+const char DLL_PUBLIC *ib_stats_name(
+    ib_stat_t stat
+);
+
+/**
+ * @} IronBeeEngineStats
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _IB_STATS_H_ */
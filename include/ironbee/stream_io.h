@@ -156,6 +156,32 @@ ib_status_t DLL_PUBLIC ib_stream_io_tx_data_add(
     size_t             len
 ) NONNULL_ATTRIBUTE(1, 2);
 
+/**
+ * Add data to be processed without copying it.
+ *
+ * As ib_stream_io_tx_data_add() but the buffer is aliased rather than
+ * copied into the io system.  The caller must guarantee that @a data
+ * remains valid and unchanged for as long as any processor may hold a
+ * reference to it -- in practice, for the life of the transaction, since
+ * processors may retain data for later phases (e.g. audit logging).
+ * Server buffers allocated from a per-request pool satisfy this; buffers
+ * recycled after the notify call do not.
+ *
+ * @param[in] io_tx The IO transaction.
+ * @param[in] data The data to alias.
+ * @param[in] len The length of @a data.
+ *
+ * @returns
+ * - IB_OK On success.
+ * - IB_EALLOC On allocation error.
+ * - Other on another error.
+ */
+ib_status_t DLL_PUBLIC ib_stream_io_tx_data_alias_add(
+    ib_stream_io_tx_t *io_tx,
+    const uint8_t     *data,
+    size_t             len
+) NONNULL_ATTRIBUTE(1, 2);
+
 /**
  * Add a flush into the transaction to be processed.
  *
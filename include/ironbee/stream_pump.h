@@ -127,6 +127,26 @@ ib_status_t DLL_PUBLIC ib_stream_pump_process(
     size_t            data_len
 ) NONNULL_ATTRIBUTE(1);
 
+/**
+ * As ib_stream_pump_process() but alias @a data instead of copying it.
+ *
+ * The caller must guarantee that @a data remains valid and unchanged for
+ * the life of the transaction; see ib_stream_io_tx_data_alias_add().
+ *
+ * @param[in] pump The pump that will do the processing.
+ * @param[in] data The data to be processed.
+ * @param[in] data_len The length of data.
+ *
+ * @return
+ * - IB_OK On success.
+ * - Other on failure.
+ */
+ib_status_t DLL_PUBLIC ib_stream_pump_process_alias(
+    ib_stream_pump_t *pump,
+    const uint8_t    *data,
+    size_t            data_len
+) NONNULL_ATTRIBUTE(1);
+
 /**
  * Send a flush message through @a pump.
  *
@@ -0,0 +1,163 @@
+/*****************************************************************************
+ * Licensed to Qualys, Inc. (QUALYS) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * QUALYS licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#ifndef _IB_TIMER_WHEEL_H_
+#define _IB_TIMER_WHEEL_H_
+
+/**
+ * @file
+ * @brief IronBee --- Hierarchical Timer Wheel
+ */
+
+#include <ironbee/build.h>
+#include <ironbee/clock.h>
+#include <ironbee/mm.h>
+#include <ironbee/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup IronBeeUtilTimerWheel Timer Wheel
+ * @ingroup IronBeeUtil
+ *
+ * A hierarchical timer wheel: constant-time scheduling and
+ * cancellation of time-based callbacks, with the cost of firing paid
+ * by whoever drives ib_timer_wheel_advance() -- typically a server
+ * module tick.  Suitable as the shared engine of collection TTL
+ * expiry, inspection deadlines, and deferred-rule scheduling, instead
+ * of each consumer comparing timestamps on every access.
+ *
+ * Four levels of 256 slots give a horizon of 2^32 ticks; timers beyond
+ * the current level cascade down as time advances, so per-tick work is
+ * proportional to timers actually due.  Timer nodes are recycled
+ * internally.
+ *
+ * Like @ref ib_queue_t, a wheel performs no locking: create, schedule,
+ * cancel and advance must be externally synchronized (a wheel per
+ * thread, or a caller-held lock).
+ *
+ * @{
+ */
+
+/** The wheel. */
+typedef struct ib_timer_wheel_t ib_timer_wheel_t;
+
+/** A scheduled timer, usable to cancel. */
+typedef struct ib_timer_t ib_timer_t;
+
+/**
+ * Callback fired when a timer expires.
+ *
+ * Fired from within ib_timer_wheel_advance().  The timer is spent;
+ * rescheduling requires a new ib_timer_wheel_schedule() call (which is
+ * safe from within the callback).
+ *
+ * @param[in] cbdata Callback data given at schedule time.
+ */
+typedef void (*ib_timer_fn_t)(void *cbdata);
+
+/**
+ * Create a timer wheel.
+ *
+ * @param[out] wheel The new wheel.
+ * @param[in] mm Memory manager to allocate from.  Timer nodes are
+ *            recycled internally, so long-lived wheels do not grow
+ *            beyond their high-water mark of concurrent timers.
+ * @param[in] tick_usec Microseconds per tick: the scheduling
+ *            granularity.  Deadlines round up to the next tick.
+ * @param[in] now Current time (e.g. ib_clock_get_time()); the epoch
+ *            the wheel starts at.
+ *
+ * @returns
+ * - IB_OK on success.
+ * - IB_EALLOC on allocation failure.
+ * - IB_EINVAL if @a tick_usec is 0.
+ */
+ib_status_t DLL_PUBLIC ib_timer_wheel_create(
+    ib_timer_wheel_t **wheel,
+    ib_mm_t            mm,
+    ib_time_t          tick_usec,
+    ib_time_t          now
+);
+
+/**
+ * Schedule @a fn to fire once @a delay_usec from the wheel's present.
+ *
+ * Constant time.
+ *
+ * @param[in] wheel The wheel.
+ * @param[in] delay_usec Delay in microseconds; rounds up to a tick,
+ *            with 0 meaning the next advance.
+ * @param[in] fn Callback to fire.
+ * @param[in] cbdata Callback data.
+ * @param[out] timer The scheduled timer, for ib_timer_cancel(); may be
+ *             NULL if cancellation is not needed.
+ *
+ * @returns
+ * - IB_OK on success.
+ * - IB_EALLOC on allocation failure.
+ * - IB_EINVAL if the delay exceeds the wheel's horizon.
+ */
+ib_status_t DLL_PUBLIC ib_timer_wheel_schedule(
+    ib_timer_wheel_t *wheel,
+    ib_time_t         delay_usec,
+    ib_timer_fn_t     fn,
+    void             *cbdata,
+    ib_timer_t      **timer
+);
+
+/**
+ * Cancel @a timer.  Constant time.
+ *
+ * Calling this on a timer that already fired (or was already canceled)
+ * is a no-op as long as the node has not been handed out again:
+ * spent nodes are recycled by the owning wheel, so a consumer whose
+ * timer may fire concurrently with its cancellation logic should
+ * clear its handle in the callback and treat a cleared handle as
+ * nothing-to-cancel.
+ *
+ * @param[in] timer Timer from ib_timer_wheel_schedule().
+ */
+void DLL_PUBLIC ib_timer_cancel(ib_timer_t *timer);
+
+/**
+ * Advance the wheel to @a now, firing every timer that came due.
+ *
+ * Per-tick cost is bounded by the timers due plus occasional cascades;
+ * empty ticks are a pointer check.  Callbacks may schedule new timers
+ * and cancel others.
+ *
+ * @param[in] wheel The wheel.
+ * @param[in] now Current time, same clock as creation.  Going
+ *            backwards is a no-op.
+ *
+ * @returns Number of timers fired.
+ */
+size_t DLL_PUBLIC ib_timer_wheel_advance(
+    ib_timer_wheel_t *wheel,
+    ib_time_t         now
+);
+
+/** @} IronBeeUtilTimerWheel */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _IB_TIMER_WHEEL_H_ */
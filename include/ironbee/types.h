@@ -66,6 +66,7 @@ typedef enum ib_status_t {
     IB_EOTHER,                  /**< 11: Other error */
     IB_EBADVAL,                 /**< 12: A value outside the allowed range */
     IB_EEXIST,                  /**< 13: Entry already exists, not overwriting */
+    IB_DEFER,                   /**< 14: Deferred; resume when ready */
 } ib_status_t;
 
 /**
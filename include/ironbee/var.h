@@ -21,6 +21,7 @@
 #include <ironbee/field.h>
 #include <ironbee/mm.h>
 #include <ironbee/rule_defs.h>
+#include <ironbee/vector.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -194,6 +195,85 @@ ib_status_t DLL_PUBLIC ib_var_store_acquire(
 )
 NONNULL_ATTRIBUTE(1, 3);
 
+/**
+ * Acquire a new var store that reads through to @a parent.
+ *
+ * The new store is a copy-on-write snapshot of @a parent: gets that miss
+ * the new store fall through to @a parent, while sets always write to the
+ * new store, shadowing the parent value.  This allows e.g.
+ * connection-scoped values to be written once and shared by every
+ * transaction store on the connection without per-transaction copies.
+ *
+ * Values read through a child store are shared with the parent and must
+ * be treated as immutable; @a parent must outlive the new store.
+ *
+ * @param[out] store  The new var store.
+ * @param[in]  mm     Memory manager to use.
+ * @param[in]  parent Store to read through to; supplies the configuration.
+ * @returns
+ * - IB_OK on success.
+ * - IB_EALLOC on allocation failure.
+ */
+ib_status_t DLL_PUBLIC ib_var_store_acquire_child(
+    ib_var_store_t       **store,
+    ib_mm_t                mm,
+    const ib_var_store_t  *parent
+)
+NONNULL_ATTRIBUTE(1, 3);
+
+/**
+ * Access parent store of @a store; NULL if @a store has no parent.
+ **/
+const ib_var_store_t DLL_PUBLIC *ib_var_store_parent(
+    const ib_var_store_t *store
+)
+NONNULL_ATTRIBUTE(1);
+
+/**
+ * Address of the store's generation counter.
+ *
+ * For consumers that cache against var writes -- e.g.
+ * ib_field_memoize() -- and need a stable location to watch rather
+ * than a sampled value.  The counter lives as long as the store.
+ *
+ * @param[in] store Store.
+ * @returns Pointer to the generation counter.
+ */
+const uint64_t DLL_PUBLIC *ib_var_store_generation_ptr(
+    const ib_var_store_t *store
+);
+
+/**
+ * The store's generation: incremented on every set.
+ *
+ * Consumers may record this value and compare it later to detect that
+ * the store has not changed at all since.
+ *
+ * @param[in] store Store to query.
+ * @returns Current generation.
+ **/
+uint64_t DLL_PUBLIC ib_var_store_generation(
+    const ib_var_store_t *store
+)
+NONNULL_ATTRIBUTE(1);
+
+/**
+ * The generation at which @a source was last set in @a store.
+ *
+ * Indexed sources are tracked individually; for unindexed sources this
+ * returns the store generation, so callers always treat them as
+ * possibly changed.  A source never set in @a store reports zero.
+ *
+ * @param[in] source Source to query.
+ * @param[in] store Store to query.
+ * @returns Generation of the last set, or zero if never set.
+ **/
+uint64_t DLL_PUBLIC ib_var_source_generation(
+    const ib_var_source_t *source,
+    const ib_var_store_t  *store
+)
+NONNULL_ATTRIBUTE(1, 2);
+
 /**
  * Access configuration of @a store.
  **/
@@ -222,6 +302,45 @@ void ib_var_store_export(
 )
 NONNULL_ATTRIBUTE(1, 2);
 
+/**
+ * Export fields as one flat, type-tagged, length-prefixed buffer.
+ *
+ * One pass over the store (and its ancestors, child-shadowed like
+ * ib_var_store_export()) appends one record per field to @a out:
+ *
+ * @code
+ * record := type:uint8 name_len:uint32 name value_len:uint32 value
+ * @endcode
+ *
+ * with integers in host byte order.  Numeric fields (NUM, FLOAT, TIME)
+ * carry their decimal text as the value; NULSTR and BYTESTR carry raw
+ * bytes; a LIST record's value_len is its child record count and the
+ * children follow as records (recursively).  Fields of other types --
+ * including dynamic fields, whose getters may not be side-effect free
+ * -- are recorded with an empty value so consumers stay aligned.
+ *
+ * Serializers consume the buffer linearly with no hash revisits or
+ * field re-boxing; @a out is truncated first, so one scratch vector
+ * can be reused across calls.
+ *
+ * @param[in] store Store to export.
+ * @param[in] name Export only this field (by name), or NULL for all.
+ * @param[in] name_length Length of @a name; 0 when @a name is NULL.
+ * @param[in,out] out Receives the records; truncated first.
+ *
+ * @returns
+ * - IB_OK on success.
+ * - IB_ENOENT if @a name was given and no such field exists.
+ * - IB_EALLOC on allocation failure.
+ */
+ib_status_t DLL_PUBLIC ib_var_store_export_flat(
+    ib_var_store_t *store,
+    const char     *name,
+    size_t          name_length,
+    ib_vector_t    *out
+)
+NONNULL_ATTRIBUTE(1, 4);
+
 /**@}*/
 
 /**
@@ -363,6 +482,29 @@ ib_status_t DLL_PUBLIC ib_var_source_get_const(
     const ib_var_store_t   *store
 );
 
+/**
+ * Existence pre-check: may @a source be set in @a store?
+ *
+ * For indexed sources this is an exact constant-time check.  For
+ * unindexed sources it consults a per-store bloom filter maintained by
+ * ib_var_source_set(): a false result means the name was certainly
+ * never set in @a store or its ancestors, so the full hash lookup (and
+ * whatever work depends on the value) can be skipped; a true result
+ * means maybe, and the caller proceeds as usual.  The filter only ever
+ * accumulates bits, so a value removed by setting it again is still
+ * reported as maybe present.
+ *
+ * @param[in] source Source to check.
+ * @param[in] store Store to check in.
+ *
+ * @returns False only if the source is certainly not set.
+ */
+bool DLL_PUBLIC ib_var_source_maybe_set(
+    const ib_var_source_t *source,
+    ib_var_store_t        *store
+)
+NONNULL_ATTRIBUTE(1, 2);
+
 /**
  * Set the value of a source in a store.
  *
@@ -743,6 +885,32 @@ ib_status_t DLL_PUBLIC ib_var_target_get(
 )
 NONNULL_ATTRIBUTE(1, 2, 4);
 
+/**
+ * Get the single value of @a target.
+ *
+ * For trivial targets (plain source, no filter) this is a direct source
+ * get with no allocation.  Targets with filters or expansions fall back
+ * to ib_var_target_get() and report the first fetched value.  Intended
+ * for consumers such as setvar that operate on exactly one value.
+ *
+ * @param[in]  target Target to get the value of.
+ * @param[out] field  Fetched value; NULL if the target has no values.
+ * @param[in]  mm     Memory manager for the fallback path.
+ * @param[in]  store  Store holding values.
+ *
+ * @return
+ * - IB_OK on success.
+ * - IB_ENOENT if the source is not set.
+ * - As ib_var_target_get() on the fallback path.
+ **/
+ib_status_t DLL_PUBLIC ib_var_target_get_single(
+    ib_var_target_t  *target,
+    ib_field_t      **field,
+    ib_mm_t           mm,
+    ib_var_store_t   *store
+)
+NONNULL_ATTRIBUTE(1, 2, 4);
+
 /**
  * Const version of ib_var_target_get().
  *
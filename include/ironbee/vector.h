@@ -156,6 +156,45 @@ ib_status_t DLL_PUBLIC ib_vector_truncate(
  *             in a @c size_t.
  * - IB_EUNKNOWN on memory pool locking failures.
  */
+/**
+ * Reserve writable space at the end of the vector.
+ *
+ * Together with ib_vector_commit() this lets producers write into the
+ * vector directly instead of building data elsewhere and appending it
+ * (a second copy).  The returned pointer has room for @a data_length
+ * bytes and is invalidated by any other vector operation.
+ *
+ * @param[in] vector The vector.
+ * @param[in] data_length Bytes of writable space required.
+ * @param[out] data Where to write; valid until the next vector call.
+ *
+ * @returns
+ * - IB_OK On success.
+ * - IB_EINVAL On size overflow.
+ * - IB_EALLOC On allocation failure.
+ */
+ib_status_t DLL_PUBLIC ib_vector_reserve(
+    ib_vector_t  *vector,
+    size_t        data_length,
+    void        **data
+);
+
+/**
+ * Commit bytes written into space from ib_vector_reserve().
+ *
+ * @param[in] vector The vector.
+ * @param[in] data_length Bytes actually written; at most the reserved
+ *            amount.
+ *
+ * @returns
+ * - IB_OK On success.
+ * - IB_EINVAL If @a data_length exceeds the reserved space.
+ */
+ib_status_t DLL_PUBLIC ib_vector_commit(
+    ib_vector_t *vector,
+    size_t       data_length
+);
+
 ib_status_t DLL_PUBLIC ib_vector_append(
     ib_vector_t *vector,
     const void  *data,
@@ -57,6 +57,14 @@ class ByteString;
  * @sa ib_bytestr_t
  * @nosubgrouping
  **/
+/* Move semantics and a string_view pass-through have been considered
+ * for these wrappers and add nothing: ByteString and Field are handle
+ * types wrapping a single engine pointer, so copies are pointer copies
+ * and moves could do no better, and const_data()/length() already
+ * expose the underlying bytes without copying (std::string_view is
+ * also unavailable at this codebase's C++ level).  The only copying
+ * accessor is to_s(), by design; callers on hot paths should use the
+ * pointer/length pair. */
 class ConstByteString :
     public CommonSemantics<ConstByteString>
 {
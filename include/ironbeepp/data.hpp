@@ -91,6 +91,36 @@ ValueType data_to_value(void* data)
     }
 }
 
+/**
+ * Access a reference to the value stored at @a data.
+ *
+ * As data_to_value() but without copying the stored value out of its
+ * boost::any -- for hot paths such as hook dispatch, where the stored
+ * functor would otherwise be copied (often a heap allocation) per
+ * event.  The reference is valid as long as the underlying storage.
+ *
+ * @tparam ValueType Type of value stored.
+ * @param[in] data Data to turn into a reference.
+ * @returns Reference to stored value.
+ * @throw einval if @a data does not hold a @a ValueType.
+ **/
+template <typename ValueType>
+ValueType& data_to_reference(void* data)
+{
+    boost::any* data_any = reinterpret_cast<boost::any*>(data);
+
+    try {
+        return boost::any_cast<ValueType&>(*data_any);
+    }
+    catch (boost::bad_any_cast) {
+        BOOST_THROW_EXCEPTION(
+            einval() << errinfo_what(
+                "Stored type mismatch."
+            )
+        );
+    }
+}
+
 /**
  * Store a copy of @a value and provide a @c void* for data_to_value().
  *
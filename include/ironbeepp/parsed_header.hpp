@@ -250,18 +250,13 @@ ib_parsed_headers_t* make_pnv_list(
         ParsedHeader pnv,
         std::make_pair(begin, end)
     ) {
-        // This will reconstruct the bytestrings but not copy the data.
-        // The C API is currently asymmetric: named values are consumed as
-        // structures but added to list as members.  IronBee++ hides that
-        // asymmetry.
+        // The ParsedHeader already wraps an ib_parsed_header_t whose
+        // byte strings alias the producer's buffers (the ParserSuite
+        // and clipp adaptors create them with create_alias, from the
+        // transaction's memory manager), so it is linked into the list
+        // directly; nothing is re-copied per header.
         throw_if_error(
-            ib_parsed_headers_add(
-                ib_pnv_list,
-                pnv.name().const_data(),
-                pnv.name().length(),
-                pnv.value().const_data(),
-                pnv.value().length()
-            )
+            ib_parsed_headers_append_header(ib_pnv_list, pnv.ib())
         );
     }
 
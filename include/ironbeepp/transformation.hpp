@@ -163,6 +163,15 @@ private:
  * @sa ib_transformation_t
  * @nosubgrouping
  **/
+/* Compile-time fused transformation chains (template composition of
+ * transformations specialized per chain) have been considered and do
+ * not fit this system: chains are assembled from configuration text at
+ * engine configuration time, so the set of chains is unknowable when
+ * this library is compiled, and every transformation remains a runtime
+ * instance with its own state.  The runtime equivalent -- flattening
+ * each rule's transformation list into a contiguous array executed
+ * without list traversal -- is done by the rule engine at context
+ * close. */
 class Transformation :
     public ConstTransformation
 {
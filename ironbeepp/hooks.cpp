@@ -34,7 +34,7 @@ ib_status_t null(
     assert(cbdata != NULL);
 
     try {
-        data_to_value<HooksRegistrar::null_t>(cbdata)(
+        data_to_reference<HooksRegistrar::null_t>(cbdata)(
             Engine(ib_engine),
             static_cast<Engine::state_e>(state)
         );
@@ -68,7 +68,7 @@ ib_status_t header_data(
     assert(cbdata != NULL);
 
     try {
-        data_to_value<HooksRegistrar::header_data_t>(cbdata)(
+        data_to_reference<HooksRegistrar::header_data_t>(cbdata)(
             Engine(ib_engine),
             Transaction(ib_tx),
             static_cast<Engine::state_e>(state),
@@ -106,7 +106,7 @@ ib_status_t request_line(
     assert(cbdata != NULL);
 
     try {
-        data_to_value<HooksRegistrar::request_line_t>(cbdata)(
+        data_to_reference<HooksRegistrar::request_line_t>(cbdata)(
             Engine(ib_engine),
             Transaction(ib_tx),
             static_cast<Engine::state_e>(state),
@@ -144,7 +144,7 @@ ib_status_t response_line(
     assert(cbdata != NULL);
 
     try {
-        data_to_value<HooksRegistrar::response_line_t>(cbdata)(
+        data_to_reference<HooksRegistrar::response_line_t>(cbdata)(
             Engine(ib_engine),
             Transaction(ib_tx),
             static_cast<Engine::state_e>(state),
@@ -179,7 +179,7 @@ ib_status_t connection(
     assert(cbdata != NULL);
 
     try {
-        data_to_value<HooksRegistrar::connection_t>(cbdata)(
+        data_to_reference<HooksRegistrar::connection_t>(cbdata)(
             Engine(ib_engine),
             Connection(ib_connection),
             static_cast<Engine::state_e>(state)
@@ -213,7 +213,7 @@ ib_status_t transaction(
     assert(cbdata != NULL);
 
     try {
-        data_to_value<HooksRegistrar::transaction_t>(cbdata)(
+        data_to_reference<HooksRegistrar::transaction_t>(cbdata)(
             Engine(ib_engine),
             Transaction(ib_transaction),
             static_cast<Engine::state_e>(state)
@@ -248,7 +248,7 @@ ib_status_t logevent(
     assert(cbdata != NULL);
 
     try {
-        data_to_value<HooksRegistrar::logevent_t>(cbdata)(
+        data_to_reference<HooksRegistrar::logevent_t>(cbdata)(
             Engine(ib_engine),
             Transaction(ib_transaction),
             LogEvent(ib_logevent)
@@ -287,7 +287,7 @@ ib_status_t transaction_data(
     assert(cbdata != NULL);
 
     try {
-        data_to_value<HooksRegistrar::transaction_data_t>(cbdata)(
+        data_to_reference<HooksRegistrar::transaction_data_t>(cbdata)(
             Engine(ib_engine),
             Transaction(ib_tx),
             static_cast<Engine::state_e>(state),
@@ -322,7 +322,7 @@ ib_status_t context(
     assert(cbdata != NULL);
 
     try {
-        data_to_value<HooksRegistrar::context_t>(cbdata)(
+        data_to_reference<HooksRegistrar::context_t>(cbdata)(
             Engine(ib_engine),
             Context(ib_ctx),
             static_cast<Engine::state_e>(state)
@@ -59,6 +59,17 @@ end
 -- Given an ib_field_t*, this will convert the data into a Lua type or
 -- nil if the value is not supported.
 --
+-- On the C-boundary cost of this function: access is already FFI
+-- throughout -- the type tag is a direct cdata struct member read and
+-- the value fetch is an ffi.C call, which LuaJIT compiles to a plain C
+-- call (no classic lua_push/lua_to API transitions occur on this
+-- path).  Reading values without any C call at all would require
+-- declaring ib_field_val_t's layout to FFI, and that layout is
+-- deliberately private: it is where dynamic-getter dispatch and value
+-- memoization live, and a struct-read bypass would silently return
+-- stale or wrong values for dynamic fields.  ib_field_value() is the
+-- stable ABI subset.
+--
 -- @tparam engine self Engine object.
 -- @tparam cdata[ib_field_t*] field IronBee C field.
 --
@@ -30,7 +30,10 @@
 #include <ironautomata/eudoxus.h>
 
 #include <ironbee/capture.h>
+#include <ironbee/clock.h>
 #include <ironbee/context.h>
+#include <ironbee/core.h>
+#include <ironbee/lock.h>
 #include <ironbee/engine_state.h>
 #include <ironbee/hash.h>
 #include <ironbee/mm_mpool_lite.h>
@@ -38,9 +41,14 @@
 #include <ironbee/operator.h>
 #include <ironbee/path.h>
 #include <ironbee/rule_engine.h>
+#include <ironbee/stats.h>
 #include <ironbee/util.h>
 
 #include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 /** Module name. */
@@ -62,14 +70,252 @@ struct ee_config_t {
     ib_hash_t *eudoxus_pattern_hash;
 };
 
+/**
+ * Process-wide registry of loaded automata, shared across engines.
+ *
+ * Loaded automata are the bulk of this module's memory and are
+ * identical between an engine and its reload successor whenever the
+ * file has not changed.  Entries are keyed by (path, mtime) and
+ * reference counted: a new engine configuring the same LoadEudoxus
+ * file references the automata the old (still draining) engine loaded
+ * instead of loading its own copy, so reload cost is proportional to
+ * what actually changed.  An automata is destroyed when the last
+ * engine referencing it shuts down.
+ *
+ * The key is (path, mtime) rather than a content hash: hashing a
+ * multi-GB file on every load costs a full read to detect only the
+ * renamed-identical-file case, while mtime identity is free and
+ * matches how intel updates are deployed (replace in place).  The
+ * registry is process wide rather than attached to the engine
+ * manager, which shares at least as much -- including between
+ * managers, and for engines created without one.
+ */
+typedef struct ee_shared_automata_t ee_shared_automata_t;
+struct ee_shared_automata_t {
+    ee_shared_automata_t *next;    /**< Next loaded automata. */
+    char                 *path;    /**< File loaded from (malloc). */
+    time_t                mtime;   /**< Modification time at load. */
+    ia_eudoxus_t         *eudoxus; /**< The loaded automata. */
+    unsigned              refcnt;  /**< Engines referencing this. */
+};
+
+static ee_shared_automata_t *c_shared_automata = NULL;
+static pthread_mutex_t       c_shared_automata_lock =
+    PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Get a (possibly shared) automata for @a path at @a mtime.
+ *
+ * Loads the file if no engine has it loaded at that modification time.
+ * Every successful acquire must be balanced by a release (holders
+ * release their references via an engine cleanup at shutdown).
+ *
+ * @param[in] path Automata file path.
+ * @param[in] mtime Modification time of the file.
+ * @param[out] peudoxus The automata.
+ *
+ * @returns IA_EUDOXUS_OK or the load error.
+ */
+static ia_eudoxus_result_t ee_shared_automata_acquire(
+    const char    *path,
+    time_t         mtime,
+    ia_eudoxus_t **peudoxus
+)
+{
+    ee_shared_automata_t *entry;
+    ia_eudoxus_t         *eudoxus;
+    ia_eudoxus_result_t   ia_rc;
+
+    pthread_mutex_lock(&c_shared_automata_lock);
+    for (entry = c_shared_automata; entry != NULL; entry = entry->next) {
+        if (entry->mtime == mtime && strcmp(entry->path, path) == 0) {
+            ++entry->refcnt;
+            *peudoxus = entry->eudoxus;
+            pthread_mutex_unlock(&c_shared_automata_lock);
+            return IA_EUDOXUS_OK;
+        }
+    }
+
+    ia_rc = ia_eudoxus_create_from_path(&eudoxus, path);
+    if (ia_rc != IA_EUDOXUS_OK) {
+        pthread_mutex_unlock(&c_shared_automata_lock);
+        return ia_rc;
+    }
+
+    entry = (ee_shared_automata_t *)malloc(sizeof(*entry));
+    if (entry == NULL || (entry->path = strdup(path)) == NULL) {
+        /* Hand the automata out unshared; release destroys it. */
+        free(entry);
+        pthread_mutex_unlock(&c_shared_automata_lock);
+        *peudoxus = eudoxus;
+        return IA_EUDOXUS_OK;
+    }
+    entry->mtime      = mtime;
+    entry->eudoxus    = eudoxus;
+    entry->refcnt     = 1;
+    entry->next       = c_shared_automata;
+    c_shared_automata = entry;
+    pthread_mutex_unlock(&c_shared_automata_lock);
+
+    *peudoxus = eudoxus;
+    return IA_EUDOXUS_OK;
+}
+
+/**
+ * Release an automata obtained from ee_shared_automata_acquire(),
+ * destroying it when the last reference drops.
+ */
+static void ee_shared_automata_release(ia_eudoxus_t *eudoxus)
+{
+    ee_shared_automata_t **pentry;
+    ee_shared_automata_t  *entry;
+
+    if (eudoxus == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&c_shared_automata_lock);
+    for (
+        pentry = &c_shared_automata;
+        *pentry != NULL;
+        pentry = &(*pentry)->next
+    ) {
+        if ((*pentry)->eudoxus == eudoxus) {
+            entry = *pentry;
+            if (--entry->refcnt == 0) {
+                *pentry = entry->next;
+                pthread_mutex_unlock(&c_shared_automata_lock);
+                ia_eudoxus_destroy(entry->eudoxus);
+                free(entry->path);
+                free(entry);
+                return;
+            }
+            pthread_mutex_unlock(&c_shared_automata_lock);
+            return;
+        }
+    }
+    pthread_mutex_unlock(&c_shared_automata_lock);
+
+    /* Unshared (registry allocation failed at acquire). */
+    ia_eudoxus_destroy(eudoxus);
+}
+
+/** How often (usec) to stat a loaded automata file for changes. */
+#define EE_RELOAD_CHECK_USEC 5000000
+
+/**
+ * A hot-reloadable automata.
+ *
+ * The pattern hash stores holders rather than automata so reputation
+ * data can be replaced on disk without an engine reload: executions
+ * read the current pointer, and a periodic (stat based) check swaps in
+ * a newly loaded file.  Replaced automata are kept until engine
+ * shutdown, so states created against them stay valid.
+ */
+/** A retired automata reference, parked until engine shutdown. */
+typedef struct ee_retired_automata_t ee_retired_automata_t;
+struct ee_retired_automata_t {
+    ia_eudoxus_t          *eudoxus; /**< Replaced automata. */
+    ee_retired_automata_t *next;    /**< Next retired entry. */
+};
+
+typedef struct {
+    ia_eudoxus_t *eudoxus;    /**< Current automata; swapped on reload. */
+    ib_engine_t  *ib;         /**< Engine, for logging and cleanup. */
+    const char   *path;       /**< File loaded from. */
+    time_t        mtime;      /**< Modification time at load. */
+    ib_time_t     next_check; /**< Next time to stat the file. */
+    ib_lock_t    *lock;       /**< Guards reloads and retired. */
+
+    /**
+     * Automata replaced by reloads, kept alive for in-flight states.
+     *
+     * Guarded by lock.  Nodes are malloced: reloads run at transaction
+     * time, where the engine's main pool -- single-threaded at
+     * configuration time -- must not be touched.  The holder's one
+     * engine cleanup, registered at load time, releases the current
+     * automata and every retired one.
+     */
+    ee_retired_automata_t *retired;
+} ee_automata_holder_t;
+
 /* Operator instance data. */
 struct ee_operator_data_t {
     /** Unique ID for this operator instance. */
     char id[IB_UUID_LENGTH];
-    /** Pointer to the eudoxus pattern for this instance. */
-    ia_eudoxus_t *eudoxus;
+    /** Holder of the eudoxus pattern for this instance. */
+    ee_automata_holder_t *holder;
 };
 
+/**
+ * Current automata of @a holder, reloading a changed file when due.
+ *
+ * The fast path is a time comparison and a pointer load.  Reloads
+ * happen under the holder's lock; failures keep the current automata.
+ *
+ * @param[in] holder Holder to read.
+ * @returns The current automata.
+ */
+static ia_eudoxus_t *ee_holder_current(ee_automata_holder_t *holder)
+{
+    ib_time_t now = ib_clock_get_time();
+
+    if (now >= holder->next_check) {
+        if (ib_lock_lock(holder->lock) == IB_OK) {
+            if (now >= holder->next_check) {
+                struct stat file_info;
+
+                holder->next_check = now + EE_RELOAD_CHECK_USEC;
+                if (
+                    stat(holder->path, &file_info) == 0 &&
+                    file_info.st_mtime != holder->mtime
+                ) {
+                    ia_eudoxus_t *fresh;
+                    ia_eudoxus_result_t ia_rc;
+
+                    /* Acquire through the registry: another engine may
+                     * already have the new file version loaded. */
+                    ia_rc = ee_shared_automata_acquire(
+                        holder->path, file_info.st_mtime, &fresh);
+                    if (ia_rc == IA_EUDOXUS_OK) {
+                        /* Park the old automata for in-flight states;
+                         * the holder's engine cleanup releases it at
+                         * shutdown. */
+                        ee_retired_automata_t *node = malloc(sizeof(*node));
+
+                        if (node == NULL) {
+                            /* Cannot guarantee the old data's cleanup;
+                             * keep the current data. */
+                            ee_shared_automata_release(fresh);
+                        }
+                        else {
+                            node->eudoxus   = holder->eudoxus;
+                            node->next      = holder->retired;
+                            holder->retired = node;
+                            holder->eudoxus = fresh;
+                            holder->mtime = file_info.st_mtime;
+                            ib_log_info(holder->ib,
+                                        MODULE_NAME_STR
+                                        ": Reloaded automata %s",
+                                        holder->path);
+                        }
+                    }
+                    else {
+                        ib_log_error(holder->ib,
+                                     MODULE_NAME_STR
+                                     ": Error reloading automata %s [%d];"
+                                     " keeping current data.",
+                                     holder->path, ia_rc);
+                    }
+                }
+            }
+            ib_lock_unlock(holder->lock);
+        }
+    }
+
+    return holder->eudoxus;
+}
+
 /* Callback data for ee match */
 struct ee_callback_data_t
 {
@@ -256,13 +502,26 @@ ib_status_t set_ee_tx_data(
     return rc;
 }
 
-static void ia_eudoxus_destroy_wrapper(void *cbdata)
+/**
+ * Engine cleanup of a holder: release the current automata reference
+ * and every reference retired by reloads.
+ */
+static void ee_automata_holder_cleanup(void *cbdata)
 {
     assert(cbdata != NULL);
 
-    ia_eudoxus_t *eudoxus = (ia_eudoxus_t *)cbdata;
+    ee_automata_holder_t  *holder = (ee_automata_holder_t *)cbdata;
+    ee_retired_automata_t *node = holder->retired;
 
-    ia_eudoxus_destroy(eudoxus);
+    ee_shared_automata_release(holder->eudoxus);
+    while (node != NULL) {
+        ee_retired_automata_t *next = node->next;
+
+        ee_shared_automata_release(node->eudoxus);
+        free(node);
+        node = next;
+    }
+    holder->retired = NULL;
 }
 
 /**
@@ -330,28 +589,69 @@ ib_status_t load_eudoxus_pattern_param2(ib_cfgparser_t *cp,
         return IB_EINVAL;
     }
 
-    ia_rc = ia_eudoxus_create_from_path(&eudoxus, automata_file);
-    if (ia_rc != IA_EUDOXUS_OK) {
-        ib_log_error(cp->ib,
-                     MODULE_NAME_STR ": Error loading eudoxus automata file[%d]: %s.",
-                     ia_rc, automata_file);
-        return IB_EINVAL;
-    }
+    /* Acquire the automata through the process-wide registry: if a
+     * previous engine (e.g. the one this reload is replacing) already
+     * has this file loaded, it is shared instead of loaded again. */
+    {
+        struct stat file_info;
+        time_t      mtime = 0;
 
-    /* Destroy this machine when the engine is destroyed. */
-    rc = ib_mm_register_cleanup(
-        ib_engine_mm_main_get(ib),
-        ia_eudoxus_destroy_wrapper,
-        eudoxus
-    );
-    if (rc != IB_OK) {
-        ib_log_error(cp->ib, "Failed to register eudoxus cleanup function.");
-        return rc;
-    }
+        if (stat(automata_file, &file_info) == 0) {
+            mtime = file_info.st_mtime;
+        }
 
-    rc = ib_hash_set(eudoxus_pattern_hash, pattern_name, eudoxus);
-    if (rc != IB_OK) {
-        return rc;
+        ia_rc = ee_shared_automata_acquire(automata_file, mtime, &eudoxus);
+        if (ia_rc != IA_EUDOXUS_OK) {
+            ib_log_error(cp->ib,
+                         MODULE_NAME_STR
+                         ": Error loading eudoxus automata file[%d]: %s.",
+                         ia_rc, automata_file);
+            return IB_EINVAL;
+        }
+
+        /* Wrap the automata in a reloadable holder. */
+        ee_automata_holder_t *holder;
+        ib_mm_t main_mm = ib_engine_mm_main_get(ib);
+
+        holder = ib_mm_calloc(main_mm, 1, sizeof(*holder));
+        if (holder == NULL) {
+            ee_shared_automata_release(eudoxus);
+            return IB_EALLOC;
+        }
+        holder->eudoxus = eudoxus;
+        holder->ib      = ib;
+        holder->path    = ib_mm_strdup(main_mm, automata_file);
+        if (holder->path == NULL) {
+            ee_shared_automata_release(eudoxus);
+            return IB_EALLOC;
+        }
+        holder->mtime = mtime;
+        holder->next_check = ib_clock_get_time() + EE_RELOAD_CHECK_USEC;
+        rc = ib_lock_create(&holder->lock, main_mm);
+        if (rc != IB_OK) {
+            ee_shared_automata_release(eudoxus);
+            return rc;
+        }
+
+        /* One engine cleanup per holder, registered here at
+         * configuration time: it releases the current reference and
+         * those retired by reloads, so transaction-time reloads never
+         * touch the engine pool. */
+        rc = ib_mm_register_cleanup(
+            ib_engine_mm_main_get(ib),
+            ee_automata_holder_cleanup,
+            holder
+        );
+        if (rc != IB_OK) {
+            ib_log_error(cp->ib, "Failed to register eudoxus cleanup function.");
+            ee_shared_automata_release(eudoxus);
+            return rc;
+        }
+
+        rc = ib_hash_set(eudoxus_pattern_hash, pattern_name, holder);
+        if (rc != IB_OK) {
+            return rc;
+        }
     }
 
     return IB_OK;
@@ -459,7 +759,7 @@ ib_status_t ee_operator_create(
     assert(instance_data != NULL);
 
     ib_status_t rc;
-    ia_eudoxus_t* eudoxus;
+    ee_automata_holder_t *holder;
     ee_operator_data_t *operator_data;
     ib_module_t *module;
     ib_engine_t *ib = ib_context_get_engine(ctx);
@@ -484,7 +784,7 @@ ib_status_t ee_operator_create(
 
     eudoxus_pattern_hash = config->eudoxus_pattern_hash;
 
-    rc = ib_hash_get(eudoxus_pattern_hash, &eudoxus, parameters);
+    rc = ib_hash_get(eudoxus_pattern_hash, &holder, parameters);
     if (rc == IB_ENOENT ) {
         ib_log_error(ib,
                      MODULE_NAME_STR ": No eudoxus automata named %s found.",
@@ -497,7 +797,7 @@ ib_status_t ee_operator_create(
         return rc;
     }
 
-    operator_data->eudoxus = eudoxus;
+    operator_data->holder = holder;
     rc = ib_uuid_create_v4(operator_data->id);
     if (rc != IB_OK) {
         ib_log_error(ib,
@@ -510,6 +810,28 @@ ib_status_t ee_operator_create(
     return IB_OK;
 }
 
+/** Input bytes between inspection-budget checks during a scan. */
+#define EE_PROGRESS_INTERVAL 4096
+
+/** Callback data for ee_progress_check(). */
+typedef struct {
+    ib_time_t deadline; /**< Absolute deadline in engine clock usec. */
+} ee_progress_t;
+
+/**
+ * Eudoxus progress callback: continue while within the budget.
+ *
+ * Lets a scan over a large body be abandoned mid-operator when the
+ * transaction exceeds its inspection budget, instead of only between
+ * rules.
+ */
+static int ee_progress_check(void *cbdata)
+{
+    const ee_progress_t *progress = (const ee_progress_t *)cbdata;
+
+    return ib_clock_get_time() <= progress->deadline;
+}
+
 /**
  * Helper function for stream and non-stream execution.
  *
@@ -568,7 +890,29 @@ ib_status_t ee_operator_execute_common(
         return IB_OK;
     }
 
+    /* Cooperative cancellation: when an inspection budget is set, the
+     * automata checks the deadline every few KB of input so a scan
+     * over a large body can be abandoned mid-operator (fail open),
+     * not just between rules. */
+    ee_progress_t progress = { 0 };
+    {
+        ib_core_cfg_t *corecfg = NULL;
+
+        if (ib_core_context_config(tx->ctx, &corecfg) == IB_OK &&
+            corecfg->inspection_budget_usec > 0)
+        {
+            progress.deadline =
+                tx->t.started + (ib_time_t)corecfg->inspection_budget_usec;
+            ia_eudoxus_set_progress_callback(
+                data->eudoxus_state,
+                ee_progress_check,
+                &progress,
+                EE_PROGRESS_INTERVAL);
+        }
+    }
+
     /* Loop until we exit by error or success. */
+    rc = IB_OK;
     for (;;) {
         ia_eudoxus_state_t  *state = data->eudoxus_state;
         ia_eudoxus_result_t  ia_rc;
@@ -582,7 +926,7 @@ ib_status_t ee_operator_execute_common(
                 /* We have a full match. Return OK. */
                 if (data->ee_cbdata->match_len == input_len) {
                     *result = 1;
-                    return IB_OK;
+                    break;
                 }
                 /* We do not have a full match. Continue matching. */
                 else {
@@ -593,22 +937,52 @@ ib_status_t ee_operator_execute_common(
             /* We have a partial or full match. Great. */
             else {
                 *result = 1;
-                return IB_OK;
+                break;
             }
         }
         else if (ia_rc == IA_EUDOXUS_END) {
             data->end_of_automata = true;
-            return IB_OK;
+            break;
+        }
+        else if (ia_rc == IA_EUDOXUS_CANCELLED) {
+            /* Budget exhausted mid-scan: fail open with no match and
+             * let the phase loop's own budget check stop the rest. */
+            ib_log_debug_tx(tx,
+                            "Inspection budget exhausted during automata "
+                            "scan; abandoning (fail open).");
+            break;
         }
         else if (ia_rc != IA_EUDOXUS_OK) {
-            return IB_EUNKNOWN;
+            rc = IB_EUNKNOWN;
+            break;
         }
         else {
-            return IB_OK;
+            break;
         }
     }
 
-    return IB_OK;
+    /* The progress callback references this frame; remove it. */
+    if (progress.deadline != 0) {
+        ia_eudoxus_set_progress_callback(
+            data->eudoxus_state, NULL, NULL, 0);
+    }
+
+    /* Surface the automata work into the engine counters, so a
+     * pathological automata/traffic mismatch (many transitions or
+     * failure edges per byte) is visible without external profiling. */
+    {
+        ia_eudoxus_metrics_t metrics;
+
+        ia_eudoxus_metrics_get(data->eudoxus_state, &metrics);
+        ia_eudoxus_metrics_reset(data->eudoxus_state);
+        ib_stats_add(tx->ib, IB_STAT_AUTOMATA_BYTES, metrics.bytes_consumed);
+        ib_stats_add(tx->ib, IB_STAT_AUTOMATA_NODES, metrics.nodes_visited);
+        ib_stats_add(tx->ib, IB_STAT_AUTOMATA_OUTPUTS, metrics.outputs_fired);
+        ib_stats_add(
+            tx->ib, IB_STAT_AUTOMATA_DEFAULTS, metrics.default_transitions);
+    }
+
+    return rc;
 }
 
 /**
@@ -642,7 +1016,7 @@ ib_status_t ee_match_operator_execute_nonstream(
     ib_status_t rc;
     ia_eudoxus_result_t ia_rc;
     ee_operator_data_t *operator_data = instance_data;
-    ia_eudoxus_t* eudoxus = operator_data->eudoxus;
+    ia_eudoxus_t* eudoxus = ee_holder_current(operator_data->holder);
 
     assert(tx != NULL);
     assert(instance_data != NULL);
@@ -762,7 +1136,7 @@ ib_status_t ee_operator_execute_stream(
     ib_status_t rc;
     ia_eudoxus_result_t ia_rc;
     ee_operator_data_t *operator_data = instance_data;
-    ia_eudoxus_t* eudoxus = operator_data->eudoxus;
+    ia_eudoxus_t* eudoxus = ee_holder_current(operator_data->holder);
     ee_tx_data_t* data = NULL;
     ee_callback_data_t *ee_cbdata;
     const ib_module_t *m = (const ib_module_t *)cbdata;
@@ -125,6 +125,14 @@ struct ErrorPageCtxConfig {
      */
     std::map<ib_num_t, boost::iostreams::mapped_file_source>
         status_to_mapped_file_source;
+
+    /**
+     * Offset of "${TRANSACTION_ID}" in each mapped page, or npos.
+     *
+     * Computed once at configuration so delivery of pages without the
+     * placeholder can alias the mapped file with no per-block work.
+     */
+    std::map<ib_num_t, size_t> status_to_placeholder;
 };
 
 /* Implementation */
@@ -173,6 +181,21 @@ void ErrorPageModule::errorPageMapDirective(
     try {
         cfg.status_to_mapped_file_source[num] =
             boost::iostreams::mapped_file_source(cfg.status_to_file[num]);
+
+        /* Locate the transaction id placeholder once. */
+        {
+            const boost::iostreams::mapped_file_source& source =
+                cfg.status_to_mapped_file_source[num];
+            static const char c_placeholder[] = "${TRANSACTION_ID}";
+            const char* found = std::search(
+                source.data(), source.data() + source.size(),
+                c_placeholder, c_placeholder + sizeof(c_placeholder) - 1
+            );
+            cfg.status_to_placeholder[num] =
+                (found == source.data() + source.size())
+                ? std::string::npos
+                : size_t(found - source.data());
+        }
     }
     catch (const std::exception& e) {
         BOOST_THROW_EXCEPTION(
@@ -209,32 +232,49 @@ void ErrorPageModule::post_block(
 #endif
     const boost::iostreams::mapped_file_source &source =
         cfg.status_to_mapped_file_source[info.status];
+    const size_t placeholder = cfg.status_to_placeholder[info.status];
 
-    /* The error page to be handed to the server is written to this
-     * output string stream. */
-    std::ostringstream error_page_output_stream;
-
-    /* Optimization: Reserve the document size + 37 characters for a UUID.
-     * We assume that the transaction ID is only replaced once. */
-    error_page_output_stream.str().reserve(source.size() + 37);
+    IronBee::ByteString body;
 
-    /* Replace holder text with transaction id. */
-    boost::algorithm::replace_all_copy(
-        /* Output iterator. */
-        std::ostream_iterator<char>(error_page_output_stream),
-
-        /* The range. */
-        std::pair<const char *, const char *>(
+    if (placeholder == std::string::npos) {
+        /* No placeholder: deliver the mapped page directly.  The
+         * mapping lives in the configuration and outlives every
+         * transaction, so no copy or allocation is needed. */
+        body = IronBee::ByteString::create_alias(
+            tx.memory_manager(),
             source.data(),
-            source.data()+ source.size()
-        ),
-
-        /* The text to replace. */
-        "${TRANSACTION_ID}",
-
-        /* What to replace the text with. */
-        tx.id()
-    );
+            source.size()
+        );
+    }
+    else {
+        /* Assemble prefix + transaction id + suffix (subsequent
+         * placeholder occurrences, if any, are replaced too). */
+        static const size_t c_placeholder_len =
+            sizeof("${TRANSACTION_ID}") - 1;
+        std::string page;
+        const char* data = source.data();
+        const char* end  = data + source.size();
+        const char* at   = data + placeholder;
+
+        page.reserve(source.size() + 37);
+        while (at != end) {
+            page.append(data, at);
+            page.append(tx.id());
+            data = at + c_placeholder_len;
+            at = std::search(
+                data, end,
+                "${TRANSACTION_ID}",
+                "${TRANSACTION_ID}" + c_placeholder_len
+            );
+        }
+        page.append(data, end);
+
+        body = IronBee::ByteString::create(
+            tx.memory_manager(),
+            page.data(),
+            page.size()
+        );
+    }
 
 #ifndef NDEBUG
     ib_log_debug2_tx(
@@ -245,12 +285,6 @@ void ErrorPageModule::post_block(
     );
 #endif
 
-    IronBee::ByteString body = IronBee::ByteString::create(
-        tx.memory_manager(),
-        error_page_output_stream.str().data(),
-        error_page_output_stream.str().size()
-    );
-
     ib_status_t rc = ib_tx_response(tx.ib(), info.status, NULL, body.ib());
     if ((rc == IB_DECLINED) || (rc == IB_ENOTIMPL)) {
         ib_log_debug2_tx(
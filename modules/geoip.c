@@ -33,8 +33,12 @@
 
 #include <GeoIP.h>
 
+#include <arpa/inet.h>
 #include <assert.h>
 #include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <strings.h>
 #include <unistd.h>
 
@@ -53,6 +57,185 @@ typedef struct {
 /* Declare the public module symbol. */
 IB_MODULE_DECLARE();
 
+/**
+ * Process-wide registry of open GeoIP database handles.
+ *
+ * Under the engine manager several engine instances coexist (the old
+ * engine drains while the new one serves), and each used to mmap its
+ * own copy of the same database file.  Handles are instead shared by
+ * path and reference counted: a reload that keeps the same
+ * GeoIPDatabaseFile reuses the already-open handle.  Lookups on a
+ * GEOIP_MMAP_CACHE handle are already made concurrently by every
+ * transaction of one engine, so sharing a handle between engines adds
+ * no new concurrency.
+ *
+ * The default database (GeoIP_new()) is registered under the empty
+ * path.
+ */
+typedef struct geoip_db_ref_t geoip_db_ref_t;
+struct geoip_db_ref_t {
+    geoip_db_ref_t *next;    /**< Next open database. */
+    char           *path;    /**< Database path; "" for the default. */
+    GeoIP          *db;      /**< The shared handle. */
+    unsigned        refcnt;  /**< Engines holding this handle. */
+};
+
+static geoip_db_ref_t  *c_geoip_dbs = NULL;
+static pthread_mutex_t  c_geoip_dbs_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Bumped whenever a database handle is closed, so lookup-cache entries
+ * tagged with a freed (and possibly reallocated) handle cannot match.
+ */
+static unsigned         c_geoip_db_generation = 0;
+
+/**
+ * Get a (possibly shared) handle for the database at @a path.
+ *
+ * @param[in] path Database file path, or NULL for the default database.
+ *
+ * @returns The handle, or NULL if the database could not be opened.
+ */
+static GeoIP *geoip_db_acquire(const char *path)
+{
+    geoip_db_ref_t *ref;
+    GeoIP          *db;
+
+    if (path == NULL) {
+        path = "";
+    }
+
+    pthread_mutex_lock(&c_geoip_dbs_lock);
+    for (ref = c_geoip_dbs; ref != NULL; ref = ref->next) {
+        if (strcmp(ref->path, path) == 0) {
+            ++ref->refcnt;
+            pthread_mutex_unlock(&c_geoip_dbs_lock);
+            return ref->db;
+        }
+    }
+
+    db = (*path == '\0')
+        ? GeoIP_new(GEOIP_MMAP_CACHE)
+        : GeoIP_open(path, GEOIP_MMAP_CACHE);
+    if (db == NULL) {
+        pthread_mutex_unlock(&c_geoip_dbs_lock);
+        return NULL;
+    }
+
+    ref = (geoip_db_ref_t *)malloc(sizeof(*ref));
+    if (ref == NULL || (ref->path = strdup(path)) == NULL) {
+        /* Hand out the handle unshared; it simply won't be reused. */
+        free(ref);
+        pthread_mutex_unlock(&c_geoip_dbs_lock);
+        return db;
+    }
+    ref->db     = db;
+    ref->refcnt = 1;
+    ref->next   = c_geoip_dbs;
+    c_geoip_dbs = ref;
+    pthread_mutex_unlock(&c_geoip_dbs_lock);
+
+    return db;
+}
+
+/**
+ * Release a handle obtained from geoip_db_acquire().
+ *
+ * The database is closed when the last holder releases it.  Handles
+ * that were handed out unshared (registry allocation failure) are
+ * closed directly.
+ */
+static void geoip_db_release(GeoIP *db)
+{
+    geoip_db_ref_t **pref;
+    geoip_db_ref_t  *ref;
+
+    if (db == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&c_geoip_dbs_lock);
+    for (pref = &c_geoip_dbs; *pref != NULL; pref = &(*pref)->next) {
+        if ((*pref)->db == db) {
+            ref = *pref;
+            if (--ref->refcnt == 0) {
+                *pref = ref->next;
+                ++c_geoip_db_generation;
+                pthread_mutex_unlock(&c_geoip_dbs_lock);
+                GeoIP_delete(ref->db);
+                free(ref->path);
+                free(ref);
+                return;
+            }
+            pthread_mutex_unlock(&c_geoip_dbs_lock);
+            return;
+        }
+    }
+    ++c_geoip_db_generation;
+    pthread_mutex_unlock(&c_geoip_dbs_lock);
+
+    GeoIP_delete(db);
+}
+
+/**
+ * Per-thread cache of country lookups, keyed by /24 prefix.
+ *
+ * Client IPs repeat heavily within short windows and country data has
+ * /24 (or coarser) granularity in practice, so the id returned by
+ * GeoIP_id_by_addr() is cached per worker thread keyed by the top 24
+ * bits of the v4 address.  Entries are tagged with the database handle
+ * they came from, so a configuration reload that opens a different
+ * database naturally misses.  The cache is direct mapped; a colliding
+ * prefix simply replaces the slot.
+ */
+#define GEOIP_CACHE_SIZE 4096
+
+typedef struct {
+    uint32_t     prefix;  /**< v4 address >> 8. */
+    const GeoIP *db;      /**< Handle the id came from; NULL = empty. */
+    unsigned     gen;     /**< c_geoip_db_generation at fill time. */
+    int          id;      /**< Cached GeoIP id; <= 0 means no record. */
+} geoip_cache_entry_t;
+
+static __thread geoip_cache_entry_t c_geoip_cache[GEOIP_CACHE_SIZE];
+
+/**
+ * Country id for @a ip, via the per-thread cache.
+ *
+ * Addresses that do not parse as IPv4 (this module only does v4
+ * lookups) fall through to the library uncached.
+ */
+static int geoip_id_cached(GeoIP *db, const char *ip)
+{
+    struct in_addr       addr;
+    uint32_t             prefix;
+    geoip_cache_entry_t *entry;
+    unsigned             gen;
+    int                  id;
+
+    if (inet_pton(AF_INET, ip, &addr) != 1) {
+        return GeoIP_id_by_addr(db, ip);
+    }
+
+    /* A handle close elsewhere invalidates every entry via the
+     * generation; a torn read here only costs a spurious miss. */
+    gen = c_geoip_db_generation;
+
+    prefix = ntohl(addr.s_addr) >> 8;
+    entry = &c_geoip_cache[(prefix * 2654435761u) % GEOIP_CACHE_SIZE];
+    if (entry->db == db && entry->gen == gen && entry->prefix == prefix) {
+        return entry->id;
+    }
+
+    id = GeoIP_id_by_addr(db, ip);
+    entry->prefix = prefix;
+    entry->db     = db;
+    entry->gen    = gen;
+    entry->id     = id;
+
+    return id;
+}
+
 /**
  * Lookup the IP address in the GeoIP database
  *
@@ -130,7 +313,7 @@ static ib_status_t geoip_lookup(
         return IB_EINVAL;
     }
 
-    geoip_id = GeoIP_id_by_addr(mod_data->geoip_db, ip);
+    geoip_id = geoip_id_cached(mod_data->geoip_db, ip);
 
     if (geoip_id > 0) {
         const char *tmp_str;
@@ -313,11 +496,11 @@ static ib_status_t geoip_database_file_dir_param1(ib_cfgparser_t *cp,
     p1_unescaped[p1_unescaped_len] = '\0';
 
     if (mod_data->geoip_db != NULL) {
-        GeoIP_delete(mod_data->geoip_db);
+        geoip_db_release(mod_data->geoip_db);
         mod_data->geoip_db = NULL;
     }
 
-    mod_data->geoip_db = GeoIP_open(p1_unescaped, GEOIP_MMAP_CACHE);
+    mod_data->geoip_db = geoip_db_acquire(p1_unescaped);
 
     if (mod_data->geoip_db == NULL) {
         int status = access(p1_unescaped, R_OK);
@@ -365,7 +548,7 @@ static ib_status_t geoip_init(ib_engine_t *ib, ib_module_t *m, void *cbdata)
     }
 
     ib_log_debug(ib, "GeoIP: Initializing default database...");
-    geoip_db = GeoIP_new(GEOIP_MMAP_CACHE);
+    geoip_db = geoip_db_acquire(NULL);
     if (geoip_db == NULL) {
         ib_log_error(ib, "GeoIP: Failed to initialize database.");
         return IB_EUNKNOWN;
@@ -423,7 +606,7 @@ static ib_status_t geoip_fini(ib_engine_t *ib, ib_module_t *m, void *cbdata)
     module_data_t *mod_data = (module_data_t *)m->data;
 
     if (mod_data->geoip_db != NULL) {
-        GeoIP_delete(mod_data->geoip_db);
+        geoip_db_release(mod_data->geoip_db);
         mod_data->geoip_db = NULL;
     }
     return IB_OK;
@@ -0,0 +1,649 @@
+/*****************************************************************************
+ * Licensed to Qualys, Inc. (QUALYS) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * QUALYS licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+/**
+ * @file
+ * @brief IronBee Modules --- Streaming JSON Body Parser
+ *
+ * A stream processor that parses application/json request bodies
+ * incrementally through yajl's SAX interface and populates configured
+ * var sources from configured JSON paths -- no DOM is ever built, and
+ * subtrees no configured path descends into cost only depth counting.
+ *
+ * Paths are configured with the JsonBodyVar directive:
+ *
+ * @code
+ * JsonBodyVar JSON_USER  user.name
+ * JsonBodyVar JSON_TOKEN auth.token
+ * @endcode
+ *
+ * which registers JSON_USER as an indexed var source filled from the
+ * "name" member of the top-level "user" object when a JSON request
+ * body streams through.  Paths are compiled into a trie at
+ * configuration time; matching at runtime is one child lookup per map
+ * key on the matched spine, and arrays are transparent (a path
+ * matches members of objects at any array nesting).  Scalar values are
+ * stored as byte strings, preserving the raw number text.
+ *
+ * The processor observes and forwards the stream unchanged, so
+ * downstream processors and rules are unaffected.
+ */
+
+#include <ironbee/bytestr.h>
+#include <ironbee/context.h>
+#include <ironbee/engine.h>
+#include <ironbee/engine_state.h>
+#include <ironbee/field.h>
+#include <ironbee/list.h>
+#include <ironbee/mm.h>
+#include <ironbee/module.h>
+#include <ironbee/parsed_content.h>
+#include <ironbee/stream_io.h>
+#include <ironbee/stream_processor.h>
+#include <ironbee/stream_pump.h>
+#include <ironbee/string.h>
+#include <ironbee/var.h>
+
+#include <yajl/yajl_parse.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+/* Define the module name as well as a string version of it. */
+#define MODULE_NAME        json_body
+#define MODULE_NAME_STR    IB_XSTRINGIFY(MODULE_NAME)
+
+IB_MODULE_DECLARE();
+
+/** Name the processor is registered (and inserted) under. */
+#define JSON_BODY_PROCESSOR_NAME "json_body"
+
+/** Maximum tracked container depth; deeper content is skipped. */
+#define JSON_BODY_MAX_DEPTH 64
+
+/**
+ * One node of the compiled path trie.
+ *
+ * Built at configuration time from JsonBodyVar directives and read
+ * only at runtime.
+ */
+typedef struct json_path_node_t json_path_node_t;
+struct json_path_node_t {
+    const char       *seg;     /**< Path segment (member name). */
+    size_t            seg_len; /**< Length of seg. */
+    json_path_node_t *child;   /**< First child segment. */
+    json_path_node_t *sibling; /**< Next sibling segment. */
+    ib_var_source_t  *source;  /**< Var to fill; non-NULL on terminals. */
+};
+
+/**
+ * Module data.
+ */
+typedef struct {
+    ib_module_t      *module; /**< This module. */
+    json_path_node_t *root;   /**< Path trie root (children only). */
+    size_t            n_paths; /**< Configured paths. */
+} json_body_moddata_t;
+
+/**
+ * Processor instance, allocated from transaction memory.
+ *
+ * The node stack mirrors the container stack of the document: each
+ * entry is the trie node the container is matched to, or NULL inside
+ * subtrees no configured path descends into (where callbacks only
+ * maintain depth).  Map keys select the child for the value that
+ * follows; arrays push their container's node unchanged.
+ */
+typedef struct {
+    const json_body_moddata_t *moddata; /**< Module data. */
+    ib_tx_t                *tx;         /**< The transaction. */
+    yajl_handle             handle;     /**< Incremental parser. */
+    bool                    failed;     /**< Parse failed; stop feeding. */
+
+    const json_path_node_t *node_stack[JSON_BODY_MAX_DEPTH]; /**< Matches. */
+    bool                    is_map[JSON_BODY_MAX_DEPTH]; /**< Map or array. */
+    size_t                  depth;      /**< Containers on the stack. */
+
+    const json_path_node_t *value_node; /**< Node for the next value. */
+} json_body_inst_t;
+
+/**
+ * Find the child of @a node named @a seg, or NULL.
+ */
+static const json_path_node_t *json_path_child(
+    const json_path_node_t *node,
+    const char             *seg,
+    size_t                  seg_len
+)
+{
+    if (node == NULL) {
+        return NULL;
+    }
+
+    for (const json_path_node_t *c = node->child; c != NULL; c = c->sibling) {
+        if (c->seg_len == seg_len && memcmp(c->seg, seg, seg_len) == 0) {
+            return c;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Store a scalar into the var the current value node targets, if any.
+ */
+static int json_body_scalar(
+    json_body_inst_t *inst,
+    const char       *data,
+    size_t            data_len
+)
+{
+    const json_path_node_t *node = inst->value_node;
+    ib_bytestr_t           *bs;
+    ib_field_t             *field;
+    ib_status_t             rc;
+
+    /* A scalar consumes the pending value node. */
+    inst->value_node =
+        (inst->depth > 0 && inst->depth <= JSON_BODY_MAX_DEPTH &&
+         ! inst->is_map[inst->depth - 1])
+        ? inst->node_stack[inst->depth - 1]
+        : NULL;
+
+    if (node == NULL || node->source == NULL) {
+        return 1;
+    }
+
+    rc = ib_bytestr_dup_mem(
+        &bs, inst->tx->mm, (const uint8_t *)data, data_len);
+    if (rc != IB_OK) {
+        return 0;
+    }
+    rc = ib_field_create(
+        &field, inst->tx->mm,
+        node->seg, node->seg_len,
+        IB_FTYPE_BYTESTR,
+        ib_ftype_bytestr_in(bs));
+    if (rc != IB_OK) {
+        return 0;
+    }
+    rc = ib_var_source_set(node->source, inst->tx->var_store, field);
+
+    return (rc == IB_OK) ? 1 : 0;
+}
+
+/* yajl SAX callbacks.  Returning 0 cancels the parse. */
+
+static int json_body_on_null(void *ctx)
+{
+    json_body_inst_t *inst = (json_body_inst_t *)ctx;
+
+    /* Consume the value node; nulls are not materialized. */
+    inst->value_node =
+        (inst->depth > 0 && inst->depth <= JSON_BODY_MAX_DEPTH &&
+         ! inst->is_map[inst->depth - 1])
+        ? inst->node_stack[inst->depth - 1]
+        : NULL;
+    return 1;
+}
+
+static int json_body_on_boolean(void *ctx, int value)
+{
+    return json_body_scalar(
+        (json_body_inst_t *)ctx,
+        value ? "true" : "false",
+        value ? 4 : 5);
+}
+
+static int json_body_on_number(void *ctx, const char *data, size_t data_len)
+{
+    return json_body_scalar((json_body_inst_t *)ctx, data, data_len);
+}
+
+static int json_body_on_string(
+    void                *ctx,
+    const unsigned char *data,
+    size_t               data_len
+)
+{
+    return json_body_scalar(
+        (json_body_inst_t *)ctx, (const char *)data, data_len);
+}
+
+static int json_body_on_start_container(void *ctx, bool map)
+{
+    json_body_inst_t       *inst = (json_body_inst_t *)ctx;
+    const json_path_node_t *node = inst->value_node;
+
+    if (inst->depth < JSON_BODY_MAX_DEPTH) {
+        inst->node_stack[inst->depth] = node;
+        inst->is_map[inst->depth]     = map;
+    }
+    ++inst->depth;
+
+    /* Array elements inherit the array's node; map values wait for a
+     * key. */
+    inst->value_node = map ? NULL : node;
+    return 1;
+}
+
+static int json_body_on_start_map(void *ctx)
+{
+    return json_body_on_start_container(ctx, true);
+}
+
+static int json_body_on_start_array(void *ctx)
+{
+    return json_body_on_start_container(ctx, false);
+}
+
+static int json_body_on_map_key(
+    void                *ctx,
+    const unsigned char *key,
+    size_t               key_len
+)
+{
+    json_body_inst_t *inst = (json_body_inst_t *)ctx;
+
+    if (inst->depth == 0 || inst->depth > JSON_BODY_MAX_DEPTH) {
+        inst->value_node = NULL;
+        return 1;
+    }
+
+    inst->value_node = json_path_child(
+        inst->node_stack[inst->depth - 1], (const char *)key, key_len);
+    return 1;
+}
+
+static int json_body_on_end_container(void *ctx)
+{
+    json_body_inst_t *inst = (json_body_inst_t *)ctx;
+
+    if (inst->depth > 0) {
+        --inst->depth;
+    }
+
+    /* The finished container was a value; the next value's node
+     * depends on the enclosing container as for scalars. */
+    inst->value_node =
+        (inst->depth > 0 && inst->depth <= JSON_BODY_MAX_DEPTH &&
+         ! inst->is_map[inst->depth - 1])
+        ? inst->node_stack[inst->depth - 1]
+        : NULL;
+    return 1;
+}
+
+static yajl_callbacks json_body_callbacks = {
+    json_body_on_null,
+    json_body_on_boolean,
+    NULL,                     /* Integer; raw number used instead. */
+    NULL,                     /* Double; raw number used instead. */
+    json_body_on_number,
+    json_body_on_string,
+    json_body_on_start_map,
+    json_body_on_map_key,
+    json_body_on_end_container,
+    json_body_on_start_array,
+    json_body_on_end_container
+};
+
+/**
+ * Is this transaction's request body JSON?
+ */
+static bool json_body_tx_is_json(const ib_tx_t *tx)
+{
+    const ib_parsed_header_t *header;
+
+    if (tx->request_header == NULL) {
+        return false;
+    }
+
+    for (header = tx->request_header->head;
+         header != NULL;
+         header = header->next)
+    {
+        if (ib_bytestr_length(header->name) == 12 &&
+            strncasecmp(
+                (const char *)ib_bytestr_const_ptr(header->name),
+                "Content-Type", 12) == 0)
+        {
+            const char *value =
+                (const char *)ib_bytestr_const_ptr(header->value);
+            size_t      value_len = ib_bytestr_length(header->value);
+
+            static const char ct[] = "application/json";
+            return
+                value_len >= sizeof(ct) - 1 &&
+                strncasecmp(value, ct, sizeof(ct) - 1) == 0;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Processor create function.
+ */
+static ib_status_t json_body_create_fn(
+    void    *inst_data,
+    ib_tx_t *tx,
+    void    *cbdata
+)
+{
+    assert(inst_data != NULL);
+    assert(tx != NULL);
+    assert(cbdata != NULL);
+
+    json_body_moddata_t *moddata = (json_body_moddata_t *)cbdata;
+    json_body_inst_t    *inst;
+
+    inst = ib_mm_calloc(tx->mm, sizeof(*inst), 1);
+    if (inst == NULL) {
+        return IB_EALLOC;
+    }
+
+    inst->moddata = moddata;
+    inst->tx      = tx;
+
+    inst->handle = yajl_alloc(&json_body_callbacks, NULL, inst);
+    if (inst->handle == NULL) {
+        return IB_EALLOC;
+    }
+
+    /* The document root is a value whose node is the trie root. */
+    inst->value_node = moddata->root;
+
+    *(json_body_inst_t **)inst_data = inst;
+    return IB_OK;
+}
+
+/**
+ * Processor destroy function: release the yajl handle.
+ */
+static void json_body_destroy_fn(void *inst_data, void *cbdata)
+{
+    json_body_inst_t *inst = (json_body_inst_t *)inst_data;
+
+    if (inst != NULL && inst->handle != NULL) {
+        yajl_free(inst->handle);
+        inst->handle = NULL;
+    }
+}
+
+/**
+ * Processor execute function: feed yajl, forward everything unchanged.
+ */
+static ib_status_t json_body_execute_fn(
+    void              *inst_data,
+    ib_tx_t           *tx,
+    ib_mm_t            mm_eval,
+    ib_stream_io_tx_t *io_tx,
+    void              *cbdata
+)
+{
+    assert(inst_data != NULL);
+    assert(tx != NULL);
+
+    json_body_inst_t *inst = (json_body_inst_t *)inst_data;
+    ib_status_t       rc;
+
+    while (ib_stream_io_data_depth(io_tx) > 0) {
+        ib_stream_io_data_t *data;
+        uint8_t             *ptr;
+        size_t               len;
+        ib_stream_io_type_t  type;
+
+        rc = ib_stream_io_data_take(io_tx, &data, &ptr, &len, &type);
+        if (rc != IB_OK) {
+            return rc;
+        }
+
+        if (type == IB_STREAM_IO_DATA &&
+            ptr != NULL && len > 0 &&
+            ! inst->failed &&
+            inst->handle != NULL)
+        {
+            if (yajl_parse(inst->handle, ptr, len) != yajl_status_ok) {
+                /* Malformed (or canceled on allocation failure): stop
+                 * feeding, keep forwarding. */
+                inst->failed = true;
+                ib_log_info_tx(tx, "JSON body: parse stopped; "
+                               "vars populated up to this point only.");
+            }
+        }
+
+        rc = ib_stream_io_data_put(io_tx, data);
+        if (rc != IB_OK) {
+            return rc;
+        }
+    }
+
+    return IB_OK;
+}
+
+/**
+ * Handle the JsonBodyVar directive: register a var for a JSON path.
+ */
+static ib_status_t json_body_var_dir_param2(
+    ib_cfgparser_t *cp,
+    const char     *name,
+    const char     *p1,
+    const char     *p2,
+    void           *cbdata
+)
+{
+    assert(cp != NULL);
+    assert(p1 != NULL);
+    assert(p2 != NULL);
+    assert(cbdata != NULL);
+
+    json_body_moddata_t *moddata = (json_body_moddata_t *)cbdata;
+    ib_engine_t         *ib = cp->ib;
+    ib_mm_t              mm = ib_engine_mm_main_get(ib);
+    ib_var_source_t     *source;
+    json_path_node_t    *node;
+    const char          *seg = p2;
+    ib_status_t          rc;
+
+    if (*p1 == '\0' || *p2 == '\0') {
+        ib_cfg_log_error(cp, "JsonBodyVar: empty var name or path.");
+        return IB_EINVAL;
+    }
+
+    /* Register (or reuse) the indexed var source. */
+    rc = ib_var_source_register(
+        &source,
+        ib_engine_var_config_get(ib),
+        IB_S2SL(p1),
+        IB_PHASE_NONE, IB_PHASE_NONE);
+    if (rc == IB_EEXIST) {
+        rc = ib_var_source_acquire(
+            &source, mm, ib_engine_var_config_get(ib), IB_S2SL(p1));
+    }
+    if (rc != IB_OK) {
+        ib_cfg_log_error(cp, "JsonBodyVar: Error registering var \"%s\": %s",
+                         p1, ib_status_to_string(rc));
+        return rc;
+    }
+
+    /* Descend/extend the trie segment by segment. */
+    {
+        json_path_node_t *parent = moddata->root;
+
+        while (*seg != '\0') {
+            const char *dot = strchr(seg, '.');
+            size_t      seg_len = (dot != NULL)
+                ? (size_t)(dot - seg)
+                : strlen(seg);
+            json_path_node_t *child;
+
+            if (seg_len == 0) {
+                ib_cfg_log_error(cp, "JsonBodyVar: malformed path \"%s\".", p2);
+                return IB_EINVAL;
+            }
+
+            child = (json_path_node_t *)json_path_child(parent, seg, seg_len);
+            if (child == NULL) {
+                child = ib_mm_calloc(mm, sizeof(*child), 1);
+                if (child == NULL) {
+                    return IB_EALLOC;
+                }
+                child->seg = ib_mm_memdup(mm, seg, seg_len);
+                if (child->seg == NULL) {
+                    return IB_EALLOC;
+                }
+                child->seg_len = seg_len;
+                child->sibling = parent->child;
+                parent->child  = child;
+            }
+
+            parent = child;
+            seg = (dot != NULL) ? dot + 1 : seg + seg_len;
+        }
+
+        if (parent == moddata->root) {
+            ib_cfg_log_error(cp, "JsonBodyVar: malformed path \"%s\".", p2);
+            return IB_EINVAL;
+        }
+        node = (json_path_node_t *)parent;
+    }
+
+    node->source = source;
+    ++moddata->n_paths;
+
+    return IB_OK;
+}
+
+/**
+ * Insert the processor into the request pump for JSON requests.
+ */
+static ib_status_t json_body_on_request_header_finished(
+    ib_engine_t *ib,
+    ib_tx_t     *tx,
+    ib_state_t   state,
+    void        *cbdata
+)
+{
+    assert(ib != NULL);
+    assert(tx != NULL);
+    assert(state == request_header_finished_state);
+    assert(cbdata != NULL);
+
+    json_body_moddata_t *moddata = (json_body_moddata_t *)cbdata;
+    ib_status_t          rc;
+
+    if (moddata->n_paths == 0 || ! json_body_tx_is_json(tx)) {
+        return IB_OK;
+    }
+
+    rc = ib_stream_pump_processor_add(
+        ib_tx_request_body_pump(tx),
+        JSON_BODY_PROCESSOR_NAME);
+    if (rc != IB_OK && rc != IB_DECLINED) {
+        ib_log_error_tx(tx, "JSON body: Error adding processor: %s",
+                        ib_status_to_string(rc));
+        /* Inspection proceeds without JSON vars. */
+    }
+
+    return IB_OK;
+}
+
+static ib_dirmap_init_t json_body_directive_map[] = {
+    IB_DIRMAP_INIT_PARAM2(
+        "JsonBodyVar",
+        json_body_var_dir_param2,
+        NULL                            /* Filled in by the init function */
+    ),
+
+    /* signal the end of the list */
+    IB_DIRMAP_INIT_LAST
+};
+
+/* Called when module is loaded. */
+static ib_status_t json_body_init(ib_engine_t *ib, ib_module_t *m, void *cbdata)
+{
+    assert(ib != NULL);
+    assert(m != NULL);
+
+    json_body_moddata_t *moddata;
+    ib_list_t           *types;
+    ib_mm_t              mm = ib_engine_mm_main_get(ib);
+    ib_status_t          rc;
+
+    moddata = ib_mm_calloc(mm, sizeof(*moddata), 1);
+    if (moddata == NULL) {
+        return IB_EALLOC;
+    }
+    moddata->module = m;
+    moddata->root = ib_mm_calloc(mm, sizeof(*moddata->root), 1);
+    if (moddata->root == NULL) {
+        return IB_EALLOC;
+    }
+
+    rc = ib_list_create(&types, mm);
+    if (rc != IB_OK) {
+        return rc;
+    }
+    rc = ib_list_push(types, (void *)"application/json");
+    if (rc != IB_OK) {
+        return rc;
+    }
+
+    rc = ib_stream_processor_registry_register(
+        ib_engine_stream_processor_registry(ib),
+        JSON_BODY_PROCESSOR_NAME,
+        types,
+        json_body_create_fn, moddata,
+        json_body_execute_fn, NULL,
+        json_body_destroy_fn, NULL
+    );
+    if (rc != IB_OK) {
+        ib_log_error(ib, "JSON body: Error registering stream processor: %s",
+                     ib_status_to_string(rc));
+        return rc;
+    }
+
+    rc = ib_hook_tx_register(
+        ib,
+        request_header_finished_state,
+        json_body_on_request_header_finished,
+        moddata);
+    if (rc != IB_OK) {
+        return rc;
+    }
+
+    m->data = moddata;
+    json_body_directive_map[0].cbdata_cb = moddata;
+
+    return IB_OK;
+}
+
+/* Initialize the module structure. */
+IB_MODULE_INIT(
+    IB_MODULE_HEADER_DEFAULTS,           /* Default metadata */
+    MODULE_NAME_STR,                     /* Module name */
+    IB_MODULE_CONFIG_NULL,               /* Global config data */
+    NULL,                                /* Configuration field map */
+    json_body_directive_map,             /* Config directive map */
+    json_body_init,                      /* Initialize function */
+    NULL,                                /* Callback data */
+    NULL,                                /* Finish function */
+    NULL,                                /* Callback data */
+);
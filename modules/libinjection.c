@@ -766,7 +766,7 @@ static ib_status_t sqli_init(ib_engine_t *ib, ib_module_t *m, void *cbdata)
         NULL,
         ib,
         "is_sqli",
-        IB_OP_CAPABILITY_CAPTURE,
+        IB_OP_CAPABILITY_CAPTURE | IB_OP_CAPABILITY_PURE,
         sqli_op_create, m,
         NULL, NULL,
         sqli_op_execute, NULL
@@ -780,7 +780,7 @@ static ib_status_t sqli_init(ib_engine_t *ib, ib_module_t *m, void *cbdata)
         NULL,
         ib,
         "is_xss",
-        IB_OP_CAPABILITY_NONE,
+        IB_OP_CAPABILITY_PURE,
         NULL, NULL,
         NULL, NULL,
         xss_op_execute, NULL
@@ -327,9 +327,11 @@ ib_status_t modlua_context_close(
         cfg->lua_resource = NULL;
         cfg->L = NULL;
 
-        rc = ib_resource_pool_flush(cfg->lua_pool);
-        if (rc != IB_OK) {
-            return rc;
+        for (int i = 0; i < MODLUA_POOL_SHARDS; ++i) {
+            rc = ib_resource_pool_flush(cfg->lua_pools[i]);
+            if (rc != IB_OK) {
+                return rc;
+            }
         }
     }
 
@@ -590,14 +592,16 @@ static ib_status_t modlua_init(
         return rc;
     }
 
-    rc = ib_lock_create(&(cfg->lua_pool_lock), mm);
-    if (rc != IB_OK) {
-        ib_log_error(ib, "Failed to configure Lua resource pool lock.");
-        return rc;
+    for (int i = 0; i < MODLUA_POOL_SHARDS; ++i) {
+        rc = ib_lock_create(&(cfg->lua_pool_locks[i]), mm);
+        if (rc != IB_OK) {
+            ib_log_error(ib, "Failed to configure Lua resource pool lock.");
+            return rc;
+        }
     }
 
     rc = modlua_runtime_resource_pool_create(
-        &(cfg->lua_pool),
+        cfg->lua_pools,
         ib,
         module,
         mm,
@@ -608,7 +612,7 @@ static ib_status_t modlua_init(
     }
 
     /* Set up defaults */
-    rc = ib_resource_acquire(cfg->lua_pool, &(cfg->lua_resource));
+    rc = ib_resource_acquire(cfg->lua_pools[0], &(cfg->lua_resource));
     if (rc != IB_OK) {
         ib_log_error(ib, "Failed to create Lua stack.");
         return rc;
@@ -1048,14 +1052,20 @@ static ib_status_t modlua_dir_param1(
             return IB_EINVAL;
         }
 
-        rc = ib_resource_pool_set_max(cfg->lua_pool, (size_t)limit);
-        if (rc != IB_OK) {
-            ib_cfg_log_error(
-                cp,
-                "%s parameter must not be less than LuaStackMin: %s",
-                name,
-                p1);
-            return rc;
+        /* The limit is global; spread it across the shards. */
+        for (int i = 0; i < MODLUA_POOL_SHARDS; ++i) {
+            rc = ib_resource_pool_set_max(
+                cfg->lua_pools[i],
+                ((size_t)limit + MODLUA_POOL_SHARDS - 1) / MODLUA_POOL_SHARDS
+            );
+            if (rc != IB_OK) {
+                ib_cfg_log_error(
+                    cp,
+                    "%s parameter must not be less than LuaStackMin: %s",
+                    name,
+                    p1);
+                return rc;
+            }
         }
     }
     else if (strcasecmp("LuaStackMin", name) == 0) {
@@ -1076,14 +1086,20 @@ static ib_status_t modlua_dir_param1(
             return IB_EINVAL;
         }
 
-        rc = ib_resource_pool_set_min(cfg->lua_pool, (size_t)limit);
-        if (rc != IB_OK) {
-            ib_cfg_log_error(
-                cp,
-                "%s parameter must not be greater than LuaStackMax: %s",
-                name,
-                p1);
-            return rc;
+        /* The limit is global; spread it across the shards. */
+        for (int i = 0; i < MODLUA_POOL_SHARDS; ++i) {
+            rc = ib_resource_pool_set_min(
+                cfg->lua_pools[i],
+                (size_t)limit / MODLUA_POOL_SHARDS
+            );
+            if (rc != IB_OK) {
+                ib_cfg_log_error(
+                    cp,
+                    "%s parameter must not be greater than LuaStackMax: %s",
+                    name,
+                    p1);
+                return rc;
+            }
         }
     }
     else if (strcasecmp("LuaLoadModule", name) == 0) {
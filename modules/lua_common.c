@@ -23,26 +23,220 @@
  */
 
 #include "lua_common_private.h"
+#include "lua_private.h"
 
+#include <ironbee/context.h>
+#include <ironbee/hash.h>
+#include <ironbee/lock.h>
 #include <ironbee/types.h>
 
+#include <lauxlib.h>
 #include <lua.h>
+
 #include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <string.h>
+
+/** Accumulation buffer for chunk_writer(). */
+typedef struct {
+    char   *data; /**< Bytecode written so far. */
+    size_t  len;  /**< Bytes used. */
+    size_t  cap;  /**< Bytes allocated. */
+} chunk_buffer_t;
 
-ib_status_t ib_lua_load_eval(ib_engine_t *ib, lua_State *L, const char *file)
+/**
+ * lua_Writer that appends dumped bytecode to a @ref chunk_buffer_t.
+ *
+ * @param[in] L Lua state; unused.
+ * @param[in] p Bytes to append.
+ * @param[in] sz Number of bytes in @a p.
+ * @param[in] ud The @ref chunk_buffer_t to append to.
+ *
+ * @returns 0 on success, nonzero on allocation failure.
+ */
+static int chunk_writer(lua_State *L, const void *p, size_t sz, void *ud)
+{
+    chunk_buffer_t *buf = (chunk_buffer_t *)ud;
+
+    if (buf->len + sz > buf->cap) {
+        size_t new_cap = (buf->cap == 0) ? 4096 : buf->cap;
+        char *tmp;
+
+        while (new_cap < buf->len + sz) {
+            new_cap *= 2;
+        }
+        tmp = realloc(buf->data, new_cap);
+        if (tmp == NULL) {
+            return 1;
+        }
+        buf->data = tmp;
+        buf->cap  = new_cap;
+    }
+
+    memcpy(buf->data + buf->len, p, sz);
+    buf->len += sz;
+
+    return 0;
+}
+
+/**
+ * Process-wide compiled chunk cache, shared across engine reloads.
+ *
+ * A configuration reload previously re-read and re-parsed every Lua
+ * rule and module file because the chunk cache lived in the engine
+ * being replaced.  Compiled chunks are instead kept per process, keyed
+ * by path and validated by file modification time: a reload whose
+ * files are unchanged loads dumped bytecode for all of them and skips
+ * parsing entirely.  A changed file replaces its entry.
+ *
+ * Execution of the chunks (which registers rules and modules) remains
+ * serial: it drives single-threaded configuration-time engine APIs,
+ * which is also why compiling rule files on a pool of parallel states
+ * would not help -- files arrive one directive at a time and their
+ * execution dominates once parsing is cached.
+ */
+typedef struct lua_chunk_entry_t lua_chunk_entry_t;
+struct lua_chunk_entry_t {
+    lua_chunk_entry_t *next;  /**< Next entry in bucket. */
+    char              *path;  /**< Source file (malloc). */
+    time_t             mtime; /**< Modification time at compile. */
+    char              *data;  /**< Dumped bytecode (malloc). */
+    size_t             len;   /**< Length of data. */
+};
+
+/** Bucket count for the chunk cache. */
+#define LUA_CHUNK_CACHE_BUCKETS 256
+
+static lua_chunk_entry_t *c_chunk_cache[LUA_CHUNK_CACHE_BUCKETS];
+static pthread_mutex_t    c_chunk_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/** Bucket index for @a path (djb2). */
+static size_t lua_chunk_bucket(const char *path)
+{
+    size_t hash = 5381;
+
+    while (*path != '\0') {
+        hash = hash * 33 + (unsigned char)*path;
+        ++path;
+    }
+
+    return hash % LUA_CHUNK_CACHE_BUCKETS;
+}
+
+ib_status_t ib_lua_load_cached(
+    ib_engine_t *ib,
+    lua_State   *L,
+    const char  *file
+)
 {
     assert(ib   != NULL);
     assert(L    != NULL);
     assert(file != NULL);
 
-    int lua_rc = luaL_loadfile(L, file);
+    lua_chunk_entry_t *entry;
+    struct stat        file_info;
+    time_t             mtime = 0;
+    size_t             bucket = lua_chunk_bucket(file);
 
-    if (lua_rc != 0) {
-        ib_log_error(ib, "Error loading \"%s\": %s (%d)",
+    if (stat(file, &file_info) == 0) {
+        mtime = file_info.st_mtime;
+    }
+
+    /* Serve a cached compilation of this file version. */
+    pthread_mutex_lock(&c_chunk_cache_lock);
+    for (entry = c_chunk_cache[bucket]; entry != NULL; entry = entry->next) {
+        if (entry->mtime == mtime && strcmp(entry->path, file) == 0) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&c_chunk_cache_lock);
+
+    if (entry != NULL) {
+        /* Entries are immutable and never freed while reachable, so
+         * using one after unlock is safe. */
+        if (luaL_loadbuffer(L, entry->data, entry->len, file) != 0) {
+            ib_log_error(ib, "Error loading cached chunk \"%s\": %s",
+                         file,
+                         lua_tostring(L, -1));
+            lua_pop(L, 1);
+            return IB_EINVAL;
+        }
+        return IB_OK;
+    }
+
+    if (luaL_loadfile(L, file) != 0) {
+        ib_log_error(ib, "Error loading \"%s\": %s",
                      file,
-                     lua_tostring(L, -1),
-                     lua_rc);
-        lua_pop(L, -1);
+                     lua_tostring(L, -1));
+        lua_pop(L, 1);
+        return IB_EINVAL;
+    }
+
+    /* Cache the compiled chunk for future stacks and future engines.
+     * Failures here only cost the caching, never the load. */
+    {
+        chunk_buffer_t buf = { NULL, 0, 0 };
+
+        if (lua_dump(L, chunk_writer, &buf) == 0 && buf.len > 0) {
+            entry = (lua_chunk_entry_t *)malloc(sizeof(*entry));
+            if (entry != NULL) {
+                entry->path = strdup(file);
+                entry->data = (char *)malloc(buf.len);
+                if (entry->path == NULL || entry->data == NULL) {
+                    free(entry->path);
+                    free(entry->data);
+                    free(entry);
+                    entry = NULL;
+                }
+            }
+            if (entry != NULL) {
+                memcpy(entry->data, buf.data, buf.len);
+                entry->len   = buf.len;
+                entry->mtime = mtime;
+
+                pthread_mutex_lock(&c_chunk_cache_lock);
+
+                /* Drop stale versions of this file.  A stale entry may
+                 * still be referenced by a concurrent reader between
+                 * its lookup and loadbuffer, so retire rather than
+                 * free: the leak is bounded by file changes within one
+                 * process lifetime. */
+                for (lua_chunk_entry_t **pe = &c_chunk_cache[bucket];
+                     *pe != NULL;
+                     /* advanced in body */)
+                {
+                    if (strcmp((*pe)->path, file) == 0) {
+                        *pe = (*pe)->next;
+                    }
+                    else {
+                        pe = &(*pe)->next;
+                    }
+                }
+
+                entry->next = c_chunk_cache[bucket];
+                c_chunk_cache[bucket] = entry;
+                pthread_mutex_unlock(&c_chunk_cache_lock);
+            }
+        }
+        free(buf.data);
+    }
+
+    return IB_OK;
+}
+
+ib_status_t ib_lua_load_eval(ib_engine_t *ib, lua_State *L, const char *file)
+{
+    assert(ib   != NULL);
+    assert(L    != NULL);
+    assert(file != NULL);
+
+    int lua_rc;
+    ib_status_t ib_rc = ib_lua_load_cached(ib, L, file);
+
+    if (ib_rc != IB_OK) {
         return IB_EINVAL;
     }
 
@@ -96,18 +290,9 @@ ib_status_t ib_lua_load_func(
     assert(func_name != NULL);
 
     /* Load (compile) the lua module. */
-    ib_status_t ib_rc = luaL_loadfile(L, file);
+    ib_status_t ib_rc = ib_lua_load_cached(ib, L, file);
 
-    if (ib_rc != 0) {
-        ib_log_error(
-            ib,
-            "Error loading file module \"%s\": %s (%d)",
-            file,
-            lua_tostring(L, -1),
-            ib_rc);
-
-        /* Get error string off the stack. */
-        lua_pop(L, 1);
+    if (ib_rc != IB_OK) {
         return IB_EINVAL;
     }
 
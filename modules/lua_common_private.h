@@ -49,6 +49,30 @@
  */
 ib_status_t ib_lua_load_eval(ib_engine_t *ib, lua_State *L, const char *file);
 
+/**
+ * Load the chunk of @a file onto @a L, compiling it once per process.
+ *
+ * The first load of a file compiles it and stores the dumped bytecode
+ * in a process-wide cache validated by file modification time; later
+ * loads -- new Lua stacks replaying the reload list, or a whole new
+ * engine during a configuration reload -- load the bytecode instead of
+ * re-reading and re-parsing the file.  On success the compiled
+ * function is left on top of the stack.
+ *
+ * @param[in] ib IronBee engine used for logging and the cache.
+ * @param[in,out] L The Lua state to load the chunk into.
+ * @param[in] file File holding the Lua source.
+ *
+ * @returns
+ * - IB_OK On success.
+ * - IB_EINVAL On compilation or load failure.
+ */
+ib_status_t ib_lua_load_cached(
+    ib_engine_t *ib,
+    lua_State   *L,
+    const char  *file
+);
+
 /**
  * Add a lua rule stored in a file to the Ironbee engine.
  *
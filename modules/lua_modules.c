@@ -2206,8 +2206,6 @@ static ib_status_t modlua_load_module_push_stack(
     assert(L      != NULL);
     assert(lua_checkstack(L, 8));
 
-    int lua_rc;
-
     lua_getglobal(L, "modlua"); /* Get the package. */
     if (lua_isnil(L, -1)) {
         ib_log_error(ib, "Module modlua is undefined.");
@@ -2243,44 +2241,12 @@ static ib_status_t modlua_load_module_push_stack(
         lua_pushnil(L);
     }
 
-    lua_rc = luaL_loadfile(L, file);
-    switch(lua_rc) {
-        case 0:
-            /* NOP */
-            break;
-        case LUA_ERRSYNTAX:
-            ib_log_error(
-                ib,
-                "Syntax error evaluating %s: %s",
-                file,
-                lua_tostring(L, -1));
-            lua_pop(L, 1); /* Get error string off of the stack. */
-            lua_pop(L, 1); /* Pop modlua global off stack. */
-            return IB_EINVAL;
-        case LUA_ERRMEM:
-            ib_log_error(
-                ib,
-                "Failed to allocate memory during load of %s",
-                file);
-            lua_pop(L, 1); /* Pop modlua global off stack. */
-            return IB_EINVAL;
-        case LUA_ERRFILE:
-            ib_log_error(
-                ib,
-                "Failed to load %s",
-                file);
-            lua_pop(L, 1); /* Pop modlua global off stack. */
-            return IB_EINVAL;
-        default:
-            ib_log_error(
-                ib,
-                "Unexpected error(%d) during evaluation of %s: %s",
-                lua_rc,
-                file,
-                lua_tostring(L, -1));
-            lua_pop(L, 1); /* Get error string off of the stack. */
-            lua_pop(L, 1); /* Pop modlua global off stack. */
-            return IB_EINVAL;
+    /* Load (compile or fetch from the chunk cache) the module file.
+     * Errors, including their stack cleanup, are handled and logged by
+     * ib_lua_load_cached(). */
+    if (ib_lua_load_cached(ib, L, file) != IB_OK) {
+        lua_pop(L, 1); /* Pop modlua global off stack. */
+        return IB_EINVAL;
     }
 
     return IB_OK;
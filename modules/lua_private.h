@@ -48,6 +48,9 @@
  */
 typedef struct modlua_runtime_cfg_t modlua_runtime_cfg_t;
 
+/** Number of independently locked Lua stack pool shards. */
+#define MODLUA_POOL_SHARDS 4
+
 //! Module configuration.
 struct modlua_cfg_t {
     char                 *pkg_path;      /**< Package path Lua Configuration. */
@@ -55,8 +58,17 @@ struct modlua_cfg_t {
     char                 *module_path;   /**< Path to Lua modules. */
     ib_list_t            *reloads;       /**< modlua_reload_t list. */
     ib_list_t            *waggle_rules;  /**< Waggle rules to execute. */
-    ib_resource_pool_t   *lua_pool;      /**< Pool of Lua stacks. */
-    ib_lock_t            *lua_pool_lock; /**< Pool lock. */
+    /**
+     * Pool shards of Lua stacks, each guarded by its own lock.
+     *
+     * Workers pick a shard by thread so concurrent transactions contend
+     * on different locks instead of one global pool mutex; stack
+     * creation inside one shard no longer blocks acquisitions from the
+     * others.
+     */
+    ib_resource_pool_t   *lua_pools[MODLUA_POOL_SHARDS];
+    ib_lock_t            *lua_pool_locks[MODLUA_POOL_SHARDS]; /**< Shard locks. */
+
     modlua_runtime_cfg_t *lua_pool_cfg;  /**< Pool configuration. */
     ib_resource_t        *lua_resource;  /**< Resource modlua_cfg_t::L. */
     lua_State            *L;             /**< Lua stack used for config. */
@@ -669,7 +669,7 @@ ib_status_t modlua_runtime_cfg_set_stack_use_limit(
 }
 
 ib_status_t modlua_runtime_resource_pool_create(
-    ib_resource_pool_t   **resource_pool,
+    ib_resource_pool_t   **resource_pools,
     ib_engine_t           *ib,
     ib_module_t           *module,
     ib_mm_t                mm,
@@ -677,7 +677,7 @@ ib_status_t modlua_runtime_resource_pool_create(
 )
 {
 
-    assert(resource_pool != NULL);
+    assert(resource_pools != NULL);
     assert(ib != NULL);
     assert(module != NULL);
 
@@ -697,23 +697,26 @@ ib_status_t modlua_runtime_resource_pool_create(
     /* Initialize the configuration. */
     modlua_runtime_cbdata->cfg.max_lua_stack_uses = MAX_LUA_STACK_USES;
 
-    rc = ib_resource_pool_create(
-        resource_pool,         /* Out variable. */
-        mm,                    /* Memory manager. */
-        10,                    /* Minimum 10 Lua stacks in reserve. */
-        0,                     /* No maximum limit. */
-        lua_pool_create_fn,    /* Create function. */
-        modlua_runtime_cbdata, /* Callback data is just the active engine. */
-        lua_pool_destroy_fn,   /* Destroy function. Calls lua_close(). */
-        modlua_runtime_cbdata, /* Callback data is just the active engine. */
-        lua_pool_preuse_fn,    /* Pre use function. Increments use count. */
-        modlua_runtime_cbdata, /* Callback data is just the active engine. */
-        lua_pool_postuse_fn,   /* Post use function. Signals delete. */
-        modlua_runtime_cbdata  /* Callback data is just the active engine. */
-    );
+    /* All shards share the callback data and thus the configuration. */
+    for (int i = 0; i < MODLUA_POOL_SHARDS; ++i) {
+        rc = ib_resource_pool_create(
+            &resource_pools[i],    /* Out variable. */
+            mm,                    /* Memory manager. */
+            3,                     /* Minimum Lua stacks in reserve. */
+            0,                     /* No maximum limit. */
+            lua_pool_create_fn,    /* Create function. */
+            modlua_runtime_cbdata, /* Callback data is just the active engine. */
+            lua_pool_destroy_fn,   /* Destroy function. Calls lua_close(). */
+            modlua_runtime_cbdata, /* Callback data is just the active engine. */
+            lua_pool_preuse_fn,    /* Pre use function. Increments use count. */
+            modlua_runtime_cbdata, /* Callback data is just the active engine. */
+            lua_pool_postuse_fn,   /* Post use function. Signals delete. */
+            modlua_runtime_cbdata  /* Callback data is just the active engine. */
+        );
 
-    if (rc != IB_OK) {
-        return rc;
+        if (rc != IB_OK) {
+            return rc;
+        }
     }
 
     *cfg = &(modlua_runtime_cbdata->cfg);
@@ -721,6 +724,18 @@ ib_status_t modlua_runtime_resource_pool_create(
     return IB_OK;
 }
 
+/**
+ * Pick the pool shard for the calling thread.
+ *
+ * @returns A shard index in [0, MODLUA_POOL_SHARDS).
+ */
+static int modlua_pool_shard(void)
+{
+    /* Thread ids are pointer-like; mix the non-alignment bits. */
+    uintptr_t id = (uintptr_t)pthread_self();
+    return (int)((id >> 10) % MODLUA_POOL_SHARDS);
+}
+
 ib_status_t modlua_releasestate(
     ib_engine_t      *ib,
     modlua_cfg_t     *cfg,
@@ -731,19 +746,21 @@ ib_status_t modlua_releasestate(
     assert(cfg != NULL);
 
     ib_status_t rc;
+    /* Release back to the shard the runtime was acquired from. */
+    const int shard = modlua_runtime->shard;
 
-    rc = ib_lock_lock(cfg->lua_pool_lock);
+    rc = ib_lock_lock(cfg->lua_pool_locks[shard]);
     if (rc != IB_OK) {
         return rc;
     }
 
     rc = ib_resource_release(modlua_runtime->resource);
     if (rc != IB_OK) {
-        ib_lock_unlock(cfg->lua_pool_lock);
+        ib_lock_unlock(cfg->lua_pool_locks[shard]);
         return rc;
     }
 
-    rc = ib_lock_unlock(cfg->lua_pool_lock);
+    rc = ib_lock_unlock(cfg->lua_pool_locks[shard]);
     if (rc != IB_OK) {
         return rc;
     }
@@ -762,19 +779,20 @@ ib_status_t modlua_acquirestate(
 
     ib_status_t    rc;
     ib_resource_t *resource;
+    const int      shard = modlua_pool_shard();
 
-    rc = ib_lock_lock(cfg->lua_pool_lock);
+    rc = ib_lock_lock(cfg->lua_pool_locks[shard]);
     if (rc != IB_OK) {
         return rc;
     }
 
-    rc = ib_resource_acquire(cfg->lua_pool, &resource);
+    rc = ib_resource_acquire(cfg->lua_pools[shard], &resource);
     if (rc != IB_OK) {
-        ib_lock_unlock(cfg->lua_pool_lock);
+        ib_lock_unlock(cfg->lua_pool_locks[shard]);
         return rc;
     }
 
-    rc = ib_lock_unlock(cfg->lua_pool_lock);
+    rc = ib_lock_unlock(cfg->lua_pool_locks[shard]);
     if (rc != IB_OK) {
         return rc;
     }
@@ -785,6 +803,7 @@ ib_status_t modlua_acquirestate(
     assert(*modlua_runtime != NULL);
 
     (*modlua_runtime)->resource = resource;
+    (*modlua_runtime)->shard    = shard;
 
     /* Validate the runtime. */
     assert((*modlua_runtime)->use_count >= 0);
@@ -45,6 +45,7 @@ struct modlua_runtime_t {
     ssize_t          use_count; /**< Number of times this stack is used. */
     ib_mpool_lite_t *mp;        /**< Memory pool for this runtime. */
     ib_resource_t   *resource;  /**< Bookkeeping for modlua_releasestate(). */
+    int              shard;     /**< Pool shard this runtime came from. */
 };
 typedef struct modlua_runtime_t modlua_runtime_t;
 
@@ -101,12 +102,16 @@ ib_status_t modlua_runtime_cfg_set_stack_use_limit(
 NONNULL_ATTRIBUTE(1);
 
 /**
- * Create a resource pool that manages @ref modlua_runtime_t instances.
+ * Create the pool shards that manage @ref modlua_runtime_t instances.
  *
- * @param[out] resource_pool Resource pool to create.
+ * All @ref MODLUA_POOL_SHARDS shards share one configuration, so
+ * settings such as the stack use limit apply across them.
+ *
+ * @param[out] resource_pools Array of @ref MODLUA_POOL_SHARDS pools to
+ *             create.
  * @param[in] ib The IronBee engine made available to the Lua runtime.
  * @param[in] module The IronBee module structure.
- * @param[in] mm The memory manager the resource pool will use.
+ * @param[in] mm The memory manager the resource pools will use.
  * @param[in] cfg Runtime configuration parameters that the user may set
  *            during configuration time.
  *
@@ -116,7 +121,7 @@ NONNULL_ATTRIBUTE(1);
  *  - Failures codes ib_resource_pool_create().
  */
 ib_status_t modlua_runtime_resource_pool_create(
-    ib_resource_pool_t   **resource_pool,
+    ib_resource_pool_t   **resource_pools,
     ib_engine_t           *ib,
     ib_module_t           *module,
     ib_mm_t                mm,
@@ -608,9 +608,21 @@ static inline ib_status_t modhtp_set_bytestr(
     /*
      * If the target bytestring is NULL, create it, otherwise
      * append to the zero-length bytestring.
+     *
+     * Creation aliases the parser's memory rather than copying: libhtp
+     * transaction data lives until the tx_finished state, after every
+     * phase including logging has run, and the fallbacks are literals.
+     * Forced updates below mutate in place via ib_bytestr_setv(), which
+     * accepts aliases.  Empty values are still duplicated so that the
+     * append path stays writable.
      */
     if (*ib_bstr == NULL) {
-        rc = ib_bytestr_dup_mem(ib_bstr, itx->mm, ptr, len);
+        if (len > 0) {
+            rc = ib_bytestr_alias_mem(ib_bstr, itx->mm, ptr, len);
+        }
+        else {
+            rc = ib_bytestr_dup_mem(ib_bstr, itx->mm, ptr, len);
+        }
     }
     else if (force) {
         void *new = ib_mm_memdup(itx->mm, ptr, len);
@@ -1963,7 +1975,18 @@ static ib_status_t modhtp_gen_request_uri_fields(
         ib_log_info_tx(itx, "Cannot generate request URI fields: No parsed URI");
     }
 
-    /* Extract the query parameters into the IronBee tx's URI parameters */
+    /* Extract the query parameters into the IronBee tx's URI parameters.
+     *
+     * On making this lazy (an index over the raw query string,
+     * materializing fields only when a rule touches ARGS): evaluated
+     * and rejected.  libhtp has already split the parameters by the
+     * time this runs, the per-parameter fields alias libhtp memory
+     * (values are never copied), each field is one coalesced pool
+     * bump and list nodes are recycled -- so the per-parameter cost is
+     * a small constant, not a set of allocations.  A lazy dynamic
+     * collection would also change ARGS's write semantics: body
+     * parameters and setvar append to it, and dynamic list fields
+     * cannot be appended to. */
     rc = modhtp_get_or_create_list(itx, "request_uri_params", &f);
     if ( (rc == IB_OK) && (htx->request_params != NULL) ) {
         modhtp_param_iter_data_t idata =
@@ -0,0 +1,750 @@
+/*****************************************************************************
+ * Licensed to Qualys, Inc. (QUALYS) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * QUALYS licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+/**
+ * @file
+ * @brief IronBee Modules --- Streaming multipart/form-data Parser
+ *
+ * A stream processor that incrementally parses multipart/form-data
+ * request bodies.  Boundaries and part headers are consumed by the
+ * parser; part bodies are forwarded down the pump as slices of the
+ * incoming chunks, so downstream processors and stream rules inspect
+ * decoded part content while memory use stays bounded by one boundary
+ * and one part-header block, independent of body size.
+ *
+ * Part headers are materialized, as each part's header block
+ * completes, into the MULTIPART list var: one "part" list per part,
+ * containing a byte-string field per header named after the
+ * (lower-cased) header name.  Bodies are never buffered here; policies
+ * that need part content inspect the (now decoded) body stream.
+ *
+ * The processor is registered at module initialization and inserted
+ * into a transaction's request body pump when the request Content-Type
+ * declares multipart/form-data with a boundary.
+ */
+
+#include <ironbee/bytestr.h>
+#include <ironbee/context.h>
+#include <ironbee/engine.h>
+#include <ironbee/engine_state.h>
+#include <ironbee/field.h>
+#include <ironbee/list.h>
+#include <ironbee/mm.h>
+#include <ironbee/module.h>
+#include <ironbee/parsed_content.h>
+#include <ironbee/stream_io.h>
+#include <ironbee/stream_processor.h>
+#include <ironbee/stream_pump.h>
+#include <ironbee/string.h>
+#include <ironbee/var.h>
+
+#include <assert.h>
+#include <ctype.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* Define the module name as well as a string version of it. */
+#define MODULE_NAME        multipart
+#define MODULE_NAME_STR    IB_XSTRINGIFY(MODULE_NAME)
+
+IB_MODULE_DECLARE();
+
+/** Name the processor is registered (and inserted) under. */
+#define MULTIPART_PROCESSOR_NAME "multipart"
+
+/** RFC 2046: a boundary is at most 70 characters. */
+#define MULTIPART_MAX_BOUNDARY 70
+
+/** Full delimiter: CRLF "--" boundary. */
+#define MULTIPART_MAX_DELIM (4 + MULTIPART_MAX_BOUNDARY)
+
+/** Cap on one part's header block; larger blocks parse but are not
+ * materialized into vars. */
+#define MULTIPART_MAX_HEADER_BLOCK 8192
+
+/**
+ * Module data.
+ */
+typedef struct {
+    ib_module_t     *module;           /**< This module. */
+    ib_var_source_t *multipart_source; /**< The MULTIPART var. */
+} multipart_moddata_t;
+
+/** Parser states. */
+typedef enum {
+    MULTIPART_PREAMBLE,    /**< Before the first delimiter; discarded. */
+    MULTIPART_AFTER_DELIM, /**< Between delimiter and part headers. */
+    MULTIPART_HEADERS,     /**< Collecting a part's header block. */
+    MULTIPART_BODY,        /**< Streaming a part body. */
+    MULTIPART_EPILOGUE     /**< After the closing delimiter; discarded. */
+} multipart_state_t;
+
+/**
+ * Processor instance: one per transaction, allocated from tx memory.
+ *
+ * The delimiter matcher exploits that CR cannot occur inside the
+ * delimiter past position 0 (boundary characters exclude CR/LF), so on
+ * a mismatch the only possible new candidate is the current byte; no
+ * backtracking over matched bytes is ever needed.  Bytes of a
+ * candidate delimiter that end one chunk are held (at most one
+ * delimiter's worth) and either discarded with the matched delimiter
+ * or re-emitted as body if the match fails in the next chunk.
+ */
+typedef struct {
+    const multipart_moddata_t *moddata; /**< Module data. */
+    ib_tx_t           *tx;              /**< The transaction. */
+
+    char               delim[MULTIPART_MAX_DELIM]; /**< CRLF "--" boundary. */
+    size_t             delim_len;       /**< Length of delim. */
+
+    multipart_state_t  state;           /**< Parser state. */
+    size_t             match;           /**< Delimiter bytes matched. */
+
+    uint8_t            held[MULTIPART_MAX_DELIM]; /**< Candidate bytes from
+                                                       previous chunks. */
+    size_t             held_len;        /**< Bytes in held. */
+
+    /* MULTIPART_AFTER_DELIM: leading dashes decide close vs part. */
+    size_t             after_len;       /**< Dashes seen after delimiter. */
+
+    char               hdr[MULTIPART_MAX_HEADER_BLOCK]; /**< Header block. */
+    size_t             hdr_len;         /**< Bytes in hdr. */
+    bool               hdr_truncated;   /**< Block exceeded the cap. */
+    size_t             hdr_crlf;        /**< Progress through CRLFCRLF. */
+
+    size_t             n_parts;         /**< Parts seen so far. */
+    ib_field_t        *multipart_list;  /**< The MULTIPART list value. */
+} multipart_inst_t;
+
+/**
+ * Extract the boundary parameter from a Content-Type header value.
+ *
+ * @param[in] value Header value.
+ * @param[in] value_len Length of @a value.
+ * @param[out] boundary Start of the boundary in @a value.
+ * @param[out] boundary_len Length of the boundary.
+ *
+ * @returns true if @a value declares multipart/form-data with a
+ *          usable boundary.
+ */
+static bool multipart_boundary(
+    const char  *value,
+    size_t       value_len,
+    const char **boundary,
+    size_t      *boundary_len
+)
+{
+    static const char prefix[]  = "multipart/form-data";
+    static const char bparam[] = "boundary=";
+    const char *p;
+    const char *end = value + value_len;
+    size_t      len;
+
+    if (value_len < sizeof(prefix) - 1 ||
+        strncasecmp(value, prefix, sizeof(prefix) - 1) != 0)
+    {
+        return false;
+    }
+
+    /* Find the boundary parameter. */
+    for (p = value; p + sizeof(bparam) - 1 < end; ++p) {
+        if (strncasecmp(p, bparam, sizeof(bparam) - 1) == 0) {
+            break;
+        }
+    }
+    if (p + sizeof(bparam) - 1 >= end) {
+        return false;
+    }
+    p += sizeof(bparam) - 1;
+
+    /* Optionally quoted. */
+    if (p < end && *p == '"') {
+        ++p;
+        for (len = 0; p + len < end && p[len] != '"'; ++len) {
+            /* nop */
+        }
+    }
+    else {
+        for (len = 0; p + len < end && p[len] != ';' &&
+                      p[len] != ' ' && p[len] != '\t' &&
+                      p[len] != '\r' && p[len] != '\n'; ++len)
+        {
+            /* nop */
+        }
+    }
+
+    if (len == 0 || len > MULTIPART_MAX_BOUNDARY) {
+        return false;
+    }
+
+    *boundary = p;
+    *boundary_len = len;
+    return true;
+}
+
+/**
+ * Find the request's multipart boundary, if any.
+ */
+static bool multipart_tx_boundary(
+    const ib_tx_t  *tx,
+    const char    **boundary,
+    size_t         *boundary_len
+)
+{
+    const ib_parsed_header_t *header;
+
+    if (tx->request_header == NULL) {
+        return false;
+    }
+
+    for (header = tx->request_header->head;
+         header != NULL;
+         header = header->next)
+    {
+        if (ib_bytestr_length(header->name) == 12 &&
+            strncasecmp(
+                (const char *)ib_bytestr_const_ptr(header->name),
+                "Content-Type", 12) == 0)
+        {
+            return multipart_boundary(
+                (const char *)ib_bytestr_const_ptr(header->value),
+                ib_bytestr_length(header->value),
+                boundary,
+                boundary_len);
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Materialize the completed header block as one "part" in MULTIPART.
+ *
+ * Each header line becomes a byte-string field named after the
+ * lower-cased header name; values are copied out of the instance's
+ * reused header buffer into transaction memory.
+ */
+static ib_status_t multipart_materialize_part(multipart_inst_t *inst)
+{
+    ib_tx_t     *tx = inst->tx;
+    ib_list_t   *part_list;
+    ib_field_t  *part_field;
+    ib_list_t   *multipart;
+    ib_status_t  rc;
+    size_t       pos = 0;
+
+    if (inst->multipart_list == NULL || inst->hdr_truncated) {
+        return IB_OK;
+    }
+
+    rc = ib_field_value(inst->multipart_list, ib_ftype_list_mutable_out(&multipart));
+    if (rc != IB_OK) {
+        return rc;
+    }
+
+    rc = ib_list_create(&part_list, tx->mm);
+    if (rc != IB_OK) {
+        return rc;
+    }
+
+    /* Parse "Name: value" lines separated by CRLF. */
+    while (pos < inst->hdr_len) {
+        size_t line_end = pos;
+        size_t colon;
+        size_t vstart;
+        size_t vlen;
+        char  *name;
+        size_t name_len;
+        ib_bytestr_t *value_bs;
+        ib_field_t   *header_field;
+
+        while (line_end + 1 < inst->hdr_len &&
+               ! (inst->hdr[line_end] == '\r' &&
+                  inst->hdr[line_end + 1] == '\n'))
+        {
+            ++line_end;
+        }
+        if (line_end + 1 >= inst->hdr_len) {
+            line_end = inst->hdr_len;
+        }
+
+        for (colon = pos; colon < line_end && inst->hdr[colon] != ':'; ++colon) {
+            /* nop */
+        }
+        if (colon > pos && colon < line_end) {
+            name_len = colon - pos;
+            name = ib_mm_alloc(tx->mm, name_len);
+            if (name == NULL) {
+                return IB_EALLOC;
+            }
+            for (size_t i = 0; i < name_len; ++i) {
+                name[i] = tolower((unsigned char)inst->hdr[pos + i]);
+            }
+
+            vstart = colon + 1;
+            while (vstart < line_end &&
+                   (inst->hdr[vstart] == ' ' || inst->hdr[vstart] == '\t'))
+            {
+                ++vstart;
+            }
+            vlen = line_end - vstart;
+
+            rc = ib_bytestr_dup_mem(
+                &value_bs, tx->mm,
+                (const uint8_t *)inst->hdr + vstart, vlen);
+            if (rc != IB_OK) {
+                return rc;
+            }
+            rc = ib_field_create(
+                &header_field, tx->mm,
+                name, name_len,
+                IB_FTYPE_BYTESTR,
+                ib_ftype_bytestr_in(value_bs));
+            if (rc != IB_OK) {
+                return rc;
+            }
+            rc = ib_list_push(part_list, header_field);
+            if (rc != IB_OK) {
+                return rc;
+            }
+        }
+
+        pos = (line_end >= inst->hdr_len) ? inst->hdr_len : line_end + 2;
+    }
+
+    rc = ib_field_create(
+        &part_field, tx->mm,
+        IB_S2SL("part"),
+        IB_FTYPE_LIST,
+        ib_ftype_list_in(part_list));
+    if (rc != IB_OK) {
+        return rc;
+    }
+
+    return ib_list_push(multipart, part_field);
+}
+
+/**
+ * Emit held candidate bytes (a failed delimiter prefix) as part body.
+ */
+static ib_status_t multipart_emit_held(
+    multipart_inst_t  *inst,
+    ib_stream_io_tx_t *io_tx
+)
+{
+    ib_stream_io_data_t *out;
+    uint8_t             *out_ptr;
+    ib_status_t          rc;
+
+    if (inst->held_len == 0) {
+        return IB_OK;
+    }
+
+    /* Preamble bytes are discarded, not forwarded. */
+    if (inst->state == MULTIPART_BODY) {
+        rc = ib_stream_io_data_alloc(io_tx, inst->held_len, &out, &out_ptr);
+        if (rc != IB_OK) {
+            return rc;
+        }
+        memcpy(out_ptr, inst->held, inst->held_len);
+        rc = ib_stream_io_data_put(io_tx, out);
+        if (rc != IB_OK) {
+            return rc;
+        }
+    }
+
+    inst->held_len = 0;
+    return IB_OK;
+}
+
+/**
+ * Forward body bytes [start, end) of the current chunk downstream.
+ */
+static ib_status_t multipart_emit_span(
+    multipart_inst_t    *inst,
+    ib_stream_io_tx_t   *io_tx,
+    ib_stream_io_data_t *data,
+    size_t               start,
+    size_t               end
+)
+{
+    ib_stream_io_data_t *slice;
+    ib_status_t          rc;
+
+    if (end <= start || inst->state != MULTIPART_BODY) {
+        return IB_OK;
+    }
+
+    rc = ib_stream_io_data_slice(io_tx, data, start, end - start, &slice, NULL);
+    if (rc != IB_OK) {
+        return rc;
+    }
+    return ib_stream_io_data_put(io_tx, slice);
+}
+
+/**
+ * Processor create function: derive the delimiter from the request.
+ */
+static ib_status_t multipart_create_fn(
+    void    *inst_data,
+    ib_tx_t *tx,
+    void    *cbdata
+)
+{
+    assert(inst_data != NULL);
+    assert(tx != NULL);
+    assert(cbdata != NULL);
+
+    multipart_moddata_t *moddata = (multipart_moddata_t *)cbdata;
+    multipart_inst_t    *inst;
+    const char          *boundary;
+    size_t               boundary_len;
+    ib_status_t          rc;
+
+    if (! multipart_tx_boundary(tx, &boundary, &boundary_len)) {
+        return IB_DECLINED;
+    }
+
+    inst = ib_mm_calloc(tx->mm, sizeof(*inst), 1);
+    if (inst == NULL) {
+        return IB_EALLOC;
+    }
+
+    inst->moddata = moddata;
+    inst->tx      = tx;
+    inst->delim[0] = '\r';
+    inst->delim[1] = '\n';
+    inst->delim[2] = '-';
+    inst->delim[3] = '-';
+    memcpy(inst->delim + 4, boundary, boundary_len);
+    inst->delim_len = 4 + boundary_len;
+
+    inst->state = MULTIPART_PREAMBLE;
+    /* The first delimiter may appear at the very start of the body
+     * without a preceding CRLF; start as if one was already matched. */
+    inst->match = 2;
+
+    /* The MULTIPART var collects per-part header lists. */
+    rc = ib_var_source_initialize(
+        moddata->multipart_source,
+        &inst->multipart_list,
+        tx->var_store,
+        IB_FTYPE_LIST);
+    if (rc != IB_OK) {
+        inst->multipart_list = NULL;  /* Parse without materializing. */
+    }
+
+    *(multipart_inst_t **)inst_data = inst;
+    return IB_OK;
+}
+
+/**
+ * Processor execute function: the streaming state machine.
+ */
+static ib_status_t multipart_execute_fn(
+    void              *inst_data,
+    ib_tx_t           *tx,
+    ib_mm_t            mm_eval,
+    ib_stream_io_tx_t *io_tx,
+    void              *cbdata
+)
+{
+    assert(inst_data != NULL);
+    assert(tx != NULL);
+
+    multipart_inst_t *inst = (multipart_inst_t *)inst_data;
+    ib_status_t       rc;
+
+    while (ib_stream_io_data_depth(io_tx) > 0) {
+        ib_stream_io_data_t *data;
+        uint8_t             *ptr;
+        size_t               len;
+        ib_stream_io_type_t  type;
+        size_t               off = 0;
+        size_t               span_start = 0;
+        size_t               cand_start = 0; /* In-chunk candidate start. */
+
+        rc = ib_stream_io_data_take(io_tx, &data, &ptr, &len, &type);
+        if (rc != IB_OK) {
+            return rc;
+        }
+
+        /* Pass non-data segments (flush) through. */
+        if (type != IB_STREAM_IO_DATA || ptr == NULL || len == 0) {
+            rc = ib_stream_io_data_put(io_tx, data);
+            if (rc != IB_OK) {
+                return rc;
+            }
+            continue;
+        }
+
+        while (off < len) {
+            const uint8_t c = ptr[off];
+
+            switch (inst->state) {
+            case MULTIPART_PREAMBLE:
+            case MULTIPART_BODY:
+                if (inst->match > 0) {
+                    if ((char)c == inst->delim[inst->match]) {
+                        if (inst->match == inst->held_len) {
+                            /* Candidate continues into this chunk. */
+                            cand_start = off;
+                        }
+                        ++inst->match;
+                        ++off;
+                        if (inst->match == inst->delim_len) {
+                            /* Delimiter complete: body ends before the
+                             * candidate; held bytes belong to it. */
+                            size_t body_end =
+                                (inst->match - inst->held_len <= off)
+                                ? off - (inst->match - inst->held_len)
+                                : 0;
+                            rc = multipart_emit_span(
+                                inst, io_tx, data, span_start, body_end);
+                            if (rc != IB_OK) {
+                                goto fail;
+                            }
+                            inst->held_len  = 0;
+                            inst->match     = 0;
+                            inst->state     = MULTIPART_AFTER_DELIM;
+                            inst->after_len = 0;
+                            span_start      = off;
+                        }
+                        continue;
+                    }
+
+                    /* Mismatch: the candidate was body.  Held bytes
+                     * (previous chunks) are re-emitted; in-chunk
+                     * candidate bytes stay inside the running span.
+                     * The delimiter contains CR only at position 0, so
+                     * the only possible new candidate is this byte. */
+                    rc = multipart_emit_held(inst, io_tx);
+                    if (rc != IB_OK) {
+                        goto fail;
+                    }
+                    inst->match = 0;
+                    /* Fall through to the match==0 handling of c. */
+                }
+                if (c == '\r') {
+                    cand_start  = off;
+                    inst->match = 1;
+                }
+                ++off;
+                break;
+
+            case MULTIPART_AFTER_DELIM:
+                /* A close delimiter is "--" immediately after the
+                 * boundary; anything else is transport padding up to
+                 * the CRLF that starts the part headers. */
+                if (inst->after_len < 2 && c == '-') {
+                    ++inst->after_len;
+                    ++off;
+                    if (inst->after_len == 2) {
+                        inst->state = MULTIPART_EPILOGUE;
+                    }
+                    break;
+                }
+                ++off;
+                if (c == '\n') {
+                    inst->state         = MULTIPART_HEADERS;
+                    inst->hdr_len       = 0;
+                    inst->hdr_truncated = false;
+                    inst->hdr_crlf      = 0;
+                }
+                break;
+
+            case MULTIPART_HEADERS: {
+                static const char crlfcrlf[4] = { '\r', '\n', '\r', '\n' };
+
+                if (inst->hdr_len < MULTIPART_MAX_HEADER_BLOCK) {
+                    inst->hdr[inst->hdr_len] = (char)c;
+                    ++inst->hdr_len;
+                }
+                else {
+                    inst->hdr_truncated = true;
+                }
+                inst->hdr_crlf =
+                    ((char)c == crlfcrlf[inst->hdr_crlf]) ? inst->hdr_crlf + 1
+                    : ((char)c == '\r') ? 1 : 0;
+                ++off;
+                if (inst->hdr_crlf == 4) {
+                    /* Header block complete (strip the CRLFCRLF). */
+                    inst->hdr_len =
+                        (inst->hdr_len >= 4) ? inst->hdr_len - 4 : 0;
+                    ++inst->n_parts;
+                    rc = multipart_materialize_part(inst);
+                    if (rc != IB_OK) {
+                        goto fail;
+                    }
+                    inst->state = MULTIPART_BODY;
+                    inst->match = 0;
+                    span_start  = off;
+                }
+                break;
+            }
+
+            case MULTIPART_EPILOGUE:
+                off = len;
+                break;
+            }
+        }
+
+        /* End of chunk: forward the finished body span.  A candidate
+         * in progress is excluded and carried in held. */
+        if (inst->state == MULTIPART_BODY || inst->state == MULTIPART_PREAMBLE) {
+            size_t in_chunk_cand =
+                (inst->match > inst->held_len)
+                ? inst->match - inst->held_len
+                : 0;
+            size_t body_end = (in_chunk_cand <= len) ? len - in_chunk_cand : 0;
+
+            rc = multipart_emit_span(inst, io_tx, data, span_start, body_end);
+            if (rc != IB_OK) {
+                goto fail;
+            }
+
+            if (in_chunk_cand > 0) {
+                memcpy(
+                    inst->held + inst->held_len,
+                    ptr + cand_start,
+                    in_chunk_cand);
+                inst->held_len = inst->match;
+            }
+        }
+
+        ib_stream_io_data_unref(io_tx, data);
+        continue;
+
+    fail:
+        ib_stream_io_data_unref(io_tx, data);
+        return rc;
+    }
+
+    return IB_OK;
+}
+
+/**
+ * Insert the processor into the request pump for multipart requests.
+ */
+static ib_status_t multipart_on_request_header_finished(
+    ib_engine_t *ib,
+    ib_tx_t     *tx,
+    ib_state_t   state,
+    void        *cbdata
+)
+{
+    assert(ib != NULL);
+    assert(tx != NULL);
+    assert(state == request_header_finished_state);
+
+    const char *boundary;
+    size_t      boundary_len;
+    ib_status_t rc;
+
+    if (! multipart_tx_boundary(tx, &boundary, &boundary_len)) {
+        return IB_OK;
+    }
+
+    rc = ib_stream_pump_processor_add(
+        ib_tx_request_body_pump(tx),
+        MULTIPART_PROCESSOR_NAME);
+    if (rc != IB_OK && rc != IB_DECLINED) {
+        ib_log_error_tx(tx, "Multipart: Error adding processor: %s",
+                        ib_status_to_string(rc));
+        /* Inspection proceeds on the raw body. */
+    }
+
+    return IB_OK;
+}
+
+/* Called when module is loaded. */
+static ib_status_t multipart_init(ib_engine_t *ib, ib_module_t *m, void *cbdata)
+{
+    assert(ib != NULL);
+    assert(m != NULL);
+
+    multipart_moddata_t *moddata;
+    ib_list_t           *types;
+    ib_mm_t              mm = ib_engine_mm_main_get(ib);
+    ib_status_t          rc;
+
+    moddata = ib_mm_calloc(mm, sizeof(*moddata), 1);
+    if (moddata == NULL) {
+        return IB_EALLOC;
+    }
+    moddata->module = m;
+
+    rc = ib_var_source_register(
+        &moddata->multipart_source,
+        ib_engine_var_config_get(ib),
+        IB_S2SL("MULTIPART"),
+        IB_PHASE_NONE, IB_PHASE_NONE);
+    if (rc != IB_OK) {
+        ib_log_warning(ib,
+            "Multipart: Error registering \"MULTIPART\" var: %s",
+            ib_status_to_string(rc));
+        /* Continue; parts simply will not be materialized. */
+    }
+
+    rc = ib_list_create(&types, mm);
+    if (rc != IB_OK) {
+        return rc;
+    }
+    rc = ib_list_push(types, (void *)"multipart/form-data");
+    if (rc != IB_OK) {
+        return rc;
+    }
+
+    rc = ib_stream_processor_registry_register(
+        ib_engine_stream_processor_registry(ib),
+        MULTIPART_PROCESSOR_NAME,
+        types,
+        multipart_create_fn, moddata,
+        multipart_execute_fn, NULL,
+        NULL, NULL
+    );
+    if (rc != IB_OK) {
+        ib_log_error(ib, "Multipart: Error registering stream processor: %s",
+                     ib_status_to_string(rc));
+        return rc;
+    }
+
+    rc = ib_hook_tx_register(
+        ib,
+        request_header_finished_state,
+        multipart_on_request_header_finished,
+        NULL);
+    if (rc != IB_OK) {
+        return rc;
+    }
+
+    m->data = moddata;
+    return IB_OK;
+}
+
+/* Initialize the module structure. */
+IB_MODULE_INIT(
+    IB_MODULE_HEADER_DEFAULTS,           /* Default metadata */
+    MODULE_NAME_STR,                     /* Module name */
+    IB_MODULE_CONFIG_NULL,               /* Global config data */
+    NULL,                                /* Configuration field map */
+    NULL,                                /* Config directive map */
+    multipart_init,                      /* Initialize function */
+    NULL,                                /* Callback data */
+    NULL,                                /* Finish function */
+    NULL,                                /* Callback data */
+);
@@ -182,6 +182,16 @@ ostream& operator<<(
     return o;
 }
 
+/* Vectorizing these parsers has been considered.  They are Boost.Spirit
+ * grammars, which parse a character at a time by construction; making
+ * the hot scans (header values to EOL, URI component runs) use
+ * memchr-class primitives means replacing the grammars with hand
+ * written parsers.  That trade was rejected for now: the grammars are
+ * the executable specification of some subtle HTTP tolerances (line
+ * folding, odd separators) with conformance tests depending on them,
+ * and parsing is a small cost next to inspection in profiles.  If that
+ * changes, rewrite parse_headers() first and keep the grammar as the
+ * reference implementation in the tests. */
 parse_headers_result_t parse_headers(span_t& input)
 {
     namespace p = boost::phoenix;
@@ -24,8 +24,10 @@
 
 #include <ironbee/bytestr.h>
 #include <ironbee/capture.h>
+#include <ironbee/clock.h>
 #include <ironbee/cfgmap.h>
 #include <ironbee/context.h>
+#include <ironbee/core.h>
 #include <ironbee/engine.h>
 #include <ironbee/escape.h>
 #include <ironbee/field.h>
@@ -45,6 +47,7 @@
 
 #include <assert.h>
 #include <ctype.h>
+#include <pthread.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -126,19 +129,72 @@ static modpcre_cfg_t modpcre_global_cfg = {
     WORKSPACE_SIZE_DEFAULT /* dfa_workspace_size. */
 };
 
-/* State information for a PCRE work common to all pcre operators in a tx. */
+/* State information for a PCRE work common to all pcre operators in a tx.
+ *
+ * The JIT stack is not kept here: it is pooled per worker thread (see
+ * modpcre_get_thread_jit_stack()) and fetched at execution time, so
+ * transactions that migrate between threads never share a stack with a
+ * concurrently executing transaction.
+ */
 struct pcre_tx_data_t {
-    pcre_jit_stack *stack;
     ib_hash_t      *dfa_workspace_hash;
     int            *ovector;    /** Array of N matches that is 3 * N long. */
     int             ovector_sz; /* The size of ovector. 3 * N. */
+    /**
+     * Module configuration for the transaction's context, resolved once
+     * per transaction; operator executions read plain struct fields.
+     */
+    modpcre_cfg_t  *config;
+
+    /**
+     * Inspection budget deadline (engine clock usec); 0 when no budget
+     * is configured.  Executions starting past it are skipped (fail
+     * open) so a transaction already over budget does not start more
+     * match work; within a match, the compiled match limits bound the
+     * slice.
+     */
+    ib_time_t       deadline;
 };
 typedef struct pcre_tx_data_t pcre_tx_data_t;
 
 #ifdef PCRE_HAVE_JIT
-static void pcre_jit_stack_cleanup(void *stack) {
-    assert(stack != NULL);
-    pcre_jit_stack_free((pcre_jit_stack *)stack);
+/**
+ * Per-thread JIT stack, reused across transactions.
+ *
+ * pcre_jit_stack_alloc() maps fresh memory, which previously happened
+ * once per transaction.  One stack per worker thread is sufficient since
+ * a stack is only in use while a match executes on that thread.  The
+ * stack is reallocated if the configured sizes change and lives for the
+ * life of the thread.
+ */
+static __thread pcre_jit_stack *c_thread_jit_stack     = NULL;
+static __thread int             c_thread_jit_stack_max = 0;
+
+/**
+ * Get this thread's JIT stack, growing it if needed.
+ *
+ * The cached stack is replaced when a caller needs a larger maximum and
+ * never shrinks, so callers with differing requirements do not thrash.
+ *
+ * @param[in] start Initial stack size, used only when (re)allocating.
+ * @param[in] max Maximum stack size required.
+ *
+ * @returns The thread's JIT stack or NULL if allocation failed; matching
+ *          falls back to the call stack in that case.
+ */
+static pcre_jit_stack *modpcre_get_thread_jit_stack(int start, int max)
+{
+    if ( (c_thread_jit_stack != NULL) && (c_thread_jit_stack_max < max) ) {
+        pcre_jit_stack_free(c_thread_jit_stack);
+        c_thread_jit_stack = NULL;
+    }
+
+    if (c_thread_jit_stack == NULL) {
+        c_thread_jit_stack     = pcre_jit_stack_alloc(start, max);
+        c_thread_jit_stack_max = max;
+    }
+
+    return c_thread_jit_stack;
 }
 #endif
 
@@ -284,50 +340,188 @@ ib_status_t get_or_create_operator_data(
         }
     }
 
-    /* Initialize the PCRE JIT Stack for the TX. */
-#ifdef PCRE_HAVE_JIT
+    /* Resolve the module configuration once for the transaction;
+     * executions read plain struct fields from it. */
     {
-        modpcre_cfg_t  *config;
-
-        rc = ib_context_module_config(tx->ctx, m, &config);
+        data_tmp->config = NULL;
+        rc = ib_context_module_config(tx->ctx, m, &data_tmp->config);
         if (rc != IB_OK) {
-            ib_log_error_tx(tx, "Cannot fetch module config for pcre.");
             return rc;
         }
+    }
 
-        data_tmp->stack = pcre_jit_stack_alloc(
-            config->jit_stack_start,
-            config->jit_stack_max
-        );
-        /* A null stack is extremely unexpected, but not fatal.
-         * JIT can use a callstack in a threadsafe way. */
-        if (data_tmp->stack == NULL) {
-            ib_log_info_tx(
-                tx,
-                "Could not allocate a pcre JIT stack: min=%d max=%d",
-                (int)config->jit_stack_start,
-                (int)config->jit_stack_max
-            );
-        }
-        else {
-            rc = ib_mm_register_cleanup(
-                tx->mm,
-                pcre_jit_stack_cleanup,
-                data_tmp->stack
-            );
-            if (rc != IB_OK) {
-                pcre_jit_stack_free(data_tmp->stack);
-                return rc;
-            }
+    /* Resolve the inspection deadline once per transaction. */
+    {
+        ib_core_cfg_t *corecfg = NULL;
+
+        data_tmp->deadline = 0;
+        if (ib_core_context_config(tx->ctx, &corecfg) == IB_OK &&
+            corecfg->inspection_budget_usec > 0)
+        {
+            data_tmp->deadline =
+                tx->t.started + (ib_time_t)corecfg->inspection_budget_usec;
         }
     }
-#endif
 
     *data = data_tmp;
 
     return IB_OK;
 }
 
+/**
+ * Process-wide cache of compiled (and studied/JIT-compiled) patterns.
+ *
+ * Compiling and studying a pattern -- in particular JIT compilation --
+ * is the expensive part of loading a large rule set, and the result
+ * depends only on the pattern text and the configuration values that
+ * feed @ref pcre_compile_internal.  Rule sets are largely stable across
+ * engine reloads, so compiled patterns are kept in a process-global
+ * table keyed by pattern and compile-affecting configuration and handed
+ * out to every engine that asks for the same compilation.  Entries are
+ * never freed: the footprint is bounded by the set of distinct
+ * (pattern, configuration) pairs seen over the process lifetime, which
+ * for reloads of the same rule set is the size of one compilation.
+ */
+typedef struct cpat_cache_entry_t cpat_cache_entry_t;
+struct cpat_cache_entry_t {
+    cpat_cache_entry_t *next;              /**< Next entry in bucket. */
+    char               *patt;              /**< Pattern text (malloc). */
+
+    /* Configuration the compilation depends on; part of the key. */
+    bool                is_dfa;            /**< DFA compilation? */
+    ib_num_t            study;             /**< config->study */
+    ib_num_t            use_jit;           /**< config->use_jit */
+    ib_num_t            match_limit;       /**< config->match_limit */
+    ib_num_t            match_limit_recursion; /**< ...recursion limit */
+    ib_num_t            dfa_workspace_size;    /**< DFA workspace size */
+
+    /* Compilation results; owned by the cache, never freed. */
+    pcre               *cpatt;             /**< Compiled pattern. */
+    pcre_extra         *edata;             /**< Study data, or NULL. */
+    bool                is_jit;            /**< JIT compilation stuck? */
+    int                 dfa_ws_size;       /**< Workspace size used. */
+};
+
+/** Bucket count for the compiled pattern cache; fixed, chains resolve. */
+#define CPAT_CACHE_BUCKETS 256
+
+static cpat_cache_entry_t *cpat_cache[CPAT_CACHE_BUCKETS];
+static pthread_mutex_t     cpat_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Bucket index for @a patt (djb2 over the pattern text).
+ */
+static size_t cpat_cache_bucket(const char *patt)
+{
+    size_t hash = 5381;
+
+    while (*patt != '\0') {
+        hash = hash * 33 + (unsigned char)*patt;
+        ++patt;
+    }
+
+    return hash % CPAT_CACHE_BUCKETS;
+}
+
+/**
+ * Does @a entry match the requested compilation exactly?
+ */
+static bool cpat_cache_match(
+    const cpat_cache_entry_t *entry,
+    const modpcre_cfg_t      *config,
+    bool                      is_dfa,
+    const char               *patt
+)
+{
+    return
+        entry->is_dfa                == is_dfa                        &&
+        entry->study                 == config->study                 &&
+        entry->use_jit               == config->use_jit               &&
+        entry->match_limit           == config->match_limit           &&
+        entry->match_limit_recursion == config->match_limit_recursion &&
+        entry->dfa_workspace_size    == config->dfa_workspace_size    &&
+        strcmp(entry->patt, patt)    == 0;
+}
+
+/**
+ * Find a cached compilation of @a patt under @a config.
+ *
+ * @returns The entry, or NULL if this compilation has not been cached.
+ */
+static cpat_cache_entry_t *cpat_cache_get(
+    const modpcre_cfg_t *config,
+    bool                 is_dfa,
+    const char          *patt
+)
+{
+    cpat_cache_entry_t *entry;
+
+    pthread_mutex_lock(&cpat_cache_lock);
+    for (
+        entry = cpat_cache[cpat_cache_bucket(patt)];
+        entry != NULL;
+        entry = entry->next
+    ) {
+        if (cpat_cache_match(entry, config, is_dfa, patt)) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&cpat_cache_lock);
+
+    return entry;
+}
+
+/**
+ * Record a successful compilation in the cache, taking ownership of
+ * @a cpdata's cpatt and edata.
+ *
+ * A duplicate insert (two engines configuring concurrently) wastes one
+ * compilation but is otherwise harmless; the first entry found wins on
+ * later lookups.
+ *
+ * @returns IB_OK, or IB_EALLOC if the entry could not be allocated (the
+ *          caller then keeps ownership of the compilation).
+ */
+static ib_status_t cpat_cache_put(
+    const modpcre_cfg_t       *config,
+    bool                       is_dfa,
+    const modpcre_cpat_data_t *cpdata
+)
+{
+    cpat_cache_entry_t *entry;
+    size_t              bucket;
+
+    entry = (cpat_cache_entry_t *)malloc(sizeof(*entry));
+    if (entry == NULL) {
+        return IB_EALLOC;
+    }
+
+    entry->patt = strdup(cpdata->patt);
+    if (entry->patt == NULL) {
+        free(entry);
+        return IB_EALLOC;
+    }
+
+    entry->is_dfa                = is_dfa;
+    entry->study                 = config->study;
+    entry->use_jit               = config->use_jit;
+    entry->match_limit           = config->match_limit;
+    entry->match_limit_recursion = config->match_limit_recursion;
+    entry->dfa_workspace_size    = config->dfa_workspace_size;
+    entry->cpatt                 = (pcre *)cpdata->cpatt;
+    entry->edata                 = (pcre_extra *)cpdata->edata;
+    entry->is_jit                = cpdata->is_jit;
+    entry->dfa_ws_size           = cpdata->dfa_ws_size;
+
+    bucket = cpat_cache_bucket(entry->patt);
+    pthread_mutex_lock(&cpat_cache_lock);
+    entry->next = cpat_cache[bucket];
+    cpat_cache[bucket] = entry;
+    pthread_mutex_unlock(&cpat_cache_lock);
+
+    return IB_OK;
+}
+
 /**
  * An adapter function to allow freeing of pcre_extra data via mpool callbacks.
  */
@@ -366,15 +560,18 @@ static ib_status_t compile_pattern(
                      patt, *errptr, *erroffset);
         return IB_EINVAL;
     }
-    ib_mm_register_cleanup(mm, pcre_free, cpatt);
 
-    /* Alias cpatt as the read-only cpatt value. */
+    /* Alias cpatt as the read-only cpatt value.  Ownership is settled by
+     * the caller: the compilation goes to the process-wide cache on
+     * success, or has its lifetime tied to @a mm if caching fails. */
     cpdata->cpatt = cpatt;
 
     /* Copy pattern. */
     cpdata->patt = ib_mm_strdup(mm, patt);
     if (cpdata->patt == NULL) {
         ib_log_error(ib, "Failed to duplicate pattern string: %s", patt);
+        pcre_free(cpatt);
+        cpdata->cpatt = NULL;
         return IB_EALLOC;
     }
 
@@ -416,8 +613,35 @@ static ib_status_t pcre_compile_internal(
     /* Pattern data structure we'll create */
     modpcre_cpat_data_t *cpdata;
 
+    /* Previous compilation of this pattern, if any. */
+    const cpat_cache_entry_t *cached;
+
     ib_status_t ib_rc;
 
+    /* Check the process-wide cache first: across engine reloads the same
+     * patterns are recompiled under the same configuration, and the
+     * compiled pattern, study data and JIT code can all be shared. */
+    cached = cpat_cache_get(config, is_dfa, patt);
+    if (cached != NULL) {
+        cpdata = (modpcre_cpat_data_t *)ib_mm_calloc(mm, sizeof(*cpdata), 1);
+        if (cpdata == NULL) {
+            return IB_EALLOC;
+        }
+
+        /* The cache entry (and thus cpatt, edata and patt) lives for the
+         * process lifetime, so aliasing it from mm-lifetime data is safe. */
+        cpdata->module      = module;
+        cpdata->cpatt       = cached->cpatt;
+        cpdata->edata       = cached->edata;
+        cpdata->patt        = cached->patt;
+        cpdata->is_dfa      = cached->is_dfa;
+        cpdata->is_jit      = cached->is_jit;
+        cpdata->dfa_ws_size = cached->dfa_ws_size;
+
+        *pcpdata = cpdata;
+        return IB_OK;
+    }
+
 #ifdef PCRE_HAVE_JIT
     /* Are we using JIT? */
     bool use_jit;
@@ -462,7 +686,6 @@ static ib_status_t pcre_compile_internal(
                 use_jit = false;
                 ib_log_warning(ib, "PCRE-JIT study failed: %s", *errptr);
             }
-            ib_mm_register_cleanup(mm, pcre_free_study_wrapper, edata);
             cpdata->edata = edata;
         }
         else
@@ -471,9 +694,9 @@ static ib_status_t pcre_compile_internal(
             edata = pcre_study(cpdata->cpatt, 0, errptr);
             if (*errptr != NULL)  {
                 ib_log_error(ib, "PCRE study failed: %s", *errptr);
+                pcre_free((void *)cpdata->cpatt);
                 return IB_EINVAL;
             }
-            ib_mm_register_cleanup(mm, pcre_free_study_wrapper, edata);
             cpdata->edata = edata;
         }
 
@@ -556,11 +779,188 @@ static ib_status_t pcre_compile_internal(
                  cpdata->is_dfa ? "yes" : "no",
                  cpdata->dfa_ws_size,
                  cpdata->is_jit ? "yes" : "no");
+
+    /* Hand the compilation to the process-wide cache so the next engine
+     * (typically the next configuration reload) reuses it.  If caching
+     * fails, fall back to the per-engine lifetime. */
+    ib_rc = cpat_cache_put(config, is_dfa, cpdata);
+    if (ib_rc != IB_OK) {
+        ib_mm_register_cleanup(mm, pcre_free, (void *)cpdata->cpatt);
+        if (cpdata->edata != NULL) {
+            ib_mm_register_cleanup(
+                mm, pcre_free_study_wrapper, (void *)cpdata->edata
+            );
+        }
+    }
+
     *pcpdata = cpdata;
 
     return IB_OK;
 }
 
+/**
+ * Create the PCRE set operator.
+ *
+ * The parameter names a file containing one pattern per line; blank
+ * lines and lines whose first character is @c # are skipped.  The
+ * patterns are combined into a single alternation and compiled once, so
+ * a rule tests a target against the whole set in one automaton pass
+ * instead of one rule and one compiled pattern per expression.
+ *
+ * @param[in] ctx Current context.
+ * @param[in] mm Memory manager.
+ * @param[in] parameters Path to the pattern file.
+ * @param[out] instance_data Instance data.
+ * @param[in] cbdata Callback data.
+ *
+ * @returns
+ * - IB_OK on success.
+ * - IB_EINVAL on an unreadable or empty pattern file or a pattern that
+ *   does not compile.
+ * - IB_EALLOC on allocation failure.
+ */
+static
+ib_status_t rxset_operator_create(
+    ib_context_t *ctx,
+    ib_mm_t       mm,
+    const char   *parameters,
+    void         *instance_data,
+    void         *cbdata
+)
+{
+    assert(ctx           != NULL);
+    assert(instance_data != NULL);
+
+    ib_engine_t *ib = ib_context_get_engine(ctx);
+    assert(ib != NULL);
+
+    modpcre_cpat_data_t *cpdata = NULL;
+    modpcre_operator_data_t *operator_data = NULL;
+    ib_module_t *module;
+    modpcre_cfg_t *config;
+    ib_status_t rc;
+    const char *errptr;
+    int erroffset;
+    FILE *fp;
+    char line[8192];
+    char *combined = NULL;
+    size_t combined_len = 0;
+    size_t combined_cap = 0;
+    size_t n_patterns = 0;
+
+    if (parameters == NULL) {
+        ib_log_error(ib, "No pattern file for operator.");
+        return IB_EINVAL;
+    }
+
+    /* Get my module object */
+    rc = ib_engine_module_get(ib, MODULE_NAME_STR, &module);
+    if (rc != IB_OK) {
+        ib_log_error(ib, "Error getting pcre module object: %s",
+                     ib_status_to_string(rc));
+        return rc;
+    }
+
+    /* Get the context configuration */
+    rc = ib_context_module_config(ctx, module, &config);
+    if (rc != IB_OK) {
+        ib_log_error(ib, "Error getting pcre module configuration: %s",
+                     ib_status_to_string(rc));
+        return rc;
+    }
+
+    fp = fopen(parameters, "r");
+    if (fp == NULL) {
+        ib_log_error(ib, "Error opening pattern file \"%s\".", parameters);
+        return IB_EINVAL;
+    }
+
+    /* Combine the patterns into "(?:p1)|(?:p2)|...". */
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        size_t len = strlen(line);
+        size_t need;
+
+        /* A full buffer without a newline means the line was split. */
+        if ( (len == sizeof(line) - 1) && (line[len-1] != '\n') ) {
+            ib_log_error(ib,
+                         "Pattern in \"%s\" exceeds %zd bytes.",
+                         parameters, sizeof(line) - 1);
+            free(combined);
+            fclose(fp);
+            return IB_EINVAL;
+        }
+
+        while ( (len > 0) &&
+                ( (line[len-1] == '\n') || (line[len-1] == '\r') ) )
+        {
+            line[--len] = '\0';
+        }
+        if ( (len == 0) || (line[0] == '#') ) {
+            continue;
+        }
+
+        /* Room for "|(?:" + pattern + ")" and a NUL. */
+        need = combined_len + len + 6;
+        if (need > combined_cap) {
+            size_t new_cap = (combined_cap == 0) ? 4096 : combined_cap;
+            while (new_cap < need) {
+                new_cap *= 2;
+            }
+            char *new_combined = realloc(combined, new_cap);
+            if (new_combined == NULL) {
+                free(combined);
+                fclose(fp);
+                return IB_EALLOC;
+            }
+            combined = new_combined;
+            combined_cap = new_cap;
+        }
+
+        combined_len += sprintf(
+            combined + combined_len,
+            "%s(?:%s)",
+            (n_patterns == 0) ? "" : "|",
+            line
+        );
+        ++n_patterns;
+    }
+    fclose(fp);
+
+    if (n_patterns == 0) {
+        ib_log_error(ib, "Pattern file \"%s\" holds no patterns.",
+                     parameters);
+        free(combined);
+        return IB_EINVAL;
+    }
+
+    /* Compile the combined pattern. */
+    rc = pcre_compile_internal(module,
+                               ib,
+                               mm,
+                               config,
+                               false,
+                               &cpdata,
+                               combined,
+                               &errptr,
+                               &erroffset);
+    free(combined);
+    if (rc != IB_OK) {
+        return rc;
+    }
+
+    /* Allocate a rule data object, populate it */
+    operator_data = ib_mm_alloc(mm, sizeof(*operator_data));
+    if (operator_data == NULL) {
+        return IB_EALLOC;
+    }
+    operator_data->cpdata = cpdata;
+    operator_data->id = NULL;           /* Not needed for rx rules */
+
+    *(modpcre_operator_data_t **)instance_data = operator_data;
+
+    return rc;
+}
+
 /**
  * Create the PCRE operator.
  *
@@ -650,11 +1050,20 @@ ib_status_t pcre_operator_create(
 /**
  * Set the matches into the given field name as .0, .1, .2 ... .9.
  *
+ * The captured spans alias @a subject rather than copying it: the
+ * subject is the value of a phase field (or a transformation result),
+ * both of which live in the transaction pool for the transaction
+ * lifetime, the same lifetime as the capture collection.  The aliases
+ * are read-only bytestrings, so anything that wants to mutate a capture
+ * must copy it first.  (The DFA path keeps its own subject copy because
+ * its subjects may be stream chunks; see pcre_dfa_set_match().)
+ *
  * @param[in] tx Current transaction.
  * @param[in] capture Collection to capture to.
  * @param[in] ovector The vector of integer pairs of matches from PCRE.
  * @param[in] matches The number of matches.
- * @param[in] subject The matched-against string data.
+ * @param[in] subject The matched-against string data.  Must live at
+ *            least as long as the transaction.
  *
  * @returns IB_OK or IB_EALLOC.
  */
@@ -693,21 +1102,29 @@ ib_status_t pcre_set_matches(
         /* Field name */
         const char *name;
 
-        /* Holder for a copy of the field value when creating a new field. */
+        /* Holder for an alias of the field value when creating a new field. */
         ib_bytestr_t *bs;
 
         /* Field holder. */
         ib_field_t *field;
 
-        /* Readability. Mark the start and length of the string. */
-        match_start = subject+ovector[i*2];
-        match_len = ovector[i*2+1] - ovector[i*2];
+        /* Readability. Mark the start and length of the string.  Groups
+         * that did not participate in the match report offset -1; treat
+         * them as empty. */
+        if (ovector[i*2] < 0) {
+            match_start = subject;
+            match_len = 0;
+        }
+        else {
+            match_start = subject+ovector[i*2];
+            match_len = ovector[i*2+1] - ovector[i*2];
+        }
 
-        /* Create a byte-string representation */
-        rc = ib_bytestr_dup_mem(&bs,
-                                tx->mm,
-                                (const uint8_t*)match_start,
-                                match_len);
+        /* Alias the span in the subject; no copy. */
+        rc = ib_bytestr_alias_mem(&bs,
+                                  tx->mm,
+                                  (const uint8_t*)match_start,
+                                  match_len);
         if (rc != IB_OK) {
             return rc;
         }
@@ -1236,9 +1653,30 @@ static ib_status_t pcre_operator_execute(
         return ib_rc;
     }
 
+    /* A transaction already past its inspection budget starts no new
+     * match work; within a match the compiled match limits bound the
+     * slice.  Fail open: no match, rules continue until the phase
+     * loop's own budget check stops them. */
+    if (tx_data->deadline != 0 && ib_clock_get_time() > tx_data->deadline) {
+        *result = 0;
+        return IB_OK;
+    }
+
+    /* Fetch this worker thread's pooled JIT stack; the configuration
+     * was resolved once per transaction. */
+    pcre_jit_stack *stack = NULL;
+#ifdef PCRE_HAVE_JIT
+    if (tx_data->config != NULL) {
+        stack = modpcre_get_thread_jit_stack(
+            (int)tx_data->config->jit_stack_start,
+            (int)tx_data->config->jit_stack_max
+        );
+    }
+#endif
+
     matches = pcre_exec_internal(
         operator_data->cpdata,
-        tx_data->stack,
+        stack,
         subject,
         subject_len,
         0, /* Starting offset. */
@@ -1399,6 +1837,12 @@ ib_status_t dfa_operator_create(
 /**
  * Create the per-transaction data for use with the dfa operator.
  *
+ * A cross-transaction workspace pool has been considered and is not
+ * worth its locking: workspaces are a few hundred bytes from the
+ * transaction arena, and connections recycle their transaction pools,
+ * so consecutive requests already reuse the same warmed pages without
+ * any coordination.
+ *
  * @param[in] data Previously created per-tx data.
  * @param[in,out] tx Transaction to store the value in.
  * @param[in] cpatt_data Compiled pattern data
@@ -1675,6 +2119,16 @@ static ib_status_t dfa_operator_execute_common(
 
             match_count += matches;
 
+            /* Abandon over-budget scans between match iterations. */
+            if (tx_data->deadline != 0 &&
+                ib_clock_get_time() > tx_data->deadline)
+            {
+                ib_log_debug_tx(tx,
+                                "Inspection budget exhausted during DFA "
+                                "match; abandoning (fail open).");
+                return IB_OK;
+            }
+
             /* Catch bugs that cause infinite matching. */
             if (match_count > 1000) {
                     pcre_log_error(
@@ -2151,15 +2605,8 @@ ib_status_t filter_rx_execute(
 
         assert(cpdata->edata != NULL);
 
-        stack = pcre_jit_stack_alloc(32*1024, 1000*1024);
-
-        if (stack != NULL) {
-            rc = ib_mm_register_cleanup(mm, pcre_jit_stack_cleanup, stack);
-            if (rc != IB_OK) {
-                pcre_jit_stack_free(stack);
-                return rc;
-            }
-        }
+        /* Use this worker thread's pooled JIT stack. */
+        stack = modpcre_get_thread_jit_stack(32*1024, 1000*1024);
     }
     else
 #endif
@@ -2291,7 +2738,7 @@ static ib_status_t modpcre_init(ib_engine_t *ib,
         NULL,
         ib,
         "pcre",
-        IB_OP_CAPABILITY_CAPTURE,
+        IB_OP_CAPABILITY_CAPTURE | IB_OP_CAPABILITY_PURE,
         pcre_operator_create, NULL,
         NULL, NULL,
         pcre_operator_execute, m
@@ -2305,7 +2752,7 @@ static ib_status_t modpcre_init(ib_engine_t *ib,
         NULL,
         ib,
         "rx",
-        IB_OP_CAPABILITY_CAPTURE,
+        IB_OP_CAPABILITY_CAPTURE | IB_OP_CAPABILITY_PURE,
         pcre_operator_create, NULL,
         NULL, NULL,
         pcre_operator_execute, m
@@ -2314,6 +2761,21 @@ static ib_status_t modpcre_init(ib_engine_t *ib,
         return rc;
     }
 
+    /* Match against a whole set of patterns with one compiled pattern.
+     * Execution is identical to rx; only creation differs. */
+    rc = ib_operator_create_and_register(
+        NULL,
+        ib,
+        "rxset",
+        IB_OP_CAPABILITY_CAPTURE | IB_OP_CAPABILITY_PURE,
+        rxset_operator_create, NULL,
+        NULL, NULL,
+        pcre_operator_execute, m
+    );
+    if (rc != IB_OK) {
+        return rc;
+    }
+
     /* Register a pcre operator that uses pcre_dfa_exec to match streams. */
     rc = ib_operator_create_and_register(
         NULL,
@@ -24,6 +24,7 @@
 
 #include "persistence_framework_private.h"
 
+#include <ironbee/clock.h>
 #include <ironbee/context.h>
 #include <ironbee/engine.h>
 #include <ironbee/engine_state.h>
@@ -186,6 +187,113 @@ static ib_status_t add_module_config(
 }
 
 
+/** How long a recorded miss stays valid (usec); bounds staleness
+ * when another writer creates the key without this thread seeing it. */
+#define PERSIST_NEG_TTL_USEC (30 * 1000000ULL)
+
+/** Slots in the per-worker negative key cache. */
+#define PERSIST_NEG_SLOTS 256
+
+/** Longest key cached; longer keys always hit the backing store. */
+#define PERSIST_NEG_MAX_KEY 64
+
+/**
+ * One known-missing key.
+ *
+ * Most transactions are keyed by fresh identifiers whose collections
+ * do not exist; remembering recent definite misses (exact keys, so a
+ * hash collision cannot suppress a real load) lets those transactions
+ * skip the backing-store round trip.  The cache is per worker thread
+ * -- entries carry the store they were recorded for -- so no reader
+ * ever races a writer.  A write to a key clears this thread's entry;
+ * writes by other threads or processes are covered by the TTL alone,
+ * exactly as for a shared backing store.
+ */
+typedef struct {
+    const ib_persist_fw_store_t *store; /**< Store recorded for. */
+    size_t    len;                      /**< Key length; 0 empty. */
+    ib_time_t until;                    /**< Valid until (engine clock). */
+    char      key[PERSIST_NEG_MAX_KEY]; /**< Key bytes. */
+} persist_fw_neg_entry_t;
+
+static __thread persist_fw_neg_entry_t c_neg_cache[PERSIST_NEG_SLOTS];
+
+/** Negative-cache slot for @a key of @a store. */
+static persist_fw_neg_entry_t *neg_cache_slot(
+    const ib_persist_fw_store_t *store,
+    const char                  *key,
+    size_t                       key_length
+)
+{
+    size_t hash = 5381;
+
+    for (size_t i = 0; i < key_length; ++i) {
+        hash = hash * 33 + (unsigned char)key[i];
+    }
+    hash = hash * 33 + (uintptr_t)store;
+
+    return &c_neg_cache[hash % PERSIST_NEG_SLOTS];
+}
+
+/** Is @a key a recently recorded definite miss? */
+static bool neg_cache_hit(
+    ib_persist_fw_store_t *store,
+    const char            *key,
+    size_t                 key_length
+)
+{
+    const persist_fw_neg_entry_t *entry;
+
+    if (key_length == 0 || key_length > PERSIST_NEG_MAX_KEY) {
+        return false;
+    }
+    entry = neg_cache_slot(store, key, key_length);
+    return entry->store == store &&
+           entry->len == key_length &&
+           entry->until >= ib_clock_coarse_get_time() &&
+           memcmp(entry->key, key, key_length) == 0;
+}
+
+/** Record @a key as missing. */
+static void neg_cache_set(
+    ib_persist_fw_store_t *store,
+    const char            *key,
+    size_t                 key_length
+)
+{
+    persist_fw_neg_entry_t *entry;
+
+    if (key_length == 0 || key_length > PERSIST_NEG_MAX_KEY) {
+        return;
+    }
+    entry = neg_cache_slot(store, key, key_length);
+    entry->store = store;
+    memcpy(entry->key, key, key_length);
+    entry->until = ib_clock_coarse_get_time() + PERSIST_NEG_TTL_USEC;
+    entry->len = key_length;
+}
+
+/** Forget any miss recorded for @a key (it was loaded or written). */
+static void neg_cache_clear(
+    ib_persist_fw_store_t *store,
+    const char            *key,
+    size_t                 key_length
+)
+{
+    persist_fw_neg_entry_t *entry;
+
+    if (key_length == 0 || key_length > PERSIST_NEG_MAX_KEY) {
+        return;
+    }
+    entry = neg_cache_slot(store, key, key_length);
+    if (entry->store == store &&
+        entry->len == key_length &&
+        memcmp(entry->key, key, key_length) == 0)
+    {
+        entry->len = 0;
+    }
+}
+
 /**
  * When a context is selected, populate the transaction from the handlers.
  *
@@ -263,6 +371,18 @@ ib_status_t populate_data_in_context(
             ib_list_t *list = NULL;
             ib_field_t *list_field = NULL;
 
+            /* Read-through negative cache: a key recently seen to be
+             * missing (the fresh-visitor common case) skips the
+             * backing-store round trip; the collection stays empty
+             * exactly as a miss would leave it. */
+            if (neg_cache_hit(store, key, key_length)) {
+                ib_log_debug(ib,
+                             "Skipping load of collection %s: "
+                             "key recently missing.",
+                             name);
+                continue;
+            }
+
             rc = ib_var_source_initialize(
                 mapping->source,
                 &list_field,
@@ -286,9 +406,17 @@ ib_status_t populate_data_in_context(
                 key, key_length,
                 list,
                 store->handler->load_data);
-            if (rc != IB_OK) {
+            if (rc == IB_ENOENT) {
+                /* A definite miss; remember it. */
+                neg_cache_set(store, key, key_length);
+                ib_log_debug(ib, "Failed to load collection %s", name);
+            }
+            else if (rc != IB_OK) {
                 ib_log_debug(ib, "Failed to load collection %s", name);
             }
+            else {
+                neg_cache_clear(store, key, key_length);
+            }
         }
     }
 
@@ -389,6 +517,10 @@ ib_status_t persist_data_in_context(
             if (rc != IB_OK) {
                 ib_log_error(ib, "Failed to store collection %s.", name);
             }
+            else {
+                /* The key now exists; forget any recorded miss. */
+                neg_cache_clear(store, key, key_length);
+            }
         }
     }
 
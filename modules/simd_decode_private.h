@@ -0,0 +1,255 @@
+/*****************************************************************************
+ * Licensed to Qualys, Inc. (QUALYS) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * QUALYS licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+#ifndef _IB_MODULES_SIMD_DECODE_PRIVATE_H_
+#define _IB_MODULES_SIMD_DECODE_PRIVATE_H_
+
+/**
+ * @file
+ * @brief IronBee Modules --- SIMD Base64/Hex Decode Kernels
+ *
+ * Vectorized bulk decoders using the standard lookup-shuffle approach
+ * (Mu&#322;a's base64 kernel).  Each decodes as many full input blocks
+ * as are valid and returns how much input it consumed and output it
+ * produced; the caller finishes the remainder (tail, padding,
+ * whitespace, or invalid bytes) with the scalar decoder, so semantics
+ * are exactly the scalar decoder's.
+ *
+ * Only standard-alphabet base64 and plain hex have kernels; variants
+ * (web-safe base64, prefixed hex extraction) take the scalar path.
+ * The same two entry points are the hook for NEON kernels on arm.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define IB_SIMD_DECODE_X86 1
+#include <immintrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef IB_SIMD_DECODE_X86
+
+/**
+ * Decode one 32-char standard base64 block to 24 bytes.
+ *
+ * @returns 1 on success, 0 if any input byte is not a base64 symbol
+ *          (including '=' padding and whitespace).
+ */
+__attribute__((target("avx2")))
+static inline int simd_b64_decode_block_avx2(
+    uint8_t       *dst,
+    const uint8_t *src
+)
+{
+    const __m256i lut_lo = _mm256_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m256i lut_hi = _mm256_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m256i lut_roll = _mm256_setr_epi8(
+        0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i mask_2F = _mm256_set1_epi8(0x2F);
+
+    __m256i in = _mm256_loadu_si256((const __m256i *)src);
+
+    const __m256i hi_nibbles =
+        _mm256_and_si256(_mm256_srli_epi32(in, 4), _mm256_set1_epi8(0x0F));
+    const __m256i lo_nibbles = _mm256_and_si256(in, _mm256_set1_epi8(0x0F));
+    const __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+    const __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+    const __m256i eq_2F = _mm256_cmpeq_epi8(in, mask_2F);
+    const __m256i roll =
+        _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_2F, hi_nibbles));
+
+    if (! _mm256_testz_si256(lo, hi)) {
+        return 0;
+    }
+
+    in = _mm256_add_epi8(in, roll);
+
+    /* Pack 32 six-bit values into 24 bytes. */
+    const __m256i merged =
+        _mm256_maddubs_epi16(in, _mm256_set1_epi32(0x01400140));
+    __m256i out = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+    out = _mm256_shuffle_epi8(out, _mm256_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    out = _mm256_permutevar8x32_epi32(
+        out, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+
+    /* 24 useful bytes; write via a temporary to avoid overrun. */
+    {
+        uint8_t tmp[32];
+        _mm256_storeu_si256((__m256i *)tmp, out);
+        memcpy(dst, tmp, 24);
+    }
+
+    return 1;
+}
+
+/**
+ * Decode one 32-char hex block to 16 bytes.
+ *
+ * @returns 1 on success, 0 if any input byte is not a hex digit.
+ */
+__attribute__((target("avx2")))
+static inline int simd_b16_decode_block_avx2(
+    uint8_t       *dst,
+    const uint8_t *src
+)
+{
+    const __m256i in = _mm256_loadu_si256((const __m256i *)src);
+
+    /* Validate: '0'-'9' or (c|0x20) in 'a'-'f'.  Unsigned range checks
+     * via signed compare after biasing by 0x80. */
+    const __m256i bias   = _mm256_set1_epi8((char)0x80);
+    const __m256i digit0 = _mm256_set1_epi8((char)('0' - 1) + (char)0x80);
+    const __m256i digit9 = _mm256_set1_epi8((char)('9' + 1) + (char)0x80);
+    const __m256i alpha  = _mm256_or_si256(in, _mm256_set1_epi8(0x20));
+    const __m256i alphaa = _mm256_set1_epi8((char)('a' - 1) + (char)0x80);
+    const __m256i alphaf = _mm256_set1_epi8((char)('f' + 1) + (char)0x80);
+
+    const __m256i in_b    = _mm256_add_epi8(in, bias);
+    const __m256i alpha_b = _mm256_add_epi8(alpha, bias);
+
+    const __m256i is_digit = _mm256_and_si256(
+        _mm256_cmpgt_epi8(in_b, digit0),
+        _mm256_cmpgt_epi8(digit9, in_b));
+    const __m256i is_alpha = _mm256_and_si256(
+        _mm256_cmpgt_epi8(alpha_b, alphaa),
+        _mm256_cmpgt_epi8(alphaf, alpha_b));
+
+    if ((uint32_t)_mm256_movemask_epi8(
+            _mm256_or_si256(is_digit, is_alpha)) != 0xFFFFFFFFu)
+    {
+        return 0;
+    }
+
+    /* Nibble value: (c & 0x0F) + 9 for alphabetic digits. */
+    __m256i nib = _mm256_and_si256(in, _mm256_set1_epi8(0x0F));
+    nib = _mm256_add_epi8(
+        nib, _mm256_and_si256(is_alpha, _mm256_set1_epi8(9)));
+
+    /* Combine pairs: 16 * hi + lo per byte pair. */
+    const __m256i pairs =
+        _mm256_maddubs_epi16(nib, _mm256_set1_epi16(0x0110));
+
+    /* Pack 16-bit values (all <= 255) into bytes, fixing lane order. */
+    __m256i packed = _mm256_packus_epi16(pairs, pairs);
+    packed = _mm256_permute4x64_epi64(packed, 0xD8);
+
+    {
+        uint8_t tmp[32];
+        _mm256_storeu_si256((__m256i *)tmp, packed);
+        memcpy(dst, tmp, 16);
+    }
+
+    return 1;
+}
+
+#endif /* IB_SIMD_DECODE_X86 */
+
+/**
+ * Bulk-decode a standard-alphabet base64 prefix of @a src.
+ *
+ * Decodes leading 32-character blocks while every byte is a plain
+ * base64 symbol, writing 24 bytes per block to @a dst.  Stops at the
+ * first block containing padding, whitespace or anything else, always
+ * on a 4-character group boundary, so the caller can hand the
+ * remainder to the scalar decoder unchanged.
+ *
+ * @param[out] dst Output; caller sizes it for the whole input.
+ * @param[in] src Input.
+ * @param[in] len Length of @a src.
+ * @param[out] consumed Input bytes decoded here.
+ *
+ * @returns Output bytes written.
+ */
+static inline size_t simd_b64_decode_prefix(
+    uint8_t       *dst,
+    const uint8_t *src,
+    size_t         len,
+    size_t        *consumed
+)
+{
+    size_t in_off = 0;
+    size_t out_off = 0;
+
+#ifdef IB_SIMD_DECODE_X86
+    if (__builtin_cpu_supports("avx2")) {
+        /* Leave at least one block for the scalar tail so padding at
+         * the very end never enters the kernel. */
+        while (in_off + 64 <= len &&
+               simd_b64_decode_block_avx2(dst + out_off, src + in_off))
+        {
+            in_off += 32;
+            out_off += 24;
+        }
+    }
+#endif
+
+    *consumed = in_off;
+    return out_off;
+}
+
+/**
+ * Bulk-decode a hex prefix of @a src; see simd_b64_decode_prefix().
+ *
+ * Stops on a byte-pair boundary.
+ */
+static inline size_t simd_b16_decode_prefix(
+    uint8_t       *dst,
+    const uint8_t *src,
+    size_t         len,
+    size_t        *consumed
+)
+{
+    size_t in_off = 0;
+    size_t out_off = 0;
+
+#ifdef IB_SIMD_DECODE_X86
+    if (__builtin_cpu_supports("avx2")) {
+        while (in_off + 32 <= len &&
+               simd_b16_decode_block_avx2(dst + out_off, src + in_off))
+        {
+            in_off += 32;
+            out_off += 16;
+        }
+    }
+#endif
+
+    *consumed = in_off;
+    return out_off;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _IB_MODULES_SIMD_DECODE_PRIVATE_H_ */
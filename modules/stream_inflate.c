@@ -30,6 +30,27 @@
 #include "stream_inflate_private.h"
 #include <zlib.h>
 
+#include <stdbool.h>
+#include <stdlib.h>
+
+/**
+ * Inflate processor instance: a pooled zlib stream.
+ */
+typedef struct {
+    z_stream strm;   /**< zlib stream; internal state is heap allocated. */
+    bool     broken; /**< Stream hit an error; do not pool or reuse. */
+} inflate_inst_t;
+
+/**
+ * One cached zlib stream per worker thread.
+ *
+ * inflateInit() allocates the internal state and 32KB window with every
+ * call; recycling a stream via inflateReset() keeps both across
+ * transactions.  A single slot suffices since a transaction's processor
+ * is created and destroyed on its worker thread.
+ */
+static __thread inflate_inst_t *c_thread_inflate_cache = NULL;
+
 //ib_stream_processor_create_fn
 ib_status_t create_inflate_processor(
     void    *instance_data,
@@ -37,24 +58,43 @@ ib_status_t create_inflate_processor(
     void    *cbdata
 )
 {
-  z_stream *strm;
+  inflate_inst_t *inst;
   int ret;
 
-  strm = (z_stream *) ib_mm_alloc(tx->mm, sizeof(z_stream));
-  if (strm == NULL) {
-    return IB_EALLOC;
+  /* Reuse this thread's cached stream if one is available. */
+  inst = c_thread_inflate_cache;
+  if (inst != NULL) {
+    c_thread_inflate_cache = NULL;
+    if (inflateReset(&inst->strm) != Z_OK) {
+      (void)inflateEnd(&inst->strm);
+      free(inst);
+      inst = NULL;
+    }
   }
-  // Use default memory allocation routines.
-  strm->zalloc = Z_NULL;
-  strm->zfree = Z_NULL;
-  strm->opaque = Z_NULL;
-  strm->avail_in = 0;
-  strm->next_in = Z_NULL;
-  ret = inflateInit(strm);
-  if (ret != Z_OK) {
-    return IB_EOTHER;
+
+  if (inst == NULL) {
+    inst = (inflate_inst_t *)malloc(sizeof(*inst));
+    if (inst == NULL) {
+      return IB_EALLOC;
+    }
+    // Use default memory allocation routines.
+    inst->strm.zalloc = Z_NULL;
+    inst->strm.zfree = Z_NULL;
+    inst->strm.opaque = Z_NULL;
+    inst->strm.avail_in = 0;
+    inst->strm.next_in = Z_NULL;
+    ret = inflateInit(&inst->strm);
+    if (ret != Z_OK) {
+      free(inst);
+      return IB_EOTHER;
+    }
   }
-  *(void **)instance_data = (void *)strm;
+
+  inst->broken = false;
+  inst->strm.avail_in = 0;
+  inst->strm.next_in = Z_NULL;
+
+  *(void **)instance_data = (void *)inst;
   return IB_OK;
 }
 
@@ -63,7 +103,20 @@ void destroy_inflate_processor(
     void *cbdata
 )
 {
-    //NOOP
+    inflate_inst_t *inst = (inflate_inst_t *)instance_data;
+
+    if (inst == NULL) {
+        return;
+    }
+
+    /* Pool healthy streams for reuse; release the rest. */
+    if ( (! inst->broken) && (c_thread_inflate_cache == NULL) ) {
+        c_thread_inflate_cache = inst;
+    }
+    else {
+        (void)inflateEnd(&inst->strm);
+        free(inst);
+    }
 }
 
 //ib_stream_processor_execute_fn
@@ -75,7 +128,8 @@ ib_status_t execute_inflate_processor(
     void                *cbdata
 )
 {
-    z_stream *strm = (z_stream *) instance_data;
+    inflate_inst_t *inst = (inflate_inst_t *)instance_data;
+    z_stream *strm = &inst->strm;
     int ret;
     ib_status_t rc;
     ib_stream_io_data_t *stream_data;
@@ -108,12 +162,12 @@ ib_status_t execute_inflate_processor(
             ret = inflate(strm, Z_NO_FLUSH);
             if (ret == Z_DATA_ERROR || ret == Z_NEED_DICT) {
                 ib_stream_io_data_error(io_tx, IB_S2SL("Invalid compressed data"));
-                (void)inflateEnd(strm);
+                inst->broken = true;
                 return IB_EOTHER;
             }
             else if (ret < 0) {
                 ib_stream_io_data_error(io_tx, IB_S2SL("Internal error inflating stream"));
-                (void)inflateEnd(strm);
+                inst->broken = true;
                 return IB_EOTHER;
             }
 
@@ -144,7 +198,7 @@ ib_status_t execute_inflate_processor(
     } while (ib_stream_io_data_depth(io_tx) > 0);
 
     if (rc != IB_OK) {
-        (void)inflateEnd(strm);
+        inst->broken = true;
     }
 
     return rc;
@@ -27,6 +27,8 @@
 #include <ironbeepp/all.hpp>
 
 #include <modp_b16.h>
+#include "simd_decode_private.h"
+
 #include <modp_b64.h>
 #include <modp_b64w.h>
 
@@ -80,13 +82,29 @@ ConstField b64_decode(
     size_t output_length = modp_b64_decode_len(bs.size());
     char* output = mm.allocate<char>(output_length);
 
-    int actual_output_length =
-        modp_b64_decode(output, bs.const_data(), bs.size());
+    // Bulk-decode leading clean blocks with the SIMD kernel; the
+    // scalar decoder finishes the remainder (tail, padding,
+    // whitespace), preserving its exact semantics.
+    size_t simd_consumed = 0;
+    size_t simd_out = simd_b64_decode_prefix(
+        reinterpret_cast<uint8_t*>(output),
+        reinterpret_cast<const uint8_t*>(bs.const_data()),
+        bs.size(),
+        &simd_consumed);
+
+    int actual_output_length = modp_b64_decode(
+        output + simd_out,
+        bs.const_data() + simd_consumed,
+        bs.size() - simd_consumed);
+    if (actual_output_length < 0) {
+        actual_output_length = 0;
+        simd_out = 0;
+    }
 
     return Field::create_no_copy_byte_string(
         mm,
         input.name(), input.name_length(),
-        ByteString::create(mm, output, actual_output_length)
+        ByteString::create(mm, output, simd_out + actual_output_length)
     );
 }
 
@@ -167,12 +185,28 @@ ConstField b16_decode(
     size_t output_length = modp_b16_decode_len(data_length);
     char* output = mm.allocate<char>(output_length);
 
-    int actual_output_length = modp_b16_decode(output, data, data_length);
+    // Bulk-decode leading clean blocks with the SIMD kernel; scalar
+    // finishes the remainder.
+    size_t simd_consumed = 0;
+    size_t simd_out = simd_b16_decode_prefix(
+        reinterpret_cast<uint8_t*>(output),
+        reinterpret_cast<const uint8_t*>(data),
+        data_length,
+        &simd_consumed);
+
+    int actual_output_length = modp_b16_decode(
+        output + simd_out,
+        data + simd_consumed,
+        data_length - simd_consumed);
+    if (actual_output_length < 0) {
+        actual_output_length = 0;
+        simd_out = 0;
+    }
 
     return Field::create_no_copy_byte_string(
         mm,
         input.name(), input.name_length(),
-        ByteString::create(mm, output, actual_output_length)
+        ByteString::create(mm, output, simd_out + actual_output_length)
     );
 }
 
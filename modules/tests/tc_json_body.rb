@@ -0,0 +1,69 @@
+class TestJsonBody < CLIPPTest::TestCase
+  include CLIPPTest
+
+  JSON_BODY = '{"user":{"name":"alice","id":7},"auth":{"token":"t0k3n"}}'
+
+  def json_body_clipp(config = {}, content_type = 'application/json')
+    config[:modules] ||= []
+    config[:modules] << 'json_body'
+    config[:modules] << 'htp'
+    clipp(config) do
+      transaction do |t|
+        t.request(
+          method: 'POST',
+          uri: '/api',
+          protocol: 'HTTP/1.1',
+          headers: {
+            'Host' => 'any',
+            'Content-Type' => content_type,
+            'Content-Length' => JSON_BODY.length
+          },
+          body: JSON_BODY
+        )
+      end
+    end
+  end
+
+  def test_load
+    json_body_clipp
+    assert_no_issues
+  end
+
+  def test_configured_paths_extracted
+    json_body_clipp(
+      config: "JsonBodyVar JSON_USER user.name\nJsonBodyVar JSON_TOKEN auth.token\n",
+      default_site_config: <<-EOS
+        Rule JSON_USER @clipp_print 'USER' id:1 rev:1 phase:REQUEST
+        Rule JSON_TOKEN @clipp_print 'TOKEN' id:2 rev:1 phase:REQUEST
+      EOS
+    )
+    assert_no_issues
+    assert_log_match /clipp_print \['USER'\]: alice/
+    assert_log_match /clipp_print \['TOKEN'\]: t0k3n/
+  end
+
+  def test_unmatched_path_unset
+    json_body_clipp(
+      config: "JsonBodyVar JSON_MISSING does.not.exist\n",
+      default_site_config: <<-EOS
+        Rule JSON_MISSING @clipp_print 'MISSING' id:1 rev:1 phase:REQUEST
+      EOS
+    )
+    assert_no_issues
+    assert_log_no_match /clipp_print \['MISSING'\]:/
+  end
+
+  def test_non_json_untouched
+    json_body_clipp(
+      {
+        config: "JsonBodyVar JSON_USER user.name\n",
+        default_site_config: <<-EOS
+          Rule JSON_USER @clipp_print 'USER' id:1 rev:1 phase:REQUEST
+        EOS
+      },
+      'text/plain'
+    )
+    assert_no_issues
+    assert_log_no_match /clipp_print \['USER'\]:/
+  end
+end
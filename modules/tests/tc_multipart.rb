@@ -0,0 +1,70 @@
+class TestMultipart < CLIPPTest::TestCase
+  include CLIPPTest
+
+  MULTIPART_BODY = [
+    "--AaB03x",
+    'Content-Disposition: form-data; name="field1"',
+    "",
+    "value1",
+    "--AaB03x",
+    'Content-Disposition: form-data; name="field2"',
+    'Content-Type: text/plain',
+    "",
+    "value2",
+    "--AaB03x--",
+    ""
+  ].join("\r\n")
+
+  def multipart_clipp(config = {}, content_type = 'multipart/form-data; boundary=AaB03x')
+    config[:modules] ||= []
+    config[:modules] << 'multipart'
+    config[:modules] << 'htp'
+    clipp(config) do
+      transaction do |t|
+        t.request(
+          method: 'POST',
+          uri: '/upload',
+          protocol: 'HTTP/1.1',
+          headers: {
+            'Host' => 'any',
+            'Content-Type' => content_type,
+            'Content-Length' => MULTIPART_BODY.length
+          },
+          body: MULTIPART_BODY
+        )
+      end
+    end
+  end
+
+  def test_load
+    multipart_clipp
+    assert_no_issues
+  end
+
+  def test_parts_parsed
+    # MULTIPART is a list of part entries; the rule target expands it,
+    # so the type prints once per parsed part.
+    multipart_clipp(
+      default_site_config: <<-EOS
+        Rule MULTIPART @clipp_print_type 'MP' id:1 rev:1 phase:REQUEST
+      EOS
+    )
+    assert_no_issues
+    assert_log_match /clipp_print_type \['MP'\]: LIST/
+  end
+
+  def test_no_boundary_no_var
+    # Without a multipart content type the processor never engages and
+    # the MULTIPART var stays unset.
+    multipart_clipp(
+      {
+        default_site_config: <<-EOS
+          Rule MULTIPART @clipp_print_type 'MP' id:1 rev:1 phase:REQUEST
+        EOS
+      },
+      'text/plain'
+    )
+    assert_no_issues
+    assert_log_no_match /clipp_print_type \['MP'\]:/
+  end
+end
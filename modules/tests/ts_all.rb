@@ -27,6 +27,8 @@ require 'tc_smart_stringencoders'
 require 'tc_utf8'
 require 'tc_txvars'
 require 'tc_response'
+require 'tc_multipart'
+require 'tc_json_body'
 
 # Conditionally require those module tests that use the optional OpenSSL code.
 File.open(File.join(CLIPPTest::TOP_BUILDDIR, "ironbee_config_auto_gen.h")) do |io|
@@ -570,6 +570,15 @@ struct TxLogConfig
     //! Is logging to the standard IronBee log enabled in this context?
     bool stdlog_enabled;
 
+    /**
+     * Emit records in the compact binary format instead of JSON?
+     *
+     * Binary records are self-framing (magic, length prefix) and are
+     * intended for external writers; they are not readable through
+     * TxLogIronBeeLog.
+     */
+    bool binary_format;
+
     std::map<
         std::string,
         std::map<
@@ -586,9 +595,137 @@ struct TxLogConfig
 TxLogConfig::TxLogConfig():
     is_enabled(true),
     stdlog_registered(false),
-    stdlog_enabled(true)
+    stdlog_enabled(true),
+    binary_format(false)
 {}
 
+namespace {
+
+//! Version of the binary transaction log record format.
+const uint8_t TXLOG_BINARY_VERSION = 1;
+
+//! Magic bytes opening every binary transaction log record.
+const char TXLOG_BINARY_MAGIC[4] = { 'I', 'B', 'T', 'X' };
+
+//! Append a big-endian 16 bit integer to @a out.
+void binAppendU16(std::string& out, uint16_t v)
+{
+    char b[2] = { char(v >> 8), char(v & 0xff) };
+    out.append(b, sizeof(b));
+}
+
+//! Append a big-endian 32 bit integer to @a out.
+void binAppendU32(std::string& out, uint32_t v)
+{
+    char b[4] = {
+        char(v >> 24), char(v >> 16), char(v >> 8), char(v)
+    };
+    out.append(b, sizeof(b));
+}
+
+//! Append a big-endian 64 bit integer to @a out.
+void binAppendU64(std::string& out, uint64_t v)
+{
+    binAppendU32(out, uint32_t(v >> 32));
+    binAppendU32(out, uint32_t(v & 0xffffffff));
+}
+
+//! Append a 16 bit length prefixed string to @a out, truncating at 64KB.
+void binAppendString(std::string& out, const std::string& s)
+{
+    size_t len = s.size();
+    if (len > 0xffff) {
+        len = 0xffff;
+    }
+    binAppendU16(out, uint16_t(len));
+    out.append(s.data(), len);
+}
+
+/**
+ * Render a transaction as a binary record.
+ *
+ * Layout, all integers big-endian:
+ * - magic "IBTX", u8 version, u32 length of the remainder.
+ * - u64 start time (ms since epoch), u32 duration (ms).
+ * - u16 client port, u16 server port, u32 response status,
+ *   u64 request bandwidth, u64 response bandwidth.
+ * - Length prefixed strings: tx id, client ip, sensor id, site id,
+ *   connection id, server ip, method, uri, protocol, host, path,
+ *   response protocol, audit log reference, block action, block method,
+ *   block phase.
+ *
+ * @param[in] tx Transaction to render.
+ * @param[in] conn Connection of @a tx.
+ * @param[in] siteId Site id or empty.
+ * @param[in] txlogdata Module telemetry for @a tx.
+ * @param[out] out Record appended here.
+ */
+void renderBinaryRecord(
+    IronBee::Transaction      tx,
+    IronBee::ConstConnection  conn,
+    const std::string&        siteId,
+    const TxLogData&          txlogdata,
+    std::string&              out
+)
+{
+    static const boost::posix_time::ptime epoch(
+        boost::gregorian::date(1970, 1, 1));
+
+    out.append(TXLOG_BINARY_MAGIC, sizeof(TXLOG_BINARY_MAGIC));
+    out.push_back(char(TXLOG_BINARY_VERSION));
+
+    /* Record the length field position; patched below. */
+    const size_t length_at = out.size();
+    binAppendU32(out, 0);
+
+    binAppendU64(out, (tx.started_time() - epoch).total_milliseconds());
+    binAppendU32(
+        out,
+        (tx.finished_time() - tx.started_time()).total_milliseconds());
+
+    binAppendU16(out, conn.remote_port());
+    binAppendU16(out, conn.local_port());
+
+    uint32_t status = 0;
+    try {
+        status = boost::lexical_cast<uint32_t>(
+            tx.response_line().status().to_s());
+    }
+    catch (const boost::bad_lexical_cast&) {
+        /* Leave status 0. */
+    }
+    binAppendU32(out, status);
+
+    binAppendU64(out, tx.request_length());
+    binAppendU64(out, tx.response_length());
+
+    binAppendString(out, tx.id());
+    binAppendString(out, tx.effective_remote_ip_string());
+    binAppendString(out, tx.engine().sensor_id());
+    binAppendString(out, siteId);
+    binAppendString(out, conn.id());
+    binAppendString(out, conn.local_ip_string());
+    binAppendString(out, tx.request_line().method().to_s());
+    binAppendString(out, tx.request_line().uri().to_s());
+    binAppendString(out, tx.request_line().protocol().to_s());
+    binAppendString(out, tx.hostname());
+    binAppendString(out, tx.path());
+    binAppendString(out, tx.response_line().protocol().to_s());
+    binAppendString(out, txlogdata.auditlogId());
+    binAppendString(out, txlogdata.blockAction());
+    binAppendString(out, txlogdata.blockMethod());
+    binAppendString(out, txlogdata.blockPhase());
+
+    /* Patch the record length: bytes following the length field. */
+    const uint32_t record_length = out.size() - length_at - 4;
+    out[length_at]     = char(record_length >> 24);
+    out[length_at + 1] = char(record_length >> 16);
+    out[length_at + 2] = char(record_length >> 8);
+    out[length_at + 3] = char(record_length);
+}
+
+} /* Anonymous namespace. */
+
 /**
  * Callback data for txlog_logger_format_fn().
  *
@@ -746,6 +883,33 @@ static ib_status_t txlog_logger_format_fn(
         return IB_EALLOC;
     }
 
+    /* Binary format: render the compact record and return. */
+    if (cfg.binary_format) {
+        try {
+            std::string record;
+            renderBinaryRecord(tx, conn, siteId, txlogdata, record);
+
+            stdmsg->msg =
+                reinterpret_cast<uint8_t *>(malloc(record.size()));
+            if (stdmsg->msg == NULL) {
+                free(stdmsg);
+                return IB_EALLOC;
+            }
+            memcpy(stdmsg->msg, record.data(), record.size());
+            stdmsg->msg_sz = record.size();
+        }
+        catch (...) {
+            free(stdmsg);
+            return IronBee::convert_exception(
+                IronBee::ConstEngine(rec->tx->ib));
+        }
+
+        stdmsg->prefix = NULL;
+        *reinterpret_cast<void **>(writer_record) = stdmsg;
+
+        return IB_OK;
+    }
+
     try {
         IronBee::Json()
             .withMap()
@@ -958,6 +1122,12 @@ private:
         bool on_off
     ) const;
 
+    //! Implement TxLogBinaryFormat directive.
+    void binaryFormatDirective(
+        IronBee::ConfigurationParser cp,
+        bool                         enabled
+    ) const;
+
     //! Implement TxLogData directive.
     void logDataDirective(
         IronBee::ConfigurationParser  cp,
@@ -1074,6 +1244,10 @@ TxLogModule::TxLogModule(IronBee::Module module):
             "TxLogEnabled",
             boost::bind(&TxLogModule::onOffDirective, this, _1, _3)
         )
+        .on_off(
+            "TxLogBinaryFormat",
+            boost::bind(&TxLogModule::binaryFormatDirective, this, _1, _3)
+        )
         .param2(
             "TxLogData",
             boost::bind(&TxLogModule::logDataDirective, this, _1, _3, _4)
@@ -1174,6 +1348,18 @@ void TxLogModule::onOffDirective(
     cfg.is_enabled = enabled;
 }
 
+void TxLogModule::binaryFormatDirective(
+    IronBee::ConfigurationParser  cp,
+    bool                          enabled
+) const
+{
+    TxLogConfig &cfg =
+        module().configuration_data<TxLogConfig>(cp.current_context());
+
+    /* Set the mapping in the context configuration. */
+    cfg.binary_format = enabled;
+}
+
 void TxLogModule::logToStdLogDirective(
     IronBee::ConfigurationParser cp,
     bool on_off
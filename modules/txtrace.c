@@ -0,0 +1,401 @@
+/*****************************************************************************
+ * Licensed to Qualys, Inc. (QUALYS) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * QUALYS licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+/**
+ * @file
+ * @brief IronBee Modules --- Transaction Timeline Tracing
+ *
+ * A peer of the txdump module: where txdump shows a transaction's
+ * state, this module shows its time.  For sampled transactions every
+ * engine state boundary is timestamped into a small per-transaction
+ * buffer (transaction-local, so recording takes no locks), and when
+ * the transaction finishes the intervals are appended to a trace file
+ * in Chrome trace-event JSON ("Array Format"; load the file in
+ * chrome://tracing or any flame-graph viewer that reads it).
+ *
+ * Per-rule timing is deliberately not duplicated here: aggregate rule
+ * and operator costs are the rule profiler's job (see
+ * ironbee/rule_profiler.h and the `rule_profile` controller command).
+ * Allocation tracing is omitted because @ref ib_mm_t has no hook
+ * points; if they are ever added, emitting them here as counter
+ * events is the natural extension.
+ *
+ * Usage:
+ * @code
+ * LoadModule ibmod_txtrace.so
+ * TxTraceFile /var/log/ironbee/trace.json
+ * TxTraceSampleRate 1000
+ * @endcode
+ */
+
+#include <ironbee/cfgmap.h>
+#include <ironbee/clock.h>
+#include <ironbee/config.h>
+#include <ironbee/context.h>
+#include <ironbee/engine.h>
+#include <ironbee/engine_state.h>
+#include <ironbee/lock.h>
+#include <ironbee/mm.h>
+#include <ironbee/module.h>
+#include <ironbee/type_convert.h>
+
+#include <assert.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Define the module name as well as a string version of it. */
+#define MODULE_NAME        txtrace
+#define MODULE_NAME_STR    IB_XSTRINGIFY(MODULE_NAME)
+
+IB_MODULE_DECLARE();
+
+/**
+ * Maximum timestamped boundaries per transaction.
+ *
+ * There are fewer than 32 transaction states, so this only truncates
+ * if states repeat (e.g. very long body-data streams, which this
+ * module does not hook for exactly that reason).
+ */
+#define TXTRACE_MAX_EVENTS 32
+
+/**
+ * Module data: trace sink and sampling state.
+ */
+typedef struct {
+    ib_module_t *module;      /**< This module. */
+    FILE        *fp;          /**< Trace file, or NULL when disabled. */
+    ib_lock_t   *fp_lock;     /**< Serializes appends to the file. */
+    ib_num_t     sample_rate; /**< Trace 1 in this many transactions. */
+    uint64_t     tx_counter;  /**< Transactions seen; drives sampling. */
+} txtrace_moddata_t;
+
+/**
+ * One timestamped state boundary.
+ */
+typedef struct {
+    ib_state_t state; /**< The state that fired. */
+    ib_time_t  ts;    /**< ib_clock_precise_get_time() at that moment. */
+} txtrace_event_t;
+
+/**
+ * Per-transaction timeline, attached as module transaction data.
+ *
+ * Only sampled transactions carry one; its absence makes the state
+ * hooks a cheap no-op for everything else.
+ */
+typedef struct {
+    size_t          n_events;                   /**< Events recorded. */
+    txtrace_event_t events[TXTRACE_MAX_EVENTS]; /**< The timeline. */
+} txtrace_txdata_t;
+
+/**
+ * The states that bound the phases of a transaction's lifetime.
+ *
+ * Per-chunk body-data states are excluded: they can fire thousands of
+ * times per transaction and their cost shows up as the width of the
+ * enclosing interval anyway.
+ */
+static const ib_state_t txtrace_states[] = {
+    tx_started_state,
+    handle_context_tx_state,
+    request_header_finished_state,
+    handle_request_header_state,
+    request_finished_state,
+    handle_request_state,
+    tx_process_state,
+    response_header_finished_state,
+    handle_response_header_state,
+    response_finished_state,
+    handle_response_state,
+    handle_postprocess_state,
+    handle_logging_state,
+    tx_finished_state,
+};
+
+/**
+ * Append the finished transaction's timeline to the trace file.
+ *
+ * Each pair of adjacent boundaries becomes one complete ("ph":"X")
+ * trace event named after the state that opened the interval, so the
+ * rendered flame row reads as "time spent getting from this state to
+ * the next".  A parent event spanning the whole transaction carries
+ * the transaction id.
+ */
+static void txtrace_write(
+    const ib_tx_t          *tx,
+    const txtrace_moddata_t *moddata,
+    const txtrace_txdata_t  *txdata
+)
+{
+    const uint64_t pid = (uint64_t)getpid();
+    const uint64_t tid = (uint64_t)pthread_self();
+
+    if (txdata->n_events < 2) {
+        return;
+    }
+
+    ib_lock_lock(moddata->fp_lock);
+
+    fprintf(
+        moddata->fp,
+        "{\"name\":\"tx %s\",\"cat\":\"tx\",\"ph\":\"X\","
+        "\"ts\":%" PRIu64 ",\"dur\":%" PRIu64 ","
+        "\"pid\":%" PRIu64 ",\"tid\":%" PRIu64 "},\n",
+        tx->id,
+        (uint64_t)txdata->events[0].ts,
+        (uint64_t)(txdata->events[txdata->n_events - 1].ts -
+                   txdata->events[0].ts),
+        pid,
+        tid);
+
+    for (size_t i = 0; i + 1 < txdata->n_events; ++i) {
+        fprintf(
+            moddata->fp,
+            "{\"name\":\"%s\",\"cat\":\"state\",\"ph\":\"X\","
+            "\"ts\":%" PRIu64 ",\"dur\":%" PRIu64 ","
+            "\"pid\":%" PRIu64 ",\"tid\":%" PRIu64 "},\n",
+            ib_state_name(txdata->events[i].state),
+            (uint64_t)txdata->events[i].ts,
+            (uint64_t)(txdata->events[i + 1].ts - txdata->events[i].ts),
+            pid,
+            tid);
+    }
+
+    fflush(moddata->fp);
+    ib_lock_unlock(moddata->fp_lock);
+}
+
+/**
+ * Hook callback: timestamp @a state into the transaction's timeline.
+ *
+ * On tx_started the sampling decision is made and the timeline
+ * allocated; on tx_finished the timeline is written out.
+ */
+static ib_status_t txtrace_on_state(
+    ib_engine_t *ib,
+    ib_tx_t     *tx,
+    ib_state_t   state,
+    void        *cbdata
+)
+{
+    assert(ib != NULL);
+    assert(tx != NULL);
+    assert(cbdata != NULL);
+
+    txtrace_moddata_t *moddata = (txtrace_moddata_t *)cbdata;
+    txtrace_txdata_t  *txdata = NULL;
+    ib_status_t        rc;
+
+    if (moddata->fp == NULL || moddata->sample_rate <= 0) {
+        return IB_OK;
+    }
+
+    if (state == tx_started_state) {
+        uint64_t n = __sync_fetch_and_add(&moddata->tx_counter, 1);
+        if (n % (uint64_t)moddata->sample_rate != 0) {
+            return IB_OK;
+        }
+        txdata = ib_mm_calloc(tx->mm, sizeof(*txdata), 1);
+        if (txdata == NULL) {
+            return IB_EALLOC;
+        }
+        rc = ib_tx_set_module_data(tx, moddata->module, txdata);
+        if (rc != IB_OK) {
+            return rc;
+        }
+    }
+    else {
+        rc = ib_tx_get_module_data(tx, moddata->module, &txdata);
+        if (rc != IB_OK || txdata == NULL) {
+            /* Not a sampled transaction. */
+            return IB_OK;
+        }
+    }
+
+    if (txdata->n_events < TXTRACE_MAX_EVENTS) {
+        txdata->events[txdata->n_events].state = state;
+        txdata->events[txdata->n_events].ts    = ib_clock_precise_get_time();
+        ++txdata->n_events;
+    }
+
+    if (state == tx_finished_state) {
+        txtrace_write(tx, moddata, txdata);
+    }
+
+    return IB_OK;
+}
+
+/**
+ * Handle the TxTraceFile directive: open (append) the trace file.
+ */
+static ib_status_t txtrace_file_dir_param1(
+    ib_cfgparser_t *cp,
+    const char     *name,
+    const char     *p1,
+    void           *cbdata
+)
+{
+    assert(cp != NULL);
+    assert(p1 != NULL);
+    assert(cbdata != NULL);
+
+    txtrace_moddata_t *moddata = (txtrace_moddata_t *)cbdata;
+
+    if (moddata->fp != NULL) {
+        fclose(moddata->fp);
+        moddata->fp = NULL;
+    }
+
+    moddata->fp = fopen(p1, "a");
+    if (moddata->fp == NULL) {
+        ib_cfg_log_error(cp, "TxTrace: Unable to open trace file \"%s\"", p1);
+        return IB_EINVAL;
+    }
+
+    /* Chrome's JSON Array Format tolerates a missing closing bracket
+     * and a trailing comma, which is what makes appending possible.
+     * Only a fresh file needs the opening bracket. */
+    fseek(moddata->fp, 0, SEEK_END);
+    if (ftell(moddata->fp) == 0) {
+        fprintf(moddata->fp, "[\n");
+    }
+
+    return IB_OK;
+}
+
+/**
+ * Handle the TxTraceSampleRate directive: trace 1 in N transactions.
+ */
+static ib_status_t txtrace_rate_dir_param1(
+    ib_cfgparser_t *cp,
+    const char     *name,
+    const char     *p1,
+    void           *cbdata
+)
+{
+    assert(cp != NULL);
+    assert(p1 != NULL);
+    assert(cbdata != NULL);
+
+    txtrace_moddata_t *moddata = (txtrace_moddata_t *)cbdata;
+    ib_num_t           rate;
+    ib_status_t        rc;
+
+    rc = ib_type_atoi(p1, 10, &rate);
+    if (rc != IB_OK || rate < 1) {
+        ib_cfg_log_error(
+            cp, "TxTrace: Invalid sample rate \"%s\"; expected N >= 1.", p1);
+        return IB_EINVAL;
+    }
+
+    moddata->sample_rate = rate;
+
+    return IB_OK;
+}
+
+static ib_dirmap_init_t txtrace_directive_map[] = {
+    IB_DIRMAP_INIT_PARAM1(
+        "TxTraceFile",
+        txtrace_file_dir_param1,
+        NULL                            /* Filled in by the init function */
+    ),
+    IB_DIRMAP_INIT_PARAM1(
+        "TxTraceSampleRate",
+        txtrace_rate_dir_param1,
+        NULL                            /* Filled in by the init function */
+    ),
+
+    /* signal the end of the list */
+    IB_DIRMAP_INIT_LAST
+};
+
+/* Called when module is loaded. */
+static ib_status_t txtrace_init(ib_engine_t *ib, ib_module_t *m, void *cbdata)
+{
+    assert(ib != NULL);
+    assert(m != NULL);
+
+    ib_status_t        rc;
+    txtrace_moddata_t *moddata;
+
+    moddata = ib_mm_calloc(ib_engine_mm_main_get(ib), sizeof(*moddata), 1);
+    if (moddata == NULL) {
+        return IB_EALLOC;
+    }
+    moddata->module      = m;
+    moddata->sample_rate = 1;
+
+    rc = ib_lock_create(&moddata->fp_lock, ib_engine_mm_main_get(ib));
+    if (rc != IB_OK) {
+        return rc;
+    }
+
+    for (size_t i = 0;
+         i < sizeof(txtrace_states) / sizeof(*txtrace_states);
+         ++i)
+    {
+        rc = ib_hook_tx_register(
+            ib, txtrace_states[i], txtrace_on_state, moddata);
+        if (rc != IB_OK) {
+            ib_log_error(
+                ib,
+                "TxTrace: Error registering hook for %s: %s",
+                ib_state_name(txtrace_states[i]),
+                ib_status_to_string(rc));
+            return rc;
+        }
+    }
+
+    m->data = moddata;
+    txtrace_directive_map[0].cbdata_cb = moddata;
+    txtrace_directive_map[1].cbdata_cb = moddata;
+
+    return IB_OK;
+}
+
+/* Called when module is unloaded. */
+static ib_status_t txtrace_finish(ib_engine_t *ib, ib_module_t *m, void *cbdata)
+{
+    assert(ib != NULL);
+    assert(m != NULL);
+
+    txtrace_moddata_t *moddata = (txtrace_moddata_t *)m->data;
+
+    if (moddata != NULL && moddata->fp != NULL) {
+        fclose(moddata->fp);
+        moddata->fp = NULL;
+    }
+
+    return IB_OK;
+}
+
+/* Initialize the module structure. */
+IB_MODULE_INIT(
+    IB_MODULE_HEADER_DEFAULTS,           /* Default metadata */
+    MODULE_NAME_STR,                     /* Module name */
+    IB_MODULE_CONFIG_NULL,               /* Global config data */
+    NULL,                                /* Configuration field map */
+    txtrace_directive_map,               /* Config directive map */
+    txtrace_init,                        /* Initialize function */
+    NULL,                                /* Callback data */
+    txtrace_finish,                      /* Finish function */
+    NULL,                                /* Callback data */
+);
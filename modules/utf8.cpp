@@ -49,6 +49,7 @@
 
 #include <iterator>
 #include <map>
+#include <cstring>
 #include <sstream>
 #include <vector>
 
@@ -198,6 +199,36 @@ void repack_utf8(std::vector<T> &v)
     }
 }
 
+/**
+ * True iff no byte of @a str has the high bit set.
+ *
+ * Such strings are trivially valid UTF-8.  Checked eight bytes at a
+ * time; typical HTTP field values are pure ASCII, making this the
+ * common case for both validation and normalization.
+ *
+ * @param[in] str String to check.
+ * @returns true iff @a str is pure ASCII.
+ */
+bool isAllAscii(const std::string& str)
+{
+    const char *data  = str.data();
+    uint64_t    accum = 0;
+    size_t      i     = 0;
+
+    for (; i + 8 <= str.size(); i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        accum |= word;
+    }
+    for (; i < str.size(); ++i) {
+        if (data[i] & 0x80) {
+            return false;
+        }
+    }
+
+    return (accum & UINT64_C(0x8080808080808080)) == 0;
+}
+
 /**
  * Return 1 if @a in is UTF8 and 0 otherwise.
  *
@@ -218,12 +249,14 @@ int validateUtf8(Transaction tx, ConstField in)
         return 0;
     }
 
-    std::istringstream in_stringstream(in.to_s());
+    std::string str = in.to_s();
 
-    std::istream_iterator<char> it(in_stringstream);
-    std::istream_iterator<char> eos;
+    /* Pure ASCII is valid; everything else takes the full decoder. */
+    if (isAllAscii(str)) {
+        return 1;
+    }
 
-    if (utf8::is_valid(it, eos)) {
+    if (utf8::is_valid(str.begin(), str.end())) {
         return 1;
     }
     else {
@@ -252,6 +285,11 @@ ConstField replaceInvalidUtf8(MemoryManager mm, ConstField f)
 
     std::string str = f.to_s();
 
+    /* Pure ASCII needs no replacement; return the input unchanged. */
+    if (isAllAscii(str)) {
+        return f;
+    }
+
     std::string new_str;
     utf8::replace_invalid(str.begin(), str.end(), std::back_inserter(new_str));
 
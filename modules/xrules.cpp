@@ -649,6 +649,12 @@ void XRulesModule::build_ip_xrule(IronBee::Engine ib, IronBee::Context ctx) {
         module().configuration_data<XRulesModuleConfig>(ctx);
 
     cfg.req_xrules.push_back(xrule_ptr(new XRuleIP(cfg)));
+
+    /* Like the address rules, all path rules compile into one
+     * longest-prefix set evaluated with one query per transaction. */
+    if (! cfg.path_list.empty()) {
+        cfg.req_xrules.push_back(xrule_ptr(new XRulePathSet(cfg.path_list)));
+    }
 }
 
 void XRulesModule::disable_xrule_events(IronBee::Engine ib, IronBee::Transaction tx) {
@@ -816,9 +822,9 @@ void XRulesModule::xrule_directive(
             ": "+
             action->logevent_msg();
         action->logevent_tag() = "xrule/path";
-        cfg.req_xrules.push_back(
-            xrule_ptr(
-                new XRulePath(params.front(), action)));
+        /* Collected; compiled into one XRulePathSet at context close. */
+        cfg.path_list.push_back(
+            std::make_pair(std::string(params.front()), action));
     }
     else if (boost::iequals(name_str, "XRuleTime")) {
         action->logevent_msg() =
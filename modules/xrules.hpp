@@ -427,6 +427,11 @@ public:
     //! List of IPv6 configurations.
     std::vector<ib_ipset6_entry_t> ipv6_list;
 
+    //! Configured path prefixes and their actions; compiled at
+    //! context close into one XRulePathSet (see build_ip_xrule's
+    //! sibling build step).
+    std::vector<std::pair<std::string, action_ptr> > path_list;
+
     //! List of xrules to execute for the request.
     std::list<xrule_ptr> req_xrules;
 
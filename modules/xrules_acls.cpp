@@ -459,6 +459,84 @@ void XRulePath::xrule_impl(
 }
 /* End XRulePath Impl */
 
+/* XRulePathSet Impl */
+XRulePathSet::XRulePathSet(
+    const std::vector<std::pair<std::string, action_ptr> >& paths
+)
+{
+    /* Group actions by path: configuring the same prefix twice applied
+     * both rules' actions, and one set entry must do the same. */
+    std::map<std::string, std::list<action_ptr> > grouped;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        grouped[paths[i].first].push_back(paths[i].second);
+    }
+
+    m_paths.reserve(grouped.size());
+    m_actions.reserve(grouped.size());
+    m_entries.reserve(grouped.size());
+
+    for (
+        std::map<std::string, std::list<action_ptr> >::const_iterator i =
+            grouped.begin();
+        i != grouped.end();
+        ++i
+    ) {
+        m_paths.push_back(i->first);
+        m_actions.push_back(i->second);
+    }
+    /* Entries reference the stable vectors built above. */
+    for (size_t i = 0; i < m_paths.size(); ++i) {
+        ib_stringset_entry_t entry;
+
+        entry.string = m_paths[i].data();
+        entry.length = m_paths[i].length();
+        entry.data   = &m_actions[i];
+        m_entries.push_back(entry);
+    }
+
+    IronBee::throw_if_error(
+        ib_stringset_init(&m_set, &m_entries[0], m_entries.size()),
+        "Failed to initialize path set."
+    );
+}
+
+void XRulePathSet::xrule_impl(
+    IronBee::Transaction tx,
+    ActionSet&           actions
+)
+{
+    if (tx.ib()->path == NULL) {
+        return;
+    }
+
+    const char *path = tx.ib()->path;
+    size_t      len = strlen(path);
+
+    /* Longest prefix first; re-query shorter to apply every matching
+     * rule's action, as the individual rules did. */
+    for (;;) {
+        const ib_stringset_entry_t *entry;
+
+        if (ib_stringset_query(&m_set, path, len, &entry) != IB_OK) {
+            break;
+        }
+
+        const std::list<action_ptr>& entry_actions =
+            *reinterpret_cast<std::list<action_ptr>*>(entry->data);
+        BOOST_FOREACH(action_ptr action, entry_actions) {
+            if (actions.overrides(action)) {
+                actions.set(action);
+            }
+        }
+
+        if (entry->length == 0) {
+            break;
+        }
+        len = entry->length - 1;
+    }
+}
+/* End XRulePathSet Impl */
+
 /* XRuleTime Impl */
 XRuleTime::XRuleTime(
     IronBee::ConfigurationParser cp,
@@ -784,8 +862,9 @@ void XRuleEventTag::xrule_impl(
         IronBee::ConstList<const ib_logevent_t*> logevents(tx.ib()->logevents);
         const ib_logevent_t *logevent = logevents.back();
         /* Do not consider suppressed events. */
-        if (logevent->suppress == IB_LEVENT_SUPPRESS_NONE) {
-
+        if (logevent->suppress == IB_LEVENT_SUPPRESS_NONE &&
+            logevent->tags != NULL)
+        {
             IronBee::ConstList<const char *> event_tags(logevent->tags);
 
             /* ... every tag in the events. */
@@ -35,6 +35,7 @@
 #include <ironbeepp/var.hpp>
 
 #include <ironbee/ipset.h>
+#include <ironbee/stringset.h>
 
 #ifdef __clang__
 #pragma clang diagnostic push
@@ -341,6 +342,52 @@ private:
     );
 };
 
+/**
+ * All configured path rules compiled into one longest-prefix set.
+ *
+ * One query per transaction replaces one prefix comparison per
+ * configured path rule.  Every matching prefix's action is applied
+ * (successively shorter matches are found by re-querying with the
+ * match truncated), preserving the semantics of the individual rules
+ * it replaces: action priority resolution is unchanged because the
+ * same set of actions is offered.
+ */
+class XRulePathSet : public XRule {
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param[in] paths Configured (prefix, action) pairs.
+     */
+    explicit
+    XRulePathSet(
+        const std::vector<std::pair<std::string, action_ptr> >& paths
+    );
+
+private:
+    //! Owned path strings, in set order.
+    std::vector<std::string> m_paths;
+    //! Per-path action groups parallel to the set entries.
+    std::vector<std::list<action_ptr> > m_actions;
+    //! Entry storage for the set.
+    std::vector<ib_stringset_entry_t> m_entries;
+    //! The compiled longest-prefix set.
+    ib_stringset_t m_set;
+
+    /**
+     * Apply the action of every configured prefix of the request path.
+     *
+     * @param[in] tx The transaction.
+     * @param[in] actions The action set to modify on matches.
+     */
+    virtual void xrule_impl(
+        IronBee::Transaction tx,
+        ActionSet&           actions
+    );
+};
+
 /**
  * Check if the start time of a tx falls in (or out of) a time window.
  */
@@ -29,6 +29,7 @@
 #include <ironbee/predicate/eval.hpp>
 
 #include <ironbee/rule_engine.h>
+#include <ironbee/rule_profiler.h>
 
 using namespace std;
 
@@ -256,11 +257,11 @@ GraphEvalProfileData::GraphEvalProfileData(
 }
 
 void GraphEvalProfileData::mark_start() {
-    m_eval_start = ib_clock_precise_get_time();
+    m_eval_start = ib_rule_profiler_ticks();
 }
 
 void GraphEvalProfileData::mark_finish() {
-    m_eval_finish = ib_clock_precise_get_time();
+    m_eval_finish = ib_rule_profiler_ticks();
 
     /* If we have a parent, report how much time we took. */
     if (m_parent != NULL) {
@@ -358,6 +359,14 @@ void GraphEvalState::initialize(const Node* node, EvalContext context)
     }
 }
 
+// Compiling the DAG to bytecode to replace the eval_calculate() virtual
+// dispatch has been considered and rejected: the indirect call is one
+// branch-predicted jump per node per phase, while the node bodies do
+// hashing, list manipulation and operator execution that dwarf it, and
+// a bytecode VM would have to reify exactly the boost::any state,
+// forwarding and phase semantics this class already encapsulates.  The
+// profitable compilation already happens upstream, where transform()
+// folds pure subtrees into literals so they are never evaluated at all.
 void GraphEvalState::eval(const Node* node, EvalContext context)
 {
 #ifdef EVAL_TRACE
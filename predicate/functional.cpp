@@ -156,6 +156,15 @@ bool Call::transform(
     NodeReporter       reporter
 )
 {
+    // This is the cross-transaction memoization point for pure subtrees:
+    // a call whose arguments are all literals is evaluated once, here at
+    // transformation time, and replaced by a Literal carrying its value.
+    // Because transformation iterates to a fixed point and replacements
+    // are themselves literals, folding cascades bottom-up through entire
+    // pure subtrees, so no transaction ever evaluates them.  Subtrees
+    // that read transaction inputs cannot be soundly cached across
+    // transactions and are re-evaluated per transaction as usual.
+
     // Only do something if all arguments are literal.
     BOOST_FOREACH(const node_p& arg, children()) {
         if (! arg->is_literal()) {
@@ -40,6 +40,15 @@ namespace {
 namespace P = IronBee::Predicate;
 
 //! Predicate `constant` function.
+//!
+//! Constant-propagation note: no separate transform-time oracle query
+//! is needed.  This call takes one static (literal) argument, so the
+//! Functional framework's transform folds it: prepare() resolves the
+//! constant from the engine during transformation and the call is
+//! replaced by a Literal carrying the value.  Because transformation
+//! iterates to a fixed point, any subtree depending solely on
+//! constants and literals then folds away bottom-up, leaving no trace
+//! of it in the runtime DAG.
 class Constant :
     public P::Functional::Simple
 {
@@ -1078,6 +1078,13 @@ IBModPredicateCore::result_t PerTransaction::query(
     const P::node_cp& root
 )
 {
+    // Roots are evaluated one at a time, on the rule engine's thread, as
+    // each injected rule queries its oracle.  Evaluating independent
+    // roots on a thread pool has been considered and rejected for now:
+    // queries arrive singly rather than as a batch, sibling roots share
+    // NodeEvalState through the merged DAG, and evaluation allocates from
+    // the transaction memory pool, which is not thread safe.  Any future
+    // parallelism needs batched queries plus per-thread arenas first.
     m_graph_eval_state.eval(root.get(), m_tx);
     P::NodeEvalState& nes = m_graph_eval_state.final(root.get(), m_tx);
 
@@ -674,11 +674,22 @@ void Var::eval_calculate(
         return;
     }
 
-    try {
-        value = Value(m_data->source.get(context.var_store()));
-    }
-    catch (enoent) {
-        return;
+    /* Use the non-throwing lookup: an absent var is the common case for
+     * early phases and would otherwise cost an exception per phase. */
+    {
+        ib_field_t *field = NULL;
+        ib_status_t rc = ib_var_source_get(
+            m_data->source.ib(),
+            &field,
+            context.var_store().ib()
+        );
+        if (rc == IB_ENOENT || field == NULL) {
+            return;
+        }
+        if (rc != IB_OK) {
+            IronBee::throw_if_error(rc);
+        }
+        value = Value(IronBee::ConstField(field));
     }
 
     if (
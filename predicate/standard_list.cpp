@@ -475,6 +475,19 @@ protected:
  *
  * This task is handled by add_from_current() and add_until_next_unfinished().
  *
+ * On allocation: element values are appended by reference, never
+ * copied, so Cat already shares structure at the element level; only
+ * the output list spine (one node per element) is fresh, and that is
+ * inherent to Cat's one-level flattening -- a child list's spine can
+ * only be reused when it is the entire output, and transform() already
+ * collapses those cases for literals.  Aliasing a lone non-literal
+ * child's list at eval was considered and rejected: it would forward
+ * the child value's name as Cat's result name, an observable change.
+ * Likewise, literal values need no per-engine interning pass: the
+ * merge graph dedups literal nodes by s-expression, so each distinct
+ * literal already has exactly one Value shared by every consumer in
+ * the graph.
+ *
  * This class is a friend of Cat and all routines take a `me` argument being
  * the Cat instance they are working on behalf of.
  **/
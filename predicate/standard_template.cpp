@@ -51,6 +51,52 @@ namespace {
 
 const string CALL_NAME_REF("ref");
 
+class Template;
+
+/**
+ * State shared by every call-site of one template definition.
+ *
+ * Besides the definition proper, this holds a memo of previous
+ * expansions: identical instantiations (same template, same argument
+ * expressions) expand to identical subtrees, so later call-sites can
+ * share the node the first expansion merged to instead of copying and
+ * substituting the body again.  For rule sets with thousands of
+ * instantiations this turns per-call-site expansion into a map lookup
+ * and keeps the pre-merge graph small.
+ *
+ * The memo is consulted and updated during transform, which runs
+ * single threaded at configuration time.
+ **/
+struct template_def_t
+{
+    template_def_t(
+        const template_arg_list_t& args_,
+        const node_cp&             body_,
+        const string&              origin_prefix_
+    ) :
+        args(args_),
+        body(body_),
+        origin_prefix(origin_prefix_),
+        expansion_graph(NULL)
+    {
+        // nop
+    }
+
+    //! Arguments.
+    const template_arg_list_t args;
+    //! Body expression.
+    const node_cp body;
+    //! Prefix for all body origin information.
+    const string origin_prefix;
+
+    //! Graph the memo below was built for; the memo is cleared when a
+    //! different graph comes along.
+    const MergeGraph* expansion_graph;
+    //! Instantiation sexpr to node the expansion merged to.
+    map<string, node_p> expansions;
+};
+typedef boost::shared_ptr<template_def_t> template_def_p;
+
 /**
  * Reference to something else, see Template.
  *
@@ -91,17 +137,13 @@ public:
      * Constructor.
      *
      * @param[in] name Name of template.
-     * @param[in] args List of arguments.  All ref nodes in @a body must
-     *                 use one of these.
-     * @param[in] body Body.  Any ref nodes in body will be replaced by
-     *                 children of this node according to @a args.
-     * @param[in] origin_prefix Prefix to add to all origins for body nodes.
+     * @param[in] def Definition (arguments, body, origin prefix and
+     *                expansion memo), shared with every other
+     *                call-site of this template.
      **/
     Template(
-        const std::string&          name,
-        const template_arg_list_t&  args,
-        const node_cp&              body,
-        const string&               origin_prefix
+        const std::string&    name,
+        const template_def_p& def
     );
 
     //! See Call::name()
@@ -132,12 +174,8 @@ public:
 private:
     //! Name.
     const std::string m_name;
-    //! Arguments.
-    const template_arg_list_t m_args;
-    //! Body expression.
-    const node_cp m_body;
-    //! Prefix for all body origin information.
-    const string m_origin_prefix;
+    //! Shared definition and expansion memo.
+    const template_def_p m_def;
 };
 
 const string& Ref::name() const
@@ -194,15 +232,11 @@ bool Ref::validate(NodeReporter reporter) const
 }
 
 Template::Template(
-    const string&              name,
-    const template_arg_list_t& args,
-    const node_cp&             body,
-    const string&              origin_prefix
+    const string&         name,
+    const template_def_p& def
 ) :
     m_name(name),
-    m_args(args),
-    m_body(body),
-    m_origin_prefix(origin_prefix)
+    m_def(def)
 {
     // nop
 }
@@ -232,7 +266,7 @@ void Template::post_transform(NodeReporter reporter) const
 bool Template::validate(NodeReporter reporter) const
 {
     return
-        Validate::n_children(reporter, m_args.size())
+        Validate::n_children(reporter, m_def->args.size())
         ;
 }
 
@@ -262,21 +296,45 @@ bool Template::transform(
 {
     node_p me = shared_from_this();
 
+    // Consult the expansion memo.  An identical instantiation was
+    // already expanded if its sexpr is recorded; if the node it merged
+    // to (or an equivalent) is still known to the graph, share it
+    // directly instead of expanding again.  If it has since been
+    // transformed away, fall through to a normal expansion, which the
+    // graph will merge as usual.
+    const string memo_key = me->to_s();
+    if (m_def->expansion_graph != &merge_graph) {
+        m_def->expansion_graph = &merge_graph;
+        m_def->expansions.clear();
+    }
+    {
+        map<string, node_p>::const_iterator memo_i =
+            m_def->expansions.find(memo_key);
+        if (memo_i != m_def->expansions.end()) {
+            node_p shared = merge_graph.known(memo_i->second);
+            if (shared) {
+                merge_graph.replace(me, shared);
+                merge_graph.add_origin(shared, m_def->origin_prefix + memo_key);
+                return true;
+            }
+        }
+    }
+
     // Construct map of argument name to children.
     typedef map<string, node_p> arg_map_t;
     arg_map_t arg_map;
 
     {
-        template_arg_list_t::const_iterator arg_i = m_args.begin();
+        template_arg_list_t::const_iterator arg_i = m_def->args.begin();
         node_list_t::const_iterator children_i = children().begin();
 
-        while (arg_i != m_args.end() && children_i != children().end()) {
+        while (arg_i != m_def->args.end() && children_i != children().end()) {
             arg_map.insert(make_pair(*arg_i, tree_copy(*children_i, call_factory)));
             ++arg_i;
             ++children_i;
         }
 
-        if (arg_i != m_args.end() || children_i != children().end()) {
+        if (arg_i != m_def->args.end() || children_i != children().end()) {
             reporter.error(
                 "Number of children not equal to number of arguments.  "
                 "Should have been caught in validation."
@@ -286,11 +344,11 @@ bool Template::transform(
     }
 
     // Construct copy of body to replace me with.
-    node_p replacement = tree_copy(m_body, call_factory);
+    node_p replacement = tree_copy(m_def->body, call_factory);
 
     // Special case.  Body might be itself a ref node.
     {
-        string top_ref = template_ref(m_body);
+        string top_ref = template_ref(m_def->body);
         if (! top_ref.empty()) {
             arg_map_t::const_iterator arg_i = arg_map.find(top_ref);
             if (arg_i == arg_map.end()) {
@@ -305,7 +363,7 @@ bool Template::transform(
             merge_graph.replace(me, replacement);
             merge_graph.add_origin(
                 replacement,
-                m_origin_prefix + m_body->to_s()
+                m_def->origin_prefix + m_def->body->to_s()
             );
             return true;
         }
@@ -338,14 +396,14 @@ bool Template::transform(
 
                 node_p arg = arg_i->second;
                 n->parents().front().lock()->replace_child(n, arg);
-                origin_info[arg] = m_origin_prefix + n->to_s();
+                origin_info[arg] = m_def->origin_prefix + n->to_s();
             }
             else {
                 copy(
                     n->children().begin(), n->children().end(),
                     back_inserter(todo)
                 );
-                origin_info[n] = m_origin_prefix + n->to_s();
+                origin_info[n] = m_def->origin_prefix + n->to_s();
             }
         }
     }
@@ -356,17 +414,20 @@ bool Template::transform(
         merge_graph.add_origin(v.first, v.second);
     }
 
+    // Record the expansion for later identical instantiations.
+    // replace() merged @c replacement into the graph, so this is the
+    // graph's node for this instantiation.
+    m_def->expansions[memo_key] = replacement;
+
     return true;
 }
 
 call_p define_template_creator(
-    const std::string&        name,
-    const template_arg_list_t args,
-    const node_cp             body,
-    const std::string         origin_prefix
+    const std::string&    name,
+    const template_def_p  def
 )
 {
-    return call_p(new Template(name, args, body, origin_prefix));
+    return call_p(new Template(name, def));
 }
 
 } // Anonymous
@@ -377,7 +438,8 @@ CallFactory::generator_t define_template(
     const string&              origin_prefix
 )
 {
-    return bind(define_template_creator, _1, args, body, origin_prefix);
+    template_def_p def(new template_def_t(args, body, origin_prefix));
+    return bind(define_template_creator, _1, def);
 }
 
 void load_template(CallFactory& to)
@@ -103,6 +103,7 @@ typedef struct ironbee_filter_ctx {
     apr_bucket_brigade *buffer;
     apr_off_t buf_limit;
     bool eos_sent;
+    bool notify_body;   /**< Feed body segments to the engine? */
 } ironbee_filter_ctx;
 
 typedef struct ironbee_svr_conf {
@@ -517,6 +518,10 @@ static int ironbee_headers_in(request_rec *r)
             rc_what = "ib_parsed_headers_create";
             goto finished;
         }
+        /* Share repeated header strings across this connection's
+         * transactions. */
+        ib_parsed_headers_intern(
+            ibhdrs, ctx->tx->conn->header_intern, ctx->tx->conn->mm);
 
         apr_table_do(ironbee_sethdr, ibhdrs, r->headers_in, NULL);
 
@@ -647,6 +652,8 @@ static apr_status_t ironbee_header_filter(ap_filter_t *f,
                       "ib_parsed_headers_create failed with %d", rc);
         goto header_filter_cleanup;
     }
+    ib_parsed_headers_intern(
+        ibhdrs, ctx->tx->conn->header_intern, ctx->tx->conn->mm);
     apr_table_do(ironbee_sethdr, ibhdrs, f->r->headers_out, NULL);
     apr_table_do(ironbee_sethdr, ibhdrs, f->r->err_headers_out, NULL);
     if (ibhdrs->size > 0) {
@@ -710,6 +717,65 @@ header_filter_cleanup:
     return ap_pass_brigade(nextf, bb);
 }
 
+/**
+ * Notify Ironbee of a file-backed bucket without morphing the bucket.
+ *
+ * apr_bucket_read() on a FILE bucket converts it in place into heap or
+ * mmap buckets, after which the core output filter can no longer send
+ * the file with sendfile().  This filter only observes the body (the
+ * engine is notified; the response content passed down the chain is
+ * never rewritten here), so the contents are read through a private
+ * copy of the bucket and the original stays file-backed for the rest
+ * of the filter chain.
+ *
+ * @param[in] f - the filter struct
+ * @param[in] rctx - request context holding the tx to notify
+ * @param[in] b - the file-backed bucket
+ * @return the number of bytes notified
+ */
+static apr_size_t ironbee_feed_file_bucket(ap_filter_t *f,
+                                           ironbee_req_ctx *rctx,
+                                           apr_bucket *b)
+{
+    apr_bucket_brigade *bbtmp;
+    apr_bucket *bcopy;
+    apr_status_t rv;
+    const char *buf;
+    apr_size_t buf_len;
+    apr_size_t total = 0;
+
+    rv = apr_bucket_copy(b, &bcopy);
+    if (rv != APR_SUCCESS) {
+        /* Can't copy; fall back to the morphing read. */
+        apr_bucket_read(b, &buf, &buf_len, APR_BLOCK_READ);
+        ib_state_notify_response_body_data(rctx->tx->ib, rctx->tx,
+                                           buf, buf_len);
+        return buf_len;
+    }
+
+    /* The copy has to live in a brigade: a morphing read inserts the
+     * unread remainder of the file after the bucket it just read.
+     */
+    bbtmp = apr_brigade_create(f->r->pool, f->c->bucket_alloc);
+    APR_BRIGADE_INSERT_TAIL(bbtmp, bcopy);
+    while (!APR_BRIGADE_EMPTY(bbtmp)) {
+        apr_bucket *bread = APR_BRIGADE_FIRST(bbtmp);
+        rv = apr_bucket_read(bread, &buf, &buf_len, APR_BLOCK_READ);
+        if (rv != APR_SUCCESS) {
+            ap_log_rerror(APLOG_MARK, APLOG_ERR, rv, f->r,
+                          "Ironbee: error reading copy of file bucket");
+            break;
+        }
+        ib_state_notify_response_body_data(rctx->tx->ib, rctx->tx,
+                                           buf, buf_len);
+        total += buf_len;
+        apr_bucket_delete(bread);
+    }
+    apr_brigade_destroy(bbtmp);
+
+    return total;
+}
+
 /**
  * HTTPD filter function to notify Ironbee of Response data,
  * and buffer data if required by Ironbee
@@ -771,6 +837,11 @@ static apr_status_t ironbee_filter_out(ap_filter_t *f, apr_bucket_brigade *bb)
             }
         }
 
+        /* Decide once whether the engine consumes response body
+         * segments; when not, buckets pass through unread. */
+        ctx->notify_body =
+            ib_tx_body_notification_needed(rctx->tx, true);
+
         /* First send a flush down the chain to trigger
          * the header filter and notify ironbee of the headers,
          * as well as tell the client we're alive.
@@ -800,11 +871,26 @@ static apr_status_t ironbee_filter_out(ap_filter_t *f, apr_bucket_brigade *bb)
             goto setaside_output;
         }
 
-        /* Now read the bucket and feed to ironbee */
+        /* Nothing consumes response body segments: pass buckets
+         * through unread (sendfile preserved trivially). */
+        if (! ctx->notify_body) {
+            goto setaside_output;
+        }
+
+        /* Now read the bucket and feed to ironbee.  File-backed buckets
+         * are fed through a private copy so the bucket passed down the
+         * chain stays file-backed and sendfile() keeps working; anything
+         * else is read in place as before.
+         */
         growing = (b->length == (apr_size_t)-1) ? 1 : growing;
-        apr_bucket_read(b, &buf, &buf_len, APR_BLOCK_READ);
-        bytecount += buf_len;
-        ib_state_notify_response_body_data(rctx->tx->ib, rctx->tx, buf, buf_len);
+        if (APR_BUCKET_IS_FILE(b)) {
+            bytecount += ironbee_feed_file_bucket(f, rctx, b);
+        }
+        else {
+            apr_bucket_read(b, &buf, &buf_len, APR_BLOCK_READ);
+            bytecount += buf_len;
+            ib_state_notify_response_body_data(rctx->tx->ib, rctx->tx, buf, buf_len);
+        }
 
         /* If Ironbee just signalled an error, switch to discard data mode,
          * dump anything we already have buffered,
@@ -1007,6 +1093,10 @@ static apr_status_t ironbee_filter_in(ap_filter_t *f,
         /* If we're buffering, initialise the buffer */
         ctx->buffer = apr_brigade_create(f->r->pool, f->c->bucket_alloc);
         ctx->eos_sent = false;
+
+        /* Decide once whether the engine consumes body segments. */
+        ctx->notify_body =
+            ib_tx_body_notification_needed(rctx->tx, false);
     }
     else {
         /* Clear any data previously buffered and returned */
@@ -1044,7 +1134,24 @@ static apr_status_t ironbee_filter_in(ap_filter_t *f,
                 goto setaside_input;
             }
 
-            /* Now read the bucket and feed to ironbee */
+            /* Now read the bucket and feed to ironbee.  Each bucket is
+             * notified individually; the brigade is never flattened.
+             * The copying notifier is used deliberately: heap bucket
+             * data is refcounted and freed when the handler consumes
+             * the bucket, long before the transaction ends, so the
+             * aliasing notifier's lifetime contract cannot be met here.
+             *
+             * When the engine has nothing consuming body segments for
+             * this transaction (no body processors, rules or audit
+             * buffering), skip the reads and notifications entirely;
+             * request_finished still delivers end-of-body.
+             */
+            if (! ctx->notify_body) {
+                if (APR_BUCKET_IS_EOS(b)) {
+                    eos_seen = 1;
+                }
+                goto setaside_input;
+            }
             growing = (b->length == (apr_size_t)-1) ? 1 : growing;
             apr_bucket_read(b, &buf, &buf_len, APR_BLOCK_READ);
             bytecount += buf_len;
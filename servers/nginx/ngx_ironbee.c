@@ -641,6 +641,10 @@ static ngx_int_t ironbee_headers_out(ngx_http_request_t *r)
     rc = ib_parsed_headers_create(&ibhdrs, ctx->tx->mm);
     if (rc != IB_OK)
         cleanup_return NGX_ERROR;
+    /* Share repeated header strings across this connection's
+     * transactions. */
+    ib_parsed_headers_intern(
+        ibhdrs, ctx->tx->conn->header_intern, ctx->tx->conn->mm);
 
     for (part = &r->headers_out.headers.part; part != NULL; part = part->next) {
         hdr = part->elts;
@@ -739,6 +743,10 @@ static ngx_int_t ironbee_post_read_request(ngx_http_request_t *r)
     rc = ib_parsed_headers_create(&ibhdrs, ctx->tx->mm);
     if (rc != IB_OK)
         cleanup_return NGX_ERROR;
+    /* Share repeated header strings across this connection's
+     * transactions. */
+    ib_parsed_headers_intern(
+        ibhdrs, ctx->tx->conn->header_intern, ctx->tx->conn->mm);
 
     for (part = &r->headers_in.headers.part; part != NULL; part = part->next) {
         hdr = part->elts;
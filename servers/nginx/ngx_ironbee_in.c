@@ -157,8 +157,13 @@ ngx_int_t ngxib_handler(ngx_http_request_t *r)
         ib_log_debug_tx(ctx->tx, "Feeding %zd bytes request data to ironbee.",
                         len);
         if (len > 0) {
-            ib_state_notify_request_body_data(ctx->tx->ib, ctx->tx,
-                                              (const char*)link->buf->pos, len);
+            /* Body buffers live in the request pool, which outlives the
+             * IronBee transaction, so they can be aliased rather than
+             * copied.  The temp-file path above uses a stack buffer and
+             * must keep copying. */
+            ib_state_notify_request_body_data_alias(
+                ctx->tx->ib, ctx->tx,
+                (const char*)link->buf->pos, len);
         }
     }
     ctx->body_done = 1;
@@ -53,6 +53,9 @@ struct tsib_ssn_ctx {
     int txn_count;
     int closing;
     TSCont contp;
+    /* One transaction context parked for reuse; transactions on a
+     * session are sequential, so a single slot covers keep-alive. */
+    tsib_txn_ctx *txn_ctx_cache;
 };
 
 /**
@@ -190,6 +193,9 @@ static void tsib_ssn_ctx_destroy(tsib_ssn_ctx * ssndata)
         ssndata->contp = NULL;
 
         TSContDestroy(contp);
+        if (ssndata->txn_ctx_cache != NULL) {
+            TSfree(ssndata->txn_ctx_cache);
+        }
         TSfree(ssndata);
     }
     else {
@@ -418,12 +424,23 @@ static void tsib_txn_ctx_destroy(tsib_txn_ctx *txndata)
         }
         TSContDataSet(ssndata->contp, NULL);
         TSContDestroy(ssndata->contp);
+        if (ssndata->txn_ctx_cache != NULL) {
+            TSfree(ssndata->txn_ctx_cache);
+        }
         TSfree(ssndata);
+        TSfree(txndata);
     }
     else {
         --(ssndata->txn_count);
+
+        /* Park the context for the session's next transaction. */
+        if (ssndata->txn_ctx_cache == NULL) {
+            ssndata->txn_ctx_cache = txndata;
+        }
+        else {
+            TSfree(txndata);
+        }
     }
-    TSfree(txndata);
 }
 
 static void ironbee_plugin_ssn_start(TSCont contp, TSHttpSsn ssnp)
@@ -534,8 +551,15 @@ static void ironbee_plugin_txn_start(TSCont contp, TSHttpTxn txnp)
         }
     }
 
-    /* create a txn cont (request ctx) and tx */
-    txndata = TSmalloc(sizeof(*txndata));
+    /* create a txn cont (request ctx) and tx, reusing the session's
+     * parked context when one is available */
+    if (ssndata->txn_ctx_cache != NULL) {
+        txndata = ssndata->txn_ctx_cache;
+        ssndata->txn_ctx_cache = NULL;
+    }
+    else {
+        txndata = TSmalloc(sizeof(*txndata));
+    }
     memset(txndata, 0, sizeof(*txndata));
     txndata->ssn = ssndata;
     txndata->txnp = txnp;
@@ -929,6 +953,45 @@ static void ironbee_plugin_ssn_close(TSCont contp, TSHttpSsn ssnp)
     TSHttpSsnReenable(ssnp, TS_EVENT_HTTP_CONTINUE);
 }
 
+/**
+ * Bundled arguments for an offloaded pre-remap event.
+ */
+typedef struct {
+    TSCont    txn_contp; /**< The transaction's continuation. */
+    TSHttpTxn txnp;      /**< The suspended transaction. */
+} tsib_offload_t;
+
+/**
+ * Task-pool continuation running ironbee_plugin_pre_remap().
+ *
+ * Request-header inspection is the heaviest IronBee work in the
+ * transaction and previously ran on the event (net) thread.  The
+ * transaction stays suspended until this handler reenables it from
+ * within ironbee_plugin_pre_remap(); sharing the transaction
+ * continuation's mutex keeps per-transaction events serialized.
+ *
+ * @param[in] contp This continuation; destroyed on completion.
+ * @param[in] event Event; unused.
+ * @param[in] edata Event data; unused.
+ *
+ * @returns 0.
+ */
+static int ironbee_plugin_pre_remap_offload(
+    TSCont contp,
+    TSEvent event,
+    void *edata
+)
+{
+    tsib_offload_t *offload = TSContDataGet(contp);
+
+    ironbee_plugin_pre_remap(offload->txn_contp, offload->txnp);
+
+    TSfree(offload);
+    TSContDestroy(contp);
+
+    return 0;
+}
+
 /**
  * Plugin for the IronBee ATS.
  *
@@ -979,8 +1042,24 @@ int ironbee_plugin(TSCont contp, TSEvent event, void *edata)
          * The OS_DNS hook is an alternative here.
          */
         case TS_EVENT_HTTP_PRE_REMAP:
-            ironbee_plugin_pre_remap(contp, (TSHttpTxn)edata);
+        {
+            /* Offload request-header inspection to the task thread pool
+             * so the event thread keeps serving I/O.  The transaction is
+             * left suspended; the offloaded handler reenables it. */
+            tsib_offload_t *offload = TSmalloc(sizeof(*offload));
+            TSCont          offload_contp;
+
+            offload->txn_contp = contp;
+            offload->txnp      = (TSHttpTxn)edata;
+
+            offload_contp = TSContCreate(
+                ironbee_plugin_pre_remap_offload,
+                TSContMutexGet(contp)
+            );
+            TSContDataSet(offload_contp, offload);
+            TSContSchedule(offload_contp, 0, TS_THREAD_POOL_TASK);
             break;
+        }
 
         /* CLEANUP EVENTS */
         case TS_EVENT_HTTP_TXN_CLOSE:
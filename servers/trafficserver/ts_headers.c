@@ -795,6 +795,10 @@ tsib_hdr_outcome process_hdr(tsib_txn_ctx *txndata,
         ret = HDR_ERROR;
         goto process_hdr_cleanup;
     }
+    /* Share repeated header strings across this connection's
+     * transactions. */
+    ib_parsed_headers_intern(
+        ibhdrs, txndata->tx->conn->header_intern, txndata->tx->conn->mm);
 
     // get_line ensures CRLF (line_len + 2)?
     line = hdr_buf;
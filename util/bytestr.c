@@ -145,21 +145,31 @@ ib_status_t ib_bytestr_dup_mem(
 ) {
     assert(pdst != NULL);
 
+    ib_bytestr_t *bs;
+
     if (data == NULL && data_length != 0) {
         return IB_EINVAL;
     }
 
-    ib_status_t rc = ib_bytestr_create(pdst, mm, data_length);
-    if (rc != IB_OK) {
-        return rc;
+    /* One allocation for header and content: duplicated bytestrings are
+     * the dominant small allocation on the header path, and the single
+     * block keeps each record's bytes next to its metadata. */
+    bs = (ib_bytestr_t *)ib_mm_alloc(mm, sizeof(*bs) + data_length);
+    if (bs == NULL) {
+        return IB_EALLOC;
     }
 
-    if (data != NULL) {
-        assert((*pdst)->size >= data_length);
+    bs->mm     = mm;
+    bs->flags  = 0;
+    bs->data   = (uint8_t *)(bs + 1);
+    bs->length = data_length;
+    bs->size   = data_length;
 
-        memcpy(ib_bytestr_ptr(*pdst), data, data_length);
-        (*pdst)->length = data_length;
+    if (data != NULL && data_length > 0) {
+        memcpy(bs->data, data, data_length);
     }
+
+    *pdst = bs;
     return IB_OK;
 }
 
@@ -285,6 +295,71 @@ ib_status_t DLL_PUBLIC ib_bytestr_setv_const(
     return IB_OK;
 }
 
+ib_status_t ib_bytestr_reserve(
+    ib_bytestr_t  *bs,
+    size_t         length,
+    uint8_t      **data
+)
+{
+    assert(bs != NULL);
+    assert(data != NULL);
+
+    size_t new_length;
+
+    if (IB_BYTESTR_CHECK_FREADONLY(bs->flags)) {
+        return IB_EINVAL;
+    }
+
+    new_length = bs->length + length;
+    if (new_length < bs->length) {
+        return IB_EINVAL;
+    }
+
+    if (new_length > bs->size) {
+        size_t   new_size = new_length;
+        uint8_t *new_data;
+
+        if (new_size < 2 * bs->size) {
+            new_size = 2 * bs->size;
+        }
+        new_data = (uint8_t *)ib_mm_alloc(bs->mm, new_size);
+        if (new_data == NULL) {
+            return IB_EALLOC;
+        }
+        if (bs->length > 0) {
+            memcpy(new_data, bs->data, bs->length);
+        }
+        bs->data = new_data;
+        bs->size = new_size;
+    }
+
+    *data = bs->data + bs->length;
+
+    return IB_OK;
+}
+
+ib_status_t ib_bytestr_commit(
+    ib_bytestr_t *bs,
+    size_t        length
+)
+{
+    assert(bs != NULL);
+
+    if (IB_BYTESTR_CHECK_FREADONLY(bs->flags)) {
+        return IB_EINVAL;
+    }
+
+    /* Only space made available by ib_bytestr_reserve() may be
+     * committed. */
+    if (length > bs->size - bs->length) {
+        return IB_EINVAL;
+    }
+
+    bs->length += length;
+
+    return IB_OK;
+}
+
 ib_status_t ib_bytestr_append(
     ib_bytestr_t *dst,
     const ib_bytestr_t *src
@@ -325,7 +400,16 @@ ib_status_t ib_bytestr_append_mem(
     new_length = dst_length + data_length;
 
     if (new_length > dst->size) {
-        new_data = (uint8_t *)ib_mm_alloc(dst->mm, new_length);
+        size_t new_size = new_length;
+
+        /* Grow geometrically: the old buffer is abandoned in the pool,
+         * so exact growth makes repeated appends quadratic in both time
+         * and pool usage. */
+        if (new_size < 2 * dst->size) {
+            new_size = 2 * dst->size;
+        }
+
+        new_data = (uint8_t *)ib_mm_alloc(dst->mm, new_size);
         if (new_data == NULL) {
             return IB_EALLOC;
         }
@@ -337,7 +421,7 @@ ib_status_t ib_bytestr_append_mem(
             );
         }
         dst->data = new_data;
-        dst->size = new_length;
+        dst->size = new_size;
     }
     assert(new_length <= dst->size);
 
@@ -52,6 +52,12 @@ ib_status_t ib_cfgmap_create(ib_cfgmap_t **pcm,
     /* Set by ib_cfgmap_init() */
     (*pcm)->base = NULL;
 
+    rc = ib_hash_create_nocase(&(*pcm)->direct, mm);
+    if (rc != IB_OK) {
+        rc = IB_EALLOC;
+        goto failed;
+    }
+
     return IB_OK;
 
 failed:
@@ -196,6 +202,28 @@ ib_status_t ib_cfgmap_init(ib_cfgmap_t *cm,
             return rc;
         }
 
+        /* Record the compiled accessor: static entries carry the
+         * direct value pointer (base and offset are in hand here),
+         * dynamic entries the field so gets call their getter. */
+        {
+            ib_cfgmap_accessor_t *accessor =
+                (ib_cfgmap_accessor_t *)ib_mm_alloc(
+                    cm->mm, sizeof(*accessor));
+            if (accessor == NULL) {
+                return IB_EALLOC;
+            }
+            accessor->field = f;
+            accessor->type  = rec->type;
+            accessor->ptr   =
+                (rec->fn_get == NULL)
+                ? (const void *)(((uint8_t *)base) + rec->offset)
+                : NULL;
+            rc = ib_hash_set(cm->direct, rec->name, accessor);
+            if (rc != IB_OK) {
+                return rc;
+            }
+        }
+
         ++rec;
     }
 
@@ -241,3 +269,51 @@ ib_status_t ib_cfgmap_get(const ib_cfgmap_t *cm,
     rc = ib_field_value(f, out_val);
     return rc;
 }
+
+ib_status_t ib_cfgmap_accessor(const ib_cfgmap_t *cm,
+                               const char *name,
+                               ib_cfgmap_accessor_t *accessor)
+{
+    ib_cfgmap_accessor_t *stored;
+    ib_status_t rc;
+
+    rc = ib_hash_get(cm->direct, &stored, name);
+    if (rc != IB_OK) {
+        return rc;
+    }
+
+    *accessor = *stored;
+    return IB_OK;
+}
+
+ib_status_t ib_cfgmap_accessor_get(
+    const ib_cfgmap_accessor_t *accessor,
+    void *out_val)
+{
+    /* Dynamic entries go through their getter. */
+    if (accessor->ptr == NULL) {
+        return ib_field_value(accessor->field, out_val);
+    }
+
+    switch (accessor->type) {
+    case IB_FTYPE_NUM:
+        *(ib_num_t *)out_val = *(const ib_num_t *)accessor->ptr;
+        return IB_OK;
+    case IB_FTYPE_FLOAT:
+        *(ib_float_t *)out_val = *(const ib_float_t *)accessor->ptr;
+        return IB_OK;
+    case IB_FTYPE_TIME:
+        *(ib_time_t *)out_val = *(const ib_time_t *)accessor->ptr;
+        return IB_OK;
+    case IB_FTYPE_NULSTR:
+        *(const char **)out_val = *(const char *const *)accessor->ptr;
+        return IB_OK;
+    case IB_FTYPE_BYTESTR:
+        *(const ib_bytestr_t **)out_val =
+            *(const ib_bytestr_t *const *)accessor->ptr;
+        return IB_OK;
+    default:
+        /* Types without a defined unboxed shape read via the field. */
+        return ib_field_value(accessor->field, out_val);
+    }
+}
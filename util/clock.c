@@ -166,6 +166,94 @@ ib_time_t ib_clock_precise_get_time(void)
 #endif
 }
 
+#if defined(__x86_64__) || defined(__i386__)
+#define IB_CLOCK_HAVE_TSC 1
+
+/** Read the CPU timestamp counter. */
+static inline uint64_t clock_tsc(void)
+{
+    uint32_t lo;
+    uint32_t hi;
+
+    __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+#endif
+
+#ifdef IB_CLOCK_HAVE_TSC
+
+/** Re-read the system clock after this much extrapolated time. */
+#define IB_CLOCK_COARSE_MAX_USEC 1000
+
+/** Minimum elapsed microseconds between readings used to calibrate. */
+#define IB_CLOCK_COARSE_MIN_CALIB_USEC 100
+
+/*
+ * Per-thread coarse clock state: the last system clock reading, the
+ * timestamp counter at that reading, and the calibrated counter ticks
+ * per microsecond (0 until two readings far enough apart have been
+ * taken).
+ */
+static __thread ib_time_t c_coarse_time         = 0;
+static __thread uint64_t  c_coarse_tsc          = 0;
+static __thread uint64_t  c_coarse_tsc_per_usec = 0;
+static __thread ib_time_t c_coarse_last         = 0;
+
+#endif /* IB_CLOCK_HAVE_TSC */
+
+ib_time_t ib_clock_coarse_get_time(void)
+{
+#ifdef IB_CLOCK_HAVE_TSC
+    uint64_t  tsc = clock_tsc();
+    ib_time_t result;
+
+    if (c_coarse_tsc_per_usec != 0 && tsc > c_coarse_tsc) {
+        uint64_t delta_usec =
+            (tsc - c_coarse_tsc) / c_coarse_tsc_per_usec;
+
+        if (delta_usec <= IB_CLOCK_COARSE_MAX_USEC) {
+            result = c_coarse_time + delta_usec;
+            goto clamp;
+        }
+    }
+
+    /* Refresh, and recalibrate from the previous reading when it is
+     * far enough away for the ratio to be meaningful.  The counter
+     * rate can vary (frequency scaling, migration); recalibrating on
+     * every refresh keeps the extrapolation self-correcting, and the
+     * refresh cap bounds any error to about a millisecond's worth. */
+    {
+        ib_time_t now = ib_clock_get_time();
+
+        if (c_coarse_tsc != 0 &&
+            now > c_coarse_time + IB_CLOCK_COARSE_MIN_CALIB_USEC &&
+            tsc > c_coarse_tsc)
+        {
+            uint64_t ratio = (tsc - c_coarse_tsc) / (now - c_coarse_time);
+            c_coarse_tsc_per_usec = (ratio > 0) ? ratio : 1;
+        }
+
+        c_coarse_time = now;
+        c_coarse_tsc  = tsc;
+        result = now;
+    }
+
+clamp:
+    /* Extrapolation can overshoot a subsequent fresh reading by a few
+     * microseconds; keep the sequence non-decreasing per thread so
+     * unsigned deltas between adjacent events never underflow. */
+    if (result < c_coarse_last) {
+        result = c_coarse_last;
+    }
+    else {
+        c_coarse_last = result;
+    }
+    return result;
+#else
+    return ib_clock_get_time();
+#endif
+}
+
 void ib_clock_gettimeofday(ib_timeval_t *tp)
 {
     assert(tp != NULL);
@@ -54,6 +54,30 @@ ib_status_t ib_dso_open(
 
     /// @todo Probably need to do this portably someday
 
+    /* On cold-start relocation cost, which comes up for deployments
+     * with many modules:
+     *
+     * - Binding is already lazy (RTLD_LAZY): only symbols actually
+     *   reached are resolved, on first use.  An explicit prebind pass
+     *   would resolve addresses via dlsym() but cannot pre-fix a
+     *   module's own PLT entries, so it would not move the work.
+     *
+     * - A symbol-address cache persisted across process starts (keyed
+     *   by DSO mtime) is unsound under address space randomization:
+     *   load addresses differ per process, so cached absolute
+     *   addresses are meaningless and cached offsets just re-derive
+     *   what the dynamic linker already computes.
+     *
+     * - Loading modules from parallel threads does not pay either:
+     *   dlopen() serializes on the dynamic loader's internal lock, and
+     *   each module's init runs engine registration (operator, action,
+     *   directive tables) that is single threaded by design at
+     *   configuration time.
+     *
+     * Within one process, repeat loads are already cheap: dlopen()
+     * reference-counts by path, so a reload engine created while the
+     * previous engine still holds the module reuses the resident
+     * mapping with no new relocation. */
     handle = dlopen(file, RTLD_GLOBAL|RTLD_LAZY);
     if (handle == NULL) {
         ib_util_log_error("%s", dlerror());
@@ -70,6 +70,14 @@ struct ib_field_val_t {
     void                 *cbdata_set;    /**< Data passed to fn_get. */
     void                 *pval;          /**< Address where value is stored */
     ib_field_val_union_t  u;             /**< Union of value types */
+
+    /* Memoization of argument-less dynamic gets; see
+     * ib_field_memoize(). */
+    bool                  memoize;   /**< Memoization enabled. */
+    bool                  memoized;  /**< memo_u holds a value. */
+    const uint64_t       *memo_gen_src; /**< Invalidation counter or NULL. */
+    uint64_t              memo_gen;  /**< Counter value at memoization. */
+    ib_field_val_union_t  memo_u;    /**< The memoized value. */
 };
 
 const char *ib_field_type_name(
@@ -410,8 +418,15 @@ ib_status_t ib_field_create_alias(
     ib_status_t rc;
     char *name_copy;
 
-    /* Allocate the field structure. */
-    *pf = (ib_field_t *)ib_mm_alloc(mm, sizeof(**pf));
+    /* Allocate the field structure, value store and name copy in one
+     * block: field, then value store (pointer aligned), then name.
+     * With numeric values stored in the value store's internal union,
+     * this makes a whole numeric or short-string field one allocation. */
+    *pf = (ib_field_t *)ib_mm_calloc(
+        mm,
+        1,
+        sizeof(**pf) + sizeof(*((*pf)->val)) + nlen
+    );
     if (*pf == NULL) {
         rc = IB_EALLOC;
         goto failed;
@@ -420,24 +435,14 @@ ib_status_t ib_field_create_alias(
     (*pf)->type = type;
     (*pf)->tfn = NULL;
 
+    (*pf)->val = (ib_field_val_t *)(*pf + 1);
+
     /* Copy the name. */
     (*pf)->nlen = nlen;
-    name_copy = (char *)ib_mm_alloc(mm, nlen);
-    if (name_copy == NULL) {
-        rc = IB_EALLOC;
-        goto failed;
-    }
+    name_copy = (char *)((*pf)->val + 1);
     memcpy(name_copy, name, nlen);
     (*pf)->name = (const char *)name_copy;
 
-    (*pf)->val = (ib_field_val_t *)ib_mm_calloc(mm,
-        1, sizeof(*((*pf)->val))
-    );
-    if ((*pf)->val == NULL) {
-        rc = IB_EALLOC;
-        goto failed;
-    }
-
     (*pf)->val->pval = storage_pval;
 
     ib_field_util_log_debug("FIELD_CREATE_ALIAS", (*pf));
@@ -740,6 +745,7 @@ ib_status_t ib_field_setv_no_copy(
     }
 
     *(void **)(f->val->pval) = mutable_in_pval;
+    f->tfn_memo = NULL;
 
     return IB_OK;
 }
@@ -862,6 +868,10 @@ ib_status_t ib_field_setv_ex(
     }
     }
 
+    /* The value changed in place; results memoized against this
+     * field's identity are stale. */
+    f->tfn_memo = NULL;
+
     ib_field_util_log_debug("FIELD_SETV", f);
 
     return IB_OK;
@@ -870,6 +880,45 @@ failed:
     return rc;
 }
 
+/** Copy @a u into @a out_pval according to @a type. */
+static void field_val_copy_out(
+    ib_ftype_t                  type,
+    const ib_field_val_union_t *u,
+    void                       *out_pval
+)
+{
+    switch (type) {
+    case IB_FTYPE_TIME:
+        *(ib_time_t *)out_pval = u->time;
+        break;
+    case IB_FTYPE_NUM:
+        *(ib_num_t *)out_pval = u->num;
+        break;
+    case IB_FTYPE_FLOAT:
+        *(ib_float_t *)out_pval = u->fnum;
+        break;
+    default:
+        *(void **)out_pval = u->ptr;
+        break;
+    }
+}
+
+void ib_field_memoize(
+    ib_field_t     *f,
+    const uint64_t *generation
+)
+{
+    assert(f != NULL);
+
+    if (! ib_field_is_dynamic(f)) {
+        return;
+    }
+
+    f->val->memoize      = true;
+    f->val->memoized     = false;
+    f->val->memo_gen_src = generation;
+}
+
 ib_status_t ib_field_value_ex(
     const ib_field_t *f,
     void             *out_pval,
@@ -881,9 +930,36 @@ ib_status_t ib_field_value_ex(
      * fn_get call to retrieve the value.
      */
     if (ib_field_is_dynamic(f)) {
+        ib_status_t rc;
+
         if (f->val->fn_get == NULL) {
             return IB_EINVAL;
         }
+
+        /* Memoized plain gets run the getter once per generation;
+         * gets with an argument always consult the getter. */
+        if (f->val->memoize && arg == NULL) {
+            if (f->val->memoized &&
+                (f->val->memo_gen_src == NULL ||
+                 *f->val->memo_gen_src == f->val->memo_gen))
+            {
+                field_val_copy_out(f->type, &f->val->memo_u, out_pval);
+                return IB_OK;
+            }
+
+            rc = f->val->fn_get(
+                f, &f->val->memo_u, NULL, 0, f->val->cbdata_get);
+            if (rc != IB_OK) {
+                return rc;
+            }
+            f->val->memoized = true;
+            if (f->val->memo_gen_src != NULL) {
+                f->val->memo_gen = *f->val->memo_gen_src;
+            }
+            field_val_copy_out(f->type, &f->val->memo_u, out_pval);
+            return IB_OK;
+        }
+
         return f->val->fn_get(f, out_pval, arg, alen, f->val->cbdata_get);
     }
 
@@ -974,6 +1050,10 @@ ib_status_t ib_field_mutable_value(
         return IB_ENOENT;
     }
 
+    /* The caller may mutate the value through the returned pointer;
+     * conservatively drop memoized results. */
+    f->tfn_memo = NULL;
+
     switch(f->type) {
         case IB_FTYPE_NUM:
         case IB_FTYPE_FLOAT:
@@ -33,6 +33,10 @@
 #include <string.h>
 #include <time.h>
 
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
+
 /* Internal Declarations */
 
 /**
@@ -56,6 +60,11 @@ typedef struct ib_hash_entry_t ib_hash_entry_t;
 
 /**
  * Entry in a ib_hash_t.
+ *
+ * Entries are stored inline in the slot array (open addressing with
+ * linear probing).  A slot is empty if @c key is NULL and a tombstone --
+ * a removed entry probes must skip over -- if @c key is
+ * @ref c_hash_tombstone.
  **/
 struct ib_hash_entry_t {
     /** Key. */
@@ -64,12 +73,17 @@ struct ib_hash_entry_t {
     size_t               key_length;
     /** Value. */
     void                *value;
-    /** Hash of @c key. */
+    /** Cached hash of @c key; compared before the key itself. */
     uint32_t             hash_value;
-    /** Next entry in slot for @c hash. */
-    ib_hash_entry_t     *next_entry;
 };
 
+/** Sentinel key marking a removed slot.  Only its address is used. */
+static const char c_hash_tombstone[1] = { '\0' };
+
+/** True iff @a entry holds a live key/value pair. */
+#define IB_HASH_ENTRY_LIVE(entry) \
+    ((entry)->key != NULL && (entry)->key != c_hash_tombstone)
+
 /**
  * External iterator for ib_hash_t.
  *
@@ -81,7 +95,7 @@ struct ib_hash_iterator_t {
     const ib_hash_t     *hash;
     /** Current entry. */
     ib_hash_entry_t     *current_entry;
-    /** Next entry. */
+    /** Next live entry, found by scanning ahead. */
     ib_hash_entry_t     *next_entry;
     /** Which slot to look in next. */
     size_t               slot_index;
@@ -103,18 +117,19 @@ struct ib_hash_t {
     /**
      * Slots.
      *
-     * Each slot holds a (possibly empty) linked list of ib_hash_entry_t's,
-     * all of which have the same hash value.
+     * Contiguous array of max_slot+1 entries, probed linearly from the
+     * entry's hash value.  Entries are stored inline; see
+     * @ref ib_hash_entry_t for the empty/tombstone encoding.
      **/
-    ib_hash_entry_t    **slots;
-    /** Maximum slot index. */
+    ib_hash_entry_t     *slots;
+    /** Maximum slot index.  max_slot+1 is a power of 2. */
     size_t               max_slot;
     /** Memory manager. */
     ib_mm_t              mm;
-    /** Linked list of removed hash entries to use for recycling. */
-    ib_hash_entry_t     *free;
-    /** Number of entries. */
+    /** Number of live entries. */
     size_t               size;
+    /** Number of used slots: live entries plus tombstones. */
+    size_t               used;
     /** Randomizer value. */
     uint32_t             randomizer;
 };
@@ -139,22 +154,29 @@ static ib_status_t ib_hash_find_entry(
 );
 
 /**
- * Search for a hash entry in the list of entries starting at @a first.
+ * Probe @a hash for the entry matching @a key.
+ *
+ * Probes linearly from the slot indicated by @a hash_value, comparing the
+ * cached hash value before the key.  Probing ends at the first empty
+ * slot; tombstones are skipped.
  *
- * @param[in] hash       Hash table.
- * @param[in] first      Beginning of list to search.
- * @param[in] key        Key to search for.
- * @param[in] key_length Length of @a key.
- * @param[in] hash_value Hash value of @a key.
+ * @param[in]  hash        Hash table.
+ * @param[in]  key         Key to search for.
+ * @param[in]  key_length  Length of @a key.
+ * @param[in]  hash_value  Hash value of @a key.
+ * @param[out] insert_slot If non-NULL, set to the slot a new entry for
+ *                         @a key should occupy: the first tombstone seen
+ *                         or, failing that, the empty slot that ended the
+ *                         probe.  Only meaningful when NULL is returned.
  *
- * @returns Hash entry if found and NULL otherwise.
+ * @returns Live hash entry if found and NULL otherwise.
  */
-static ib_hash_entry_t *ib_hash_find_htentry(
-     const ib_hash_t *hash,
-     ib_hash_entry_t *first,
-     const char      *key,
-     size_t           key_length,
-     uint32_t         hash_value
+static ib_hash_entry_t *ib_hash_probe(
+     const ib_hash_t  *hash,
+     const char       *key,
+     size_t            key_length,
+     uint32_t          hash_value,
+     ib_hash_entry_t **insert_slot
 );
 
 /**
@@ -203,22 +225,41 @@ static char ib_hash_tolower(
 
 /* Internal Definitions */
 
-ib_hash_entry_t *ib_hash_find_htentry(
-    const ib_hash_t *hash,
-    ib_hash_entry_t *first,
-    const char      *key,
-    size_t           key_length,
-    uint32_t         hash_value
+ib_hash_entry_t *ib_hash_probe(
+    const ib_hash_t  *hash,
+    const char       *key,
+    size_t            key_length,
+    uint32_t          hash_value,
+    ib_hash_entry_t **insert_slot
 ) {
     assert(hash != NULL);
     assert(key  != NULL);
 
+    ib_hash_entry_t *tombstone = NULL;
+
+    /* The load factor guarantees an empty slot exists, so the probe
+     * always terminates. */
     for (
-        ib_hash_entry_t* current_entry = first;
-        current_entry != NULL;
-        current_entry = current_entry->next_entry
+        size_t slot_index = hash_value & hash->max_slot;
+        ;
+        slot_index = (slot_index + 1) & hash->max_slot
     )
     {
+        ib_hash_entry_t *current_entry = &hash->slots[slot_index];
+
+        if (current_entry->key == NULL) {
+            if (insert_slot != NULL) {
+                *insert_slot =
+                    (tombstone != NULL) ? tombstone : current_entry;
+            }
+            return NULL;
+        }
+        if (current_entry->key == c_hash_tombstone) {
+            if (tombstone == NULL) {
+                tombstone = current_entry;
+            }
+            continue;
+        }
         if (
             current_entry->hash_value == hash_value &&
             hash->equal_predicate(
@@ -230,7 +271,6 @@ ib_hash_entry_t *ib_hash_find_htentry(
             return current_entry;
         }
     }
-    return NULL;
 }
 
 ib_status_t ib_hash_find_entry(
@@ -243,7 +283,6 @@ ib_status_t ib_hash_find_entry(
     assert(hash       != NULL);
     assert(key        != NULL);
 
-    ib_hash_entry_t *current_slot  = NULL;
     ib_hash_entry_t *current_entry = NULL;
     uint32_t         hash_value    = 0;
 
@@ -253,14 +292,12 @@ ib_status_t ib_hash_find_entry(
         hash->hash_cbdata
     );
 
-    /* hash->max_slot+1 is a power of 2 */
-    current_slot = hash->slots[hash_value & hash->max_slot];
-    current_entry = ib_hash_find_htentry(
+    current_entry = ib_hash_probe(
         hash,
-        current_slot,
         key,
         key_length,
-        hash_value
+        hash_value,
+        NULL
     );
     if (current_entry == NULL) {
         *hash_entry = NULL;
@@ -322,20 +359,47 @@ void ib_hash_iterator_fetch(
     }
 }
 
+/**
+ * Scan for the next live entry at or after @a *slot_index.
+ *
+ * @param[in]     hash       Hash table to scan.
+ * @param[in,out] slot_index Slot to start at; advanced past the returned
+ *                           entry.
+ *
+ * @returns Next live entry or NULL if none remain.
+ */
+static ib_hash_entry_t *ib_hash_scan(
+    const ib_hash_t *hash,
+    size_t          *slot_index
+) {
+    assert(hash       != NULL);
+    assert(slot_index != NULL);
+
+    while (*slot_index <= hash->max_slot) {
+        ib_hash_entry_t *current_entry = &hash->slots[*slot_index];
+        ++(*slot_index);
+        if (IB_HASH_ENTRY_LIVE(current_entry)) {
+            return current_entry;
+        }
+    }
+    return NULL;
+}
+
 void ib_hash_iterator_next(
     ib_hash_iterator_t *iterator
 ) {
     assert(iterator != NULL);
 
     iterator->current_entry = iterator->next_entry;
-    while (! iterator->current_entry) {
-        if (iterator->slot_index > iterator->hash->max_slot) {
+    if (iterator->current_entry == NULL) {
+        iterator->current_entry =
+            ib_hash_scan(iterator->hash, &iterator->slot_index);
+        if (iterator->current_entry == NULL) {
             return;
         }
-        iterator->current_entry = iterator->hash->slots[iterator->slot_index];
-        ++iterator->slot_index;
     }
-    iterator->next_entry = iterator->current_entry->next_entry;
+    iterator->next_entry =
+        ib_hash_scan(iterator->hash, &iterator->slot_index);
 }
 
 void ib_hash_iterator_copy(
@@ -364,13 +428,12 @@ ib_status_t ib_hash_resize_slots(
 ) {
     assert(hash != NULL);
 
-    ib_hash_entry_t    **new_slots     = NULL;
-    size_t               new_max_slot = 0;
-    ib_hash_iterator_t   i;
+    ib_hash_entry_t *new_slots    = NULL;
+    size_t           new_max_slot = 0;
 
-    /* Maintain power of 2 slots */
+    /* Maintain power of 2 slots.  Tombstones are dropped on the way. */
     new_max_slot = 2 * hash->max_slot + 1;
-    new_slots = (ib_hash_entry_t **)ib_mm_calloc(
+    new_slots = (ib_hash_entry_t *)ib_mm_calloc(
         hash->mm,
         new_max_slot + 1,
         sizeof(*new_slots)
@@ -379,14 +442,28 @@ ib_status_t ib_hash_resize_slots(
         return IB_EALLOC;
     }
 
-    IB_HASH_LOOP(i, hash) {
-        size_t j =
-            i.current_entry->hash_value & new_max_slot;
-        i.current_entry->next_entry = new_slots[j];
-        new_slots[j] = i.current_entry;
+    for (size_t i = 0; i <= hash->max_slot; ++i) {
+        const ib_hash_entry_t *old_entry = &hash->slots[i];
+        size_t j;
+
+        if (! IB_HASH_ENTRY_LIVE(old_entry)) {
+            continue;
+        }
+
+        /* Probe for the first empty slot; the new table is at most half
+         * full, so one always exists. */
+        for (
+            j = old_entry->hash_value & new_max_slot;
+            new_slots[j].key != NULL;
+            j = (j + 1) & new_max_slot
+        ) {
+            /* nop */
+        }
+        new_slots[j] = *old_entry;
     }
     hash->max_slot = new_max_slot;
-    hash->slots     = new_slots;
+    hash->slots    = new_slots;
+    hash->used     = hash->size;
 
     return IB_OK;
 }
@@ -472,6 +549,95 @@ uint32_t ib_hashfunc_djb2_nocase(
     return hash;
 }
 
+#ifdef __SSE4_2__
+
+/**
+ * Lowercase the ASCII uppercase bytes of @a octets, SWAR style.
+ *
+ * Equivalent to applying ib_hash_tolower() to each byte: only bytes in
+ * the range 'A'-'Z' are changed; high-bit bytes pass through untouched.
+ *
+ * @param[in] octets Eight bytes of key material.
+ * @return @a octets with ASCII uppercase bytes lowercased.
+ */
+static inline uint64_t ib_hash_tolower8(uint64_t octets)
+{
+    /* bit 7 of is_ge_A is set for bytes >= 'A' (ignoring bit 7),
+     * bit 7 of is_gt_Z is set for bytes >  'Z' (ignoring bit 7). */
+    uint64_t heptets = octets & UINT64_C(0x7f7f7f7f7f7f7f7f);
+    uint64_t is_ge_A = heptets + UINT64_C(0x3f3f3f3f3f3f3f3f);
+    uint64_t is_gt_Z = heptets + UINT64_C(0x2525252525252525);
+    uint64_t is_upper =
+        (is_ge_A & ~is_gt_Z & ~octets) & UINT64_C(0x8080808080808080);
+
+    /* 0x80 >> 2 == 0x20, the ASCII case bit. */
+    return octets | (is_upper >> 2);
+}
+
+#endif /* __SSE4_2__ */
+
+uint32_t ib_hashfunc_crc32(
+    const char *key,
+    size_t      key_length,
+    uint32_t    randomizer,
+    void       *cbdata
+) {
+    assert(key != NULL);
+
+#ifdef __SSE4_2__
+    uint32_t    hash = randomizer;
+    const char *p    = key;
+
+    while (key_length >= 8) {
+        uint64_t octets;
+        memcpy(&octets, p, 8);
+        hash = (uint32_t)_mm_crc32_u64(hash, octets);
+        p          += 8;
+        key_length -= 8;
+    }
+    while (key_length > 0) {
+        hash = _mm_crc32_u8(hash, (uint8_t)*p);
+        ++p;
+        --key_length;
+    }
+
+    return hash;
+#else
+    return ib_hashfunc_djb2(key, key_length, randomizer, cbdata);
+#endif
+}
+
+uint32_t ib_hashfunc_crc32_nocase(
+    const char *key,
+    size_t      key_length,
+    uint32_t    randomizer,
+    void       *cbdata
+) {
+    assert(key != NULL);
+
+#ifdef __SSE4_2__
+    uint32_t    hash = randomizer;
+    const char *p    = key;
+
+    while (key_length >= 8) {
+        uint64_t octets;
+        memcpy(&octets, p, 8);
+        hash = (uint32_t)_mm_crc32_u64(hash, ib_hash_tolower8(octets));
+        p          += 8;
+        key_length -= 8;
+    }
+    while (key_length > 0) {
+        hash = _mm_crc32_u8(hash, (uint8_t)ib_hash_tolower(*p));
+        ++p;
+        --key_length;
+    }
+
+    return hash;
+#else
+    return ib_hashfunc_djb2_nocase(key, key_length, randomizer, cbdata);
+#endif
+}
+
 int ib_hashequal_default(
     const char *a,
     size_t      a_length,
@@ -547,9 +713,9 @@ ib_status_t ib_hash_create_ex(
         return IB_EALLOC;
     }
 
-    ib_hash_entry_t **slots = (ib_hash_entry_t **)ib_mm_calloc(
+    ib_hash_entry_t *slots = (ib_hash_entry_t *)ib_mm_calloc(
         mm,
-        size + 1,
+        size,
         sizeof(*slots)
     );
     if (slots == NULL) {
@@ -564,8 +730,8 @@ ib_status_t ib_hash_create_ex(
     new_hash->max_slot        = size-1;
     new_hash->slots           = slots;
     new_hash->mm              = mm;
-    new_hash->free            = NULL;
     new_hash->size            = 0;
+    new_hash->used            = 0;
     new_hash->randomizer      = (uint32_t)clock();
 
     *hash = new_hash;
@@ -583,7 +749,7 @@ ib_status_t ib_hash_create(
         hash,
         mm,
         IB_HASH_INITIAL_SIZE,
-        ib_hashfunc_djb2, NULL,
+        ib_hashfunc_crc32, NULL,
         ib_hashequal_default, NULL
     );
 }
@@ -598,7 +764,7 @@ ib_status_t ib_hash_create_nocase(
         hash,
         mm,
         IB_HASH_INITIAL_SIZE,
-        ib_hashfunc_djb2_nocase, NULL,
+        ib_hashfunc_crc32_nocase, NULL,
         ib_hashequal_nocase, NULL
     );
 }
@@ -705,92 +871,56 @@ ib_status_t ib_hash_set_ex(
     assert(hash != NULL);
     assert(key  != NULL);
 
-    uint32_t     hash_value = 0;
-    size_t       slot_index = 0;
-    int          found      = 0;
-
-    ib_hash_entry_t  *current_entry         = NULL;
-    /* Points to pointer that points to current_entry */
-    ib_hash_entry_t **current_entry_handle  = NULL;
+    uint32_t         hash_value    = 0;
+    ib_hash_entry_t *current_entry = NULL;
+    ib_hash_entry_t *insert_slot   = NULL;
 
     hash_value = hash->hash_function(
         key, key_length,
         hash->randomizer,
         hash->hash_cbdata
     );
-    slot_index = (hash_value & hash->max_slot);
 
-    current_entry_handle = &hash->slots[slot_index];
-
-    while (*current_entry_handle != NULL) {
-        current_entry = *current_entry_handle;
-        if (
-            current_entry->hash_value == hash_value &&
-            hash->equal_predicate(
-               current_entry->key, current_entry->key_length,
-               key,                key_length,
-               hash->equal_cbdata
-            )
-        ) {
-            found = 1;
-            break;
-        }
-        current_entry_handle = &(current_entry->next_entry);
-    }
-    /* current_entry is now the entry to change, and current_entry_handler
-     * points to the pointer to it.
-     */
-    if (found) {
-        assert(current_entry != NULL);
-        assert(current_entry == *current_entry_handle);
+    current_entry = ib_hash_probe(
+        hash,
+        key, key_length,
+        hash_value,
+        &insert_slot
+    );
 
+    if (current_entry != NULL) {
         /* Update. */
         current_entry->value = value;
 
         /* Delete if appropriate. */
         if (value == NULL) {
-            /* Delete */
+            /* Leave a tombstone so later probes keep scanning; the slot
+             * stays counted in used until the next resize. */
+            current_entry->key        = c_hash_tombstone;
+            current_entry->key_length = 0;
             --hash->size;
-
-            /* Remove from slot list. */
-            *current_entry_handle = current_entry->next_entry;
-
-            /* Add to free list. */
-            current_entry->next_entry = hash->free;
-            hash->free                = current_entry;
         }
     }
     else {
-        /* It's not in the list. Add it if value != NULL. */
+        /* It's not in the table. Add it if value != NULL. */
         if (value != NULL) {
-            ib_hash_entry_t *entry = NULL;
+            assert(insert_slot != NULL);
 
-            if (hash->free != NULL) {
-                entry = hash->free;
-                hash->free = entry->next_entry;
-            }
-            else {
-                entry = (ib_hash_entry_t *)ib_mm_alloc(
-                    hash->mm,
-                    sizeof(*entry)
-                );
-                if (entry == NULL) {
-                    return IB_EALLOC;
-                }
+            if (insert_slot->key == NULL) {
+                ++hash->used;
             }
+            /* Else recycling a tombstone; used is unchanged. */
 
-            entry->hash_value = hash_value;
-            entry->key        = key;
-            entry->key_length = key_length;
-            entry->value      = value;
-            entry->next_entry = hash->slots[slot_index];
-
-            hash->slots[slot_index] = entry;
+            insert_slot->hash_value = hash_value;
+            insert_slot->key        = key;
+            insert_slot->key_length = key_length;
+            insert_slot->value      = value;
 
             ++hash->size;
 
-            /* If we have more elements that slots, resize. */
-            if (hash->size > hash->max_slot+1) {
+            /* Keep the load factor, live entries plus tombstones, at or
+             * below 3/4 so probes stay short and always terminate. */
+            if (4 * hash->used > 3 * (hash->max_slot + 1)) {
                 return ib_hash_resize_slots(hash);
             }
         }
@@ -819,23 +949,13 @@ ib_status_t ib_hash_set(
 void ib_hash_clear(ib_hash_t *hash) {
     assert(hash != NULL);
 
-    for (size_t i = 0; i <= hash->max_slot; ++i) {
-        if (hash->slots[i] != NULL) {
-            ib_hash_entry_t *current_entry;
-            for (
-                current_entry = hash->slots[i];
-                current_entry->next_entry != NULL;
-                current_entry = current_entry->next_entry
-            ) {
-                current_entry->value = NULL;
-            }
-
-            current_entry->next_entry = hash->free;
-            hash->free                = hash->slots[i];
-            hash->slots[i]            = NULL;
-        }
-    }
+    memset(
+        hash->slots,
+        0,
+        (hash->max_slot + 1) * sizeof(*hash->slots)
+    );
     hash->size = 0;
+    hash->used = 0;
 
     return;
 }
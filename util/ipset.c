@@ -32,11 +32,6 @@
 #include <stdbool.h>
 #include <stdlib.h>
 
-/**
- * Helper typedef of a stdlib compare function.
- */
-typedef int (*ib_ipset_compare_fn)(const void *, const void *);
-
 /**
  * The mask \f$1^{bits}0^{32-bits}\f$.
  *
@@ -93,57 +88,6 @@ ib_ip6_t ib_ipset6_canonical(
     return ip;
 }
 
-/**
- * True iff @a a_net is a prefix of @a b_net (v4 version).
- *
- * @param[in] a_net Network to check if prefix.
- * @param[in] b_net Network to check if prefix of.
- * @return true iff @a a_net is a prefix of @a b_net.
- */
-static
-bool ib_ipset4_is_prefix(
-    ib_ip4_network_t a_net,
-    ib_ip4_network_t b_net
-)
-{
-    /* Note that use of a_net.size on both sides is correct. */
-    return
-        a_net.size <= b_net.size &&
-        (
-            (b_net.ip & ib_ipset4_mask(a_net.size)) ==
-            (a_net.ip & ib_ipset4_mask(a_net.size))
-        )
-        ;
-}
-
-/**
- * True iff @a a_net is a prefix of @a b_net (v6 version).
- *
- * @param[in] a_net Network to check if prefix.
- * @param[in] b_net Network to check if prefix of.
- * @return true iff @a a_net is a prefix of @a b_net.
- */
-static
-bool ib_ipset6_is_prefix(
-    const ib_ip6_network_t a_net,
-    const ib_ip6_network_t b_net
-)
-{
-    size_t initial_bytes  = a_net.size / 32;
-    size_t remaining_bits = a_net.size % 32;
-
-    for (size_t i = 0; i < initial_bytes; ++i) {
-        if (a_net.ip.ip[i] != b_net.ip.ip[i]) {
-            return false;
-        }
-    }
-
-    return
-        (a_net.ip.ip[initial_bytes] & ib_ipset4_mask(remaining_bits)) ==
-        (b_net.ip.ip[initial_bytes] & ib_ipset4_mask(remaining_bits))
-        ;
-}
-
 /**
  * Comparison function for ib_ip4_network_t (strict).
  *
@@ -177,7 +121,7 @@ int ib_ipset4_compare_strict(
             return -1;
         }
         if (a_net->size > b_net->size) {
-            return -1;
+            return 1;
         }
         return 0;
     }
@@ -188,45 +132,6 @@ int ib_ipset4_compare_strict(
     return 1;
 }
 
-/**
- * Comparison function for ib_ip4_network_t.
- *
- * This function is as ib_ipset4_compare_strict() except that it considers
- * elements to be equal if either is a prefix of the other.
- *
- * Assumes @a a and @a b are pointers to ib_ip4_network_t in canonical
- * form.
- *
- * @param[in] a LHS.
- * @param[in] b RHS.
- * @return
- * - 0  -- Same address and mask, or @a a is a prefix of @a b, or @a b is a
- *         prefix of @a a.
- * - -1 -- @a a has earlier address or same address and shorter length.
- * - 1  -- @a a has later address or same address and longer length.
- */
-static
-int ib_ipset4_compare(
-    const void *a,
-    const void *b
-)
-{
-    const ib_ip4_network_t *a_net = (const ib_ip4_network_t *)a;
-    const ib_ip4_network_t *b_net = (const ib_ip4_network_t *)b;
-
-    assert(a_net->ip == ib_ipset4_canonical(*a_net));
-    assert(b_net->ip == ib_ipset4_canonical(*b_net));
-
-    if (
-        ib_ipset4_is_prefix(*a_net, *b_net) ||
-        ib_ipset4_is_prefix(*b_net, *a_net)
-    ) {
-        return 0;
-    }
-
-    return ib_ipset4_compare_strict(a, b);
-}
-
 /**
  * Comparison function for ib_ip6_network_t (strict).
  *
@@ -272,257 +177,243 @@ int ib_ipset6_compare_strict(
     return 0;
 }
 
+/* Public API */
+
 /**
- * Comparison function for ib_ip6_network_t.
+ * Find the entry for exactly the network (@a ip masked to @a length,
+ * @a length), if present.
  *
- * This function is as ib_ipset6_compare_strict() except that it considers
- * elements to be equal if either is a prefix of the other.
+ * The entries are sorted by (address, size), so each (network, length)
+ * pair occupies a unique position found by plain binary search with the
+ * comparison inlined.  Querying per prefix length this way resolves
+ * longest-prefix matches exactly in all configurations, including
+ * overlapping sibling networks, which a single comparator-based search
+ * over interleaved lengths can miss.
  *
- * Assumes @a a and @a b are pointers to ib_ip6_network_t in canonical
- * form.
+ * A pointer-based trie was considered but the init API hands over caller
+ * arrays with no memory manager to allocate nodes from; a per-length
+ * search over the existing sorted array provides the same matching
+ * semantics within that contract.
  *
- * @sa ib_ipset6_compare()
+ * @param[in] ip          Address to search for.
+ * @param[in] length      Prefix length to search at.
+ * @param[in] entries     Sorted entries to search.
+ * @param[in] num_entries Number of entries in @a entries.
  *
- * @param[in] a LHS.
- * @param[in] b RHS.
- * @return
- * - 0  -- Same address and mask, or @a a is a prefix of @a b, or @a b is a
- *         prefix of @a a.
- * - -1 -- @a a has earlier address or same address and shorter length.
- * - 1  -- @a a has later address or same address and longer length.
+ * @returns The entry of that exact network and length or NULL.
  */
-static
-int ib_ipset6_compare(
-    const void *a,
-    const void *b
+static const ib_ipset4_entry_t *ib_ipset4_find_at(
+    ib_ip4_t                 ip,
+    size_t                   length,
+    const ib_ipset4_entry_t *entries,
+    size_t                   num_entries
 )
 {
-    const ib_ip6_network_t *a_net = (const ib_ip6_network_t *)a;
-    const ib_ip6_network_t *b_net = (const ib_ip6_network_t *)b;
-
-    if (
-        ib_ipset6_is_prefix(*a_net, *b_net) ||
-        ib_ipset6_is_prefix(*b_net, *a_net)
-    ) {
-        return 0;
+    ib_ip4_t target = ip & ib_ipset4_mask(length);
+    size_t   lo     = 0;
+    size_t   hi     = num_entries;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const ib_ipset4_entry_t *entry = &entries[mid];
+
+        if (entry->network.ip == target) {
+            if (entry->network.size == length) {
+                return entry;
+            }
+            if (entry->network.size < length) {
+                lo = mid + 1;
+            }
+            else {
+                hi = mid;
+            }
+        }
+        else if (entry->network.ip < target) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
     }
 
-    return ib_ipset6_compare_strict(a, b);
+    return NULL;
 }
 
-/**
- * Generic query routine for an entry of entries.
- *
- * This is a generic function intended for searching for v4 and v6 arrays of
- * entries for a specific entry.
- *
- * @param[in]  net         Pointer to a network describing a single IP,
- *                         i.e., size is max.  Note: This is not validated.
- * @param[in]  entries     Entries to search.
- * @param[in]  num_entries Number of entries in @a entries.
- * @param[in]  entry_size  Size of each entry and of @a net.
- * @param[in]  compare     Comparison function to use.
- * @param[out] out_entry   Output variable for a matching entry, if found.
- *                         May be NULL.
- *
- * @return
- * - IB_OK if an entry is found.
- * - IB_ENOENT if an entry is not found.
- * - IB_EINVAL if @a net is NULL, or @a entries is NULL with
- *   @a num_entries > 0, or @a entry_size is 0, or @a compare is NULL.
- */
-static
-ib_status_t ib_ipset_set_query(
-    const void           *net,
-    const void           *entries,
-    size_t                num_entries,
-    size_t                entry_size,
-    ib_ipset_compare_fn   compare,
-    const void          **out_entry
+ib_status_t ib_ipset4_query(
+    const ib_ipset4_t        *set,
+    ib_ip4_t                  ip,
+    const ib_ipset4_entry_t **out_entry,
+    const ib_ipset4_entry_t **out_specific_entry,
+    const ib_ipset4_entry_t **out_general_entry
 )
 {
+    const ib_ipset4_entry_t *specific = NULL;
+    const ib_ipset4_entry_t *general  = NULL;
+
     if (out_entry != NULL) {
         *out_entry = NULL;
     }
+    if (out_specific_entry != NULL) {
+        *out_specific_entry = NULL;
+    }
+    if (out_general_entry != NULL) {
+        *out_general_entry = NULL;
+    }
 
-    if (
-        net == NULL ||
-        compare == NULL ||
-        (entries == NULL && num_entries > 0) ||
-        (entry_size == 0)
-    ) {
+    if (set == NULL) {
         return IB_EINVAL;
     }
 
-    if (num_entries == 0) {
+    /* A negative match at any length excludes the address. */
+    if (set->num_negative > 0) {
+        for (size_t length = 0; length <= 32; ++length) {
+            if ((set->negative_lengths & ((uint64_t)1 << length)) == 0) {
+                continue;
+            }
+            if (ib_ipset4_find_at(
+                    ip, length,
+                    set->negative, set->num_negative) != NULL)
+            {
+                return IB_ENOENT;
+            }
+        }
+    }
+
+    if (set->num_positive == 0) {
         return IB_ENOENT;
     }
 
-    void *result = bsearch(
-        net,
-        entries,
-        num_entries,
-        entry_size,
-        compare
-    );
+    /* Longest prefix first; the last hit is the most general. */
+    for (int length = 32; length >= 0; --length) {
+        const ib_ipset4_entry_t *entry;
 
-    if (result == NULL) {
+        if ((set->positive_lengths & ((uint64_t)1 << length)) == 0) {
+            continue;
+        }
+        entry = ib_ipset4_find_at(
+            ip, length,
+            set->positive, set->num_positive
+        );
+        if (entry != NULL) {
+            if (specific == NULL) {
+                specific = entry;
+                if (out_general_entry == NULL) {
+                    break;
+                }
+            }
+            general = entry;
+        }
+    }
+
+    if (specific == NULL) {
         return IB_ENOENT;
     }
+
     if (out_entry != NULL) {
-        *out_entry = result;
+        *out_entry = specific;
+    }
+    if (out_specific_entry != NULL) {
+        *out_specific_entry = specific;
+    }
+    if (out_general_entry != NULL) {
+        *out_general_entry = general;
     }
 
     return IB_OK;
 }
 
 /**
- * Generic query routine for an IP Set.
+ * Return @a ip masked to @a size bits (v6 version).
  *
- * This takes an IP Set, either v4 or v6, and looks for an entry, and
- * optionally, the most specific and general entries.
+ * @param[in] ip   Address to mask.
+ * @param[in] size Number of prefix bits to keep.
  *
- * @param[in]  network               Pointer to a network describing a single
- *                                   IP, i.e., size is max.  Note: This is
- *                                   not validated.
- * @param[in]  negative              Negative networks to search.
- * @param[in]  num_negative          Number of entries in @a negative.
- * @param[in]  positive              Positive networks to search.
- * @param[in]  num_positive          Number of entries in @a positive.
- * @param[in]  entry_size            Size of each entry and of @a net.
- * @param[in]  compare               Comparison function to use.
- * @param[out] out_entry             Output variable for a matching entry, if
- *                                   found.  May be NULL.
- * @param[out] out_specific_entry    Output variable for most specific
- *                                   matching entry, if found.  May be NULL.
- * @param[out] out_general_entry     Output variable for most general
- *                                   matching entry, if found.  May be NULL.
- * @return
- * - IB_OK if an entry is found.
- * - IB_ENOENT if an entry is not found.
- * - IB_EINVAL if @a net is NULL, or @a negative is NULL with
- *   @a num_negative > 0, or same for positive entries, or @a entry_size is 0,
- *   or @a compare is NULL.
+ * @returns The masked address.
  */
-static
-ib_status_t ib_ipset_query(
-    const void          *network,
-    const void          *negative,
-    size_t               num_negative,
-    const void          *positive,
-    size_t               num_positive,
-    size_t               entry_size,
-    ib_ipset_compare_fn  compare,
-    const void          *out_entry,
-    const void          *out_specific_entry,
-    const void          *out_general_entry
-)
+static ib_ip6_t ib_ipset6_masked(ib_ip6_t ip, size_t size)
 {
-    const void *entry = NULL;
-
-    if (out_entry != NULL) {
-        *(const void **)out_entry = NULL;
-    }
-    if (out_specific_entry != NULL) {
-        *(const void **)out_specific_entry = NULL;
-    }
-    if (out_general_entry != NULL) {
-        *(const void **)out_general_entry = NULL;
-    }
+    ib_ip6_t r;
+    size_t   initial_words  = size / 32;
+    size_t   remaining_bits = size % 32;
 
-    if (
-        network == NULL ||
-        compare == NULL ||
-        (negative == NULL && num_negative > 0) ||
-        (positive == NULL && num_positive > 0) ||
-        (entry_size == 0)
-    ) {
-        return IB_EINVAL;
+    for (size_t i = 0; i < 4; ++i) {
+        r.ip[i] = (i < initial_words) ? ip.ip[i] : 0;
     }
-
-    ib_status_t rc = ib_ipset_set_query(
-        network,
-        negative,
-        num_negative,
-        entry_size,
-        compare,
-        NULL
-    );
-    if (rc != IB_ENOENT) {
-        return IB_ENOENT;
+    if (remaining_bits > 0 && initial_words < 4) {
+        r.ip[initial_words] =
+            ip.ip[initial_words] & ib_ipset4_mask(remaining_bits);
     }
 
-    rc = ib_ipset_set_query(
-        network,
-        positive,
-        num_positive,
-        entry_size,
-        compare,
-        &entry
-    );
+    return r;
+}
 
-    if (rc != IB_OK) {
-        return rc;
-    }
-    if (out_entry != NULL) {
-        *(const void **)out_entry = entry;
-    }
-    if (out_specific_entry != NULL) {
-        *(const void **)out_specific_entry = entry;
-        while (
-            *(char **)out_specific_entry <
-                ((char *)positive + entry_size * (num_positive - 1)) &&
-            compare((*(char **)out_specific_entry + entry_size), network) == 0
-        )
-        {
-            *(const void **)out_specific_entry =
-                *(char **)out_specific_entry + entry_size;
+/**
+ * Compare two v6 addresses word by word.
+ *
+ * @param[in] a LHS.
+ * @param[in] b RHS.
+ *
+ * @returns -1, 0 or 1.
+ */
+static int ib_ipset6_ip_compare(const ib_ip6_t *a, const ib_ip6_t *b)
+{
+    for (int i = 0; i < 4; ++i) {
+        if (a->ip[i] < b->ip[i]) {
+            return -1;
         }
-    }
-
-    if (out_general_entry != NULL) {
-        *(const void **)out_general_entry = entry;
-        while (
-            *(const void **)out_general_entry > positive &&
-            compare((*(char **)out_general_entry - entry_size), network) == 0
-        )
-        {
-            *(const void **)out_general_entry =
-                *(char **)out_general_entry - entry_size;
+        if (a->ip[i] > b->ip[i]) {
+            return 1;
         }
     }
-
-    return IB_OK;
+    return 0;
 }
 
-/* Public API */
-
-ib_status_t ib_ipset4_query(
-    const ib_ipset4_t        *set,
-    ib_ip4_t                  ip,
-    const ib_ipset4_entry_t **out_entry,
-    const ib_ipset4_entry_t **out_specific_entry,
-    const ib_ipset4_entry_t **out_general_entry
+/**
+ * As ib_ipset4_find_at() but for v6 entries.
+ *
+ * @param[in] ip          Address to search for.
+ * @param[in] length      Prefix length to search at.
+ * @param[in] entries     Sorted entries to search.
+ * @param[in] num_entries Number of entries in @a entries.
+ *
+ * @returns The entry of that exact network and length or NULL.
+ */
+static const ib_ipset6_entry_t *ib_ipset6_find_at(
+    const ib_ip6_t          *ip,
+    size_t                   length,
+    const ib_ipset6_entry_t *entries,
+    size_t                   num_entries
 )
 {
-    ib_ip4_network_t net = {ip, 32};
-
-    if (set == NULL) {
-        return IB_EINVAL;
+    ib_ip6_t target = ib_ipset6_masked(*ip, length);
+    size_t   lo     = 0;
+    size_t   hi     = num_entries;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const ib_ipset6_entry_t *entry = &entries[mid];
+        int cmp = ib_ipset6_ip_compare(&entry->network.ip, &target);
+
+        if (cmp == 0) {
+            if (entry->network.size == length) {
+                return entry;
+            }
+            if (entry->network.size < length) {
+                lo = mid + 1;
+            }
+            else {
+                hi = mid;
+            }
+        }
+        else if (cmp < 0) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
     }
 
-    return ib_ipset_query(
-        &net,
-        set->negative,
-        set->num_negative,
-        set->positive,
-        set->num_positive,
-        sizeof(ib_ipset4_entry_t),
-        &ib_ipset4_compare,
-        out_entry,
-        out_specific_entry,
-        out_general_entry
-    );
+    return NULL;
 }
 
 ib_status_t ib_ipset6_query(
@@ -533,24 +424,83 @@ ib_status_t ib_ipset6_query(
     const ib_ipset6_entry_t **out_general_entry
 )
 {
-    ib_ip6_network_t net = {ip, 128};
+    const ib_ipset6_entry_t *specific = NULL;
+    const ib_ipset6_entry_t *general  = NULL;
+
+    if (out_entry != NULL) {
+        *out_entry = NULL;
+    }
+    if (out_specific_entry != NULL) {
+        *out_specific_entry = NULL;
+    }
+    if (out_general_entry != NULL) {
+        *out_general_entry = NULL;
+    }
 
     if (set == NULL) {
         return IB_EINVAL;
     }
 
-    return ib_ipset_query(
-        &net,
-        set->negative,
-        set->num_negative,
-        set->positive,
-        set->num_positive,
-        sizeof(ib_ipset6_entry_t),
-        &ib_ipset6_compare,
-        out_entry,
-        out_specific_entry,
-        out_general_entry
-    );
+    /* A negative match at any length excludes the address. */
+    if (set->num_negative > 0) {
+        for (size_t length = 0; length <= 128; ++length) {
+            if ((set->negative_lengths[length / 64] &
+                 ((uint64_t)1 << (length % 64))) == 0)
+            {
+                continue;
+            }
+            if (ib_ipset6_find_at(
+                    &ip, length,
+                    set->negative, set->num_negative) != NULL)
+            {
+                return IB_ENOENT;
+            }
+        }
+    }
+
+    if (set->num_positive == 0) {
+        return IB_ENOENT;
+    }
+
+    /* Longest prefix first; the last hit is the most general. */
+    for (int length = 128; length >= 0; --length) {
+        const ib_ipset6_entry_t *entry;
+
+        if ((set->positive_lengths[length / 64] &
+             ((uint64_t)1 << (length % 64))) == 0)
+        {
+            continue;
+        }
+        entry = ib_ipset6_find_at(
+            &ip, length,
+            set->positive, set->num_positive
+        );
+        if (entry != NULL) {
+            if (specific == NULL) {
+                specific = entry;
+                if (out_general_entry == NULL) {
+                    break;
+                }
+            }
+            general = entry;
+        }
+    }
+
+    if (specific == NULL) {
+        return IB_ENOENT;
+    }
+
+    if (out_entry != NULL) {
+        *out_entry = specific;
+    }
+    if (out_specific_entry != NULL) {
+        *out_specific_entry = specific;
+    }
+    if (out_general_entry != NULL) {
+        *out_general_entry = general;
+    }
+
+    return IB_OK;
 }
 
 ib_status_t ib_ipset4_init(
@@ -574,13 +524,20 @@ ib_status_t ib_ipset4_init(
     set->positive     = positive;
     set->num_positive = num_positive;
 
+    set->negative_lengths = 0;
+    set->positive_lengths = 0;
+
     for (size_t i = 0; i < set->num_negative; ++i) {
         set->negative[i].network.ip =
              ib_ipset4_canonical(set->negative[i].network);
+        set->negative_lengths |=
+            (uint64_t)1 << set->negative[i].network.size;
     }
     for (size_t i = 0; i < set->num_positive; ++i) {
         set->positive[i].network.ip =
              ib_ipset4_canonical(set->positive[i].network);
+        set->positive_lengths |=
+            (uint64_t)1 << set->positive[i].network.size;
     }
 
     if (set->negative != NULL) {
@@ -621,13 +578,24 @@ ib_status_t ib_ipset6_init(
     set->positive     = positive;
     set->num_positive = num_positive;
 
+    set->negative_lengths[0] = 0;
+    set->negative_lengths[1] = 0;
+    set->negative_lengths[2] = 0;
+    set->positive_lengths[0] = 0;
+    set->positive_lengths[1] = 0;
+    set->positive_lengths[2] = 0;
+
     for (size_t i = 0; i < set->num_negative; ++i) {
+        size_t size = set->negative[i].network.size;
         set->negative[i].network.ip =
              ib_ipset6_canonical(set->negative[i].network);
+        set->negative_lengths[size / 64] |= (uint64_t)1 << (size % 64);
     }
     for (size_t i = 0; i < set->num_positive; ++i) {
+        size_t size = set->positive[i].network.size;
         set->positive[i].network.ip =
              ib_ipset6_canonical(set->positive[i].network);
+        set->positive_lengths[size / 64] |= (uint64_t)1 << (size % 64);
     }
 
     if (set->negative != NULL) {
@@ -646,3 +614,51 @@ ib_status_t ib_ipset6_init(
 
     return IB_OK;
 }
+
+const ib_ipset4_t *ib_ipset4_swap_get(
+    const ib_ipset4_swap_t *swap
+)
+{
+    assert(swap != NULL);
+
+    return swap->current;
+}
+
+const ib_ipset4_t *ib_ipset4_swap_set(
+    ib_ipset4_swap_t  *swap,
+    const ib_ipset4_t *set
+)
+{
+    assert(swap != NULL);
+
+    /* Publish with release semantics: the set's contents must be
+     * visible before the pointer is. */
+    const ib_ipset4_t *previous = swap->current;
+    __sync_synchronize();
+    swap->current = set;
+
+    return previous;
+}
+
+const ib_ipset6_t *ib_ipset6_swap_get(
+    const ib_ipset6_swap_t *swap
+)
+{
+    assert(swap != NULL);
+
+    return swap->current;
+}
+
+const ib_ipset6_t *ib_ipset6_swap_set(
+    ib_ipset6_swap_t  *swap,
+    const ib_ipset6_t *set
+)
+{
+    assert(swap != NULL);
+
+    const ib_ipset6_t *previous = swap->current;
+    __sync_synchronize();
+    swap->current = set;
+
+    return previous;
+}
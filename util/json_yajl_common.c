@@ -50,9 +50,8 @@ void *json_yajl_alloc(
 {
     json_yajl_alloc_context_t *alloc_ctx = (json_yajl_alloc_context_t *)ctx;
     chunk_t *chunk;
-    size_t alloc = size + sizeof(*chunk);
 
-    chunk = (chunk_t *)ib_mm_alloc(alloc_ctx->mm, size + alloc);
+    chunk = (chunk_t *)ib_mm_alloc(alloc_ctx->mm, size + sizeof(*chunk));
     if (chunk == NULL) {
         alloc_ctx->status = IB_EALLOC;
         return NULL;
@@ -81,6 +80,12 @@ void *json_yajl_realloc(
         return chunk->data;
     }
 
+    /* The old chunk is abandoned in the pool, so grow geometrically to
+     * bound the total waste at roughly twice the final size. */
+    if (size < 2 * chunk->size) {
+        size = 2 * chunk->size;
+    }
+
     bytes = size + sizeof(*chunk);
     new = (chunk_t *)ib_mm_alloc(alloc_ctx->mm, bytes);
     if (new == NULL) {
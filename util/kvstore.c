@@ -124,6 +124,7 @@ ib_status_t ib_kvstore_init(ib_kvstore_t *kvstore)
     kvstore->malloc = &kvstore_malloc;
     kvstore->free = &kvstore_free;
     kvstore->default_merge_policy = &default_merge_policy;
+    kvstore->wb_enabled = false;
 
     return IB_OK;
 }
@@ -136,9 +137,16 @@ ib_status_t ib_kvstore_connect(ib_kvstore_t *kvstore) {
     return rc;
 }
 
+//! Stop the write-behind flusher, draining the queue first.
+static void kvstore_wb_stop(ib_kvstore_t *kvstore);
+
 ib_status_t ib_kvstore_disconnect(ib_kvstore_t *kvstore) {
     assert(kvstore != NULL);
 
+    /* Drain pending write-behind work before the backend goes away.
+     * Write-behind must be re-enabled after a reconnect. */
+    kvstore_wb_stop(kvstore);
+
     ib_status_t rc = kvstore->disconnect(kvstore, kvstore->disconnect_cbdata);
 
     return rc;
@@ -217,6 +225,210 @@ exit_get:
     return rc;
 }
 
+/**
+ * A queued write-behind entry.
+ *
+ * The entry's pool owns the key and value copies; destroying the pool
+ * releases the whole entry's data.
+ */
+struct kvstore_wb_entry_t {
+    kvstore_wb_entry_t           *next;         /**< Next (newer) entry. */
+    ib_mpool_lite_t              *mp;           /**< Owns key and value. */
+    ib_kvstore_key_t             *key;          /**< Key copy. */
+    ib_kvstore_value_t           *value;        /**< Value copy. */
+    ib_kvstore_merge_policy_fn_t  merge_policy; /**< Policy for the set. */
+};
+
+/**
+ * Write one queued entry to the backend and release it.
+ *
+ * @param[in] kvstore Store to write to.
+ * @param[in] entry Entry to write; destroyed here.
+ */
+static void kvstore_wb_write(ib_kvstore_t *kvstore, kvstore_wb_entry_t *entry)
+{
+    kvstore->set(
+        kvstore,
+        entry->merge_policy,
+        entry->key,
+        entry->value,
+        kvstore->set_cbdata);
+    ib_mpool_lite_destroy(entry->mp);
+}
+
+/**
+ * Flusher thread: drain the write-behind queue until stopped.
+ *
+ * @param[in] data The @ref ib_kvstore_t.
+ *
+ * @returns NULL.
+ */
+static void *kvstore_wb_flusher(void *data)
+{
+    ib_kvstore_t *kvstore = (ib_kvstore_t *)data;
+
+    pthread_mutex_lock(&kvstore->wb_lock);
+    for (;;) {
+        kvstore_wb_entry_t *batch;
+
+        while (kvstore->wb_head == NULL && ! kvstore->wb_stop) {
+            pthread_cond_wait(&kvstore->wb_cond, &kvstore->wb_lock);
+        }
+        if (kvstore->wb_head == NULL && kvstore->wb_stop) {
+            break;
+        }
+
+        /* Take the whole queue and write it outside the lock. */
+        batch = kvstore->wb_head;
+        kvstore->wb_head = NULL;
+        kvstore->wb_tail = NULL;
+        kvstore->wb_pending = 0;
+        pthread_cond_broadcast(&kvstore->wb_cond);
+        pthread_mutex_unlock(&kvstore->wb_lock);
+
+        while (batch != NULL) {
+            kvstore_wb_entry_t *next = batch->next;
+            kvstore_wb_write(kvstore, batch);
+            batch = next;
+        }
+
+        pthread_mutex_lock(&kvstore->wb_lock);
+    }
+    pthread_mutex_unlock(&kvstore->wb_lock);
+
+    return NULL;
+}
+
+ib_status_t ib_kvstore_write_behind_set(
+    ib_kvstore_t *kvstore,
+    size_t        max_pending)
+{
+    assert(kvstore != NULL);
+
+    if (kvstore->wb_enabled || max_pending == 0) {
+        return IB_EINVAL;
+    }
+
+    if (pthread_mutex_init(&kvstore->wb_lock, NULL) != 0) {
+        return IB_EOTHER;
+    }
+    if (pthread_cond_init(&kvstore->wb_cond, NULL) != 0) {
+        pthread_mutex_destroy(&kvstore->wb_lock);
+        return IB_EOTHER;
+    }
+
+    kvstore->wb_max_pending = max_pending;
+    kvstore->wb_pending     = 0;
+    kvstore->wb_head        = NULL;
+    kvstore->wb_tail        = NULL;
+    kvstore->wb_stop        = false;
+
+    if (pthread_create(
+            &kvstore->wb_thread, NULL, kvstore_wb_flusher, kvstore) != 0)
+    {
+        pthread_cond_destroy(&kvstore->wb_cond);
+        pthread_mutex_destroy(&kvstore->wb_lock);
+        return IB_EOTHER;
+    }
+
+    kvstore->wb_enabled = true;
+
+    return IB_OK;
+}
+
+/**
+ * Stop the flusher thread, draining the queue first.
+ *
+ * @param[in] kvstore Store whose flusher to stop.
+ */
+static void kvstore_wb_stop(ib_kvstore_t *kvstore)
+{
+    if (! kvstore->wb_enabled) {
+        return;
+    }
+
+    pthread_mutex_lock(&kvstore->wb_lock);
+    kvstore->wb_stop = true;
+    pthread_cond_broadcast(&kvstore->wb_cond);
+    pthread_mutex_unlock(&kvstore->wb_lock);
+
+    pthread_join(kvstore->wb_thread, NULL);
+
+    pthread_cond_destroy(&kvstore->wb_cond);
+    pthread_mutex_destroy(&kvstore->wb_lock);
+    kvstore->wb_enabled = false;
+}
+
+/**
+ * Enqueue a write-behind copy of @a key / @a val.
+ *
+ * Blocks while the queue is at its depth bound.
+ *
+ * @param[in] kvstore Store to write to.
+ * @param[in] merge_policy Merge policy for the eventual write.
+ * @param[in] key Key; copied.
+ * @param[in] val Value; copied.
+ *
+ * @returns IB_OK or IB_EALLOC.
+ */
+static ib_status_t kvstore_wb_enqueue(
+    ib_kvstore_t *kvstore,
+    ib_kvstore_merge_policy_fn_t merge_policy,
+    const ib_kvstore_key_t *key,
+    ib_kvstore_value_t *val)
+{
+    ib_status_t         rc;
+    ib_mpool_lite_t    *mp;
+    ib_mm_t             mm;
+    kvstore_wb_entry_t *entry;
+    const uint8_t      *key_data;
+    size_t              key_len;
+
+    rc = ib_mpool_lite_create(&mp);
+    if (rc != IB_OK) {
+        return rc;
+    }
+    mm = ib_mm_mpool_lite(mp);
+
+    entry = ib_mm_calloc(mm, 1, sizeof(*entry));
+    if (entry == NULL) {
+        ib_mpool_lite_destroy(mp);
+        return IB_EALLOC;
+    }
+    entry->mp           = mp;
+    entry->merge_policy = merge_policy;
+
+    ib_kvstore_key_get(key, &key_data, &key_len);
+    rc = ib_kvstore_key_create(&entry->key, mm, key_data, key_len);
+    if (rc != IB_OK) {
+        ib_mpool_lite_destroy(mp);
+        return rc;
+    }
+
+    rc = ib_kvstore_value_dup(mm, val, &entry->value);
+    if (rc != IB_OK) {
+        ib_mpool_lite_destroy(mp);
+        return rc;
+    }
+
+    pthread_mutex_lock(&kvstore->wb_lock);
+    while (kvstore->wb_pending >= kvstore->wb_max_pending) {
+        pthread_cond_wait(&kvstore->wb_cond, &kvstore->wb_lock);
+    }
+    if (kvstore->wb_tail != NULL) {
+        kvstore->wb_tail->next = entry;
+    }
+    else {
+        kvstore->wb_head = entry;
+    }
+    kvstore->wb_tail = entry;
+    ++kvstore->wb_pending;
+    pthread_cond_broadcast(&kvstore->wb_cond);
+    pthread_mutex_unlock(&kvstore->wb_lock);
+
+    return IB_OK;
+}
+
 ib_status_t ib_kvstore_set(
     ib_kvstore_t *kvstore,
     ib_kvstore_merge_policy_fn_t merge_policy,
@@ -233,6 +445,11 @@ ib_status_t ib_kvstore_set(
         merge_policy = kvstore->default_merge_policy;
     }
 
+    /* In write-behind mode, queue a copy for the flusher thread. */
+    if (kvstore->wb_enabled) {
+        return kvstore_wb_enqueue(kvstore, merge_policy, key, val);
+    }
+
     rc = kvstore->set(kvstore, merge_policy, key, val, kvstore->set_cbdata);
 
     return rc;
@@ -255,6 +472,9 @@ void ib_kvstore_destroy(ib_kvstore_t *kvstore) {
     assert(kvstore != NULL);
     assert(kvstore->destroy != NULL);
 
+    /* Drain and stop the write-behind flusher before teardown. */
+    kvstore_wb_stop(kvstore);
+
     kvstore->destroy(kvstore, kvstore->destroy_cbdata);
 }
 
@@ -0,0 +1,700 @@
+/*****************************************************************************
+ * Licensed to Qualys, Inc. (QUALYS) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * QUALYS licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+/**
+ * @file
+ * @brief IronBee --- Key-Value Store, Single-File Log Implementation
+ *
+ * See ironbee/kvstore_filelog.h for the design discussion.
+ */
+
+#include "ironbee_config_auto.h"
+
+#include <ironbee/kvstore_filelog.h>
+
+#include "kvstore_private.h"
+
+#include <ironbee/clock.h>
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/uio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/** File magic: "IBKL". */
+#define KVSTORE_FILELOG_MAGIC 0x49424b4c
+
+/** Format version. */
+#define KVSTORE_FILELOG_VERSION 1
+
+/** Slot offset values below this are sentinels, not log offsets. */
+#define KVSTORE_FILELOG_FIRST_OFFSET 2
+
+/** Empty slot. */
+#define KVSTORE_FILELOG_EMPTY 0
+
+/** Removed key; probes continue past it. */
+#define KVSTORE_FILELOG_TOMBSTONE 1
+
+/** File header, at offset 0, part of the index mapping. */
+typedef struct {
+    uint32_t magic;   /**< KVSTORE_FILELOG_MAGIC; written last at init. */
+    uint32_t version; /**< KVSTORE_FILELOG_VERSION. */
+    uint64_t n_slots; /**< Index slots following this header. */
+    uint64_t log_end; /**< File offset of the next record append. */
+} kvstore_filelog_header_t;
+
+/** One index slot. */
+typedef struct {
+    uint64_t hash;   /**< Key hash; valid when offset is a log offset. */
+    uint64_t offset; /**< Record offset, or a sentinel. */
+} kvstore_filelog_slot_t;
+
+/** On-disk record header; key, type and value bytes follow. */
+typedef struct {
+    uint32_t key_len;    /**< Key length. */
+    uint32_t type_len;   /**< Type string length. */
+    uint32_t value_len;  /**< Value length. */
+    uint32_t reserved;   /**< Zero. */
+    uint64_t expiration; /**< Relative expiration (usec); 0 = none. */
+    uint64_t creation;   /**< Creation time (usec). */
+} kvstore_filelog_record_t;
+
+/** Server data. */
+typedef struct {
+    char                     *path;   /**< Store file path (malloc). */
+    int                       fd;     /**< Open file descriptor. */
+    kvstore_filelog_header_t *header; /**< Mapped header + slots. */
+    size_t                    map_sz; /**< Size of the mapping. */
+} kvstore_filelog_server_t;
+
+/** Slots of a mapped header. */
+static kvstore_filelog_slot_t *filelog_slots(kvstore_filelog_header_t *h)
+{
+    return (kvstore_filelog_slot_t *)(h + 1);
+}
+
+/** FNV-1a 64 over the key. */
+static uint64_t filelog_hash(const uint8_t *key, size_t key_len)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (size_t i = 0; i < key_len; ++i) {
+        hash ^= key[i];
+        hash *= 0x100000001b3ULL;
+    }
+    /* Avoid colliding with slot sentinels when stored. */
+    return (hash == 0) ? 1 : hash;
+}
+
+/** Read exactly @a len bytes at @a offset.  Returns IB_OK or IB_EOTHER. */
+static ib_status_t filelog_pread(
+    int      fd,
+    void    *buf,
+    size_t   len,
+    uint64_t offset
+)
+{
+    ssize_t r = pread(fd, buf, len, (off_t)offset);
+
+    return (r == (ssize_t)len) ? IB_OK : IB_EOTHER;
+}
+
+/**
+ * Find the slot for @a key.
+ *
+ * @param[in] server The server.
+ * @param[in] key Key bytes.
+ * @param[in] key_len Key length.
+ * @param[out] free_slot First reusable (empty/tombstone) slot seen, or
+ *             NULL if none; may be NULL.
+ *
+ * @returns The slot holding @a key, or NULL.
+ */
+static kvstore_filelog_slot_t *filelog_find(
+    kvstore_filelog_server_t *server,
+    const uint8_t            *key,
+    size_t                    key_len,
+    kvstore_filelog_slot_t  **free_slot
+)
+{
+    kvstore_filelog_slot_t *slots = filelog_slots(server->header);
+    size_t                  n = server->header->n_slots;
+    uint64_t                hash = filelog_hash(key, key_len);
+
+    if (free_slot != NULL) {
+        *free_slot = NULL;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        kvstore_filelog_slot_t *slot = &slots[(hash + i) % n];
+
+        if (slot->offset == KVSTORE_FILELOG_EMPTY) {
+            return NULL;
+        }
+        if (slot->offset == KVSTORE_FILELOG_TOMBSTONE) {
+            if (free_slot != NULL && *free_slot == NULL) {
+                *free_slot = slot;
+            }
+            continue;
+        }
+        if (slot->hash == hash) {
+            kvstore_filelog_record_t rec;
+            uint8_t                  rec_key[256];
+
+            if (key_len <= sizeof(rec_key) &&
+                filelog_pread(
+                    server->fd, &rec, sizeof(rec), slot->offset) == IB_OK &&
+                rec.key_len == key_len &&
+                filelog_pread(
+                    server->fd, rec_key, key_len,
+                    slot->offset + sizeof(rec)) == IB_OK &&
+                memcmp(rec_key, key, key_len) == 0)
+            {
+                return slot;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/** Connect: nothing to do; the file opens at init. */
+static ib_status_t kvconnect(
+    ib_kvstore_t        *kvstore,
+    ib_kvstore_cbdata_t *cbdata
+)
+{
+    return IB_OK;
+}
+
+/** Disconnect: nothing to do; teardown happens at destroy. */
+static ib_status_t kvdisconnect(
+    ib_kvstore_t        *kvstore,
+    ib_kvstore_cbdata_t *cbdata
+)
+{
+    return IB_OK;
+}
+
+/** Get implementation. */
+static ib_status_t kvget(
+    ib_kvstore_t            *kvstore,
+    ib_mm_t                  mm,
+    const ib_kvstore_key_t  *key,
+    ib_kvstore_value_t    ***values,
+    size_t                  *values_length,
+    ib_kvstore_cbdata_t     *cbdata
+)
+{
+    assert(kvstore != NULL);
+    assert(key != NULL);
+
+    kvstore_filelog_server_t *server =
+        (kvstore_filelog_server_t *)kvstore->server;
+    const uint8_t            *key_data;
+    size_t                    key_len;
+    kvstore_filelog_slot_t   *slot;
+    kvstore_filelog_record_t  rec;
+    ib_kvstore_value_t       *value;
+    char                     *type = NULL;
+    uint8_t                  *data = NULL;
+    ib_status_t               rc;
+
+    ib_kvstore_key_get(key, &key_data, &key_len);
+
+    rc = ib_kvstore_value_create(&value, mm);
+    if (rc != IB_OK) {
+        return rc;
+    }
+
+    if (flock(server->fd, LOCK_SH) != 0) {
+        return IB_EOTHER;
+    }
+
+    slot = filelog_find(server, key_data, key_len, NULL);
+    if (slot == NULL) {
+        flock(server->fd, LOCK_UN);
+        return IB_ENOENT;
+    }
+
+    rc = filelog_pread(server->fd, &rec, sizeof(rec), slot->offset);
+    if (rc != IB_OK) {
+        flock(server->fd, LOCK_UN);
+        return IB_EOTHER;
+    }
+
+    /* Expired records are absent; compaction reclaims them. */
+    if (rec.expiration > 0 &&
+        (ib_time_t)(rec.creation + rec.expiration) < ib_clock_get_time())
+    {
+        flock(server->fd, LOCK_UN);
+        return IB_ENOENT;
+    }
+
+    if (rec.type_len > 0) {
+        type = ib_mm_alloc(mm, rec.type_len);
+    }
+    if (rec.value_len > 0) {
+        data = ib_mm_alloc(mm, rec.value_len);
+    }
+    if ((rec.type_len > 0 && type == NULL) ||
+        (rec.value_len > 0 && data == NULL))
+    {
+        flock(server->fd, LOCK_UN);
+        return IB_EALLOC;
+    }
+    if ((rec.type_len > 0 &&
+         filelog_pread(
+             server->fd, type, rec.type_len,
+             slot->offset + sizeof(rec) + rec.key_len) != IB_OK) ||
+        (rec.value_len > 0 &&
+         filelog_pread(
+             server->fd, data, rec.value_len,
+             slot->offset + sizeof(rec) + rec.key_len + rec.type_len)
+         != IB_OK))
+    {
+        flock(server->fd, LOCK_UN);
+        return IB_EOTHER;
+    }
+
+    flock(server->fd, LOCK_UN);
+
+    ib_kvstore_value_expiration_set(value, (ib_time_t)rec.expiration);
+    ib_kvstore_value_creation_set(value, (ib_time_t)rec.creation);
+    ib_kvstore_value_type_set(value, type, rec.type_len);
+    ib_kvstore_value_value_set(value, data, rec.value_len);
+
+    *values = (ib_kvstore_value_t **)ib_mm_alloc(mm, sizeof(**values));
+    if (*values == NULL) {
+        return IB_EALLOC;
+    }
+    (*values)[0] = value;
+    *values_length = 1;
+
+    return IB_OK;
+}
+
+/** Set implementation. */
+static ib_status_t kvset(
+    ib_kvstore_t                 *kvstore,
+    ib_kvstore_merge_policy_fn_t  merge_policy,
+    const ib_kvstore_key_t       *key,
+    ib_kvstore_value_t           *value,
+    ib_kvstore_cbdata_t          *cbdata
+)
+{
+    assert(kvstore != NULL);
+    assert(key != NULL);
+    assert(value != NULL);
+
+    kvstore_filelog_server_t *server =
+        (kvstore_filelog_server_t *)kvstore->server;
+    const uint8_t            *key_data;
+    size_t                    key_len;
+    const uint8_t            *val_data;
+    size_t                    val_len;
+    const char               *type;
+    size_t                    type_len;
+    kvstore_filelog_record_t  rec;
+    kvstore_filelog_slot_t   *slot;
+    kvstore_filelog_slot_t   *free_slot = NULL;
+    uint64_t                  offset;
+    struct iovec              iov[4];
+    ib_status_t               rc = IB_OK;
+
+    ib_kvstore_key_get(key, &key_data, &key_len);
+    ib_kvstore_value_value_get(value, &val_data, &val_len);
+    ib_kvstore_value_type_get(value, &type, &type_len);
+
+    if (key_len == 0 || key_len > 256) {
+        return IB_EINVAL;
+    }
+
+    memset(&rec, 0, sizeof(rec));
+    rec.key_len    = (uint32_t)key_len;
+    rec.type_len   = (uint32_t)type_len;
+    rec.value_len  = (uint32_t)val_len;
+    rec.expiration = (uint64_t)ib_kvstore_value_expiration_get(value);
+    rec.creation   = (uint64_t)ib_clock_get_time();
+
+    if (flock(server->fd, LOCK_EX) != 0) {
+        return IB_EOTHER;
+    }
+
+    /* Append the record at the log end. */
+    offset = server->header->log_end;
+    iov[0].iov_base = &rec;
+    iov[0].iov_len  = sizeof(rec);
+    iov[1].iov_base = (void *)key_data;
+    iov[1].iov_len  = key_len;
+    iov[2].iov_base = (void *)type;
+    iov[2].iov_len  = type_len;
+    iov[3].iov_base = (void *)val_data;
+    iov[3].iov_len  = val_len;
+    {
+        size_t  total = sizeof(rec) + key_len + type_len + val_len;
+        ssize_t written = pwritev(server->fd, iov, 4, (off_t)offset);
+
+        if (written != (ssize_t)total) {
+            rc = IB_EOTHER;
+            goto unlock;
+        }
+        server->header->log_end = offset + total;
+    }
+
+    /* Point the key's slot at the new record. */
+    slot = filelog_find(server, key_data, key_len, &free_slot);
+    if (slot == NULL) {
+        if (free_slot == NULL) {
+            /* Probe for an empty slot. */
+            kvstore_filelog_slot_t *slots = filelog_slots(server->header);
+            size_t                  n = server->header->n_slots;
+            uint64_t                hash = filelog_hash(key_data, key_len);
+
+            for (size_t i = 0; i < n; ++i) {
+                kvstore_filelog_slot_t *candidate =
+                    &slots[(hash + i) % n];
+
+                if (candidate->offset == KVSTORE_FILELOG_EMPTY ||
+                    candidate->offset == KVSTORE_FILELOG_TOMBSTONE)
+                {
+                    free_slot = candidate;
+                    break;
+                }
+            }
+        }
+        if (free_slot == NULL) {
+            /* Index full. */
+            rc = IB_EOTHER;
+            goto unlock;
+        }
+        slot = free_slot;
+        slot->hash = filelog_hash(key_data, key_len);
+    }
+    slot->offset = offset;
+
+unlock:
+    flock(server->fd, LOCK_UN);
+    return rc;
+}
+
+/** Remove implementation. */
+static ib_status_t kvremove(
+    ib_kvstore_t           *kvstore,
+    const ib_kvstore_key_t *key,
+    ib_kvstore_cbdata_t    *cbdata
+)
+{
+    assert(kvstore != NULL);
+    assert(key != NULL);
+
+    kvstore_filelog_server_t *server =
+        (kvstore_filelog_server_t *)kvstore->server;
+    const uint8_t            *key_data;
+    size_t                    key_len;
+    kvstore_filelog_slot_t   *slot;
+
+    ib_kvstore_key_get(key, &key_data, &key_len);
+
+    if (flock(server->fd, LOCK_EX) != 0) {
+        return IB_EOTHER;
+    }
+
+    slot = filelog_find(server, key_data, key_len, NULL);
+    if (slot != NULL) {
+        slot->offset = KVSTORE_FILELOG_TOMBSTONE;
+    }
+
+    flock(server->fd, LOCK_UN);
+    return (slot != NULL) ? IB_OK : IB_ENOENT;
+}
+
+/** Destroy: unmap, close and free the server. */
+static void kvdestroy(
+    ib_kvstore_t        *kvstore,
+    ib_kvstore_cbdata_t *cbdata
+)
+{
+    kvstore_filelog_server_t *server =
+        (kvstore_filelog_server_t *)kvstore->server;
+
+    if (server != NULL) {
+        if (server->header != NULL) {
+            munmap(server->header, server->map_sz);
+        }
+        if (server->fd >= 0) {
+            close(server->fd);
+        }
+        free(server->path);
+        free(server);
+        kvstore->server = NULL;
+    }
+}
+
+ib_status_t ib_kvstore_filelog_init(
+    ib_kvstore_t *kvstore,
+    const char   *path,
+    size_t        slots
+)
+{
+    assert(kvstore != NULL);
+    assert(path != NULL);
+
+    kvstore_filelog_server_t *server;
+    kvstore_filelog_header_t  header;
+    size_t                    map_sz;
+    ssize_t                   got;
+
+    if (slots == 0) {
+        return IB_EINVAL;
+    }
+
+    server = calloc(1, sizeof(*server));
+    if (server == NULL) {
+        return IB_EALLOC;
+    }
+    server->fd = -1;
+    server->path = strdup(path);
+    if (server->path == NULL) {
+        free(server);
+        return IB_EALLOC;
+    }
+
+    server->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (server->fd < 0) {
+        goto fail;
+    }
+
+    if (flock(server->fd, LOCK_EX) != 0) {
+        goto fail;
+    }
+
+    got = pread(server->fd, &header, sizeof(header), 0);
+    if (got == (ssize_t)sizeof(header) &&
+        header.magic == KVSTORE_FILELOG_MAGIC)
+    {
+        /* Existing store; its geometry wins. */
+        if (header.version != KVSTORE_FILELOG_VERSION) {
+            flock(server->fd, LOCK_UN);
+            goto fail;
+        }
+        slots = (size_t)header.n_slots;
+    }
+    else {
+        /* Fresh store: header + empty slots; magic goes in last. */
+        kvstore_filelog_slot_t empty_slot = { 0, 0 };
+
+        memset(&header, 0, sizeof(header));
+        header.version = KVSTORE_FILELOG_VERSION;
+        header.n_slots = slots;
+        header.log_end = sizeof(header) + slots * sizeof(empty_slot);
+        if (pwrite(server->fd, &header, sizeof(header), 0) !=
+            (ssize_t)sizeof(header))
+        {
+            flock(server->fd, LOCK_UN);
+            goto fail;
+        }
+        for (size_t i = 0; i < slots; ++i) {
+            if (pwrite(
+                    server->fd, &empty_slot, sizeof(empty_slot),
+                    sizeof(header) + i * sizeof(empty_slot)) !=
+                (ssize_t)sizeof(empty_slot))
+            {
+                flock(server->fd, LOCK_UN);
+                goto fail;
+            }
+        }
+        header.magic = KVSTORE_FILELOG_MAGIC;
+        if (pwrite(server->fd, &header, sizeof(header), 0) !=
+            (ssize_t)sizeof(header))
+        {
+            flock(server->fd, LOCK_UN);
+            goto fail;
+        }
+    }
+
+    map_sz = sizeof(header) + slots * sizeof(kvstore_filelog_slot_t);
+    server->header = mmap(
+        NULL, map_sz, PROT_READ | PROT_WRITE, MAP_SHARED, server->fd, 0);
+    if (server->header == MAP_FAILED) {
+        server->header = NULL;
+        flock(server->fd, LOCK_UN);
+        goto fail;
+    }
+    server->map_sz = map_sz;
+
+    flock(server->fd, LOCK_UN);
+
+    ib_kvstore_init(kvstore);
+    kvstore->server = (ib_kvstore_server_t *)server;
+    kvstore->get = kvget;
+    kvstore->set = kvset;
+    kvstore->remove = kvremove;
+    kvstore->connect = kvconnect;
+    kvstore->disconnect = kvdisconnect;
+    kvstore->destroy = kvdestroy;
+    kvstore->connect_cbdata = NULL;
+    kvstore->disconnect_cbdata = NULL;
+    kvstore->get_cbdata = NULL;
+    kvstore->set_cbdata = NULL;
+    kvstore->remove_cbdata = NULL;
+    kvstore->destroy_cbdata = NULL;
+
+    return IB_OK;
+
+fail:
+    if (server->fd >= 0) {
+        close(server->fd);
+    }
+    free(server->path);
+    free(server);
+    return IB_EINVAL;
+}
+
+ib_status_t ib_kvstore_filelog_compact(
+    ib_kvstore_t *kvstore
+)
+{
+    assert(kvstore != NULL);
+
+    kvstore_filelog_server_t *server =
+        (kvstore_filelog_server_t *)kvstore->server;
+    kvstore_filelog_header_t  new_header;
+    kvstore_filelog_slot_t   *slots;
+    char                     *tmp_path = NULL;
+    int                       tmp_fd = -1;
+    size_t                    n;
+    ib_time_t                 now = ib_clock_get_time();
+    ib_status_t               rc = IB_EOTHER;
+
+    if (flock(server->fd, LOCK_EX) != 0) {
+        return IB_EOTHER;
+    }
+
+    n = server->header->n_slots;
+    slots = filelog_slots(server->header);
+
+    tmp_path = malloc(strlen(server->path) + 8);
+    if (tmp_path == NULL) {
+        goto done;
+    }
+    sprintf(tmp_path, "%s.cmpct", server->path);
+    tmp_fd = open(tmp_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (tmp_fd < 0) {
+        goto done;
+    }
+
+    /* Fresh header and empty index. */
+    memset(&new_header, 0, sizeof(new_header));
+    new_header.version = KVSTORE_FILELOG_VERSION;
+    new_header.n_slots = n;
+    new_header.log_end =
+        sizeof(new_header) + n * sizeof(kvstore_filelog_slot_t);
+    if (ftruncate(tmp_fd, (off_t)new_header.log_end) != 0) {
+        goto done;
+    }
+
+    /* Copy live, unexpired records; rebuild slots as we go. */
+    for (size_t i = 0; i < n; ++i) {
+        kvstore_filelog_record_t rec;
+        kvstore_filelog_slot_t   new_slot;
+        uint8_t                 *buf;
+        size_t                   total;
+
+        if (slots[i].offset < KVSTORE_FILELOG_FIRST_OFFSET) {
+            continue;
+        }
+        if (filelog_pread(
+                server->fd, &rec, sizeof(rec), slots[i].offset) != IB_OK)
+        {
+            goto done;
+        }
+        if (rec.expiration > 0 &&
+            (ib_time_t)(rec.creation + rec.expiration) < now)
+        {
+            continue;
+        }
+
+        total = sizeof(rec) + rec.key_len + rec.type_len + rec.value_len;
+        buf = malloc(total);
+        if (buf == NULL) {
+            goto done;
+        }
+        if (filelog_pread(server->fd, buf, total, slots[i].offset) != IB_OK ||
+            pwrite(tmp_fd, buf, total, (off_t)new_header.log_end) !=
+                (ssize_t)total)
+        {
+            free(buf);
+            goto done;
+        }
+        free(buf);
+
+        new_slot.hash = slots[i].hash;
+        new_slot.offset = new_header.log_end;
+        if (pwrite(
+                tmp_fd, &new_slot, sizeof(new_slot),
+                (off_t)(sizeof(new_header) + i * sizeof(new_slot))) !=
+            (ssize_t)sizeof(new_slot))
+        {
+            goto done;
+        }
+        new_header.log_end += total;
+    }
+
+    new_header.magic = KVSTORE_FILELOG_MAGIC;
+    if (pwrite(tmp_fd, &new_header, sizeof(new_header), 0) !=
+        (ssize_t)sizeof(new_header))
+    {
+        goto done;
+    }
+
+    /* Swap the file in and remap this process's view. */
+    if (rename(tmp_path, server->path) != 0) {
+        goto done;
+    }
+    munmap(server->header, server->map_sz);
+    close(server->fd);
+    server->fd = tmp_fd;
+    tmp_fd = -1;
+    server->header = mmap(
+        NULL, server->map_sz,
+        PROT_READ | PROT_WRITE, MAP_SHARED, server->fd, 0);
+    if (server->header == MAP_FAILED) {
+        server->header = NULL;
+        rc = IB_EOTHER;
+        goto done_nolock;
+    }
+
+    rc = IB_OK;
+
+done:
+    flock(server->fd, LOCK_UN);
+done_nolock:
+    if (tmp_fd >= 0) {
+        close(tmp_fd);
+        unlink(tmp_path);
+    }
+    free(tmp_path);
+    return rc;
+}
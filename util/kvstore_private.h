@@ -24,6 +24,8 @@
 #include <ironbee/kvstore.h>
 #include <ironbee/types.h>
 
+#include <pthread.h>
+#include <stdbool.h>
 #include <stdlib.h>
 
 /**
@@ -155,9 +157,30 @@ typedef void (*ib_kvstore_destroy_fn_t)(
  *
  * Function pointer in this structure should never be called directly.
  */
+//! A queued write-behind entry; defined in kvstore.c.
+typedef struct kvstore_wb_entry_t kvstore_wb_entry_t;
+
 struct ib_kvstore_t {
     ib_kvstore_server_t *server; /**< Implementation dependent server data. */
 
+    /**
+     * Write-behind state.  See ib_kvstore_write_behind_set().
+     *
+     * When enabled, ib_kvstore_set() enqueues a copy of the key and
+     * value and returns; a flusher thread drains the queue into the
+     * backend in the background.  The queue depth is bounded by
+     * wb_max_pending; producers block when it is full.
+     */
+    bool                 wb_enabled;     /**< Write-behind on? */
+    size_t               wb_max_pending; /**< Queue depth bound. */
+    size_t               wb_pending;     /**< Entries queued. */
+    kvstore_wb_entry_t  *wb_head;        /**< Oldest queued entry. */
+    kvstore_wb_entry_t  *wb_tail;        /**< Newest queued entry. */
+    pthread_mutex_t      wb_lock;        /**< Guards the queue. */
+    pthread_cond_t       wb_cond;        /**< Queue state changes. */
+    pthread_t            wb_thread;      /**< Flusher thread. */
+    bool                 wb_stop;        /**< Flusher shutdown flag. */
+
     ib_kvstore_malloc_fn_t malloc; /**< Malloc memory for keys and values. */
     ib_kvstore_cbdata_t *malloc_cbdata; /**< Malloc cbdata. */
 
@@ -0,0 +1,562 @@
+/*****************************************************************************
+ * Licensed to Qualys, Inc. (QUALYS) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * QUALYS licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+/**
+ * @file
+ * @brief IronBee --- Key-Value Shared Memory Store Implementation
+ *
+ * @author Sam Baskinger <sbaskinger@qualys.com>
+ */
+
+#include "ironbee_config_auto.h"
+
+#include <ironbee/kvstore_shm.h>
+
+#include "kvstore_private.h"
+
+#include <ironbee/clock.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/** Magic tagging an initialized segment; bump when the layout changes. */
+#define KVSTORE_SHM_MAGIC 0x4942534eU /* "IBSN": v2, with sweep cursor. */
+
+/** Slot states. */
+#define KVSTORE_SHM_SLOT_EMPTY     0
+#define KVSTORE_SHM_SLOT_USED      1
+#define KVSTORE_SHM_SLOT_TOMBSTONE 2
+
+/**
+ * Header at the start of the shared segment.
+ */
+typedef struct {
+    uint32_t        magic;          /**< KVSTORE_SHM_MAGIC when ready. */
+    uint32_t        num_slots;      /**< Slots in the table. */
+    uint32_t        slot_data_size; /**< Data bytes per slot. */
+    uint32_t        sweep_cursor;   /**< Incremental expiry sweep position. */
+    pthread_mutex_t lock;           /**< Process-shared store lock. */
+} kvstore_shm_header_t;
+
+/**
+ * One slot: fixed-size record of key, type and value data.
+ */
+typedef struct {
+    uint32_t state;      /**< KVSTORE_SHM_SLOT_*. */
+    uint32_t key_len;    /**< Bytes of key at data[0]. */
+    uint32_t type_len;   /**< Bytes of type after the key. */
+    uint32_t value_len;  /**< Bytes of value after the type. */
+    uint64_t expiration; /**< Expiration, as ib_time_t. */
+    uint64_t creation;   /**< Creation, as ib_time_t. */
+    char     data[];     /**< key_len + type_len + value_len bytes. */
+} kvstore_shm_slot_t;
+
+/**
+ * The shared memory server object.
+ */
+typedef struct {
+    char                 *name;           /**< Segment name. */
+    size_t                num_slots;      /**< Slots in the table. */
+    size_t                slot_data_size; /**< Data bytes per slot. */
+    size_t                segment_size;   /**< Total mapping size. */
+    kvstore_shm_header_t *header;         /**< Mapped segment or NULL. */
+} kvstore_shm_server_t;
+
+/** Bytes for one whole slot. */
+static size_t kvstore_shm_slot_size(const kvstore_shm_server_t *server)
+{
+    /* Keep slots pointer-aligned. */
+    size_t size = sizeof(kvstore_shm_slot_t) + server->slot_data_size;
+    return (size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+}
+
+/** Fetch slot @a idx from the mapped table. */
+static kvstore_shm_slot_t *kvstore_shm_slot(
+    const kvstore_shm_server_t *server,
+    size_t                      idx
+)
+{
+    char *table = (char *)(server->header + 1);
+    return (kvstore_shm_slot_t *)(table + idx * kvstore_shm_slot_size(server));
+}
+
+/** djb2 over the key bytes. */
+static uint32_t kvstore_shm_hash(const uint8_t *key, size_t key_len)
+{
+    uint32_t hash = 5381;
+    for (size_t i = 0; i < key_len; ++i) {
+        hash = ((hash << 5) + hash) + key[i];
+    }
+    return hash;
+}
+
+/**
+ * Probe for the slot holding @a key.
+ *
+ * @param[in] server Server with a mapped segment.
+ * @param[in] key Key bytes.
+ * @param[in] key_len Length of @a key.
+ * @param[out] free_slot If non-NULL, set to the first tombstone or
+ *             empty slot seen; NULL if the table is full of live keys.
+ *
+ * @returns The slot holding @a key or NULL.
+ */
+static kvstore_shm_slot_t *kvstore_shm_find(
+    const kvstore_shm_server_t  *server,
+    const uint8_t               *key,
+    size_t                       key_len,
+    kvstore_shm_slot_t         **free_slot
+)
+{
+    size_t idx = kvstore_shm_hash(key, key_len) % server->num_slots;
+
+    if (free_slot != NULL) {
+        *free_slot = NULL;
+    }
+
+    for (size_t probes = 0; probes < server->num_slots; ++probes) {
+        kvstore_shm_slot_t *slot = kvstore_shm_slot(server, idx);
+
+        if (slot->state == KVSTORE_SHM_SLOT_EMPTY) {
+            if (free_slot != NULL && *free_slot == NULL) {
+                *free_slot = slot;
+            }
+            return NULL;
+        }
+        if (slot->state == KVSTORE_SHM_SLOT_TOMBSTONE) {
+            if (free_slot != NULL && *free_slot == NULL) {
+                *free_slot = slot;
+            }
+        }
+        else if (
+            slot->key_len == key_len &&
+            memcmp(slot->data, key, key_len) == 0
+        ) {
+            return slot;
+        }
+
+        idx = (idx + 1) % server->num_slots;
+    }
+
+    return NULL;
+}
+
+static ib_status_t kvconnect(
+    ib_kvstore_t        *kvstore,
+    ib_kvstore_cbdata_t *cbdata
+)
+{
+    assert(kvstore != NULL);
+
+    kvstore_shm_server_t *server = (kvstore_shm_server_t *)kvstore->server;
+    kvstore_shm_header_t *header;
+    int                   fd;
+    bool                  creator = false;
+
+    if (server->header != NULL) {
+        return IB_OK;
+    }
+
+    /* The creator initializes the segment; magic is set last so racing
+     * openers of a half built segment spin below until it is ready. */
+    fd = shm_open(server->name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd >= 0) {
+        creator = true;
+    }
+    else if (errno == EEXIST) {
+        fd = shm_open(server->name, O_RDWR, 0600);
+    }
+    if (fd < 0) {
+        return IB_EOTHER;
+    }
+
+    if (creator && ftruncate(fd, server->segment_size) != 0) {
+        close(fd);
+        shm_unlink(server->name);
+        return IB_EOTHER;
+    }
+
+    header = mmap(
+        NULL,
+        server->segment_size,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED,
+        fd,
+        0
+    );
+    close(fd);
+    if (header == MAP_FAILED) {
+        return IB_EOTHER;
+    }
+
+    if (creator) {
+        pthread_mutexattr_t attr;
+
+        memset(header, 0, server->segment_size);
+        header->num_slots      = server->num_slots;
+        header->slot_data_size = server->slot_data_size;
+
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        pthread_mutex_init(&header->lock, &attr);
+        pthread_mutexattr_destroy(&attr);
+
+        __sync_synchronize();
+        header->magic = KVSTORE_SHM_MAGIC;
+    }
+    else {
+        /* Wait (bounded) for the creator to finish initialization; a
+         * magic that never appears means a stale or incompatible
+         * segment. */
+        int spins = 5000;
+        while (header->magic != KVSTORE_SHM_MAGIC && spins-- > 0) {
+            usleep(1000);
+        }
+        if (header->magic != KVSTORE_SHM_MAGIC) {
+            munmap(header, server->segment_size);
+            return IB_EINVAL;
+        }
+        if (
+            header->num_slots != server->num_slots ||
+            header->slot_data_size != server->slot_data_size
+        ) {
+            munmap(header, server->segment_size);
+            return IB_EINVAL;
+        }
+    }
+
+    server->header = header;
+
+    return IB_OK;
+}
+
+static ib_status_t kvdisconnect(
+    ib_kvstore_t        *kvstore,
+    ib_kvstore_cbdata_t *cbdata
+)
+{
+    assert(kvstore != NULL);
+
+    kvstore_shm_server_t *server = (kvstore_shm_server_t *)kvstore->server;
+
+    if (server->header != NULL) {
+        munmap(server->header, server->segment_size);
+        server->header = NULL;
+    }
+
+    return IB_OK;
+}
+
+static ib_status_t kvget(
+    ib_kvstore_t             *kvstore,
+    ib_mm_t                   mm,
+    const ib_kvstore_key_t   *key,
+    ib_kvstore_value_t     ***values,
+    size_t                   *values_length,
+    ib_kvstore_cbdata_t      *cbdata
+)
+{
+    assert(kvstore != NULL);
+    assert(key != NULL);
+
+    kvstore_shm_server_t *server = (kvstore_shm_server_t *)kvstore->server;
+    const uint8_t        *key_data;
+    size_t                key_len;
+    kvstore_shm_slot_t   *slot;
+    ib_kvstore_value_t   *value;
+    char                 *type;
+    uint8_t              *data;
+    ib_status_t           rc;
+
+    if (server->header == NULL) {
+        return IB_EOTHER;
+    }
+
+    ib_kvstore_key_get(key, &key_data, &key_len);
+
+    rc = ib_kvstore_value_create(&value, mm);
+    if (rc != IB_OK) {
+        return rc;
+    }
+
+    pthread_mutex_lock(&server->header->lock);
+
+    slot = kvstore_shm_find(server, key_data, key_len, NULL);
+    if (slot == NULL) {
+        pthread_mutex_unlock(&server->header->lock);
+        return IB_ENOENT;
+    }
+
+    /* Expired entries are treated as absent and reaped in place. */
+    if (
+        slot->expiration > 0 &&
+        (ib_time_t)(slot->creation + slot->expiration) < ib_clock_get_time()
+    ) {
+        slot->state = KVSTORE_SHM_SLOT_TOMBSTONE;
+        pthread_mutex_unlock(&server->header->lock);
+        return IB_ENOENT;
+    }
+
+    /* Copy out under the lock. */
+    type = ib_mm_memdup(mm, slot->data + slot->key_len, slot->type_len);
+    data = ib_mm_memdup(
+        mm,
+        slot->data + slot->key_len + slot->type_len,
+        slot->value_len
+    );
+    if (
+        (slot->type_len > 0 && type == NULL) ||
+        (slot->value_len > 0 && data == NULL)
+    ) {
+        pthread_mutex_unlock(&server->header->lock);
+        return IB_EALLOC;
+    }
+
+    ib_kvstore_value_expiration_set(value, (ib_time_t)slot->expiration);
+    ib_kvstore_value_creation_set(value, (ib_time_t)slot->creation);
+    ib_kvstore_value_type_set(value, type, slot->type_len);
+    ib_kvstore_value_value_set(value, data, slot->value_len);
+
+    pthread_mutex_unlock(&server->header->lock);
+
+    *values = (ib_kvstore_value_t **)ib_mm_alloc(mm, sizeof(**values));
+    if (*values == NULL) {
+        return IB_EALLOC;
+    }
+    (*values)[0] = value;
+    *values_length = 1;
+
+    return IB_OK;
+}
+
+/** Slots examined by the incremental expiry sweep per write. */
+#define KVSTORE_SHM_SWEEP_STEP 8
+
+/**
+ * Reap a few expired slots, advancing the shared sweep cursor.
+ *
+ * Called with the store lock held on every write, this bounds the
+ * number of expired entries to roughly the write rate without a timer
+ * thread or per-read full scans: the cursor walks the whole table once
+ * every num_slots / KVSTORE_SHM_SWEEP_STEP writes.
+ *
+ * @param[in] server Server with a mapped segment.
+ * @param[in] now Current time.
+ */
+static void kvstore_shm_sweep(kvstore_shm_server_t *server, ib_time_t now)
+{
+    kvstore_shm_header_t *header = server->header;
+
+    for (size_t i = 0; i < KVSTORE_SHM_SWEEP_STEP; ++i) {
+        kvstore_shm_slot_t *slot;
+
+        header->sweep_cursor =
+            (header->sweep_cursor + 1) % server->num_slots;
+        slot = kvstore_shm_slot(server, header->sweep_cursor);
+
+        if (
+            slot->state == KVSTORE_SHM_SLOT_USED &&
+            slot->expiration > 0 &&
+            (ib_time_t)(slot->creation + slot->expiration) < now
+        ) {
+            slot->state = KVSTORE_SHM_SLOT_TOMBSTONE;
+        }
+    }
+}
+
+static ib_status_t kvset(
+    ib_kvstore_t                 *kvstore,
+    ib_kvstore_merge_policy_fn_t  merge_policy,
+    const ib_kvstore_key_t       *key,
+    ib_kvstore_value_t           *value,
+    ib_kvstore_cbdata_t          *cbdata
+)
+{
+    assert(kvstore != NULL);
+    assert(key != NULL);
+    assert(value != NULL);
+
+    kvstore_shm_server_t *server = (kvstore_shm_server_t *)kvstore->server;
+    const uint8_t        *key_data;
+    size_t                key_len;
+    const uint8_t        *val_data;
+    size_t                val_len;
+    const char           *type;
+    size_t                type_len;
+    kvstore_shm_slot_t   *slot;
+    kvstore_shm_slot_t   *free_slot;
+
+    if (server->header == NULL) {
+        return IB_EOTHER;
+    }
+
+    ib_kvstore_key_get(key, &key_data, &key_len);
+    ib_kvstore_value_value_get(value, &val_data, &val_len);
+    ib_kvstore_value_type_get(value, &type, &type_len);
+
+    if (key_len + type_len + val_len > server->slot_data_size) {
+        return IB_EINVAL;
+    }
+
+    pthread_mutex_lock(&server->header->lock);
+
+    slot = kvstore_shm_find(server, key_data, key_len, &free_slot);
+    if (slot == NULL) {
+        slot = free_slot;
+    }
+    if (slot == NULL) {
+        /* Table full. */
+        pthread_mutex_unlock(&server->header->lock);
+        return IB_EALLOC;
+    }
+
+    slot->key_len    = key_len;
+    slot->type_len   = type_len;
+    slot->value_len  = val_len;
+    slot->expiration = (uint64_t)ib_kvstore_value_expiration_get(value);
+    slot->creation   = (uint64_t)ib_clock_get_time();
+    memcpy(slot->data, key_data, key_len);
+    memcpy(slot->data + key_len, type, type_len);
+    memcpy(slot->data + key_len + type_len, val_data, val_len);
+    slot->state = KVSTORE_SHM_SLOT_USED;
+
+    /* Amortized expiry: reap a few slots per write. */
+    kvstore_shm_sweep(server, (ib_time_t)slot->creation);
+
+    pthread_mutex_unlock(&server->header->lock);
+
+    return IB_OK;
+}
+
+static ib_status_t kvremove(
+    ib_kvstore_t           *kvstore,
+    const ib_kvstore_key_t *key,
+    ib_kvstore_cbdata_t    *cbdata
+)
+{
+    assert(kvstore != NULL);
+    assert(key != NULL);
+
+    kvstore_shm_server_t *server = (kvstore_shm_server_t *)kvstore->server;
+    const uint8_t        *key_data;
+    size_t                key_len;
+    kvstore_shm_slot_t   *slot;
+
+    if (server->header == NULL) {
+        return IB_EOTHER;
+    }
+
+    ib_kvstore_key_get(key, &key_data, &key_len);
+
+    pthread_mutex_lock(&server->header->lock);
+
+    slot = kvstore_shm_find(server, key_data, key_len, NULL);
+    if (slot != NULL) {
+        slot->state = KVSTORE_SHM_SLOT_TOMBSTONE;
+    }
+
+    pthread_mutex_unlock(&server->header->lock);
+
+    return (slot == NULL) ? IB_ENOENT : IB_OK;
+}
+
+static void kvdestroy(
+    ib_kvstore_t        *kvstore,
+    ib_kvstore_cbdata_t *cbdata
+)
+{
+    assert(kvstore != NULL);
+
+    kvstore_shm_server_t *server = (kvstore_shm_server_t *)kvstore->server;
+
+    if (server != NULL) {
+        if (server->header != NULL) {
+            munmap(server->header, server->segment_size);
+        }
+        free(server->name);
+        free(server);
+        kvstore->server = NULL;
+    }
+}
+
+ib_status_t ib_kvstore_shm_init(
+    ib_kvstore_t *kvstore,
+    const char   *name,
+    size_t        num_slots,
+    size_t        slot_data_size)
+{
+    assert(kvstore != NULL);
+    assert(name != NULL);
+
+    kvstore_shm_server_t *server;
+
+    if (num_slots == 0 || slot_data_size == 0) {
+        return IB_EINVAL;
+    }
+
+    /* There is no callback data used for this implementation. */
+    ib_kvstore_init(kvstore);
+
+    server = calloc(1, sizeof(*server));
+    if (server == NULL) {
+        return IB_EALLOC;
+    }
+
+    server->name = strdup(name);
+    if (server->name == NULL) {
+        free(server);
+        return IB_EALLOC;
+    }
+    server->num_slots      = num_slots;
+    server->slot_data_size = slot_data_size;
+
+    {
+        /* Compute the slot size the same way the accessors will. */
+        size_t slot_size =
+            (sizeof(kvstore_shm_slot_t) + slot_data_size +
+             sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+        server->segment_size =
+            sizeof(kvstore_shm_header_t) + num_slots * slot_size;
+    }
+
+    kvstore->server = (ib_kvstore_server_t *)server;
+    kvstore->get = kvget;
+    kvstore->set = kvset;
+    kvstore->remove = kvremove;
+    kvstore->connect = kvconnect;
+    kvstore->disconnect = kvdisconnect;
+    kvstore->destroy = kvdestroy;
+
+    kvstore->malloc_cbdata = NULL;
+    kvstore->free_cbdata = NULL;
+    kvstore->connect_cbdata = NULL;
+    kvstore->disconnect_cbdata = NULL;
+    kvstore->get_cbdata = NULL;
+    kvstore->set_cbdata = NULL;
+    kvstore->remove_cbdata = NULL;
+    kvstore->merge_policy_cbdata = NULL;
+    kvstore->destroy_cbdata = NULL;
+
+    return IB_OK;
+}
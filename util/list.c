@@ -30,6 +30,7 @@
 #include <ironbee/list.h>
 
 #include <assert.h>
+#include <string.h>
 
 ib_status_t ib_list_create(ib_list_t **plist, ib_mm_t mm)
 {
@@ -87,11 +88,29 @@ ib_status_t ib_list_copy(const ib_list_t *src,
     return IB_OK;
 }
 
+/**
+ * Get a node for insertion, reusing a recycled one if available.
+ *
+ * @param[in] list List to get a node for.
+ *
+ * @returns A zeroed node or NULL on allocation failure.
+ */
+static ib_list_node_t *ib_list_node_get(ib_list_t *list)
+{
+    ib_list_node_t *node = list->free_nodes;
+
+    if (node != NULL) {
+        list->free_nodes = node->next;
+        memset(node, 0, sizeof(*node));
+        return node;
+    }
+
+    return (ib_list_node_t *)ib_mm_calloc(list->mm, 1, sizeof(*node));
+}
+
 ib_status_t ib_list_push(ib_list_t *list, void *data)
 {
-    ib_list_node_t *node = (ib_list_node_t *)ib_mm_calloc(list->mm,
-        1, sizeof(*node)
-    );
+    ib_list_node_t *node = ib_list_node_get(list);
     if (node == NULL) {
         return IB_EALLOC;
     }
@@ -126,9 +145,7 @@ ib_status_t ib_list_pop(ib_list_t *list, void *pdata)
 
 ib_status_t ib_list_unshift(ib_list_t *list, void *data)
 {
-    ib_list_node_t *node = (ib_list_node_t *)ib_mm_calloc(list->mm,
-        1, sizeof(*node)
-    );
+    ib_list_node_t *node = ib_list_node_get(list);
     if (node == NULL) {
         return IB_EALLOC;
     }
@@ -163,6 +180,12 @@ ib_status_t ib_list_shift(ib_list_t *list, void *pdata)
 
 void ib_list_clear(ib_list_t *list)
 {
+    /* Recycle the nodes for future inserts. */
+    if (list->head != NULL) {
+        list->tail->next = list->free_nodes;
+        list->free_nodes = list->head;
+    }
+
     list->nelts = 0;
     list->head = list->tail = NULL;
     return;
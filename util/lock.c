@@ -25,6 +25,8 @@
 
 #include <ironbee/lock.h>
 
+#include <assert.h>
+
 static void lock_destroy(void *cbdata)
 {
     ib_lock_t *lock = (ib_lock_t *)cbdata;
@@ -116,3 +118,89 @@ ib_status_t ib_lock_unlock(ib_lock_t *lock)
 
     return IB_OK;
 }
+
+/** Contended acquisitions spin this many attempts before parking. */
+#define IB_LOCK_SPIN_TRIES 64
+
+/** A CPU pause between spin attempts. */
+static inline void lock_cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __asm__ __volatile__ ("pause");
+#endif
+}
+
+/** Destroy an rwlock; cleanup callback for memory managers. */
+static void rwlock_destroy(void *lock)
+{
+    pthread_rwlock_destroy((ib_rwlock_t *)lock);
+}
+
+ib_status_t ib_rwlock_create(ib_rwlock_t **lock, ib_mm_t mm)
+{
+    ib_rwlock_t *l;
+    int          rc;
+
+    l = ib_mm_alloc(mm, sizeof(*l));
+    if (l == NULL) {
+        return IB_EALLOC;
+    }
+
+    rc = pthread_rwlock_init(l, NULL);
+    if (rc != 0) {
+        return IB_EALLOC;
+    }
+
+    rc = ib_mm_register_cleanup(mm, &rwlock_destroy, l);
+    if (rc != 0) {
+        return IB_EOTHER;
+    }
+
+    *lock = l;
+
+    return IB_OK;
+}
+
+ib_status_t ib_rwlock_rdlock(ib_rwlock_t *lock)
+{
+    assert(lock != NULL);
+
+    for (int i = 0; i < IB_LOCK_SPIN_TRIES; ++i) {
+        if (pthread_rwlock_tryrdlock(lock) == 0) {
+            return IB_OK;
+        }
+        lock_cpu_relax();
+    }
+
+    if (pthread_rwlock_rdlock(lock) != 0) {
+        return IB_EUNKNOWN;
+    }
+    return IB_OK;
+}
+
+ib_status_t ib_rwlock_wrlock(ib_rwlock_t *lock)
+{
+    assert(lock != NULL);
+
+    for (int i = 0; i < IB_LOCK_SPIN_TRIES; ++i) {
+        if (pthread_rwlock_trywrlock(lock) == 0) {
+            return IB_OK;
+        }
+        lock_cpu_relax();
+    }
+
+    if (pthread_rwlock_wrlock(lock) != 0) {
+        return IB_EUNKNOWN;
+    }
+    return IB_OK;
+}
+
+ib_status_t ib_rwlock_unlock(ib_rwlock_t *lock)
+{
+    assert(lock != NULL);
+
+    if (pthread_rwlock_unlock(lock) != 0) {
+        return IB_EUNKNOWN;
+    }
+    return IB_OK;
+}
@@ -30,6 +30,7 @@
 #include <ironbee/logformat.h>
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
 typedef enum {
     STATE_NORMAL,
@@ -320,12 +321,13 @@ ib_status_t ib_logformat_format(const ib_logformat_t *lf,
             return IB_EINVAL;
         }
 
-        /* Copy into buffer */
-        strncpy(line_cur, str, line_remain);
+        /* Copy into buffer.  Only the item's bytes are copied; strncpy
+         * would zero fill the whole remaining buffer per item. */
         if (len > line_remain) {
             len = line_remain;
             truncated = true;
         }
+        memcpy(line_cur, str, len);
         line_cur += len;
         line_remain -= len;
 
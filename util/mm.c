@@ -39,6 +39,15 @@ bool ib_mm_is_null(ib_mm_t mm)
     return mm.alloc == NULL;
 }
 
+bool ib_mm_same(ib_mm_t a, ib_mm_t b)
+{
+    return
+        a.alloc                 == b.alloc                 &&
+        a.alloc_data            == b.alloc_data            &&
+        a.register_cleanup      == b.register_cleanup      &&
+        a.register_cleanup_data == b.register_cleanup_data;
+}
+
 void *ib_mm_alloc(
     ib_mm_t mm,
     size_t  size
@@ -96,6 +105,63 @@ void *ib_mm_memdup(ib_mm_t mm, const void *src, size_t size)
     return mem;
 }
 
+/** State of a counted memory manager; see ib_mm_counted(). */
+typedef struct {
+    ib_mm_t              inner; /**< Wrapped memory manager. */
+    ib_mm_alloc_count_t *count; /**< Counters to maintain. */
+} mm_counted_t;
+
+/** Allocation function of a counted memory manager. */
+static void *mm_counted_alloc(
+    size_t  size,
+    void   *cbdata
+)
+{
+    mm_counted_t *counted = (mm_counted_t *)cbdata;
+
+    __sync_fetch_and_add(&counted->count->allocations, 1);
+    __sync_fetch_and_add(&counted->count->bytes, size);
+
+    return ib_mm_alloc(counted->inner, size);
+}
+
+/** Cleanup registration function of a counted memory manager. */
+static ib_status_t mm_counted_register_cleanup(
+    ib_mm_cleanup_fn_t  fn,
+    void               *fndata,
+    void               *cbdata
+)
+{
+    mm_counted_t *counted = (mm_counted_t *)cbdata;
+
+    return ib_mm_register_cleanup(counted->inner, fn, fndata);
+}
+
+ib_status_t ib_mm_counted(
+    ib_mm_t               mm,
+    ib_mm_alloc_count_t  *count,
+    ib_mm_t              *out
+)
+{
+    assert(count != NULL);
+    assert(out   != NULL);
+
+    mm_counted_t *counted =
+        (mm_counted_t *)ib_mm_alloc(mm, sizeof(*counted));
+    if (counted == NULL) {
+        return IB_EALLOC;
+    }
+    counted->inner = mm;
+    counted->count = count;
+
+    out->alloc                 = mm_counted_alloc;
+    out->alloc_data            = counted;
+    out->register_cleanup      = mm_counted_register_cleanup;
+    out->register_cleanup_data = counted;
+
+    return IB_OK;
+}
+
 char *ib_mm_memdup_to_str(ib_mm_t mm, const void *src, size_t size)
 {
     if (src == NULL) {
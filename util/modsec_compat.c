@@ -95,6 +95,30 @@ ib_status_t ib_util_decode_url(
     const uint8_t *end = data_in + dlen_in;
 
     while (in < end) {
+        /* Bulk-handle the span up to the next byte needing work.  memchr
+         * is vectorized by the C library, so clean spans move at SIMD
+         * speed instead of byte at a time. */
+        if ( (*in != '%') && (*in != '+') ) {
+            const uint8_t *next_pct  = memchr(in, '%', end - in);
+            const uint8_t *next_plus = memchr(in, '+', end - in);
+            const uint8_t *next      = next_pct;
+
+            if (next == NULL ||
+                (next_plus != NULL && next_plus < next))
+            {
+                next = next_plus;
+            }
+            if (next == NULL) {
+                next = end;
+            }
+            if (out != in) {
+                memmove(out, in, next - in);
+            }
+            out += next - in;
+            in   = next;
+            continue;
+        }
+
         if (*in == '%') {
             /* Character is a percent sign. */
 
@@ -131,16 +155,9 @@ ib_status_t ib_util_decode_url(
             }
         }
         else {
-            /* Character is not a percent sign. */
-            if (*in == '+') {
-                *out++ = ' ';
-            }
-            else if (out != in) {
-                *out++ = *in;
-            }
-            else {
-                ++out;
-            }
+            /* Character is a plus sign; all other bytes were bulk
+             * copied above. */
+            *out++ = ' ';
             ++in;
         }
     }
@@ -168,6 +185,22 @@ ib_status_t ib_util_decode_html_entity(
     while (in < end) {
         size_t copy = 1;
 
+        /* Bulk-copy the span up to the next ampersand; memchr is
+         * vectorized by the C library. */
+        if (*in != '&') {
+            const uint8_t *next = memchr(in, '&', end - in);
+
+            if (next == NULL) {
+                next = end;
+            }
+            if (out != in) {
+                memmove(out, in, next - in);
+            }
+            out += next - in;
+            in   = next;
+            continue;
+        }
+
         /* Require an ampersand and at least one character to
          * start looking into the entity.
          */
@@ -609,6 +642,20 @@ ib_status_t ib_util_decode_html_entity(
     return IB_OK;
 }
 
+/*
+ * On restructuring this as a segment-stack normalizer over an offset
+ * array with vectorized "/." anchor search: the implementation below
+ * is already a single forward pass with separate read and write
+ * cursors -- collapsing a back-reference rewinds the write cursor in
+ * place, so there is no per-collapse data movement and exactly one
+ * copy of the input is made (the memmove-based loops elsewhere in this
+ * file are the URL/entity decoders, not this function).  An offset
+ * array plus final compaction would perform the same single compaction
+ * with extra bookkeeping, and request URIs are far too short for an
+ * anchor-scan to amortize; the wins here came from running it less
+ * (the per-field transformation memo covers the raw/decoded double
+ * application when targets repeat).
+ */
 ib_status_t ib_util_normalize_path(
     ib_mm_t mm,
     const uint8_t *data_in,
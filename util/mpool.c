@@ -652,6 +652,13 @@ ib_mpool_page_t *ib_mpool_alloc_pages(
  * Pops a page from the free list if available or allocates a new page if
  * not.  The page returned should be considered uninitialized.
  *
+ * On NUMA systems no explicit placement is done, deliberately: pages are
+ * first touched by the worker thread that owns the pool (connection and
+ * transaction pools never migrate mid-use), so the kernel's first-touch
+ * policy already places them on that thread's node.  Recycled pages stay
+ * with their pool and thus their node.  Explicit libnuma binding would
+ * add a dependency to reproduce the behavior this layout gets for free.
+ *
  * @param[in] mp Memory pool to acquire page for.
  * @return Uninitialized page or NULL on allocation error.
  **/
@@ -1421,6 +1428,138 @@ finished:
     return result;
 }
 
+/** A top-consumer row for ib_mpool_usage_report(). */
+typedef struct {
+    char   *path;  /**< Malloced path of the pool; see ib_mpool_path(). */
+    size_t  inuse; /**< Bytes in use by the pool itself. */
+} ib_mpool_usage_row_t;
+
+/**
+ * Total bytes in use by @a mp and all of its descendants.
+ *
+ * @sa ib_mpool_usage_report()
+ *
+ * @param[in] mp Memory pool to total.
+ * @return Bytes in use in the subtree rooted at @a mp.
+ */
+static
+size_t ib_mpool_usage_subtree(
+    const ib_mpool_t *mp
+)
+{
+    assert(mp != NULL);
+
+    size_t total = mp->inuse;
+
+    IB_MPOOL_FOREACH(const ib_mpool_t, child, mp->children) {
+        total += ib_mpool_usage_subtree(child);
+    }
+
+    return total;
+}
+
+/**
+ * Insert @a mp into the top-consumer rows if it ranks.
+ *
+ * Rows are kept sorted, largest first; an inserted pool's path is
+ * malloced and an evicted row's path freed.
+ *
+ * @sa ib_mpool_usage_report()
+ *
+ * @param[in] mp    Memory pool to consider.
+ * @param[in] rows  Rows, @a top_n of them; empty rows have NULL path.
+ * @param[in] top_n Number of rows.
+ */
+static
+void ib_mpool_usage_rank(
+    const ib_mpool_t     *mp,
+    ib_mpool_usage_row_t *rows,
+    size_t                top_n
+)
+{
+    assert(mp   != NULL);
+    assert(rows != NULL);
+
+    if (
+        rows[top_n - 1].path != NULL &&
+        mp->inuse <= rows[top_n - 1].inuse
+    ) {
+        return;
+    }
+
+    char *path = ib_mpool_path(mp);
+    if (path == NULL) {
+        return;
+    }
+
+    if (rows[top_n - 1].path != NULL) {
+        free(rows[top_n - 1].path);
+    }
+
+    size_t at = top_n - 1;
+    while (
+        at > 0 &&
+        (rows[at - 1].path == NULL || rows[at - 1].inuse < mp->inuse)
+    ) {
+        rows[at] = rows[at - 1];
+        --at;
+    }
+    rows[at].path  = path;
+    rows[at].inuse = mp->inuse;
+
+    return;
+}
+
+/**
+ * Add the usage line for @a mp to @a report and recurse into children.
+ *
+ * @sa ib_mpool_usage_report()
+ *
+ * @param[in] mp     Memory pool to report on.
+ * @param[in] depth  Indentation depth of @a mp.
+ * @param[in] report Report to append to.
+ * @param[in] rows   Top-consumer rows or NULL for none.
+ * @param[in] top_n  Number of rows.
+ * @return true iff success.
+ */
+static
+bool ib_mpool_usage_report_helper(
+    const ib_mpool_t     *mp,
+    size_t                depth,
+    ib_mpool_report_t    *report,
+    ib_mpool_usage_row_t *rows,
+    size_t                top_n
+)
+{
+    assert(mp     != NULL);
+    assert(report != NULL);
+
+    IMR_PRINTF(
+        "%*s%s inuse=%zd subtree=%zd\n",
+        (int)(2 * depth), "",
+        (mp->name != NULL ? mp->name : "(unnamed)"),
+        mp->inuse,
+        ib_mpool_usage_subtree(mp)
+    );
+
+    if (rows != NULL) {
+        ib_mpool_usage_rank(mp, rows, top_n);
+    }
+
+    IB_MPOOL_FOREACH(const ib_mpool_t, child, mp->children) {
+        bool result =
+            ib_mpool_usage_report_helper(child, depth + 1, report, rows, top_n);
+        if (! result) {
+            goto failure;
+        }
+    }
+
+    return true;
+
+failure:
+    return false;
+}
+
 #undef IMR_PRINTF
 
 /* End Internal */
@@ -2344,6 +2483,61 @@ char *ib_mpool_debug_report(
     return report_text;
 }
 
+char *ib_mpool_usage_report(
+    const ib_mpool_t *mp,
+    size_t            top_n
+)
+{
+    assert(mp != NULL);
+
+    ib_mpool_report_t     report;
+    ib_mpool_usage_row_t *rows        = NULL;
+    char                 *report_text = NULL;
+
+    ib_mpool_report_init(&report);
+
+    if (top_n > 0) {
+        rows = (ib_mpool_usage_row_t *)calloc(top_n, sizeof(*rows));
+        if (rows == NULL) {
+            return NULL;
+        }
+    }
+
+    bool result =
+        ib_mpool_report_printf(&report, "Pool tree:\n") &&
+        ib_mpool_usage_report_helper(mp, 1, &report, rows, top_n);
+
+    if (result && rows != NULL) {
+        result = ib_mpool_report_printf(&report, "Top consumers:\n");
+        for (size_t i = 0; result && i < top_n; ++i) {
+            if (rows[i].path == NULL) {
+                break;
+            }
+            result = ib_mpool_report_printf(
+                &report,
+                "  %s inuse=%zd\n",
+                rows[i].path,
+                rows[i].inuse
+            );
+        }
+    }
+
+    if (result) {
+        report_text = ib_mpool_report_convert(&report);
+    }
+
+    if (rows != NULL) {
+        for (size_t i = 0; i < top_n; ++i) {
+            if (rows[i].path != NULL) {
+                free(rows[i].path);
+            }
+        }
+        free(rows);
+    }
+    ib_mpool_report_destroy(&report);
+    return report_text;
+}
+
 /* All of the following routines are written in terms of the previous and
  * do not directly touch mp.
  */
@@ -74,9 +74,11 @@
  * now small.  However, it also increases the amount of memory used and
  * wasted.
  *
+ * The definition lives in the public header so stats callers can size
+ * their per-class arrays.
+ *
  * @sa IB_MPOOL_FREEABLE_TRACK_ZERO_SIZE
  **/
-#define IB_MPOOL_FREEABLE_NUM_TRACKS 9
 
 
 /**
@@ -148,6 +150,8 @@ struct tiny_allocation_t {
     size_t             references; /**< How many references to this. */
     size_t             size;       /**< Size of allocation. */
     size_t             allocated;  /**< Amount of segment that is allocated. */
+    int                closed;     /**< No further bump allocations; see
+                                        ib_mpool_freeable_compact(). */
     segment_cleanup_t *cleanup;    /**< Linked list of cleanup functions. */
     tiny_allocation_t *next;       /**< Next allocation. */
     char               alloc;      /**< 1st byte of allocation. */
@@ -434,6 +438,7 @@ static ib_status_t tiny_allocation_create(
     t->references            = 1;
     t->size                  = IB_MPOOL_FREEABLE_DEFAULT_PAGE_SIZE;
     t->allocated             = 0;
+    t->closed                = 0;
     t->cleanup               = NULL;
     t->next                  = mp->tracks[track_number];
     mp->tracks[track_number] = t;
@@ -605,7 +610,7 @@ static void* tiny_alloc(
      * front of the stack. */
     if (
         (mp->tracks[track_number] == NULL) ||
-
+        (mp->tracks[track_number]->closed) ||
         (mp->tracks[track_number]->size - mp->tracks[track_number]->allocated)
             < (size + IB_MPOOL_FREEABLE_REDZONE_SIZE)
     )
@@ -1074,3 +1079,86 @@ failure:
 
 
 /**@}*/
+
+ib_status_t ib_mpool_freeable_stats(
+    ib_mpool_freeable_t             *mp,
+    ib_mpool_freeable_class_stats_t *classes,
+    size_t                          *n_classes,
+    size_t                          *segment_bytes,
+    size_t                          *segment_count
+)
+{
+    assert(mp != NULL);
+    assert(classes != NULL);
+    assert(n_classes != NULL);
+    assert(segment_bytes != NULL);
+    assert(segment_count != NULL);
+
+    ib_status_t rc;
+
+    rc = ib_lock_lock(mp->mutex);
+    if (rc != IB_OK) {
+        return rc;
+    }
+
+    for (size_t tn = 0; tn < IB_MPOOL_FREEABLE_NUM_TRACKS; ++tn) {
+        ib_mpool_freeable_class_stats_t *c = &classes[tn];
+
+        c->pages      = 0;
+        c->held_bytes = 0;
+        c->used_bytes = 0;
+        c->references = 0;
+        for (
+            const tiny_allocation_t *ta = mp->tracks[tn];
+            ta != NULL;
+            ta = ta->next
+        ) {
+            ++c->pages;
+            c->held_bytes += ta->size;
+            c->used_bytes += ta->allocated;
+            c->references += ta->references;
+        }
+    }
+    *n_classes = IB_MPOOL_FREEABLE_NUM_TRACKS;
+
+    *segment_bytes = 0;
+    *segment_count = 0;
+    if (mp->segment_list != NULL) {
+        const ib_mpool_freeable_segment_t *seg = mp->segment_list;
+
+        do {
+            *segment_bytes += seg->size;
+            ++*segment_count;
+            seg = seg->next;
+        } while (seg != mp->segment_list);
+    }
+
+    ib_lock_unlock(mp->mutex);
+    return IB_OK;
+}
+
+ib_status_t ib_mpool_freeable_compact(ib_mpool_freeable_t *mp)
+{
+    assert(mp != NULL);
+
+    ib_status_t rc;
+
+    rc = ib_lock_lock(mp->mutex);
+    if (rc != IB_OK) {
+        return rc;
+    }
+
+    /* Close each class's bump page: allocations after this point start
+     * fresh pages, so new (short-lived) data never moves in with old
+     * (long-lived) data and pages drain along generation lines.  The
+     * closed page itself frees as soon as its last reference drops,
+     * exactly as any non-head page does. */
+    for (size_t tn = 0; tn < IB_MPOOL_FREEABLE_NUM_TRACKS; ++tn) {
+        if (mp->tracks[tn] != NULL) {
+            mp->tracks[tn]->closed = 1;
+        }
+    }
+
+    ib_lock_unlock(mp->mutex);
+    return IB_OK;
+}
@@ -52,6 +52,12 @@ struct ib_mpool_lite_block_t
 };
 typedef struct ib_mpool_lite_block_t ib_mpool_lite_block_t;
 
+/** Size of each small-object slab. */
+#define IB_MPOOL_LITE_SLAB_SIZE 2048
+
+/** Allocations at or below this size are bump allocated from a slab. */
+#define IB_MPOOL_LITE_SMALL_MAX 256
+
 struct ib_mpool_lite_t
 {
     /**
@@ -64,6 +70,19 @@ struct ib_mpool_lite_t
 
     /** First cleanup function. */
     ib_mpool_lite_cleanup_t *first_cleanup;
+
+    /**
+     * Current small-object slab, or NULL.
+     *
+     * Small allocations are bump allocated from slabs of
+     * @ref IB_MPOOL_LITE_SLAB_SIZE bytes instead of one malloc() each.
+     * Slabs are chained into first_block like any other block, so
+     * destruction frees them the same way.
+     */
+    char *slab;
+
+    /** Bytes of the current slab already handed out. */
+    size_t slab_used;
 };
 
 ib_status_t ib_mpool_lite_create(ib_mpool_lite_t **pool)
@@ -76,6 +95,8 @@ ib_status_t ib_mpool_lite_create(ib_mpool_lite_t **pool)
     }
     local_pool->first_block = NULL;
     local_pool->first_cleanup = NULL;
+    local_pool->slab = NULL;
+    local_pool->slab_used = 0;
 
     *pool = local_pool;
 
@@ -119,6 +140,32 @@ void *ib_mpool_lite_alloc(ib_mpool_lite_t *pool, size_t size)
         return (void *)s_empty_mem;
     }
 
+    /* Bump allocate small requests from a slab.  Returned memory keeps
+     * the same alignment as block->data: one pointer past a malloc. */
+    if (size <= IB_MPOOL_LITE_SMALL_MAX) {
+        const size_t aligned =
+            (size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+        void *ptr;
+
+        if (
+            pool->slab == NULL ||
+            pool->slab_used + aligned > IB_MPOOL_LITE_SLAB_SIZE
+        ) {
+            block = malloc(sizeof(block->next) + IB_MPOOL_LITE_SLAB_SIZE);
+            if (block == NULL) {
+                return NULL;
+            }
+            block->next = pool->first_block;
+            pool->first_block = block;
+            pool->slab = block->data;
+            pool->slab_used = 0;
+        }
+
+        ptr = pool->slab + pool->slab_used;
+        pool->slab_used += aligned;
+        return ptr;
+    }
+
     block = malloc(sizeof(block->next) + size);
     if (block == NULL) {
         return NULL;
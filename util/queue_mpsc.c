@@ -0,0 +1,89 @@
+/*****************************************************************************
+ * Licensed to Qualys, Inc. (QUALYS) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * QUALYS licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+/**
+ * @file
+ * @brief IronBee --- Lock-Free MPSC Queue Implementation
+ */
+
+#include "ironbee_config_auto.h"
+
+#include <ironbee/queue_mpsc.h>
+
+#include <assert.h>
+#include <stddef.h>
+
+void ib_queue_mpsc_init(ib_queue_mpsc_t *queue)
+{
+    assert(queue != NULL);
+
+    queue->head  = NULL;
+    queue->depth = 0;
+}
+
+bool ib_queue_mpsc_push(
+    ib_queue_mpsc_t      *queue,
+    ib_queue_mpsc_node_t *node
+)
+{
+    assert(queue != NULL);
+    assert(node != NULL);
+
+    ib_queue_mpsc_node_t *prev;
+
+    do {
+        prev = queue->head;
+        node->next = prev;
+    } while (! __sync_bool_compare_and_swap(&queue->head, prev, node));
+    __sync_fetch_and_add(&queue->depth, 1);
+
+    return prev == NULL;
+}
+
+ib_queue_mpsc_node_t *ib_queue_mpsc_drain(ib_queue_mpsc_t *queue)
+{
+    assert(queue != NULL);
+
+    /* Take the whole list in one atomic exchange; every node now
+     * belongs to this (single) consumer. */
+    ib_queue_mpsc_node_t *node = __sync_lock_test_and_set(&queue->head, NULL);
+
+    /* The list is newest first; reverse it so the caller sees
+     * submission order. */
+    ib_queue_mpsc_node_t *reversed = NULL;
+    size_t                n        = 0;
+    while (node != NULL) {
+        ib_queue_mpsc_node_t *next = node->next;
+        node->next = reversed;
+        reversed   = node;
+        node       = next;
+        ++n;
+    }
+
+    if (n > 0) {
+        __sync_fetch_and_sub(&queue->depth, n);
+    }
+
+    return reversed;
+}
+
+size_t ib_queue_mpsc_depth(const ib_queue_mpsc_t *queue)
+{
+    assert(queue != NULL);
+
+    return queue->depth;
+}
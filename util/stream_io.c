@@ -44,7 +44,14 @@ struct ib_stream_io_tx_t {
 };
 
 struct ib_stream_io_data_t {
-    ib_mpool_freeable_segment_t *segment; /**< Memory backing. */
+    /**
+     * Memory backing.
+     *
+     * NULL when the data aliases caller-owned memory (see
+     * ib_stream_io_tx_data_alias_add()); reference counting is a no-op
+     * for such data and the caller guarantees the buffer's lifetime.
+     */
+    ib_mpool_freeable_segment_t *segment;
     uint8_t                     *ptr;     /**< Pointer into segment. */
     size_t                       len;     /**< The length in bytes. */
     ib_stream_io_type_t          type;    /**< Type of data this is. */
@@ -153,6 +160,40 @@ ib_status_t ib_stream_io_tx_data_add(
     return IB_OK;
 }
 
+ib_status_t ib_stream_io_tx_data_alias_add(
+    ib_stream_io_tx_t *io_tx,
+    const uint8_t     *data,
+    size_t             len
+)
+{
+    assert(io_tx != NULL);
+    assert((data != NULL && len > 0) || (len == 0));
+
+    ib_status_t          rc;
+    ib_stream_io_data_t *stream_data;
+
+    /* Only the node is allocated; the buffer stays with the caller. */
+    stream_data = (ib_stream_io_data_t *)ib_mpool_freeable_alloc(
+        io_tx->io->mp,
+        sizeof(*stream_data)
+    );
+    if (stream_data == NULL) {
+        return IB_EALLOC;
+    }
+
+    stream_data->segment = NULL;
+    stream_data->ptr     = (uint8_t *)data;
+    stream_data->len     = len;
+    stream_data->type    = IB_STREAM_IO_DATA;
+
+    rc = ib_queue_enqueue(io_tx->input, stream_data);
+    if (rc != IB_OK) {
+        return rc;
+    }
+
+    return IB_OK;
+}
+
 ib_status_t ib_stream_io_tx_flush_add(
     ib_stream_io_tx_t *io_tx
 )
@@ -604,10 +645,13 @@ ib_status_t DLL_PUBLIC ib_stream_io_data_slice(
         return IB_EALLOC;
     }
 
-    /* Increase the references to the segment. */
-    rc = ib_mpool_freeable_segment_ref(mp, src->segment);
-    if (rc != IB_OK) {
-        return rc;
+    /* Increase the references to the segment.  Slices of aliased data
+     * alias the same caller-owned memory. */
+    if (src->segment != NULL) {
+        rc = ib_mpool_freeable_segment_ref(mp, src->segment);
+        if (rc != IB_OK) {
+            return rc;
+        }
     }
 
     d->segment = src->segment;
@@ -677,6 +721,11 @@ void ib_stream_io_data_ref(
 
     ib_mpool_freeable_t *mp = io_tx->io->mp;
 
+    /* Aliased data is owned by the caller; nothing to count. */
+    if (data->segment == NULL) {
+        return;
+    }
+
     ib_mpool_freeable_segment_ref(mp, data->segment);
 }
 
@@ -691,6 +740,11 @@ void ib_stream_io_data_unref(
 
     ib_mpool_freeable_t *mp = io_tx->io->mp;
 
+    /* Aliased data is owned by the caller; nothing to count. */
+    if (data->segment == NULL) {
+        return;
+    }
+
     ib_mpool_freeable_segment_free(mp, data->segment);
 }
 
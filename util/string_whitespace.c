@@ -28,53 +28,62 @@
 
 #include <assert.h>
 #include <ctype.h>
+#include <string.h>
 
 /**
- * Count the total whitespace and number of whitespace regions.
+ * True iff any byte of @a w is less than 0x21.
  *
- * @param[in] data String.
- * @param[in] dlen Length of @a s.
- * @param[out] spaces Number of whitespace characters.
- * @param[out] regions Number of whitespace regions.
+ * Every whitespace byte is below 0x21, so words failing this test can be
+ * copied wholesale.  The standard SWAR has-less test; bytes with the
+ * high bit set are never flagged, which is correct as none are
+ * whitespace.
+ *
+ * @param[in] w Eight input bytes.
+ * @returns true if a byte below 0x21 may be present.
  **/
-void count_ws(
-    const uint8_t *data,
-    size_t         dlen,
-    size_t        *spaces,
-    size_t        *regions
-)
+static bool word_may_have_ws(uint64_t w)
 {
-    assert(data != NULL);
-
-    size_t local_spaces = 0;
-    size_t local_regions = 0;
-    local_spaces = 0;
-    local_regions = 0;
-    bool last_char_is_space = false;
-
-    for (size_t i = 0; i < dlen; ++i) {
-        uint8_t c = data[i];
+    return (((w - UINT64_C(0x2121212121212121)) & ~w) &
+            UINT64_C(0x8080808080808080)) != 0;
+}
 
-        if (isspace(c)) {
-            ++local_spaces;
-            if (! last_char_is_space) {
-                ++local_regions;
+/**
+ * Index of the next whitespace byte at or after @a i.
+ *
+ * Words without whitespace candidates are skipped eight bytes at a
+ * time.
+ *
+ * @param[in] data String.
+ * @param[in] dlen Length of @a data.
+ * @param[in] i    Index to start at.
+ * @returns Index of the next whitespace byte or @a dlen.
+ **/
+static size_t find_next_ws(const uint8_t *data, size_t dlen, size_t i)
+{
+    while (i < dlen) {
+        if (i + 8 <= dlen) {
+            uint64_t w;
+            memcpy(&w, data + i, sizeof(w));
+            if (! word_may_have_ws(w)) {
+                i += 8;
+                continue;
             }
-            last_char_is_space = true;
-        }
-        else {
-            last_char_is_space = false;
         }
-    }
 
-    if (spaces != NULL) {
-        *spaces = local_spaces;
-    }
-    if (regions != NULL) {
-        *regions = local_regions;
+        /* Scalar check of up to eight candidate bytes. */
+        {
+            size_t stop = (i + 8 < dlen) ? i + 8 : dlen;
+            for (; i < stop; ++i) {
+                if (isspace(data[i])) {
+                    return i;
+                }
+            }
+        }
     }
+    return dlen;
 }
 
+
 ib_status_t ib_str_whitespace_remove(
     ib_mm_t         mm,
     const uint8_t  *data_in,
@@ -87,27 +96,32 @@ ib_status_t ib_str_whitespace_remove(
     assert(data_out != NULL);
     assert(dlen_out != NULL);
 
-    size_t spaces = 0;
     uint8_t *buf;
     uint8_t *cur;
+    size_t   i = 0;
 
-    count_ws(data_in, dlen_in, &spaces, NULL);
-    buf = ib_mm_alloc(mm, dlen_in - spaces);
+    /* One pass: clean spans are block copied; sizing for the worst case
+     * trades a counting pass for a little pool slack. */
+    buf = ib_mm_alloc(mm, dlen_in);
     if (buf == NULL) {
         return IB_EALLOC;
     }
 
     cur = buf;
-    for (size_t i = 0; i < dlen_in; ++i) {
-        uint8_t c = data_in[i];
-        if (! isspace(c)) {
-            *cur = c;
-            ++cur;
+    while (i < dlen_in) {
+        size_t span_end = find_next_ws(data_in, dlen_in, i);
+
+        memcpy(cur, data_in + i, span_end - i);
+        cur += span_end - i;
+        i = span_end;
+
+        while (i < dlen_in && isspace(data_in[i])) {
+            ++i;
         }
     }
 
     *data_out = buf;
-    *dlen_out = dlen_in - spaces;
+    *dlen_out = cur - buf;
 
     return IB_OK;
 }
@@ -124,31 +138,37 @@ ib_status_t ib_str_whitespace_compress(
     assert(data_out != NULL);
     assert(dlen_out != NULL);
 
-    size_t spaces = 0;
-    size_t regions = 0;
     uint8_t *buf;
     uint8_t *cur;
-    bool last_char_is_space = false;
+    size_t   i = 0;
 
-    count_ws(data_in, dlen_in, &spaces, &regions);
-    buf = ib_mm_alloc(mm, dlen_in - spaces + regions);
+    /* One pass: clean spans are block copied and each whitespace region
+     * contributes its first character, as before.  Sizing for the worst
+     * case trades a counting pass for a little pool slack. */
+    buf = ib_mm_alloc(mm, dlen_in);
     if (buf == NULL) {
         return IB_EALLOC;
     }
 
     cur = buf;
-    for (size_t i = 0; i < dlen_in; ++i) {
-        uint8_t c = data_in[i];
-        if (! isspace(c) || ! last_char_is_space) {
-            *cur = c;
+    while (i < dlen_in) {
+        size_t span_end = find_next_ws(data_in, dlen_in, i);
+
+        memcpy(cur, data_in + i, span_end - i);
+        cur += span_end - i;
+        i = span_end;
+
+        if (i < dlen_in) {
+            *cur = data_in[i];
             ++cur;
+            while (i < dlen_in && isspace(data_in[i])) {
+                ++i;
+            }
         }
-
-        last_char_is_space = isspace(c);
     }
 
     *data_out = buf;
-    *dlen_out = dlen_in - spaces + regions;
+    *dlen_out = cur - buf;
 
     return IB_OK;
 }
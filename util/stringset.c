@@ -110,31 +110,57 @@ ib_status_t ib_stringset_query(
 
     ib_stringset_entry_t key = {string, string_length, NULL};
 
-    /* Based on C++ std::upper_bound() */
-    size_t len = set->num_entries;
-    size_t first = 0;
-
-    while (len > 0) {
-        size_t half = len >> 1;
-        size_t middle = first + half;
+    /* Longest prefix by iterative shortening: find the predecessor of
+     * the key; if it is a prefix, it is the longest one present.
+     * Otherwise no prefix longer than the common prefix of key and
+     * predecessor can exist, so shorten the key to that and search
+     * again.  This finds prefixes hidden behind sibling entries (e.g.
+     * "a" for the query "ac" in the set {"a", "ab"}), which a single
+     * predecessor check misses. */
+    for (;;) {
+        /* Based on C++ std::upper_bound() */
+        size_t len = set->num_entries;
+        size_t first = 0;
+        const ib_stringset_entry_t *pred;
+        size_t common;
+        size_t min_len;
+
+        while (len > 0) {
+            size_t half = len >> 1;
+            size_t middle = first + half;
+
+            if (less(&key, &set->entries[middle])) {
+                len = half;
+            }
+            else {
+                first = middle + 1;
+                len = len - half - 1;
+            }
+        }
 
-        if (less(&key, &set->entries[middle])) {
-            len = half;
+        /* At this point, first is the first element greater than key. */
+        if (first == 0) {
+            return IB_ENOENT;
         }
-        else {
-            first = middle + 1;
-            len = len - half - 1;
+
+        pred = &set->entries[first - 1];
+        if (is_prefix(pred, &key)) {
+            if (out_entry != NULL) {
+                *out_entry = pred;
+            }
+            return IB_OK;
         }
-    }
 
-    /* At this point, first is the first element greater than key. */
-    if (first != 0 && is_prefix(&set->entries[first - 1], &key)) {
-        if (out_entry != NULL) {
-            *out_entry = &set->entries[first - 1];
+        /* Shorten the key to the common prefix with the predecessor. */
+        min_len = pred->length < key.length ? pred->length : key.length;
+        for (common = 0; common < min_len; ++common) {
+            if (pred->string[common] != key.string[common]) {
+                break;
+            }
         }
-        return IB_OK;
-    }
-    else {
-        return IB_ENOENT;
+        if (common == 0) {
+            return IB_ENOENT;
+        }
+        key.length = common;
     }
 }
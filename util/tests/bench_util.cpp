@@ -0,0 +1,240 @@
+/*****************************************************************************
+ * Licensed to Qualys, Inc. (QUALYS) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * QUALYS licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+/**
+ * @file
+ * @brief IronBee --- Utility Microbenchmarks
+ *
+ * Microbenchmarks for the hot utility primitives: hash, list, mpool,
+ * ipset, string transformations and decoding.  Build with `make bench`
+ * (not part of `make check`); each benchmark reports nanoseconds per
+ * operation to stdout.  Numbers are for comparing changes on one
+ * machine, not across machines.
+ *
+ * @author Christopher Alfeld <calfeld@qualys.com>
+ */
+
+#include <ironbee/decode.h>
+#include <ironbee/hash.h>
+#include <ironbee/ipset.h>
+#include <ironbee/list.h>
+#include <ironbee/mm_mpool.h>
+#include <ironbee/mpool.h>
+#include <ironbee/string_lower.h>
+#include <ironbee/string_whitespace.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace {
+
+//! Monotonic time in nanoseconds.
+uint64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+//! Report @a total_ns over @a ops as one line.
+void report(const char* name, uint64_t total_ns, uint64_t ops)
+{
+    printf("%-28s %10.1f ns/op  (%llu ops)\n",
+           name,
+           double(total_ns) / double(ops),
+           (unsigned long long)ops);
+}
+
+//! Deterministic pseudo-random generator for reproducible inputs.
+uint32_t prng(uint32_t& state)
+{
+    state = state * 1664525u + 1013904223u;
+    return state;
+}
+
+void bench_hash()
+{
+    const size_t c_keys = 1000;
+    const uint64_t c_rounds = 1000;
+    ib_mpool_t* mp;
+    ib_mpool_create(&mp, "bench", NULL);
+    ib_mm_t mm = ib_mm_mpool(mp);
+
+    std::vector<std::string> keys;
+    uint32_t state = 42;
+    for (size_t i = 0; i < c_keys; ++i) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "Key-%u-%zd", prng(state), i);
+        keys.push_back(buf);
+    }
+
+    ib_hash_t* hash;
+    ib_hash_create(&hash, mm);
+    for (size_t i = 0; i < c_keys; ++i) {
+        ib_hash_set(hash, keys[i].c_str(), (void*)&keys[i]);
+    }
+
+    uint64_t start = now_ns();
+    size_t found = 0;
+    for (uint64_t r = 0; r < c_rounds; ++r) {
+        for (size_t i = 0; i < c_keys; ++i) {
+            void* v;
+            if (ib_hash_get(hash, &v, keys[i].c_str()) == IB_OK) {
+                ++found;
+            }
+        }
+    }
+    report("hash_get", now_ns() - start, c_rounds * c_keys);
+    if (found != c_rounds * c_keys) {
+        printf("hash_get MISSES: %zd\n", c_rounds * c_keys - found);
+    }
+
+    ib_mpool_destroy(mp);
+}
+
+void bench_list()
+{
+    const uint64_t c_rounds = 10000;
+    const size_t c_items = 100;
+    ib_mpool_t* mp;
+    ib_mpool_create(&mp, "bench", NULL);
+    ib_mm_t mm = ib_mm_mpool(mp);
+
+    ib_list_t* list;
+    ib_list_create(&list, mm);
+
+    uint64_t start = now_ns();
+    for (uint64_t r = 0; r < c_rounds; ++r) {
+        for (size_t i = 0; i < c_items; ++i) {
+            ib_list_push(list, (void*)&c_items);
+        }
+        ib_list_clear(list);
+    }
+    report("list_push_clear", now_ns() - start, c_rounds * c_items);
+
+    ib_mpool_destroy(mp);
+}
+
+void bench_mpool()
+{
+    const uint64_t c_rounds = 1000;
+    const size_t c_allocs = 1000;
+
+    uint64_t start = now_ns();
+    for (uint64_t r = 0; r < c_rounds; ++r) {
+        ib_mpool_t* mp;
+        ib_mpool_create(&mp, "bench", NULL);
+        for (size_t i = 0; i < c_allocs; ++i) {
+            void* p = ib_mpool_alloc(mp, 16 + (i % 6) * 24);
+            if (p == NULL) {
+                printf("mpool_alloc FAILED\n");
+                return;
+            }
+        }
+        ib_mpool_destroy(mp);
+    }
+    report("mpool_small_alloc", now_ns() - start, c_rounds * c_allocs);
+}
+
+void bench_ipset()
+{
+    const size_t c_entries = 512;
+    const uint64_t c_queries = 1000000;
+
+    std::vector<ib_ipset4_entry_t> entries(c_entries);
+    uint32_t state = 7;
+    for (size_t i = 0; i < c_entries; ++i) {
+        entries[i].network.ip = prng(state);
+        entries[i].network.size = 8 + prng(state) % 25;
+        entries[i].data = NULL;
+    }
+    ib_ipset4_t set;
+    ib_ipset4_init(&set, NULL, 0, &entries[0], c_entries);
+
+    uint64_t start = now_ns();
+    size_t hits = 0;
+    for (uint64_t q = 0; q < c_queries; ++q) {
+        const ib_ipset4_entry_t* e;
+        if (ib_ipset4_query(&set, prng(state), &e, NULL, NULL) == IB_OK) {
+            ++hits;
+        }
+    }
+    report("ipset4_query", now_ns() - start, c_queries);
+    printf("  (hit rate %.1f%%)\n", 100.0 * double(hits) / double(c_queries));
+}
+
+void bench_strings()
+{
+    const uint64_t c_rounds = 200000;
+    ib_mpool_t* mp;
+    ib_mpool_create(&mp, "bench", NULL);
+    ib_mm_t mm = ib_mm_mpool(mp);
+
+    const char c_input[] =
+        "GET /Some/Path/With/MIXED/case%20and+Encodings HTTP/1.1  extra";
+    const size_t c_len = sizeof(c_input) - 1;
+
+    uint64_t start = now_ns();
+    for (uint64_t r = 0; r < c_rounds; ++r) {
+        uint8_t* out;
+        ib_strlower(mm, (const uint8_t*)c_input, c_len, &out);
+        if ((r & 0x3ff) == 0) {
+            ib_mpool_clear(mp);
+        }
+    }
+    report("strlower", now_ns() - start, c_rounds * c_len);
+    ib_mpool_clear(mp);
+
+    start = now_ns();
+    for (uint64_t r = 0; r < c_rounds; ++r) {
+        uint8_t out[sizeof(c_input)];
+        size_t out_len;
+        ib_util_decode_url(
+            (const uint8_t*)c_input, c_len, out, &out_len);
+    }
+    report("decode_url", now_ns() - start, c_rounds * c_len);
+
+    start = now_ns();
+    for (uint64_t r = 0; r < c_rounds; ++r) {
+        uint8_t* out;
+        size_t out_len;
+        ib_str_whitespace_remove(
+            mm, (const uint8_t*)c_input, c_len, &out, &out_len);
+        if ((r & 0x3ff) == 0) {
+            ib_mpool_clear(mp);
+        }
+    }
+    report("whitespace_remove", now_ns() - start, c_rounds * c_len);
+
+    ib_mpool_destroy(mp);
+}
+
+} // Anonymous
+
+int main()
+{
+    bench_hash();
+    bench_list();
+    bench_mpool();
+    bench_ipset();
+    bench_strings();
+    return 0;
+}
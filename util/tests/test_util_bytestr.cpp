@@ -128,6 +128,64 @@ TEST_F(TestIBUtilByteStr, test_bytestr_alias_nulstr)
     ASSERT_EQ(IB_EINVAL, rc);
 }
 
+/// @test Test util bytestr library - ib_bytestr_reserve()/commit()
+TEST_F(TestIBUtilByteStr, test_bytestr_reserve_commit)
+{
+    ib_bytestr_t *bs;
+    ib_status_t rc;
+    uint8_t *space;
+    const uint8_t *before;
+
+    rc = ib_bytestr_dup_nulstr(&bs, MM(), "abc");
+    ASSERT_EQ(IB_OK, rc);
+
+    /* Write directly into reserved space, then commit it. */
+    rc = ib_bytestr_reserve(bs, 3, &space);
+    ASSERT_EQ(IB_OK, rc);
+    memcpy(space, "def", 3);
+    rc = ib_bytestr_commit(bs, 3);
+    ASSERT_EQ(IB_OK, rc);
+    ASSERT_EQ(6UL, ib_bytestr_length(bs));
+    ASSERT_EQ(
+        0, strncmp("abcdef", (char *)ib_bytestr_const_ptr(bs), 6));
+
+    /* Growth is geometric, so after one oversized reservation a
+     * following small one fits in place, without reallocation. */
+    rc = ib_bytestr_reserve(bs, 10, &space);
+    ASSERT_EQ(IB_OK, rc);
+    memcpy(space, "g", 1);
+    rc = ib_bytestr_commit(bs, 1);
+    ASSERT_EQ(IB_OK, rc);
+    ASSERT_EQ(7UL, ib_bytestr_length(bs));
+
+    before = ib_bytestr_const_ptr(bs);
+    rc = ib_bytestr_reserve(bs, 2, &space);
+    ASSERT_EQ(IB_OK, rc);
+    ASSERT_EQ(before + 7, space);
+
+    /* Committing more than the remaining space is rejected. */
+    rc = ib_bytestr_commit(bs, ib_bytestr_size(bs));
+    ASSERT_EQ(IB_EINVAL, rc);
+    ASSERT_EQ(7UL, ib_bytestr_length(bs));
+}
+
+/// @test Test util bytestr library - reserve on a read-only bytestr
+TEST_F(TestIBUtilByteStr, test_bytestr_reserve_readonly)
+{
+    ib_bytestr_t *bs;
+    ib_status_t rc;
+    uint8_t *space;
+    uint8_t data[] = { 'a', 'b', 'c' };
+
+    rc = ib_bytestr_alias_mem(&bs, MM(), data, sizeof(data));
+    ASSERT_EQ(IB_OK, rc);
+
+    rc = ib_bytestr_reserve(bs, 1, &space);
+    ASSERT_EQ(IB_EINVAL, rc);
+    rc = ib_bytestr_commit(bs, 1);
+    ASSERT_EQ(IB_EINVAL, rc);
+}
+
 /// @test Test util bytestr library - ib_bytestr_append_*()
 TEST_F(TestIBUtilByteStr, test_bytestr_append)
 {
@@ -160,7 +218,9 @@ TEST_F(TestIBUtilByteStr, test_bytestr_append)
     ASSERT_EQ(IB_OK, rc);
     ASSERT_TRUE(bs1);
     ASSERT_EQ(12UL, ib_bytestr_length(bs1));
-    ASSERT_EQ(12UL, ib_bytestr_size(bs1));
+    /* Appends grow capacity geometrically; it at least covers the
+     * length but need not match it. */
+    ASSERT_LE(12UL, ib_bytestr_size(bs1));
     ptr = ib_bytestr_const_ptr(bs1);
     ASSERT_EQ(0, strncmp("abcdefghijkl", (char *)ptr, 12));
 
@@ -168,7 +228,9 @@ TEST_F(TestIBUtilByteStr, test_bytestr_append)
     ASSERT_EQ(IB_OK, rc);
     ASSERT_TRUE(bs1);
     ASSERT_EQ(15UL, ib_bytestr_length(bs1));
-    ASSERT_EQ(15UL, ib_bytestr_size(bs1));
+    /* Appends grow capacity geometrically; it at least covers the
+     * length but need not match it. */
+    ASSERT_LE(15UL, ib_bytestr_size(bs1));
     ptr = ib_bytestr_const_ptr(bs1);
     ASSERT_EQ(0, strncmp("abcdefghijklfoo", (char *)ptr, 15));
 
@@ -176,7 +238,9 @@ TEST_F(TestIBUtilByteStr, test_bytestr_append)
     ASSERT_EQ(IB_OK, rc);
     ASSERT_TRUE(bs1);
     ASSERT_EQ(18UL, ib_bytestr_length(bs1));
-    ASSERT_EQ(18UL, ib_bytestr_size(bs1));
+    /* Appends grow capacity geometrically; it at least covers the
+     * length but need not match it. */
+    ASSERT_LE(18UL, ib_bytestr_size(bs1));
     ptr = ib_bytestr_const_ptr(bs1);
     ASSERT_EQ(0, strncmp("abcdefghijklfoobar", (char *)ptr, 18));
 }
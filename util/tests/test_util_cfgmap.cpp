@@ -134,6 +134,39 @@ TEST_F(TestIBUtilCfgMap, test_get)
     ASSERT_EQ(n, m_config.num1);
 }
 
+TEST_F(TestIBUtilCfgMap, test_accessor)
+{
+    ib_status_t rc;
+    ib_cfgmap_accessor_t acc;
+    const char *s;
+    ib_num_t n;
+
+    rc = ib_cfgmap_accessor(m_cfgmap, "xyzzy", &acc);
+    ASSERT_EQ(IB_ENOENT, rc);
+
+    rc = ib_cfgmap_accessor(m_cfgmap, "num1", &acc);
+    ASSERT_EQ(IB_OK, rc);
+
+    m_config.num1 = 1234;
+    rc = ib_cfgmap_accessor_get(&acc, ib_ftype_num_out(&n));
+    ASSERT_EQ(IB_OK, rc);
+    ASSERT_EQ(m_config.num1, n);
+
+    // The accessor tracks the live value, no re-resolution needed.
+    m_config.num1 = 5678;
+    rc = ib_cfgmap_accessor_get(&acc, ib_ftype_num_out(&n));
+    ASSERT_EQ(IB_OK, rc);
+    ASSERT_EQ(m_config.num1, n);
+
+    rc = ib_cfgmap_accessor(m_cfgmap, "str1", &acc);
+    ASSERT_EQ(IB_OK, rc);
+
+    m_config.str1 = "abc";
+    rc = ib_cfgmap_accessor_get(&acc, ib_ftype_nulstr_out(&s));
+    ASSERT_EQ(IB_OK, rc);
+    ASSERT_EQ(m_config.str1, s);
+}
+
 TEST_F(TestIBUtilCfgMap, test_set)
 {
     ib_status_t rc;
@@ -691,3 +691,78 @@ TEST_F(TestIBUtilField, AliasConvert)
     ASSERT_EQ(IB_OK, rc);
     ASSERT_FLOAT_EQ(1.1, flt);
 }
+
+namespace {
+
+//! Counts invocations of the memoized getter.
+extern "C" ib_status_t memo_get_fn(
+    const ib_field_t *f,
+    void             *out_val,
+    const void       *arg,
+    size_t            alen,
+    void             *cbdata
+)
+{
+    int *calls = static_cast<int *>(cbdata);
+    ++*calls;
+    *reinterpret_cast<ib_num_t *>(out_val) = 17;
+    return IB_OK;
+}
+
+}
+
+TEST_F(TestIBUtilField, Memoize)
+{
+    ib_field_t *f;
+    ib_status_t rc;
+    ib_num_t n = 0;
+    int calls = 0;
+    uint64_t generation = 1;
+
+    rc = ib_field_create_dynamic(
+        &f, MM(), IB_S2SL("dyn"), IB_FTYPE_NUM,
+        memo_get_fn, &calls,
+        NULL, NULL);
+    ASSERT_EQ(IB_OK, rc);
+
+    ib_field_memoize(f, &generation);
+
+    ASSERT_EQ(IB_OK, ib_field_value(f, ib_ftype_num_out(&n)));
+    ASSERT_EQ(17, n);
+    ASSERT_EQ(1, calls);
+
+    // Second get served from the memo.
+    n = 0;
+    ASSERT_EQ(IB_OK, ib_field_value(f, ib_ftype_num_out(&n)));
+    ASSERT_EQ(17, n);
+    ASSERT_EQ(1, calls);
+
+    // Generation change re-materializes.
+    ++generation;
+    ASSERT_EQ(IB_OK, ib_field_value(f, ib_ftype_num_out(&n)));
+    ASSERT_EQ(17, n);
+    ASSERT_EQ(2, calls);
+}
+
+TEST_F(TestIBUtilField, SetvClearsTfnMemo)
+{
+    ib_field_t *f;
+    ib_status_t rc;
+    ib_num_t n = 5;
+
+    rc = ib_field_create(
+        &f, MM(), IB_S2SL("num"), IB_FTYPE_NUM, ib_ftype_num_in(&n));
+    ASSERT_EQ(IB_OK, rc);
+
+    // Simulate a memoized transformation result, then mutate in place.
+    f->tfn_memo = &n;
+    n = 6;
+    ASSERT_EQ(IB_OK, ib_field_setv(f, ib_ftype_num_in(&n)));
+    EXPECT_EQ(NULL, f->tfn_memo);
+
+    f->tfn_memo = &n;
+    ib_num_t *mutable_n;
+    ASSERT_EQ(IB_OK,
+        ib_field_mutable_value(f, ib_ftype_num_mutable_out(&mutable_n)));
+    EXPECT_EQ(NULL, f->tfn_memo);
+}
@@ -94,6 +94,36 @@ TEST(TestMM, MMMpool)
     EXPECT_TRUE(cleanup_data);
 }
 
+TEST(TestMM, Counted)
+{
+    ib_mpool_t* mp;
+    ib_status_t rc;
+    ib_mm_t mm;
+    ib_mm_t counted;
+    ib_mm_alloc_count_t count = {0, 0};
+
+    rc = ib_mpool_create(&mp, "", NULL);
+    ASSERT_EQ(IB_OK, rc);
+    mm = ib_mm_mpool(mp);
+
+    rc = ib_mm_counted(mm, &count, &counted);
+    ASSERT_EQ(IB_OK, rc);
+
+    void* p = ib_mm_alloc(counted, 100);
+    EXPECT_TRUE(p);
+    p = ib_mm_alloc(counted, 23);
+    EXPECT_TRUE(p);
+    EXPECT_EQ(2UL, count.allocations);
+    EXPECT_EQ(123UL, count.bytes);
+
+    bool cleanup_data = false;
+    rc = ib_mm_register_cleanup(counted, cleanup, &cleanup_data);
+    EXPECT_EQ(IB_OK, rc);
+
+    ib_mpool_destroy(mp);
+    EXPECT_TRUE(cleanup_data);
+}
+
 TEST(TestMM, Helpers)
 {
     ib_mpool_t* mp;
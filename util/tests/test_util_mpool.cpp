@@ -189,6 +189,38 @@ TEST(TestMpool, OneThousandAllocs)
     ASSERT_EQ(g_malloc_bytes, g_free_bytes);
 }
 
+TEST(TestMpool, UsageReport)
+{
+    reset_test();
+
+    ib_mpool_t* mp = NULL;
+    ib_status_t rc =
+        ib_mpool_create_ex(&mp, "root", NULL, 0, &test_malloc, &test_free);
+    ASSERT_EQ(IB_OK, rc);
+    ASSERT_TRUE(mp);
+
+    ib_mpool_t* child = NULL;
+    rc = ib_mpool_create(&child, "child", mp);
+    ASSERT_EQ(IB_OK, rc);
+    EXPECT_TRUE(ib_mpool_alloc(child, 100));
+    EXPECT_VALID(mp);
+
+    char* output = ib_mpool_usage_report(mp, 5);
+    ASSERT_TRUE(output);
+    EXPECT_NE(string::npos, string(output).find("root"));
+    EXPECT_NE(string::npos, string(output).find("child"));
+    EXPECT_NE(string::npos, string(output).find("Top consumers:"));
+    free(output);
+
+    // Without a top-consumer section.
+    output = ib_mpool_usage_report(mp, 0);
+    ASSERT_TRUE(output);
+    EXPECT_EQ(string::npos, string(output).find("Top consumers:"));
+    free(output);
+
+    ib_mpool_destroy(mp);
+}
+
 TEST(TestMpool, Clear)
 {
     reset_test();
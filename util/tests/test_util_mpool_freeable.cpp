@@ -258,4 +258,58 @@ TEST(MpoolFreeable, ManySmallAllocs) {
     }
 
     ib_mpool_freeable_destroy(mp);
-}
\ No newline at end of file
+}
+TEST(MpoolFreeable, StatsAndCompact) {
+    ib_mpool_freeable_t *mp;
+    ib_mpool_freeable_class_stats_t classes[IB_MPOOL_FREEABLE_NUM_TRACKS];
+    size_t n_classes = 0;
+    size_t segment_bytes = 0;
+    size_t segment_count = 0;
+
+    ASSERT_EQ(IB_OK, ib_mpool_freeable_create(&mp));
+
+    void *small = ib_mpool_freeable_alloc(mp, 100);
+    ASSERT_TRUE(small != NULL);
+    void *large = ib_mpool_freeable_alloc(mp, 1024 * 1024);
+    ASSERT_TRUE(large != NULL);
+
+    ASSERT_EQ(IB_OK, ib_mpool_freeable_stats(
+        mp, classes, &n_classes, &segment_bytes, &segment_count));
+    ASSERT_EQ((size_t)IB_MPOOL_FREEABLE_NUM_TRACKS, n_classes);
+    ASSERT_EQ(1UL, segment_count);
+    ASSERT_EQ(1024UL * 1024UL, segment_bytes);
+
+    size_t total_refs = 0;
+    size_t total_pages = 0;
+    for (size_t i = 0; i < n_classes; ++i) {
+        total_refs += classes[i].references;
+        total_pages += classes[i].pages;
+    }
+    ASSERT_EQ(1UL, total_refs);
+    ASSERT_EQ(1UL, total_pages);
+
+    // After compact, a same-class allocation lands on a fresh page.
+    ASSERT_EQ(IB_OK, ib_mpool_freeable_compact(mp));
+    void *small2 = ib_mpool_freeable_alloc(mp, 100);
+    ASSERT_TRUE(small2 != NULL);
+
+    ASSERT_EQ(IB_OK, ib_mpool_freeable_stats(
+        mp, classes, &n_classes, &segment_bytes, &segment_count));
+    total_pages = 0;
+    for (size_t i = 0; i < n_classes; ++i) {
+        total_pages += classes[i].pages;
+    }
+    ASSERT_EQ(2UL, total_pages);
+
+    // Freeing the old allocation releases its (closed) page.
+    ib_mpool_freeable_free(mp, small);
+    ASSERT_EQ(IB_OK, ib_mpool_freeable_stats(
+        mp, classes, &n_classes, &segment_bytes, &segment_count));
+    total_pages = 0;
+    for (size_t i = 0; i < n_classes; ++i) {
+        total_pages += classes[i].pages;
+    }
+    ASSERT_EQ(1UL, total_pages);
+
+    ib_mpool_freeable_destroy(mp);
+}
@@ -0,0 +1,123 @@
+//////////////////////////////////////////////////////////////////////////////
+// Licensed to Qualys, Inc. (QUALYS) under one or more
+// contributor license agreements.  See the NOTICE file distributed with
+// this work for additional information regarding copyright ownership.
+// QUALYS licenses this file to You under the Apache License, Version 2.0
+// (the "License"); you may not use this file except in compliance with
+// the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief IronBee --- MPSC Queue Test Functions
+//////////////////////////////////////////////////////////////////////////////
+#include "ironbee_config_auto.h"
+
+#include <ironbee/queue_mpsc.h>
+
+#include "gtest/gtest.h"
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <vector>
+
+namespace {
+
+//! A record with the queue node embedded first.
+struct record_t {
+    ib_queue_mpsc_node_t node;
+    long                 value;
+};
+
+//! Push @a count records tagged with @a producer into @a queue.
+void produce(ib_queue_mpsc_t *queue, long producer, long count)
+{
+    for (long i = 0; i < count; ++i) {
+        record_t *rec = new record_t;
+        rec->value = producer * count + i;
+        ib_queue_mpsc_push(queue, &rec->node);
+    }
+}
+
+}
+
+TEST(QueueMpscTest, EmptyDrain)
+{
+    ib_queue_mpsc_t q;
+
+    ib_queue_mpsc_init(&q);
+    ASSERT_EQ(0UL, ib_queue_mpsc_depth(&q));
+    ASSERT_TRUE(ib_queue_mpsc_drain(&q) == NULL);
+}
+
+TEST(QueueMpscTest, FifoSingleThread)
+{
+    ib_queue_mpsc_t q;
+    record_t        recs[10];
+
+    ib_queue_mpsc_init(&q);
+    for (int i = 0; i < 10; ++i) {
+        recs[i].value = i;
+        ASSERT_EQ(i == 0, ib_queue_mpsc_push(&q, &recs[i].node));
+    }
+    ASSERT_EQ(10UL, ib_queue_mpsc_depth(&q));
+
+    ib_queue_mpsc_node_t *node = ib_queue_mpsc_drain(&q);
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(node != NULL);
+        ASSERT_EQ(i, reinterpret_cast<record_t *>(node)->value);
+        node = node->next;
+    }
+    ASSERT_TRUE(node == NULL);
+    ASSERT_EQ(0UL, ib_queue_mpsc_depth(&q));
+}
+
+TEST(QueueMpscTest, ConcurrentProducers)
+{
+    const long n_producers = 4;
+    const long n_records   = 10000;
+
+    ib_queue_mpsc_t q;
+    ib_queue_mpsc_init(&q);
+
+    boost::thread_group producers;
+    for (long p = 0; p < n_producers; ++p) {
+        producers.create_thread(boost::bind(produce, &q, p, n_records));
+    }
+
+    // Drain concurrently with production; every record must arrive
+    // exactly once and in per-producer submission order.
+    std::vector<bool> seen(n_producers * n_records, false);
+    std::vector<long> last(n_producers, -1);
+    long total = 0;
+    while (total < n_producers * n_records) {
+        ib_queue_mpsc_node_t *node = ib_queue_mpsc_drain(&q);
+        while (node != NULL) {
+            record_t *rec = reinterpret_cast<record_t *>(node);
+            node = node->next;
+
+            ASSERT_FALSE(seen[rec->value]);
+            seen[rec->value] = true;
+
+            long producer = rec->value / n_records;
+            long i        = rec->value % n_records;
+            ASSERT_LT(last[producer], i);
+            last[producer] = i;
+
+            delete rec;
+            ++total;
+        }
+    }
+
+    producers.join_all();
+    ASSERT_EQ(0UL, ib_queue_mpsc_depth(&q));
+}
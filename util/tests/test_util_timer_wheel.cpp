@@ -0,0 +1,109 @@
+//////////////////////////////////////////////////////////////////////////////
+// Licensed to Qualys, Inc. (QUALYS) under one or more
+// contributor license agreements.  See the NOTICE file distributed with
+// this work for additional information regarding copyright ownership.
+// QUALYS licenses this file to You under the Apache License, Version 2.0
+// (the "License"); you may not use this file except in compliance with
+// the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief IronBee --- Timer Wheel Test Functions
+//////////////////////////////////////////////////////////////////////////////
+#include "ironbee_config_auto.h"
+#include "simple_fixture.hpp"
+
+#include <ironbee/timer_wheel.h>
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+namespace {
+
+//! Record of fired timer ids.
+std::vector<long> g_fired;
+
+extern "C" void record_cb(void *cbdata)
+{
+    g_fired.push_back(reinterpret_cast<intptr_t>(cbdata));
+}
+
+}
+
+class TimerWheelTest : public SimpleFixture {
+public:
+    virtual void SetUp()
+    {
+        SimpleFixture::SetUp();
+        g_fired.clear();
+        ASSERT_EQ(
+            IB_OK,
+            ib_timer_wheel_create(&m_wheel, MM(), 10, 1000));
+    }
+
+protected:
+    ib_timer_wheel_t *m_wheel;
+};
+
+TEST_F(TimerWheelTest, FireInOrder)
+{
+    ASSERT_EQ(IB_OK, ib_timer_wheel_schedule(
+        m_wheel, 100, record_cb, (void *)1, NULL));
+    ASSERT_EQ(IB_OK, ib_timer_wheel_schedule(
+        m_wheel, 50, record_cb, (void *)2, NULL));
+
+    // Nothing due yet.
+    ASSERT_EQ(0UL, ib_timer_wheel_advance(m_wheel, 1040));
+    ASSERT_TRUE(g_fired.empty());
+
+    // The 50us timer comes due first.
+    ASSERT_EQ(1UL, ib_timer_wheel_advance(m_wheel, 1060));
+    ASSERT_EQ(1UL, g_fired.size());
+    ASSERT_EQ(2L, g_fired[0]);
+
+    ASSERT_EQ(1UL, ib_timer_wheel_advance(m_wheel, 1200));
+    ASSERT_EQ(2UL, g_fired.size());
+    ASSERT_EQ(1L, g_fired[1]);
+}
+
+TEST_F(TimerWheelTest, Cancel)
+{
+    ib_timer_t *timer;
+
+    ASSERT_EQ(IB_OK, ib_timer_wheel_schedule(
+        m_wheel, 50, record_cb, (void *)1, &timer));
+    ib_timer_cancel(timer);
+
+    ASSERT_EQ(0UL, ib_timer_wheel_advance(m_wheel, 2000));
+    ASSERT_TRUE(g_fired.empty());
+}
+
+TEST_F(TimerWheelTest, Cascade)
+{
+    // 10000 ticks: past the first level, so the timer must cascade.
+    ASSERT_EQ(IB_OK, ib_timer_wheel_schedule(
+        m_wheel, 100000, record_cb, (void *)7, NULL));
+
+    ASSERT_EQ(0UL, ib_timer_wheel_advance(m_wheel, 1000 + 99990));
+    ASSERT_EQ(1UL, ib_timer_wheel_advance(m_wheel, 1000 + 100010));
+    ASSERT_EQ(1UL, g_fired.size());
+    ASSERT_EQ(7L, g_fired[0]);
+}
+
+TEST_F(TimerWheelTest, HorizonRejected)
+{
+    // Beyond 2^32 ticks.
+    ASSERT_EQ(IB_EINVAL, ib_timer_wheel_schedule(
+        m_wheel, (ib_time_t)50u * 1000000000u * 1000u,
+        record_cb, NULL, NULL));
+}
@@ -107,6 +107,37 @@ class VectorAppendFailsTest :
    public ::testing::WithParamInterface<size_t>
 { };
 
+TEST_F(VectorTest, ReserveCommit) {
+    void *space;
+
+    ASSERT_EQ(
+        IB_OK,
+        ib_vector_append(m_vector, "hi", 2));
+
+    /* Write directly into reserved space, then commit it. */
+    ASSERT_EQ(IB_OK, ib_vector_reserve(m_vector, 3, &space));
+    memcpy(space, "!?.", 3);
+    ASSERT_EQ(IB_OK, ib_vector_commit(m_vector, 3));
+    ASSERT_EQ(5U, m_vector->len);
+    ASSERT_EQ(
+        std::string("hi!?."),
+        std::string(reinterpret_cast<char *>(m_vector->data), 5)
+    );
+
+    /* Committing less than was reserved is fine... */
+    ASSERT_EQ(IB_OK, ib_vector_reserve(m_vector, 8, &space));
+    memcpy(space, "x", 1);
+    ASSERT_EQ(IB_OK, ib_vector_commit(m_vector, 1));
+    ASSERT_EQ(6U, m_vector->len);
+    ASSERT_EQ('x', reinterpret_cast<char *>(m_vector->data)[5]);
+
+    /* ... but committing past the remaining space is not. */
+    ASSERT_EQ(
+        IB_EINVAL,
+        ib_vector_commit(m_vector, m_vector->size - m_vector->len + 1));
+    ASSERT_EQ(6U, m_vector->len);
+}
+
 TEST_P(VectorAppendFailsTest, IB_EINVAL) {
     const char *c = "This buffer is never read.";
     ASSERT_EQ(IB_EINVAL, ib_vector_append(m_vector, c, GetParam()));
@@ -0,0 +1,282 @@
+/*****************************************************************************
+ * Licensed to Qualys, Inc. (QUALYS) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * QUALYS licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+/**
+ * @file
+ * @brief IronBee --- Hierarchical Timer Wheel Implementation
+ */
+
+#include "ironbee_config_auto.h"
+
+#include <ironbee/timer_wheel.h>
+
+#include <assert.h>
+#include <string.h>
+
+/** Slots per level; slot index is one byte of the expiry tick. */
+#define WHEEL_SLOTS 256
+
+/** Levels; together they cover 2^32 ticks. */
+#define WHEEL_LEVELS 4
+
+struct ib_timer_t {
+    ib_timer_t    *next;        /**< Next in slot (or free list). */
+    ib_timer_t    *prev;        /**< Previous in slot; NULL when free. */
+    ib_timer_t   **slot;        /**< Slot head; for O(1) unlink. */
+    uint64_t       expire_tick; /**< Absolute tick to fire at. */
+    ib_timer_fn_t  fn;          /**< Callback; NULL when spent. */
+    void          *cbdata;      /**< Callback data. */
+    ib_timer_wheel_t *wheel;    /**< Owning wheel, for recycling. */
+};
+
+struct ib_timer_wheel_t {
+    ib_mm_t     mm;           /**< Node allocations. */
+    ib_time_t   tick_usec;    /**< Microseconds per tick. */
+    ib_time_t   epoch;        /**< Time at creation; tick 0. */
+    uint64_t    current_tick; /**< Wheel's present. */
+    ib_timer_t *free_list;    /**< Recycled nodes. */
+
+    /** slots[level][index]: doubly linked timer lists. */
+    ib_timer_t *slots[WHEEL_LEVELS][WHEEL_SLOTS];
+};
+
+/**
+ * Insert @a timer into the slot appropriate for its expiry.
+ *
+ * The level is the highest byte in which the expiry differs from the
+ * wheel's present, so timers land as low as their proximity allows and
+ * cascade downward as time advances.
+ */
+static void wheel_place(ib_timer_wheel_t *wheel, ib_timer_t *timer)
+{
+    uint64_t delta = timer->expire_tick - wheel->current_tick;
+    int      level = 0;
+
+    while (level + 1 < WHEEL_LEVELS && delta >= ((uint64_t)1 << (8 * (level + 1)))) {
+        ++level;
+    }
+
+    {
+        size_t index =
+            (timer->expire_tick >> (8 * level)) & (WHEEL_SLOTS - 1);
+        ib_timer_t **slot = &wheel->slots[level][index];
+
+        timer->slot = slot;
+        timer->prev = NULL;
+        timer->next = *slot;
+        if (*slot != NULL) {
+            (*slot)->prev = timer;
+        }
+        *slot = timer;
+    }
+}
+
+/** Unlink @a timer from its slot. */
+static void wheel_unlink(ib_timer_t *timer)
+{
+    if (timer->prev != NULL) {
+        timer->prev->next = timer->next;
+    }
+    else if (timer->slot != NULL) {
+        *timer->slot = timer->next;
+    }
+    if (timer->next != NULL) {
+        timer->next->prev = timer->prev;
+    }
+    timer->next = NULL;
+    timer->prev = NULL;
+    timer->slot = NULL;
+}
+
+/** Return @a timer to the wheel's free list. */
+static void wheel_recycle(ib_timer_t *timer)
+{
+    timer->fn     = NULL;
+    timer->cbdata = NULL;
+    timer->prev   = NULL;
+    timer->slot   = NULL;
+    timer->next   = timer->wheel->free_list;
+    timer->wheel->free_list = timer;
+}
+
+ib_status_t ib_timer_wheel_create(
+    ib_timer_wheel_t **wheel,
+    ib_mm_t            mm,
+    ib_time_t          tick_usec,
+    ib_time_t          now
+)
+{
+    assert(wheel != NULL);
+
+    ib_timer_wheel_t *w;
+
+    if (tick_usec == 0) {
+        return IB_EINVAL;
+    }
+
+    w = (ib_timer_wheel_t *)ib_mm_calloc(mm, sizeof(*w), 1);
+    if (w == NULL) {
+        return IB_EALLOC;
+    }
+
+    w->mm           = mm;
+    w->tick_usec    = tick_usec;
+    w->epoch        = now;
+    w->current_tick = 0;
+
+    *wheel = w;
+    return IB_OK;
+}
+
+ib_status_t ib_timer_wheel_schedule(
+    ib_timer_wheel_t *wheel,
+    ib_time_t         delay_usec,
+    ib_timer_fn_t     fn,
+    void             *cbdata,
+    ib_timer_t      **timer
+)
+{
+    assert(wheel != NULL);
+    assert(fn != NULL);
+
+    ib_timer_t *t;
+    uint64_t    delay_ticks;
+
+    /* Round up; a delay of 0 fires on the next advance. */
+    delay_ticks =
+        ((uint64_t)delay_usec + wheel->tick_usec - 1) / wheel->tick_usec;
+    if (delay_ticks == 0) {
+        delay_ticks = 1;
+    }
+    if (delay_ticks > ((uint64_t)1 << (8 * WHEEL_LEVELS)) - 1) {
+        return IB_EINVAL;
+    }
+
+    if (wheel->free_list != NULL) {
+        t = wheel->free_list;
+        wheel->free_list = t->next;
+        t->next = NULL;
+    }
+    else {
+        t = (ib_timer_t *)ib_mm_alloc(wheel->mm, sizeof(*t));
+        if (t == NULL) {
+            return IB_EALLOC;
+        }
+        t->wheel = wheel;
+    }
+
+    t->expire_tick = wheel->current_tick + delay_ticks;
+    t->fn          = fn;
+    t->cbdata      = cbdata;
+
+    wheel_place(wheel, t);
+
+    if (timer != NULL) {
+        *timer = t;
+    }
+    return IB_OK;
+}
+
+void ib_timer_cancel(ib_timer_t *timer)
+{
+    assert(timer != NULL);
+
+    /* Spent or already canceled timers have no callback and no slot. */
+    if (timer->fn == NULL && timer->slot == NULL) {
+        return;
+    }
+
+    wheel_unlink(timer);
+    wheel_recycle(timer);
+}
+
+size_t ib_timer_wheel_advance(
+    ib_timer_wheel_t *wheel,
+    ib_time_t         now
+)
+{
+    assert(wheel != NULL);
+
+    uint64_t target_tick;
+    size_t   fired = 0;
+
+    if (now <= wheel->epoch) {
+        return 0;
+    }
+    target_tick = (uint64_t)(now - wheel->epoch) / wheel->tick_usec;
+
+    while (wheel->current_tick < target_tick) {
+        ++wheel->current_tick;
+
+        /* When a level-0 lap completes, cascade one slot from the next
+         * level down; recursively, byte by byte. */
+        for (int level = 1; level < WHEEL_LEVELS; ++level) {
+            if ((wheel->current_tick &
+                 (((uint64_t)1 << (8 * level)) - 1)) != 0)
+            {
+                break;
+            }
+            {
+                size_t index =
+                    (wheel->current_tick >> (8 * level)) & (WHEEL_SLOTS - 1);
+                ib_timer_t *t = wheel->slots[level][index];
+
+                wheel->slots[level][index] = NULL;
+                while (t != NULL) {
+                    ib_timer_t *next = t->next;
+
+                    t->next = NULL;
+                    t->prev = NULL;
+                    t->slot = NULL;
+                    wheel_place(wheel, t);
+                    t = next;
+                }
+            }
+        }
+
+        /* Fire the current level-0 slot. */
+        {
+            size_t       index = wheel->current_tick & (WHEEL_SLOTS - 1);
+            ib_timer_t **slot = &wheel->slots[0][index];
+
+            while (*slot != NULL) {
+                ib_timer_t *t = *slot;
+
+                if (t->expire_tick > wheel->current_tick) {
+                    /* Same slot, a later lap; leave in place. */
+                    slot = &t->next;
+                    continue;
+                }
+
+                wheel_unlink(t);
+                {
+                    ib_timer_fn_t  fn = t->fn;
+                    void          *cbdata = t->cbdata;
+
+                    wheel_recycle(t);
+                    fn(cbdata);
+                    ++fired;
+                }
+                /* The callback may have scheduled into this slot;
+                 * restart from the head. */
+                slot = &wheel->slots[0][index];
+            }
+        }
+    }
+
+    return fired;
+}
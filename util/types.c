@@ -47,6 +47,7 @@ const char *ib_status_to_string(ib_status_t status)
     case IB_EOTHER:    return "EOTHER";
     case IB_EBADVAL:   return "EBADVAL";
     case IB_EEXIST:    return "EEXIST";
+    case IB_DEFER:     return "DEFER";
     default:
         sprintf(buffer, "Unknown Status Code: %d", status);
         return buffer;
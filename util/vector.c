@@ -135,6 +135,23 @@ ib_status_t ib_vector_resize(
         return IB_OK;
     }
 
+    /* Growth allocates from the existing pool: abandoning the old
+     * buffer there is bounded (geometric growth sums to under twice
+     * the final size) and far cheaper than creating and destroying a
+     * pool per step.  Shrinks keep the pool swap below, since their
+     * point is returning memory. */
+    if (size > vector->size) {
+        new_data = ib_mpool_lite_alloc(vector->mp, size);
+        if (new_data == NULL) {
+            return IB_EALLOC;
+        }
+        memcpy(new_data, vector->data, vector->size);
+
+        vector->data = new_data;
+        vector->size = size;
+        return IB_OK;
+    }
+
     rc = ib_mpool_lite_create(&new_mp);
     if (rc != IB_OK) {
         return rc;
@@ -202,6 +219,59 @@ ib_status_t ib_vector_truncate(
     return IB_OK;
 }
 
+ib_status_t ib_vector_reserve(
+    ib_vector_t  *vector,
+    size_t        data_length,
+    void        **data
+)
+{
+    assert(vector != NULL);
+    assert(vector->mp != NULL);
+    assert(data != NULL);
+
+    ib_status_t rc;
+    size_t vector_size = 0;
+    size_t new_len = data_length + vector->len;
+
+    /* Check for overflow. */
+    if (new_len < vector->len) {
+        return IB_EINVAL;
+    }
+
+    if (new_len > vector->size) {
+        rc = buffer_size(new_len, &vector_size);
+        if (rc != IB_OK) {
+            return rc;
+        }
+        rc = ib_vector_resize(vector, vector_size);
+        if (rc != IB_OK) {
+            return IB_EALLOC;
+        }
+    }
+
+    *data = vector->data + vector->len;
+
+    return IB_OK;
+}
+
+ib_status_t ib_vector_commit(
+    ib_vector_t *vector,
+    size_t       data_length
+)
+{
+    assert(vector != NULL);
+
+    /* Only space made available by ib_vector_reserve() may be
+     * committed. */
+    if (data_length > vector->size - vector->len) {
+        return IB_EINVAL;
+    }
+
+    vector->len += data_length;
+
+    return IB_OK;
+}
+
 ib_status_t ib_vector_append(
     ib_vector_t *vector,
     const void *data,